@@ -24,17 +24,21 @@
 constexpr std::string_view version_tag_name = "Version";
 constexpr std::string_view path_backup_ext  = ".bk";
 
+// Saves requested within this time of each other are written together.
+constexpr std::chrono::milliseconds save_debounce{250};
+
 streamfx::configuration::~configuration()
 {
 	try {
-		save();
+		// Skip the debounce, so that shutdown waits for at most the write in progress and this one.
+		schedule_save(std::chrono::steady_clock::now());
 		_save_task->wait();
 	} catch (std::exception const& ex) {
-		DLOG_ERROR("Failed to save configuration: %s", ex.what());
+		D_LOG_ERROR("Failed to save configuration: %s", ex.what());
 	}
 }
 
-streamfx::configuration::configuration() : _config_path(), _data(), _task_lock(), _save_task()
+streamfx::configuration::configuration() : _config_path(), _data(), _task_lock(), _save_cv(), _save_deadline(), _save_requested(false), _save_running(false), _save_task()
 {
 	// Retrieve global configuration path.
 	_config_path = streamfx::config_file_path("config.json");
@@ -57,22 +61,60 @@ streamfx::configuration::configuration() : _config_path(), _data(), _task_lock()
 
 void streamfx::configuration::save()
 {
-	std::lock_guard<std::mutex> lg(_task_lock);
-	if (!_save_task || _save_task->is_completed()) {
-		_save_task = streamfx::threadpool()->push([this](streamfx::util::threadpool::task_data_t) {
-			// ToDo: Implement delayed tasks in ::threadpool.
-			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	schedule_save(std::chrono::steady_clock::now() + save_debounce);
+}
 
-			// Update version tag.
-			obs_data_set_int(_data.get(), version_tag_name.data(), STREAMFX_VERSION);
+void streamfx::configuration::schedule_save(std::chrono::steady_clock::time_point deadline)
+{
+	{
+		std::lock_guard<std::mutex> lg(_task_lock);
+		_save_deadline  = deadline;
+		_save_requested = true;
+
+		// A running task picks up the new request by itself, it only finishes once there are none left.
+		if (!_save_running) {
+			_save_running = true;
+			_save_task    = streamfx::threadpool()->push(std::bind(&configuration::task_save, this, std::placeholders::_1), nullptr, ::streamfx::util::threadpool::priority::BACKGROUND);
+		}
+	}
+	_save_cv.notify_all();
+}
 
-			if (_config_path.has_parent_path()) {
-				std::filesystem::create_directories(_config_path.parent_path());
-			}
-			if (!obs_data_save_json_safe(_data.get(), _config_path.u8string().c_str(), ".tmp", path_backup_ext.data())) {
-				D_LOG_ERROR("Failed to save configuration file.", nullptr);
-			}
-		});
+void streamfx::configuration::task_save(streamfx::util::threadpool::task_data_t)
+{
+	std::unique_lock<std::mutex> ul(_task_lock);
+	while (_save_requested) {
+		// Keep pushing the write back while saves keep coming in.
+		if (std::chrono::steady_clock::now() < _save_deadline) {
+			_save_cv.wait_until(ul, _save_deadline);
+			continue;
+		}
+
+		_save_requested = false;
+		ul.unlock();
+		write();
+		ul.lock();
+	}
+	_save_running = false;
+}
+
+void streamfx::configuration::write()
+{
+	try {
+		// Update version tag.
+		obs_data_set_int(_data.get(), version_tag_name.data(), STREAMFX_VERSION);
+
+		if (_config_path.has_parent_path()) {
+			std::filesystem::create_directories(_config_path.parent_path());
+		}
+
+		// Written to a temporary file first and then renamed over the old one, so a failed write never leaves a
+		// truncated configuration behind.
+		if (!obs_data_save_json_safe(_data.get(), _config_path.u8string().c_str(), ".tmp", path_backup_ext.data())) {
+			D_LOG_ERROR("Failed to save configuration file.", nullptr);
+		}
+	} catch (std::exception const& ex) {
+		D_LOG_ERROR("Failed to save configuration: %s", ex.what());
 	}
 }
 
@@ -6,6 +6,8 @@
 #include "common.hpp"
 
 #include "warning-disable.hpp"
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <memory>
 #include <new>
@@ -22,6 +24,10 @@ namespace streamfx {
 #endif
 			std::mutex _task_lock;
 
+		std::condition_variable                           _save_cv;
+		std::chrono::steady_clock::time_point             _save_deadline;
+		bool                                              _save_requested;
+		bool                                              _save_running;
 		std::shared_ptr<streamfx::util::threadpool::task> _save_task;
 
 		public:
@@ -31,8 +37,16 @@ namespace streamfx {
 		configuration();
 
 		public:
+		/** Save the configuration in the background, a burst of calls results in a single write. */
 		void save();
 
+		private:
+		void schedule_save(std::chrono::steady_clock::time_point deadline);
+
+		void task_save(streamfx::util::threadpool::task_data_t data);
+
+		void write();
+
 		public:
 		std::shared_ptr<obs_data_t> get();
 
@@ -11,6 +11,7 @@
 #include "codecs/hevc.hpp"
 #include "ffmpeg/tools.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "util/util-plane-copy.hpp"
 #include "plugin.hpp"
 
 #include "warning-disable.hpp"
@@ -24,6 +25,7 @@ extern "C" {
 
 #include "warning-disable.hpp"
 #include <libavcodec/avcodec.h>
+#include <libavutil/cpu.h>
 #include <libavutil/dict.h>
 #include <libavutil/frame.h>
 #include <libavutil/opt.h>
@@ -34,18 +36,43 @@ extern "C" {
 #ifdef WIN32
 #include "ffmpeg/hwapi/d3d11.hpp"
 #endif
+#ifdef ENABLE_ENCODER_FFMPEG_VAAPI
+#include "ffmpeg/hwapi/vaapi.hpp"
+#endif
 
 // FFmpeg
 #define ST_I18N_FFMPEG "Encoder.FFmpeg"
 #define ST_I18N_FFMPEG_SUFFIX ST_I18N_FFMPEG ".Suffix"
 #define ST_I18N_FFMPEG_CUSTOMSETTINGS ST_I18N_FFMPEG ".CustomSettings"
 #define ST_KEY_FFMPEG_CUSTOMSETTINGS "FFmpeg.CustomSettings"
+#define ST_I18N_FFMPEG_CUSTOMSETTINGS_ERRORS ST_I18N_FFMPEG_CUSTOMSETTINGS ".Errors"
+#define ST_KEY_FFMPEG_CUSTOMSETTINGS_ERRORS "FFmpeg.CustomSettings.Errors"
 #define ST_I18N_FFMPEG_THREADS ST_I18N_FFMPEG ".Threads"
 #define ST_KEY_FFMPEG_THREADS "FFmpeg.Threads"
 #define ST_I18N_FFMPEG_FRAMERATE ST_I18N_FFMPEG ".Framerate"
 #define ST_KEY_FFMPEG_FRAMERATE "FFmpeg.Framerate"
+#define ST_I18N_FFMPEG_RENDITION ST_I18N_FFMPEG ".Rendition"
+#define ST_KEY_FFMPEG_RENDITION "FFmpeg.Rendition"
 #define ST_I18N_FFMPEG_GPU ST_I18N_FFMPEG ".GPU"
 #define ST_KEY_FFMPEG_GPU "FFmpeg.GPU"
+#define ST_I18N_FFMPEG_GPU_WARNING ST_I18N_FFMPEG_GPU ".Warning"
+#define ST_KEY_FFMPEG_GPU_WARNING "FFmpeg.GPU.Warning"
+#define ST_I18N_FFMPEG_ZEROCOPY ST_I18N_FFMPEG ".ZeroCopy"
+#define ST_KEY_FFMPEG_ZEROCOPY "FFmpeg.ZeroCopy"
+#define ST_I18N_FFMPEG_GPUCONVERT ST_I18N_FFMPEG ".GPUConvert"
+#define ST_KEY_FFMPEG_GPUCONVERT "FFmpeg.GPUConvert"
+#define ST_I18N_FFMPEG_CONVERTSLICES ST_I18N_FFMPEG ".ConvertSlices"
+#define ST_KEY_FFMPEG_CONVERTSLICES "FFmpeg.ConvertSlices"
+#define ST_I18N_FFMPEG_ASYNCDEPTH ST_I18N_FFMPEG ".AsyncDepth"
+#define ST_KEY_FFMPEG_ASYNCDEPTH "FFmpeg.AsyncDepth"
+#define ST_I18N_FFMPEG_STANDBY ST_I18N_FFMPEG ".Standby"
+#define ST_KEY_FFMPEG_STANDBY "FFmpeg.Standby"
+#define ST_I18N_FFMPEG_REGIONHINTS ST_I18N_FFMPEG ".RegionHints"
+#define ST_KEY_FFMPEG_REGIONHINTS "FFmpeg.RegionHints"
+#define ST_I18N_FFMPEG_STATICHINTS ST_I18N_FFMPEG ".StaticHints"
+#define ST_KEY_FFMPEG_STATICHINTS "FFmpeg.StaticHints"
+#define ST_I18N_FFMPEG_OVERLOAD ST_I18N_FFMPEG ".Overload"
+#define ST_KEY_FFMPEG_OVERLOAD "FFmpeg.Overload"
 
 #define ST_I18N_KEYFRAMES ST_I18N_FFMPEG ".KeyFrames"
 #define ST_I18N_KEYFRAMES_INTERVALTYPE ST_I18N_KEYFRAMES ".IntervalType"
@@ -58,8 +85,57 @@ extern "C" {
 using namespace streamfx::encoder::ffmpeg;
 using namespace streamfx::encoder::codec;
 
+// How often stage timings are written to the log while encoding.
+constexpr uint64_t timing_report_interval = 300ull * 1000000000ull;
+
+// Encoding has to take this much longer than a frame lasts before frames are dropped, and get this much faster again
+// before it stops, so that jitter around the limit doesn't turn it on and off all the time.
+constexpr double_t overload_enter = 1.05;
+constexpr double_t overload_leave = 0.95;
+
+// Unchanged frames in a row before they are hinted as static, which gives the encoder a few frames to refine the
+// picture first. Only every static_row_step-th row is compared, changes that fit between them go unnoticed.
+constexpr uint64_t    static_after    = 3;
+constexpr std::size_t static_row_step = 4;
+
+// Renditions are stored in twelfths of the input size, which covers the usual 1080p, 720p, 540p, 360p and 270p ladder.
+constexpr int64_t     rendition_full     = 12;
+constexpr int64_t     rendition_scales[] = {12, 9, 8, 6, 4, 3};
+constexpr const char* rendition_names[]  = {"1/1", "3/4", "2/3", "1/2", "1/3", "1/4"};
+
+// Software encoders which are currently active, so that automatic threading can share the CPU between them.
+static std::atomic<int64_t> active_software_encoders = 0;
+
+// Hardware encoders only allow so many sessions per GPU, so at most one warm standby is opened at a time.
+static std::atomic<int64_t> standby_hardware_sessions = 0;
+
 enum class keyframe_type { SECONDS, FRAMES };
 
+// Acceleration API for the graphics backend OBS uses, if there is one.
+static std::shared_ptr<::streamfx::ffmpeg::hwapi::base> create_hwapi()
+{
+#ifdef WIN32
+	auto gctx = streamfx::obs::gs::context();
+	if (gs_get_device_type() == GS_DEVICE_DIRECT3D_11) {
+		return std::make_shared<::streamfx::ffmpeg::hwapi::d3d11>();
+	}
+#endif
+#if defined(ENABLE_ENCODER_FFMPEG_VAAPI) && defined(D_ENCODER_TEXTURE2)
+	auto gctx = streamfx::obs::gs::context();
+	if (gs_get_device_type() == GS_DEVICE_OPENGL) {
+		return std::make_shared<::streamfx::ffmpeg::hwapi::vaapi>();
+	}
+#endif
+	return nullptr;
+}
+
+// Can the encoder run on the adapter? If either vendor is unknown, the driver gets to decide.
+static bool is_adapter_usable(const AVCodec* codec, const ::streamfx::ffmpeg::hwapi::device& adapter)
+{
+	uint32_t vendor = ::streamfx::ffmpeg::tools::get_hardware_vendor(codec);
+	return (vendor == 0) || (adapter.vendor == 0) || (vendor == adapter.vendor);
+}
+
 ffmpeg_instance::ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool is_hw)
 	: encoder_instance(settings, self, is_hw),
 
@@ -67,31 +143,51 @@ ffmpeg_instance::ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool
 
 	  _codec(_factory->get_avcodec()), _context(nullptr), _handler(ffmpeg_manager::instance()->get_handler(_codec->name)),
 
-	  _scaler(), _packet(),
+	  _scaler(), _gpu_convert(), _gpu_ladder(), _packet(),
 
 	  _hwapi(), _hwinst(),
 
 	  _lag_in_frames(0), _sent_frames(0), _have_first_frame(false), _extra_data(), _sei_data(),
 
-	  _free_frames(), _used_frames(), _free_frames_last_used()
+	  _frame_pool(), _used_frames(), _late_allocations(0), _packet_pool(), _frame_hub(), _frame_channel(),
+
+	  _zerocopy(false), _zerocopy_refs(0),
+
+	  _async_input(), _async_output(), _async_packet(), _async_lock(), _async_cv(), _async_stop(false), _async_failed(false), _async_thread(),
+
+	  _standby_enabled(false), _standby_session(false), _standby(nullptr), _standby_open(), _standby_output(), _standby_packet(),
+
+	  _region_hints(), _static_hints(false), _static_active(false), _static_hash(0), _static_frames(0),
+
+	  _overload_enabled(false), _overload_active(false), _overload_cost(0.), _overload_credit(0.), _overload_episode(0), _overload_dropped(0),
+
+	  _timing_convert(), _timing_upload(), _timing_send(), _timing_receive(), _timing_reported(os_gettime_ns())
 {
+	_profiler_copy = ::streamfx::util::profiler::create();
+
 	// Initialize GPU Stuff
 	if (is_hw) {
 		// Abort if user specified manual override.
-		if ((obs_data_get_int(settings, ST_KEY_FFMPEG_GPU) != -1) || (obs_encoder_scaling_enabled(_self)) || (video_output_get_info(obs_encoder_video(_self))->format != VIDEO_FORMAT_NV12)) {
+		// Shared textures are only available as NV12 or P010.
+		auto format = video_output_get_info(obs_encoder_video(_self))->format;
+		if ((obs_data_get_int(settings, ST_KEY_FFMPEG_GPU) != -1) || (obs_data_get_int(settings, ST_KEY_FFMPEG_RENDITION) != rendition_full) || (obs_encoder_scaling_enabled(_self)) || ((format != VIDEO_FORMAT_NV12) && (format != VIDEO_FORMAT_P010))) {
 			throw std::runtime_error("Selected settings prevent the use of hardware encoding, falling back to software.");
 		}
 
-#ifdef WIN32
-		auto gctx = streamfx::obs::gs::context();
-		if (gs_get_device_type() == GS_DEVICE_DIRECT3D_11) {
-			_hwapi = std::make_shared<::streamfx::ffmpeg::hwapi::d3d11>();
-		}
-#endif
+		_hwapi = create_hwapi();
 		if (!_hwapi) {
 			throw std::runtime_error("Failed to create acceleration context.");
 		}
 
+		// Textures from OBS only stay on the GPU if the encoder runs on the same GPU that OBS renders on. Anything else
+		// has the driver silently copy every frame between GPUs, which is slower than just using system memory.
+		auto adapter = _hwapi->get_obs_adapter();
+		DLOG_INFO("[%s] OBS renders on '%s'.", _codec->name, adapter.name.c_str());
+		if (!is_adapter_usable(_codec, adapter)) {
+			DLOG_WARNING("[%s] Encoder can not run on the GPU that OBS renders on, frames will be copied to it through system memory. Use the '%s' option to pick the GPU it runs on.", _codec->name, D_TRANSLATE(ST_I18N_FFMPEG_GPU));
+			throw std::runtime_error("Encoder and OBS are on different GPUs, falling back to software.");
+		}
+
 		_hwinst = _hwapi->create_from_obs();
 	}
 
@@ -102,6 +198,12 @@ ffmpeg_instance::ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool
 		throw std::runtime_error("Failed to create encoder context.");
 	}
 
+	// Recycle packet payloads instead of allocating them for every packet, if the encoder lets us.
+	if ((_codec->capabilities & AV_CODEC_CAP_DR1) != 0) {
+		_packet_pool = std::make_unique<::streamfx::ffmpeg::packet_pool>();
+		_packet_pool->attach(_context);
+	}
+
 	// Allocate a small packet for later use.
 	_packet = {av_packet_alloc(), [](AVPacket* ptr) { av_packet_free(&ptr); }};
 	av_new_packet(_packet.get(), 8 * 1024 * 1024); // 8 MiB is usually enough for compressed data.
@@ -130,10 +232,80 @@ ffmpeg_instance::ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool
 	if (res < 0) {
 		throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
 	}
+
+	// Asynchronous encoding moves all interaction with libavcodec to a dedicated thread, and the queue depth
+	// becomes the number of frames we lag behind OBS.
+	if (int64_t depth = obs_data_get_int(settings, ST_KEY_FFMPEG_ASYNCDEPTH); depth > 0) {
+		_lag_in_frames = static_cast<size_t>(depth);
+		_async_input   = std::make_unique<::streamfx::util::spsc_queue<::streamfx::ffmpeg::pooled_frame>>(_lag_in_frames);
+	}
+	DLOG_INFO("[%s]   Asynchronous: %s (lagging %zu frames behind)", _codec->name, _async_input ? "Enabled" : "Disabled", _lag_in_frames);
+
+	// Pre-allocate all frames we expect to need, now that we know how far behind we lag.
+	create_frame_pool();
+
+	if (_async_input) {
+		_async_thread = std::thread(&ffmpeg_instance::async_work, this);
+	}
+
+	// The asynchronous worker owns the context, so it can't be replaced from here.
+	_standby_enabled = !_async_input && obs_data_get_bool(settings, ST_KEY_FFMPEG_STANDBY);
+	DLOG_INFO("[%s]   Warm Standby: %s", _codec->name, _standby_enabled ? "Enabled" : "Disabled");
+
+	if (obs_data_get_bool(settings, ST_KEY_FFMPEG_REGIONHINTS)) {
+		_region_hints = ::streamfx::util::region_hints::get();
+	}
+	DLOG_INFO("[%s]   Region Hints: %s", _codec->name, _region_hints ? "Enabled" : "Disabled");
+
+	// Only frames in system memory can be compared cheaply.
+	_static_hints = !_hwinst && obs_data_get_bool(settings, ST_KEY_FFMPEG_STATICHINTS);
+	DLOG_INFO("[%s]   Static Hints: %s", _codec->name, _static_hints ? "Enabled" : "Disabled");
+
+	_overload_enabled = obs_data_get_bool(settings, ST_KEY_FFMPEG_OVERLOAD);
+	DLOG_INFO("[%s]   Drop Frames when Overloaded: %s", _codec->name, _overload_enabled ? "Enabled" : "Disabled");
+
+	// Zero-Copy is only safe if the encoder lets go of all frame references before avcodec_send_frame or
+	// avcodec_receive_packet return, as OBS reclaims the frame memory right after the encode callback.
+	if (!_hwinst && !_async_input && obs_data_get_bool(settings, ST_KEY_FFMPEG_ZEROCOPY)) {
+		_zerocopy = ((_codec->capabilities & AV_CODEC_CAP_DELAY) == 0) && (_scaler.get_source_width() == _scaler.get_target_width()) && (_scaler.get_source_height() == _scaler.get_target_height()) && ((_context->active_thread_type & FF_THREAD_FRAME) == 0) && (_scaler.is_source_full_range() == _scaler.is_target_full_range()) && (_scaler.get_source_colorspace() == _scaler.get_target_colorspace()) && (_scaler.get_source_format() == _scaler.get_target_format());
+	}
+	DLOG_INFO("[%s]   Zero-Copy: %s", _codec->name, _zerocopy ? "Enabled" : "Disabled");
+
+	// Software encoders that need the same conversion of the same video output can share the converted frame.
+	if (!_hwinst && !_zerocopy) {
+		::streamfx::ffmpeg::frame_hub_key key;
+		key.video      = obs_encoder_video(_self);
+		key.width      = static_cast<uint32_t>(_context->width);
+		key.height     = static_cast<uint32_t>(_context->height);
+		key.format     = _scaler.get_target_format();
+		key.colorspace = _scaler.get_target_colorspace();
+		key.full_range = _scaler.is_target_full_range();
+
+		_frame_hub     = ::streamfx::ffmpeg::frame_hub::instance();
+		_frame_channel = _frame_hub->subscribe(key);
+	}
+	DLOG_INFO("[%s]   Frame Sharing: %s", _codec->name, _frame_channel ? "Enabled" : "Disabled");
+
+	if (!_hwinst) {
+		active_software_encoders.fetch_add(1);
+	}
 }
 
 ffmpeg_instance::~ffmpeg_instance()
 {
+	if (!_hwinst) {
+		active_software_encoders.fetch_sub(1);
+	}
+
+	// Stop the asynchronous worker first, as it may still be talking to libavcodec.
+	if (_async_thread.joinable()) {
+		_async_stop = true;
+		_async_cv.notify_all();
+		_async_thread.join();
+	}
+
+	discard_standby();
+
 	auto gctx = streamfx::obs::gs::context();
 	if (_context) {
 		// Flush encoders that require it.
@@ -152,6 +324,29 @@ ffmpeg_instance::~ffmpeg_instance()
 	av_packet_unref(_packet.get());
 
 	_scaler.finalize();
+	_gpu_convert.reset();
+	_gpu_ladder.reset();
+
+	if (_frame_pool) {
+		DLOG_INFO("[%s] Frame Pool: %" PRIu64 " hits, %" PRIu64 " misses (%" PRIu64 " after the first second) with %zu frames.", _codec->name, _frame_pool->hits(), _frame_pool->misses(), _late_allocations, _frame_pool->capacity());
+	}
+	if (_packet_pool) {
+		DLOG_INFO("[%s] Packet Pool: %" PRIu64 " packets with %" PRIu64 " allocations, %.3f MiB peak.", _codec->name, _packet_pool->packets(), _packet_pool->allocations(), static_cast<double_t>(_packet_pool->peak()) / 1048576.0);
+	}
+	log_timings();
+	if (_overload_dropped > 0) {
+		DLOG_INFO("[%s] Overload: %" PRIu64 " frames were dropped to keep up.", _codec->name, _overload_dropped);
+	}
+	if (_frame_channel && (_frame_channel.use_count() == 1)) {
+		DLOG_INFO("[%s] Frame Sharing: %" PRIu64 " frames were shared between encoders.", _codec->name, _frame_channel->shared());
+	}
+	if (_gpu_ladder && (_gpu_ladder.use_count() == 1)) {
+		DLOG_INFO("[%s] GPU Ladder: %" PRIu64 " uploads were shared between encoders.", _codec->name, _gpu_ladder->shared());
+	}
+
+	if (_profiler_copy->count() > 0) {
+		DLOG_INFO("[%s] Frame Copy: %" PRIu64 " frames, %.3f ms average, %.3f ms 95th percentile, %.3f ms 99th percentile.", _codec->name, _profiler_copy->count(), _profiler_copy->average_duration() / 1000000.0, static_cast<double_t>(_profiler_copy->percentile(0.95).count()) / 1000000.0, static_cast<double_t>(_profiler_copy->percentile(0.99).count()) / 1000000.0);
+	}
 }
 
 void ffmpeg_instance::get_properties(obs_properties_t* props)
@@ -165,6 +360,15 @@ void ffmpeg_instance::get_properties(obs_properties_t* props)
 
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_THREADS), false);
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_GPU), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_ZEROCOPY), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_GPUCONVERT), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_CONVERTSLICES), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_RENDITION), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_ASYNCDEPTH), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_STANDBY), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_REGIONHINTS), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_STATICHINTS), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_OVERLOAD), false);
 }
 
 void ffmpeg_instance::migrate(obs_data_t* settings, uint64_t version)
@@ -182,6 +386,16 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 	if (_handler) {
 		support_reconfig = _handler->is_reconfigurable(_factory, support_reconfig_threads, support_reconfig_gpu, support_reconfig_keyframes);
 	}
+	if (_context->internal && _standby_enabled) {
+		// Reconfiguring in place only covers some of the settings, a new context covers all of them.
+		if (prepare_standby(settings)) {
+			return true;
+		}
+	}
+	if (_context->internal && !support_reconfig) {
+		DLOG_WARNING("[%s] Encoder does not support changing settings while active, changes require restarting the encoder.", _codec->name);
+		return true;
+	}
 
 	if (!_context->internal) {
 		// FFmpeg Options
@@ -200,18 +414,39 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 				_context->thread_type |= FF_THREAD_SLICE;
 			}
 			if (_context->thread_type != 0) {
-				int64_t threads = obs_data_get_int(settings, ST_I18N_FFMPEG_THREADS);
+				int64_t threads = obs_data_get_int(settings, ST_KEY_FFMPEG_THREADS);
 				if (threads > 0) {
 					_context->thread_count = static_cast<int>(threads);
 				} else {
-					_context->thread_count = static_cast<int>(std::thread::hardware_concurrency());
+					// Slice threading adds no latency and needs no extra frames, so prefer it if available.
+					if ((_context->thread_type & FF_THREAD_SLICE) != 0) {
+						_context->thread_type = FF_THREAD_SLICE;
+					}
+
+					// Share the CPU evenly with all other active software encoders, as multiple recordings at once
+					// would otherwise oversubscribe it many times over.
+					int64_t others = active_software_encoders.load() - (_context->internal ? 1 : 0);
+					int64_t cores  = std::max<int64_t>(static_cast<int64_t>(std::thread::hardware_concurrency()), 1);
+					int64_t share  = std::max<int64_t>(cores / (std::max<int64_t>(others, 0) + 1), 1);
+
+					// More threads than there is work for only adds overhead. Slices are at least a row of
+					// macroblocks tall, and frame threading stops scaling well beyond FFmpeg's own limit of 16.
+					int64_t limit = 16;
+					if (_context->thread_type == FF_THREAD_SLICE) {
+						limit = std::max<int64_t>(_context->height / 16, 1);
+					} else {
+						limit = std::clamp<int64_t>((static_cast<int64_t>(_context->width) * _context->height) / (320 * 240), 1, 16);
+					}
+
+					_context->thread_count = static_cast<int>(std::min<int64_t>(share, limit));
+					DLOG_INFO("[%s] Automatic Threading: %i threads for %" PRId64 " cores shared with %" PRId64 " other encoders.", _codec->name, _context->thread_count, cores, std::max<int64_t>(others, 0));
 				}
 			} else {
 				_context->thread_count = 1;
 			}
 
-			// Frame Delay (Lag In Frames)
-			_context->delay = _context->thread_count;
+			// Frame Delay (Lag In Frames), only frame threading holds on to frames.
+			_context->delay = ((_context->thread_type & FF_THREAD_FRAME) != 0) ? _context->thread_count : 0;
 		} else {
 			_context->delay = 0;
 		}
@@ -247,6 +482,12 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 	}
 
 	if (!_context->internal || support_reconfig) {
+		// An active encoder reads these while encoding, so only change them in between two frames.
+		std::unique_ptr<streamfx::obs::gs::context> gctx;
+		if (_context->internal) {
+			gctx = std::make_unique<streamfx::obs::gs::context>();
+		}
+
 		// Handler Options
 		if (_handler)
 			_handler->update(this->_factory, this, settings);
@@ -255,7 +496,14 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 			const char* opts     = obs_data_get_string(settings, ST_KEY_FFMPEG_CUSTOMSETTINGS);
 			std::size_t opts_len = strnlen(opts, 65535);
 
-			parse_ffmpeg_commandline(std::string{opts, opts + opts_len});
+			// Parsed and validated only once per distinct text, so restarts do not pay for it again.
+			auto options = ::streamfx::ffmpeg::option_list::parse(std::string_view{opts, opts_len}, _codec);
+			for (const auto& opt : options->options()) {
+				if (!opt.error.empty()) {
+					DLOG_WARNING("[%s] Ignoring option '%s' (value: '%s'): %s", _codec->name, opt.key.c_str(), opt.value.c_str(), opt.error.c_str());
+				}
+			}
+			options->apply(_context);
 		}
 
 		// Handler Overrides
@@ -264,7 +512,9 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 	}
 
 	// Handler Logging
-	if (!_context->internal || support_reconfig) {
+	if (_context->internal) {
+		DLOG_INFO("[%s] Reconfigured: %" PRId64 " kbit/s target, %" PRId64 " kbit/s maximum, %" PRId32 " kbit buffer.", _codec->name, static_cast<int64_t>(_context->bit_rate / 1000), static_cast<int64_t>(_context->rc_max_rate / 1000), _context->rc_buffer_size / 1000);
+	} else {
 		DLOG_INFO("[%s] Configuration:", _codec->name);
 		DLOG_INFO("[%s]   FFmpeg:", _codec->name);
 		DLOG_INFO("[%s]     Custom Settings: %s", _codec->name, obs_data_get_string(settings, ST_KEY_FFMPEG_CUSTOMSETTINGS));
@@ -308,24 +558,66 @@ static inline void copy_data(encoder_frame* frame, AVFrame* vframe)
 			continue;
 
 		std::size_t plane_height = static_cast<size_t>(vframe->height) >> (idx ? v_chroma_shift : 0);
+		std::size_t ls_in        = static_cast<size_t>(frame->linesize[idx]);
+		std::size_t ls_out       = static_cast<size_t>(vframe->linesize[idx]);
+		std::size_t bytes        = ls_in < ls_out ? ls_in : ls_out;
 
-		if (static_cast<uint32_t>(vframe->linesize[idx]) == frame->linesize[idx]) {
-			std::memcpy(vframe->data[idx], frame->data[idx], frame->linesize[idx] * plane_height);
-		} else {
-			std::size_t ls_in  = static_cast<size_t>(frame->linesize[idx]);
-			std::size_t ls_out = static_cast<size_t>(vframe->linesize[idx]);
-			std::size_t bytes  = ls_in < ls_out ? ls_in : ls_out;
+		::streamfx::util::plane_copy::copy(vframe->data[idx], ls_out, frame->data[idx], ls_in, bytes, plane_height);
+	}
+}
+
+::streamfx::ffmpeg::pooled_frame ffmpeg_instance::wrap_frame(encoder_frame* frame)
+{
+	// FFmpeg expects all of its input to be aligned to the largest SIMD register size, so check this first.
+	std::size_t align = av_cpu_max_align();
 
-			uint8_t* to   = vframe->data[idx];
-			uint8_t* from = frame->data[idx];
+	int h_chroma_shift, v_chroma_shift;
+	av_pix_fmt_get_chroma_sub_sample(_context->pix_fmt, &h_chroma_shift, &v_chroma_shift);
 
-			for (std::size_t y = 0; y < plane_height; y++) {
-				std::memcpy(to, from, bytes);
-				to += ls_out;
-				from += ls_in;
-			}
+	std::size_t planes = static_cast<size_t>(av_pix_fmt_count_planes(_context->pix_fmt));
+	if ((planes == 0) || (planes > MAX_AV_PLANES) || (planes > AV_NUM_DATA_POINTERS)) {
+		return nullptr;
+	}
+	for (std::size_t idx = 0; idx < planes; idx++) {
+		if (!frame->data[idx] || (frame->linesize[idx] == 0)) {
+			return nullptr;
 		}
+		if (((reinterpret_cast<uintptr_t>(frame->data[idx]) % align) != 0) || ((frame->linesize[idx] % align) != 0)) {
+			return nullptr;
+		}
+	}
+
+	auto vframe = std::shared_ptr<AVFrame>(av_frame_alloc(), [](AVFrame* frame) { av_frame_free(&frame); });
+	if (!vframe) {
+		return nullptr;
 	}
+
+	vframe->width  = _context->width;
+	vframe->height = _context->height;
+	vframe->format = _context->pix_fmt;
+	for (std::size_t idx = 0; idx < planes; idx++) {
+		std::size_t plane_height = static_cast<size_t>(vframe->height) >> (idx ? v_chroma_shift : 0);
+		std::size_t plane_size   = static_cast<size_t>(frame->linesize[idx]) * plane_height;
+
+		// Wrap the plane as a non-owning, read-only buffer. The free callback only tracks if any reference is left.
+		vframe->buf[idx] = av_buffer_create(
+			frame->data[idx], plane_size,
+			[](void* opaque, uint8_t*) {
+				// Tracks how many references the encoder is still holding on to.
+				static_cast<std::atomic<size_t>*>(opaque)->fetch_sub(1);
+			},
+			&_zerocopy_refs, AV_BUFFER_FLAG_READONLY);
+		if (!vframe->buf[idx]) {
+			return nullptr;
+		}
+		++_zerocopy_refs;
+
+		vframe->data[idx]     = frame->data[idx];
+		vframe->linesize[idx] = static_cast<int>(frame->linesize[idx]);
+	}
+
+	// Wrapped frames point at memory owned by OBS, so they must never end up in the pool.
+	return _frame_pool->wrap(vframe);
 }
 
 bool ffmpeg_instance::encode_audio(struct encoder_frame* frame, struct encoder_packet* packet, bool* received_packet)
@@ -339,28 +631,77 @@ bool ffmpeg_instance::encode_video(struct encoder_frame* frame, struct encoder_p
 		return true;
 	}
 
-	std::shared_ptr<AVFrame> vframe = pop_free_frame(); // Retrieve an empty frame.
+	_static_active = is_static(frame);
+
+	if (_zerocopy) { // Try to hand the OBS frame memory to the encoder directly.
+		if (auto vframe = wrap_frame(frame); vframe) {
+			vframe->color_range     = _context->color_range;
+			vframe->colorspace      = _context->colorspace;
+			vframe->color_primaries = _context->color_primaries;
+			vframe->color_trc       = _context->color_trc;
+			vframe->pts             = frame->pts;
+			apply_region_hints(vframe.get());
+
+			bool result = encode_avframe(vframe, packet, received_packet);
+			vframe.reset();
+
+			// If the encoder still holds references, the memory will be gone once we return. This should never
+			// happen due to the checks in the constructor, but if it does we must stop using Zero-Copy right away.
+			if (_zerocopy_refs > 0) {
+				DLOG_WARNING("[%s] Encoder kept references to frame memory past encoding, disabling Zero-Copy.", _codec->name);
+				_zerocopy = false;
+			}
+
+			return result;
+		}
+	}
+
+	::streamfx::ffmpeg::pooled_frame vframe;
+	if (_frame_channel) { // Another encoder may have already converted this exact frame.
+		vframe = _frame_pool->wrap(_frame_channel->find(frame));
+	}
 
 	// Convert frame.
-	{
+	if (!vframe) {
+		vframe = pop_free_frame(); // Retrieve an empty frame.
+
 		vframe->height          = _context->height;
 		vframe->format          = _context->pix_fmt;
 		vframe->color_range     = _context->color_range;
 		vframe->colorspace      = _context->colorspace;
 		vframe->color_primaries = _context->color_primaries;
 		vframe->color_trc       = _context->color_trc;
-		vframe->pts             = frame->pts;
 
-		if ((_scaler.is_source_full_range() == _scaler.is_target_full_range()) && (_scaler.get_source_colorspace() == _scaler.get_target_colorspace()) && (_scaler.get_source_format() == _scaler.get_target_format())) {
+		auto timing = _timing_convert.track();
+		if ((_scaler.get_source_width() == _scaler.get_target_width()) && (_scaler.get_source_height() == _scaler.get_target_height()) && (_scaler.is_source_full_range() == _scaler.is_target_full_range()) && (_scaler.get_source_colorspace() == _scaler.get_target_colorspace()) && (_scaler.get_source_format() == _scaler.get_target_format())) {
+			auto profile = _profiler_copy->track();
 			copy_data(frame, vframe.get());
+		} else if (_gpu_convert) {
+			auto profile = _profiler_copy->track();
+			try {
+				// Smaller renditions sample the shared mip chain, so that downscaling never skips over input pixels.
+				bool scaled = (_scaler.get_source_width() != _scaler.get_target_width()) || (_scaler.get_source_height() != _scaler.get_target_height());
+				_gpu_convert->convert(_gpu_ladder->get(frame, scaled), vframe.get());
+			} catch (const std::exception& ex) {
+				DLOG_ERROR("Failed to convert frame on the GPU: %s", ex.what());
+				return false;
+			}
 		} else {
-			int res = _scaler.convert(reinterpret_cast<uint8_t**>(frame->data), reinterpret_cast<int*>(frame->linesize), 0, _context->height, vframe->data, vframe->linesize);
+			int res = _scaler.convert(reinterpret_cast<uint8_t**>(frame->data), reinterpret_cast<int*>(frame->linesize), 0, static_cast<int32_t>(_scaler.get_source_height()), vframe->data, vframe->linesize);
 			if (res <= 0) {
 				DLOG_ERROR("Failed to convert frame: %s (%" PRId32 ").", ::streamfx::ffmpeg::tools::get_error_description(res), res);
 				return false;
 			}
 		}
+
+		// Encoders sharing this frame get the same hints, as there is only one set of them.
+		apply_region_hints(vframe.get());
+
+		if (_frame_channel) {
+			_frame_channel->publish(frame, vframe.get());
+		}
 	}
+	vframe->pts = frame->pts;
 
 	if (!encode_avframe(vframe, packet, received_packet))
 		return false;
@@ -382,14 +723,18 @@ bool ffmpeg_instance::encode_video(uint32_t handle, int64_t pts, uint64_t lock_k
 		return false;
 	}
 
-	std::shared_ptr<AVFrame> vframe = pop_free_frame();
-	_hwinst->copy_from_obs(_context->hw_frames_ctx, handle, lock_key, next_key, vframe);
+	::streamfx::ffmpeg::pooled_frame vframe = pop_free_frame();
+	{
+		auto timing = _timing_upload.track();
+		_hwinst->copy_from_obs(_context->hw_frames_ctx, handle, lock_key, next_key, vframe.shared());
+	}
 
 	vframe->color_range     = _context->color_range;
 	vframe->colorspace      = _context->colorspace;
 	vframe->color_primaries = _context->color_primaries;
 	vframe->color_trc       = _context->color_trc;
 	vframe->pts             = pts;
+	apply_region_hints(vframe.get());
 
 	if (!encode_avframe(vframe, packet, received_packet))
 		return false;
@@ -402,40 +747,94 @@ bool ffmpeg_instance::encode_video(uint32_t handle, int64_t pts, uint64_t lock_k
 #endif
 }
 
+#ifdef D_ENCODER_TEXTURE2
+bool ffmpeg_instance::encode_video(struct encoder_texture* texture, int64_t pts, uint64_t lock_key, uint64_t* next_key, struct encoder_packet* packet, bool* received_packet)
+{
+	if ((_framerate_divisor > 1) && (pts % _framerate_divisor != 0)) {
+		*next_key = lock_key;
+		return true;
+	}
+
+	// Direct3D 11 still hands us a shared texture, only OpenGL needs the textures themselves.
+	if (texture->handle != GS_INVALID_HANDLE) {
+		return encode_video(texture->handle, pts, lock_key, next_key, packet, received_packet);
+	}
+
+	::streamfx::ffmpeg::pooled_frame vframe = pop_free_frame();
+	{
+		auto timing = _timing_upload.track();
+		_hwinst->copy_from_obs_textures(_context->hw_frames_ctx, texture->tex, vframe.shared());
+	}
+
+	vframe->color_range     = _context->color_range;
+	vframe->colorspace      = _context->colorspace;
+	vframe->color_primaries = _context->color_primaries;
+	vframe->color_trc       = _context->color_trc;
+	vframe->pts             = pts;
+	apply_region_hints(vframe.get());
+
+	if (!encode_avframe(vframe, packet, received_packet))
+		return false;
+
+	*next_key = lock_key;
+
+	return true;
+}
+#endif
+
 void ffmpeg_instance::initialize_sw(obs_data_t* settings)
 {
 	// Initialize Video Encoding
 	auto voi = video_output_get_info(obs_encoder_video(_self));
 
 	// Figure out a suitable pixel format to convert to if necessary.
-	AVPixelFormat pix_fmt_source = ::streamfx::ffmpeg::tools::obs_videoformat_to_avpixelformat(voi->format);
+	AVPixelFormat pix_fmt_output = ::streamfx::ffmpeg::tools::obs_videoformat_to_avpixelformat(voi->format);
 	AVPixelFormat pix_fmt_target = AV_PIX_FMT_NONE;
 	{
 		if (_codec->pix_fmts) {
-			pix_fmt_target = ::streamfx::ffmpeg::tools::get_least_lossy_format(_codec->pix_fmts, pix_fmt_source);
+			pix_fmt_target = ::streamfx::ffmpeg::tools::get_least_lossy_format(_codec->pix_fmts, pix_fmt_output);
 		} else { // If there are no supported formats, just pass in the current one.
-			pix_fmt_target = pix_fmt_source;
+			pix_fmt_target = pix_fmt_output;
 		}
 
 		if (_handler) // Allow Handler to override the automatic color format for sanity reasons.
 			_handler->override_colorformat(this->_factory, this, settings, pix_fmt_target);
 	}
 
+	// Ask OBS for the format the codec wants if its GPU conversion can produce it, which get_video_info() passes on.
+	// Only formats it can't produce are still converted here.
+	AVPixelFormat pix_fmt_source = pix_fmt_output;
+	if ((pix_fmt_target != pix_fmt_output) && ::streamfx::ffmpeg::tools::can_obs_convert_to(pix_fmt_target)) {
+		pix_fmt_source = pix_fmt_target;
+	}
+	DLOG_INFO("[%s]   Input Format: %s from OBS, %s for the codec, converted by %s", _codec->name, ::streamfx::ffmpeg::tools::get_pixel_format_name(pix_fmt_output), ::streamfx::ffmpeg::tools::get_pixel_format_name(pix_fmt_target), (pix_fmt_source == pix_fmt_target) ? "OBS" : "StreamFX");
+
 	// Setup from OBS information.
 	::streamfx::ffmpeg::tools::context_setup_from_obs(voi, _context);
 
 	// Override with other information.
-	_context->width   = static_cast<int>(obs_encoder_get_width(_self));
-	_context->height  = static_cast<int>(obs_encoder_get_height(_self));
-	_context->pix_fmt = pix_fmt_target;
+	uint32_t source_width  = obs_encoder_get_width(_self);
+	uint32_t source_height = obs_encoder_get_height(_self);
+	_context->width        = static_cast<int>(source_width);
+	_context->height       = static_cast<int>(source_height);
+	_context->pix_fmt      = pix_fmt_target;
+
+	// Encode a smaller rendition of the full frame, letting several encoders share one input at different sizes.
+	if (int64_t rendition = std::clamp<int64_t>(obs_data_get_int(settings, ST_KEY_FFMPEG_RENDITION), 1, rendition_full); rendition != rendition_full) {
+		// Chroma subsampling needs even sizes.
+		_context->width  = std::max(static_cast<int>((source_width * rendition / rendition_full) & ~1ull), 2);
+		_context->height = std::max(static_cast<int>((source_height * rendition / rendition_full) & ~1ull), 2);
+	}
+	DLOG_INFO("[%s]   Rendition: %" PRId32 "x%" PRId32 " from %" PRIu32 "x%" PRIu32, _codec->name, _context->width, _context->height, source_width, source_height);
 
-	_scaler.set_source_size(static_cast<uint32_t>(_context->width), static_cast<uint32_t>(_context->height));
+	_scaler.set_source_size(source_width, source_height);
 	_scaler.set_source_color(_context->color_range == AVCOL_RANGE_JPEG, _context->colorspace);
 	_scaler.set_source_format(pix_fmt_source);
 
 	_scaler.set_target_size(static_cast<uint32_t>(_context->width), static_cast<uint32_t>(_context->height));
 	_scaler.set_target_color(_context->color_range == AVCOL_RANGE_JPEG, _context->colorspace);
 	_scaler.set_target_format(pix_fmt_target);
+	_scaler.set_slices(static_cast<std::size_t>(std::max<int64_t>(obs_data_get_int(settings, ST_KEY_FFMPEG_CONVERTSLICES), 0)));
 
 	// Create Scaler
 	if (!_scaler.initialize(SWS_SINC | SWS_FULL_CHR_H_INT | SWS_FULL_CHR_H_INP | SWS_ACCURATE_RND | SWS_BITEXACT)) {
@@ -443,20 +842,43 @@ void ffmpeg_instance::initialize_sw(obs_data_t* settings)
 		sstr << "Initializing scaler failed for conversion from '" << ::streamfx::ffmpeg::tools::get_pixel_format_name(_scaler.get_source_format()) << "' to '" << ::streamfx::ffmpeg::tools::get_pixel_format_name(_scaler.get_target_format()) << "' with color space '" << ::streamfx::ffmpeg::tools::get_color_space_name(_scaler.get_source_colorspace()) << "' and " << (_scaler.is_source_full_range() ? "full" : "partial") << " range.";
 		throw std::runtime_error(sstr.str());
 	}
+	DLOG_INFO("[%s]   Conversion Slices: %zu", _codec->name, _scaler.get_slices());
+
+	// Optionally convert on the GPU instead, so only the subsampled planes need to be read back.
+	if (obs_data_get_bool(settings, ST_KEY_FFMPEG_GPUCONVERT) && ::streamfx::ffmpeg::gpu_convert::is_supported(pix_fmt_source, pix_fmt_target)) {
+		try {
+			_gpu_convert = std::make_unique<::streamfx::ffmpeg::gpu_convert>(_scaler.get_target_width(), _scaler.get_target_height(), pix_fmt_source, pix_fmt_target, _scaler.get_target_colorspace(), _scaler.is_target_full_range());
+			_gpu_ladder  = ::streamfx::ffmpeg::gpu_ladder::subscribe(obs_encoder_video(_self), source_width, source_height, ::streamfx::ffmpeg::gpu_convert::get_input_format(pix_fmt_source));
+		} catch (const std::exception& ex) {
+			DLOG_WARNING("[%s] Failed to set up GPU conversion, falling back to software: %s", _codec->name, ex.what());
+			_gpu_convert.reset();
+			_gpu_ladder.reset();
+		}
+	}
+	DLOG_INFO("[%s]   GPU Conversion: %s", _codec->name, _gpu_convert ? "Enabled" : "Disabled");
 }
 
 void ffmpeg_instance::initialize_hw(obs_data_t*)
 {
-#ifndef D_PLATFORM_WINDOWS
-	throw std::runtime_error("OBS Studio currently does not support zero copy encoding for this platform.");
-#else
 	// Initialize Video Encoding
 	const video_output_info* voi = video_output_get_info(obs_encoder_video(_self));
 
+	// Not every hardware encoder can consume every kind of hardware frame.
+	AVPixelFormat hw_format = _hwinst->get_pixel_format();
+	{
+		bool supported = false;
+		for (auto fmt = _codec->pix_fmts; fmt && (*fmt != AV_PIX_FMT_NONE); fmt++) {
+			supported |= (*fmt == hw_format);
+		}
+		if (!supported) {
+			throw std::runtime_error("Encoder does not support frames from this hardware API, falling back to software.");
+		}
+	}
+
 	// Apply pixel format settings.
 	::streamfx::ffmpeg::tools::context_setup_from_obs(voi, _context);
 	_context->sw_pix_fmt = _context->pix_fmt;
-	_context->pix_fmt    = AV_PIX_FMT_D3D11;
+	_context->pix_fmt    = hw_format;
 
 	// Try to create a hardware context.
 	_context->hw_device_ctx = _hwinst->create_device_context();
@@ -477,37 +899,33 @@ void ffmpeg_instance::initialize_hw(obs_data_t*)
 		int len = snprintf(buffer.data(), buffer.size(), "Failed initialize hardware context: %s (%" PRIu32 ")", ::streamfx::ffmpeg::tools::get_error_description(res), res);
 		throw std::runtime_error(std::string(buffer.data(), buffer.data() + len));
 	}
-#endif
 }
 
-void ffmpeg_instance::push_free_frame(std::shared_ptr<AVFrame> frame)
+void ffmpeg_instance::create_frame_pool()
 {
-	auto now = std::chrono::high_resolution_clock::now();
-	if (_free_frames.size() > 0) {
-		if ((now - _free_frames_last_used) < std::chrono::seconds(1)) {
-			_free_frames.push(frame);
-		}
-	} else {
-		_free_frames.push(frame);
-		_free_frames_last_used = std::chrono::high_resolution_clock::now();
+	// Frames are in flight while they wait for the worker, while libavcodec holds on to them for B-Frames, Look-Ahead
+	// or its own delay, and while we fill them.
+	constexpr std::size_t headroom = 2;
+	std::size_t           lag      = static_cast<size_t>(std::max<int>(_context->delay, 0));
+	if (_handler) {
+		lag = _handler->get_frame_lag(_factory, this);
 	}
-}
+	std::size_t capacity = _lag_in_frames + lag + headroom;
+	DLOG_INFO("[%s]   Frame Pool: %zu frames (%zu lagging, %zu held by the encoder)", _codec->name, capacity, _lag_in_frames, lag);
 
-std::shared_ptr<AVFrame> ffmpeg_instance::pop_free_frame()
-{
-	std::shared_ptr<AVFrame> frame;
-	if (_free_frames.size() > 0) {
-		// Re-use existing frames first.
-		frame = _free_frames.top();
-		_free_frames.pop();
+	if (_hwinst) {
+		// Allow copies for every lagging frame to be in flight before waiting on the GPU.
+		_hwinst->set_pipeline_depth(_lag_in_frames + headroom);
+		_frame_pool = std::make_unique<::streamfx::ffmpeg::frame_pool>(capacity, [this]() { return _hwinst->allocate_frame(_context->hw_frames_ctx); });
 	} else {
-		if (_hwinst) {
-			frame = _hwinst->allocate_frame(_context->hw_frames_ctx);
-		} else {
-			frame = std::shared_ptr<AVFrame>(av_frame_alloc(), [](AVFrame* frame) {
+		_frame_pool = std::make_unique<::streamfx::ffmpeg::frame_pool>(capacity, [this]() {
+			auto frame = std::shared_ptr<AVFrame>(av_frame_alloc(), [](AVFrame* frame) {
 				av_frame_unref(frame);
 				av_frame_free(&frame);
 			});
+			if (!frame) {
+				throw std::bad_alloc();
+			}
 
 			frame->width  = _context->width;
 			frame->height = _context->height;
@@ -517,22 +935,155 @@ std::shared_ptr<AVFrame> ffmpeg_instance::pop_free_frame()
 			if (res < 0) {
 				throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
 			}
+
+			return frame;
+		});
+	}
+	DLOG_INFO("[%s]   Frame Pool: %zu frames", _codec->name, capacity);
+}
+
+::streamfx::ffmpeg::pooled_frame ffmpeg_instance::pop_free_frame()
+{
+	uint64_t misses = _frame_pool->misses();
+	auto     frame  = _frame_pool->acquire();
+
+	// Allocating during startup is expected while the encoder settles, but afterwards it causes hitches.
+	if (_frame_pool->misses() != misses) {
+		int64_t fps = (_context->time_base.num > 0) ? (_context->time_base.den / _context->time_base.num) : 0;
+		if (static_cast<int64_t>(_sent_frames) > fps) {
+			if (_late_allocations == 0) {
+				DLOG_WARNING("[%s] Frame Pool ran dry after the first second and had to allocate frames on demand, the encoder holds on to more frames than expected.", _codec->name);
+			}
+			_late_allocations++;
 		}
 	}
 
 	return frame;
 }
 
-void ffmpeg_instance::push_used_frame(std::shared_ptr<AVFrame> frame)
+void ffmpeg_instance::apply_region_hints(AVFrame* frame)
 {
-	_used_frames.push(frame);
+	// Pooled frames may still carry the regions of the last time they were used.
+	av_frame_remove_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST);
+
+	// Nothing changed, so there is nothing worth spending bits on anywhere. Keyframes in this time get the higher QP
+	// too, which is why the offset stays moderate.
+	if (_static_active) {
+		if (AVFrameSideData* sd = av_frame_new_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST, sizeof(AVRegionOfInterest)); sd) {
+			auto roi       = reinterpret_cast<AVRegionOfInterest*>(sd->data);
+			roi->self_size = sizeof(AVRegionOfInterest);
+			roi->left      = 0;
+			roi->right     = frame->width;
+			roi->top       = 0;
+			roi->bottom    = frame->height;
+			roi->qoffset   = av_make_q(1, 2);
+		}
+		return;
+	}
+
+	if (!_region_hints) {
+		return;
+	}
+
+	// Hints older than a few frames describe a picture that is long gone.
+	auto regions = _region_hints->collect(250000000ull);
+	if (regions.empty()) {
+		return;
+	}
+
+	// One more region covers the whole frame, to take the bits away from what nobody looks at. Encoders use the
+	// first region that covers a block, so it has to come last.
+	AVFrameSideData* sd = av_frame_new_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST, sizeof(AVRegionOfInterest) * (regions.size() + 1));
+	if (!sd) {
+		return;
+	}
+
+	auto        rois  = reinterpret_cast<AVRegionOfInterest*>(sd->data);
+	std::size_t count = 0;
+	for (auto& region : regions) {
+		AVRegionOfInterest& roi = rois[count];
+		roi.self_size           = sizeof(AVRegionOfInterest);
+		roi.left                = static_cast<int>(std::clamp<float>(region.x, 0.f, 1.f) * static_cast<float>(frame->width));
+		roi.right               = static_cast<int>(std::clamp<float>(region.x + region.width, 0.f, 1.f) * static_cast<float>(frame->width));
+		roi.top                 = static_cast<int>(std::clamp<float>(region.y, 0.f, 1.f) * static_cast<float>(frame->height));
+		roi.bottom              = static_cast<int>(std::clamp<float>(region.y + region.height, 0.f, 1.f) * static_cast<float>(frame->height));
+		// Negative offsets mean a lower QP, a full emphasis is roughly 6 QP below the rest on most encoders.
+		roi.qoffset = av_make_q(-static_cast<int>(std::lroundf(std::clamp<float>(region.emphasis, -1.f, 1.f) * 100.f)), 800);
+		if ((roi.right > roi.left) && (roi.bottom > roi.top)) {
+			count++;
+		}
+	}
+	if (count == 0) {
+		av_frame_remove_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST);
+		return;
+	}
+
+	AVRegionOfInterest& background = rois[count];
+	background.self_size           = sizeof(AVRegionOfInterest);
+	background.left                = 0;
+	background.right               = frame->width;
+	background.top                 = 0;
+	background.bottom              = frame->height;
+	background.qoffset             = av_make_q(1, 16);
+	count++;
+
+	// Only what was filled in counts.
+	sd->size = sizeof(AVRegionOfInterest) * count;
 }
 
-std::shared_ptr<AVFrame> ffmpeg_instance::pop_used_frame()
+bool ffmpeg_instance::is_static(struct encoder_frame* frame)
 {
-	auto frame = _used_frames.front();
-	_used_frames.pop();
-	return frame;
+	if (!_static_hints) {
+		return false;
+	}
+
+	// Hash every few rows of every plane, a word at a time.
+	AVPixelFormat format = _scaler.get_source_format();
+	int           h_chroma_shift, v_chroma_shift;
+	av_pix_fmt_get_chroma_sub_sample(format, &h_chroma_shift, &v_chroma_shift);
+	std::size_t planes = std::min<std::size_t>(static_cast<std::size_t>(std::max(av_pix_fmt_count_planes(format), 0)), MAX_AV_PLANES);
+	uint64_t    hash   = 0xcbf29ce484222325ull;
+	for (std::size_t idx = 0; idx < planes; idx++) {
+		if (!frame->data[idx]) {
+			continue;
+		}
+
+		std::size_t rows = static_cast<std::size_t>(_scaler.get_source_height()) >> (idx ? v_chroma_shift : 0);
+		std::size_t size = frame->linesize[idx];
+		for (std::size_t row = 0; row < rows; row += static_row_step) {
+			const uint8_t* data = frame->data[idx] + row * size;
+			std::size_t    pos  = 0;
+			for (; (pos + sizeof(uint64_t)) <= size; pos += sizeof(uint64_t)) {
+				uint64_t word;
+				std::memcpy(&word, data + pos, sizeof(uint64_t));
+				hash = (hash ^ word) * 0x100000001b3ull;
+			}
+			for (; pos < size; pos++) {
+				hash = (hash ^ data[pos]) * 0x100000001b3ull;
+			}
+		}
+	}
+
+	if (hash != _static_hash) {
+		_static_hash   = hash;
+		_static_frames = 0;
+		return false;
+	}
+	_static_frames++;
+	return _static_frames >= static_after;
+}
+
+void ffmpeg_instance::push_used_frame(::streamfx::ffmpeg::pooled_frame frame)
+{
+	_used_frames.push(std::move(frame));
+}
+
+void ffmpeg_instance::pop_used_frame()
+{
+	// Dropping the reference returns the frame to the pool.
+	if (!_used_frames.empty()) {
+		_used_frames.pop();
+	}
 }
 
 bool ffmpeg_instance::get_extra_data(uint8_t** data, size_t* size)
@@ -569,6 +1120,7 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 
 	av_packet_unref(_packet.get());
 
+	auto start = std::chrono::steady_clock::now();
 	{
 		auto gctx = streamfx::obs::gs::context();
 		res       = avcodec_receive_packet(_context, _packet.get());
@@ -576,7 +1128,18 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 	if (res != 0) {
 		return res;
 	}
+	_timing_receive.track(std::chrono::steady_clock::now() - start);
+
+	process_packet(_packet.get(), packet, received_packet);
+
+	// Release the oldest frame back into the pool.
+	pop_used_frame();
+
+	return res;
+}
 
+void ffmpeg_instance::process_packet(AVPacket* pkt, struct encoder_packet* packet, bool* received_packet)
+{
 	if (!_have_first_frame) {
 		if (_codec->id == AV_CODEC_ID_H264) {
 			uint8_t*    tmp_packet;
@@ -584,7 +1147,7 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 			uint8_t*    tmp_sei;
 			std::size_t sz_packet, sz_header, sz_sei;
 
-			obs_extract_avc_headers(_packet->data, static_cast<size_t>(_packet->size), &tmp_packet, &sz_packet, &tmp_header, &sz_header, &tmp_sei, &sz_sei);
+			obs_extract_avc_headers(pkt->data, static_cast<size_t>(pkt->size), &tmp_packet, &sz_packet, &tmp_header, &sz_header, &tmp_sei, &sz_sei);
 
 			if (sz_header) {
 				_extra_data.resize(sz_header);
@@ -604,7 +1167,7 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 			bfree(tmp_header);
 			bfree(tmp_sei);
 		} else if (_codec->id == AV_CODEC_ID_HEVC) {
-			hevc::extract_header_sei(_packet->data, static_cast<size_t>(_packet->size), _extra_data, _sei_data);
+			hevc::extract_header_sei(pkt->data, static_cast<size_t>(pkt->size), _extra_data, _sei_data);
 		} else if (_context->extradata != nullptr) {
 			_extra_data.resize(static_cast<size_t>(_context->extradata_size));
 			std::memcpy(_extra_data.data(), _context->extradata, static_cast<size_t>(_context->extradata_size));
@@ -619,19 +1182,19 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 
 	// Build packet for use in OBS.
 	packet->type     = OBS_ENCODER_VIDEO;
-	packet->pts      = _packet->pts;
-	packet->dts      = _packet->dts;
-	packet->data     = _packet->data;
-	packet->size     = static_cast<size_t>(_packet->size);
-	packet->keyframe = !!(_packet->flags & AV_PKT_FLAG_KEY);
+	packet->pts      = pkt->pts;
+	packet->dts      = pkt->dts;
+	packet->data     = pkt->data;
+	packet->size     = static_cast<size_t>(pkt->size);
+	packet->keyframe = !!(pkt->flags & AV_PKT_FLAG_KEY);
 	*received_packet = true;
 
 	// Figure out priority and drop_priority.
 	// In theory, this is done by OBS, but its not doing a great job.
 	packet->priority      = packet->keyframe ? 3 : 2;
 	packet->drop_priority = 3;
-	for (size_t idx = 0, edx = static_cast<size_t>(_packet->side_data_elems); idx < edx; idx++) {
-		auto& side_data = _packet->side_data[idx];
+	for (size_t idx = 0, edx = static_cast<size_t>(pkt->side_data_elems); idx < edx; idx++) {
+		auto& side_data = pkt->side_data[idx];
 		if (side_data.type == AV_PKT_DATA_NEW_EXTRADATA) {
 			_extra_data.resize(side_data.size);
 			std::memcpy(_extra_data.data(), side_data.data, side_data.size);
@@ -640,7 +1203,7 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 			switch (side_data.data[sizeof(uint32_t)]) {
 			case AV_PICTURE_TYPE_I: // I-Frame
 			case AV_PICTURE_TYPE_SI: // Switching I-Frame
-				if (_packet->flags & AV_PKT_FLAG_KEY) {
+				if (pkt->flags & AV_PKT_FLAG_KEY) {
 					// Recovery only via IDR-Frame.
 					packet->priority      = 3; // OBS_NAL_PRIORITY_HIGHEST
 					packet->drop_priority = 2; // OBS_NAL_PRIORITY_HIGH
@@ -674,29 +1237,97 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 			}
 		}
 	}
-
-	// Push free frame back into pool.
-	push_free_frame(pop_used_frame());
-
-	return res;
 }
 
-int ffmpeg_instance::send_frame(std::shared_ptr<AVFrame> const frame)
+int ffmpeg_instance::send_frame(::streamfx::ffmpeg::pooled_frame const frame)
 {
 	int res = 0;
 	{
-		auto gctx = streamfx::obs::gs::context();
-		res       = avcodec_send_frame(_context, frame.get());
+		auto timing = _timing_send.track();
+		auto gctx   = streamfx::obs::gs::context();
+		res         = avcodec_send_frame(_context, frame.get());
 	}
 	if (res == 0) {
 		push_used_frame(frame);
+		_sent_frames++;
 	}
 
 	return res;
 }
 
-bool ffmpeg_instance::encode_avframe(std::shared_ptr<AVFrame> frame, encoder_packet* packet, bool* received_packet)
+bool ffmpeg_instance::encode_avframe(::streamfx::ffmpeg::pooled_frame frame, encoder_packet* packet, bool* received_packet)
+{
+	if (uint64_t now = os_gettime_ns(); (now - _timing_reported) >= timing_report_interval) {
+		_timing_reported = now;
+		log_timings();
+	}
+
+	if (!_overload_enabled) {
+		return encode_avframe_direct(frame, packet, received_packet);
+	}
+
+	if (overload_should_drop()) {
+		// Not sending the frame leaves a gap in the timestamps, which is how encoders and OBS learn of the drop.
+		return true;
+	}
+
+	uint64_t begin  = os_gettime_ns();
+	bool     result = encode_avframe_direct(frame, packet, received_packet);
+	overload_track(static_cast<double_t>(os_gettime_ns() - begin) / 1000000000.);
+	return result;
+}
+
+bool ffmpeg_instance::overload_should_drop()
+{
+	if (!_overload_active) {
+		return false;
+	}
+
+	// Only the share of frames we can't keep up with is dropped, spread out evenly. Never more than every other
+	// frame, so that motion doesn't fall apart, and never two in a row.
+	double_t interval = av_q2d(_context->time_base);
+	double_t ratio    = std::clamp<double_t>(1. - (interval / _overload_cost), 0., 0.5);
+	_overload_credit += ratio;
+	if (_overload_credit < 1.) {
+		return false;
+	}
+
+	_overload_credit -= 1.;
+	_overload_episode++;
+	_overload_dropped++;
+	return true;
+}
+
+void ffmpeg_instance::overload_track(double_t cost)
 {
+	// Follow changes within about a second, without reacting to a single slow frame.
+	_overload_cost = (_overload_cost <= 0.) ? cost : (_overload_cost * 0.95 + cost * 0.05);
+
+	double_t interval = av_q2d(_context->time_base);
+	if (!_overload_active && (_overload_cost > (interval * overload_enter)) && (_sent_frames > _lag_in_frames)) {
+		_overload_active  = true;
+		_overload_credit  = 0.;
+		_overload_episode = 0;
+		DLOG_WARNING("[%s] Overload: Encoding takes %.3f ms for frames lasting %.3f ms, dropping %.1f%% of frames until it catches up.", _codec->name, _overload_cost * 1000., interval * 1000., std::clamp<double_t>(1. - (interval / _overload_cost), 0., 0.5) * 100.);
+	} else if (_overload_active && (_overload_cost < (interval * overload_leave))) {
+		_overload_active = false;
+		DLOG_INFO("[%s] Overload: Caught up again after dropping %" PRIu64 " frames, encoding takes %.3f ms for frames lasting %.3f ms.", _codec->name, _overload_episode, _overload_cost * 1000., interval * 1000.);
+	}
+}
+
+bool ffmpeg_instance::encode_avframe_direct(::streamfx::ffmpeg::pooled_frame frame, encoder_packet* packet, bool* received_packet)
+{
+	if (_async_input) {
+		return encode_avframe_async(frame, packet, received_packet);
+	}
+
+	if (_standby && (_standby_open.wait_for(std::chrono::seconds(0)) == std::future_status::ready)) {
+		swap_standby();
+	}
+	if (!_standby_output.empty()) {
+		return encode_avframe_standby(frame, packet, received_packet);
+	}
+
 	bool sent_frame  = false;
 	bool recv_packet = false;
 	bool should_lag  = (_sent_frames >= _lag_in_frames);
@@ -763,151 +1394,335 @@ bool ffmpeg_instance::encode_avframe(std::shared_ptr<AVFrame> frame, encoder_pac
 		}
 	}
 
-	if (!sent_frame)
-		push_free_frame(frame);
+	return true;
+}
+
+bool ffmpeg_instance::encode_avframe_async(::streamfx::ffmpeg::pooled_frame frame, encoder_packet* packet, bool* received_packet)
+{
+	if (_async_failed) {
+		return false;
+	}
+
+	{ // Hand the frame to the worker, and wait for space if it can't keep up.
+		std::unique_lock<std::mutex> ul(_async_lock);
+		while (!_async_input->try_push(frame)) {
+			if (_async_failed) {
+				return false;
+			}
+			_async_cv.wait_for(ul, std::chrono::milliseconds(1));
+		}
+	}
+	_async_cv.notify_all();
+
+	// Return the oldest finished packet, if there is any. The previous packet is released here, as OBS is
+	// guaranteed to be done with it by now.
+	std::unique_lock<std::mutex> ul(_async_lock);
+	if (!_async_output.empty()) {
+		_async_packet = _async_output.front();
+		_async_output.pop_front();
+		ul.unlock();
+
+		process_packet(_async_packet.get(), packet, received_packet);
+	}
 
 	return true;
 }
 
-bool ffmpeg_instance::is_hardware_encode()
+bool ffmpeg_instance::async_drain()
 {
-	return _hwinst != nullptr;
+	bool drained_any = false;
+
+	while (true) {
+		auto pkt = std::shared_ptr<AVPacket>(av_packet_alloc(), [](AVPacket* ptr) { av_packet_free(&ptr); });
+		if (!pkt) {
+			throw std::bad_alloc();
+		}
+
+		int  res   = 0;
+		auto start = std::chrono::steady_clock::now();
+		{
+			auto gctx = streamfx::obs::gs::context();
+			res       = avcodec_receive_packet(_context, pkt.get());
+		}
+		if ((res == AVERROR(EAGAIN)) || (res == AVERROR(EOF))) {
+			break;
+		} else if (res < 0) {
+			DLOG_ERROR("[%s] Failed to receive packet: %s (%" PRId32 ").", _codec->name, ::streamfx::ffmpeg::tools::get_error_description(res), res);
+			_async_failed = true;
+			break;
+		}
+		_timing_receive.track(std::chrono::steady_clock::now() - start);
+
+		pop_used_frame();
+		drained_any = true;
+
+		std::unique_lock<std::mutex> ul(_async_lock);
+		_async_output.push_back(pkt);
+	}
+
+	return drained_any;
 }
 
-const AVCodec* ffmpeg_instance::get_avcodec()
+void ffmpeg_instance::async_work()
 {
-	return _codec;
+	while (!_async_stop && !_async_failed) {
+		::streamfx::ffmpeg::pooled_frame frame;
+		if (!_async_input->try_pop(frame)) {
+			std::unique_lock<std::mutex> ul(_async_lock);
+			_async_cv.wait_for(ul, std::chrono::milliseconds(10), [this]() { return _async_stop || !_async_input->empty(); });
+			continue;
+		}
+		_async_cv.notify_all();
+
+		// Keep sending the frame, draining the encoder whenever it asks us to.
+		while (!_async_stop && !_async_failed) {
+			int res = send_frame(frame);
+			if (res == 0) {
+				break;
+			} else if (res == AVERROR(EAGAIN)) {
+				if (!async_drain()) {
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+			} else {
+				DLOG_ERROR("[%s] Failed to encode frame: %s (%" PRId32 ").", _codec->name, ::streamfx::ffmpeg::tools::get_error_description(res), res);
+				_async_failed = true;
+			}
+		}
+
+		async_drain();
+	}
 }
 
-AVCodecContext* ffmpeg_instance::get_avcodeccontext()
+bool ffmpeg_instance::prepare_standby(obs_data_t* settings)
 {
-	return _context;
+	// Only the latest settings matter.
+	discard_standby();
+
+	if (_hwinst || ::streamfx::ffmpeg::tools::can_hardware_encode(_codec)) {
+		if (standby_hardware_sessions.fetch_add(1) > 0) {
+			standby_hardware_sessions.fetch_sub(1);
+			DLOG_WARNING("[%s] Another encoder is already preparing a warm standby, applying the settings to the running encoder instead.", _codec->name);
+			return false;
+		}
+		_standby_session = true;
+	}
+
+	AVCodecContext* context = avcodec_alloc_context3(_codec);
+	if (!context) {
+		DLOG_ERROR("[%s] Failed to create context for the warm standby.", _codec->name);
+		discard_standby();
+		return false;
+	}
+
+	// The video itself doesn't change, so neither does anything that was set up from it.
+	context->width                  = _context->width;
+	context->height                 = _context->height;
+	context->pix_fmt                = _context->pix_fmt;
+	context->sw_pix_fmt             = _context->sw_pix_fmt;
+	context->color_range            = _context->color_range;
+	context->colorspace             = _context->colorspace;
+	context->color_primaries        = _context->color_primaries;
+	context->color_trc              = _context->color_trc;
+	context->chroma_sample_location = _context->chroma_sample_location;
+	context->field_order            = _context->field_order;
+	context->sample_aspect_ratio    = _context->sample_aspect_ratio;
+	context->time_base              = _context->time_base;
+	context->framerate              = _context->framerate;
+	context->ticks_per_frame        = _context->ticks_per_frame;
+	context->flags                  = _context->flags;
+	context->flags2                 = _context->flags2;
+	if (_context->hw_device_ctx) {
+		context->hw_device_ctx = av_buffer_ref(_context->hw_device_ctx);
+	}
+	if (_context->hw_frames_ctx) {
+		context->hw_frames_ctx = av_buffer_ref(_context->hw_frames_ctx);
+	}
+	if (_packet_pool) {
+		_packet_pool->attach(context);
+	}
+
+	// Handlers configure whatever get_avcodeccontext() returns. update() is only ever called in between two frames, so
+	// nothing else looks at the context while they do.
+	std::swap(_context, context);
+	try {
+		update(settings);
+	} catch (const std::exception& ex) {
+		std::swap(_context, context);
+		DLOG_ERROR("[%s] Failed to configure the warm standby: %s", _codec->name, ex.what());
+		avcodec_free_context(&context);
+		discard_standby();
+		return false;
+	}
+	std::swap(_context, context);
+
+	// Opening is what takes long, creating the encoder session and its buffers. Hardware devices take the graphics
+	// context themselves whenever they need it, so there is no need to hold it here.
+	_standby      = context;
+	_standby_open = std::async(std::launch::async, [this, context]() { return avcodec_open2(context, _codec, NULL); });
+	DLOG_INFO("[%s] Preparing a warm standby with the new settings.", _codec->name);
+	return true;
 }
 
-void ffmpeg_instance::parse_ffmpeg_commandline(std::string_view text)
+void ffmpeg_instance::discard_standby()
 {
-	// Steps to properly parse a command line:
-	// 1. Split by space and package by quotes.
-	// 2. Parse each resulting option individually.
-
-	// First, we split by space and of course respect quotes while doing so.
-	// That means that "-foo= bar" is stored as std::string("-foo= bar"),
-	//  and things like -foo="bar" is stored as std::string("-foo=\"bar\"").
-	// However "-foo"=bar" -foo2=bar" is stored as std::string("-foo=bar -foo2=bar")
-	//  because the quote was not escaped.
-	std::list<std::string> opts;
-	std::stringstream      opt_stream{std::ios_base::in | std::ios_base::out | std::ios_base::binary};
-	std::stack<char>       quote_stack;
-	for (std::size_t p = 0; p <= text.size(); p++) {
-		char here = p < text.size() ? text.at(p) : 0;
-
-		if (here == '\\') {
-			std::size_t p2 = p + 1;
-			if (p2 < text.size()) {
-				char here2 = text.at(p2);
-				if (isdigit(here2)) { // Octal
-					// Not supported yet.
-					p++;
-				} else if (here2 == 'x') { // Hexadecimal
-					// Not supported yet.
-					p += 3;
-				} else if (here2 == 'u') { // 4 or 8 wide Unicode.
-					// Not supported yet.
-				} else if (here2 == 'a') {
-					opt_stream << '\a';
-					p++;
-				} else if (here2 == 'b') {
-					opt_stream << '\b';
-					p++;
-				} else if (here2 == 'f') {
-					opt_stream << '\f';
-					p++;
-				} else if (here2 == 'n') {
-					opt_stream << '\n';
-					p++;
-				} else if (here2 == 'r') {
-					opt_stream << '\r';
-					p++;
-				} else if (here2 == 't') {
-					opt_stream << '\t';
-					p++;
-				} else if (here2 == 'v') {
-					opt_stream << '\v';
-					p++;
-				} else if (here2 == '\\') {
-					opt_stream << '\\';
-					p++;
-				} else if (here2 == '\'') {
-					opt_stream << '\'';
-					p++;
-				} else if (here2 == '"') {
-					opt_stream << '"';
-					p++;
-				} else if (here2 == '?') {
-					opt_stream << '\?';
-					p++;
-				}
-			}
-		} else if ((here == '\'') || (here == '"')) {
-			if (quote_stack.size() > 1) {
-				opt_stream << here;
-			}
-			if (quote_stack.size() == 0) {
-				quote_stack.push(here);
-			} else if (quote_stack.top() == here) {
-				quote_stack.pop();
-			} else {
-				quote_stack.push(here);
+	if (_standby_open.valid()) {
+		_standby_open.wait();
+		_standby_open = {};
+	}
+
+	if (_standby) {
+		auto gctx = streamfx::obs::gs::context();
+		avcodec_free_context(&_standby);
+	}
+
+	if (_standby_session) {
+		standby_hardware_sessions.fetch_sub(1);
+		_standby_session = false;
+	}
+}
+
+bool ffmpeg_instance::swap_standby()
+{
+	if (int res = _standby_open.get(); res < 0) {
+		DLOG_ERROR("[%s] Failed to open the warm standby, keeping the previous settings: %s (%" PRId32 ").", _codec->name, ::streamfx::ffmpeg::tools::get_error_description(res), res);
+		discard_standby();
+		return false;
+	}
+
+	// Decode timestamps must keep increasing across the switch, which they can't if the new context reorders more.
+	if (_standby->has_b_frames > _context->has_b_frames) {
+		DLOG_WARNING("[%s] New settings reorder more frames than the previous ones, which requires restarting the encoder.", _codec->name);
+		discard_standby();
+		return false;
+	}
+
+	{ // Everything the previous context still holds goes out first, so the new one starts on a keyframe boundary.
+		auto gctx = streamfx::obs::gs::context();
+		avcodec_send_frame(_context, nullptr);
+		while (true) {
+			auto pkt = std::shared_ptr<AVPacket>(av_packet_alloc(), [](AVPacket* ptr) { av_packet_free(&ptr); });
+			if (!pkt) {
+				throw std::bad_alloc();
 			}
-		} else if ((here == 0) || ((here == ' ') && (quote_stack.size() == 0))) {
-			std::string ropt = opt_stream.str();
-			if (ropt.size() > 0) {
-				opts.push_back(ropt);
-				opt_stream.str(std::string());
-				opt_stream.clear();
+			if (avcodec_receive_packet(_context, pkt.get()) < 0) {
+				break;
 			}
-		} else {
-			opt_stream << here;
+			pop_used_frame();
+			_standby_output.push_back(pkt);
 		}
+		avcodec_free_context(&_context);
+	}
+	while (!_used_frames.empty()) {
+		pop_used_frame();
 	}
 
-	// Now that we have a list of parameters as neatly grouped strings, and
-	//  have also dealt with escaping for the most part. We want to parse
-	//  an FFmpeg commandline option set here, so the first character in
-	//  the string must be a '-'.
-	for (const auto& opt : opts) {
-		// Skip empty options.
-		if (opt.size() == 0)
-			continue;
+	_context      = _standby;
+	_standby      = nullptr;
+	_standby_open = {};
+	discard_standby(); // The previous session is gone, so the extra one isn't extra anymore.
 
-		// Skip options that don't start with a '-'.
-		if (opt.at(0) != '-') {
-			DLOG_WARNING("Option '%s' is malformed, must start with a '-'.", opt.c_str());
-			continue;
+	DLOG_INFO("[%s] Switched to the warm standby, with %zu packets of the previous settings still queued.", _codec->name, _standby_output.size());
+	return true;
+}
+
+bool ffmpeg_instance::encode_avframe_standby(::streamfx::ffmpeg::pooled_frame frame, encoder_packet* packet, bool* received_packet)
+{
+	// The new context fills up while the packets of the previous one go out, one per frame as usual. As it doesn't
+	// reorder more than the previous one, the queue runs dry by the time it produces its own packets at full rate.
+	auto receive = [this]() {
+		auto pkt = std::shared_ptr<AVPacket>(av_packet_alloc(), [](AVPacket* ptr) { av_packet_free(&ptr); });
+		if (!pkt) {
+			throw std::bad_alloc();
 		}
 
-		// Skip options that don't contain a '='.
-		const char* cstr  = opt.c_str();
-		const char* eq_at = strchr(cstr, '=');
-		if (eq_at == nullptr) {
-			DLOG_WARNING("Option '%s' is malformed, must contain a '='.", opt.c_str());
-			continue;
+		int res = 0;
+		{
+			auto gctx = streamfx::obs::gs::context();
+			res       = avcodec_receive_packet(_context, pkt.get());
+		}
+		if (res == 0) {
+			pop_used_frame();
+			_standby_output.push_back(pkt);
+		}
+		return res;
+	};
+
+	int res = send_frame(frame);
+	while (res == AVERROR(EAGAIN)) {
+		if (int rres = receive(); (rres < 0) && (rres != AVERROR(EAGAIN))) {
+			DLOG_ERROR("[%s] Failed to receive packet: %s (%" PRId32 ").", _codec->name, ::streamfx::ffmpeg::tools::get_error_description(rres), rres);
+			return false;
 		}
+		res = send_frame(frame);
+	}
+	if (res < 0) {
+		DLOG_ERROR("[%s] Failed to encode frame: %s (%" PRId32 ").", _codec->name, ::streamfx::ffmpeg::tools::get_error_description(res), res);
+		return false;
+	}
+	while (receive() == 0) {
+	}
 
-		try {
-			std::string key   = opt.substr(1, static_cast<size_t>((eq_at - cstr) - 1));
-			std::string value = opt.substr(static_cast<size_t>((eq_at - cstr) + 1));
+	// The previous packet is released here, as OBS is guaranteed to be done with it by now.
+	_standby_packet = _standby_output.front();
+	_standby_output.pop_front();
+	process_packet(_standby_packet.get(), packet, received_packet);
 
-			int res = av_opt_set(_context, key.c_str(), value.c_str(), AV_OPT_SEARCH_CHILDREN);
-			if (res < 0) {
-				DLOG_WARNING("Option '%s' (key: '%s', value: '%s') encountered error: %s", opt.c_str(), key.c_str(), value.c_str(), ::streamfx::ffmpeg::tools::get_error_description(res));
-			}
-		} catch (const std::exception& ex) {
-			DLOG_ERROR("Option '%s' encountered exception: %s", opt.c_str(), ex.what());
+	return true;
+}
+
+void ffmpeg_instance::log_timings()
+{
+	auto log_stage = [this](const char* name, ::streamfx::util::histogram& stage) {
+		if (stage.count() == 0) {
+			return;
 		}
+		DLOG_INFO("[%s] Timing: %s took %.3f ms on average, %.3f ms 50th, %.3f ms 95th, %.3f ms 99th percentile over %" PRIu64 " calls.", _codec->name, name, stage.average_duration() / 1000000.0, static_cast<double_t>(stage.percentile(0.50).count()) / 1000000.0, static_cast<double_t>(stage.percentile(0.95).count()) / 1000000.0, static_cast<double_t>(stage.percentile(0.99).count()) / 1000000.0, stage.count());
+	};
+
+	log_stage("Convert", _timing_convert);
+	log_stage("Upload", _timing_upload);
+	log_stage("Send", _timing_send);
+	log_stage("Receive", _timing_receive);
+}
+
+void ffmpeg_instance::enumerate_timings(const std::function<void(const char*, const ::streamfx::util::histogram&)>& fn)
+{
+	encoder_instance::enumerate_timings(fn);
+	fn("convert", _timing_convert);
+	fn("upload", _timing_upload);
+	fn("send", _timing_send);
+	fn("receive", _timing_receive);
+}
+
+void ffmpeg_instance::enumerate_counters(const std::function<void(const char*, uint64_t)>& fn)
+{
+	if (_frame_pool) {
+		fn("frame_pool_hits", _frame_pool->hits());
+		fn("frame_pool_misses", _frame_pool->misses());
+	}
+	if (_frame_channel) {
+		fn("frames_shared", _frame_channel->shared());
+	}
+	if (_overload_enabled) {
+		fn("frames_dropped", _overload_dropped);
 	}
 }
 
+bool ffmpeg_instance::is_hardware_encode()
+{
+	return _hwinst != nullptr;
+}
+
+const AVCodec* ffmpeg_instance::get_avcodec()
+{
+	return _codec;
+}
+
+AVCodecContext* ffmpeg_instance::get_avcodeccontext()
+{
+	return _context;
+}
+
 ffmpeg_factory::ffmpeg_factory(ffmpeg_manager* manager, const AVCodec* codec) : _avcodec(codec)
 {
 	// Generate default identifier.
@@ -1001,6 +1816,15 @@ void ffmpeg_factory::get_defaults2(obs_data_t* settings)
 		obs_data_set_default_string(settings, ST_KEY_FFMPEG_CUSTOMSETTINGS, "");
 		obs_data_set_default_int(settings, ST_KEY_FFMPEG_THREADS, 0);
 		obs_data_set_default_int(settings, ST_KEY_FFMPEG_GPU, -1);
+		obs_data_set_default_bool(settings, ST_KEY_FFMPEG_ZEROCOPY, true);
+		obs_data_set_default_bool(settings, ST_KEY_FFMPEG_GPUCONVERT, false);
+		obs_data_set_default_int(settings, ST_KEY_FFMPEG_CONVERTSLICES, 0);
+		obs_data_set_default_int(settings, ST_KEY_FFMPEG_RENDITION, rendition_full);
+		obs_data_set_default_int(settings, ST_KEY_FFMPEG_ASYNCDEPTH, 0);
+		obs_data_set_default_bool(settings, ST_KEY_FFMPEG_STANDBY, false);
+		obs_data_set_default_bool(settings, ST_KEY_FFMPEG_REGIONHINTS, false);
+		obs_data_set_default_bool(settings, ST_KEY_FFMPEG_STATICHINTS, false);
+		obs_data_set_default_bool(settings, ST_KEY_FFMPEG_OVERLOAD, false);
 	}
 }
 
@@ -1026,6 +1850,36 @@ static bool modified_keyframes(obs_properties_t* props, obs_property_t*, obs_dat
 	}
 }
 
+bool ffmpeg_factory::modified_customsettings(void* priv, obs_properties_t* props, obs_property_t*, obs_data_t* settings) noexcept
+{
+	try {
+		auto self = reinterpret_cast<ffmpeg_factory*>(priv);
+		auto p    = obs_properties_get(props, ST_KEY_FFMPEG_CUSTOMSETTINGS_ERRORS);
+		if (!p) {
+			return false;
+		}
+
+		auto options = ::streamfx::ffmpeg::option_list::parse(obs_data_get_string(settings, ST_KEY_FFMPEG_CUSTOMSETTINGS), self->_avcodec);
+
+		std::stringstream sstr;
+		sstr << D_TRANSLATE(ST_I18N_FFMPEG_CUSTOMSETTINGS_ERRORS);
+		for (const auto& opt : options->options()) {
+			if (!opt.error.empty()) {
+				sstr << "\n-" << opt.key << ": " << opt.error;
+			}
+		}
+		obs_property_set_description(p, sstr.str().c_str());
+		obs_property_set_visible(p, options->has_errors());
+		return true;
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+		return false;
+	} catch (...) {
+		DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+		return false;
+	}
+}
+
 obs_properties_t* ffmpeg_factory::get_properties2(instance_t* data)
 {
 	obs_properties_t* props = obs_properties_create();
@@ -1077,12 +1931,64 @@ obs_properties_t* ffmpeg_factory::get_properties2(instance_t* data)
 
 		{ // Custom Settings
 			auto p = obs_properties_add_text(grp, ST_KEY_FFMPEG_CUSTOMSETTINGS, D_TRANSLATE(ST_I18N_FFMPEG_CUSTOMSETTINGS), obs_text_type::OBS_TEXT_DEFAULT);
+			obs_property_set_modified_callback2(p, modified_customsettings, this);
+		}
+		{ // Custom Settings Errors
+			auto p = obs_properties_add_text(grp, ST_KEY_FFMPEG_CUSTOMSETTINGS_ERRORS, D_TRANSLATE(ST_I18N_FFMPEG_CUSTOMSETTINGS_ERRORS), OBS_TEXT_INFO);
+			obs_property_text_set_info_type(p, OBS_TEXT_INFO_WARNING);
+			obs_property_set_visible(p, false);
+		}
+
+		if (!_handler || !_handler->is_hardware(this)) {
+			auto p = obs_properties_add_bool(grp, ST_KEY_FFMPEG_ZEROCOPY, D_TRANSLATE(ST_I18N_FFMPEG_ZEROCOPY));
+		}
+
+		if (!_handler || !_handler->is_hardware(this)) {
+			auto p = obs_properties_add_bool(grp, ST_KEY_FFMPEG_GPUCONVERT, D_TRANSLATE(ST_I18N_FFMPEG_GPUCONVERT));
+		}
+
+		if (!_handler || !_handler->is_hardware(this)) { // 0 picks a count automatically.
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_FFMPEG_CONVERTSLICES, D_TRANSLATE(ST_I18N_FFMPEG_CONVERTSLICES), 0, static_cast<int64_t>(std::thread::hardware_concurrency()), 1);
 		}
 
 		if (_handler && _handler->is_hardware(this)) {
+			// Let the user know that the GPU matters, as OBS renders on one this encoder can't use.
+			try {
+				if (auto hwapi = create_hwapi(); hwapi && !is_adapter_usable(_avcodec, hwapi->get_obs_adapter())) {
+					auto p = obs_properties_add_text(grp, ST_KEY_FFMPEG_GPU_WARNING, D_TRANSLATE(ST_I18N_FFMPEG_GPU_WARNING), OBS_TEXT_INFO);
+					obs_property_text_set_info_type(p, OBS_TEXT_INFO_WARNING);
+				}
+			} catch (const std::exception& ex) {
+				DLOG_WARNING("Failed to find the GPU OBS renders on: %s", ex.what());
+			}
+
 			auto p = obs_properties_add_int(grp, ST_KEY_FFMPEG_GPU, D_TRANSLATE(ST_I18N_FFMPEG_GPU), -1, std::numeric_limits<uint8_t>::max(), 1);
 		}
 
+		{ // Asynchronous Encoding
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_FFMPEG_ASYNCDEPTH, D_TRANSLATE(ST_I18N_FFMPEG_ASYNCDEPTH), 0, 16, 1);
+			obs_property_int_set_suffix(p, " frames");
+		}
+
+		{ // Warm Standby
+			auto p = obs_properties_add_bool(grp, ST_KEY_FFMPEG_STANDBY, D_TRANSLATE(ST_I18N_FFMPEG_STANDBY));
+		}
+
+		{ // Region Hints
+			auto p = obs_properties_add_bool(grp, ST_KEY_FFMPEG_REGIONHINTS, D_TRANSLATE(ST_I18N_FFMPEG_REGIONHINTS));
+			obs_property_set_long_description(p, D_TRANSLATE(ST_I18N_FFMPEG_REGIONHINTS ".Description"));
+		}
+
+		if (!_handler || !_handler->is_hardware(this)) { // Static Hints
+			auto p = obs_properties_add_bool(grp, ST_KEY_FFMPEG_STATICHINTS, D_TRANSLATE(ST_I18N_FFMPEG_STATICHINTS));
+			obs_property_set_long_description(p, D_TRANSLATE(ST_I18N_FFMPEG_STATICHINTS ".Description"));
+		}
+
+		{ // Overload Policy
+			auto p = obs_properties_add_bool(grp, ST_KEY_FFMPEG_OVERLOAD, D_TRANSLATE(ST_I18N_FFMPEG_OVERLOAD));
+			obs_property_set_long_description(p, D_TRANSLATE(ST_I18N_FFMPEG_OVERLOAD ".Description"));
+		}
+
 		if (_handler && _handler->has_threading(this)) {
 			auto p = obs_properties_add_int_slider(grp, ST_KEY_FFMPEG_THREADS, D_TRANSLATE(ST_I18N_FFMPEG_THREADS), 0, static_cast<int64_t>(std::thread::hardware_concurrency()) * 2, 1);
 		}
@@ -1103,6 +2009,22 @@ obs_properties_t* ffmpeg_factory::get_properties2(instance_t* data)
 				obs_property_list_add_int(p, buf.data(), divisor);
 			}
 		}
+
+		{ // Rendition
+			obs_video_info ovi;
+			if (!obs_get_video_info(&ovi)) {
+				throw std::runtime_error("obs_get_video_info failed unexpectedly.");
+			}
+
+			auto p = obs_properties_add_list(grp, ST_KEY_FFMPEG_RENDITION, D_TRANSLATE(ST_I18N_FFMPEG_RENDITION), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+			std::vector<char> buf{size_t{256}, 0, std::allocator<char>()};
+			for (std::size_t idx = 0; idx < std::size(rendition_scales); idx++) {
+				uint32_t width  = static_cast<uint32_t>((ovi.output_width * rendition_scales[idx] / rendition_full) & ~1ull);
+				uint32_t height = static_cast<uint32_t>((ovi.output_height * rendition_scales[idx] / rendition_full) & ~1ull);
+				snprintf(buf.data(), buf.size(), "%" PRIu32 "x%" PRIu32 " (%s)", width, height, rendition_names[idx]);
+				obs_property_list_add_int(p, buf.data(), rendition_scales[idx]);
+			}
+		}
 	};
 
 	return props;
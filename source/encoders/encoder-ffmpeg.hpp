@@ -6,13 +6,24 @@
 #pragma once
 #include "common.hpp"
 #include "encoders/ffmpeg/handler.hpp"
-#include "ffmpeg/avframe-queue.hpp"
+#include "ffmpeg/frame-hub.hpp"
+#include "ffmpeg/frame-pool.hpp"
+#include "ffmpeg/packet-pool.hpp"
+#include "ffmpeg/gpu-convert.hpp"
+#include "ffmpeg/gpu-ladder.hpp"
 #include "ffmpeg/hwapi/base.hpp"
+#include "ffmpeg/options.hpp"
 #include "ffmpeg/swscale.hpp"
 #include "obs/obs-encoder-factory.hpp"
+#include "util/util-profiler.hpp"
+#include "util/util-region-hints.hpp"
+#include "util/util-spsc-queue.hpp"
 
 #include "warning-disable.hpp"
+#include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <future>
 #include <map>
 #include <mutex>
 #include <queue>
@@ -32,15 +43,17 @@ namespace streamfx::encoder::ffmpeg {
 	class ffmpeg_factory;
 	class ffmpeg_manager;
 
-	class ffmpeg_instance : public obs::encoder_instance {
+	class ffmpeg_instance final : public obs::encoder_instance {
 		ffmpeg_factory* _factory;
 		const AVCodec*  _codec;
 		AVCodecContext* _context;
 
 		streamfx::encoder::ffmpeg::handler* _handler;
 
-		::streamfx::ffmpeg::swscale _scaler;
-		std::shared_ptr<AVPacket>   _packet;
+		::streamfx::ffmpeg::swscale                      _scaler;
+		std::unique_ptr<::streamfx::ffmpeg::gpu_convert> _gpu_convert;
+		std::shared_ptr<::streamfx::ffmpeg::gpu_ladder>  _gpu_ladder;
+		std::shared_ptr<AVPacket>                        _packet;
 
 		std::shared_ptr<::streamfx::ffmpeg::hwapi::base>     _hwapi;
 		std::shared_ptr<::streamfx::ffmpeg::hwapi::instance> _hwinst;
@@ -54,10 +67,77 @@ namespace streamfx::encoder::ffmpeg {
 		std::vector<uint8_t> _extra_data;
 		std::vector<uint8_t> _sei_data;
 
-		// Frame Stack and Queue
-		std::stack<std::shared_ptr<AVFrame>>           _free_frames;
-		std::queue<std::shared_ptr<AVFrame>>           _used_frames;
-		std::chrono::high_resolution_clock::time_point _free_frames_last_used;
+		// Frame Pool and Queue
+		// _used_frames is only ever touched by the thread talking to libavcodec.
+		std::unique_ptr<::streamfx::ffmpeg::frame_pool> _frame_pool;
+		std::queue<::streamfx::ffmpeg::pooled_frame>    _used_frames;
+		uint64_t                                        _late_allocations; // Frames allocated after the first second.
+
+		// Packet Pool
+		std::unique_ptr<::streamfx::ffmpeg::packet_pool> _packet_pool;
+
+		// Frame Sharing
+		std::shared_ptr<::streamfx::ffmpeg::frame_hub>         _frame_hub;
+		std::shared_ptr<::streamfx::ffmpeg::frame_hub_channel> _frame_channel;
+
+		// Zero-Copy
+		bool                _zerocopy;
+		std::atomic<size_t> _zerocopy_refs;
+
+		// Asynchronous Encoding
+		std::unique_ptr<::streamfx::util::spsc_queue<::streamfx::ffmpeg::pooled_frame>> _async_input;
+		std::deque<std::shared_ptr<AVPacket>>                                           _async_output;
+		std::shared_ptr<AVPacket>                                                       _async_packet;
+		std::mutex                                                                      _async_lock;
+		std::condition_variable                                                         _async_cv;
+		std::atomic<bool>                                                               _async_stop;
+		std::atomic<bool>                                                               _async_failed;
+		std::thread                                                                     _async_thread;
+
+		// Warm Standby
+		// Settings changed while encoding go into a second context, which is opened in the background and replaces
+		// the current one at the next frame. _standby_output holds what the previous context still had in flight.
+		bool                                  _standby_enabled;
+		bool                                  _standby_session; // Holds one of the extra hardware sessions.
+		AVCodecContext*                       _standby;
+		std::future<int>                      _standby_open;
+		std::deque<std::shared_ptr<AVPacket>> _standby_output;
+		std::shared_ptr<AVPacket>             _standby_packet;
+
+		// Region Hints
+		// Regions published by filters are attached to frames as regions of interest, which encoders that support
+		// them turn into QP offsets. Only set if enabled.
+		std::shared_ptr<::streamfx::util::region_hints> _region_hints;
+
+		// Static Hints
+		// Frames identical to the ones before them get a higher QP across the whole frame, so that unchanged content
+		// like slides costs next to nothing. Only for frames in system memory.
+		bool     _static_hints;
+		bool     _static_active; // The current frame is static.
+		uint64_t _static_hash;   // Sampled hash of the previous frame.
+		uint64_t _static_frames; // Unchanged frames in a row.
+
+		// Overload Policy
+		// When encoding takes longer than a frame lasts, frames are dropped on purpose and evenly spaced, instead of
+		// OBS skipping them wherever its queue happens to run full.
+		bool     _overload_enabled;
+		bool     _overload_active;
+		double_t _overload_cost;    // Smoothed time spent per encoded frame, in seconds.
+		double_t _overload_credit;  // Share of a frame that is owed to the drop budget.
+		uint64_t _overload_episode; // Frames dropped since falling behind.
+		uint64_t _overload_dropped;
+
+		// Stage Timings
+		// Always enabled, so that we can tell from any log where time was spent.
+		::streamfx::util::histogram _timing_convert; // Copying or converting frames from OBS in system memory.
+		::streamfx::util::histogram _timing_upload;  // Copying textures from OBS into hardware frames.
+		::streamfx::util::histogram _timing_send;    // avcodec_send_frame
+		::streamfx::util::histogram _timing_receive; // avcodec_receive_packet, only if a packet was returned.
+		uint64_t                    _timing_reported;
+
+#ifdef ENABLE_PROFILING
+		std::shared_ptr<::streamfx::util::profiler> _profiler_copy;
+#endif
 
 		public:
 		ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool is_hw);
@@ -76,27 +156,65 @@ namespace streamfx::encoder::ffmpeg {
 
 		bool encode_video(uint32_t handle, int64_t pts, uint64_t lock_key, uint64_t* next_key, struct encoder_packet* packet, bool* received_packet) override;
 
+#ifdef D_ENCODER_TEXTURE2
+		bool encode_video(struct encoder_texture* texture, int64_t pts, uint64_t lock_key, uint64_t* next_key, struct encoder_packet* packet, bool* received_packet) override;
+#endif
+
 		bool get_extra_data(uint8_t** extra_data, size_t* size) override;
 
 		bool get_sei_data(uint8_t** sei_data, size_t* size) override;
 
 		void get_video_info(struct video_scale_info* info) override;
 
+		void enumerate_timings(const std::function<void(const char*, const ::streamfx::util::histogram&)>& fn) override;
+
+		void enumerate_counters(const std::function<void(const char*, uint64_t)>& fn) override;
+
 		public:
 		void initialize_sw(obs_data_t* settings);
 		void initialize_hw(obs_data_t* settings);
 
-		void                     push_free_frame(std::shared_ptr<AVFrame> frame);
-		std::shared_ptr<AVFrame> pop_free_frame();
+		::streamfx::ffmpeg::pooled_frame wrap_frame(struct encoder_frame* frame);
+
+		void                             create_frame_pool();
+		::streamfx::ffmpeg::pooled_frame pop_free_frame();
 
-		void                     push_used_frame(std::shared_ptr<AVFrame> frame);
-		std::shared_ptr<AVFrame> pop_used_frame();
+		void apply_region_hints(AVFrame* frame);
+
+		bool is_static(struct encoder_frame* frame);
+
+		void push_used_frame(::streamfx::ffmpeg::pooled_frame frame);
+		void pop_used_frame();
 
 		int receive_packet(bool* received_packet, struct encoder_packet* packet);
 
-		int send_frame(std::shared_ptr<AVFrame> frame);
+		void process_packet(AVPacket* pkt, struct encoder_packet* packet, bool* received_packet);
+
+		int send_frame(::streamfx::ffmpeg::pooled_frame frame);
+
+		bool encode_avframe(::streamfx::ffmpeg::pooled_frame frame, struct encoder_packet* packet, bool* received_packet);
+
+		bool encode_avframe_direct(::streamfx::ffmpeg::pooled_frame frame, struct encoder_packet* packet, bool* received_packet);
 
-		bool encode_avframe(std::shared_ptr<AVFrame> frame, struct encoder_packet* packet, bool* received_packet);
+		bool overload_should_drop();
+
+		void overload_track(double_t cost);
+
+		bool encode_avframe_async(::streamfx::ffmpeg::pooled_frame frame, struct encoder_packet* packet, bool* received_packet);
+
+		bool async_drain();
+
+		void async_work();
+
+		bool prepare_standby(obs_data_t* settings);
+
+		void discard_standby();
+
+		bool swap_standby();
+
+		bool encode_avframe_standby(::streamfx::ffmpeg::pooled_frame frame, struct encoder_packet* packet, bool* received_packet);
+
+		void log_timings();
 
 		public: // Handler API
 		bool is_hardware_encode();
@@ -104,8 +222,6 @@ namespace streamfx::encoder::ffmpeg {
 		const AVCodec* get_avcodec();
 
 		AVCodecContext* get_avcodeccontext();
-
-		void parse_ffmpeg_commandline(std::string_view text);
 	};
 
 	class ffmpeg_factory : public obs::encoder_factory<ffmpeg_factory, ffmpeg_instance> {
@@ -129,6 +245,8 @@ namespace streamfx::encoder::ffmpeg {
 
 		obs_properties_t* get_properties2(instance_t* data) override;
 
+		static bool modified_customsettings(void* priv, obs_properties_t* props, obs_property_t* property, obs_data_t* settings) noexcept;
+
 #ifdef ENABLE_FRONTEND
 		static bool on_manual_open(obs_properties_t* props, obs_property_t* property, void* data);
 #endif
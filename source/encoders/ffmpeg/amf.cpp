@@ -17,6 +17,7 @@
 #include "plugin.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
 extern "C" {
 #include <libavutil/opt.h>
 }
@@ -32,6 +33,10 @@ extern "C" {
 #define ST_I18N_RATECONTROL_MODE_(x) ST_I18N_RATECONTROL_MODE "." x
 #define ST_I18N_RATECONTROL_LOOKAHEAD ST_I18N_RATECONTROL ".LookAhead"
 #define ST_I18N_RATECONTROL_FRAMESKIPPING ST_I18N_RATECONTROL ".FrameSkipping"
+#define ST_I18N_RATECONTROL_PREANALYSIS ST_I18N_RATECONTROL ".PreAnalysis"
+#define ST_I18N_RATECONTROL_PREANALYSIS_DEPTH ST_I18N_RATECONTROL_PREANALYSIS ".Depth"
+#define ST_I18N_RATECONTROL_PREANALYSIS_TEMPORALAQ ST_I18N_RATECONTROL_PREANALYSIS ".TemporalAQ"
+#define ST_I18N_RATECONTROL_PREANALYSIS_SCENECHANGE ST_I18N_RATECONTROL_PREANALYSIS ".SceneChange"
 #define ST_I18N_RATECONTROL_LIMITS ST_I18N_RATECONTROL ".Limits"
 #define ST_I18N_RATECONTROL_LIMITS_BUFFERSIZE ST_I18N_RATECONTROL_LIMITS ".BufferSize"
 #define ST_I18N_RATECONTROL_LIMITS_BITRATE ST_I18N_RATECONTROL_LIMITS ".Bitrate"
@@ -54,6 +59,9 @@ extern "C" {
 #define ST_KEY_RATECONTROL_MODE "RateControl.Mode"
 #define ST_KEY_RATECONTROL_LOOKAHEAD "RateControl.LookAhead"
 #define ST_KEY_RATECONTROL_FRAMESKIPPING "RateControl.FrameSkipping"
+#define ST_KEY_RATECONTROL_PREANALYSIS_DEPTH "RateControl.PreAnalysis.Depth"
+#define ST_KEY_RATECONTROL_PREANALYSIS_TEMPORALAQ "RateControl.PreAnalysis.TemporalAQ"
+#define ST_KEY_RATECONTROL_PREANALYSIS_SCENECHANGE "RateControl.PreAnalysis.SceneChange"
 #define ST_KEY_RATECONTROL_LIMITS_BUFFERSIZE "RateControl.Limits.BufferSize"
 #define ST_KEY_RATECONTROL_LIMITS_BITRATE_TARGET "RateControl.Limits.Bitrate.Target"
 #define ST_KEY_RATECONTROL_LIMITS_BITRATE_MAXIMUM "RateControl.Limits.Bitrate.Maximum"
@@ -158,6 +166,9 @@ void amf::defaults(ffmpeg_factory* factory, obs_data_t* settings)
 	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_MODE, static_cast<int64_t>(ratecontrolmode::CBR));
 	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_LOOKAHEAD, -1);
 	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_FRAMESKIPPING, -1);
+	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_PREANALYSIS_DEPTH, -1);
+	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_PREANALYSIS_TEMPORALAQ, -1);
+	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_PREANALYSIS_SCENECHANGE, -1);
 	//ob
 	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_LIMITS_BITRATE_TARGET, 6000);
 	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_LIMITS_BITRATE_MAXIMUM, 0);
@@ -247,6 +258,18 @@ void amf::properties_after(ffmpeg_factory* factory, ffmpeg_instance* instance, o
 		streamfx::util::obs_properties_add_tristate(grp, ST_KEY_RATECONTROL_FRAMESKIPPING, D_TRANSLATE(ST_I18N_RATECONTROL_FRAMESKIPPING));
 	}
 
+	{ // Pre-Analysis, which only applies with Look Ahead enabled.
+		obs_properties_t* grp = obs_properties_create();
+		obs_properties_add_group(props, ST_I18N_RATECONTROL_PREANALYSIS, D_TRANSLATE(ST_I18N_RATECONTROL_PREANALYSIS), OBS_GROUP_NORMAL, grp);
+
+		{
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_RATECONTROL_PREANALYSIS_DEPTH, D_TRANSLATE(ST_I18N_RATECONTROL_PREANALYSIS_DEPTH), -1, 41, 1);
+			obs_property_int_set_suffix(p, " frames");
+		}
+		streamfx::util::obs_properties_add_tristate(grp, ST_KEY_RATECONTROL_PREANALYSIS_TEMPORALAQ, D_TRANSLATE(ST_I18N_RATECONTROL_PREANALYSIS_TEMPORALAQ));
+		streamfx::util::obs_properties_add_tristate(grp, ST_KEY_RATECONTROL_PREANALYSIS_SCENECHANGE, D_TRANSLATE(ST_I18N_RATECONTROL_PREANALYSIS_SCENECHANGE));
+	}
+
 	{
 		obs_properties_t* grp = obs_properties_create();
 		obs_properties_add_group(props, ST_I18N_RATECONTROL_LIMITS, D_TRANSLATE(ST_I18N_RATECONTROL_LIMITS), OBS_GROUP_NORMAL, grp);
@@ -360,6 +383,17 @@ void amf::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t*
 			av_opt_set_int(context->priv_data, "preanalysis", la, AV_OPT_SEARCH_CHILDREN);
 		}
 
+		// Pre-Analysis options, which older versions of FFmpeg don't have.
+		if (int64_t v = obs_data_get_int(settings, ST_KEY_RATECONTROL_PREANALYSIS_DEPTH); (v > -1) && streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "pa_lookahead_buffer_depth")) {
+			av_opt_set_int(context->priv_data, "pa_lookahead_buffer_depth", v, AV_OPT_SEARCH_CHILDREN);
+		}
+		if (int64_t v = obs_data_get_int(settings, ST_KEY_RATECONTROL_PREANALYSIS_TEMPORALAQ); !streamfx::util::is_tristate_default(v) && streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "pa_taq_mode")) {
+			av_opt_set_int(context->priv_data, "pa_taq_mode", v, AV_OPT_SEARCH_CHILDREN);
+		}
+		if (int64_t v = obs_data_get_int(settings, ST_KEY_RATECONTROL_PREANALYSIS_SCENECHANGE); !streamfx::util::is_tristate_default(v) && streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "pa_scene_change_detection_enable")) {
+			av_opt_set_int(context->priv_data, "pa_scene_change_detection_enable", v, AV_OPT_SEARCH_CHILDREN);
+		}
+
 		// Frame Skipping (Drop frames to maintain bitrate limits)
 		if (int la = static_cast<int>(obs_data_get_int(settings, ST_KEY_RATECONTROL_FRAMESKIPPING)); !streamfx::util::is_tristate_default(la)) {
 			if (std::string_view("amf_h264") == codec->name) {
@@ -447,6 +481,19 @@ void amf::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t*
 
 void amf::override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) {}
 
+std::size_t amf::get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance)
+{
+	// Pre-Analysis holds on to input frames for its look-ahead, in addition to B-Frames and the output delay.
+	auto    context     = instance->get_avcodeccontext();
+	int64_t preanalysis = 0;
+	int64_t depth       = 0;
+	av_opt_get_int(context, "preanalysis", AV_OPT_SEARCH_CHILDREN, &preanalysis);
+	if (preanalysis != 0) {
+		av_opt_get_int(context, "pa_lookahead_buffer_depth", AV_OPT_SEARCH_CHILDREN, &depth);
+	}
+	return static_cast<std::size_t>(std::max<int64_t>(depth, 0) + std::max<int>(context->max_b_frames, 0) + std::max<int>(context->delay, 0));
+}
+
 void amf::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
 {
 	using namespace ::streamfx::ffmpeg;
@@ -459,6 +506,11 @@ void amf::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* se
 	tools::print_av_option_string2(context, "quality", "    Preset", [](int64_t v, std::string_view o) { return std::string(o); });
 	tools::print_av_option_string2(context, "rc", "    Rate Control", [](int64_t v, std::string_view o) { return std::string(o); });
 	tools::print_av_option_bool(context, "preanalysis", "      Look-Ahead");
+	if (tools::avoption_exists(context->priv_data, "pa_lookahead_buffer_depth")) {
+		tools::print_av_option_int(context, "pa_lookahead_buffer_depth", "        Depth", "Frames");
+		tools::print_av_option_int(context, "pa_taq_mode", "        Temporal AQ", "");
+		tools::print_av_option_bool(context, "pa_scene_change_detection_enable", "        Scene Change Detection");
+	}
 	if (std::string_view("amf_h264") == codec->name) {
 		tools::print_av_option_bool(context, "frame_skipping", "      Frame Skipping");
 	} else {
@@ -514,6 +566,11 @@ bool amf_h264::has_threading(ffmpeg_factory* instance)
 	return false;
 }
 
+std::size_t amf_h264::get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance)
+{
+	return amf::get_frame_lag(factory, instance);
+}
+
 void streamfx::encoder::ffmpeg::amf_h264::adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec)
 {
 	name = "AMD AMF H.264/AVC (via FFmpeg)";
@@ -647,6 +704,11 @@ bool amf_hevc::has_threading(ffmpeg_factory* instance)
 	return false;
 }
 
+std::size_t amf_hevc::get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance)
+{
+	return amf::get_frame_lag(factory, instance);
+}
+
 void streamfx::encoder::ffmpeg::amf_hevc::adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec)
 {
 	name = "AMD AMF H.265/HEVC (via FFmpeg)";
@@ -767,3 +829,75 @@ void amf_hevc::get_runtime_properties(ffmpeg_factory* factory, ffmpeg_instance*
 }
 
 static auto inst_hevc = amf_hevc();
+
+// AV1 Handler
+//-------------
+
+amf_av1::amf_av1() : handler("av1_amf") {}
+
+amf_av1::~amf_av1(){};
+
+bool amf_av1::has_keyframes(ffmpeg_factory* instance)
+{
+	return true;
+}
+
+bool amf_av1::is_hardware(ffmpeg_factory* instance)
+{
+	return true;
+}
+
+bool amf_av1::has_threading(ffmpeg_factory* instance)
+{
+	return false;
+}
+
+std::size_t amf_av1::get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance)
+{
+	return amf::get_frame_lag(factory, instance);
+}
+
+void streamfx::encoder::ffmpeg::amf_av1::adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec)
+{
+	name = "AMD AMF AV1 (via FFmpeg)";
+	if (!amf::is_available())
+		factory->get_info()->caps |= OBS_ENCODER_CAP_DEPRECATED;
+	factory->get_info()->caps |= OBS_ENCODER_CAP_DEPRECATED;
+}
+
+void amf_av1::defaults(ffmpeg_factory* factory, obs_data_t* settings)
+{
+	amf::defaults(factory, settings);
+}
+
+void amf_av1::properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+{
+	if (!instance) {
+		amf::properties_before(factory, instance, props);
+		amf::properties_after(factory, instance, props);
+	} else {
+		amf::properties_runtime(factory, instance, props);
+	}
+}
+
+void amf_av1::migrate(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings, uint64_t version)
+{
+	amf::migrate(factory, instance, settings, version);
+}
+
+void amf_av1::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	amf::update(factory, instance, settings);
+}
+
+void amf_av1::override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	amf::override_update(factory, instance, settings);
+}
+
+void amf_av1::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	amf::log(factory, instance, settings);
+}
+
+static auto inst_av1 = amf_av1();
@@ -102,6 +102,9 @@ namespace streamfx::encoder::ffmpeg {
 		void override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings);
 		void log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings);
 
+		/** Frames held by the encoder, including those that Pre-Analysis looks ahead at. */
+		std::size_t get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance);
+
 	} // namespace amf
 
 	class amf_h264 : public handler {
@@ -109,9 +112,10 @@ namespace streamfx::encoder::ffmpeg {
 		amf_h264();
 		virtual ~amf_h264();
 
-		bool has_keyframes(ffmpeg_factory* instance) override;
-		bool is_hardware(ffmpeg_factory* instance) override;
-		bool has_threading(ffmpeg_factory* instance) override;
+		bool        has_keyframes(ffmpeg_factory* instance) override;
+		bool        is_hardware(ffmpeg_factory* instance) override;
+		bool        has_threading(ffmpeg_factory* instance) override;
+		std::size_t get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance) override;
 
 		void adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec) override;
 
@@ -139,9 +143,10 @@ namespace streamfx::encoder::ffmpeg {
 		amf_hevc();
 		virtual ~amf_hevc();
 
-		bool has_keyframes(ffmpeg_factory* instance) override;
-		bool is_hardware(ffmpeg_factory* instance) override;
-		bool has_threading(ffmpeg_factory* instance) override;
+		bool        has_keyframes(ffmpeg_factory* instance) override;
+		bool        is_hardware(ffmpeg_factory* instance) override;
+		bool        has_threading(ffmpeg_factory* instance) override;
+		std::size_t get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance) override;
 
 		void adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec) override;
 
@@ -161,4 +166,29 @@ namespace streamfx::encoder::ffmpeg {
 		void get_encoder_properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props);
 		void get_runtime_properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props);
 	};
+
+	class amf_av1 : public handler {
+		public:
+		amf_av1();
+		virtual ~amf_av1();
+
+		bool        has_keyframes(ffmpeg_factory* instance) override;
+		bool        is_hardware(ffmpeg_factory* instance) override;
+		bool        has_threading(ffmpeg_factory* instance) override;
+		std::size_t get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance) override;
+
+		void adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec) override;
+
+		std::string help(ffmpeg_factory* factory) override
+		{
+			return "https://github.com/Xaymar/obs-StreamFX/wiki/Encoder-FFmpeg-AMF";
+		};
+
+		void defaults(ffmpeg_factory* factory, obs_data_t* settings) override;
+		void properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props) override;
+		void migrate(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings, uint64_t version) override;
+		void update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+		void override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+		void log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+	};
 } // namespace streamfx::encoder::ffmpeg
@@ -4,6 +4,111 @@
 
 #include "handler.hpp"
 #include "../encoder-ffmpeg.hpp"
+#include "configuration.hpp"
+#include "obs/obs-tools.hpp"
+#include "util/util-library.hpp"
+
+#include "warning-disable.hpp"
+#include <cstdlib>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#if defined(D_PLATFORM_WINDOWS)
+#include <Windows.h>
+#endif
+#include "warning-enable.hpp"
+
+#define ST_CFG_PROBES "Encoder.FFmpeg.Probes"
+
+static std::filesystem::path find_library(std::filesystem::path const& library)
+{
+	// Only look where drivers are usually installed, we do not need to match the loader exactly.
+	std::vector<std::filesystem::path> paths;
+#if defined(D_PLATFORM_WINDOWS)
+	std::vector<wchar_t> buffer(MAX_PATH, 0);
+	if (UINT length = GetSystemDirectoryW(buffer.data(), static_cast<UINT>(buffer.size())); (length > 0) && (length < buffer.size())) {
+		paths.emplace_back(std::wstring(buffer.data(), length));
+	}
+#else
+	if (const char* env = std::getenv("LD_LIBRARY_PATH"); env) {
+		std::stringstream sstr{std::string(env)};
+		for (std::string path; std::getline(sstr, path, ':');) {
+			if (!path.empty()) {
+				paths.emplace_back(path);
+			}
+		}
+	}
+	for (auto path : {"/usr/lib64", "/usr/lib/x86_64-linux-gnu", "/usr/lib", "/lib64", "/lib"}) {
+		paths.emplace_back(path);
+	}
+#endif
+
+	for (auto& path : paths) {
+		std::error_code ec;
+		if (auto file = path / library; std::filesystem::is_regular_file(file, ec)) {
+			return file;
+		}
+	}
+	return {};
+}
+
+bool streamfx::encoder::ffmpeg::is_library_available(std::filesystem::path const& library)
+{
+	static std::mutex                            lock;
+	static std::map<std::filesystem::path, bool> session;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (auto kv = session.find(library); kv != session.end()) {
+		return kv->second;
+	}
+
+	// Drivers replace their libraries on every update, so the file itself is a good enough version.
+	std::string key;
+	if (auto file = find_library(library); !file.empty()) {
+		std::error_code ec;
+		auto            size = std::filesystem::file_size(file, ec);
+		auto            time = ec ? std::filesystem::file_time_type() : std::filesystem::last_write_time(file, ec);
+		if (!ec) {
+			key = file.u8string() + ";" + std::to_string(size) + ";" + std::to_string(time.time_since_epoch().count());
+		}
+	}
+
+	auto                        config = streamfx::configuration::instance();
+	auto                        data   = config->get();
+	std::string                 name   = library.u8string();
+	std::shared_ptr<obs_data_t> probes(obs_data_get_obj(data.get(), ST_CFG_PROBES), streamfx::obs::obs_data_deleter);
+	if (!probes) {
+		probes = std::shared_ptr<obs_data_t>(obs_data_create(), streamfx::obs::obs_data_deleter);
+	}
+
+	if (!key.empty()) {
+		std::shared_ptr<obs_data_t> probe(obs_data_get_obj(probes.get(), name.c_str()), streamfx::obs::obs_data_deleter);
+		if (probe && (key == obs_data_get_string(probe.get(), "Key"))) {
+			bool available = obs_data_get_bool(probe.get(), "Available");
+			session.emplace(library, available);
+			return available;
+		}
+	}
+
+	bool available = false;
+	try {
+		streamfx::util::library::load(library);
+		available = true;
+	} catch (...) {
+	}
+	session.emplace(library, available);
+
+	if (!key.empty()) {
+		std::shared_ptr<obs_data_t> probe(obs_data_create(), streamfx::obs::obs_data_deleter);
+		obs_data_set_string(probe.get(), "Key", key.c_str());
+		obs_data_set_bool(probe.get(), "Available", available);
+		obs_data_set_obj(probes.get(), name.c_str(), probe.get());
+		obs_data_set_obj(data.get(), ST_CFG_PROBES, probes.get());
+		config->save();
+	}
+
+	return available;
+}
 
 streamfx::encoder::ffmpeg::handler::handler_map_t& streamfx::encoder::ffmpeg::handler::handlers()
 {
@@ -59,6 +164,13 @@ bool streamfx::encoder::ffmpeg::handler::is_reconfigurable(ffmpeg_factory* facto
 	return false;
 }
 
+std::size_t streamfx::encoder::ffmpeg::handler::get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance)
+{
+	// B-Frames have to wait for the next reference frame, and delay is what the encoder buffers on top.
+	auto context = instance->get_avcodeccontext();
+	return static_cast<std::size_t>(std::max<int>(context->max_b_frames, 0) + std::max<int>(context->delay, 0));
+}
+
 void streamfx::encoder::ffmpeg::handler::adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec) {}
 
 std::string streamfx::encoder::ffmpeg::handler::help(ffmpeg_factory* factory)
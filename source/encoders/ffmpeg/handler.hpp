@@ -5,6 +5,7 @@
 #pragma once
 #include "warning-disable.hpp"
 #include <cstdint>
+#include <filesystem>
 #include <map>
 #include <string>
 extern "C" {
@@ -25,6 +26,9 @@ namespace streamfx::encoder::ffmpeg {
 		virtual bool is_hardware(ffmpeg_factory* factory);
 		virtual bool is_reconfigurable(ffmpeg_factory* factory, bool& threads, bool& gpu, bool& keyframes);
 
+		/** Number of input frames the encoder may hold on to at once after it has been configured. */
+		virtual std::size_t get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance);
+
 		virtual void adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec);
 
 		virtual std::string help(ffmpeg_factory* factory);
@@ -43,4 +47,11 @@ namespace streamfx::encoder::ffmpeg {
 
 		static handler_map_t& handlers();
 	};
+
+	/** Check if a driver library can be loaded, without actually loading it if nothing changed.
+	 *
+	 * Results are remembered for the session, and stored in the configuration keyed by the size and modification time
+	 * of the library, so that the next start only has to load the library again once the driver has been updated.
+	 */
+	bool is_library_available(std::filesystem::path const& library);
 } // namespace streamfx::encoder::ffmpeg
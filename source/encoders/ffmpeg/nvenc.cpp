@@ -19,6 +19,24 @@ extern "C" {
 }
 #include "warning-enable.hpp"
 
+#ifdef ENABLE_NVIDIA_CUDA
+#include "nvidia/cuda/nvidia-cuda-obs.hpp"
+#include "nvidia/nvml/nvidia-nvml.hpp"
+
+#include "warning-disable.hpp"
+// FFmpeg only needs the handle types from the CUDA SDK, which are opaque pointers anyway.
+#ifndef CUDA_VERSION
+#define CUDA_VERSION 0
+typedef struct CUctx_st*    CUcontext;
+typedef struct CUstream_st* CUstream;
+#endif
+extern "C" {
+#include <libavutil/hwcontext.h>
+#include <libavutil/hwcontext_cuda.h>
+}
+#include "warning-enable.hpp"
+#endif
+
 #define ST_I18N_PRESET "Encoder.FFmpeg.NVENC.Preset"
 #define ST_I18N_PRESET_(x) ST_I18N_PRESET "." D_VSTR(x)
 #define ST_KEY_PRESET "Preset"
@@ -35,6 +53,8 @@ extern "C" {
 #define ST_KEY_RATECONTROL_MULTIPASS "RateControl.MultiPass"
 #define ST_I18N_RATECONTROL_LOOKAHEAD ST_I18N_RATECONTROL ".LookAhead"
 #define ST_KEY_RATECONTROL_LOOKAHEAD "RateControl.LookAhead"
+#define ST_I18N_RATECONTROL_LATENCY ST_I18N_RATECONTROL ".Latency"
+#define ST_KEY_RATECONTROL_LATENCY "RateControl.Latency"
 #define ST_I18N_RATECONTROL_ADAPTIVEI ST_I18N_RATECONTROL ".AdaptiveI"
 #define ST_KEY_RATECONTROL_ADAPTIVEI "RateControl.AdaptiveI"
 #define ST_I18N_RATECONTROL_ADAPTIVEB ST_I18N_RATECONTROL ".AdaptiveB"
@@ -82,10 +102,22 @@ extern "C" {
 #define ST_KEY_OTHER_REFERENCEFRAMES "Other.ReferenceFrames"
 #define ST_I18N_OTHER_LOWDELAYKEYFRAMESCALE ST_I18N_OTHER ".LowDelayKeyFrameScale"
 #define ST_KEY_OTHER_LOWDELAYKEYFRAMESCALE "Other.LowDelayKeyFrameScale"
+#define ST_I18N_OTHER_INTRAREFRESH ST_I18N_OTHER ".IntraRefresh"
+#define ST_KEY_OTHER_INTRAREFRESH "Other.IntraRefresh"
+#define ST_I18N_OTHER_SPLITENCODE ST_I18N_OTHER ".SplitEncode"
+#define ST_KEY_OTHER_SPLITENCODE "Other.SplitEncode"
+#define ST_I18N_ADMISSION "Encoder.FFmpeg.NVENC.Admission"
+#define ST_I18N_ADMISSION_MODE ST_I18N_ADMISSION ".Mode"
+#define ST_KEY_ADMISSION_MODE "Admission.Mode"
+#define ST_I18N_ADMISSION_THRESHOLD ST_I18N_ADMISSION ".Threshold"
+#define ST_KEY_ADMISSION_THRESHOLD "Admission.Threshold"
 
 #define ST_KEY_H264_PROFILE "H264.Profile"
 #define ST_KEY_H264_LEVEL "H264.Level"
 
+// Owned by ffmpeg_instance, but counts towards the latency budget.
+#define ST_KEY_FFMPEG_ASYNCDEPTH "FFmpeg.AsyncDepth"
+
 #define ST_KEY_H265_PROFILE "H265.Profile"
 #define ST_KEY_H265_TIER "H265.Tier"
 #define ST_KEY_H264_LEVEL "H265.Level"
@@ -93,6 +125,17 @@ extern "C" {
 using namespace streamfx::encoder::ffmpeg;
 using namespace streamfx::encoder::codec;
 
+// Pixels per second a single NVENC engine keeps up with at the faster presets, roughly 4K at 60 frames per second.
+// Anything above this needs the frame to be split across engines.
+constexpr int64_t split_encode_threshold = 3840ll * 2160ll * 60ll;
+
+enum class admission_mode : int64_t {
+	DISABLED = 0,
+	WARN     = 1,
+	MOVE     = 2,
+	REFUSE   = 3,
+};
+
 inline bool is_cqp(std::string_view rc)
 {
 	return std::string_view("constqp") == rc;
@@ -108,6 +151,40 @@ inline bool is_vbr(std::string_view rc)
 	return std::string_view("vbr") == rc;
 }
 
+struct latency_budget {
+	int64_t frames;    // Frames the encoder may hold on to, excluding the one being encoded.
+	int64_t bframes;   // Maximum B-Frames
+	int64_t lookahead; // Look-Ahead depth in frames
+	int64_t delay;     // Frames NVENC may buffer before returning output.
+};
+
+/** Split a latency target into B-Frames, Look-Ahead and output delay.
+ *
+ * Each of these delays the output by its number of frames, so we assume the worst case where they add up. B-Frames
+ * are the cheapest way to improve quality, followed by a single frame of output delay to keep NVENC busy, and then
+ * Look-Ahead, which is only worth it with a few frames to look at.
+ */
+static bool calculate_latency_budget(AVCodecContext* context, obs_data_t* settings, latency_budget& budget)
+{
+	int64_t target = obs_data_get_int(settings, ST_KEY_RATECONTROL_LATENCY);
+	if ((target <= 0) || (context->time_base.num <= 0) || (context->time_base.den <= 0)) {
+		return false;
+	}
+
+	// Frames we already lag behind due to asynchronous encoding count against the budget too.
+	int64_t async_lag = std::max<int64_t>(obs_data_get_int(settings, ST_KEY_FFMPEG_ASYNCDEPTH), 0);
+	int64_t frames    = (target * context->time_base.den) / (context->time_base.num * 1000ll);
+
+	budget.frames    = std::max<int64_t>(frames - 1 - async_lag, 0);
+	int64_t left     = budget.frames;
+	budget.bframes   = std::min<int64_t>(left, 2);
+	left            -= budget.bframes;
+	budget.delay     = std::min<int64_t>(left, 1);
+	left            -= budget.delay;
+	budget.lookahead = (left >= 4) ? std::min<int64_t>(left, 32) : 0;
+	return true;
+}
+
 bool nvenc::is_available()
 {
 #if defined(D_PLATFORM_WINDOWS)
@@ -119,12 +196,7 @@ bool nvenc::is_available()
 #else
 	std::filesystem::path lib_name = "libnvidia-encode.so.1";
 #endif
-	try {
-		streamfx::util::library::load(lib_name);
-		return true;
-	} catch (...) {
-		return false;
-	}
+	return is_library_available(lib_name);
 }
 
 void nvenc::defaults(ffmpeg_factory* factory, obs_data_t* settings)
@@ -138,6 +210,7 @@ void nvenc::defaults(ffmpeg_factory* factory, obs_data_t* settings)
 	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_LOOKAHEAD, -1);
 	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_ADAPTIVEI, -1);
 	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_ADAPTIVEB, -1);
+	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_LATENCY, 0);
 
 	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_LIMITS_BITRATE_TARGET, 6000);
 	obs_data_set_default_int(settings, ST_KEY_RATECONTROL_LIMITS_BITRATE_MAXIMUM, 0);
@@ -161,6 +234,11 @@ void nvenc::defaults(ffmpeg_factory* factory, obs_data_t* settings)
 	obs_data_set_default_int(settings, ST_KEY_OTHER_NONREFERENCEPFRAMES, -1);
 	obs_data_set_default_int(settings, ST_KEY_OTHER_REFERENCEFRAMES, -1);
 	obs_data_set_default_int(settings, ST_KEY_OTHER_LOWDELAYKEYFRAMESCALE, -1);
+	obs_data_set_default_int(settings, ST_KEY_OTHER_INTRAREFRESH, -1);
+	obs_data_set_default_string(settings, ST_KEY_OTHER_SPLITENCODE, "automatic");
+
+	obs_data_set_default_int(settings, ST_KEY_ADMISSION_MODE, static_cast<int64_t>(admission_mode::DISABLED));
+	obs_data_set_default_int(settings, ST_KEY_ADMISSION_THRESHOLD, 90);
 
 	// Replay Buffer
 	obs_data_set_default_int(settings, "bitrate", 0);
@@ -209,6 +287,16 @@ static bool modified_ratecontrol(obs_properties_t* props, obs_property_t*, obs_d
 	return true;
 }
 
+static bool modified_latency(obs_properties_t* props, obs_property_t*, obs_data_t* settings) noexcept
+{
+	// A latency target replaces the manual choice of these.
+	bool manual = obs_data_get_int(settings, ST_KEY_RATECONTROL_LATENCY) <= 0;
+	obs_property_set_visible(obs_properties_get(props, ST_KEY_RATECONTROL_LOOKAHEAD), manual);
+	obs_property_set_visible(obs_properties_get(props, ST_KEY_OTHER_BFRAMES), manual);
+	obs_property_set_visible(obs_properties_get(props, ST_KEY_OTHER_ZEROLATENCY), manual);
+	return true;
+}
+
 static bool modified_aq(obs_properties_t* props, obs_property_t*, obs_data_t* settings) noexcept
 {
 	bool spatial_aq = streamfx::util::is_tristate_enabled(obs_data_get_int(settings, ST_KEY_AQ_SPATIAL));
@@ -277,6 +365,12 @@ void nvenc::properies_after(ffmpeg_factory* factory, ffmpeg_instance* instance,
 			auto p = streamfx::util::obs_properties_add_tristate(grp, ST_KEY_RATECONTROL_TWOPASS, D_TRANSLATE(ST_I18N_RATECONTROL_TWOPASS));
 		}
 
+		{
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_RATECONTROL_LATENCY, D_TRANSLATE(ST_I18N_RATECONTROL_LATENCY), 0, 1000, 1);
+			obs_property_int_set_suffix(p, " ms");
+			obs_property_set_modified_callback(p, modified_latency);
+		}
+
 		{
 			auto p = obs_properties_add_int_slider(grp, ST_KEY_RATECONTROL_LOOKAHEAD, D_TRANSLATE(ST_I18N_RATECONTROL_LOOKAHEAD), -1, 32, 1);
 			obs_property_int_set_suffix(p, " frames");
@@ -405,7 +499,48 @@ void nvenc::properies_after(ffmpeg_factory* factory, ffmpeg_instance* instance,
 		if (streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "ldkfs")) {
 			auto p = obs_properties_add_int_slider(grp, ST_KEY_OTHER_LOWDELAYKEYFRAMESCALE, D_TRANSLATE(ST_I18N_OTHER_LOWDELAYKEYFRAMESCALE), -1, 255, 1);
 		}
+
+		if (streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "intra-refresh")) {
+			auto p = streamfx::util::obs_properties_add_tristate(grp, ST_KEY_OTHER_INTRAREFRESH, D_TRANSLATE(ST_I18N_OTHER_INTRAREFRESH));
+			obs_property_set_long_description(p, D_TRANSLATE(ST_I18N_OTHER_INTRAREFRESH ".Description"));
+		}
+
+		if (streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "split_encode_mode")) {
+			auto p = obs_properties_add_list(grp, ST_KEY_OTHER_SPLITENCODE, D_TRANSLATE(ST_I18N_OTHER_SPLITENCODE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+			obs_property_set_long_description(p, D_TRANSLATE(ST_I18N_OTHER_SPLITENCODE ".Description"));
+			obs_property_list_add_string(p, D_TRANSLATE(S_STATE_DEFAULT), "");
+			obs_property_list_add_string(p, D_TRANSLATE(ST_I18N_OTHER_SPLITENCODE ".Automatic"), "automatic");
+			streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "split_encode_mode", [&p](const AVOption* opt) {
+				char buffer[1024];
+				snprintf(buffer, sizeof(buffer), "%s.%s", ST_I18N_OTHER_SPLITENCODE, opt->name);
+				obs_property_list_add_string(p, D_TRANSLATE(buffer), opt->name);
+			});
+		}
+	}
+
+#ifdef ENABLE_NVIDIA_CUDA
+	{ // Admission Control
+		obs_properties_t* grp = props;
+		if (!streamfx::util::are_property_groups_broken()) {
+			grp = obs_properties_create();
+			obs_properties_add_group(props, ST_I18N_ADMISSION, D_TRANSLATE(ST_I18N_ADMISSION), OBS_GROUP_NORMAL, grp);
+		}
+
+		{
+			auto p = obs_properties_add_list(grp, ST_KEY_ADMISSION_MODE, D_TRANSLATE(ST_I18N_ADMISSION_MODE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+			obs_property_set_long_description(p, D_TRANSLATE(ST_I18N_ADMISSION_MODE ".Description"));
+			obs_property_list_add_int(p, D_TRANSLATE(S_STATE_DISABLED), static_cast<int64_t>(admission_mode::DISABLED));
+			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_ADMISSION_MODE ".Warn"), static_cast<int64_t>(admission_mode::WARN));
+			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_ADMISSION_MODE ".Move"), static_cast<int64_t>(admission_mode::MOVE));
+			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_ADMISSION_MODE ".Refuse"), static_cast<int64_t>(admission_mode::REFUSE));
+		}
+
+		{
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_ADMISSION_THRESHOLD, D_TRANSLATE(ST_I18N_ADMISSION_THRESHOLD), 10, 100, 1);
+			obs_property_int_set_suffix(p, " %");
+		}
 	}
+#endif
 }
 
 void nvenc::properties_runtime(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
@@ -416,6 +551,7 @@ void nvenc::properties_runtime(ffmpeg_factory* factory, ffmpeg_instance* instanc
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_RATECONTROL_MODE), false);
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_RATECONTROL_TWOPASS), false);
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_RATECONTROL_MULTIPASS), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_RATECONTROL_LATENCY), false);
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_RATECONTROL_LOOKAHEAD), false);
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_RATECONTROL_ADAPTIVEI), false);
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_RATECONTROL_ADAPTIVEB), false);
@@ -442,6 +578,11 @@ void nvenc::properties_runtime(ffmpeg_factory* factory, ffmpeg_instance* instanc
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_OTHER_NONREFERENCEPFRAMES), false);
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_OTHER_REFERENCEFRAMES), false);
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_OTHER_LOWDELAYKEYFRAMESCALE), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_OTHER_INTRAREFRESH), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_OTHER_SPLITENCODE), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_I18N_ADMISSION), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_ADMISSION_MODE), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_ADMISSION_THRESHOLD), false);
 }
 
 void nvenc::migrate(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings, uint64_t version)
@@ -527,11 +668,177 @@ void nvenc::migrate(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data
 #undef COPY_UNSET
 }
 
+static void check_restart_required(const AVCodec* codec, void* priv_data, const char* option, const char* value)
+{
+	if ((value == nullptr) || (value[0] == '\0')) {
+		return;
+	}
+
+	// Named values are constants in the unit of the option they belong to.
+	const AVOption* opt = av_opt_find(priv_data, option, nullptr, 0, 0);
+	if (!opt || !opt->unit) {
+		return;
+	}
+	const AVOption* named   = av_opt_find(priv_data, value, opt->unit, 0, 0);
+	int64_t         current = 0;
+	if (!named || (named->type != AV_OPT_TYPE_CONST) || (av_opt_get_int(priv_data, option, 0, &current) < 0)) {
+		return;
+	}
+
+	if (named->default_val.i64 != current) {
+		DLOG_WARNING("[%s] Changing '%s' to '%s' requires restarting the encoder, the change was not applied.", codec->name, option, value);
+	}
+}
+
+#ifdef ENABLE_NVIDIA_CUDA
+static AVBufferRef* create_shared_cuda_device()
+{
+	// The NVIDIA filters already keep the primary context of OBS's device alive, so share it instead of having FFmpeg
+	// create yet another context that the driver then has to switch between every frame.
+	auto cuda = ::streamfx::nvidia::cuda::obs::get();
+
+	AVBufferRef* device = av_hwdevice_ctx_alloc(AV_HWDEVICE_TYPE_CUDA);
+	if (!device) {
+		throw std::bad_alloc();
+	}
+
+	auto hwdev         = reinterpret_cast<AVHWDeviceContext*>(device->data);
+	auto hwctx         = reinterpret_cast<AVCUDADeviceContext*>(hwdev->hwctx);
+	hwctx->cuda_ctx    = reinterpret_cast<CUcontext>(cuda->get_context()->get());
+	hwdev->user_opaque = new std::shared_ptr<::streamfx::nvidia::cuda::obs>(cuda);
+	hwdev->free        = [](AVHWDeviceContext* ctx) { delete reinterpret_cast<std::shared_ptr<::streamfx::nvidia::cuda::obs>*>(ctx->user_opaque); };
+
+	if (int res = av_hwdevice_ctx_init(device); res < 0) {
+		av_buffer_unref(&device);
+		throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+	}
+	return device;
+}
+
+/** Load the GPU would have with one more session, assuming it costs as much as the average existing one. */
+static bool predict_encoder_load(const std::shared_ptr<::streamfx::nvidia::cuda::cuda>& cuda, const std::shared_ptr<::streamfx::nvidia::nvml::nvml>& nvml, ::streamfx::nvidia::cuda::device_t device, uint32_t& load)
+{
+	::streamfx::nvidia::cuda::uuid_t       uuid;
+	::streamfx::nvidia::nvml::encoder_load current;
+	if ((cuda->cuDeviceGetUuid(&uuid, device) != ::streamfx::nvidia::cuda::result::SUCCESS) || !nvml->get_encoder_load(uuid, current)) {
+		return false;
+	}
+
+	load = current.utilization;
+	if (current.sessions > 0) {
+		load += current.utilization / current.sessions;
+	}
+	return true;
+}
+
+/** Check if the GPU can take another session without slowing down the ones it already has.
+ *
+ * Once the NVENC engines are saturated, every session on them slows down at the same time. NVML only tells us how
+ * busy the engines were over the last second, which is enough to tell the user before it happens.
+ */
+static void admit_session(const AVCodec* codec, ffmpeg_instance* instance, AVCodecContext* context, obs_data_t* settings)
+{
+	auto mode = static_cast<admission_mode>(obs_data_get_int(settings, ST_KEY_ADMISSION_MODE));
+	if (mode == admission_mode::DISABLED) {
+		return;
+	}
+	uint32_t threshold = static_cast<uint32_t>(std::clamp<int64_t>(obs_data_get_int(settings, ST_KEY_ADMISSION_THRESHOLD), 0, 100));
+
+	std::shared_ptr<::streamfx::nvidia::cuda::cuda> cuda;
+	std::shared_ptr<::streamfx::nvidia::nvml::nvml> nvml;
+	try {
+		cuda = ::streamfx::nvidia::cuda::cuda::get();
+		nvml = ::streamfx::nvidia::nvml::nvml::get();
+	} catch (const std::exception& ex) {
+		DLOG_WARNING("[%s] Admission Control is unavailable: %s", codec->name, ex.what());
+		return;
+	}
+
+	// Sessions on the shared context or OBS's textures run on the GPU OBS renders on, anything else on the chosen one.
+	::streamfx::nvidia::cuda::device_t device = 0;
+	int64_t                            gpu    = -1;
+	av_opt_get_int(context->priv_data, "gpu", AV_OPT_SEARCH_CHILDREN, &gpu);
+	if (context->hw_device_ctx || instance->is_hardware_encode()) {
+		if (!::streamfx::nvidia::cuda::obs::get()->get_context()->get_device(device)) {
+			return;
+		}
+	} else if (cuda->cuDeviceGet(&device, static_cast<int32_t>(std::max<int64_t>(gpu, 0))) != ::streamfx::nvidia::cuda::result::SUCCESS) {
+		return;
+	}
+
+	uint32_t load = 0;
+	if (!predict_encoder_load(cuda, nvml, device, load)) {
+		DLOG_WARNING("[%s] Admission Control is unavailable: NVML doesn't know the encoder load of the GPU.", codec->name);
+		return;
+	}
+	if (load <= threshold) {
+		DLOG_INFO("[%s] Admission Control: Encoder load will be about %" PRIu32 "%%.", codec->name, load);
+		return;
+	}
+
+	if ((mode == admission_mode::MOVE) && !instance->is_hardware_encode()) {
+		// OBS's textures can't go anywhere else, but frames from system memory can go to any GPU.
+		int32_t  count     = 0;
+		int32_t  best      = -1;
+		uint32_t best_load = threshold;
+		cuda->cuDeviceGetCount(&count);
+		for (int32_t ordinal = 0; ordinal < count; ordinal++) {
+			::streamfx::nvidia::cuda::device_t other;
+			uint32_t                           other_load = 0;
+			if ((cuda->cuDeviceGet(&other, ordinal) != ::streamfx::nvidia::cuda::result::SUCCESS) || (other == device)) {
+				continue;
+			}
+			if (predict_encoder_load(cuda, nvml, other, other_load) && (other_load <= best_load)) {
+				best      = ordinal;
+				best_load = other_load;
+			}
+		}
+
+		if (best >= 0) {
+			// NVENC would otherwise stick to the device of the shared context.
+			av_buffer_unref(&context->hw_device_ctx);
+			av_opt_set_int(context->priv_data, "gpu", best, AV_OPT_SEARCH_CHILDREN);
+			DLOG_WARNING("[%s] Admission Control: Encoder load would be about %" PRIu32 "%%, moved to GPU %" PRId32 " with about %" PRIu32 "%% instead.", codec->name, load, best, best_load);
+			return;
+		}
+		DLOG_WARNING("[%s] Admission Control: Encoder load would be about %" PRIu32 "%%, and no other GPU has room for another session.", codec->name, load);
+	} else if (mode == admission_mode::REFUSE) {
+		DLOG_ERROR("[%s] Admission Control: Encoder load would be about %" PRIu32 "%%, refusing to start another session.", codec->name, load);
+		throw std::runtime_error("The GPU has no room for another encoding session.");
+	} else {
+		DLOG_WARNING("[%s] Admission Control: Encoder load would be about %" PRIu32 "%%, all sessions on this GPU may start dropping frames.", codec->name, load);
+	}
+}
+#endif
+
 void nvenc::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
 {
 	auto codec   = factory->get_avcodec();
 	auto context = instance->get_avcodeccontext();
 
+#ifdef ENABLE_NVIDIA_CUDA
+	// Frames from system memory are uploaded through CUDA, while textures come with their own device.
+	if (!context->internal && !instance->is_hardware_encode() && !context->hw_device_ctx) {
+		try {
+			context->hw_device_ctx = create_shared_cuda_device();
+			DLOG_INFO("[%s] Using the shared CUDA context.", codec->name);
+		} catch (const std::exception& ex) {
+			DLOG_WARNING("[%s] Unable to share the CUDA context, NVENC will create its own: %s", codec->name, ex.what());
+		}
+	}
+
+	if (!context->internal) {
+		admit_session(codec, instance, context, settings);
+	}
+#endif
+
+	if (context->internal) {
+		// NVENC picks up changes to bitrate, maximum bitrate and buffer size with the next frame, anything else
+		// needs a new session.
+		check_restart_required(codec, context->priv_data, "preset", obs_data_get_string(settings, ST_KEY_PRESET));
+		check_restart_required(codec, context->priv_data, "rc", obs_data_get_string(settings, ST_KEY_RATECONTROL_MODE));
+	}
+
 	if (const char* v = obs_data_get_string(settings, ST_KEY_PRESET); !context->internal && (v != nullptr) && (v[0] != '\0')) {
 		av_opt_set(context->priv_data, "preset", v, AV_OPT_SEARCH_CHILDREN);
 	}
@@ -738,6 +1045,48 @@ void nvenc::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_
 		if (auto v = obs_data_get_int(settings, ST_KEY_OTHER_LOWDELAYKEYFRAMESCALE); v > -1) {
 			av_opt_set_int(context->priv_data, "ldkfs", v, AV_OPT_SEARCH_CHILDREN);
 		}
+
+		// Intra-Refresh spreads the keyframe over the keyframe interval, one band of intra blocks per frame, instead of
+		// sending it all at once. FFmpeg then uses an infinite GOP and marks where each refresh starts with a recovery
+		// point SEI, so decoders can still join the stream there.
+		if (int64_t ir = obs_data_get_int(settings, ST_KEY_OTHER_INTRAREFRESH); !streamfx::util::is_tristate_default(ir)) {
+			av_opt_set_int(context->priv_data, "intra-refresh", ir, AV_OPT_SEARCH_CHILDREN);
+			if (streamfx::util::is_tristate_enabled(ir)) {
+				// Keyframes requested later on should refresh too, not force a full IDR frame after all.
+				av_opt_set_int(context->priv_data, "forced-idr", 0, AV_OPT_SEARCH_CHILDREN);
+				if (context->max_b_frames > 0) {
+					DLOG_WARNING("[%s] Intra-Refresh works best without B-Frames, as they delay the refresh of each band.", codec->name);
+				}
+			}
+		}
+
+		// Split-Frame Encoding has every NVENC engine of the GPU encode a part of each frame. The driver only does this
+		// on its own for some presets, so outputs that a single engine can't keep up with force it. How many parts it
+		// uses is still up to the driver, which knows how many engines there are.
+		if (const char* v = obs_data_get_string(settings, ST_KEY_OTHER_SPLITENCODE); (v != nullptr) && (v[0] != '\0') && streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "split_encode_mode")) {
+			if (std::string_view("automatic") == v) {
+				int64_t rate = 0;
+				if ((context->framerate.num > 0) && (context->framerate.den > 0)) {
+					rate = (static_cast<int64_t>(context->width) * context->height * context->framerate.num) / context->framerate.den;
+				}
+				v = (rate > split_encode_threshold) ? "forced" : "auto";
+				DLOG_INFO("[%s] Split-Frame Encoding: %s for %" PRId64 " pixels per second.", codec->name, (rate > split_encode_threshold) ? "Forced" : "Left to the driver", rate);
+			}
+			av_opt_set(context->priv_data, "split_encode_mode", v, AV_OPT_SEARCH_CHILDREN);
+		}
+	}
+
+	if (latency_budget budget; !context->internal && calculate_latency_budget(context, settings, budget)) { // Latency
+		av_opt_set_int(context, "bf", budget.bframes, AV_OPT_SEARCH_CHILDREN);
+		av_opt_set_int(context->priv_data, "rc-lookahead", budget.lookahead, AV_OPT_SEARCH_CHILDREN);
+		av_opt_set_int(context->priv_data, "zerolatency", (budget.bframes == 0) ? 1 : 0, AV_OPT_SEARCH_CHILDREN);
+		av_opt_set_int(context->priv_data, "delay", budget.delay, AV_OPT_SEARCH_CHILDREN);
+
+		int64_t target = obs_data_get_int(settings, ST_KEY_RATECONTROL_LATENCY);
+		if (budget.frames == 0) {
+			DLOG_WARNING("[%s] Target Latency of %" PRId64 " ms is less than a frame, disabling all buffering.", codec->name, target);
+		}
+		DLOG_INFO("[%s] Target Latency of %" PRId64 " ms allows %" PRId64 " frames: %" PRId64 " B-Frames, %" PRId64 " frames Look-Ahead, %" PRId64 " frames delay.", codec->name, target, budget.frames, budget.bframes, budget.lookahead, budget.delay);
 	}
 }
 
@@ -768,7 +1117,20 @@ void nvenc::override_update(ffmpeg_factory* factory, ffmpeg_instance* instance,
 	}
 
 	// Set delay
-	context->delay = std::min<int>(std::max<int>(static_cast<int>(async_depth), 3), static_cast<int>(surfaces - 1));
+	if (latency_budget budget; calculate_latency_budget(context, settings, budget)) {
+		context->delay = static_cast<int>(budget.delay);
+	} else {
+		context->delay = std::min<int>(std::max<int>(static_cast<int>(async_depth), 3), static_cast<int>(surfaces - 1));
+	}
+}
+
+std::size_t nvenc::get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance)
+{
+	// Look-Ahead holds on to input frames in addition to B-Frames and the output delay.
+	auto    context   = instance->get_avcodeccontext();
+	int64_t lookahead = 0;
+	av_opt_get_int(context, "rc-lookahead", AV_OPT_SEARCH_CHILDREN, &lookahead);
+	return static_cast<std::size_t>(std::max<int64_t>(lookahead, 0) + std::max<int>(context->max_b_frames, 0) + std::max<int>(context->delay, 0));
 }
 
 void nvenc::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
@@ -804,6 +1166,8 @@ void nvenc::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t*
 	tools::print_av_option_int(context, "qp_cb_offset", "        CB Offset", "");
 	tools::print_av_option_int(context, "qp_cr_offset", "        CR Offset", "");
 
+	if (tools::avoption_exists(context->priv_data, "split_encode_mode"))
+		tools::print_av_option_string2(context, "split_encode_mode", "    Split-Frame Encoding", [](int64_t v, std::string_view o) { return std::string(o); });
 	tools::print_av_option_int(context, "bf", "    B-Frames", "Frames");
 	tools::print_av_option_string2(context, "b_ref_mode", "      Reference Mode", [](int64_t v, std::string_view o) { return std::string(o); });
 
@@ -866,11 +1230,19 @@ bool nvenc_h264::is_reconfigurable(ffmpeg_factory* instance, bool& threads, bool
 	return true;
 }
 
+std::size_t nvenc_h264::get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance)
+{
+	return nvenc::get_frame_lag(factory, instance);
+}
+
 void nvenc_h264::adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec)
 {
 	name = "NVIDIA NVENC H.264/AVC (via FFmpeg)";
 	if (!nvenc::is_available()) // If we don't have NVENC, don't even allow listing it.
 		factory->get_info()->caps |= OBS_ENCODER_CAP_DEPRECATED | OBS_ENCODER_CAP_INTERNAL;
+
+	// Bitrate changes are applied without restarting, so allow outputs to adjust it dynamically.
+	factory->get_info()->caps |= OBS_ENCODER_CAP_DYN_BITRATE;
 }
 
 void nvenc_h264::defaults(ffmpeg_factory* factory, obs_data_t* settings)
@@ -1032,11 +1404,19 @@ bool nvenc_hevc::is_reconfigurable(ffmpeg_factory* instance, bool& threads, bool
 	return true;
 }
 
+std::size_t nvenc_hevc::get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance)
+{
+	return nvenc::get_frame_lag(factory, instance);
+}
+
 void nvenc_hevc::adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec)
 {
 	name = "NVIDIA NVENC H.265/HEVC (via FFmpeg)";
 	if (!nvenc::is_available())
 		factory->get_info()->caps |= OBS_ENCODER_CAP_DEPRECATED;
+
+	// Bitrate changes are applied without restarting, so allow outputs to adjust it dynamically.
+	factory->get_info()->caps |= OBS_ENCODER_CAP_DYN_BITRATE;
 }
 
 void nvenc_hevc::defaults(ffmpeg_factory* factory, obs_data_t* settings)
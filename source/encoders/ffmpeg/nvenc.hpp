@@ -34,6 +34,7 @@ namespace streamfx::encoder::ffmpeg {
 		void update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings);
 		void override_update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings);
 		void log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings);
+		std::size_t get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance);
 	} // namespace nvenc
 
 	class nvenc_h264 : public handler {
@@ -45,6 +46,7 @@ namespace streamfx::encoder::ffmpeg {
 		bool has_threading(ffmpeg_factory* factory) override;
 		bool is_hardware(ffmpeg_factory* factory) override;
 		bool is_reconfigurable(ffmpeg_factory* factory, bool& threads, bool& gpu, bool& keyframes) override;
+		std::size_t get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance) override;
 
 		void adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec) override;
 
@@ -74,6 +76,7 @@ namespace streamfx::encoder::ffmpeg {
 		bool has_threading(ffmpeg_factory* factory) override;
 		bool is_hardware(ffmpeg_factory* factory) override;
 		bool is_reconfigurable(ffmpeg_factory* factory, bool& threads, bool& gpu, bool& keyframes) override;
+		std::size_t get_frame_lag(ffmpeg_factory* factory, ffmpeg_instance* instance) override;
 
 		void adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec) override;
 
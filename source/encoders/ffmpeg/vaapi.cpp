@@ -0,0 +1,31 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "vaapi.hpp"
+#include "common.hpp"
+#include "encoders/encoder-ffmpeg.hpp"
+#include "handler.hpp"
+
+using namespace streamfx::encoder::ffmpeg;
+
+vaapi::vaapi(std::string codec, std::string name) : handler(codec), _name(name) {}
+
+bool vaapi::is_hardware(ffmpeg_factory* factory)
+{
+	return true;
+}
+
+bool vaapi::has_threading(ffmpeg_factory* factory)
+{
+	return false;
+}
+
+void vaapi::adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec)
+{
+	name = _name;
+}
+
+static vaapi handler_h264 = vaapi("h264_vaapi", "VA-API H.264/AVC (via FFmpeg)");
+static vaapi handler_hevc = vaapi("hevc_vaapi", "VA-API H.265/HEVC (via FFmpeg)");
+static vaapi handler_av1  = vaapi("av1_vaapi", "VA-API AV1 (via FFmpeg)");
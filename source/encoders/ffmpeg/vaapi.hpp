@@ -0,0 +1,22 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "handler.hpp"
+
+namespace streamfx::encoder::ffmpeg {
+	class vaapi : public handler {
+		std::string _name;
+
+		public:
+		vaapi(std::string codec, std::string name);
+		virtual ~vaapi(){};
+
+		bool is_hardware(ffmpeg_factory* factory) override;
+
+		bool has_threading(ffmpeg_factory* factory) override;
+
+		void adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec) override;
+	};
+} // namespace streamfx::encoder::ffmpeg
@@ -0,0 +1,113 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "frame-hub.hpp"
+
+#include "warning-disable.hpp"
+#include <tuple>
+#include "warning-enable.hpp"
+
+using namespace streamfx::ffmpeg;
+
+bool frame_hub_key::operator<(const frame_hub_key& rhs) const
+{
+	return std::tie(video, width, height, format, colorspace, full_range) < std::tie(rhs.video, rhs.width, rhs.height, rhs.format, rhs.colorspace, rhs.full_range);
+}
+
+frame_hub_channel::frame_hub_channel(video_t* video) : _lock(), _frame(), _source(), _published(0), _lifetime(0), _shared(0)
+{
+	_frame = std::shared_ptr<AVFrame>(av_frame_alloc(), [](AVFrame* frame) { av_frame_free(&frame); });
+	if (!_frame) {
+		throw std::bad_alloc();
+	}
+
+	// All encoders on a video output are handed the same frame one after another, so a published frame is stale long
+	// before the next one arrives. Anything older than half a frame must be from a previous frame that happened to
+	// reuse the same memory.
+	auto voi  = video_output_get_info(video);
+	_lifetime = (static_cast<uint64_t>(voi->fps_den) * 1000000000ull) / (static_cast<uint64_t>(voi->fps_num) * 2ull);
+}
+
+frame_hub_channel::~frame_hub_channel() = default;
+
+std::shared_ptr<AVFrame> frame_hub_channel::find(const struct encoder_frame* frame)
+{
+	std::unique_lock<std::mutex> lock(_lock);
+
+	if (!_frame->buf[0] || ((os_gettime_ns() - _published) > _lifetime)) {
+		return nullptr;
+	}
+	for (std::size_t idx = 0; idx < MAX_AV_PLANES; idx++) {
+		if (_source[idx] != frame->data[idx]) {
+			return nullptr;
+		}
+	}
+
+	auto result = std::shared_ptr<AVFrame>(av_frame_clone(_frame.get()), [](AVFrame* frame) { av_frame_free(&frame); });
+	if (result) {
+		_shared.fetch_add(1, std::memory_order_relaxed);
+	}
+	return result;
+}
+
+void frame_hub_channel::publish(const struct encoder_frame* frame, const AVFrame* converted)
+{
+	std::unique_lock<std::mutex> lock(_lock);
+
+	av_frame_unref(_frame.get());
+	if (av_frame_ref(_frame.get(), converted) < 0) {
+		return;
+	}
+	for (std::size_t idx = 0; idx < MAX_AV_PLANES; idx++) {
+		_source[idx] = frame->data[idx];
+	}
+	_published = os_gettime_ns();
+}
+
+uint64_t frame_hub_channel::shared() const
+{
+	return _shared.load(std::memory_order_relaxed);
+}
+
+frame_hub::frame_hub() : _lock(), _channels() {}
+
+frame_hub::~frame_hub() = default;
+
+std::shared_ptr<frame_hub_channel> frame_hub::subscribe(const frame_hub_key& key)
+{
+	std::unique_lock<std::mutex> lock(_lock);
+
+	// Forget about channels nobody is subscribed to anymore.
+	for (auto iter = _channels.begin(); iter != _channels.end();) {
+		if (iter->second.expired()) {
+			iter = _channels.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+
+	if (auto iter = _channels.find(key); iter != _channels.end()) {
+		if (auto channel = iter->second.lock(); channel) {
+			return channel;
+		}
+	}
+
+	auto channel   = std::make_shared<frame_hub_channel>(key.video);
+	_channels[key] = channel;
+	return channel;
+}
+
+std::shared_ptr<frame_hub> frame_hub::instance()
+{
+	static std::weak_ptr<frame_hub> winst;
+	static std::mutex               mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<frame_hub>(new frame_hub());
+		winst    = instance;
+	}
+	return instance;
+}
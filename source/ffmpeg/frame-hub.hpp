@@ -0,0 +1,77 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "warning-enable.hpp"
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#include "warning-enable.hpp"
+}
+
+namespace streamfx::ffmpeg {
+	struct frame_hub_key {
+		video_t*      video;
+		uint32_t      width;
+		uint32_t      height;
+		AVPixelFormat format;
+		AVColorSpace  colorspace;
+		bool          full_range;
+
+		bool operator<(const frame_hub_key& rhs) const;
+	};
+
+	/** Shares the most recently converted frame between all encoders that need the exact same conversion. */
+	class frame_hub_channel {
+		std::mutex                             _lock;
+		std::shared_ptr<AVFrame>               _frame;
+		std::array<const void*, MAX_AV_PLANES> _source;
+		uint64_t                               _published;
+		uint64_t                               _lifetime;
+		std::atomic<uint64_t>                  _shared;
+
+		public:
+		frame_hub_channel(video_t* video);
+		~frame_hub_channel();
+
+		/** Retrieve a new reference to the converted version of a frame from OBS.
+		 *
+		 * @return A frame sharing its buffers with the published frame, or nullptr if nobody converted it yet.
+		 */
+		std::shared_ptr<AVFrame> find(const struct encoder_frame* frame);
+
+		/** Publish the converted version of a frame from OBS, so that other encoders can reuse it.
+		 *
+		 * The buffers of the converted frame are referenced, and must not be written to until they are writable again.
+		 */
+		void publish(const struct encoder_frame* frame, const AVFrame* converted);
+
+		uint64_t shared() const;
+	};
+
+	/** Lets multiple encoders on the same video output convert each frame only once, instead of once per encoder. */
+	class frame_hub {
+		std::mutex                                                _lock;
+		std::map<frame_hub_key, std::weak_ptr<frame_hub_channel>> _channels;
+
+		public:
+		frame_hub();
+		~frame_hub();
+
+		std::shared_ptr<frame_hub_channel> subscribe(const frame_hub_key& key);
+
+		public: // Singleton
+		static std::shared_ptr<frame_hub> instance();
+	};
+} // namespace streamfx::ffmpeg
@@ -0,0 +1,221 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "frame-pool.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include "warning-enable.hpp"
+
+using namespace streamfx::ffmpeg;
+
+pooled_frame::pooled_frame() : _entry(nullptr) {}
+
+pooled_frame::pooled_frame(std::nullptr_t) : _entry(nullptr) {}
+
+pooled_frame::pooled_frame(frame_pool_entry* entry) : _entry(entry) {}
+
+pooled_frame::~pooled_frame()
+{
+	reset();
+}
+
+pooled_frame::pooled_frame(const pooled_frame& other) : _entry(other._entry)
+{
+	if (_entry) {
+		_entry->refs.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+pooled_frame& pooled_frame::operator=(const pooled_frame& other)
+{
+	if (this != &other) {
+		if (other._entry) {
+			other._entry->refs.fetch_add(1, std::memory_order_relaxed);
+		}
+		reset();
+		_entry = other._entry;
+	}
+	return *this;
+}
+
+pooled_frame::pooled_frame(pooled_frame&& other) noexcept : _entry(std::exchange(other._entry, nullptr)) {}
+
+pooled_frame& pooled_frame::operator=(pooled_frame&& other) noexcept
+{
+	if (this != &other) {
+		reset();
+		_entry = std::exchange(other._entry, nullptr);
+	}
+	return *this;
+}
+
+void pooled_frame::reset()
+{
+	if (!_entry) {
+		return;
+	}
+
+	if (_entry->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		if (_entry->pool) {
+			_entry->pool->release(_entry);
+		} else {
+			delete _entry;
+		}
+	}
+	_entry = nullptr;
+}
+
+AVFrame* pooled_frame::get() const
+{
+	return _entry ? _entry->frame.get() : nullptr;
+}
+
+std::shared_ptr<AVFrame> const& pooled_frame::shared() const
+{
+	static const std::shared_ptr<AVFrame> empty;
+	return _entry ? _entry->frame : empty;
+}
+
+frame_pool::frame_pool(std::size_t capacity, std::function<std::shared_ptr<AVFrame>()> allocate) : _allocate(allocate), _capacity(capacity), _mask(0), _entries(), _cells(), _head(0), _tail(0), _hits(0), _misses(0)
+{
+	if (!_allocate) {
+		throw std::invalid_argument("allocate");
+	}
+
+	// The ring buffer requires a power of two size, which must also be able to hold every frame at once.
+	std::size_t cells = 1;
+	while (cells < std::max<std::size_t>(_capacity, 2)) {
+		cells <<= 1;
+	}
+	_mask  = cells - 1;
+	_cells = std::make_unique<cell[]>(cells);
+	for (std::size_t idx = 0; idx < cells; idx++) {
+		_cells[idx].sequence.store(idx, std::memory_order_relaxed);
+		_cells[idx].entry = nullptr;
+	}
+
+	// Pre-allocate all frames, so that we never have to allocate during encoding.
+	_entries = std::make_unique<frame_pool_entry[]>(_capacity);
+	for (std::size_t idx = 0; idx < _capacity; idx++) {
+		_entries[idx].frame = _allocate();
+		_entries[idx].refs.store(0, std::memory_order_relaxed);
+		_entries[idx].pool = this;
+		push(&_entries[idx]);
+	}
+}
+
+frame_pool::~frame_pool() = default;
+
+pooled_frame frame_pool::acquire()
+{
+	for (std::size_t attempt = 0; attempt < _capacity; attempt++) {
+		frame_pool_entry* entry = pop();
+		if (!entry) {
+			break;
+		}
+
+		// Someone else (libavcodec, or another encoder) may still reference the buffers, so we can't write to them yet.
+		if (av_frame_is_writable(entry->frame.get()) == 0) {
+			push(entry);
+			continue;
+		}
+
+		_hits.fetch_add(1, std::memory_order_relaxed);
+		entry->refs.store(1, std::memory_order_relaxed);
+		return pooled_frame(entry);
+	}
+
+	// The pool ran dry, so allocate a frame which is freed again once released.
+	_misses.fetch_add(1, std::memory_order_relaxed);
+	return wrap(_allocate());
+}
+
+pooled_frame frame_pool::wrap(std::shared_ptr<AVFrame> frame)
+{
+	if (!frame) {
+		return pooled_frame();
+	}
+
+	auto entry   = new frame_pool_entry();
+	entry->frame = std::move(frame);
+	entry->refs.store(1, std::memory_order_relaxed);
+	entry->pool = nullptr;
+	return pooled_frame(entry);
+}
+
+std::size_t frame_pool::capacity() const
+{
+	return _capacity;
+}
+
+uint64_t frame_pool::hits() const
+{
+	return _hits.load(std::memory_order_relaxed);
+}
+
+uint64_t frame_pool::misses() const
+{
+	return _misses.load(std::memory_order_relaxed);
+}
+
+void frame_pool::push(frame_pool_entry* entry)
+{
+	// Bounded multi-producer multi-consumer queue, where each cell tracks which lap of the ring it was last written in.
+	std::size_t pos = _tail.load(std::memory_order_relaxed);
+	cell*       here;
+	while (true) {
+		here             = &_cells[pos & _mask];
+		std::size_t seq  = here->sequence.load(std::memory_order_acquire);
+		intptr_t    diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+		if (diff == 0) {
+			if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else {
+			// There are always more cells than frames, so the ring is never full. If the cell still looks occupied, an
+			// acquire is in progress for it, which only takes a few instructions to complete.
+			pos = _tail.load(std::memory_order_relaxed);
+		}
+	}
+
+	here->entry = entry;
+	here->sequence.store(pos + 1, std::memory_order_release);
+}
+
+frame_pool_entry* frame_pool::pop()
+{
+	std::size_t pos = _head.load(std::memory_order_relaxed);
+	cell*       here;
+	while (true) {
+		here             = &_cells[pos & _mask];
+		std::size_t seq  = here->sequence.load(std::memory_order_acquire);
+		intptr_t    diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+		if (diff == 0) {
+			if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if (diff < 0) {
+			if (_tail.load(std::memory_order_acquire) == pos) {
+				return nullptr; // Empty.
+			}
+			// A release is still in progress for this cell, which also only takes a few instructions to complete.
+			pos = _head.load(std::memory_order_relaxed);
+		} else {
+			pos = _head.load(std::memory_order_relaxed);
+		}
+	}
+
+	frame_pool_entry* entry = here->entry;
+	here->entry             = nullptr;
+	here->sequence.store(pos + _mask + 1, std::memory_order_release);
+	return entry;
+}
+
+void frame_pool::release(frame_pool_entry* entry)
+{
+	push(entry);
+}
@@ -0,0 +1,129 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include "warning-enable.hpp"
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavutil/frame.h>
+#include "warning-enable.hpp"
+}
+
+namespace streamfx::ffmpeg {
+	class frame_pool;
+
+	struct frame_pool_entry {
+		std::shared_ptr<AVFrame> frame;
+		std::atomic<uint32_t>    refs;
+		frame_pool*              pool; // nullptr if the entry is not owned by a pool.
+	};
+
+	/** Intrusively reference counted handle to a frame from a frame_pool.
+	 *
+	 * Once the last handle to a frame is gone, the frame is returned to its pool, or freed if it never belonged to one.
+	 */
+	class pooled_frame {
+		frame_pool_entry* _entry;
+
+		pooled_frame(frame_pool_entry* entry);
+
+		public:
+		pooled_frame();
+		pooled_frame(std::nullptr_t);
+		~pooled_frame();
+
+		pooled_frame(const pooled_frame& other);
+		pooled_frame& operator=(const pooled_frame& other);
+		pooled_frame(pooled_frame&& other) noexcept;
+		pooled_frame& operator=(pooled_frame&& other) noexcept;
+
+		void reset();
+
+		AVFrame* get() const;
+
+		std::shared_ptr<AVFrame> const& shared() const;
+
+		AVFrame* operator->() const
+		{
+			return get();
+		}
+
+		explicit operator bool() const
+		{
+			return _entry != nullptr;
+		}
+
+		friend class frame_pool;
+	};
+
+	/** Fixed capacity pool of pre-allocated frames.
+	 *
+	 * Free frames are kept in a bounded lock-free ring buffer, so frames may be acquired and released from any thread
+	 * without taking a lock or allocating memory. Frames whose buffers are still referenced elsewhere are skipped. Should
+	 * the pool run dry, a new frame is allocated which is freed again once released. The pool must outlive all frames
+	 * acquired from it.
+	 */
+	class frame_pool {
+		struct cell {
+			std::atomic<std::size_t> sequence;
+			frame_pool_entry*        entry;
+		};
+
+		std::function<std::shared_ptr<AVFrame>()> _allocate;
+		std::size_t                               _capacity;
+		std::size_t                               _mask;
+		std::unique_ptr<frame_pool_entry[]>       _entries;
+		std::unique_ptr<cell[]>                   _cells;
+
+#if __cpp_lib_hardware_interference_size >= 201603
+		alignas(std::hardware_destructive_interference_size)
+#endif
+			std::atomic<std::size_t> _head; // Next cell to take a free frame from.
+#if __cpp_lib_hardware_interference_size >= 201603
+		alignas(std::hardware_destructive_interference_size)
+#endif
+			std::atomic<std::size_t> _tail; // Next cell to put a free frame into.
+
+		std::atomic<uint64_t> _hits;
+		std::atomic<uint64_t> _misses;
+
+		public:
+		/** Create a new pool and pre-allocate all frames.
+		 *
+		 * @param capacity Number of frames to pre-allocate.
+		 * @param allocate Called to allocate a single frame, must return a valid frame or throw.
+		 */
+		frame_pool(std::size_t capacity, std::function<std::shared_ptr<AVFrame>()> allocate);
+		~frame_pool();
+
+		/** Retrieve a free and writable frame from the pool, or allocate a new one if none are left. */
+		pooled_frame acquire();
+
+		/** Manage an existing frame which is not part of the pool. */
+		pooled_frame wrap(std::shared_ptr<AVFrame> frame);
+
+		std::size_t capacity() const;
+
+		uint64_t hits() const;
+
+		uint64_t misses() const;
+
+		private:
+		void              push(frame_pool_entry* entry);
+		frame_pool_entry* pop();
+
+		void release(frame_pool_entry* entry);
+
+		friend class pooled_frame;
+	};
+} // namespace streamfx::ffmpeg
@@ -0,0 +1,217 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gpu-convert.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
+
+#include "warning-disable.hpp"
+#include <cstring>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+using namespace streamfx::ffmpeg;
+
+static gs_color_format source_color_format(AVPixelFormat format)
+{
+	switch (format) {
+	case AV_PIX_FMT_RGBA:
+		return GS_RGBA;
+	case AV_PIX_FMT_BGRA:
+		return GS_BGRA;
+	case AV_PIX_FMT_BGR0:
+		return GS_BGRX;
+	default:
+		return GS_UNKNOWN;
+	}
+}
+
+static uint32_t target_bit_depth(AVPixelFormat format)
+{
+	switch (format) {
+	case AV_PIX_FMT_NV12:
+	case AV_PIX_FMT_YUV422P:
+		return 8;
+	case AV_PIX_FMT_P010:
+	case AV_PIX_FMT_YUV422P10:
+		return 10;
+	default:
+		return 0;
+	}
+}
+
+// Formats with separate U and V planes, which are only subsampled horizontally.
+static bool target_is_planar(AVPixelFormat format)
+{
+	return (format == AV_PIX_FMT_YUV422P) || (format == AV_PIX_FMT_YUV422P10);
+}
+
+gpu_convert::gpu_convert(uint32_t width, uint32_t height, AVPixelFormat source_format, AVPixelFormat target_format, AVColorSpace colorspace, bool full_range) : _width(width), _height(height), _target_format(target_format), _matrix(), _scale(1.), _gfx_util(::streamfx::gfx::util::get()), _effect(), _luma_rt(), _chroma_rt(), _cr_rt(), _luma_stage(nullptr), _chroma_stage(nullptr), _cr_stage(nullptr)
+{
+	if (!is_supported(source_format, target_format)) {
+		throw std::invalid_argument("Conversion is not supported on the GPU.");
+	}
+
+	// Luma weights of the supported color spaces, everything else is treated as BT.709.
+	float_t kr = 0.2126f, kb = 0.0722f;
+	switch (colorspace) {
+	case AVCOL_SPC_BT470BG:
+	case AVCOL_SPC_SMPTE170M:
+		kr = 0.299f;
+		kb = 0.114f;
+		break;
+	case AVCOL_SPC_BT2020_NCL:
+		kr = 0.2627f;
+		kb = 0.0593f;
+		break;
+	default:
+		break;
+	}
+	float_t kg = 1.f - kr - kb;
+
+	// Scale and offset for the range, expressed in code values of the target bit depth.
+	uint32_t bits   = target_bit_depth(target_format);
+	float_t  max    = static_cast<float_t>((1u << bits) - 1);
+	float_t  step   = static_cast<float_t>(1u << (bits - 8));
+	float_t  yscale = full_range ? 1.f : (219.f * step / max);
+	float_t  yoff   = full_range ? 0.f : (16.f * step / max);
+	float_t  cscale = full_range ? 1.f : (224.f * step / max);
+	float_t  coff   = (128.f * step) / max;
+
+	_matrix[0] = {kr * yscale, kg * yscale, kb * yscale, yoff};
+	_matrix[1] = {-kr / (2.f * (1.f - kb)) * cscale, -kg / (2.f * (1.f - kb)) * cscale, 0.5f * cscale, coff};
+	_matrix[2] = {0.5f * cscale, -kg / (2.f * (1.f - kr)) * cscale, -kb / (2.f * (1.f - kr)) * cscale, coff};
+
+	// P010 keeps its 10 bits in the upper bits of each 16-bit value, planar formats keep them in the lower bits.
+	if (bits > 8) {
+		_scale = (max * static_cast<float_t>(target_is_planar(target_format) ? 1u : (1u << (16 - bits)))) / 65535.f;
+	}
+
+	auto gctx = streamfx::obs::gs::context();
+
+	auto file = streamfx::data_file_path("effects/rgb-to-yuv.effect");
+	try {
+		_effect = streamfx::obs::gs::effect::create(file);
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
+		throw;
+	}
+
+	bool            planar        = target_is_planar(target_format);
+	gs_color_format luma_format   = (bits > 8) ? GS_R16 : GS_R8;
+	gs_color_format chroma_format = planar ? luma_format : ((bits > 8) ? GS_RG16 : GS_R8G8);
+	uint32_t        chroma_width  = (_width + 1) / 2;
+	uint32_t        chroma_height = planar ? _height : (_height + 1) / 2;
+
+	_luma_rt      = std::make_unique<::streamfx::obs::gs::rendertarget>(luma_format, GS_ZS_NONE);
+	_chroma_rt    = std::make_unique<::streamfx::obs::gs::rendertarget>(chroma_format, GS_ZS_NONE);
+	_luma_stage   = gs_stagesurface_create(_width, _height, luma_format);
+	_chroma_stage = gs_stagesurface_create(chroma_width, chroma_height, chroma_format);
+	if (planar) {
+		_cr_rt    = std::make_unique<::streamfx::obs::gs::rendertarget>(chroma_format, GS_ZS_NONE);
+		_cr_stage = gs_stagesurface_create(chroma_width, chroma_height, chroma_format);
+	}
+	if (!_luma_stage || !_chroma_stage || (planar && !_cr_stage)) {
+		gs_stagesurface_destroy(_luma_stage);
+		gs_stagesurface_destroy(_chroma_stage);
+		gs_stagesurface_destroy(_cr_stage);
+		throw std::runtime_error("Failed to create staging surfaces.");
+	}
+}
+
+gpu_convert::~gpu_convert()
+{
+	auto gctx = streamfx::obs::gs::context();
+
+	gs_stagesurface_destroy(_luma_stage);
+	gs_stagesurface_destroy(_chroma_stage);
+	gs_stagesurface_destroy(_cr_stage);
+	_cr_rt.reset();
+	_chroma_rt.reset();
+	_luma_rt.reset();
+	_effect.reset();
+}
+
+void gpu_convert::convert(std::shared_ptr<::streamfx::obs::gs::texture> input, AVFrame* target)
+{
+	auto gctx = streamfx::obs::gs::context();
+
+	bool        planar        = target_is_planar(_target_format);
+	std::size_t pixel_size    = (target_bit_depth(_target_format) > 8) ? 2 : 1;
+	uint32_t    chroma_width  = (_width + 1) / 2;
+	uint32_t    chroma_height = planar ? _height : (_height + 1) / 2;
+
+	// Set up rendering state.
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
+
+	try {
+		render_plane(_luma_rt.get(), input, _width, _height, "Luma", _matrix[0]);
+		if (planar) {
+			// Each chroma plane is a single channel like luma, just with its own row of the matrix. Linear filtering
+			// averages each horizontal pair of pixels at half the width.
+			render_plane(_chroma_rt.get(), input, chroma_width, chroma_height, "Luma", _matrix[1]);
+			render_plane(_cr_rt.get(), input, chroma_width, chroma_height, "Luma", _matrix[2]);
+		} else {
+			render_plane(_chroma_rt.get(), input, chroma_width, chroma_height, "Chroma", _matrix[0]);
+		}
+	} catch (...) {
+		gs_blend_state_pop();
+		throw;
+	}
+	gs_blend_state_pop();
+
+	// Only the subsampled planes travel back to system memory.
+	gs_stage_texture(_luma_stage, _luma_rt->get_object());
+	gs_stage_texture(_chroma_stage, _chroma_rt->get_object());
+	if (planar) {
+		gs_stage_texture(_cr_stage, _cr_rt->get_object());
+	}
+	read_plane(_luma_stage, target->data[0], target->linesize[0], _width * pixel_size, _height);
+	if (planar) {
+		read_plane(_chroma_stage, target->data[1], target->linesize[1], chroma_width * pixel_size, chroma_height);
+		read_plane(_cr_stage, target->data[2], target->linesize[2], chroma_width * pixel_size, chroma_height);
+	} else {
+		read_plane(_chroma_stage, target->data[1], target->linesize[1], chroma_width * pixel_size * 2, chroma_height);
+	}
+}
+
+bool gpu_convert::is_supported(AVPixelFormat source_format, AVPixelFormat target_format)
+{
+	return (source_color_format(source_format) != GS_UNKNOWN) && (target_bit_depth(target_format) != 0);
+}
+
+gs_color_format gpu_convert::get_input_format(AVPixelFormat source_format)
+{
+	return source_color_format(source_format);
+}
+
+void gpu_convert::render_plane(::streamfx::obs::gs::rendertarget* rt, std::shared_ptr<::streamfx::obs::gs::texture> input, uint32_t width, uint32_t height, const char* technique, const std::array<float_t, 4>& row)
+{
+	auto op = rt->render(width, height);
+	gs_ortho(0, 1, 0, 1, 0, 1);
+
+	_effect.get_parameter("image").set_texture(input, false);
+	_effect.get_parameter("pY").set_float4(row[0], row[1], row[2], row[3]);
+	_effect.get_parameter("pU").set_float4(_matrix[1][0], _matrix[1][1], _matrix[1][2], _matrix[1][3]);
+	_effect.get_parameter("pV").set_float4(_matrix[2][0], _matrix[2][1], _matrix[2][2], _matrix[2][3]);
+	_effect.get_parameter("pScale").set_float(_scale);
+	while (gs_effect_loop(_effect.get_object(), technique)) {
+		_gfx_util->draw_fullscreen_triangle();
+	}
+}
+
+void gpu_convert::read_plane(gs_stagesurf_t* stage, uint8_t* target, int target_stride, std::size_t row_size, uint32_t rows)
+{
+	uint8_t* data     = nullptr;
+	uint32_t linesize = 0;
+	if (!gs_stagesurface_map(stage, &data, &linesize)) {
+		throw std::runtime_error("Failed to map staging surface.");
+	}
+
+	for (uint32_t row = 0; row < rows; row++) {
+		memcpy(target + static_cast<std::ptrdiff_t>(row) * target_stride, data + static_cast<std::size_t>(row) * linesize, row_size);
+	}
+
+	gs_stagesurface_unmap(stage);
+}
@@ -0,0 +1,65 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gfx/gfx-util.hpp"
+#include "obs/gs/gs-effect.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <memory>
+#include "warning-enable.hpp"
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#include "warning-enable.hpp"
+}
+
+namespace streamfx::ffmpeg {
+	/** Converts RGB frames to two plane 4:2:0 or three plane 4:2:2 YUV on the GPU, as an alternative to swscale.
+	 *
+	 * The frame is uploaded once, converted and subsampled by rendering each plane, and only the finished planes are
+	 * read back into the target frame. The target may be smaller than the input, in which case the input should have
+	 * mip-maps so that every output pixel averages all the input pixels it covers.
+	 */
+	class gpu_convert {
+		uint32_t      _width;
+		uint32_t      _height;
+		AVPixelFormat _target_format;
+
+		std::array<std::array<float_t, 4>, 3> _matrix; // Y, U and V rows, with the offset last.
+		float_t                               _scale;
+
+		std::shared_ptr<::streamfx::gfx::util>             _gfx_util;
+		::streamfx::obs::gs::effect                        _effect;
+		std::unique_ptr<::streamfx::obs::gs::rendertarget> _luma_rt;
+		std::unique_ptr<::streamfx::obs::gs::rendertarget> _chroma_rt;
+		std::unique_ptr<::streamfx::obs::gs::rendertarget> _cr_rt; // V plane of three plane formats, U is in _chroma_rt.
+		gs_stagesurf_t*                                    _luma_stage;
+		gs_stagesurf_t*                                    _chroma_stage;
+		gs_stagesurf_t*                                    _cr_stage;
+
+		public:
+		gpu_convert(uint32_t width, uint32_t height, AVPixelFormat source_format, AVPixelFormat target_format, AVColorSpace colorspace, bool full_range);
+		~gpu_convert();
+
+		/** Convert an uploaded frame from OBS into the planes of an already allocated frame. */
+		void convert(std::shared_ptr<::streamfx::obs::gs::texture> input, AVFrame* target);
+
+		/** Check if a conversion can be done on the GPU at all. */
+		static bool is_supported(AVPixelFormat source_format, AVPixelFormat target_format);
+
+		/** Format of the texture that frames in the source format need to be uploaded to. */
+		static gs_color_format get_input_format(AVPixelFormat source_format);
+
+		private:
+		void render_plane(::streamfx::obs::gs::rendertarget* rt, std::shared_ptr<::streamfx::obs::gs::texture> input, uint32_t width, uint32_t height, const char* technique, const std::array<float_t, 4>& row);
+		void read_plane(gs_stagesurf_t* stage, uint8_t* target, int target_stride, std::size_t row_size, uint32_t rows);
+	};
+} // namespace streamfx::ffmpeg
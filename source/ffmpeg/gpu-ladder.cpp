@@ -0,0 +1,93 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gpu-ladder.hpp"
+#include "obs/gs/gs-helper.hpp"
+
+using namespace streamfx::ffmpeg;
+
+gpu_ladder::gpu_ladder(video_t* video, uint32_t width, uint32_t height, gs_color_format format) : _lock(), _mipmapper(::streamfx::gfx::mipmapper::get()), _input(), _mipmapped(), _mipmapped_valid(false), _source(), _uploaded(0), _lifetime(0), _shared(0)
+{
+	// Same reasoning as for the frame hub, anything older than half a frame belongs to a previous frame.
+	auto voi  = video_output_get_info(video);
+	_lifetime = (static_cast<uint64_t>(voi->fps_den) * 1000000000ull) / (static_cast<uint64_t>(voi->fps_num) * 2ull);
+
+	auto gctx = streamfx::obs::gs::context();
+	_input    = std::make_shared<::streamfx::obs::gs::texture>(width, height, format, 1, nullptr, ::streamfx::obs::gs::texture::flags::Dynamic);
+}
+
+gpu_ladder::~gpu_ladder()
+{
+	auto gctx = streamfx::obs::gs::context();
+	_mipmapped.reset();
+	_input.reset();
+}
+
+std::shared_ptr<::streamfx::obs::gs::texture> gpu_ladder::get(const struct encoder_frame* frame, bool mipmapped)
+{
+	std::unique_lock<std::mutex> lock(_lock);
+
+	bool fresh = (_uploaded != 0) && ((os_gettime_ns() - _uploaded) <= _lifetime);
+	for (std::size_t idx = 0; fresh && (idx < MAX_AV_PLANES); idx++) {
+		fresh = (_source[idx] == frame->data[idx]);
+	}
+
+	if (fresh) {
+		_shared.fetch_add(1, std::memory_order_relaxed);
+	} else {
+		gs_texture_set_image(_input->get_object(), frame->data[0], frame->linesize[0], false);
+		for (std::size_t idx = 0; idx < MAX_AV_PLANES; idx++) {
+			_source[idx] = frame->data[idx];
+		}
+		_uploaded        = os_gettime_ns();
+		_mipmapped_valid = false;
+	}
+
+	if (!mipmapped) {
+		return _input;
+	}
+
+	// The mip chain is only built once someone actually needs a smaller rendition of this frame.
+	if (!_mipmapped_valid) {
+		if (!_mipmapped) {
+			_mipmapped = std::make_shared<::streamfx::obs::gs::texture>(_input->get_width(), _input->get_height(), _input->get_color_format(), _mipmapper->calculate_max_mip_level(_input->get_width(), _input->get_height()), nullptr, ::streamfx::obs::gs::texture::flags::None);
+		}
+		_mipmapper->rebuild(_input, _mipmapped);
+		_mipmapped_valid = true;
+	}
+	return _mipmapped;
+}
+
+uint64_t gpu_ladder::shared() const
+{
+	return _shared.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<gpu_ladder> gpu_ladder::subscribe(video_t* video, uint32_t width, uint32_t height, gs_color_format format)
+{
+	static std::map<std::tuple<video_t*, uint32_t, uint32_t, gs_color_format>, std::weak_ptr<gpu_ladder>> ladders;
+	static std::mutex                                                                                     mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+
+	// Forget about ladders nobody is using anymore.
+	for (auto iter = ladders.begin(); iter != ladders.end();) {
+		if (iter->second.expired()) {
+			iter = ladders.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+
+	auto key = std::make_tuple(video, width, height, format);
+	if (auto iter = ladders.find(key); iter != ladders.end()) {
+		if (auto ladder = iter->second.lock(); ladder) {
+			return ladder;
+		}
+	}
+
+	auto ladder  = std::make_shared<gpu_ladder>(video, width, height, format);
+	ladders[key] = ladder;
+	return ladder;
+}
@@ -0,0 +1,53 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gfx/gfx-mipmapper.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include "warning-enable.hpp"
+
+namespace streamfx::ffmpeg {
+	/** Uploads each frame of a video output to the GPU once, for every encoder converting it there.
+	 *
+	 * Encoders producing smaller renditions of the same frame sample the mip chain instead of the frame itself, so the
+	 * whole ladder of renditions is fed from a single upload and a single downscale chain.
+	 */
+	class gpu_ladder {
+		std::mutex                                    _lock;
+		std::shared_ptr<::streamfx::gfx::mipmapper>   _mipmapper;
+		std::shared_ptr<::streamfx::obs::gs::texture> _input;
+		std::shared_ptr<::streamfx::obs::gs::texture> _mipmapped;
+		bool                                          _mipmapped_valid;
+		std::array<const void*, MAX_AV_PLANES>        _source;
+		uint64_t                                      _uploaded;
+		uint64_t                                      _lifetime;
+		std::atomic<uint64_t>                         _shared;
+
+		public:
+		gpu_ladder(video_t* video, uint32_t width, uint32_t height, gs_color_format format);
+		~gpu_ladder();
+
+		/** Retrieve the texture holding a frame from OBS, uploading it if nobody did so yet.
+		 *
+		 * Must be called with the graphics context entered. The texture is only valid until the next frame arrives.
+		 *
+		 * @param mipmapped Retrieve the mip-mapped version instead, for sampling at a smaller size.
+		 */
+		std::shared_ptr<::streamfx::obs::gs::texture> get(const struct encoder_frame* frame, bool mipmapped);
+
+		uint64_t shared() const;
+
+		public:
+		static std::shared_ptr<gpu_ladder> subscribe(video_t* video, uint32_t width, uint32_t height, gs_color_format format);
+	};
+} // namespace streamfx::ffmpeg
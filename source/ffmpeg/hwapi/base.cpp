@@ -3,3 +3,10 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "base.hpp"
+
+void streamfx::ffmpeg::hwapi::instance::copy_from_obs_textures(AVBufferRef*, gs_texture_t* const[], std::shared_ptr<AVFrame>)
+{
+	throw std::runtime_error("Copying from textures is not supported by this API.");
+}
+
+void streamfx::ffmpeg::hwapi::instance::set_pipeline_depth(std::size_t) {}
@@ -15,6 +15,7 @@ extern "C" {
 #include "warning-disable.hpp"
 #include <libavutil/frame.h>
 #include <libavutil/hwcontext.h>
+#include <libavutil/pixfmt.h>
 #include "warning-enable.hpp"
 }
 
@@ -22,6 +23,7 @@ namespace streamfx::ffmpeg::hwapi {
 	struct device {
 		std::pair<int64_t, int64_t> id;
 		std::string                 name;
+		uint32_t                    vendor = 0; // PCI vendor id, or 0 if unknown.
 	};
 
 	class instance {
@@ -30,11 +32,22 @@ namespace streamfx::ffmpeg::hwapi {
 
 		virtual AVBufferRef* create_device_context() = 0;
 
+		virtual AVPixelFormat get_pixel_format() = 0;
+
 		virtual std::shared_ptr<AVFrame> allocate_frame(AVBufferRef* frames) = 0;
 
 		virtual void copy_from_obs(AVBufferRef* frames, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key, std::shared_ptr<AVFrame> frame) = 0;
 
 		virtual std::shared_ptr<AVFrame> avframe_from_obs(AVBufferRef* frames, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key) = 0;
+
+		/** Copy the planes of an OBS texture into a frame, for platforms that have no shared texture handles.
+		 *
+		 * @param textures One texture per plane, as handed to the encoder by OBS.
+		 */
+		virtual void copy_from_obs_textures(AVBufferRef* frames, gs_texture_t* const textures[], std::shared_ptr<AVFrame> frame);
+
+		/** Hint at how many copies may be in flight at once, usually the number of frames the encoder lags behind. */
+		virtual void set_pipeline_depth(std::size_t depth);
 	};
 
 	class base {
@@ -46,5 +59,8 @@ namespace streamfx::ffmpeg::hwapi {
 		virtual std::shared_ptr<hwapi::instance> create(const hwapi::device& target) = 0;
 
 		virtual std::shared_ptr<hwapi::instance> create_from_obs() = 0;
+
+		/** Adapter that OBS renders on, which is the only one textures from OBS can reach without a copy between GPUs. */
+		virtual hwapi::device get_obs_adapter() = 0;
 	};
 } // namespace streamfx::ffmpeg::hwapi
@@ -10,6 +10,7 @@
 
 #include "warning-disable.hpp"
 #include <sstream>
+#include <thread>
 #include <vector>
 #include "warning-enable.hpp"
 
@@ -21,6 +22,22 @@ extern "C" {
 
 using namespace streamfx::ffmpeg::hwapi;
 
+static device device_from_adapter(IDXGIAdapter1* adapter)
+{
+	DXGI_ADAPTER_DESC1 desc = DXGI_ADAPTER_DESC1();
+	adapter->GetDesc1(&desc);
+
+	std::vector<char> buf(1024);
+	std::size_t       len = static_cast<size_t>(snprintf(buf.data(), buf.size(), "%ls (VEN_%04x/DEV_%04x/SUB_%04x/REV_%04x)", desc.Description, desc.VendorId, desc.DeviceId, desc.SubSysId, desc.Revision));
+
+	device dev;
+	dev.name      = std::string(buf.data(), buf.data() + len);
+	dev.id.first  = desc.AdapterLuid.HighPart;
+	dev.id.second = desc.AdapterLuid.LowPart;
+	dev.vendor    = desc.VendorId;
+	return dev;
+}
+
 d3d11::d3d11() : _dxgi_module(0), _d3d11_module(0)
 {
 	_dxgi_module = LoadLibraryW(L"dxgi.dll");
@@ -65,18 +82,8 @@ std::list<device> d3d11::enumerate_adapters()
 	// Enumerate Adapters
 	IDXGIAdapter1* dxgi_adapter = nullptr;
 	for (UINT idx = 0; !FAILED(_dxgifactory->EnumAdapters1(idx, &dxgi_adapter)); idx++) {
-		DXGI_ADAPTER_DESC1 desc = DXGI_ADAPTER_DESC1();
-		dxgi_adapter->GetDesc1(&desc);
-
-		std::vector<char> buf(1024);
-		std::size_t       len = static_cast<size_t>(snprintf(buf.data(), buf.size(), "%ls (VEN_%04x/DEV_%04x/SUB_%04x/REV_%04x)", desc.Description, desc.VendorId, desc.DeviceId, desc.SubSysId, desc.Revision));
-
-		device dev;
-		dev.name      = std::string(buf.data(), buf.data() + len);
-		dev.id.first  = desc.AdapterLuid.HighPart;
-		dev.id.second = desc.AdapterLuid.LowPart;
-
-		adapters.push_back(dev);
+		adapters.push_back(device_from_adapter(dxgi_adapter));
+		dxgi_adapter->Release();
 	}
 
 	return adapters;
@@ -124,14 +131,39 @@ std::shared_ptr<instance> d3d11::create_from_obs()
 	return std::make_shared<d3d11_instance>(device);
 }
 
+device d3d11::get_obs_adapter()
+{
+	auto gctx = streamfx::obs::gs::context();
+
+	if (GS_DEVICE_DIRECT3D_11 != gs_get_device_type()) {
+		throw std::runtime_error("OBS Device is not a D3D11 Device.");
+	}
+
+	// The LUID of the adapter behind the OBS device is what every other adapter is compared against.
+	auto                        obs_device = reinterpret_cast<ID3D11Device*>(gs_get_device_obj());
+	ATL::CComPtr<IDXGIDevice>   dxgi_device;
+	ATL::CComPtr<IDXGIAdapter>  dxgi_adapter;
+	ATL::CComPtr<IDXGIAdapter1> dxgi_adapter1;
+	if (FAILED(obs_device->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&dxgi_device))) || FAILED(dxgi_device->GetAdapter(&dxgi_adapter)) || FAILED(dxgi_adapter->QueryInterface(__uuidof(IDXGIAdapter1), reinterpret_cast<void**>(&dxgi_adapter1)))) {
+		throw std::runtime_error("Failed to find the adapter of the OBS device.");
+	}
+
+	return device_from_adapter(dxgi_adapter1);
+}
+
 struct D3D11AVFrame {
 	ATL::CComPtr<ID3D11Texture2D> handle;
 };
 
-d3d11_instance::d3d11_instance(ATL::CComPtr<ID3D11Device> device) : _device(device)
+// Upper limit of shared textures to remember, OBS itself uses far fewer than this.
+constexpr std::size_t max_inputs = 16;
+
+d3d11_instance::d3d11_instance(ATL::CComPtr<ID3D11Device> device) : _device(device), _inputs(), _copies(), _copy_index(0)
 {
 	// Acquire immediate rendering context.
 	device->GetImmediateContext(&_context);
+
+	set_pipeline_depth(1);
 }
 
 d3d11_instance::~d3d11_instance()
@@ -164,6 +196,11 @@ AVBufferRef* d3d11_instance::create_device_context()
 	return dctx_ref;
 }
 
+AVPixelFormat d3d11_instance::get_pixel_format()
+{
+	return AV_PIX_FMT_D3D11;
+}
+
 std::shared_ptr<AVFrame> d3d11_instance::allocate_frame(AVBufferRef* frames)
 {
 	auto gctx = streamfx::obs::gs::context();
@@ -186,41 +223,53 @@ void d3d11_instance::copy_from_obs(AVBufferRef*, uint32_t handle, uint64_t lock_
 {
 	auto gctx = streamfx::obs::gs::context();
 
-	// Attempt to acquire shared texture.
-	ATL::CComPtr<ID3D11Texture2D> input;
-	if (FAILED(_device->OpenSharedResource(reinterpret_cast<HANDLE>(static_cast<uintptr_t>(handle)), __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&input)))) {
-		throw std::runtime_error("Failed to open shared texture resource.");
+	auto& input  = open_input(handle);
+	auto  target = reinterpret_cast<ID3D11Texture2D*>(frame->data[0]);
+
+	// Copies between different formats are undefined, which happens if the encoder wanted a different bit depth.
+	{
+		D3D11_TEXTURE2D_DESC desc;
+		target->GetDesc(&desc);
+		if (desc.Format != input.format) {
+			throw std::runtime_error("Shared texture format does not match the encoder format.");
+		}
 	}
 
-	// Attempt to acquire texture mutex.
-	ATL::CComPtr<IDXGIKeyedMutex> mutex;
-	if (FAILED(input->QueryInterface(__uuidof(IDXGIKeyedMutex), reinterpret_cast<void**>(&mutex)))) {
-		throw std::runtime_error("Failed to retrieve mutex for texture resource.");
+	// Only block if the copy we are about to reuse the event of has not finished yet, which only happens if the GPU has
+	// fallen behind by the entire pipeline depth. Otherwise this copy simply queues up behind encoding the previous one.
+	auto& copy  = _copies[_copy_index];
+	_copy_index = (_copy_index + 1) % _copies.size();
+	if (copy) {
+		while (_context->GetData(copy, nullptr, 0, 0) == S_FALSE) {
+			std::this_thread::yield();
+		}
+	} else {
+		D3D11_QUERY_DESC desc = {D3D11_QUERY_EVENT, 0};
+		if (FAILED(_device->CreateQuery(&desc, &copy))) {
+			throw std::runtime_error("Failed to create copy event.");
+		}
 	}
 
 	// Attempt to acquire texture lock.
-	if (FAILED(mutex->AcquireSync(lock_key, 1000))) {
+	if (FAILED(input.mutex->AcquireSync(lock_key, 1000))) {
 		throw std::runtime_error("Failed to acquire lock on input texture.");
 	}
 
 	// Set some parameters on the input texture, and get its description.
-	UINT evict = input->GetEvictionPriority();
-	input->SetEvictionPriority(DXGI_RESOURCE_PRIORITY_MAXIMUM);
+	UINT evict = input.texture->GetEvictionPriority();
+	input.texture->SetEvictionPriority(DXGI_RESOURCE_PRIORITY_MAXIMUM);
 
-	// Clone the content of the input texture.
-	_context->CopyResource(reinterpret_cast<ID3D11Texture2D*>(frame->data[0]), input);
+	// Clone the content of the input texture into our slice of the texture array.
+	_context->CopySubresourceRegion(target, static_cast<UINT>(reinterpret_cast<intptr_t>(frame->data[1])), 0, 0, 0, input.texture, 0, nullptr);
+	_context->End(copy);
 
 	// Restore original parameters on input.
-	input->SetEvictionPriority(evict);
+	input.texture->SetEvictionPriority(evict);
 
-	// Release the acquired lock.
-	if (FAILED(mutex->ReleaseSync(lock_key))) {
+	// Hand the texture back to OBS right away, the copy itself is ordered on the GPU and does not need to finish first.
+	if (FAILED(input.mutex->ReleaseSync(*next_lock_key))) {
 		throw std::runtime_error("Failed to release lock on input texture.");
 	}
-
-	// Release the lock on the next texture.
-	// TODO: Determine if this is necessary.
-	mutex->ReleaseSync(*next_lock_key);
 }
 
 std::shared_ptr<AVFrame> d3d11_instance::avframe_from_obs(AVBufferRef* frames, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key)
@@ -232,4 +281,43 @@ std::shared_ptr<AVFrame> d3d11_instance::avframe_from_obs(AVBufferRef* frames, u
 	return frame;
 }
 
+void d3d11_instance::set_pipeline_depth(std::size_t depth)
+{
+	auto gctx = streamfx::obs::gs::context();
+
+	_copies.clear();
+	_copies.resize(std::max<std::size_t>(depth, 1));
+	_copy_index = 0;
+}
+
+d3d11_instance::shared_texture& d3d11_instance::open_input(uint32_t handle)
+{
+	if (auto kv = _inputs.find(handle); kv != _inputs.end()) {
+		return kv->second;
+	}
+
+	// Textures from a previous video reset can not be told apart from the current ones, so start over.
+	if (_inputs.size() >= max_inputs) {
+		_inputs.clear();
+	}
+
+	// Attempt to acquire shared texture.
+	shared_texture input;
+	if (FAILED(_device->OpenSharedResource(reinterpret_cast<HANDLE>(static_cast<uintptr_t>(handle)), __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&input.texture)))) {
+		throw std::runtime_error("Failed to open shared texture resource.");
+	}
+
+	// Attempt to acquire texture mutex.
+	if (FAILED(input.texture->QueryInterface(__uuidof(IDXGIKeyedMutex), reinterpret_cast<void**>(&input.mutex)))) {
+		throw std::runtime_error("Failed to retrieve mutex for texture resource.");
+	}
+
+	// NV12 for 8-bit and P010 for 10-bit video.
+	D3D11_TEXTURE2D_DESC desc;
+	input.texture->GetDesc(&desc);
+	input.format = desc.Format;
+
+	return _inputs.emplace(handle, input).first->second;
+}
+
 #endif
@@ -11,6 +11,8 @@
 #include <d3d11.h>
 #include <d3d11_1.h>
 #include <dxgi.h>
+#include <map>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::ffmpeg::hwapi {
@@ -37,22 +39,44 @@ namespace streamfx::ffmpeg::hwapi {
 		virtual std::shared_ptr<hwapi::instance> create(const hwapi::device& target) override;
 
 		virtual std::shared_ptr<hwapi::instance> create_from_obs() override;
+
+		virtual hwapi::device get_obs_adapter() override;
 	};
 
 	class d3d11_instance : public streamfx::ffmpeg::hwapi::instance {
+		struct shared_texture {
+			ATL::CComPtr<ID3D11Texture2D> texture;
+			ATL::CComPtr<IDXGIKeyedMutex> mutex;
+			DXGI_FORMAT                   format;
+		};
+
 		ATL::CComPtr<ID3D11Device>        _device;
 		ATL::CComPtr<ID3D11DeviceContext> _context;
 
+		// OBS cycles through a small set of shared textures, so each is only opened once.
+		std::map<uint32_t, shared_texture> _inputs;
+
+		// One event per copy in flight, used to only wait on the GPU once all of them are in use.
+		std::vector<ATL::CComPtr<ID3D11Query>> _copies;
+		std::size_t                            _copy_index;
+
 		public:
 		d3d11_instance(ATL::CComPtr<ID3D11Device> device);
 		virtual ~d3d11_instance();
 
 		virtual AVBufferRef* create_device_context() override;
 
+		virtual AVPixelFormat get_pixel_format() override;
+
 		virtual std::shared_ptr<AVFrame> allocate_frame(AVBufferRef* frames) override;
 
 		virtual void copy_from_obs(AVBufferRef* frames, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key, std::shared_ptr<AVFrame> frame) override;
 
 		virtual std::shared_ptr<AVFrame> avframe_from_obs(AVBufferRef* frames, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key) override;
+
+		virtual void set_pipeline_depth(std::size_t depth) override;
+
+		private:
+		shared_texture& open_input(uint32_t handle);
 	};
 } // namespace streamfx::ffmpeg::hwapi
@@ -0,0 +1,297 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#ifdef D_PLATFORM_LINUX
+
+#include "vaapi.hpp"
+#include "gfx/gfx-opengl.hpp"
+#include "obs/gs/gs-helper.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "warning-enable.hpp"
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavutil/hwcontext_vaapi.h>
+#include "warning-enable.hpp"
+}
+
+using namespace streamfx::ffmpeg::hwapi;
+
+// From drm_fourcc.h, which we otherwise do not need.
+constexpr uint64_t drm_format_mod_invalid = 0x00ffffffffffffffull;
+
+static std::filesystem::path render_node_path(int64_t minor)
+{
+	return std::filesystem::path("/dev/dri") / ("renderD" + std::to_string(minor));
+}
+
+static uint32_t render_node_vendor(int64_t minor)
+{
+	std::ifstream file(std::filesystem::path("/sys/class/drm") / ("renderD" + std::to_string(minor)) / "device" / "vendor");
+	uint32_t      vendor = 0;
+	if (file >> std::hex >> vendor) {
+		return vendor;
+	}
+	return 0;
+}
+
+static uint32_t opengl_vendor(std::string_view name)
+{
+	std::string lower(name);
+	std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+	// Older versions of Mesa report "X.Org" for AMD GPUs.
+	if ((lower.find("nvidia") != std::string::npos) || (lower.find("nouveau") != std::string::npos)) {
+		return 0x10DE;
+	} else if ((lower.find("amd") != std::string::npos) || (lower.find("ati ") != std::string::npos) || (lower.find("x.org") != std::string::npos)) {
+		return 0x1002;
+	} else if (lower.find("intel") != std::string::npos) {
+		return 0x8086;
+	}
+	return 0;
+}
+
+vaapi::vaapi() : _library(), _vaQueryVendorString(nullptr)
+{
+	// Check if there even is a usable libva, so that we fail early instead of on the first frame.
+	_library             = ::streamfx::util::library::load(std::filesystem::path("libva.so.2"));
+	_vaQueryVendorString = reinterpret_cast<vaQueryVendorString_t>(_library->load_symbol("vaQueryVendorString"));
+}
+
+vaapi::~vaapi() {}
+
+std::list<device> vaapi::enumerate_adapters()
+{
+	std::list<device> adapters;
+
+	std::error_code ec;
+	for (auto& entry : std::filesystem::directory_iterator("/dev/dri", ec)) {
+		std::string name = entry.path().filename().string();
+		if (name.rfind("renderD", 0) != 0) {
+			continue;
+		}
+
+		device dev;
+		dev.id.first  = std::stoll(name.substr(7));
+		dev.id.second = 0;
+		dev.name      = entry.path().string();
+		dev.vendor    = render_node_vendor(dev.id.first);
+
+		// Append the driver description if we can open the device.
+		AVBufferRef* ctx = nullptr;
+		if (av_hwdevice_ctx_create(&ctx, AV_HWDEVICE_TYPE_VAAPI, dev.name.c_str(), nullptr, 0) >= 0) {
+			auto hwctx = reinterpret_cast<AVVAAPIDeviceContext*>(reinterpret_cast<AVHWDeviceContext*>(ctx->data)->hwctx);
+			if (const char* vendor = _vaQueryVendorString ? _vaQueryVendorString(hwctx->display) : nullptr; vendor) {
+				dev.name = dev.name + " (" + vendor + ")";
+			}
+			av_buffer_unref(&ctx);
+		}
+
+		adapters.push_back(dev);
+	}
+	adapters.sort([](const device& a, const device& b) { return a.id.first < b.id.first; });
+
+	return adapters;
+}
+
+std::shared_ptr<instance> vaapi::create(const device& target)
+{
+	AVBufferRef* ctx  = nullptr;
+	std::string  path = render_node_path(target.id.first).string();
+	if (int res = av_hwdevice_ctx_create(&ctx, AV_HWDEVICE_TYPE_VAAPI, path.c_str(), nullptr, 0); res < 0) {
+		throw std::runtime_error("Failed to create VA-API device for target.");
+	}
+
+	return std::make_shared<vaapi_instance>(ctx);
+}
+
+std::shared_ptr<instance> vaapi::create_from_obs()
+{
+	auto gctx = streamfx::obs::gs::context();
+
+	if (GS_DEVICE_OPENGL != gs_get_device_type()) {
+		throw std::runtime_error("OBS Device is not an OpenGL Device.");
+	}
+
+	// Prefer the render node OBS is most likely on, then fall back to the first usable one.
+	auto preferred = get_obs_adapter();
+	try {
+		return create(preferred);
+	} catch (...) {
+	}
+	for (auto& adapter : enumerate_adapters()) {
+		if (adapter.id == preferred.id) {
+			continue;
+		}
+		try {
+			return create(adapter);
+		} catch (...) {
+		}
+	}
+	throw std::runtime_error("No usable VA-API device found.");
+}
+
+device vaapi::get_obs_adapter()
+{
+	auto gctx = streamfx::obs::gs::context();
+
+	if (GS_DEVICE_OPENGL != gs_get_device_type()) {
+		throw std::runtime_error("OBS Device is not an OpenGL Device.");
+	}
+
+	// OpenGL has no way to tell us which render node it uses, only the vendor of the driver. Multiple GPUs from the
+	// same vendor can therefore not be told apart, in which case the first one wins.
+	auto adapters = enumerate_adapters();
+	if (adapters.empty()) {
+		throw std::runtime_error("No VA-API devices found.");
+	}
+	if (uint32_t vendor = opengl_vendor(::streamfx::gfx::opengl::get()->get_vendor()); vendor != 0) {
+		for (auto& adapter : adapters) {
+			if (adapter.vendor == vendor) {
+				return adapter;
+			}
+		}
+	}
+	return adapters.front();
+}
+
+vaapi_instance::vaapi_instance(AVBufferRef* device) : _library(), _vaExportSurfaceHandle(nullptr), _vaSyncSurface(nullptr), _device(device), _display(nullptr), _surfaces()
+{
+	_display = reinterpret_cast<AVVAAPIDeviceContext*>(reinterpret_cast<AVHWDeviceContext*>(_device->data)->hwctx)->display;
+
+	// FFmpeg already depends on libva, so this just gives us access to what is already loaded.
+	_library               = ::streamfx::util::library::load(std::filesystem::path("libva.so.2"));
+	_vaExportSurfaceHandle = reinterpret_cast<vaExportSurfaceHandle_t>(_library->load_symbol("vaExportSurfaceHandle"));
+	_vaSyncSurface         = reinterpret_cast<vaSyncSurface_t>(_library->load_symbol("vaSyncSurface"));
+	if (!_vaExportSurfaceHandle || !_vaSyncSurface) {
+		av_buffer_unref(&_device);
+		throw std::runtime_error("VA-API is too old, surface export is not supported.");
+	}
+}
+
+vaapi_instance::~vaapi_instance()
+{
+	if (!_surfaces.empty()) {
+		auto gctx = streamfx::obs::gs::context();
+		for (auto& kv : _surfaces) {
+			for (auto texture : kv.second) {
+				gs_texture_destroy(texture);
+			}
+		}
+		_surfaces.clear();
+	}
+
+	av_buffer_unref(&_device);
+}
+
+AVBufferRef* vaapi_instance::create_device_context()
+{
+	AVBufferRef* dctx_ref = av_buffer_ref(_device);
+	if (!dctx_ref)
+		throw std::runtime_error("Failed to reference AVHWDeviceContext.");
+
+	return dctx_ref;
+}
+
+AVPixelFormat vaapi_instance::get_pixel_format()
+{
+	return AV_PIX_FMT_VAAPI;
+}
+
+std::shared_ptr<AVFrame> vaapi_instance::allocate_frame(AVBufferRef* frames)
+{
+	auto frame = std::shared_ptr<AVFrame>(av_frame_alloc(), [](AVFrame* frame) { av_frame_free(&frame); });
+
+	if (av_hwframe_get_buffer(frames, frame.get(), 0) < 0) {
+		throw std::runtime_error("Failed to create AVFrame.");
+	}
+
+	return frame;
+}
+
+void vaapi_instance::copy_from_obs(AVBufferRef*, uint32_t, uint64_t, uint64_t*, std::shared_ptr<AVFrame>)
+{
+	throw std::runtime_error("VA-API has no support for shared texture handles.");
+}
+
+std::shared_ptr<AVFrame> vaapi_instance::avframe_from_obs(AVBufferRef*, uint32_t, uint64_t, uint64_t*)
+{
+	throw std::runtime_error("VA-API has no support for shared texture handles.");
+}
+
+void vaapi_instance::copy_from_obs_textures(AVBufferRef* frames, gs_texture_t* const textures[], std::shared_ptr<AVFrame> frame)
+{
+	auto gctx = streamfx::obs::gs::context();
+
+	VASurfaceID surface = static_cast<VASurfaceID>(reinterpret_cast<uintptr_t>(frame->data[3]));
+
+	// The surface may still be read by a previous encode, which we must not overwrite.
+	if (_vaSyncSurface(_display, surface) != VA_STATUS_SUCCESS) {
+		throw std::runtime_error("Failed to synchronize with VA-API surface.");
+	}
+
+	// Copy both planes entirely on the GPU, the frame never touches system memory.
+	bool  deep   = reinterpret_cast<AVHWFramesContext*>(frames->data)->sw_format == AV_PIX_FMT_P010;
+	auto& planes = import_surface(surface, deep);
+	gs_copy_texture(planes[0], textures[0]);
+	gs_copy_texture(planes[1], textures[1]);
+	gs_flush();
+}
+
+std::array<gs_texture_t*, 2>& vaapi_instance::import_surface(VASurfaceID surface, bool deep)
+{
+	if (auto kv = _surfaces.find(surface); kv != _surfaces.end()) {
+		return kv->second;
+	}
+
+	// Export the surface as one DMA-BUF layer per plane, which OpenGL can then import as regular textures.
+	VADRMPRIMESurfaceDescriptor desc = {};
+	if (_vaExportSurfaceHandle(_display, surface, VA_SURFACE_ATTRIB_MEM_TYPE_DRM_PRIME_2, VA_EXPORT_SURFACE_WRITE_ONLY | VA_EXPORT_SURFACE_SEPARATE_LAYERS, &desc) != VA_STATUS_SUCCESS) {
+		throw std::runtime_error("Failed to export VA-API surface.");
+	}
+	if (desc.num_layers != 2) {
+		for (uint32_t idx = 0; idx < desc.num_objects; idx++) {
+			close(desc.objects[idx].fd);
+		}
+		throw std::runtime_error("Exported VA-API surface is not in a two plane format.");
+	}
+
+	std::array<gs_texture_t*, 2> planes = {nullptr, nullptr};
+	for (uint32_t idx = 0; idx < 2; idx++) {
+		auto&    layer    = desc.layers[idx];
+		auto&    object   = desc.objects[layer.object_index[0]];
+		int      fd       = object.fd;
+		uint32_t pitch    = layer.pitch[0];
+		uint32_t offset   = layer.offset[0];
+		uint64_t modifier = object.drm_format_modifier;
+
+		// P010 keeps 10-bit samples in 16-bit words, matching the R16 and RG16 textures OBS hands us.
+		gs_color_format format = deep ? (idx ? GS_RG16 : GS_R16) : (idx ? GS_R8G8 : GS_R8);
+
+		planes[idx] = gs_texture_create_from_dmabuf(desc.width >> idx, desc.height >> idx, layer.drm_format, format, 1, &fd, &pitch, &offset, (modifier != drm_format_mod_invalid) ? &modifier : nullptr);
+	}
+
+	// The driver holds on to its own references, so we no longer need the file descriptors.
+	for (uint32_t idx = 0; idx < desc.num_objects; idx++) {
+		close(desc.objects[idx].fd);
+	}
+
+	if (!planes[0] || !planes[1]) {
+		gs_texture_destroy(planes[0]);
+		gs_texture_destroy(planes[1]);
+		throw std::runtime_error("Failed to import VA-API surface into OBS.");
+	}
+
+	return _surfaces.emplace(surface, planes).first->second;
+}
+
+#endif
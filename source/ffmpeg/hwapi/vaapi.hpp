@@ -0,0 +1,69 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "base.hpp"
+#include "util/util-library.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <map>
+#include <va/va.h>
+#include <va/va_drmcommon.h>
+#include "warning-enable.hpp"
+
+namespace streamfx::ffmpeg::hwapi {
+	class vaapi : public streamfx::ffmpeg::hwapi::base {
+		typedef const char* (*vaQueryVendorString_t)(VADisplay);
+
+		std::shared_ptr<::streamfx::util::library> _library;
+		vaQueryVendorString_t                      _vaQueryVendorString;
+
+		public:
+		vaapi();
+		virtual ~vaapi();
+
+		virtual std::list<hwapi::device> enumerate_adapters() override;
+
+		virtual std::shared_ptr<hwapi::instance> create(const hwapi::device& target) override;
+
+		virtual std::shared_ptr<hwapi::instance> create_from_obs() override;
+
+		virtual hwapi::device get_obs_adapter() override;
+	};
+
+	class vaapi_instance : public streamfx::ffmpeg::hwapi::instance {
+		typedef VAStatus (*vaExportSurfaceHandle_t)(VADisplay, VASurfaceID, uint32_t, uint32_t, void*);
+		typedef VAStatus (*vaSyncSurface_t)(VADisplay, VASurfaceID);
+
+		std::shared_ptr<::streamfx::util::library> _library;
+		vaExportSurfaceHandle_t                    _vaExportSurfaceHandle;
+		vaSyncSurface_t                            _vaSyncSurface;
+
+		AVBufferRef* _device;
+		VADisplay    _display;
+
+		// Surfaces imported into OBS, one texture per plane.
+		std::map<VASurfaceID, std::array<gs_texture_t*, 2>> _surfaces;
+
+		public:
+		vaapi_instance(AVBufferRef* device);
+		virtual ~vaapi_instance();
+
+		virtual AVBufferRef* create_device_context() override;
+
+		virtual AVPixelFormat get_pixel_format() override;
+
+		virtual std::shared_ptr<AVFrame> allocate_frame(AVBufferRef* frames) override;
+
+		virtual void copy_from_obs(AVBufferRef* frames, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key, std::shared_ptr<AVFrame> frame) override;
+
+		virtual std::shared_ptr<AVFrame> avframe_from_obs(AVBufferRef* frames, uint32_t handle, uint64_t lock_key, uint64_t* next_lock_key) override;
+
+		virtual void copy_from_obs_textures(AVBufferRef* frames, gs_texture_t* const textures[], std::shared_ptr<AVFrame> frame) override;
+
+		private:
+		std::array<gs_texture_t*, 2>& import_surface(VASurfaceID surface, bool deep);
+	};
+} // namespace streamfx::ffmpeg::hwapi
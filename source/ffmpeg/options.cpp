@@ -0,0 +1,206 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "options.hpp"
+#include "tools.hpp"
+
+#include "warning-disable.hpp"
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include <stack>
+#include "warning-enable.hpp"
+
+using namespace streamfx::ffmpeg;
+
+// Settings rarely change, so a handful of entries covers every encoder that is in use.
+constexpr std::size_t cache_limit = 32;
+
+option_list::option_list(std::string_view text, const AVCodec* codec) : _options(), _valid(nullptr)
+{
+	// A throwaway context lets FFmpeg validate both keys and values exactly like it would on the real context.
+	std::shared_ptr<AVCodecContext> test{avcodec_alloc_context3(codec), [](AVCodecContext* ctx) { avcodec_free_context(&ctx); }};
+	if (!test) {
+		throw std::bad_alloc();
+	}
+
+	// We want to parse an FFmpeg commandline option set here, so every option must look like "-key=value".
+	for (const auto& opt : tokenize(text)) {
+		option entry{"", "", AV_OPT_TYPE_STRING, ""};
+
+		const char* cstr  = opt.c_str();
+		const char* eq_at = strchr(cstr, '=');
+		if (opt.at(0) != '-') {
+			entry.key   = opt;
+			entry.error = "Malformed, must start with a '-'.";
+		} else if (eq_at == nullptr) {
+			entry.key   = opt.substr(1);
+			entry.error = "Malformed, must contain a '='.";
+		} else {
+			entry.key   = opt.substr(1, static_cast<size_t>((eq_at - cstr) - 1));
+			entry.value = opt.substr(static_cast<size_t>((eq_at - cstr) + 1));
+
+			if (auto* avopt = av_opt_find(test.get(), entry.key.c_str(), nullptr, 0, AV_OPT_SEARCH_CHILDREN); avopt) {
+				entry.type = avopt->type;
+				if (int res = av_opt_set(test.get(), entry.key.c_str(), entry.value.c_str(), AV_OPT_SEARCH_CHILDREN); res < 0) {
+					entry.error = ::streamfx::ffmpeg::tools::get_error_description(res);
+				}
+			} else {
+				entry.error = "Unknown option.";
+			}
+		}
+
+		if (entry.error.empty()) {
+			av_dict_set(&_valid, entry.key.c_str(), entry.value.c_str(), 0);
+		}
+		_options.push_back(std::move(entry));
+	}
+}
+
+option_list::~option_list()
+{
+	av_dict_free(&_valid);
+}
+
+void option_list::apply(void* obj) const
+{
+	if (!_valid) {
+		return;
+	}
+
+	// av_opt_set_dict2 consumes what it applied, so hand it a copy and report only what is left over.
+	AVDictionary* remaining = nullptr;
+	av_dict_copy(&remaining, _valid, 0);
+	if (int res = av_opt_set_dict2(obj, &remaining, AV_OPT_SEARCH_CHILDREN); res < 0) {
+		DLOG_WARNING("Applying custom options failed: %s", ::streamfx::ffmpeg::tools::get_error_description(res));
+	}
+	for (AVDictionaryEntry* entry = av_dict_get(remaining, "", nullptr, AV_DICT_IGNORE_SUFFIX); entry; entry = av_dict_get(remaining, "", entry, AV_DICT_IGNORE_SUFFIX)) {
+		DLOG_WARNING("Option '%s' (value: '%s') was not applied.", entry->key, entry->value);
+	}
+	av_dict_free(&remaining);
+}
+
+std::list<option_list::option> const& option_list::options() const
+{
+	return _options;
+}
+
+bool option_list::has_errors() const
+{
+	for (const auto& opt : _options) {
+		if (!opt.error.empty()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+std::shared_ptr<const option_list> option_list::parse(std::string_view text, const AVCodec* codec)
+{
+	static std::map<std::pair<const AVCodec*, std::string>, std::shared_ptr<const option_list>> cache;
+	static std::mutex                                                                              mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            key = std::make_pair(codec, std::string{text});
+	if (auto iter = cache.find(key); iter != cache.end()) {
+		return iter->second;
+	}
+
+	auto result = std::make_shared<const option_list>(text, codec);
+	if (cache.size() >= cache_limit) {
+		cache.clear();
+	}
+	cache.emplace(std::move(key), result);
+	return result;
+}
+
+std::list<std::string> option_list::tokenize(std::string_view text)
+{
+	// Steps to properly parse a command line:
+	// 1. Split by space and package by quotes.
+	// 2. Parse each resulting option individually.
+
+	// First, we split by space and of course respect quotes while doing so.
+	// That means that "-foo= bar" is stored as std::string("-foo= bar"),
+	//  and things like -foo="bar" is stored as std::string("-foo=\"bar\"").
+	// However "-foo"=bar" -foo2=bar" is stored as std::string("-foo=bar -foo2=bar")
+	//  because the quote was not escaped.
+	std::list<std::string> opts;
+	std::stringstream      opt_stream{std::ios_base::in | std::ios_base::out | std::ios_base::binary};
+	std::stack<char>       quote_stack;
+	for (std::size_t p = 0; p <= text.size(); p++) {
+		char here = p < text.size() ? text.at(p) : 0;
+
+		if (here == '\\') {
+			std::size_t p2 = p + 1;
+			if (p2 < text.size()) {
+				char here2 = text.at(p2);
+				if (isdigit(here2)) { // Octal
+					// Not supported yet.
+					p++;
+				} else if (here2 == 'x') { // Hexadecimal
+					// Not supported yet.
+					p += 3;
+				} else if (here2 == 'u') { // 4 or 8 wide Unicode.
+					// Not supported yet.
+				} else if (here2 == 'a') {
+					opt_stream << '\a';
+					p++;
+				} else if (here2 == 'b') {
+					opt_stream << '\b';
+					p++;
+				} else if (here2 == 'f') {
+					opt_stream << '\f';
+					p++;
+				} else if (here2 == 'n') {
+					opt_stream << '\n';
+					p++;
+				} else if (here2 == 'r') {
+					opt_stream << '\r';
+					p++;
+				} else if (here2 == 't') {
+					opt_stream << '\t';
+					p++;
+				} else if (here2 == 'v') {
+					opt_stream << '\v';
+					p++;
+				} else if (here2 == '\\') {
+					opt_stream << '\\';
+					p++;
+				} else if (here2 == '\'') {
+					opt_stream << '\'';
+					p++;
+				} else if (here2 == '"') {
+					opt_stream << '"';
+					p++;
+				} else if (here2 == '?') {
+					opt_stream << '\?';
+					p++;
+				}
+			}
+		} else if ((here == '\'') || (here == '"')) {
+			if (quote_stack.size() > 1) {
+				opt_stream << here;
+			}
+			if (quote_stack.size() == 0) {
+				quote_stack.push(here);
+			} else if (quote_stack.top() == here) {
+				quote_stack.pop();
+			} else {
+				quote_stack.push(here);
+			}
+		} else if ((here == 0) || ((here == ' ') && (quote_stack.size() == 0))) {
+			std::string ropt = opt_stream.str();
+			if (ropt.size() > 0) {
+				opts.push_back(ropt);
+				opt_stream.str(std::string());
+				opt_stream.clear();
+			}
+		} else {
+			opt_stream << here;
+		}
+	}
+
+	return opts;
+}
@@ -0,0 +1,64 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "warning-enable.hpp"
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavcodec/avcodec.h>
+#include <libavutil/dict.h>
+#include <libavutil/opt.h>
+#include "warning-enable.hpp"
+}
+
+namespace streamfx::ffmpeg {
+	/** A list of FFmpeg options parsed from a command line like "-key=value -key2="other value"".
+	 *
+	 * Every option is validated against the codec once while parsing, so that invalid options are known before the
+	 * encoder is ever opened, and only valid options are ever applied.
+	 */
+	class option_list {
+		public:
+		struct option {
+			std::string  key;
+			std::string  value;
+			AVOptionType type;
+			std::string  error; // Empty if the option is valid.
+		};
+
+		private:
+		std::list<option> _options;
+		AVDictionary*     _valid;
+
+		public:
+		option_list(std::string_view text, const AVCodec* codec);
+		~option_list();
+
+		/** Apply all valid options to an AVCodecContext or any other AVClass based object. */
+		void apply(void* obj) const;
+
+		std::list<option> const& options() const;
+
+		/** Does the list contain any invalid options? */
+		bool has_errors() const;
+
+		public:
+		/** Parse the given text for a codec, or reuse the result of an earlier parse of the same text. */
+		static std::shared_ptr<const option_list> parse(std::string_view text, const AVCodec* codec);
+
+		private:
+		static std::list<std::string> tokenize(std::string_view text);
+	};
+} // namespace streamfx::ffmpeg
@@ -0,0 +1,104 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "packet-pool.hpp"
+
+#include "warning-disable.hpp"
+#include <cstring>
+#include "warning-enable.hpp"
+
+using namespace streamfx::ffmpeg;
+
+packet_pool::packet_pool() : _lock(), _pools(), _allocated(0), _allocations(0), _packets(0)
+{
+	_pools.fill(nullptr);
+}
+
+packet_pool::~packet_pool()
+{
+	// Buffers still in use keep their pool alive until they are released.
+	for (auto& pool : _pools) {
+		if (pool) {
+			av_buffer_pool_uninit(&pool);
+		}
+	}
+}
+
+void packet_pool::attach(AVCodecContext* context)
+{
+	context->opaque            = this;
+	context->get_encode_buffer = &packet_pool::get_encode_buffer;
+}
+
+uint64_t packet_pool::peak() const
+{
+	return _allocated.load(std::memory_order_relaxed);
+}
+
+uint64_t packet_pool::allocations() const
+{
+	return _allocations.load(std::memory_order_relaxed);
+}
+
+uint64_t packet_pool::packets() const
+{
+	return _packets.load(std::memory_order_relaxed);
+}
+
+bool packet_pool::get_buffer(AVPacket* packet)
+{
+	// Find the smallest size class that fits the packet and its padding.
+	std::size_t size  = static_cast<std::size_t>(packet->size) + AV_INPUT_BUFFER_PADDING_SIZE;
+	std::size_t shift = min_class;
+	while ((shift <= max_class) && ((std::size_t(1) << shift) < size)) {
+		shift++;
+	}
+	if (shift > max_class) {
+		return false;
+	}
+
+	AVBufferPool* pool = nullptr;
+	{ // Slice and frame threaded encoders may ask for buffers from multiple threads.
+		std::unique_lock<std::mutex> lock(_lock);
+		auto&                        entry = _pools[shift - min_class];
+		if (!entry) {
+			entry = av_buffer_pool_init2(std::size_t(1) << shift, this, &packet_pool::allocate, nullptr);
+		}
+		pool = entry;
+	}
+	if (!pool) {
+		return false;
+	}
+
+	packet->buf = av_buffer_pool_get(pool);
+	if (!packet->buf) {
+		return false;
+	}
+	packet->data = packet->buf->data;
+	std::memset(packet->data + packet->size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+
+	_packets.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+int packet_pool::get_encode_buffer(AVCodecContext* context, AVPacket* packet, int flags)
+{
+	auto self = reinterpret_cast<packet_pool*>(context->opaque);
+	if (self->get_buffer(packet)) {
+		return 0;
+	}
+	return avcodec_default_get_encode_buffer(context, packet, flags);
+}
+
+AVBufferRef* packet_pool::allocate(void* opaque, std::size_t size)
+{
+	auto self = reinterpret_cast<packet_pool*>(opaque);
+
+	AVBufferRef* buffer = av_buffer_alloc(size);
+	if (buffer) {
+		self->_allocated.fetch_add(size, std::memory_order_relaxed);
+		self->_allocations.fetch_add(1, std::memory_order_relaxed);
+	}
+	return buffer;
+}
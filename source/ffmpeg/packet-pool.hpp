@@ -0,0 +1,63 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include "warning-enable.hpp"
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavcodec/avcodec.h>
+#include <libavutil/buffer.h>
+#include "warning-enable.hpp"
+}
+
+namespace streamfx::ffmpeg {
+	/** Recycles the payload of encoded packets instead of allocating new memory for each one.
+	 *
+	 * Payloads are sorted into power of two size classes, each backed by an AVBufferPool, so a payload only becomes
+	 * available again once every reference to it is gone. Anything the pool can not provide falls back to the default
+	 * allocator. Only encoders with AV_CODEC_CAP_DR1 allocate their packets through this.
+	 */
+	class packet_pool {
+		static constexpr std::size_t min_class = 16; // 64 KiB
+		static constexpr std::size_t max_class = 26; // 64 MiB
+
+		std::mutex                                           _lock;
+		std::array<AVBufferPool*, max_class - min_class + 1> _pools;
+
+		std::atomic<uint64_t> _allocated;
+		std::atomic<uint64_t> _allocations;
+		std::atomic<uint64_t> _packets;
+
+		public:
+		packet_pool();
+		~packet_pool();
+
+		/** Make the codec context allocate its packets from this pool. Must be called before opening the context.
+		 *
+		 * The pool must outlive the codec context, but packets may outlive the pool.
+		 */
+		void attach(AVCodecContext* context);
+
+		/** Bytes held by the pool, which is also the most it ever needed at once. */
+		uint64_t peak() const;
+
+		uint64_t allocations() const;
+
+		uint64_t packets() const;
+
+		private:
+		bool get_buffer(AVPacket* packet);
+
+		static int          get_encode_buffer(AVCodecContext* context, AVPacket* packet, int flags);
+		static AVBufferRef* allocate(void* opaque, std::size_t size);
+	};
+} // namespace streamfx::ffmpeg
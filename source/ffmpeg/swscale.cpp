@@ -4,13 +4,41 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "swscale.hpp"
+#include "plugin.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
 #include <stdexcept>
+#include <thread>
 #include "warning-enable.hpp"
 
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavutil/pixdesc.h>
+#include "warning-enable.hpp"
+}
+
 using namespace streamfx::ffmpeg;
 
+// Frames smaller than this are not worth splitting up automatically.
+constexpr std::size_t slice_auto_threshold = 1920 * 1080;
+// Each band should be at least this many rows.
+constexpr uint32_t slice_minimum_rows = 64;
+// More than this is unlikely to help, as we will be limited by memory bandwidth.
+constexpr std::size_t slice_maximum = 16;
+
+// Number of rows to shift by to get the first row of a band in a plane.
+static int plane_row_shift(const AVPixFmtDescriptor* desc, int plane)
+{
+	if (!desc || (desc->flags & AV_PIX_FMT_FLAG_RGB) || (desc->comp[0].plane == plane)) {
+		return 0;
+	}
+	if (((desc->nb_components > 1) && (desc->comp[1].plane == plane)) || ((desc->nb_components > 2) && (desc->comp[2].plane == plane))) {
+		return desc->log2_chroma_h;
+	}
+	return 0; // Alpha
+}
+
 swscale::swscale() = default;
 
 swscale::~swscale()
@@ -144,6 +172,16 @@ bool swscale::is_target_full_range()
 	return this->target_full_range;
 }
 
+void swscale::set_slices(std::size_t count)
+{
+	this->slices = count;
+}
+
+std::size_t swscale::get_slices()
+{
+	return std::max<std::size_t>(this->slice_contexts.size(), 1);
+}
+
 bool swscale::initialize(int flags)
 {
 	if (this->context) {
@@ -163,11 +201,47 @@ bool swscale::initialize(int flags)
 
 	sws_setColorspaceDetails(this->context, sws_getCoefficients(source_colorspace), source_full_range ? 1 : 0, sws_getCoefficients(target_colorspace), target_full_range ? 1 : 0, 1L << 16 | 0L, 1L << 16 | 0L, 1L << 16 | 0L);
 
+	// Without scaling, every band of rows can be converted on its own as if it were a separate frame.
+	std::size_t count = (source_size == target_size) ? this->slices : 1;
+	if (count == 0) {
+		count = 1;
+		if ((static_cast<std::size_t>(target_size.first) * target_size.second) >= slice_auto_threshold) {
+			count = std::min<std::size_t>(std::max<std::size_t>(std::thread::hardware_concurrency(), 1), slice_maximum);
+		}
+	}
+	count = std::min<std::size_t>(count, std::max<uint32_t>(target_size.second / slice_minimum_rows, 1));
+	if (count > 1) {
+		// Bands must start on a row that exists in every plane of both formats.
+		const AVPixFmtDescriptor* source_desc = av_pix_fmt_desc_get(source_format);
+		const AVPixFmtDescriptor* target_desc = av_pix_fmt_desc_get(target_format);
+		uint32_t                  alignment   = 1u << std::max<int>(source_desc ? source_desc->log2_chroma_h : 0, target_desc ? target_desc->log2_chroma_h : 0);
+		uint32_t                  band_rows   = static_cast<uint32_t>((target_size.second + count - 1) / count);
+		band_rows                             = ((band_rows + alignment - 1) / alignment) * alignment;
+
+		for (uint32_t row = 0; row < target_size.second; row += band_rows) {
+			uint32_t    rows = std::min<uint32_t>(band_rows, target_size.second - row);
+			SwsContext* ctx  = sws_getContext(static_cast<int>(source_size.first), static_cast<int>(rows), source_format, static_cast<int>(target_size.first), static_cast<int>(rows), target_format, flags, nullptr, nullptr, nullptr);
+			if (!ctx) {
+				finalize();
+				return false;
+			}
+			sws_setColorspaceDetails(ctx, sws_getCoefficients(source_colorspace), source_full_range ? 1 : 0, sws_getCoefficients(target_colorspace), target_full_range ? 1 : 0, 1L << 16 | 0L, 1L << 16 | 0L, 1L << 16 | 0L);
+			this->slice_contexts.push_back(ctx);
+			this->slice_rows.emplace_back(row, rows);
+		}
+	}
+
 	return true;
 }
 
 bool swscale::finalize()
 {
+	for (auto ctx : this->slice_contexts) {
+		sws_freeContext(ctx);
+	}
+	this->slice_contexts.clear();
+	this->slice_rows.clear();
+
 	if (this->context) {
 		sws_freeContext(this->context);
 		this->context = nullptr;
@@ -181,6 +255,45 @@ int32_t swscale::convert(const uint8_t* const source_data[], const int source_st
 	if (!this->context) {
 		return 0;
 	}
+
+	// Whole frames are split into bands, with the first one converted on the calling thread.
+	if ((this->slice_contexts.size() > 1) && (source_row == 0) && (static_cast<uint32_t>(source_rows) == source_size.second)) {
+		const AVPixFmtDescriptor* source_desc = av_pix_fmt_desc_get(source_format);
+		const AVPixFmtDescriptor* target_desc = av_pix_fmt_desc_get(target_format);
+
+		auto convert_slice = [&](std::size_t idx) {
+			const uint8_t* slice_source[AV_NUM_DATA_POINTERS] = {};
+			uint8_t*       slice_target[AV_NUM_DATA_POINTERS] = {};
+			uint32_t       row                                = this->slice_rows[idx].first;
+			for (int plane = 0; plane < AV_NUM_DATA_POINTERS; plane++) {
+				if (plane < av_pix_fmt_count_planes(source_format)) {
+					slice_source[plane] = source_data[plane] + static_cast<std::ptrdiff_t>(row >> plane_row_shift(source_desc, plane)) * source_stride[plane];
+				}
+				if (plane < av_pix_fmt_count_planes(target_format)) {
+					slice_target[plane] = target_data[plane] + static_cast<std::ptrdiff_t>(row >> plane_row_shift(target_desc, plane)) * target_stride[plane];
+				}
+			}
+			return sws_scale(this->slice_contexts[idx], slice_source, source_stride, 0, static_cast<int>(this->slice_rows[idx].second), slice_target, target_stride);
+		};
+
+		// Bands never overlap, so no synchronization is necessary beyond waiting for them to finish.
+		std::vector<int> results(this->slice_contexts.size(), 0);
+		streamfx::threadpool()->parallel_for(0, this->slice_contexts.size(), 1, [&convert_slice, &results](std::size_t first, std::size_t last) {
+			for (std::size_t idx = first; idx < last; idx++) {
+				results[idx] = convert_slice(idx);
+			}
+		});
+
+		int height = 0;
+		for (auto result : results) {
+			if (result <= 0) {
+				return result;
+			}
+			height += result;
+		}
+		return height;
+	}
+
 	int height = sws_scale(this->context, source_data, source_stride, source_row, source_rows, target_data, target_stride);
 	return height;
 }
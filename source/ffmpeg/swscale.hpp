@@ -7,6 +7,7 @@
 
 #include "warning-disable.hpp"
 #include <utility>
+#include <vector>
 #include "warning-enable.hpp"
 
 extern "C" {
@@ -30,6 +31,11 @@ namespace streamfx::ffmpeg {
 
 		SwsContext* context = nullptr;
 
+		// Slice mode, one context per horizontal band of the frame.
+		std::size_t                                slices = 1;
+		std::vector<SwsContext*>                   slice_contexts;
+		std::vector<std::pair<uint32_t, uint32_t>> slice_rows;
+
 		public:
 		swscale();
 		~swscale();
@@ -60,6 +66,16 @@ namespace streamfx::ffmpeg {
 		void                          set_target_full_range(bool full_range);
 		bool                          is_target_full_range();
 
+		/** Convert frames in this many horizontal bands in parallel, must be set before initialize().
+		 *
+		 * Only used if source and target have the same size, as there is nothing to scale across bands then. A value
+		 * of 0 picks a count based on the frame size and the number of cores.
+		 */
+		void set_slices(std::size_t count);
+
+		/** Number of bands frames are actually converted in, only valid after initialize(). */
+		std::size_t get_slices();
+
 		bool initialize(int flags);
 		bool finalize();
 
@@ -9,6 +9,7 @@
 #include "warning-disable.hpp"
 #include <list>
 #include <sstream>
+#include <string_view>
 #include "warning-enable.hpp"
 
 extern "C" {
@@ -120,6 +121,20 @@ AVPixelFormat tools::get_least_lossy_format(const AVPixelFormat* haystack, AVPix
 	return avcodec_find_best_pix_fmt_of_list(haystack, needle, 0, &data_loss);
 }
 
+bool tools::can_obs_convert_to(AVPixelFormat v)
+{
+	switch (avpixelformat_to_obs_videoformat(v)) {
+	case VIDEO_FORMAT_I420:
+	case VIDEO_FORMAT_NV12:
+	case VIDEO_FORMAT_I444:
+	case VIDEO_FORMAT_I010:
+	case VIDEO_FORMAT_P010:
+		return true;
+	default:
+		return false;
+	}
+}
+
 AVColorRange tools::obs_to_av_color_range(video_range_type v)
 {
 	switch (v) {
@@ -248,6 +263,19 @@ bool tools::can_hardware_encode(const AVCodec* codec)
 	return false;
 }
 
+uint32_t tools::get_hardware_vendor(const AVCodec* codec)
+{
+	std::string_view name = codec->name;
+	if (name.find("_nvenc") != std::string_view::npos) {
+		return 0x10DE;
+	} else if (name.find("_amf") != std::string_view::npos) {
+		return 0x1002;
+	} else if (name.find("_qsv") != std::string_view::npos) {
+		return 0x8086;
+	}
+	return 0;
+}
+
 std::vector<AVPixelFormat> tools::get_software_formats(const AVPixelFormat* list)
 {
 	constexpr AVPixelFormat hardware_formats[] = {
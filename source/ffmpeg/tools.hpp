@@ -30,6 +30,9 @@ namespace streamfx::ffmpeg::tools {
 
 	AVPixelFormat get_least_lossy_format(const AVPixelFormat* haystack, AVPixelFormat needle);
 
+	/** Can libobs convert its video to this format on the GPU, so that an encoder can ask for it instead? */
+	bool can_obs_convert_to(AVPixelFormat v);
+
 	AVColorRange                  obs_to_av_color_range(video_range_type v);
 	AVColorSpace                  obs_to_av_color_space(video_colorspace v);
 	AVColorPrimaries              obs_to_av_color_primary(video_colorspace v);
@@ -37,6 +40,9 @@ namespace streamfx::ffmpeg::tools {
 
 	bool can_hardware_encode(const AVCodec* codec);
 
+	/** PCI vendor id of the only GPUs a hardware encoder can run on, or 0 if it isn't tied to a vendor. */
+	uint32_t get_hardware_vendor(const AVCodec* codec);
+
 	std::vector<AVPixelFormat> get_software_formats(const AVPixelFormat* list);
 
 	void context_setup_from_obs(const video_output_info* voi, AVCodecContext* context);
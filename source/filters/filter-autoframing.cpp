@@ -51,7 +51,9 @@
  * 
  * Advanced
  *   Provider: What provider should be used?
- *   Frequency: How often should we track? Every frame, every 2nd frame, etc.
+ *   Frequency: How often should we track? In Hz, seconds ("0.5 s") or frames ("3 f" for every 3rd frame).
+ *   Adaptive: Track less often while tracked elements barely move, and rely on motion prediction in between.
+ *   Batch: Share tracking with other sources of the same size, at a quarter of the resolution each.
  */
 
 #define ST_I18N "Filter.AutoFraming"
@@ -63,6 +65,15 @@
 #define ST_I18N_FRAMING_MODE_GROUP ST_I18N_TRACKING_MODE ".Group"
 #define ST_KEY_TRACKING_FREQUENCY "Tracking.Frequency"
 #define ST_I18N_TRACKING_FREQUENCY ST_I18N_TRACKING ".Frequency"
+#define ST_KEY_TRACKING_ADAPTIVE "Tracking.Adaptive"
+#define ST_I18N_TRACKING_ADAPTIVE ST_I18N_TRACKING ".Adaptive"
+#define ST_KEY_TRACKING_BATCH "Tracking.Batch"
+#define ST_I18N_TRACKING_BATCH ST_I18N_TRACKING ".Batch"
+
+// Adaptive tracking stretches the interval by up to this factor while tracked elements are still.
+#define ST_ADAPTIVE_MAXIMUM 4.f
+// Motion between two tracking attempts, relative to the element size, at which the interval is no longer stretched.
+#define ST_ADAPTIVE_MOTION 0.05f
 
 #define ST_I18N_MOTION ST_I18N ".Motion"
 #define ST_KEY_MOTION_PREDICTION "Motion.Prediction"
@@ -83,6 +94,7 @@
 #define ST_KEY_ADVANCED_PROVIDER "Provider"
 #define ST_I18N_ADVANCED_PROVIDER ST_I18N ".Provider"
 #define ST_I18N_ADVANCED_PROVIDER_NVIDIA_FACEDETECTION ST_I18N_ADVANCED_PROVIDER ".NVIDIA.FaceDetection"
+#define ST_I18N_ADVANCED_PROVIDER_SALIENCY ST_I18N_ADVANCED_PROVIDER ".Saliency"
 
 #define ST_KALMAN_EEC 1.0f
 
@@ -92,8 +104,15 @@ using streamfx::filter::autoframing::tracking_provider;
 
 static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-StreamFX/wiki/Filter-Auto-Framing";
 
+// Faces stay large enough to be found at this width, and detection gets much cheaper than at the full input size.
+static constexpr uint32_t DETECTION_WIDTH = 640;
+
+// The saliency provider works on the CPU, where a face is still a few dozen pixels at this width.
+static constexpr uint32_t SALIENCY_WIDTH = 96;
+
 static tracking_provider provider_priority[] = {
 	tracking_provider::NVIDIA_FACEDETECTION,
+	tracking_provider::SALIENCY,
 };
 
 inline std::pair<bool, double_t> parse_text_as_size(const char* text)
@@ -120,6 +139,8 @@ const char* streamfx::filter::autoframing::cstring(tracking_provider provider)
 		return D_TRANSLATE(S_STATE_AUTOMATIC);
 	case tracking_provider::NVIDIA_FACEDETECTION:
 		return D_TRANSLATE(ST_I18N_ADVANCED_PROVIDER_NVIDIA_FACEDETECTION);
+	case tracking_provider::SALIENCY:
+		return D_TRANSLATE(ST_I18N_ADVANCED_PROVIDER_SALIENCY);
 	default:
 		throw std::runtime_error("Missing Conversion Entry");
 	}
@@ -134,6 +155,8 @@ autoframing_instance::~autoframing_instance()
 {
 	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
 
+	_region_hints->withdraw(this);
+
 	{ // Unload the underlying effect ASAP.
 		std::unique_lock<std::mutex> ul(_provider_lock);
 
@@ -151,6 +174,9 @@ autoframing_instance::~autoframing_instance()
 			nvar_facedetection_unload();
 			break;
 #endif
+		case tracking_provider::SALIENCY:
+			saliency_unload();
+			break;
 		default:
 			break;
 		}
@@ -160,47 +186,31 @@ autoframing_instance::~autoframing_instance()
 autoframing_instance::autoframing_instance(obs_data_t* data, obs_source_t* self)
 	: source_instance(data, self),
 
-	  _dirty(true), _size(1, 1), _out_size(1, 1),
+	  _dirty(true), _input_fresh(false), _size(1, 1), _out_size(1, 1),
 
-	  _gfx_debug(), _standard_effect(), _input(), _vb(),
+	  _gfx_debug(), _standard_effect(), _input(), _vb(), _proxy(), _proxy_scale({1., 1.}),
 
 	  _provider(tracking_provider::INVALID), _provider_ui(tracking_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(),
 
-	  _track_mode(tracking_mode::SOLO), _track_frequency(1),
+	  _saliency_stage(nullptr), _saliency_staged(false), _saliency_scale({1., 1.}), _saliency_task(), _saliency_lock(), _saliency_results(), _saliency_complete(false),
+
+	  _track_mode(tracking_mode::SOLO), _track_frequency(1), _track_adaptive(false), _track_interval(1), _track_batch(false),
 
 	  _motion_smoothing(0.0), _motion_smoothing_kalman_pnc(1.), _motion_smoothing_kalman_mnc(1.), _motion_prediction(0.0),
 
 	  _frame_stability(0.), _frame_stability_kalman(1.), _frame_padding_prc(), _frame_padding(), _frame_offset_prc(), _frame_offset(), _frame_aspect_ratio(0.0),
 
-	  _track_frequency_counter(0), _tracked_elements(), _predicted_elements(),
+	  _track_frequency_counter(0), _tracked(), _track_cells(),
 
 	  _frame_pos_x({1., 1., 1., 1.}), _frame_pos_y({1., 1., 1., 1.}), _frame_pos({0, 0}), _frame_size({1, 1}),
 
+	  _region_hints(::streamfx::util::region_hints::get()),
+
 	  _debug(false)
 {
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 
-	{
-		::streamfx::obs::gs::context gctx;
-
-		// Get debug renderer.
-		_gfx_debug = ::streamfx::gfx::util::get();
-
-		// Create the render target for the input buffering.
-		_input = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
-		_input->render(1, 1); // Preallocate the RT on the driver and GPU.
-
-		// Load the required effect.
-		_standard_effect = std::make_shared<::streamfx::obs::gs::effect>(::streamfx::data_file_path("effects/standard.effect"));
-
-		// Create the Vertex Buffer for rendering.
-		_vb = std::make_shared<::streamfx::obs::gs::vertex_buffer>(uint32_t{4}, uint8_t{1});
-		vec3_set(_vb->at(0).position, 0, 0, 0);
-		vec3_set(_vb->at(1).position, 1, 0, 0);
-		vec3_set(_vb->at(2).position, 0, 1, 0);
-		vec3_set(_vb->at(3).position, 1, 1, 0);
-		_vb->update(true);
-	}
+	// Graphics resources are created by allocate() on the first render, so that loading doesn't wait for the GPU.
 
 	if (data) {
 		load(data);
@@ -231,7 +241,16 @@ void autoframing_instance::update(obs_data_t* data)
 		if (const char* text = obs_data_get_string(data, ST_KEY_TRACKING_FREQUENCY); text != nullptr) {
 			float value = 0.;
 			if (sscanf(text, "%f", &value) == 1) {
-				if (const char* seconds = strchr(text, 's'); seconds == nullptr) {
+				if (strstr(text, "fps") != nullptr) {
+					value = 1.f / value; // Hz -> seconds
+				} else if (const char* frames = strchr(text, 'f'); frames != nullptr) {
+					// Frames -> seconds
+					if (obs_video_info ovi; obs_get_video_info(&ovi) && (ovi.fps_num > 0)) {
+						value = value * static_cast<float>(ovi.fps_den) / static_cast<float>(ovi.fps_num);
+					} else {
+						value = value / 60.f;
+					}
+				} else if (const char* seconds = strchr(text, 's'); seconds == nullptr) {
 					value = 1.f / value; // Hz -> seconds
 				} else {
 					// No-op
@@ -240,6 +259,9 @@ void autoframing_instance::update(obs_data_t* data)
 			_track_frequency = value;
 		}
 	}
+	_track_adaptive          = obs_data_get_bool(data, ST_KEY_TRACKING_ADAPTIVE);
+	_track_batch             = obs_data_get_bool(data, ST_KEY_TRACKING_BATCH);
+	_track_interval          = _track_frequency;
 	_track_frequency_counter = 0;
 
 	// Motion
@@ -247,10 +269,10 @@ void autoframing_instance::update(obs_data_t* data)
 	_motion_smoothing            = static_cast<float>(obs_data_get_double(data, ST_KEY_MOTION_SMOOTHING)) / 100.f;
 	_motion_smoothing_kalman_pnc = streamfx::util::math::lerp<float>(1.0f, 0.00001f, _motion_smoothing);
 	_motion_smoothing_kalman_mnc = streamfx::util::math::lerp<float>(0.001f, 1000.0f, _motion_smoothing);
-	for (auto kv : _predicted_elements) {
+	for (std::size_t idx = 0, edx = _tracked.size(); idx < edx; idx++) {
 		// Regenerate filters.
-		kv.second->filter_pos_x = {_frame_stability_kalman, _motion_smoothing_kalman_mnc, ST_KALMAN_EEC, kv.second->filter_pos_x.get()};
-		kv.second->filter_pos_y = {_frame_stability_kalman, _motion_smoothing_kalman_mnc, ST_KALMAN_EEC, kv.second->filter_pos_y.get()};
+		_tracked.filter_x[idx] = {_frame_stability_kalman, _motion_smoothing_kalman_mnc, ST_KALMAN_EEC, _tracked.filter_x[idx].get()};
+		_tracked.filter_y[idx] = {_frame_stability_kalman, _motion_smoothing_kalman_mnc, ST_KALMAN_EEC, _tracked.filter_y[idx].get()};
 	}
 
 	// Framing
@@ -419,13 +441,60 @@ void autoframing_instance::video_tick(float_t seconds)
 		}
 	}
 
+	// Merge detections that completed since the last frame.
+	if (_provider_ready) {
+		std::unique_lock<std::mutex> ul(_provider_lock);
+		switch (_provider) {
+#ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
+		case tracking_provider::NVIDIA_FACEDETECTION:
+			nvar_facedetection_collect();
+			break;
+#endif
+		case tracking_provider::SALIENCY:
+			saliency_collect();
+			break;
+		default:
+			break;
+		}
+	}
+
 	// Update tracking.
 	tracking_tick(seconds);
 
+	// Inform encoders about the elements.
+	publish_region_hints();
+
 	// Mark the effect as dirty.
 	_dirty = true;
 }
 
+void autoframing_instance::allocate()
+{
+	// Get debug renderer.
+	_gfx_debug = ::streamfx::gfx::util::get();
+
+	// Load the required effect.
+	_standard_effect = std::make_shared<::streamfx::obs::gs::effect>(::streamfx::data_file_path("effects/standard.effect"));
+
+	// Create the Vertex Buffer for rendering.
+	_vb = std::make_shared<::streamfx::obs::gs::vertex_buffer>(uint32_t{4}, uint8_t{1});
+	vec3_set(_vb->at(0).position, 0, 0, 0);
+	vec3_set(_vb->at(1).position, 1, 0, 0);
+	vec3_set(_vb->at(2).position, 0, 1, 0);
+	vec3_set(_vb->at(3).position, 1, 1, 0);
+	_vb->update(true);
+
+	// Create the render target for the input buffering last, as it marks everything as allocated.
+	_input = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+}
+
+void autoframing_instance::prepare()
+{
+	if (!_input) {
+		allocate();
+	}
+}
+
 void autoframing_instance::video_render(gs_effect_t* effect)
 {
 	auto parent = obs_filter_get_parent(_self);
@@ -452,7 +521,16 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 	::streamfx::obs::gs::debug_marker profiler0_0{::streamfx::obs::gs::debug_color_gray, "'%s' on '%s'", obs_source_get_name(_self), obs_source_get_name(parent)};
 #endif
 
+	if (!_input) {
+		allocate();
+	}
+
 	if (_dirty) {
+		// Only detection and debug mode need the whole input, everything else draws the framed region straight from it.
+		_input_fresh = _debug || (_track_frequency_counter >= _track_interval);
+	}
+
+	if (_dirty && _input_fresh) {
 		// Capture the input.
 		if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
 			auto op = _input->render(width, height);
@@ -485,7 +563,7 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 		}
 
 		// Lock & Process the captured input with the provider.
-		if (_track_frequency_counter >= _track_frequency) {
+		if (_track_frequency_counter >= _track_interval) {
 			_track_frequency_counter = 0;
 
 			std::unique_lock<std::mutex> ul(_provider_lock);
@@ -495,14 +573,16 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 				nvar_facedetection_process();
 				break;
 #endif
+			case tracking_provider::SALIENCY:
+				saliency_process();
+				break;
 			default:
 				obs_source_skip_video_filter(_self);
 				return;
 			}
 		}
-
-		_dirty = false;
 	}
+	_dirty = false;
 
 	{ // Draw the result for the next filter to use.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
@@ -515,31 +595,50 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 				gs_draw_sprite(nullptr, 0, _size.first, _size.second);
 			}
 
-			for (auto kv : _predicted_elements) {
+			for (std::size_t idx = 0, edx = _tracked.size(); idx < edx; idx++) {
+				float pos_x  = _tracked.pos_x[idx];
+				float pos_y  = _tracked.pos_y[idx];
+				float size_x = _tracked.size_x[idx];
+				float size_y = _tracked.size_y[idx];
+
 				// Tracked Area (Red)
-				_gfx_debug->draw_rectangle(kv.first->pos.x - kv.first->size.x / 2.f, kv.first->pos.y - kv.first->size.y / 2.f, kv.first->size.x, kv.first->size.y, true, 0x7E0000FF);
+				_gfx_debug->draw_rectangle(pos_x - size_x / 2.f, pos_y - size_y / 2.f, size_x, size_y, true, 0x7E0000FF);
 
 				// Velocity Arrow (Black)
-				_gfx_debug->draw_arrow(kv.first->pos.x, kv.first->pos.y, kv.first->pos.x + kv.first->vel.x, kv.first->pos.y + kv.first->vel.y, 0., 0x7E000000);
+				_gfx_debug->draw_arrow(pos_x, pos_y, pos_x + _tracked.vel_x[idx], pos_y + _tracked.vel_y[idx], 0., 0x7E000000);
 
 				// Predicted Area (Orange)
-				_gfx_debug->draw_rectangle(kv.second->mp_pos.x - kv.first->size.x / 2.f, kv.second->mp_pos.y - kv.first->size.y / 2.f, kv.first->size.x, kv.first->size.y, true, 0x7E007EFF);
+				_gfx_debug->draw_rectangle(_tracked.mp_x[idx] - size_x / 2.f, _tracked.mp_y[idx] - size_y / 2.f, size_x, size_y, true, 0x7E007EFF);
 
 				// Filtered Area (Yellow)
-				_gfx_debug->draw_rectangle(kv.second->filter_pos_x.get() - kv.first->size.x / 2.f, kv.second->filter_pos_y.get() - kv.first->size.y / 2.f, kv.first->size.x, kv.first->size.y, true, 0x7E00FFFF);
+				_gfx_debug->draw_rectangle(_tracked.filter_x[idx].get() - size_x / 2.f, _tracked.filter_y[idx].get() - size_y / 2.f, size_x, size_y, true, 0x7E00FFFF);
 
 				// Offset Filtered Area (Blue)
-				_gfx_debug->draw_rectangle(kv.second->offset_pos.x - kv.first->size.x / 2.f, kv.second->offset_pos.y - kv.first->size.y / 2.f, kv.first->size.x, kv.first->size.y, true, 0x7EFF0000);
+				_gfx_debug->draw_rectangle(_tracked.offset_x[idx] - size_x / 2.f, _tracked.offset_y[idx] - size_y / 2.f, size_x, size_y, true, 0x7EFF0000);
 
 				// Padded Offset Filtered Area (Cyan)
-				_gfx_debug->draw_rectangle(kv.second->offset_pos.x - kv.second->pad_size.x / 2.f, kv.second->offset_pos.y - kv.second->pad_size.y / 2.f, kv.second->pad_size.x, kv.second->pad_size.y, true, 0x7EFFFF00);
+				_gfx_debug->draw_rectangle(_tracked.offset_x[idx] - _tracked.pad_x[idx] / 2.f, _tracked.offset_y[idx] - _tracked.pad_y[idx] / 2.f, _tracked.pad_x[idx], _tracked.pad_y[idx], true, 0x7EFFFF00);
 
 				// Aspect-Ratio-Corrected Padded Offset Filtered Area (Green)
-				_gfx_debug->draw_rectangle(kv.second->offset_pos.x - kv.second->aspected_size.x / 2.f, kv.second->offset_pos.y - kv.second->aspected_size.y / 2.f, kv.second->aspected_size.x, kv.second->aspected_size.y, true, 0x7E00FF00);
+				_gfx_debug->draw_rectangle(_tracked.offset_x[idx] - _tracked.aspected_x[idx] / 2.f, _tracked.offset_y[idx] - _tracked.aspected_y[idx] / 2.f, _tracked.aspected_x[idx], _tracked.aspected_y[idx], true, 0x7E00FF00);
 			}
 
 			// Final Region (White)
 			_gfx_debug->draw_rectangle(_frame_pos.x - _frame_size.x / 2.f, _frame_pos.y - _frame_size.y / 2.f, _frame_size.x, _frame_size.y, true, 0x7EFFFFFF);
+			_gfx_debug->flush();
+		} else if (!_input_fresh) {
+			// Scale the framed region up to the output size, and leave the rest to the viewport. With direct rendering
+			// allowed, the input is never copied at all.
+			if ((_frame_size.x < 1.f) || (_frame_size.y < 1.f) || !obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
+				obs_source_skip_video_filter(_self);
+				return;
+			}
+
+			gs_matrix_push();
+			gs_matrix_scale3f(static_cast<float>(_out_size.first) / _frame_size.x, static_cast<float>(_out_size.second) / _frame_size.y, 1.f);
+			gs_matrix_translate3f(-(_frame_pos.x - _frame_size.x / 2.f), -(_frame_pos.y - _frame_size.y / 2.f), 0.f);
+			obs_source_process_filter_end(_self, effect, _size.first, _size.second);
+			gs_matrix_pop();
 		} else {
 			float x0 = (_frame_pos.x - _frame_size.x / 2.f) / static_cast<float>(_size.first);
 			float x1 = (_frame_pos.x + _frame_size.x / 2.f) / static_cast<float>(_size.first);
@@ -592,119 +691,288 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 	}
 }
 
-void streamfx::filter::autoframing::autoframing_instance::tracking_tick(float seconds)
+static inline int64_t cell_key(int32_t x, int32_t y)
 {
-	{ // Increase the age of all elements, and kill off any that are "too old".
-		float threshold = (0.5f * (1.f / (1.f - _track_frequency)));
+	return (static_cast<int64_t>(x) << 32) | static_cast<uint32_t>(y);
+}
 
-		auto iter = _tracked_elements.begin();
-		while (iter != _tracked_elements.end()) {
-			// Increment the age by the tick duration.
-			(*iter)->age += seconds;
-
-			// If the age exceeds the threshold, remove it.
-			if ((*iter)->age >= threshold) {
-				if (iter == _tracked_elements.begin()) {
-					// Erase iter, then reset to start.
-					_predicted_elements.erase(*iter);
-					_tracked_elements.erase(iter);
-					iter = _tracked_elements.begin();
-				} else {
-					// Copy, then advance before erasing.
-					auto iter2 = iter;
-					iter++;
-					_predicted_elements.erase(*iter2);
-					_tracked_elements.erase(iter2);
-				}
-			} else {
-				// Move ahead.
-				iter++;
-			}
+std::size_t streamfx::filter::autoframing::autoframing_instance::track_store::add(const vec2& pos, const vec2& size, float conf, const streamfx::util::math::kalman1D<float>& fx, const streamfx::util::math::kalman1D<float>& fy)
+{
+	each([](auto& v) { v.emplace_back(); });
+
+	std::size_t idx = age.size() - 1;
+	age[idx]        = 0.;
+	confidence[idx] = conf;
+	pos_x[idx]      = pos.x;
+	pos_y[idx]      = pos.y;
+	size_x[idx]     = size.x;
+	size_y[idx]     = size.y;
+	vel_x[idx]      = 0.;
+	vel_y[idx]      = 0.;
+	mp_x[idx]       = pos.x;
+	mp_y[idx]       = pos.y;
+	filter_x[idx]   = fx;
+	filter_y[idx]   = fy;
+	return idx;
+}
+
+void streamfx::filter::autoframing::autoframing_instance::track_store::expire(float threshold)
+{
+	std::size_t kept = 0;
+	for (std::size_t idx = 0, edx = age.size(); idx < edx; idx++) {
+		if (age[idx] >= threshold) {
+			continue;
+		}
+		if (kept != idx) {
+			each([kept, idx](auto& v) { v[kept] = v[idx]; });
 		}
+		kept++;
 	}
+	each([kept](auto& v) { v.resize(kept); });
+}
 
-	for (auto trck : _tracked_elements) { // Updated predicted elements
-		std::shared_ptr<pred_el> pred;
+void streamfx::filter::autoframing::autoframing_instance::track_detections(const std::pmr::vector<detect_el>& detections)
+{
+	// Frames may not move more than this distance.
+	float max_dst = sqrtf(static_cast<float>(_size.first * _size.first) + static_cast<float>(_size.second * _size.second)) * 0.667f;
+	max_dst *= 1.f / (1.f - _track_frequency); // Fine-tune this?
 
-		// Find the corresponding prediction element.
-		auto iter = _predicted_elements.find(trck);
-		if (iter == _predicted_elements.end()) {
-			pred = std::make_shared<pred_el>();
-			_predicted_elements.insert_or_assign(trck, pred);
-			pred->filter_pos_x = {_motion_smoothing_kalman_pnc, _motion_smoothing_kalman_mnc, ST_KALMAN_EEC, trck->pos.x};
-			pred->filter_pos_y = {_motion_smoothing_kalman_pnc, _motion_smoothing_kalman_mnc, ST_KALMAN_EEC, trck->pos.y};
-		} else {
-			pred = iter->second;
-		}
+	if (detections.empty()) {
+		return;
+	}
 
-		// Calculate absolute velocity.
-		vec2 vel;
-		vec2_copy(&vel, &trck->vel);
-		vec2_mulf(&vel, &vel, _motion_prediction);
-		vec2_mulf(&vel, &vel, seconds);
+	// Hash the tracked elements into cells about the size of an element, so that a detection only looks at the
+	// elements around it instead of all of them.
+	std::size_t tracked = _tracked.size();
+	float       cell    = 0.;
+	for (std::size_t idx = 0; idx < tracked; idx++) {
+		cell += std::max<float>(_tracked.size_x[idx], _tracked.size_y[idx]);
+	}
+	cell = std::max<float>(tracked > 0 ? cell / static_cast<float>(tracked) : 0.f, 16.f);
+
+	int32_t min_cx = std::numeric_limits<int32_t>::max();
+	int32_t min_cy = std::numeric_limits<int32_t>::max();
+	int32_t max_cx = std::numeric_limits<int32_t>::min();
+	int32_t max_cy = std::numeric_limits<int32_t>::min();
+	_track_cells.clear();
+	for (std::size_t idx = 0; idx < tracked; idx++) {
+		int32_t cx = static_cast<int32_t>(floorf(_tracked.pos_x[idx] / cell));
+		int32_t cy = static_cast<int32_t>(floorf(_tracked.pos_y[idx] / cell));
+		min_cx     = std::min(min_cx, cx);
+		min_cy     = std::min(min_cy, cy);
+		max_cx     = std::max(max_cx, cx);
+		max_cy     = std::max(max_cy, cy);
+		_track_cells.emplace_back(cell_key(cx, cy), static_cast<uint32_t>(idx));
+	}
+	std::sort(_track_cells.begin(), _track_cells.end());
+
+	// Merge the detections with the tracked elements.
+	for (const auto& det : detections) {
+		float confidence = det.confidence;
+		auto  rect       = det.rect;
+
+		// Skip elements that have not enough confidence of being a face.
+		// TODO: Make the threshold configurable.
+		if (confidence < .5) {
+			continue;
+		}
 
-		// Calculate predicted position.
+		// Calculate centered position.
 		vec2 pos;
-		if (trck->age > seconds) {
-			vec2_copy(&pos, &pred->mp_pos);
+		pos.x = rect.x + (rect.z / 2.f);
+		pos.y = rect.y + (rect.w / 2.f);
+
+		// Try and find a match in the current list of tracked elements, walking rings of cells outwards until the next
+		// ring can no longer hold anything closer.
+		int64_t match     = -1;
+		float   match_dst = max_dst;
+		if (tracked > 0) {
+			int32_t cx    = static_cast<int32_t>(floorf(pos.x / cell));
+			int32_t cy    = static_cast<int32_t>(floorf(pos.y / cell));
+			int32_t rings = std::max({cx - min_cx, max_cx - cx, cy - min_cy, max_cy - cy, 0});
+			rings         = std::min(rings, static_cast<int32_t>(ceilf(max_dst / cell)));
+			for (int32_t r = 0; r <= rings; r++) {
+				if (match_dst <= static_cast<float>(r - 1) * cell) {
+					break;
+				}
+
+				for (int32_t dy = -r; dy <= r; dy++) {
+					int32_t step = ((dy == -r) || (dy == r)) ? 1 : (r * 2);
+					for (int32_t dx = -r; dx <= r; dx += step) {
+						auto key  = cell_key(cx + dx, cy + dy);
+						auto iter = std::lower_bound(_track_cells.begin(), _track_cells.end(), std::pair<int64_t, uint32_t>(key, 0));
+						for (; (iter != _track_cells.end()) && (iter->first == key); iter++) {
+							uint32_t idx = iter->second;
+
+							// Skip "fresh" elements.
+							if (_tracked.age[idx] < 0.00001) {
+								continue;
+							}
+
+							// Check if the distance is within acceptable bounds.
+							float dst = hypotf(pos.x - _tracked.pos_x[idx], pos.y - _tracked.pos_y[idx]);
+							if (dst < match_dst) {
+								match_dst = dst;
+								match     = idx;
+							}
+						}
+					}
+				}
+			}
+		}
+
+		// Do we have a match?
+		if (match < 0) {
+			// No, so create a new one.
+			vec2 size;
+			vec2_set(&size, rect.z, rect.w);
+			_tracked.add(pos, size, confidence, {_motion_smoothing_kalman_pnc, _motion_smoothing_kalman_mnc, ST_KALMAN_EEC, pos.x}, {_motion_smoothing_kalman_pnc, _motion_smoothing_kalman_mnc, ST_KALMAN_EEC, pos.y});
 		} else {
-			vec2_copy(&pos, &trck->pos);
+			// Calculate the velocity between changes, and update information.
+			auto idx                 = static_cast<std::size_t>(match);
+			_tracked.vel_x[idx]      = pos.x - _tracked.pos_x[idx];
+			_tracked.vel_y[idx]      = pos.y - _tracked.pos_y[idx];
+			_tracked.pos_x[idx]      = pos.x;
+			_tracked.pos_y[idx]      = pos.y;
+			_tracked.size_x[idx]     = rect.z;
+			_tracked.size_y[idx]     = rect.w;
+			_tracked.confidence[idx] = confidence;
+			_tracked.age[idx]        = 0.;
 		}
-		vec2_add(&pos, &pos, &vel);
-		vec2_copy(&pred->mp_pos, &pos);
+	}
+}
 
-		// Update filtered position.
-		pred->filter_pos_x.filter(pred->mp_pos.x);
-		pred->filter_pos_y.filter(pred->mp_pos.y);
-
-		// Update offset position.
-		vec2_set(&pred->offset_pos, pred->filter_pos_x.get(), pred->filter_pos_y.get());
-		if (_frame_offset_prc[0]) { // %
-			pred->offset_pos.x += trck->size.x * (-_frame_offset.x);
-		} else { // Pixels
-			pred->offset_pos.x += _frame_offset.x;
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::filter::autoframing::autoframing_instance::detection_input(uint32_t max_width)
+{
+	auto     texture = _input->get_texture();
+	uint32_t width   = texture->get_width();
+	uint32_t height  = texture->get_height();
+	vec2_set(&_proxy_scale, 1., 1.);
+
+	// Halving with linear filtering averages each 2x2 block, so a chain of halves filters like a mip chain would.
+	for (std::size_t level = 0; width > max_width; level++) {
+		uint32_t next_width  = std::max<uint32_t>(width / 2, max_width);
+		uint32_t next_height = std::max<uint32_t>(static_cast<uint32_t>(std::lround(static_cast<double>(height) * next_width / width)), 1);
+
+		if (_proxy.size() <= level) {
+			_proxy.push_back(std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE));
 		}
-		if (_frame_offset_prc[1]) { // %
-			pred->offset_pos.y += trck->size.y * (-_frame_offset.y);
-		} else { // Pixels
-			pred->offset_pos.y += _frame_offset.y;
+
+		{
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+			::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Proxy %" PRIu32 "x%" PRIu32, next_width, next_height};
+#endif
+			auto op = _proxy[level]->render(next_width, next_height);
+			gs_ortho(0, 1, 0, 1, 0, 1);
+
+			gs_blend_state_push();
+			gs_enable_color(true, true, true, true);
+			gs_enable_blending(false);
+			gs_enable_depth_test(false);
+			gs_enable_stencil_test(false);
+			gs_set_cull_mode(GS_NEITHER);
+
+			gs_effect_t* effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+			gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), texture->get_object());
+			while (gs_effect_loop(effect, "Draw")) {
+				gs_draw_sprite(nullptr, 0, 1, 1);
+			}
+
+			gs_blend_state_pop();
+		}
+
+		texture = _proxy[level]->get_texture();
+		width   = next_width;
+		height  = next_height;
+	}
+
+	vec2_set(&_proxy_scale, static_cast<float>(_input->get_texture()->get_width()) / static_cast<float>(width), static_cast<float>(_input->get_texture()->get_height()) / static_cast<float>(height));
+	return texture;
+}
+
+void streamfx::filter::autoframing::autoframing_instance::tracking_tick(float seconds)
+{
+	{ // Increase the age of all elements, and kill off any that are "too old".
+		float threshold = (0.5f * (1.f / (1.f - _track_frequency)));
+
+		// Elements must survive until the next tracking attempt, even if that was pushed back.
+		threshold = std::max<float>(threshold, _track_interval * 2.f);
+
+		for (float& age : _tracked.age) {
+			// Increment the age by the tick duration.
+			age += seconds;
 		}
 
-		// Calculate padded area.
-		vec2_copy(&pred->pad_size, &trck->size);
-		if (_frame_padding_prc[0]) { // %
-			pred->pad_size.x += trck->size.x * (-_frame_padding.x) * 2.f;
-		} else { // Pixels
-			pred->pad_size.x += _frame_padding.x * 2.f;
+		// Remove all that exceed the threshold.
+		_tracked.expire(threshold);
+	}
+
+	{ // Update predicted elements.
+		std::size_t count = _tracked.size();
+
+		// Calculate predicted position, continuing from the last prediction until there is a new detection.
+		float velocity = _motion_prediction * seconds;
+		for (std::size_t idx = 0; idx < count; idx++) {
+			bool fresh         = _tracked.age[idx] <= seconds;
+			_tracked.mp_x[idx] = (fresh ? _tracked.pos_x[idx] : _tracked.mp_x[idx]) + _tracked.vel_x[idx] * velocity;
+			_tracked.mp_y[idx] = (fresh ? _tracked.pos_y[idx] : _tracked.mp_y[idx]) + _tracked.vel_y[idx] * velocity;
 		}
-		if (_frame_padding_prc[1]) { // %
-			pred->pad_size.y += trck->size.y * (-_frame_padding.y) * 2.f;
-		} else { // Pixels
-			pred->pad_size.y += _frame_padding.y * 2.f;
+
+		// Update filtered position.
+		for (std::size_t idx = 0; idx < count; idx++) {
+			_tracked.filter_x[idx].filter(_tracked.mp_x[idx]);
+			_tracked.filter_y[idx].filter(_tracked.mp_y[idx]);
+		}
+
+		// Update offset position, and calculate padded area. Either relative to the size (%) or in pixels.
+		float offset_rel_x = _frame_offset_prc[0] ? -_frame_offset.x : 0.f;
+		float offset_rel_y = _frame_offset_prc[1] ? -_frame_offset.y : 0.f;
+		float offset_abs_x = _frame_offset_prc[0] ? 0.f : _frame_offset.x;
+		float offset_abs_y = _frame_offset_prc[1] ? 0.f : _frame_offset.y;
+		float pad_rel_x    = _frame_padding_prc[0] ? (-_frame_padding.x * 2.f) : 0.f;
+		float pad_rel_y    = _frame_padding_prc[1] ? (-_frame_padding.y * 2.f) : 0.f;
+		float pad_abs_x    = _frame_padding_prc[0] ? 0.f : (_frame_padding.x * 2.f);
+		float pad_abs_y    = _frame_padding_prc[1] ? 0.f : (_frame_padding.y * 2.f);
+		for (std::size_t idx = 0; idx < count; idx++) {
+			_tracked.offset_x[idx] = _tracked.filter_x[idx].get() + _tracked.size_x[idx] * offset_rel_x + offset_abs_x;
+			_tracked.offset_y[idx] = _tracked.filter_y[idx].get() + _tracked.size_y[idx] * offset_rel_y + offset_abs_y;
+			_tracked.pad_x[idx]    = _tracked.size_x[idx] + _tracked.size_x[idx] * pad_rel_x + pad_abs_x;
+			_tracked.pad_y[idx]    = _tracked.size_y[idx] + _tracked.size_y[idx] * pad_rel_y + pad_abs_y;
 		}
 
 		// Adjust to match aspect ratio (width / height).
-		vec2_copy(&pred->aspected_size, &pred->pad_size);
-		if (_frame_aspect_ratio > 0.0) {
-			if ((pred->aspected_size.x / pred->aspected_size.y) >= _frame_aspect_ratio) { // Ours > Target
-				pred->aspected_size.y = pred->aspected_size.x / _frame_aspect_ratio;
-			} else { // Target > Ours
-				pred->aspected_size.x = pred->aspected_size.y * _frame_aspect_ratio;
+		for (std::size_t idx = 0; idx < count; idx++) {
+			float x = _tracked.pad_x[idx];
+			float y = _tracked.pad_y[idx];
+			if (_frame_aspect_ratio > 0.0) {
+				if ((x / y) >= _frame_aspect_ratio) { // Ours > Target
+					y = x / _frame_aspect_ratio;
+				} else { // Target > Ours
+					x = y * _frame_aspect_ratio;
+				}
 			}
+			_tracked.aspected_x[idx] = x;
+			_tracked.aspected_y[idx] = y;
 		}
 	}
 
 	{ // Find final frame.
 		bool need_filter = true;
-		if (_predicted_elements.size() > 0) {
+		if (_tracked.size() > 0) {
 			if (_track_mode == tracking_mode::SOLO) {
-				auto kv = _predicted_elements.rbegin();
+				// Follow the most confident element, and the oldest one of those.
+				std::size_t best = 0;
+				for (std::size_t idx = 1, edx = _tracked.size(); idx < edx; idx++) {
+					if (_tracked.confidence[idx] > _tracked.confidence[best]) {
+						best = idx;
+					}
+				}
 
-				_frame_pos_x.filter(kv->second->offset_pos.x);
-				_frame_pos_y.filter(kv->second->offset_pos.y);
+				_frame_pos_x.filter(_tracked.offset_x[best]);
+				_frame_pos_y.filter(_tracked.offset_y[best]);
 
 				vec2_set(&_frame_pos, _frame_pos_x.get(), _frame_pos_y.get());
-				vec2_copy(&_frame_size, &kv->second->aspected_size);
+				vec2_set(&_frame_size, _tracked.aspected_x[best], _tracked.aspected_y[best]);
 
 				need_filter = false;
 			} else {
@@ -714,32 +982,13 @@ void streamfx::filter::autoframing::autoframing_instance::tracking_tick(float se
 				vec2_set(&min, std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
 				vec2_set(&max, 0., 0.);
 
-				for (auto kv : _predicted_elements) {
-					vec2 size;
-					vec2 low;
-					vec2 high;
-
-					vec2_copy(&size, &kv.second->aspected_size);
-					vec2_mulf(&size, &size, .5f);
-
-					vec2_copy(&low, &kv.second->offset_pos);
-					vec2_copy(&high, &kv.second->offset_pos);
-
-					vec2_sub(&low, &low, &size);
-					vec2_add(&high, &high, &size);
-
-					if (low.x < min.x) {
-						min.x = low.x;
-					}
-					if (low.y < min.y) {
-						min.y = low.y;
-					}
-					if (high.x > max.x) {
-						max.x = high.x;
-					}
-					if (high.y > max.y) {
-						max.y = high.y;
-					}
+				for (std::size_t idx = 0, edx = _tracked.size(); idx < edx; idx++) {
+					float half_x = _tracked.aspected_x[idx] * .5f;
+					float half_y = _tracked.aspected_y[idx] * .5f;
+					min.x        = std::min<float>(min.x, _tracked.offset_x[idx] - half_x);
+					min.y        = std::min<float>(min.y, _tracked.offset_y[idx] - half_y);
+					max.x        = std::max<float>(max.x, _tracked.offset_x[idx] + half_x);
+					max.y        = std::max<float>(max.y, _tracked.offset_y[idx] + half_y);
 				}
 
 				// Calculate center.
@@ -806,10 +1055,52 @@ void streamfx::filter::autoframing::autoframing_instance::tracking_tick(float se
 		}
 	}
 
+	{ // Decide when to track next.
+		_track_interval = _track_frequency;
+
+		// Without any elements there is nothing to predict, so keep looking at the configured frequency.
+		if (_track_adaptive && (_tracked.size() > 0)) {
+			float motion = 0.;
+			for (std::size_t idx = 0, edx = _tracked.size(); idx < edx; idx++) {
+				float size = std::max<float>(std::max<float>(_tracked.size_x[idx], _tracked.size_y[idx]), 1.f);
+				motion     = std::max<float>(motion, hypotf(_tracked.vel_x[idx], _tracked.vel_y[idx]) / size);
+			}
+
+			_track_interval *= std::clamp<float>(ST_ADAPTIVE_MOTION / std::max<float>(motion, 0.00001f), 1.f, ST_ADAPTIVE_MAXIMUM);
+		}
+	}
+
 	// Increment tracking counter.
 	_track_frequency_counter += seconds;
 }
 
+void streamfx::filter::autoframing::autoframing_instance::publish_region_hints()
+{
+	// Only what is actually on the program output matters to encoders.
+	obs_source_t* parent = obs_filter_get_parent(_self);
+	if (!parent || !obs_source_active(parent) || !obs_source_enabled(_self) || (_frame_size.x < 1.f) || (_frame_size.y < 1.f)) {
+		_region_hints->withdraw(this);
+		return;
+	}
+
+	// Map the elements from input pixels into the framed output.
+	float x0 = _frame_pos.x - _frame_size.x / 2.f;
+	float y0 = _frame_pos.y - _frame_size.y / 2.f;
+
+	std::vector<::streamfx::util::region_hints::region> regions;
+	regions.reserve(_tracked.size());
+	for (std::size_t idx = 0, edx = _tracked.size(); idx < edx; idx++) {
+		::streamfx::util::region_hints::region region;
+		region.x        = (_tracked.filter_x[idx].get() - _tracked.size_x[idx] / 2.f - x0) / _frame_size.x;
+		region.y        = (_tracked.filter_y[idx].get() - _tracked.size_y[idx] / 2.f - y0) / _frame_size.y;
+		region.width    = _tracked.size_x[idx] / _frame_size.x;
+		region.height   = _tracked.size_y[idx] / _frame_size.y;
+		region.emphasis = 1.f;
+		regions.push_back(region);
+	}
+	_region_hints->publish(this, std::move(regions));
+}
+
 struct switch_provider_data_t {
 	tracking_provider provider;
 };
@@ -848,7 +1139,7 @@ void streamfx::filter::autoframing::autoframing_instance::switch_provider(tracki
 	_provider     = provider;
 
 	// Then spawn a new task to switch provider.
-	_provider_task = streamfx::threadpool()->push(std::bind(&autoframing_instance::task_switch_provider, this, std::placeholders::_1), spd);
+	_provider_task = streamfx::threadpool()->push(std::bind(&autoframing_instance::task_switch_provider, this, std::placeholders::_1), spd, ::streamfx::util::threadpool::priority::BACKGROUND);
 }
 
 void streamfx::filter::autoframing::autoframing_instance::task_switch_provider(util::threadpool::task_data_t data)
@@ -869,6 +1160,9 @@ void streamfx::filter::autoframing::autoframing_instance::task_switch_provider(u
 			nvar_facedetection_unload();
 			break;
 #endif
+		case tracking_provider::SALIENCY:
+			saliency_unload();
+			break;
 		default:
 			break;
 		}
@@ -880,6 +1174,9 @@ void streamfx::filter::autoframing::autoframing_instance::task_switch_provider(u
 			nvar_facedetection_load();
 			break;
 #endif
+		case tracking_provider::SALIENCY:
+			saliency_load();
+			break;
 		default:
 			break;
 		}
@@ -894,14 +1191,178 @@ void streamfx::filter::autoframing::autoframing_instance::task_switch_provider(u
 	}
 }
 
+struct saliency_data_t {
+	std::vector<uint8_t> pixels;
+	uint32_t             width;
+	uint32_t             height;
+	vec2                 scale;
+};
+
+void streamfx::filter::autoframing::autoframing_instance::saliency_load()
+{
+	std::unique_lock<std::mutex> ul(_saliency_lock);
+	_saliency_results.clear();
+	_saliency_complete = false;
+}
+
+void streamfx::filter::autoframing::autoframing_instance::saliency_unload()
+{
+	if (_saliency_task) {
+		streamfx::threadpool()->pop(_saliency_task);
+		_saliency_task->await_completion();
+		_saliency_task.reset();
+	}
+
+	if (_saliency_stage) {
+		::streamfx::obs::gs::context gctx;
+		gs_stagesurface_destroy(_saliency_stage);
+		_saliency_stage  = nullptr;
+		_saliency_staged = false;
+	}
+}
+
+void streamfx::filter::autoframing::autoframing_instance::saliency_process()
+{
+	// The previous frame has not been read back yet, so there is nothing to gain from staging another one.
+	if (_saliency_staged) {
+		return;
+	}
+
+	auto     input  = detection_input(SALIENCY_WIDTH);
+	uint32_t width  = input->get_width();
+	uint32_t height = input->get_height();
+
+	if (_saliency_stage && ((gs_stagesurface_get_width(_saliency_stage) != width) || (gs_stagesurface_get_height(_saliency_stage) != height))) {
+		gs_stagesurface_destroy(_saliency_stage);
+		_saliency_stage = nullptr;
+	}
+	if (!_saliency_stage) {
+		_saliency_stage = gs_stagesurface_create(width, height, GS_RGBA);
+		if (!_saliency_stage) {
+			D_LOG_ERROR("Instance '%s' failed to create a %" PRIu32 "x%" PRIu32 " staging surface.", obs_source_get_name(_self), width, height);
+			return;
+		}
+	}
+
+	// Only copy here, the surface is mapped by the next video_tick so that we don't wait for the GPU.
+	gs_stage_texture(_saliency_stage, input->get_object());
+	vec2_copy(&_saliency_scale, &_proxy_scale);
+	_saliency_staged = true;
+}
+
+void streamfx::filter::autoframing::autoframing_instance::saliency_collect()
+{
+	{ // Merge whatever the last task found.
+		std::pmr::vector<detect_el> results(::streamfx::gfx::frame_arena::get());
+		{
+			std::unique_lock<std::mutex> ul(_saliency_lock);
+			if (_saliency_complete) {
+				results.assign(_saliency_results.begin(), _saliency_results.end());
+				_saliency_results.clear();
+				_saliency_complete = false;
+			}
+		}
+		if (!results.empty()) {
+			track_detections(results);
+		}
+	}
+
+	// Hand the staged frame to the CPU, unless it is still busy with the previous one.
+	if (!_saliency_staged || (_saliency_task && !_saliency_task->is_completed())) {
+		return;
+	}
+
+	auto td = std::make_shared<saliency_data_t>();
+	{
+		::streamfx::obs::gs::context gctx;
+
+		uint8_t* data     = nullptr;
+		uint32_t linesize = 0;
+		if (!gs_stagesurface_map(_saliency_stage, &data, &linesize)) {
+			return;
+		}
+
+		td->width  = gs_stagesurface_get_width(_saliency_stage);
+		td->height = gs_stagesurface_get_height(_saliency_stage);
+		td->pixels.resize(static_cast<size_t>(td->width) * td->height * 4);
+		for (uint32_t y = 0; y < td->height; y++) {
+			memcpy(td->pixels.data() + static_cast<size_t>(y) * td->width * 4, data + static_cast<size_t>(y) * linesize, static_cast<size_t>(td->width) * 4);
+		}
+
+		gs_stagesurface_unmap(_saliency_stage);
+	}
+	vec2_copy(&td->scale, &_saliency_scale);
+	_saliency_staged = false;
+
+	_saliency_task = streamfx::threadpool()->push(std::bind(&autoframing_instance::task_saliency, this, std::placeholders::_1), td, ::streamfx::util::threadpool::priority::FRAME);
+}
+
+void streamfx::filter::autoframing::autoframing_instance::task_saliency(util::threadpool::task_data_t data)
+{
+	auto td = std::static_pointer_cast<saliency_data_t>(data);
+
+	// Skin tones sit in a narrow range of the chroma plane regardless of the person or lighting, so the bounds of all
+	// skin colored pixels are a usable stand-in for a face. The loops are kept branch-free integer math, which the
+	// compiler can vectorize.
+	uint64_t count = 0;
+	uint64_t sum_x = 0, sum_y = 0;
+	uint64_t sum_xx = 0, sum_yy = 0;
+	for (uint32_t y = 0; y < td->height; y++) {
+		const uint8_t* row       = td->pixels.data() + static_cast<size_t>(y) * td->width * 4;
+		uint32_t       row_count = 0;
+		uint32_t       row_x     = 0;
+		uint32_t       row_xx    = 0;
+		for (uint32_t x = 0; x < td->width; x++) {
+			int32_t r  = row[x * 4 + 0];
+			int32_t g  = row[x * 4 + 1];
+			int32_t b  = row[x * 4 + 2];
+			int32_t cb = 128 + ((-43 * r - 85 * g + 128 * b) >> 8);
+			int32_t cr = 128 + ((128 * r - 107 * g - 21 * b) >> 8);
+			// Chroma bounds for skin from Chai & Ngan, "Face segmentation using skin-color map in videophone applications".
+			uint32_t skin = static_cast<uint32_t>((cb >= 77) & (cb <= 127) & (cr >= 133) & (cr <= 173));
+			row_count += skin;
+			row_x += skin * x;
+			row_xx += skin * x * x;
+		}
+		count += row_count;
+		sum_x += row_x;
+		sum_xx += row_xx;
+		sum_y += static_cast<uint64_t>(row_count) * y;
+		sum_yy += static_cast<uint64_t>(row_count) * y * y;
+	}
+
+	std::vector<detect_el> results;
+	if (count > (static_cast<uint64_t>(td->width) * td->height / 200)) {
+		double mean_x = static_cast<double>(sum_x) / count;
+		double mean_y = static_cast<double>(sum_y) / count;
+		double dev_x  = sqrt(std::max(static_cast<double>(sum_xx) / count - mean_x * mean_x, 0.));
+		double dev_y  = sqrt(std::max(static_cast<double>(sum_yy) / count - mean_y * mean_y, 0.));
+
+		// A uniformly filled box is sqrt(12) standard deviations wide.
+		double width  = std::max(dev_x * 3.4641, 1.);
+		double height = std::max(dev_y * 3.4641, 1.);
+
+		// Skin scattered over the whole frame fills its box poorly, which makes for a low confidence.
+		detect_el el;
+		el.confidence = static_cast<float>(std::min(static_cast<double>(count) / (width * height), 1.));
+		vec4_set(&el.rect, static_cast<float>(mean_x - width / 2.) * td->scale.x, static_cast<float>(mean_y - height / 2.) * td->scale.y, static_cast<float>(width) * td->scale.x, static_cast<float>(height) * td->scale.y);
+		results.push_back(el);
+	}
+
+	std::unique_lock<std::mutex> ul(_saliency_lock);
+	_saliency_results.swap(results);
+	_saliency_complete = true;
+}
+
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
 void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_load()
 {
-	_nvidia_fx = std::make_shared<::streamfx::nvidia::ar::facedetection>();
+	_nvidia_fx = ::streamfx::nvidia::warmup::get()->take<::streamfx::nvidia::ar::facedetection>();
 }
 
 void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_unload()
 {
+	_nvidia_batch.reset();
 	_nvidia_fx.reset();
 }
 
@@ -911,76 +1372,58 @@ void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_pro
 		return;
 	}
 
-	// Frames may not move more than this distance.
-	float max_dst = sqrtf(static_cast<float>(_size.first * _size.first) + static_cast<float>(_size.second * _size.second)) * 0.667f;
-	max_dst *= 1.f / (1.f - _track_frequency); // Fine-tune this?
-
-	// Process the current frame (if requested).
-	_nvidia_fx->process(_input->get_texture());
-
-	// If there are tracked faces, merge them with the tracked elements.
-	if (auto edx = _nvidia_fx->count(); edx > 0) {
-		for (size_t idx = 0; idx < edx; idx++) {
-			float confidence = 0.;
-			auto  rect       = _nvidia_fx->at(idx, confidence);
-
-			// Skip elements that have not enough confidence of being a face.
-			// TODO: Make the threshold configurable.
-			if (confidence < .5) {
-				continue;
-			}
-
-			// Calculate centered position.
-			vec2 pos;
-			pos.x = rect.x + (rect.z / 2.f);
-			pos.y = rect.y + (rect.w / 2.f);
-
-			// Try and find a match in the current list of tracked elements.
-			std::shared_ptr<track_el> match;
-			float                     match_dst = max_dst;
-			for (const auto& el : _tracked_elements) {
-				// Skip "fresh" elements.
-				if (el->age < 0.00001) {
-					continue;
-				}
+	// Switch between our own and the shared detection.
+	if (_track_batch && !_nvidia_batch) {
+		_nvidia_batch = std::make_shared<::streamfx::nvidia::ar::facedetection_batch::client>(::streamfx::nvidia::ar::facedetection_batch::get());
+	} else if (!_track_batch && _nvidia_batch) {
+		_nvidia_batch.reset();
+	}
 
-				// Check if the distance is within acceptable bounds.
-				float dst = vec2_dist(&pos, &el->pos);
-				if ((dst < match_dst) && (dst < max_dst)) {
-					match_dst = dst;
-					match     = el;
-				}
-			}
+	// Queue the current frame, the results are merged by a later video_tick once the GPU is done with them.
+	auto input = detection_input(DETECTION_WIDTH);
+	if (_nvidia_batch) {
+		if (!_nvidia_batch->submit(input)) {
+			// The shared atlas is full, so try again with the next frame.
+			_track_frequency_counter = _track_interval;
+		}
+	} else {
+		_nvidia_fx->enqueue(input);
+	}
+}
 
-			// Do we have a match?
-			if (!match) {
-				// No, so create a new one.
-				match = std::make_shared<track_el>();
+void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_collect()
+{
+	if (!_nvidia_fx) {
+		return;
+	}
 
-				// Insert it.
-				_tracked_elements.push_back(match);
+	std::pmr::vector<::streamfx::nvidia::ar::facedetection_batch::detection> detections(::streamfx::gfx::frame_arena::get());
+	if (_nvidia_batch) {
+		if (!_nvidia_batch->collect(detections)) {
+			return;
+		}
+	} else {
+		if (!_nvidia_fx->collect()) {
+			return;
+		}
 
-				// Update information.
-				vec2_copy(&match->pos, &pos);
-				vec2_set(&match->size, rect.z, rect.w);
-				vec2_set(&match->vel, 0., 0.);
-				match->age = 0.;
-			} else {
-				// Reset the age to 0.
-				match->age = 0.;
-
-				// Calculate the velocity between changes.
-				vec2 vel;
-				vec2_sub(&vel, &pos, &match->pos);
-
-				// Update information.
-				vec2_copy(&match->pos, &pos);
-				vec2_set(&match->size, rect.z, rect.w);
-				vec2_copy(&match->vel, &vel);
-				match->age = 0.;
-			}
+		for (size_t idx = 0, edx = _nvidia_fx->count(); idx < edx; idx++) {
+			::streamfx::nvidia::ar::facedetection_batch::detection det;
+			det.rect = _nvidia_fx->at(idx, det.confidence);
+			detections.push_back(det);
 		}
 	}
+
+	// Detection ran on the proxy, so bring the rectangles back to the input.
+	std::pmr::vector<detect_el> elements(::streamfx::gfx::frame_arena::get());
+	elements.reserve(detections.size());
+	for (const auto& det : detections) {
+		detect_el el;
+		vec4_set(&el.rect, det.rect.x * _proxy_scale.x, det.rect.y * _proxy_scale.y, det.rect.z * _proxy_scale.x, det.rect.w * _proxy_scale.y);
+		el.confidence = det.confidence;
+		elements.push_back(el);
+	}
+	track_detections(elements);
 }
 
 void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_properties(obs_properties_t* props) {}
@@ -1005,39 +1448,17 @@ void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_upd
 
 autoframing_factory::autoframing_factory()
 {
-	bool any_available = false;
-
 	// 1. Try and load any configured providers.
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
-	try {
-		// Load CVImage and Video Effects SDK.
-		_nvcuda           = ::streamfx::nvidia::cuda::obs::get();
-		_nvcvi            = ::streamfx::nvidia::cv::cv::get();
-		_nvar             = ::streamfx::nvidia::ar::ar::get();
-		_nvidia_available = true;
-		any_available |= _nvidia_available;
-	} catch (const std::exception& ex) {
-		_nvidia_available = false;
-		_nvar.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA providers available due to error: %s", ex.what());
-	} catch (...) {
-		_nvidia_available = false;
-		_nvar.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA providers available with unknown error.", nullptr);
+	// Only look for the SDK here. It is loaded once a filter actually uses it, so that OBS doesn't pay for it on
+	// every start.
+	_nvidia_available = ::streamfx::nvidia::ar::ar::is_available();
+	if (!_nvidia_available) {
+		D_LOG_WARNING("Failed to make NVIDIA providers available, as the SDK is not installed.", nullptr);
 	}
 #endif
 
-	// 2. Check if any of them managed to load at all.
-	if (!any_available) {
-		D_LOG_ERROR("All supported providers failed to initialize, disabling effect.", 0);
-		return;
-	}
-
-	// Register initial source.
+	// 2. Register the filter, the saliency provider runs on the CPU and is always available.
 	_info.id           = S_PREFIX "filter-autoframing";
 	_info.type         = OBS_SOURCE_TYPE_FILTER;
 	_info.output_flags = OBS_SOURCE_VIDEO;
@@ -1062,6 +1483,8 @@ void autoframing_factory::get_defaults2(obs_data_t* data)
 	// Tracking
 	obs_data_set_default_int(data, ST_KEY_TRACKING_MODE, static_cast<int64_t>(tracking_mode::SOLO));
 	obs_data_set_default_string(data, ST_KEY_TRACKING_FREQUENCY, "20 Hz");
+	obs_data_set_default_bool(data, ST_KEY_TRACKING_ADAPTIVE, false);
+	obs_data_set_default_bool(data, ST_KEY_TRACKING_BATCH, false);
 
 	// Motion
 	obs_data_set_default_double(data, ST_KEY_MOTION_SMOOTHING, 33.333);
@@ -1117,6 +1540,14 @@ obs_properties_t* autoframing_factory::get_properties2(autoframing_instance* dat
 		{
 			auto p = obs_properties_add_text(grp, ST_KEY_TRACKING_FREQUENCY, D_TRANSLATE(ST_I18N_TRACKING_FREQUENCY), OBS_TEXT_DEFAULT);
 		}
+
+		{
+			auto p = obs_properties_add_bool(grp, ST_KEY_TRACKING_ADAPTIVE, D_TRANSLATE(ST_I18N_TRACKING_ADAPTIVE));
+		}
+
+		{
+			auto p = obs_properties_add_bool(grp, ST_KEY_TRACKING_BATCH, D_TRANSLATE(ST_I18N_TRACKING_BATCH));
+		}
 	}
 
 	{
@@ -1216,6 +1647,7 @@ obs_properties_t* autoframing_factory::get_properties2(autoframing_instance* dat
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
 			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_ADVANCED_PROVIDER_NVIDIA_FACEDETECTION), static_cast<int64_t>(tracking_provider::NVIDIA_FACEDETECTION));
 #endif
+			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_ADVANCED_PROVIDER_SALIENCY), static_cast<int64_t>(tracking_provider::SALIENCY));
 		}
 
 		obs_properties_add_bool(grp, "Debug", "Debug");
@@ -1239,6 +1671,8 @@ bool streamfx::filter::autoframing::autoframing_factory::is_provider_available(t
 	case tracking_provider::NVIDIA_FACEDETECTION:
 		return _nvidia_available;
 #endif
+	case tracking_provider::SALIENCY:
+		return true;
 	default:
 		return false;
 	}
@@ -3,24 +3,28 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "gfx/gfx-frame-arena.hpp"
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
 #include "obs/gs/gs-vertexbuffer.hpp"
 #include "obs/obs-source-factory.hpp"
 #include "plugin.hpp"
+#include "util/util-region-hints.hpp"
 #include "util/util-threadpool.hpp"
 #include "util/utility.hpp"
 
 #include "warning-disable.hpp"
 #include <atomic>
-#include <list>
 #include <memory>
 #include <mutex>
+#include <vector>
 #include "warning-enable.hpp"
 
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
+#include "nvidia/ar/nvidia-ar-facedetection-batch.hpp"
 #include "nvidia/ar/nvidia-ar-facedetection.hpp"
+#include "nvidia/nvidia-warmup.hpp"
 #endif
 
 namespace streamfx::filter::autoframing {
@@ -34,39 +38,91 @@ namespace streamfx::filter::autoframing {
 		INVALID              = -1,
 		AUTOMATIC            = 0,
 		NVIDIA_FACEDETECTION = 1,
+		SALIENCY             = 2,
 	};
 
 	const char* cstring(tracking_provider provider);
 
 	std::string string(tracking_provider provider);
 
-	class autoframing_instance : public obs::source_instance {
-		struct track_el {
-			float age;
-			vec2  pos;
-			vec2  size;
-			vec2  vel;
+	class autoframing_instance final : public obs::source_instance {
+		struct detect_el {
+			vec4  rect; // x, y, width, height in input pixels.
+			float confidence;
 		};
 
-		struct pred_el {
+		/** Tracked elements as a structure of arrays, where the same index in every array is one element.
+		 *
+		 * Keeps every per-tick pass a straight loop over contiguous values, instead of chasing a pointer per element.
+		 */
+		struct track_store {
+			// Detection
+			std::vector<float> age;
+			std::vector<float> confidence;
+			std::vector<float> pos_x;
+			std::vector<float> pos_y;
+			std::vector<float> size_x;
+			std::vector<float> size_y;
+			std::vector<float> vel_x;
+			std::vector<float> vel_y;
+
 			// Motion-Predicted Position
-			vec2 mp_pos;
+			std::vector<float> mp_x;
+			std::vector<float> mp_y;
 
 			// Filtered Position
-			streamfx::util::math::kalman1D<float> filter_pos_x;
-			streamfx::util::math::kalman1D<float> filter_pos_y;
+			std::vector<streamfx::util::math::kalman1D<float>> filter_x;
+			std::vector<streamfx::util::math::kalman1D<float>> filter_y;
 
 			// Offset Filtered Position
-			vec2 offset_pos;
+			std::vector<float> offset_x;
+			std::vector<float> offset_y;
 
 			// Padded Area
-			vec2 pad_size;
+			std::vector<float> pad_x;
+			std::vector<float> pad_y;
 
 			// Aspect-Ratio-Corrected Padded Area
-			vec2 aspected_size;
+			std::vector<float> aspected_x;
+			std::vector<float> aspected_y;
+
+			std::size_t size() const
+			{
+				return age.size();
+			}
+
+			/** Call fn for every array, to apply the same change to all of them. */
+			template<typename F>
+			void each(F&& fn)
+			{
+				fn(age);
+				fn(confidence);
+				fn(pos_x);
+				fn(pos_y);
+				fn(size_x);
+				fn(size_y);
+				fn(vel_x);
+				fn(vel_y);
+				fn(mp_x);
+				fn(mp_y);
+				fn(filter_x);
+				fn(filter_y);
+				fn(offset_x);
+				fn(offset_y);
+				fn(pad_x);
+				fn(pad_y);
+				fn(aspected_x);
+				fn(aspected_y);
+			}
+
+			std::size_t add(const vec2& pos, const vec2& size, float confidence, const streamfx::util::math::kalman1D<float>& filter_x, const streamfx::util::math::kalman1D<float>& filter_y);
+
+			/** Remove all elements that are older than the threshold, keeping the order of the rest. */
+			void expire(float threshold);
 		};
 
 		bool                          _dirty;
+		bool                          _input_fresh; // _input holds the current frame.
 		std::pair<uint32_t, uint32_t> _size;
 		std::pair<uint32_t, uint32_t> _out_size;
 
@@ -75,18 +131,33 @@ namespace streamfx::filter::autoframing {
 		std::shared_ptr<::streamfx::obs::gs::rendertarget>  _input;
 		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _vb;
 
+		std::vector<std::shared_ptr<::streamfx::obs::gs::rendertarget>> _proxy;
+		vec2                                                            _proxy_scale;
+
 		tracking_provider                       _provider;
 		tracking_provider                       _provider_ui;
 		std::atomic<bool>                       _provider_ready;
 		std::mutex                              _provider_lock;
 		std::shared_ptr<util::threadpool::task> _provider_task;
 
+		gs_stagesurf_t*                         _saliency_stage;
+		bool                                    _saliency_staged;
+		vec2                                    _saliency_scale;
+		std::shared_ptr<util::threadpool::task> _saliency_task;
+		std::mutex                              _saliency_lock;
+		std::vector<detect_el>                  _saliency_results;
+		bool                                    _saliency_complete;
+
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
-		std::shared_ptr<::streamfx::nvidia::ar::facedetection> _nvidia_fx;
+		std::shared_ptr<::streamfx::nvidia::ar::facedetection>               _nvidia_fx;
+		std::shared_ptr<::streamfx::nvidia::ar::facedetection_batch::client> _nvidia_batch;
 #endif
 
 		tracking_mode _track_mode;
 		float         _track_frequency;
+		bool          _track_adaptive;
+		float         _track_interval; // Seconds until the next tracking attempt, _track_frequency unless adaptive.
+		bool          _track_batch;
 
 		float _motion_smoothing;
 		float _motion_smoothing_kalman_pnc;
@@ -101,9 +172,11 @@ namespace streamfx::filter::autoframing {
 		vec2  _frame_offset;
 		float _frame_aspect_ratio;
 
-		float                                                         _track_frequency_counter;
-		std::list<std::shared_ptr<track_el>>                          _tracked_elements;
-		std::map<std::shared_ptr<track_el>, std::shared_ptr<pred_el>> _predicted_elements;
+		float       _track_frequency_counter;
+		track_store _tracked;
+
+		// Spatial hash of _tracked for matching, by cell coordinates packed into one key.
+		std::vector<std::pair<int64_t, uint32_t>> _track_cells;
 
 		streamfx::util::math::kalman1D<float> _frame_pos_x;
 		streamfx::util::math::kalman1D<float> _frame_pos_y;
@@ -112,6 +185,8 @@ namespace streamfx::filter::autoframing {
 		streamfx::util::math::kalman1D<float> _frame_size_y;
 		vec2                                  _frame_size;
 
+		std::shared_ptr<::streamfx::util::region_hints> _region_hints;
+
 		bool _debug;
 
 		public:
@@ -128,17 +203,36 @@ namespace streamfx::filter::autoframing {
 
 		virtual void video_tick(float_t seconds) override;
 		virtual void video_render(gs_effect_t* effect) override;
+		virtual void prepare() override;
 
 		private:
+		void allocate();
+
 		void tracking_tick(float seconds);
 
+		/** Tell encoders where the tracked elements are in the output. */
+		void publish_region_hints();
+
+		/** Merge new detections into the tracked elements. */
+		void track_detections(const std::pmr::vector<detect_el>& detections);
+
+		/** The input, halved until it is no wider than max_width. Sets _proxy_scale to map back to the input. */
+		std::shared_ptr<::streamfx::obs::gs::texture> detection_input(uint32_t max_width);
+
 		void switch_provider(tracking_provider provider);
 		void task_switch_provider(util::threadpool::task_data_t data);
 
+		void saliency_load();
+		void saliency_unload();
+		void saliency_process();
+		void saliency_collect();
+		void task_saliency(util::threadpool::task_data_t data);
+
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
 		void nvar_facedetection_load();
 		void nvar_facedetection_unload();
 		void nvar_facedetection_process();
+		void nvar_facedetection_collect();
 		void nvar_facedetection_properties(obs_properties_t* props);
 		void nvar_facedetection_update(obs_data_t* data);
 #endif
@@ -146,10 +240,7 @@ namespace streamfx::filter::autoframing {
 
 	class autoframing_factory : public obs::source_factory<streamfx::filter::autoframing::autoframing_factory, streamfx::filter::autoframing::autoframing_instance> {
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
-		bool                                           _nvidia_available;
-		std::shared_ptr<::streamfx::nvidia::cuda::obs> _nvcuda;
-		std::shared_ptr<::streamfx::nvidia::cv::cv>    _nvcvi;
-		std::shared_ptr<::streamfx::nvidia::ar::ar>    _nvar;
+		bool _nvidia_available;
 #endif
 
 		public:
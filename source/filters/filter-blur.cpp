@@ -9,8 +9,13 @@
 #include "gfx/blur/gfx-blur-dual-filtering.hpp"
 #include "gfx/blur/gfx-blur-gaussian-linear.hpp"
 #include "gfx/blur/gfx-blur-gaussian.hpp"
+#include "gfx/blur/gfx-blur-polar.hpp"
+#include "gfx/gfx-calibration.hpp"
+#include "gfx/gfx-frame-arena.hpp"
+#include "obs/gs/gs-handoff.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "obs/obs-source-tracker.hpp"
+#include "obs/obs-tools.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
@@ -18,7 +23,9 @@
 #include <cinttypes>
 #include <cmath>
 #include <map>
+#include <memory>
 #include <stdexcept>
+#include <string_view>
 #include "warning-enable.hpp"
 
 // OBS
@@ -65,6 +72,11 @@
 #define ST_KEY_STEPSCALE_X "Filter.Blur.StepScale.X"
 #define ST_I18N_STEPSCALE_Y "Filter.Blur.StepScale.Y"
 #define ST_KEY_STEPSCALE_Y "Filter.Blur.StepScale.Y"
+#define ST_I18N_PRECISION "Filter.Blur.Precision"
+#define ST_KEY_PRECISION "Filter.Blur.Precision"
+#define ST_I18N_PRECISION_LOW "Filter.Blur.Precision.Low"
+#define ST_I18N_PRECISION_HALF "Filter.Blur.Precision.Half"
+#define ST_I18N_PRECISION_FULL "Filter.Blur.Precision.Full"
 #define ST_I18N_MASK "Filter.Blur.Mask"
 #define ST_KEY_MASK "Filter.Blur.Mask"
 #define ST_I18N_MASK_TYPE "Filter.Blur.Mask.Type"
@@ -90,12 +102,29 @@
 #define ST_KEY_MASK_IMAGE "Filter.Blur.Mask.Image"
 #define ST_I18N_MASK_SOURCE "Filter.Blur.Mask.Source"
 #define ST_KEY_MASK_SOURCE "Filter.Blur.Mask.Source"
+#define ST_I18N_MASK_TYPE_SHARED "Filter.Blur.Mask.Type.Shared"
+#define ST_I18N_MASK_SHARED "Filter.Blur.Mask.Shared"
+#define ST_KEY_MASK_SHARED "Filter.Blur.Mask.Shared"
+#define ST_I18N_MASK_SHARED_INVERT "Filter.Blur.Mask.Shared.Invert"
+#define ST_KEY_MASK_SHARED_INVERT "Filter.Blur.Mask.Shared.Invert"
 #define ST_I18N_MASK_COLOR "Filter.Blur.Mask.Color"
 #define ST_KEY_MASK_COLOR "Filter.Blur.Mask.Color"
 #define ST_I18N_MASK_ALPHA "Filter.Blur.Mask.Alpha"
 #define ST_KEY_MASK_ALPHA "Filter.Blur.Mask.Alpha"
 #define ST_I18N_MASK_MULTIPLIER "Filter.Blur.Mask.Multiplier"
 #define ST_KEY_MASK_MULTIPLIER "Filter.Blur.Mask.Multiplier"
+#define ST_I18N_MASK_VARIABLE "Filter.Blur.Mask.Variable"
+#define ST_KEY_MASK_VARIABLE "Filter.Blur.Mask.Variable"
+#define ST_I18N_STATIC "Filter.Blur.Static"
+#define ST_KEY_STATIC "Filter.Blur.Static"
+#define ST_I18N_TEMPORAL "Filter.Blur.Temporal"
+#define ST_KEY_TEMPORAL "Filter.Blur.Temporal"
+#define ST_I18N_TEMPORAL_INTERVAL "Filter.Blur.Temporal.Interval"
+#define ST_KEY_TEMPORAL_INTERVAL "Filter.Blur.Temporal.Interval"
+#define ST_I18N_TEMPORAL_THRESHOLD "Filter.Blur.Temporal.Threshold"
+#define ST_KEY_TEMPORAL_THRESHOLD "Filter.Blur.Temporal.Threshold"
+
+#define ST_TEMPORAL_PROBE_SIZE 16 // Width and height of the image used to detect changes.
 
 using namespace streamfx::filter::blur;
 
@@ -111,7 +140,7 @@ struct local_blur_subtype_t {
 };
 
 static std::map<std::string, local_blur_type_t> list_of_types = {
-	{"box", {&::streamfx::gfx::blur::box_factory::get, S_BLUR_TYPE_BOX}}, {"box_linear", {&::streamfx::gfx::blur::box_linear_factory::get, S_BLUR_TYPE_BOX_LINEAR}}, {"gaussian", {&::streamfx::gfx::blur::gaussian_factory::get, S_BLUR_TYPE_GAUSSIAN}}, {"gaussian_linear", {&::streamfx::gfx::blur::gaussian_linear_factory::get, S_BLUR_TYPE_GAUSSIAN_LINEAR}}, {"dual_filtering", {&::streamfx::gfx::blur::dual_filtering_factory::get, S_BLUR_TYPE_DUALFILTERING}},
+	{"box", {&::streamfx::gfx::blur::box_factory::get, S_BLUR_TYPE_BOX}}, {"box_linear", {&::streamfx::gfx::blur::box_linear_factory::get, S_BLUR_TYPE_BOX_LINEAR}}, {"gaussian", {&::streamfx::gfx::blur::gaussian_factory::get, S_BLUR_TYPE_GAUSSIAN}}, {"gaussian_linear", {&::streamfx::gfx::blur::gaussian_linear_factory::get, S_BLUR_TYPE_GAUSSIAN_LINEAR}}, {"dual_filtering", {&::streamfx::gfx::blur::dual_filtering_factory::get, S_BLUR_TYPE_DUALFILTERING}}, {"polar", {&::streamfx::gfx::blur::polar_factory::get, S_BLUR_TYPE_POLAR}},
 };
 static std::map<std::string, local_blur_subtype_t> list_of_subtypes = {
 	{"area", {::streamfx::gfx::blur::type::Area, S_BLUR_SUBTYPE_AREA}},
@@ -120,30 +149,286 @@ static std::map<std::string, local_blur_subtype_t> list_of_subtypes = {
 	{"zoom", {::streamfx::gfx::blur::type::Zoom, S_BLUR_SUBTYPE_ZOOM}},
 };
 
-blur_instance::blur_instance(obs_data_t* settings, obs_source_t* self) : obs::source_instance(settings, self), _gfx_util(::streamfx::gfx::util::get()), _source_rendered(false), _output_rendered(false)
+blur_instance::blur_instance(obs_data_t* settings, obs_source_t* self) : obs::source_instance(settings, self), _effect_mask_loader(streamfx::data_file_path("effects/mask.effect")), _gfx_util(::streamfx::gfx::util::get()), _qos(::streamfx::gfx::qos::get()), _source_rendered(false), _roi(), _output_rendered(false), _cache(), _temporal()
 {
+	// Render targets are created on the first render, in the format of the target.
+	update(settings);
+}
+
+blur_instance::~blur_instance()
+{
+	auto gctx = streamfx::obs::gs::context();
+	for (auto stage : _temporal.probe_stage) {
+		if (stage) {
+			gs_stagesurface_destroy(stage);
+		}
+	}
+}
+
+bool blur_instance::is_source_static(obs_source_t* parent, obs_source_t* target, int64_t& media_time)
+{
+	media_time = 0;
+
+	// Masks from other sources change whenever that source does.
+	if (_mask.enabled && (_mask.type == mask_type::Source)) {
+		return false;
+	}
+
+	if (_cache.is_static) {
+		return true;
+	}
+
+	return ::streamfx::obs::tools::filter_input_is_static(parent, target, media_time);
+}
+
+void blur_instance::calculate_roi(uint32_t width, uint32_t height)
+{
+	_roi.enabled = false;
+	_roi.x       = 0;
+	_roi.y       = 0;
+	_roi.width   = width;
+	_roi.height  = height;
+
+	// Only a regular region mask keeps everything outside of it unblurred, and variable blurs don't blur on their own.
+	if (!_mask.enabled || (_mask.type != mask_type::Region) || _mask.region.invert || is_variable()) {
+		return;
+	}
+
+	// Zoom and Rotational blur depend on where the pixel is in the whole image.
+	if ((_blur->get_type() != ::streamfx::gfx::blur::type::Area) && (_blur->get_type() != ::streamfx::gfx::blur::type::Directional)) {
+		return;
+	}
+
+	// Feathering reaches past the region itself, further so if shifted outwards.
+	double_t feather = (_mask.region.feather > std::numeric_limits<float_t>::epsilon()) ? (_mask.region.feather / 2.0 + std::max(_mask.region.feather_shift, 0.f) * _mask.region.feather) : 0.;
+
+	// Pixels just outside the region still contribute to the blur inside of it.
+	double_t radius = 0.;
+	if (std::dynamic_pointer_cast<::streamfx::gfx::blur::dual_filtering>(_blur)) {
+		radius = std::ldexp(1.0, static_cast<int>(std::round(_blur->get_size())) + 1);
+	} else {
+		double_t step_x, step_y;
+		_blur->get_step_scale(step_x, step_y);
+		radius = _blur->get_size() * std::max(std::abs(step_x), std::abs(step_y));
+	}
+	radius = std::ceil(radius) + 1.;
+
+	double_t left   = std::floor((_mask.region.left - feather) * width - radius);
+	double_t top    = std::floor((_mask.region.top - feather) * height - radius);
+	double_t right  = std::ceil((_mask.region.right + feather) * width + radius);
+	double_t bottom = std::ceil((_mask.region.bottom + feather) * height + radius);
+	left            = std::clamp<double_t>(left, 0., width);
+	top             = std::clamp<double_t>(top, 0., height);
+	right           = std::clamp<double_t>(right, left, width);
+	bottom          = std::clamp<double_t>(bottom, top, height);
+	if ((right <= left) || (bottom <= top)) {
+		return;
+	}
+
+	// Not worth the extra copy if most of the image has to be blurred anyway.
+	if (((right - left) * (bottom - top)) > (0.75 * width * height)) {
+		return;
+	}
+
+	_roi.enabled = true;
+	_roi.x       = static_cast<uint32_t>(left);
+	_roi.y       = static_cast<uint32_t>(top);
+	_roi.width   = static_cast<uint32_t>(right - left);
+	_roi.height  = static_cast<uint32_t>(bottom - top);
+}
+
+bool blur_instance::is_mergeable()
+{
+	// Only Gaussian blurs add up to another Gaussian blur, with a size of sqrt(a² + b²). Anything that depends on more
+	// than the image and the size of the blur can not be combined.
+	return _blur && (_blur->get_type() == ::streamfx::gfx::blur::type::Area) && std::dynamic_pointer_cast<::streamfx::gfx::blur::gaussian>(_blur) && !_blur_step_scaling && !_mask.enabled && !_temporal.enabled && !_cache.is_static;
+}
+
+bool blur_instance::is_variable()
+{
+	return _mask.enabled && _mask.variable && _blur && (_blur->get_type() == ::streamfx::gfx::blur::type::Area);
+}
+
+bool blur_instance::is_fusable()
+{
+	// Masks and fading need the unblurred source as well, and the mask also limits what is blurred.
+	return _blur && !_mask.enabled && !_temporal.enabled;
+}
+
+std::shared_ptr<streamfx::obs::gs::texture> blur_instance::render_blur(const ::streamfx::gfx::blur::base::capture_t& capture, uint32_t width, uint32_t height, gs_color_format format, bool is_static)
+{
+	// While OBS can't keep up, take half the samples twice as far apart, which keeps the radius. Static results are kept
+	// for longer, so they are always blurred at full quality.
+	bool     reduce = !is_static && (_qos->level() >= 1) && !std::dynamic_pointer_cast<::streamfx::gfx::blur::dual_filtering>(_blur);
+	double_t size   = _blur->get_size();
+	double_t step_x, step_y;
+	_blur->get_step_scale(step_x, step_y);
+	if (reduce) {
+		_blur->set_size(size / 2.);
+		_blur->set_step_scale(step_x * 2., step_y * 2.);
+	}
+	auto result = capture ? _blur->render_capture(capture, width, height, format) : _blur->render();
+	if (reduce) {
+		_blur->set_size(size);
+		_blur->set_step_scale(step_x, step_y);
+	}
+	return result;
+}
+
+blur_instance* blur_instance::find_filter_above(obs_source_t* parent)
+{
+	struct {
+		obs_source_t* self;
+		obs_source_t* above;
+	} context = {_self, nullptr};
+
+	obs_source_enum_filters(
+		parent,
+		[](obs_source_t*, obs_source_t* child, void* param) {
+			auto ctx = reinterpret_cast<decltype(context)*>(param);
+			if (obs_filter_get_target(child) == ctx->self) {
+				ctx->above = child;
+			}
+		},
+		&context);
+
+	return from_filter(context.above);
+}
+
+blur_instance* blur_instance::from_filter(obs_source_t* filter)
+{
+	if (!filter || (obs_source_get_type(filter) != OBS_SOURCE_TYPE_FILTER) || !obs_source_enabled(filter)) {
+		return nullptr;
+	}
+	if (strcmp(obs_source_get_id(filter), S_PREFIX "filter-blur") != 0) {
+		return nullptr;
+	}
+	return reinterpret_cast<blur_instance*>(obs_obj_get_data(filter));
+}
+
+void blur_instance::temporal_probe()
+{
+	if (!_temporal.probe_rt) {
+		_temporal.probe_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	}
+	for (auto& stage : _temporal.probe_stage) {
+		if (!stage) {
+			stage = gs_stagesurface_create(ST_TEMPORAL_PROBE_SIZE, ST_TEMPORAL_PROBE_SIZE, GS_RGBA);
+		}
+	}
+	if (!_temporal.probe_stage[0] || !_temporal.probe_stage[1]) {
+		// Without a way to read back the source, only the interval decides.
+		return;
+	}
+
+	// Read what was staged on the previous frame, so that we never have to wait for the GPU.
+	if (std::size_t read = _temporal.probe_index ^ 1; _temporal.probe_staged[read]) {
+		uint8_t* data     = nullptr;
+		uint32_t linesize = 0;
+		if (gs_stagesurface_map(_temporal.probe_stage[read], &data, &linesize)) {
+			std::pmr::vector<float_t> luma(ST_TEMPORAL_PROBE_SIZE * ST_TEMPORAL_PROBE_SIZE, streamfx::gfx::frame_arena::get());
+			for (std::size_t y = 0; y < ST_TEMPORAL_PROBE_SIZE; y++) {
+				for (std::size_t x = 0; x < ST_TEMPORAL_PROBE_SIZE; x++) {
+					const uint8_t* px                    = data + y * linesize + x * 4;
+					luma[y * ST_TEMPORAL_PROBE_SIZE + x] = (0.2126f * px[0] + 0.7152f * px[1] + 0.0722f * px[2]) / 255.f;
+				}
+			}
+			gs_stagesurface_unmap(_temporal.probe_stage[read]);
+
+			if (_temporal.reference.empty()) {
+				_temporal.reference.assign(luma.begin(), luma.end());
+			} else {
+				float_t difference = 0.;
+				for (std::size_t idx = 0; idx < luma.size(); idx++) {
+					difference += std::abs(luma[idx] - _temporal.reference[idx]);
+				}
+				if ((difference / static_cast<float_t>(luma.size())) > _temporal.threshold) {
+					_temporal.changed = true;
+				}
+			}
+		}
+		_temporal.probe_staged[read] = false;
+	}
+
+	// Stage a tiny copy of the current frame.
 	{
-		auto gctx = streamfx::obs::gs::context();
+		gs_effect_t* effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
 
-		// Create RenderTargets
-		this->_source_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-		this->_output_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
-		// Load Effects
 		{
-			auto file = streamfx::data_file_path("effects/mask.effect");
-			try {
-				_effect_mask = streamfx::obs::gs::effect::create(file);
-			} catch (std::exception& ex) {
-				DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
+			auto op = _temporal.probe_rt->render(ST_TEMPORAL_PROBE_SIZE, ST_TEMPORAL_PROBE_SIZE);
+			gs_ortho(0, 1., 0, 1., -1., 1.);
+			gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), _source_texture->get_object());
+			while (gs_effect_loop(effect, "Draw")) {
+				_gfx_util->draw_fullscreen_triangle();
 			}
 		}
+
+		gs_blend_state_pop();
 	}
+	gs_stage_texture(_temporal.probe_stage[_temporal.probe_index], _temporal.probe_rt->get_object());
+	_temporal.probe_staged[_temporal.probe_index] = true;
+	_temporal.probe_index ^= 1;
+}
 
-	update(settings);
+bool blur_instance::temporal_should_blur(uint32_t width, uint32_t height)
+{
+	temporal_probe();
+
+	if (_temporal.dirty || !_temporal.blurred || (_temporal.width != width) || (_temporal.height != height)) {
+		// Nothing shown so far is worth fading from.
+		_temporal.mix_rt[_temporal.mix_index].reset();
+		return true;
+	}
+
+	return _temporal.changed || ((_temporal.frames + 1) >= _temporal.interval);
 }
 
-blur_instance::~blur_instance() {}
+std::shared_ptr<streamfx::obs::gs::texture> blur_instance::temporal_mix(std::shared_ptr<streamfx::obs::gs::texture> blurred, bool fresh)
+{
+	if (!_effect_mask || !blurred) {
+		return blurred;
+	}
+
+	if (fresh) {
+		// Whatever was shown last fades out over the next frames, so keep it away from the next mix.
+		_temporal.previous  = _temporal.mix_rt[_temporal.mix_index];
+		_temporal.mix_index = _temporal.mix_index ^ 1;
+	}
+
+	auto& target = _temporal.mix_rt[_temporal.mix_index];
+	if (!target || (target->get_color_format() != blurred->get_color_format())) {
+		target = std::make_shared<streamfx::obs::gs::rendertarget>(blurred->get_color_format(), GS_ZS_NONE);
+	}
+
+	// Mix linearly over the interval, anything that does not match is replaced right away.
+	float_t                                     factor   = 1.;
+	std::shared_ptr<streamfx::obs::gs::texture> previous = _temporal.previous ? _temporal.previous->get_texture() : nullptr;
+	if (previous && (previous->get_width() == blurred->get_width()) && (previous->get_height() == blurred->get_height()) && (_temporal.interval > 1)) {
+		factor = std::clamp<float_t>(static_cast<float_t>(_temporal.frames + 1) / static_cast<float_t>(_temporal.interval), 0., 1.);
+	} else {
+		previous = blurred;
+	}
+
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
+
+	{
+		auto op = target->render(blurred->get_width(), blurred->get_height());
+		gs_ortho(0, 1., 0, 1., -1., 1.);
+
+		_effect_mask.get_parameter("image_orig").set_texture(previous);
+		_effect_mask.get_parameter("image_blur").set_texture(blurred);
+		_effect_mask.get_parameter("mix_factor").set_float(factor);
+		while (gs_effect_loop(_effect_mask.get_object(), "Mix")) {
+			_gfx_util->draw_fullscreen_triangle();
+		}
+	}
+
+	gs_blend_state_pop();
+
+	return target->get_texture();
+}
 
 bool blur_instance::apply_mask_parameters(streamfx::obs::gs::effect effect, gs_texture_t* original_texture, gs_texture_t* blurred_texture)
 {
@@ -153,6 +438,15 @@ bool blur_instance::apply_mask_parameters(streamfx::obs::gs::effect effect, gs_t
 	if (effect.has_parameter("image_blur")) {
 		effect.get_parameter("image_blur").set_texture(blurred_texture);
 	}
+	if (effect.has_parameter("image_blur_region")) {
+		uint32_t width  = gs_texture_get_width(original_texture);
+		uint32_t height = gs_texture_get_height(original_texture);
+		if (_roi.enabled && (width > 0) && (height > 0)) {
+			effect.get_parameter("image_blur_region").set_float4(static_cast<float_t>(_roi.x) / width, static_cast<float_t>(_roi.y) / height, static_cast<float_t>(_roi.width) / width, static_cast<float_t>(_roi.height) / height);
+		} else {
+			effect.get_parameter("image_blur_region").set_float4(0.f, 0.f, 1.f, 1.f);
+		}
+	}
 
 	// Region
 	if (_mask.type == mask_type::Region) {
@@ -198,6 +492,17 @@ bool blur_instance::apply_mask_parameters(streamfx::obs::gs::effect effect, gs_t
 		}
 	}
 
+	// Shared Mask
+	if (_mask.type == mask_type::Shared) {
+		if (effect.has_parameter("mask_image")) {
+			if (_mask.shared.target) {
+				effect.get_parameter("mask_image").set_texture(_mask.shared.target->get_object());
+			} else {
+				effect.get_parameter("mask_image").set_texture(nullptr);
+			}
+		}
+	}
+
 	// Shared
 	if (effect.has_parameter("mask_color")) {
 		effect.get_parameter("mask_color").set_float4(_mask.color.r, _mask.color.g, _mask.color.b, _mask.color.a);
@@ -206,6 +511,16 @@ bool blur_instance::apply_mask_parameters(streamfx::obs::gs::effect effect, gs_t
 		effect.get_parameter("mask_multiplier").set_float(_mask.multiplier);
 	}
 
+	// Variable
+	if (effect.has_parameter("mask_blur_size")) {
+		effect.get_parameter("mask_blur_size").set_float(static_cast<float_t>(_blur->get_size()));
+	}
+	if (effect.has_parameter("image_texel")) {
+		uint32_t width  = std::max<uint32_t>(gs_texture_get_width(original_texture), 1);
+		uint32_t height = std::max<uint32_t>(gs_texture_get_height(original_texture), 1);
+		effect.get_parameter("image_texel").set_float2(1.f / static_cast<float_t>(width), 1.f / static_cast<float_t>(height));
+	}
+
 	return true;
 }
 
@@ -254,6 +569,17 @@ void blur_instance::migrate(obs_data_t* settings, uint64_t version)
 
 void blur_instance::update(obs_data_t* settings)
 {
+	// Any change to the settings invalidates the previous result.
+	_cache.is_static = obs_data_get_bool(settings, ST_KEY_STATIC);
+	_cache.valid     = false;
+
+	{ // Temporal Reuse
+		_temporal.enabled   = obs_data_get_bool(settings, ST_KEY_TEMPORAL);
+		_temporal.interval  = static_cast<uint32_t>(std::max<int64_t>(obs_data_get_int(settings, ST_KEY_TEMPORAL_INTERVAL), 1));
+		_temporal.threshold = static_cast<float_t>(obs_data_get_double(settings, ST_KEY_TEMPORAL_THRESHOLD) / 100.0);
+		_temporal.dirty     = true;
+	}
+
 	{ // Blur Type
 		const char* blur_type      = obs_data_get_string(settings, ST_KEY_TYPE);
 		const char* blur_subtype   = obs_data_get_string(settings, ST_KEY_SUBTYPE);
@@ -282,12 +608,16 @@ void blur_instance::update(obs_data_t* settings)
 		this->_blur_step_scaling      = obs_data_get_bool(settings, ST_KEY_STEPSCALE);
 		this->_blur_step_scale.first  = obs_data_get_double(settings, ST_KEY_STEPSCALE_X) / 100.0;
 		this->_blur_step_scale.second = obs_data_get_double(settings, ST_KEY_STEPSCALE_Y) / 100.0;
+
+		// Precision
+		this->_blur_precision = static_cast<::streamfx::gfx::blur::precision>(obs_data_get_int(settings, ST_KEY_PRECISION));
 	}
 
 	{ // Masking
 		_mask.enabled = obs_data_get_bool(settings, ST_KEY_MASK);
 		if (_mask.enabled) {
-			_mask.type = static_cast<mask_type>(obs_data_get_int(settings, ST_KEY_MASK_TYPE));
+			_mask.type     = static_cast<mask_type>(obs_data_get_int(settings, ST_KEY_MASK_TYPE));
+			_mask.variable = obs_data_get_bool(settings, ST_KEY_MASK_VARIABLE);
 			switch (_mask.type) {
 			case mask_type::Region:
 				_mask.region.left          = float_t(obs_data_get_double(settings, ST_KEY_MASK_REGION_LEFT) / 100.0);
@@ -304,6 +634,13 @@ void blur_instance::update(obs_data_t* settings)
 			case mask_type::Source:
 				_mask.source.name = obs_data_get_string(settings, ST_KEY_MASK_SOURCE);
 				break;
+			case mask_type::Shared:
+				_mask.shared.name   = obs_data_get_string(settings, ST_KEY_MASK_SHARED);
+				_mask.shared.invert = obs_data_get_bool(settings, ST_KEY_MASK_SHARED_INVERT);
+				if (!_mask.shared.registry) {
+					_mask.shared.registry = ::streamfx::gfx::shared_masks::get();
+				}
+				break;
 			}
 			if ((_mask.type == mask_type::Image) || (_mask.type == mask_type::Source)) {
 				uint32_t color   = static_cast<uint32_t>(obs_data_get_int(settings, ST_KEY_MASK_COLOR));
@@ -312,11 +649,20 @@ void blur_instance::update(obs_data_t* settings)
 				_mask.color.b    = static_cast<float>((color >> 16) & 0xFF) / 255.0f;
 				_mask.color.a    = static_cast<float_t>(obs_data_get_double(settings, ST_KEY_MASK_ALPHA));
 				_mask.multiplier = float_t(obs_data_get_double(settings, ST_KEY_MASK_MULTIPLIER));
+			} else if (_mask.type == mask_type::Shared) {
+				// Shared masks are always in the alpha channel.
+				_mask.color      = {0.f, 0.f, 0.f, 1.f};
+				_mask.multiplier = float_t(obs_data_get_double(settings, ST_KEY_MASK_MULTIPLIER));
 			}
 		}
 	}
 }
 
+bool blur_instance::video_tick_skip_hidden()
+{
+	return true;
+}
+
 void blur_instance::video_tick(float)
 {
 	// Blur
@@ -327,6 +673,7 @@ void blur_instance::video_tick(float)
 		} else {
 			_blur->set_step_scale(1.0, 1.0);
 		}
+		_blur->set_precision(_blur_precision);
 		if ((_blur->get_type() == ::streamfx::gfx::blur::type::Directional) || (_blur->get_type() == ::streamfx::gfx::blur::type::Rotational)) {
 			auto obj = std::dynamic_pointer_cast<::streamfx::gfx::blur::base_angle>(_blur);
 			obj->set_angle(_blur_angle);
@@ -339,13 +686,16 @@ void blur_instance::video_tick(float)
 
 	// Load Mask
 	if (_mask.type == mask_type::Image) {
+		// Decoding happens on the thread pool, the previous image stays in use until the new one is ready.
+		if (!_mask.image.upload) {
+			_mask.image.upload = std::make_shared<streamfx::obs::gs::texture_upload>();
+		}
 		if (_mask.image.path_old != _mask.image.path) {
-			try {
-				_mask.image.texture  = std::make_shared<streamfx::obs::gs::texture>(_mask.image.path);
-				_mask.image.path_old = _mask.image.path;
-			} catch (...) {
-				DLOG_ERROR("<filter-blur> Instance '%s' failed to load image '%s'.", obs_source_get_name(_self), _mask.image.path.c_str());
-			}
+			_mask.image.upload->submit_file(_mask.image.path);
+			_mask.image.path_old = _mask.image.path;
+		}
+		if (_mask.image.upload->update()) {
+			_mask.image.texture = _mask.image.upload->get_texture();
 		}
 	} else if (_mask.type == mask_type::Source) {
 		if (_mask.source.name_old != _mask.source.name) {
@@ -363,6 +713,12 @@ void blur_instance::video_tick(float)
 	_output_rendered = false;
 }
 
+gs_color_space blur_instance::video_get_color_space(size_t count, const gs_color_space* preferred_spaces)
+{
+	// Blurring works the same in every color space, so there is no reason to convert to or from any of them.
+	return ::streamfx::obs::tools::filter_pass_through_space(_self);
+}
+
 void blur_instance::video_render(gs_effect_t* effect)
 {
 	obs_source_t* parent        = obs_filter_get_parent(this->_self);
@@ -381,6 +737,51 @@ void blur_instance::video_render(gs_effect_t* effect)
 	streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_source, "Blur '%s'", obs_source_get_name(_self)};
 #endif
 
+	// Work in the color space of the target, and only convert when drawing the result if the render target needs it.
+	gs_color_space  space  = ::streamfx::obs::tools::filter_pass_through_space(_self);
+	gs_color_format format = ::streamfx::obs::tools::color_format(space);
+	if (!_source_rt || (_source_rt->get_color_format() != format)) {
+		_source_rt   = std::make_shared<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+		_output_rt   = std::make_shared<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+		_roi_rt      = std::make_shared<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+		_cache.valid = false;
+	}
+
+	// Masking and fading need an extra effect, loaded once either is used. Until then, the whole frame is blurred.
+	if ((_mask.enabled || _temporal.enabled) && !_effect_mask) {
+		_effect_mask = _effect_mask_loader.get();
+	}
+
+	// Stacked Gaussian blurs combine into a single one, so only the top-most of them has to do any work.
+	if (is_mergeable()) {
+		if (auto above = find_filter_above(parent); above && above->is_mergeable()) {
+			obs_source_skip_video_filter(this->_self);
+			return;
+		}
+
+		double_t size  = _blur_size * _blur_size;
+		bool     merge = false;
+		for (obs_source_t* below = target; blur_instance* instance = from_filter(below); below = obs_filter_get_target(below)) {
+			if (!instance->is_mergeable()) {
+				break;
+			}
+			size += instance->_blur_size * instance->_blur_size;
+			merge = true;
+		}
+		if (merge) {
+			_blur->set_size(std::sqrt(size));
+		}
+	}
+
+	// Static sources only need to be blurred again if something about them or us changed.
+	int64_t media_time = 0;
+	bool    is_static  = is_source_static(parent, target, media_time);
+	if (!_source_rendered && _cache.valid && is_static && (_cache.width == baseW) && (_cache.height == baseH) && (_cache.media_time == media_time)) {
+		_source_rendered = true;
+		_output_rendered = true;
+	}
+
+	bool fused = false;
 	if (!_source_rendered) {
 		// Source To Texture
 		{
@@ -388,37 +789,44 @@ void blur_instance::video_render(gs_effect_t* effect)
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_cache, "Cache"};
 #endif
 
-			if (obs_source_process_filter_begin(this->_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
-				{
-					auto op = this->_source_rt->render(baseW, baseH);
+			// Static sources keep their capture across frames, which a handed over texture must not be.
+			std::unique_ptr<streamfx::obs::gs::handoff> handoff;
+			if (!is_static) {
+				handoff = std::make_unique<streamfx::obs::gs::handoff>(target, baseW, baseH, format);
+			}
 
-					gs_blend_state_push();
-					gs_reset_blend_state();
-					gs_enable_blending(false);
-					gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+			// A blur that captures the source itself draws it with its own effect, which only works if libobs draws the source
+			// from a texture instead of letting the source draw itself.
+			::streamfx::gfx::blur::base::capture_t capture;
+			if (is_fusable()) {
+				capture = [this, baseW, baseH](gs_effect_t* blur_effect, const char* technique) { obs_source_process_filter_tech_end(this->_self, blur_effect, baseW, baseH, technique); };
+			}
 
-					gs_set_cull_mode(GS_NEITHER);
-					gs_enable_color(true, true, true, true);
+			if (obs_source_process_filter_begin_with_color_space(this->_self, format, space, capture ? OBS_NO_DIRECT_RENDERING : OBS_ALLOW_DIRECT_RENDERING)) {
+				if (auto handed = handoff ? handoff->take() : nullptr; handed) {
+					_source_texture = handed;
+				} else if (capture && (_output_texture = render_blur(capture, baseW, baseH, format, is_static))) {
+					// The first pass of the blur read the source as it was drawn, so there is no copy of it.
+					_source_texture = _output_texture;
+					fused           = true;
+				} else {
+					{
+						auto op = this->_source_rt->render(baseW, baseH, space);
 
-					gs_enable_depth_test(false);
-					gs_depth_function(GS_ALWAYS);
+						streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
-					gs_enable_stencil_test(false);
-					gs_enable_stencil_write(false);
-					gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-					gs_stencil_op(GS_STENCIL_BOTH, GS_KEEP, GS_KEEP, GS_KEEP);
+						// Orthographic Camera and clear RenderTarget.
+						gs_ortho(0, static_cast<float>(baseW), 0, static_cast<float>(baseH), -1., 1.);
+						//gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &black, 0, 0);
 
-					// Orthographic Camera and clear RenderTarget.
-					gs_ortho(0, static_cast<float>(baseW), 0, static_cast<float>(baseH), -1., 1.);
-					//gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &black, 0, 0);
+						// Render
+						obs_source_process_filter_end(this->_self, defaultEffect, baseW, baseH);
 
-					// Render
-					obs_source_process_filter_end(this->_self, defaultEffect, baseW, baseH);
+						gs_blend_state_pop();
+					}
 
-					gs_blend_state_pop();
+					_source_texture = this->_source_rt->get_texture();
 				}
-
-				_source_texture = this->_source_rt->get_texture();
 				if (!_source_texture) {
 					obs_source_skip_video_filter(this->_self);
 					return;
@@ -438,28 +846,72 @@ void blur_instance::video_render(gs_effect_t* effect)
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Blur"};
 #endif
 
-			_blur->set_input(_source_texture);
-			_output_texture = _blur->render();
+			// Only blur the part of the image that the mask will actually show.
+			calculate_roi(baseW, baseH);
+
+			// Slowly changing sources may reuse an earlier blur for a few frames. Variable blurs are cheap enough not to, and
+			// fused ones are already done.
+			bool variable = is_variable();
+			bool fresh    = variable || fused || !_temporal.enabled || temporal_should_blur(baseW, baseH);
+			if (variable) {
+				// Every mip level is twice as blurry as the previous one, and the mask picks which one to show.
+				if (!_mipmapper) {
+					_mipmapper = ::streamfx::gfx::mipmapper::get();
+				}
+				if (!(_output_texture = _mipmapper->generate(_source_texture))) {
+					obs_source_skip_video_filter(this->_self);
+					return;
+				}
+			} else if (fresh && !fused) {
+				if (_roi.enabled) {
+					try {
+						auto op = _roi_rt->render(_roi.width, _roi.height, space);
+						gs_ortho(static_cast<float>(_roi.x), static_cast<float>(_roi.x + _roi.width), static_cast<float>(_roi.y), static_cast<float>(_roi.y + _roi.height), -1., 1.);
+
+						streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
+
+						gs_effect_set_texture(gs_effect_get_param_by_name(defaultEffect, "image"), _source_texture->get_object());
+						while (gs_effect_loop(defaultEffect, "Draw")) {
+							gs_draw_sprite(_source_texture->get_object(), 0, baseW, baseH);
+						}
+
+						gs_blend_state_pop();
+					} catch (const std::exception&) {
+						obs_source_skip_video_filter(this->_self);
+						return;
+					}
+
+					_blur->set_input(_roi_rt->get_texture());
+				} else {
+					_blur->set_input(_source_texture);
+				}
+				_output_texture = render_blur({}, baseW, baseH, format, is_static);
+
+				_temporal.blurred = _output_texture;
+				_temporal.frames  = 0;
+				_temporal.changed = false;
+				_temporal.dirty   = false;
+				_temporal.width   = baseW;
+				_temporal.height  = baseH;
+				_temporal.reference.clear();
+			} else {
+				_output_texture = _temporal.blurred;
+				_temporal.frames++;
+			}
+
+			// Fade from the previous result to the new one, instead of jumping to it.
+			if (_temporal.enabled && !variable) {
+				_output_texture = temporal_mix(_output_texture, fresh);
+			}
 		}
 
 		// Mask
-		if (_mask.enabled) {
+		if (_mask.enabled && _effect_mask) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Mask"};
 #endif
 
-			gs_blend_state_push();
-			gs_reset_blend_state();
-			gs_enable_color(true, true, true, true);
-			gs_enable_blending(false);
-			gs_enable_depth_test(false);
-			gs_enable_stencil_test(false);
-			gs_enable_stencil_write(false);
-			gs_set_cull_mode(GS_NEITHER);
-			gs_depth_function(GS_ALWAYS);
-			gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-			gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-			gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+			streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
 			std::string technique = "";
 			switch (this->_mask.type) {
@@ -482,6 +934,20 @@ void blur_instance::video_render(gs_effect_t* effect)
 			case mask_type::Source:
 				technique = "Image";
 				break;
+			case mask_type::Shared:
+				technique = this->_mask.shared.invert ? "ImageInverted" : "Image";
+				break;
+			}
+			if (is_variable()) {
+				technique += "Variable";
+			}
+
+			// Whoever publishes the shared mask may not have rendered in a while, in which case the source is shown as is.
+			if (_mask.type == mask_type::Shared) {
+				_mask.shared.target = _mask.shared.registry ? _mask.shared.registry->find(_mask.shared.name) : nullptr;
+				if (!_mask.shared.target) {
+					technique.clear();
+				}
 			}
 
 			if (_mask.source.source_texture) {
@@ -509,30 +975,41 @@ void blur_instance::video_render(gs_effect_t* effect)
 				this->_mask.source.texture = this->_mask.source.source_texture->render(source_width, source_height);
 			}
 
-			apply_mask_parameters(_effect_mask, _source_texture->get_object(), _output_texture->get_object());
+			if (technique.empty()) {
+				_output_texture = _source_texture;
+			} else {
+				apply_mask_parameters(_effect_mask, _source_texture->get_object(), _output_texture->get_object());
 
-			try {
-				auto op = this->_output_rt->render(baseW, baseH);
-				gs_ortho(0, 1, 0, 1, -1, 1);
+				try {
+					auto op = this->_output_rt->render(baseW, baseH, space);
+					gs_ortho(0, 1, 0, 1, -1, 1);
 
-				// Render
-				while (gs_effect_loop(_effect_mask.get_object(), technique.c_str())) {
-					_gfx_util->draw_fullscreen_triangle();
+					// Render
+					while (gs_effect_loop(_effect_mask.get_object(), technique.c_str())) {
+						_gfx_util->draw_fullscreen_triangle();
+					}
+				} catch (const std::exception&) {
+					_mask.shared.target.reset();
+					gs_blend_state_pop();
+					obs_source_skip_video_filter(this->_self);
+					return;
 				}
-			} catch (const std::exception&) {
-				gs_blend_state_pop();
-				obs_source_skip_video_filter(this->_self);
-				return;
 			}
+			_mask.shared.target.reset();
 			gs_blend_state_pop();
 
-			if (!(_output_texture = this->_output_rt->get_texture())) {
+			if (!_output_texture || (!technique.empty() && !(_output_texture = this->_output_rt->get_texture()))) {
 				obs_source_skip_video_filter(this->_self);
 				return;
 			}
 		}
 
 		_output_rendered = true;
+
+		_cache.valid      = is_static && !(_mask.enabled && (_mask.type == mask_type::Shared)); // Shared masks change on their own.
+		_cache.width      = baseW;
+		_cache.height     = baseH;
+		_cache.media_time = media_time;
 	}
 
 	// Draw source
@@ -552,7 +1029,19 @@ void blur_instance::video_render(gs_effect_t* effect)
 		gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
 
 		gs_effect_t* finalEffect = effect ? effect : defaultEffect;
-		const char*  technique   = "Draw";
+		float_t      multiplier  = 1.f;
+		const char*  technique   = ::streamfx::obs::tools::draw_technique(space, multiplier);
+		bool         convert     = (std::string_view(technique) != "Draw");
+		if (convert) {
+			// Only the default effect knows how to convert between color spaces.
+			finalEffect = defaultEffect;
+			gs_effect_set_float(gs_effect_get_param_by_name(finalEffect, "multiplier"), multiplier);
+		}
+
+		// A StreamFX filter below may take the output as it is, which saves drawing it here and capturing it there.
+		if (!convert && (finalEffect == defaultEffect) && streamfx::obs::gs::handoff::offer(_self, _output_texture)) {
+			return;
+		}
 
 		gs_eparam_t* param = gs_effect_get_param_by_name(finalEffect, "image");
 		if (!param) {
@@ -568,6 +1057,21 @@ void blur_instance::video_render(gs_effect_t* effect)
 	}
 }
 
+void blur_instance::prepare()
+{
+	gs_color_format format = ::streamfx::obs::tools::color_format(::streamfx::obs::tools::filter_pass_through_space(_self));
+	if (!_source_rt || (_source_rt->get_color_format() != format)) {
+		_source_rt   = std::make_shared<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+		_output_rt   = std::make_shared<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+		_roi_rt      = std::make_shared<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+		_cache.valid = false;
+	}
+
+	if ((_mask.enabled || _temporal.enabled) && !_effect_mask) {
+		_effect_mask = _effect_mask_loader.get();
+	}
+}
+
 blur_factory::blur_factory()
 {
 	_info.id           = S_PREFIX "filter-blur";
@@ -575,6 +1079,7 @@ blur_factory::blur_factory()
 	_info.output_flags = OBS_SOURCE_VIDEO;
 
 	support_size(false);
+	support_color_space(true);
 	finish_setup();
 	register_proxy("obs-stream-effects-filter-blur");
 }
@@ -588,8 +1093,11 @@ const char* blur_factory::get_name()
 
 void blur_factory::get_defaults2(obs_data_t* settings)
 {
+	// Box and Linear Box blur look the same, as do Low and Automatic precision for most sources, so use what is faster here.
+	auto calibration = ::streamfx::gfx::calibration::get();
+
 	// Type, Subtype
-	obs_data_set_default_string(settings, ST_KEY_TYPE, "box");
+	obs_data_set_default_string(settings, ST_KEY_TYPE, calibration->blur_type().c_str());
 	obs_data_set_default_string(settings, ST_KEY_SUBTYPE, "area");
 
 	// Parameters
@@ -600,6 +1108,7 @@ void blur_factory::get_defaults2(obs_data_t* settings)
 	obs_data_set_default_bool(settings, ST_KEY_STEPSCALE, false);
 	obs_data_set_default_double(settings, ST_KEY_STEPSCALE_X, 1.);
 	obs_data_set_default_double(settings, ST_KEY_STEPSCALE_Y, 1.);
+	obs_data_set_default_int(settings, ST_KEY_PRECISION, static_cast<int64_t>(calibration->blur_precision()));
 
 	// Masking
 	obs_data_set_default_bool(settings, ST_KEY_MASK, false);
@@ -613,8 +1122,19 @@ void blur_factory::get_defaults2(obs_data_t* settings)
 	obs_data_set_default_bool(settings, ST_KEY_MASK_REGION_INVERT, false);
 	obs_data_set_default_string(settings, ST_KEY_MASK_IMAGE, streamfx::data_file_path("white.png").u8string().c_str());
 	obs_data_set_default_string(settings, ST_KEY_MASK_SOURCE, "");
+	obs_data_set_default_string(settings, ST_KEY_MASK_SHARED, "");
+	obs_data_set_default_bool(settings, ST_KEY_MASK_SHARED_INVERT, false);
 	obs_data_set_default_int(settings, ST_KEY_MASK_COLOR, 0xFFFFFFFFull);
 	obs_data_set_default_double(settings, ST_KEY_MASK_MULTIPLIER, 1.0);
+	obs_data_set_default_bool(settings, ST_KEY_MASK_VARIABLE, false);
+
+	// Temporal Reuse
+	obs_data_set_default_bool(settings, ST_KEY_TEMPORAL, false);
+	obs_data_set_default_int(settings, ST_KEY_TEMPORAL_INTERVAL, 4);
+	obs_data_set_default_double(settings, ST_KEY_TEMPORAL_THRESHOLD, 2.0);
+
+	// Caching
+	obs_data_set_default_bool(settings, ST_KEY_STATIC, false);
 }
 
 bool modified_properties(void*, obs_properties_t* props, obs_property* prop, obs_data_t* settings) noexcept
@@ -717,7 +1237,9 @@ bool modified_properties(void*, obs_properties_t* props, obs_property* prop, obs
 			bool      show_region = (mtype == mask_type::Region) && show_mask;
 			bool      show_image  = (mtype == mask_type::Image) && show_mask;
 			bool      show_source = (mtype == mask_type::Source) && show_mask;
+			bool      show_shared = (mtype == mask_type::Shared) && show_mask;
 			obs_property_set_visible(obs_properties_get(props, ST_KEY_MASK_TYPE), show_mask);
+			obs_property_set_visible(obs_properties_get(props, ST_KEY_MASK_VARIABLE), show_mask);
 			obs_property_set_visible(obs_properties_get(props, ST_KEY_MASK_REGION_LEFT), show_region);
 			obs_property_set_visible(obs_properties_get(props, ST_KEY_MASK_REGION_TOP), show_region);
 			obs_property_set_visible(obs_properties_get(props, ST_KEY_MASK_REGION_RIGHT), show_region);
@@ -727,9 +1249,17 @@ bool modified_properties(void*, obs_properties_t* props, obs_property* prop, obs
 			obs_property_set_visible(obs_properties_get(props, ST_KEY_MASK_REGION_INVERT), show_region);
 			obs_property_set_visible(obs_properties_get(props, ST_KEY_MASK_IMAGE), show_image);
 			obs_property_set_visible(obs_properties_get(props, ST_KEY_MASK_SOURCE), show_source);
+			obs_property_set_visible(obs_properties_get(props, ST_KEY_MASK_SHARED), show_shared);
+			obs_property_set_visible(obs_properties_get(props, ST_KEY_MASK_SHARED_INVERT), show_shared);
 			obs_property_set_visible(obs_properties_get(props, ST_KEY_MASK_COLOR), show_image || show_source);
 			obs_property_set_visible(obs_properties_get(props, ST_KEY_MASK_ALPHA), show_image || show_source);
-			obs_property_set_visible(obs_properties_get(props, ST_KEY_MASK_MULTIPLIER), show_image || show_source);
+			obs_property_set_visible(obs_properties_get(props, ST_KEY_MASK_MULTIPLIER), show_image || show_source || show_shared);
+		}
+
+		{ // Temporal Reuse
+			bool show_temporal = obs_data_get_bool(settings, ST_KEY_TEMPORAL);
+			obs_property_set_visible(obs_properties_get(props, ST_KEY_TEMPORAL_INTERVAL), show_temporal);
+			obs_property_set_visible(obs_properties_get(props, ST_KEY_TEMPORAL_THRESHOLD), show_temporal);
 		}
 
 		return true;
@@ -759,6 +1289,7 @@ obs_properties_t* blur_factory::get_properties2(blur_instance* data)
 		obs_property_list_add_string(p, D_TRANSLATE(S_BLUR_TYPE_GAUSSIAN), "gaussian");
 		obs_property_list_add_string(p, D_TRANSLATE(S_BLUR_TYPE_GAUSSIAN_LINEAR), "gaussian_linear");
 		obs_property_list_add_string(p, D_TRANSLATE(S_BLUR_TYPE_DUALFILTERING), "dual_filtering");
+		obs_property_list_add_string(p, D_TRANSLATE(S_BLUR_TYPE_POLAR), "polar");
 
 		p = obs_properties_add_list(pr, ST_KEY_SUBTYPE, D_TRANSLATE(ST_I18N_SUBTYPE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 		obs_property_set_modified_callback2(p, modified_properties, this);
@@ -779,6 +1310,12 @@ obs_properties_t* blur_factory::get_properties2(blur_instance* data)
 		obs_property_set_modified_callback2(p, modified_properties, this);
 		p = obs_properties_add_float_slider(pr, ST_KEY_STEPSCALE_X, D_TRANSLATE(ST_I18N_STEPSCALE_X), 0.0, 1000.0, 0.01);
 		p = obs_properties_add_float_slider(pr, ST_KEY_STEPSCALE_Y, D_TRANSLATE(ST_I18N_STEPSCALE_Y), 0.0, 1000.0, 0.01);
+
+		p = obs_properties_add_list(pr, ST_KEY_PRECISION, D_TRANSLATE(ST_I18N_PRECISION), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+		obs_property_list_add_int(p, D_TRANSLATE(S_STATE_AUTOMATIC), static_cast<int64_t>(::streamfx::gfx::blur::precision::Automatic));
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_PRECISION_LOW), static_cast<int64_t>(::streamfx::gfx::blur::precision::Low));
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_PRECISION_HALF), static_cast<int64_t>(::streamfx::gfx::blur::precision::Half));
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_PRECISION_FULL), static_cast<int64_t>(::streamfx::gfx::blur::precision::Full));
 	}
 
 	// Masking
@@ -790,6 +1327,8 @@ obs_properties_t* blur_factory::get_properties2(blur_instance* data)
 		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_MASK_TYPE_REGION), static_cast<int64_t>(mask_type::Region));
 		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_MASK_TYPE_IMAGE), static_cast<int64_t>(mask_type::Image));
 		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_MASK_TYPE_SOURCE), static_cast<int64_t>(mask_type::Source));
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_MASK_TYPE_SHARED), static_cast<int64_t>(mask_type::Shared));
+		p = obs_properties_add_bool(pr, ST_KEY_MASK_VARIABLE, D_TRANSLATE(ST_I18N_MASK_VARIABLE));
 		/// Region
 		p = obs_properties_add_float_slider(pr, ST_KEY_MASK_REGION_LEFT, D_TRANSLATE(ST_I18N_MASK_REGION_LEFT), 0.0, 100.0, 0.01);
 		p = obs_properties_add_float_slider(pr, ST_KEY_MASK_REGION_TOP, D_TRANSLATE(ST_I18N_MASK_REGION_TOP), 0.0, 100.0, 0.01);
@@ -819,6 +1358,12 @@ obs_properties_t* blur_factory::get_properties2(blur_instance* data)
 				return false;
 			},
 			obs::source_tracker::filter_scenes);
+		/// Shared Mask
+		p = obs_properties_add_list(pr, ST_KEY_MASK_SHARED, D_TRANSLATE(ST_I18N_MASK_SHARED), OBS_COMBO_TYPE_EDITABLE, OBS_COMBO_FORMAT_STRING);
+		for (auto& name : ::streamfx::gfx::shared_masks::get()->names()) {
+			obs_property_list_add_string(p, name.c_str(), name.c_str());
+		}
+		p = obs_properties_add_bool(pr, ST_KEY_MASK_SHARED_INVERT, D_TRANSLATE(ST_I18N_MASK_SHARED_INVERT));
 
 		/// Shared
 		p = obs_properties_add_color(pr, ST_KEY_MASK_COLOR, D_TRANSLATE(ST_I18N_MASK_COLOR));
@@ -826,6 +1371,17 @@ obs_properties_t* blur_factory::get_properties2(blur_instance* data)
 		p = obs_properties_add_float_slider(pr, ST_KEY_MASK_MULTIPLIER, D_TRANSLATE(ST_I18N_MASK_MULTIPLIER), 0.0, 10.0, 0.01);
 	}
 
+	{ // Temporal Reuse
+		p = obs_properties_add_bool(pr, ST_KEY_TEMPORAL, D_TRANSLATE(ST_I18N_TEMPORAL));
+		obs_property_set_modified_callback2(p, modified_properties, this);
+		p = obs_properties_add_int_slider(pr, ST_KEY_TEMPORAL_INTERVAL, D_TRANSLATE(ST_I18N_TEMPORAL_INTERVAL), 1, 120, 1);
+		p = obs_properties_add_float_slider(pr, ST_KEY_TEMPORAL_THRESHOLD, D_TRANSLATE(ST_I18N_TEMPORAL_THRESHOLD), 0.0, 100.0, 0.01);
+	}
+
+	{ // Caching
+		p = obs_properties_add_bool(pr, ST_KEY_STATIC, D_TRANSLATE(ST_I18N_STATIC));
+	}
+
 	return pr;
 }
 
@@ -5,19 +5,25 @@
 #pragma once
 #include "common.hpp"
 #include "gfx/blur/gfx-blur-base.hpp"
+#include "gfx/gfx-mipmapper.hpp"
+#include "gfx/gfx-qos.hpp"
+#include "gfx/gfx-shared-mask.hpp"
 #include "gfx/gfx-source-texture.hpp"
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
+#include "obs/gs/gs-texture-upload.hpp"
 #include "obs/obs-source-factory.hpp"
 
 #include "warning-disable.hpp"
 #include <chrono>
 #include <functional>
+#include <array>
 #include <list>
 #include <map>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::filter::blur {
@@ -25,18 +31,34 @@ namespace streamfx::filter::blur {
 		Region,
 		Image,
 		Source,
+		Shared,
 	};
 
-	class blur_instance : public obs::source_instance {
+	class blur_instance final : public obs::source_instance {
 		// Effects
 		streamfx::obs::gs::effect            _effect_mask;
+		streamfx::obs::gs::effect_loader     _effect_mask_loader;
 		std::shared_ptr<streamfx::gfx::util> _gfx_util;
+		std::shared_ptr<streamfx::gfx::qos>  _qos;
+
+		// Only used by variable blurs, created once needed.
+		std::shared_ptr<streamfx::gfx::mipmapper> _mipmapper;
 
 		// Input
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _source_rt;
 		std::shared_ptr<streamfx::obs::gs::texture>      _source_texture;
 		bool                                             _source_rendered;
 
+		// Region of Interest
+		std::shared_ptr<streamfx::obs::gs::rendertarget> _roi_rt;
+		struct {
+			bool     enabled;
+			uint32_t x;
+			uint32_t y;
+			uint32_t width;
+			uint32_t height;
+		} _roi;
+
 		// Rendering
 		std::shared_ptr<streamfx::obs::gs::texture>      _output_texture;
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _output_rt;
@@ -49,11 +71,13 @@ namespace streamfx::filter::blur {
 		std::pair<double_t, double_t>                _blur_center;
 		bool                                         _blur_step_scaling;
 		std::pair<double_t, double_t>                _blur_step_scale;
+		::streamfx::gfx::blur::precision             _blur_precision;
 
 		// Masking
 		struct {
 			bool      enabled;
 			mask_type type;
+			bool      variable; // The mask sets the size per pixel, instead of mixing a blur of one size.
 			struct {
 				float_t left;
 				float_t top;
@@ -64,9 +88,10 @@ namespace streamfx::filter::blur {
 				bool    invert;
 			} region;
 			struct {
-				std::string                                 path;
-				std::string                                 path_old;
-				std::shared_ptr<streamfx::obs::gs::texture> texture;
+				std::string                                        path;
+				std::string                                        path_old;
+				std::shared_ptr<streamfx::obs::gs::texture_upload> upload;
+				std::shared_ptr<streamfx::obs::gs::texture>        texture;
 			} image;
 			struct {
 				std::string                                    name_old;
@@ -75,6 +100,12 @@ namespace streamfx::filter::blur {
 				std::shared_ptr<streamfx::gfx::source_texture> source_texture;
 				std::shared_ptr<streamfx::obs::gs::texture>    texture;
 			} source;
+			struct {
+				std::string                                      name;
+				bool                                             invert;
+				std::shared_ptr<streamfx::gfx::shared_masks>     registry;
+				std::shared_ptr<streamfx::obs::gs::rendertarget> target; // Only valid during a render.
+			} shared;
 			struct {
 				float_t r;
 				float_t g;
@@ -84,6 +115,36 @@ namespace streamfx::filter::blur {
 			float_t multiplier;
 		} _mask;
 
+		// Caching
+		struct {
+			bool     is_static;  // The user promised that the source never changes.
+			bool     valid;      // The output still matches the source and settings.
+			uint32_t width;
+			uint32_t height;
+			int64_t  media_time; // Media can be seeked while paused.
+		} _cache;
+
+		// Temporal Reuse
+		struct {
+			bool                                                            enabled;
+			uint32_t                                                        interval;  // Blur at least every this many frames.
+			float_t                                                         threshold; // Average luminance difference that forces a blur.
+			bool                                                            dirty;     // Settings changed since the last blur.
+			bool                                                            changed;   // The source changed more than the threshold.
+			uint32_t                                                        frames;    // Frames since the last blur.
+			uint32_t                                                        width;
+			uint32_t                                                        height;
+			std::shared_ptr<streamfx::obs::gs::texture>                     blurred;
+			std::array<std::shared_ptr<streamfx::obs::gs::rendertarget>, 2> mix_rt;
+			std::size_t                                                     mix_index;
+			std::shared_ptr<streamfx::obs::gs::rendertarget>                previous; // What was shown before the last blur.
+			std::shared_ptr<streamfx::obs::gs::rendertarget>                probe_rt;
+			std::array<gs_stagesurf_t*, 2>                                  probe_stage;
+			std::array<bool, 2>                                             probe_staged;
+			std::size_t                                                     probe_index;
+			std::vector<float_t>                                            reference; // Luminance of the source at the last blur.
+		} _temporal;
+
 		public:
 		blur_instance(obs_data_t* settings, obs_source_t* self);
 		~blur_instance();
@@ -94,10 +155,39 @@ namespace streamfx::filter::blur {
 		virtual void update(obs_data_t* settings) override;
 
 		virtual void video_tick(float_t time) override;
+		virtual gs_color_space video_get_color_space(size_t count, const gs_color_space* preferred_spaces) override;
+		virtual bool video_tick_skip_hidden() override;
 		virtual void video_render(gs_effect_t* effect) override;
+		virtual void prepare() override;
 
 		private:
 		bool apply_mask_parameters(streamfx::obs::gs::effect effect, gs_texture_t* original_texture, gs_texture_t* blurred_texture);
+
+		bool is_source_static(obs_source_t* parent, obs_source_t* target, int64_t& media_time);
+
+		void calculate_roi(uint32_t width, uint32_t height);
+
+		/** Can this blur be combined with other stacked blurs into a single one? */
+		bool is_mergeable();
+
+		/** Is the mask sampling a mip chain of the source instead? Only area blurs can be approximated this way. */
+		bool is_variable();
+
+		/** Is nothing but the blur itself reading the unblurred source, so that the blur may read it while it is drawn? */
+		bool is_fusable();
+
+		/** Blur the input, or what capture draws if it isn't empty. Returns nullptr if the blur can't capture. */
+		std::shared_ptr<streamfx::obs::gs::texture> render_blur(const ::streamfx::gfx::blur::base::capture_t& capture, uint32_t width, uint32_t height, gs_color_format format, bool is_static);
+
+		blur_instance* find_filter_above(obs_source_t* parent);
+
+		static blur_instance* from_filter(obs_source_t* filter);
+
+		void temporal_probe();
+
+		bool temporal_should_blur(uint32_t width, uint32_t height);
+
+		std::shared_ptr<streamfx::obs::gs::texture> temporal_mix(std::shared_ptr<streamfx::obs::gs::texture> blurred, bool fresh);
 	};
 
 	class blur_factory : public obs::source_factory<filter::blur::blur_factory, filter::blur::blur_instance> {
@@ -5,10 +5,15 @@
 #include "filter-color-grade.hpp"
 #include "strings.hpp"
 #include "gfx/gfx-util.hpp"
+#include "obs/gs/gs-handoff.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/obs-tools.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <stdexcept>
 #include "warning-enable.hpp"
 
@@ -83,6 +88,17 @@ extern "C" {
 #define ST_I18N_RENDERMODE_LUT_6BIT ST_I18N_RENDERMODE ".LUT.6Bit"
 #define ST_I18N_RENDERMODE_LUT_8BIT ST_I18N_RENDERMODE ".LUT.8Bit"
 #define ST_I18N_RENDERMODE_LUT_10BIT ST_I18N_RENDERMODE ".LUT.10Bit"
+// Static
+#define ST_KEY_STATIC "Filter.ColorGrade.Static"
+#define ST_I18N_STATIC ST_I18N ".Static"
+// Scopes
+#define ST_KEY_SCOPES "Filter.ColorGrade.Scopes"
+#define ST_I18N_SCOPES ST_I18N ".Scopes"
+// LUT File
+#define ST_KEY_LUT "Filter.ColorGrade.LUT"
+#define ST_I18N_LUT ST_I18N ".LUT"
+#define ST_KEY_LUT_FILE ST_KEY_LUT ".File"
+#define ST_I18N_LUT_FILE ST_I18N_LUT ".File"
 
 #define ST_RED "Red"
 #define ST_GREEN "Green"
@@ -108,52 +124,69 @@ using namespace streamfx::filter::color_grade;
 
 static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-StreamFX/wiki/Filter-Color-Grade";
 
-// TODO: Figure out a way to merge _lut_rt, _lut_texture, _rt_source, _rt_grad, _tex_source, _tex_grade, _source_updated and _grade_updated.
-// Seriously this is too much GPU space wasted on unused trash.
+render_cache::render_cache() : input_rt(), input(), input_fresh(false), lut_rt(), lut_file_rt(), lut(), lut_volume(), lut_depth(streamfx::gfx::lut::color_depth::Invalid), lut_fresh(false), merge_rt(), output_rt(), output(), output_fresh(false), width(0), height(0), media_time(0) {}
 
-color_grade_instance::~color_grade_instance() {}
+void render_cache::next_frame(bool is_static, uint32_t new_width, uint32_t new_height, int64_t new_media_time)
+{
+	bool unchanged = is_static && input && (width == new_width) && (height == new_height) && (media_time == new_media_time);
+
+	width      = new_width;
+	height     = new_height;
+	media_time = new_media_time;
+
+	if (!unchanged) {
+		input_fresh  = false;
+		output_fresh = false;
+	}
+}
 
-color_grade_instance::color_grade_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self), _effect(), _gfx_util(::streamfx::gfx::util::get()), _lift(), _gamma(), _gain(), _offset(), _tint_detection(), _tint_luma(), _tint_exponent(), _tint_low(), _tint_mid(), _tint_hig(), _correction(), _lut_enabled(true), _lut_depth(), _ccache_rt(), _ccache_texture(), _ccache_fresh(false), _lut_initialized(false), _lut_dirty(true), _lut_producer(), _lut_consumer(), _lut_rt(), _lut_texture(), _cache_rt(), _cache_texture(), _cache_fresh(false)
+void render_cache::invalidate_grade()
 {
-	{
-		auto gctx = streamfx::obs::gs::context();
+	lut_fresh    = false;
+	output_fresh = false;
+}
 
-		// Load the color grading effect.
-		{
-			auto file = streamfx::data_file_path("effects/color-grade.effect");
-			try {
-				_effect = streamfx::obs::gs::effect::create(file);
-			} catch (std::exception& ex) {
-				D_LOG_ERROR("Error loading '%s': %s", file.u8string().c_str(), ex.what());
-				throw;
-			}
-		}
+void render_cache::release_lut()
+{
+	lut_rt.reset();
+	lut_file_rt.reset();
+	merge_rt.clear();
+	lut.reset();
+	lut_volume.reset();
+	lut_fresh    = false;
+	output_fresh = false;
+}
 
-		// Initialize LUT work flow.
-		try {
-			_lut_producer    = std::make_shared<streamfx::gfx::lut::producer>();
-			_lut_consumer    = std::make_shared<streamfx::gfx::lut::consumer>();
-			_lut_initialized = true;
-		} catch (std::exception const& ex) {
-			D_LOG_WARNING("Failed to initialize LUT rendering, falling back to direct rendering.\n%s", ex.what());
-			_lut_initialized = false;
-		}
+color_grade_instance::~color_grade_instance() {}
 
-		// Allocate render target for rendering.
-		try {
-			allocate_rendertarget(GS_RGBA);
-		} catch (std::exception const& ex) {
-			D_LOG_ERROR("Failed to acquire render target for rendering: %s", ex.what());
-			throw;
-		}
-	}
+color_grade_instance::color_grade_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self), _effect(), _effect_variant(), _gfx_util(::streamfx::gfx::util::get()), _lift(), _gamma(), _gain(), _offset(), _tint_detection(), _tint_luma(), _tint_exponent(), _tint_low(), _tint_mid(), _tint_hig(), _correction(), _lut_enabled(true), _lut_depth(), _static(false), _lut_attempted(false), _lut_initialized(false), _lut_producer(), _lut_consumer(), _lut_job(), _lut_file_path(), _lut_file(), _lut_file_applied(false), _version(0), _merged(), _scopes_enabled(false), _scopes(std::make_shared<streamfx::gfx::color_scopes>()), _cache()
+{
+	// Nothing on the GPU is created until the first render, so that loading doesn't wait for the graphics thread.
+
+	// Scopes are read by whoever wants to display them, without any ties to the render thread.
+	proc_handler_add(obs_source_get_proc_handler(_self), "void get_scopes(out int frame, out ptr histogram, out ptr waveform)", get_scopes, this);
 
 	update(data);
 }
 
 void color_grade_instance::allocate_rendertarget(gs_color_format format)
 {
-	_cache_rt = std::make_unique<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+	_cache.output_rt = std::make_unique<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+}
+
+void color_grade_instance::initialize_lut()
+{
+	_lut_attempted = true;
+	try {
+		_lut_producer    = std::make_shared<streamfx::gfx::lut::producer>();
+		_lut_consumer    = std::make_shared<streamfx::gfx::lut::consumer>();
+		_lut_initialized = true;
+	} catch (std::exception const& ex) {
+		D_LOG_WARNING("Failed to initialize LUT rendering, falling back to direct rendering.\n%s", ex.what());
+		_lut_producer.reset();
+		_lut_consumer.reset();
+		_lut_initialized = false;
+	}
 }
 
 float_t fix_gamma_value(double_t v)
@@ -207,25 +240,114 @@ void color_grade_instance::update(obs_data_t* data)
 	_correction.z   = static_cast<float_t>(obs_data_get_double(data, ST_KEY_CORRECTION_(ST_LIGHTNESS)) / 100.0);
 	_correction.w   = static_cast<float_t>(obs_data_get_double(data, ST_KEY_CORRECTION_(ST_CONTRAST)) / 100.0);
 
+	if (std::filesystem::path file = obs_data_get_string(data, ST_KEY_LUT_FILE); file != _lut_file_path) {
+		_lut_file_path    = file;
+		_lut_file         = file.empty() ? nullptr : streamfx::gfx::lut::file::load(file);
+		_lut_file_applied = false;
+	}
+
 	{
 		int64_t v = obs_data_get_int(data, ST_KEY_RENDERMODE);
 
-		// LUT status depends on selected option.
-		_lut_enabled = v != 0; // 0 (Direct)
+		// LUT status depends on selected option, files can only be applied as a LUT.
+		_lut_enabled = (v != 0) || _lut_file; // 0 (Direct)
 
-		if (v == -1) {
+		if ((v == -1) || ((v == 0) && _lut_file)) {
 			_lut_depth = streamfx::gfx::lut::color_depth::_8;
 		} else if (v > 0) {
 			_lut_depth = static_cast<streamfx::gfx::lut::color_depth>(v);
 		}
 	}
 
-	if (_lut_enabled && _lut_initialized)
-		_lut_dirty = true;
+	_static         = obs_data_get_bool(data, ST_KEY_STATIC);
+	_scopes_enabled = obs_data_get_bool(data, ST_KEY_SCOPES);
+
+	// Direct rendering caches its output too, so it needs to know about changes as well.
+	_cache.invalidate_grade();
+
+	// Filters that merged this grade into their own LUT compare this to know when to rebuild it.
+	static std::atomic<uint64_t> next_version{0};
+	_version = ++next_version;
+}
+
+void color_grade_instance::select_effect_variant()
+{
+	std::list<std::string> defines;
+
+	// Stages which do not change anything with the current values.
+	if ((_lift.x == 0.f) && (_lift.y == 0.f) && (_lift.z == 0.f) && (_lift.w == 0.f)) {
+		defines.push_back("GRADE_SKIP_LIFT");
+	}
+	if ((_gamma.x == 1.f) && (_gamma.y == 1.f) && (_gamma.z == 1.f) && (_gamma.w == 1.f)) {
+		defines.push_back("GRADE_SKIP_GAMMA");
+	}
+	if ((_gain.x == 1.f) && (_gain.y == 1.f) && (_gain.z == 1.f) && (_gain.w == 1.f)) {
+		defines.push_back("GRADE_SKIP_GAIN");
+	}
+	if ((_offset.x == 0.f) && (_offset.y == 0.f) && (_offset.z == 0.f) && (_offset.w == 0.f)) {
+		defines.push_back("GRADE_SKIP_OFFSET");
+	}
+	if ((_tint_low.x == 1.f) && (_tint_low.y == 1.f) && (_tint_low.z == 1.f) && (_tint_mid.x == 1.f) && (_tint_mid.y == 1.f) && (_tint_mid.z == 1.f) && (_tint_hig.x == 1.f) && (_tint_hig.y == 1.f) && (_tint_hig.z == 1.f)) {
+		defines.push_back("GRADE_SKIP_TINT");
+	} else {
+		switch (_tint_detection) {
+		case detection_mode::HSV:
+			defines.push_back("GRADE_TINT_DETECTION_HSV");
+			break;
+		case detection_mode::HSL:
+			defines.push_back("GRADE_TINT_DETECTION_HSL");
+			break;
+		case detection_mode::YUV_SDR:
+			defines.push_back("GRADE_TINT_DETECTION_YUV_SDR");
+			break;
+		}
+		switch (_tint_luma) {
+		case luma_mode::Linear:
+			defines.push_back("GRADE_TINT_MODE_LINEAR");
+			break;
+		case luma_mode::Exp:
+			defines.push_back("GRADE_TINT_MODE_EXP");
+			break;
+		case luma_mode::Exp2:
+			defines.push_back("GRADE_TINT_MODE_EXP2");
+			break;
+		case luma_mode::Log:
+			defines.push_back("GRADE_TINT_MODE_LOG");
+			break;
+		case luma_mode::Log10:
+			defines.push_back("GRADE_TINT_MODE_LOG10");
+			break;
+		}
+	}
+	if ((_correction.x == 0.f) && (_correction.y == 1.f) && (_correction.z == 1.f)) {
+		defines.push_back("GRADE_SKIP_CORRECTION");
+	}
+	if (_correction.w == 1.f) {
+		defines.push_back("GRADE_SKIP_CONTRAST");
+	}
+
+	std::string variant;
+	for (auto& define : defines) {
+		variant += define + ";";
+	}
+	if (_effect && (variant == _effect_variant)) {
+		return;
+	}
+
+	// Variants are shared with every other instance using the same one.
+	auto file = streamfx::data_file_path("effects/color-grade.effect");
+	try {
+		_effect         = streamfx::obs::gs::effect::create_shared(file, defines);
+		_effect_variant = variant;
+	} catch (std::exception& ex) {
+		D_LOG_ERROR("Error loading variant '%s' of '%s': %s", variant.c_str(), file.u8string().c_str(), ex.what());
+	}
 }
 
 void color_grade_instance::prepare_effect()
 {
+	select_effect_variant();
+
 	if (auto p = _effect.get_parameter("pLift"); p) {
 		p.set_float4(_lift);
 	}
@@ -275,64 +397,205 @@ void color_grade_instance::prepare_effect()
 	}
 }
 
+std::shared_ptr<streamfx::obs::gs::texture> color_grade_instance::apply_to_lut(std::shared_ptr<streamfx::obs::gs::texture> lut, std::shared_ptr<streamfx::obs::gs::rendertarget>& grade_rt, std::shared_ptr<streamfx::obs::gs::rendertarget>& file_rt)
+{
+	std::shared_ptr<streamfx::obs::gs::texture> result;
+
+	// Check if we have a render target to work with and if it's the correct format.
+	if (!grade_rt || (lut->get_color_format() != grade_rt->get_color_format())) {
+		// Create a new render target with new format.
+		grade_rt = std::make_shared<streamfx::obs::gs::rendertarget>(lut->get_color_format(), GS_ZS_NONE);
+	}
+
+	// Prepare our color grade effect.
+	prepare_effect();
+
+	// Assign texture.
+	if (auto p = _effect.get_parameter("image"); p) {
+		p.set_texture(lut);
+	}
+
+	{ // Begin rendering.
+		auto op = grade_rt->render(lut->get_width(), lut->get_height());
+
+		// Set up graphics context.
+		gs_ortho(0, 1, 0, 1, 0, 1);
+		gs_blend_state_push();
+		gs_enable_blending(false);
+		gs_enable_color(true, true, true, true);
+		gs_enable_stencil_test(false);
+		gs_enable_stencil_write(false);
+
+		while (gs_effect_loop(_effect.get_object(), "Draw")) {
+			_gfx_util->draw_fullscreen_triangle();
+		}
+
+		gs_blend_state_pop();
+	}
+
+	grade_rt->get_texture(result);
+	if (!result) {
+		throw std::runtime_error("Failed to produce modified LUT texture.");
+	}
+
+	// Apply the LUT file on top of the grade, which keeps rendering at a single LUT fetch per pixel.
+	if (_lut_file && _lut_file->ready()) {
+		if (auto file_texture = _lut_file->get_texture(); file_texture) {
+			if (!file_rt || (file_rt->get_color_format() != result->get_color_format())) {
+				file_rt = std::make_shared<streamfx::obs::gs::rendertarget>(result->get_color_format(), GS_ZS_NONE);
+			}
+
+			{
+				auto op = file_rt->render(result->get_width(), result->get_height());
+
+				gs_ortho(0, 1, 0, 1, 0, 1);
+				gs_blend_state_push();
+				gs_enable_blending(false);
+				gs_enable_color(true, true, true, true);
+				gs_enable_stencil_test(false);
+				gs_enable_stencil_write(false);
+
+				auto effect = _lut_consumer->prepare(_lut_file->depth(), file_texture);
+				effect->get_parameter("image").set_texture(result);
+				while (gs_effect_loop(effect->get_object(), "Draw")) {
+					_gfx_util->draw_fullscreen_triangle();
+				}
+
+				gs_blend_state_pop();
+			}
+
+			file_rt->get_texture(result);
+			if (!result) {
+				throw std::runtime_error("Failed to apply LUT file.");
+			}
+		}
+		_lut_file_applied = true;
+	}
+
+	return result;
+}
+
 void color_grade_instance::rebuild_lut()
 {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 	streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_cache, "Rebuild LUT"};
 #endif
 
-	// Generate a fresh LUT texture.
-	auto lut_texture = _lut_producer->produce(_lut_depth);
+	// The combined LUT needs to be as precise as the most precise of the grades in it.
+	streamfx::gfx::lut::color_depth depth = _lut_depth;
+	for (auto& kv : _merged) {
+		depth = std::max(depth, kv.first->_lut_depth);
+	}
 
-	// Modify the LUT with our color grade.
-	if (lut_texture) {
-		// Check if we have a render target to work with and if it's the correct format.
-		if (!_lut_rt || (lut_texture->get_color_format() != _lut_rt->get_color_format())) {
-			// Create a new render target with new format.
-			_lut_rt = std::make_unique<streamfx::obs::gs::rendertarget>(lut_texture->get_color_format(), GS_ZS_NONE);
-		}
+	// Generate a fresh LUT texture.
+	auto lut_texture = _lut_producer->produce(depth);
+	if (!lut_texture) {
+		throw std::runtime_error("Failed to produce LUT texture.");
+	}
 
-		// Prepare our color grade effect.
-		prepare_effect();
+	// Modify the LUT with the merged grades, in the same order as the filters would have applied them, then our own.
+	_cache.merge_rt.resize(_merged.size() * 2);
+	for (std::size_t idx = 0; idx < _merged.size(); idx++) {
+		lut_texture = _merged[idx].first->apply_to_lut(lut_texture, _cache.merge_rt[idx * 2], _cache.merge_rt[idx * 2 + 1]);
+	}
+	_cache.lut       = apply_to_lut(lut_texture, _cache.lut_rt, _cache.lut_file_rt);
+	_cache.lut_depth = depth;
 
-		// Assign texture.
-		if (auto p = _effect.get_parameter("image"); p) {
-			p.set_texture(lut_texture);
-		}
+	// Convert to a volume texture in the background, the packed LUT is used until that is done.
+	_cache.lut_volume.reset();
+	_lut_consumer->stage(depth, _cache.lut);
 
-		{ // Begin rendering.
-			auto op = _lut_rt->render(lut_texture->get_width(), lut_texture->get_height());
+	_cache.lut_fresh = true;
+}
 
-			// Set up graphics context.
-			gs_ortho(0, 1, 0, 1, 0, 1);
-			gs_blend_state_push();
-			gs_enable_blending(false);
-			gs_enable_color(true, true, true, true);
-			gs_enable_stencil_test(false);
-			gs_enable_stencil_write(false);
+bool color_grade_instance::is_mergeable()
+{
+	// Only a grade baked into a LUT can be combined with another one.
+	return _lut_initialized && _lut_enabled && _effect;
+}
 
-			while (gs_effect_loop(_effect.get_object(), "Draw")) {
-				_gfx_util->draw_fullscreen_triangle();
+color_grade_instance* color_grade_instance::find_filter_above(obs_source_t* parent)
+{
+	struct {
+		obs_source_t* self;
+		obs_source_t* above;
+	} context = {_self, nullptr};
+
+	obs_source_enum_filters(
+		parent,
+		[](obs_source_t*, obs_source_t* child, void* param) {
+			auto ctx = reinterpret_cast<decltype(context)*>(param);
+			if (obs_filter_get_target(child) == ctx->self) {
+				ctx->above = child;
 			}
+		},
+		&context);
 
-			gs_blend_state_pop();
-		}
+	return from_filter(context.above);
+}
 
-		_lut_rt->get_texture(_lut_texture);
-		if (!_lut_texture) {
-			throw std::runtime_error("Failed to produce modified LUT texture.");
+std::pmr::vector<color_grade_instance*> color_grade_instance::find_merged_filters()
+{
+	std::pmr::vector<color_grade_instance*> merged(streamfx::gfx::frame_arena::get());
+	for (obs_source_t* below = obs_filter_get_target(_self); color_grade_instance* instance = from_filter(below); below = obs_filter_get_target(below)) {
+		if (!instance->is_mergeable()) {
+			break;
 		}
-	} else {
-		throw std::runtime_error("Failed to produce LUT texture.");
+		merged.insert(merged.begin(), instance);
 	}
+	return merged;
+}
 
-	_lut_dirty = false;
+color_grade_instance* color_grade_instance::from_filter(obs_source_t* filter)
+{
+	if (!filter || (obs_source_get_type(filter) != OBS_SOURCE_TYPE_FILTER) || !obs_source_enabled(filter)) {
+		return nullptr;
+	}
+	if (strcmp(obs_source_get_id(filter), S_PREFIX "filter-color-grade") != 0) {
+		return nullptr;
+	}
+	return reinterpret_cast<color_grade_instance*>(obs_obj_get_data(filter));
+}
+
+void color_grade_instance::get_scopes(void* ptr, calldata_t* data)
+{
+	auto self   = reinterpret_cast<color_grade_instance*>(ptr);
+	auto scopes = self->_scopes->get();
+	if (!scopes) {
+		calldata_set_int(data, "frame", 0);
+		return;
+	}
+
+	// Luma, red, green and blue histograms back to back, followed by the waveform.
+	std::vector<uint32_t> histogram;
+	histogram.reserve(streamfx::gfx::color_scopes::bins * 4);
+	histogram.insert(histogram.end(), scopes->luma.begin(), scopes->luma.end());
+	histogram.insert(histogram.end(), scopes->red.begin(), scopes->red.end());
+	histogram.insert(histogram.end(), scopes->green.begin(), scopes->green.end());
+	histogram.insert(histogram.end(), scopes->blue.begin(), scopes->blue.end());
+
+	calldata_set_int(data, "frame", static_cast<long long>(scopes->frame));
+	calldata_set_data(data, "histogram", histogram.data(), histogram.size() * sizeof(uint32_t));
+	calldata_set_data(data, "waveform", scopes->waveform.data(), scopes->waveform.size() * sizeof(uint32_t));
+}
+
+bool color_grade_instance::video_tick_skip_hidden()
+{
+	return true;
 }
 
 void color_grade_instance::video_tick(float)
 {
-	_ccache_fresh = false;
-	_cache_fresh  = false;
+	obs_source_t* parent = obs_filter_get_parent(_self);
+	obs_source_t* target = obs_filter_get_target(_self);
+
+	int64_t media_time = 0;
+	bool    is_static  = _static || ::streamfx::obs::tools::filter_input_is_static(parent, target, media_time);
+	if (_static) {
+		media_time = 0;
+	}
+
+	_cache.next_frame(is_static, target ? obs_source_get_base_width(target) : 0, target ? obs_source_get_base_height(target) : 0, media_time);
 }
 
 void color_grade_instance::video_render(gs_effect_t* shader)
@@ -355,85 +618,149 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 	streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_source, "Color Grading '%s'", obs_source_get_name(_self)};
 #endif
 
+	// The LUT work flow decides whether we can be merged, so it has to exist before anything else looks at us.
+	if (!_lut_attempted) {
+		initialize_lut();
+	}
+
+	// Nothing works without the grading effect, which also decides whether we can be merged.
+	select_effect_variant();
+	if (!_effect) {
+		obs_source_skip_video_filter(_self);
+		return;
+	}
+
+	// Stacked color grades combine into a single LUT, so only the top-most of them has to do any work.
+	if (is_mergeable()) {
+		if (auto above = find_filter_above(parent); above && above->is_mergeable()) {
+			// Anything baked before is outdated by the time this renders on its own again.
+			_cache.invalidate_grade();
+			obs_source_skip_video_filter(_self);
+			return;
+		}
+	}
+
 	// TODO: Optimize this once (https://github.com/obsproject/obs-studio/pull/4199) is merged.
 	// - We can skip the original capture and reduce the overall impact of this.
 
 	// 1. Capture the filter/source rendered above this.
-	if (!_ccache_fresh || !_ccache_texture) {
+	if (!_cache.input_fresh || !_cache.input) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_cache, "Cache '%s'", obs_source_get_name(target)};
 #endif
 		// If the input cache render target doesn't exist, create it.
-		if (!_ccache_rt) {
-			_ccache_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		if (!_cache.input_rt) {
+			_cache.input_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 		}
 
+		std::shared_ptr<streamfx::obs::gs::texture> handed;
 		{
-			auto op = _ccache_rt->render(width, height);
+			auto op = _cache.input_rt->render(width, height);
 			gs_ortho(0, static_cast<float_t>(width), 0, static_cast<float_t>(height), 0, 1);
 
 			// Blank out the input cache.
 			gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0., 0);
 
-			// Begin rendering the actual input source.
-			obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING);
+			// Begin rendering the actual input source, which lets a filter above hand over its output. A forced static
+			// input is kept across frames, which a handed over texture must not be.
+			{
+				std::unique_ptr<streamfx::obs::gs::handoff> handoff;
+				if (!_static) {
+					handoff = std::make_unique<streamfx::obs::gs::handoff>(target, width, height);
+				}
+				obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING);
+				if (handoff) {
+					handed = handoff->take();
+				}
+			}
 
-			// Enable all colors for rendering.
-			gs_enable_color(true, true, true, true);
+			if (!handed) {
+				// Enable all colors for rendering.
+				gs_enable_color(true, true, true, true);
 
-			// Prevent blending with existing content, even if it is cleared.
-			gs_blend_state_push();
-			gs_enable_blending(false);
-			gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+				// Prevent blending with existing content, even if it is cleared.
+				gs_blend_state_push();
+				gs_enable_blending(false);
+				gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
 
-			// Disable depth testing.
-			gs_enable_depth_test(false);
+				// Disable depth testing.
+				gs_enable_depth_test(false);
 
-			// Disable stencil testing.
-			gs_enable_stencil_test(false);
+				// Disable stencil testing.
+				gs_enable_stencil_test(false);
 
-			// Disable culling.
-			gs_set_cull_mode(GS_NEITHER);
+				// Disable culling.
+				gs_set_cull_mode(GS_NEITHER);
 
-			// End rendering the actual input source.
-			obs_source_process_filter_end(_self, obs_get_base_effect(OBS_EFFECT_DEFAULT), width, height);
+				// End rendering the actual input source.
+				obs_source_process_filter_end(_self, obs_get_base_effect(OBS_EFFECT_DEFAULT), width, height);
 
-			// Restore original blend mode.
-			gs_blend_state_pop();
+				// Restore original blend mode.
+				gs_blend_state_pop();
+			}
 		}
 
 		// Try and retrieve the input cache as a texture for later use.
-		_ccache_rt->get_texture(_ccache_texture);
-		if (!_ccache_texture) {
+		if (handed) {
+			_cache.input = handed;
+		} else {
+			_cache.input_rt->get_texture(_cache.input);
+		}
+		if (!_cache.input) {
 			throw std::runtime_error("Failed to cache original source.");
 		}
 
 		// Mark the input cache as valid.
-		_ccache_fresh = true;
+		_cache.input_fresh = true;
 	}
 
 	// 2. Apply one of the two rendering methods (LUT or Direct).
+	bool output_was_fresh = _cache.output_fresh;
 	if (_lut_initialized && _lut_enabled) { // Try to apply with the LUT based method.
 		try {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "LUT Rendering"};
 #endif
-			// If the LUT was changed, rebuild the LUT first.
-			if (_lut_dirty) {
+			// Merged grades may have been changed, added or removed since the LUT was built.
+			std::pmr::vector<std::pair<color_grade_instance*, uint64_t>> merged(streamfx::gfx::frame_arena::get());
+			for (auto instance : find_merged_filters()) {
+				merged.emplace_back(instance, instance->_version);
+			}
+			if (!std::equal(merged.begin(), merged.end(), _merged.begin(), _merged.end())) {
+				_merged.assign(merged.begin(), merged.end());
+				_cache.invalidate_grade();
+			}
+
+			// Files are loaded in the background, so they may show up at any time.
+			if (_lut_file && !_lut_file_applied && _lut_file->ready()) {
+				_cache.invalidate_grade();
+			}
+			for (auto& kv : _merged) {
+				if (kv.first->_lut_file && !kv.first->_lut_file_applied && kv.first->_lut_file->ready()) {
+					_cache.invalidate_grade();
+				}
+			}
+
+			// If the LUT was changed, rebuild the LUT first. Unless this is the first one, rebuilding can wait for a frame
+			// with time to spare, and the previous LUT is used until then.
+			if (!_cache.lut_fresh && (!_cache.lut || _lut_job.admit())) {
+				auto job = _lut_job.run();
 				rebuild_lut();
+				_cache.output_fresh = false;
+			}
 
-				// Mark the cache as invalid, since the LUT has been changed.
-				_cache_fresh = false;
+			if (!_cache.lut_volume) {
+				_cache.lut_volume = _lut_consumer->volume();
 			}
 
 			// Reallocate the rendertarget if necessary.
-			if (_cache_rt->get_color_format() != GS_RGBA) {
+			if (!_cache.output_rt || (_cache.output_rt->get_color_format() != GS_RGBA)) {
 				allocate_rendertarget(GS_RGBA);
 			}
 
-			if (!_cache_fresh) {
+			if (!_cache.output_fresh) {
 				{ // Render the source to the cache.
-					auto op = _cache_rt->render(width, height);
+					auto op = _cache.output_rt->render(width, height);
 					gs_ortho(0, 1., 0, 1., 0, 1);
 
 					// Blank out the input cache.
@@ -456,8 +783,8 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 					// Disable culling.
 					gs_set_cull_mode(GS_NEITHER);
 
-					auto effect = _lut_consumer->prepare(_lut_depth, _lut_texture);
-					effect->get_parameter("image").set_texture(_ccache_texture);
+					auto effect = _lut_consumer->prepare(_cache.lut_depth, _cache.lut_volume ? _cache.lut_volume : _cache.lut);
+					effect->get_parameter("image").set_texture(_cache.input);
 					while (gs_effect_loop(effect->get_object(), "Draw")) {
 						_gfx_util->draw_fullscreen_triangle();
 					}
@@ -467,30 +794,29 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 				}
 
 				// Try and retrieve the render cache as a texture.
-				_cache_rt->get_texture(_cache_texture);
+				_cache.output_rt->get_texture(_cache.output);
 
 				// Mark the render cache as valid.
-				_cache_fresh = true;
+				_cache.output_fresh = true;
 			}
 		} catch (std::exception const& ex) {
 			// If anything happened, revert to direct rendering.
-			_lut_rt.reset();
-			_lut_texture.reset();
+			_cache.release_lut();
 			_lut_enabled = false;
 			D_LOG_WARNING("Reverting to direct rendering due to error: %s", ex.what());
 		}
 	}
-	if ((!_lut_initialized || !_lut_enabled) && !_cache_fresh) {
+	if ((!_lut_initialized || !_lut_enabled) && !_cache.output_fresh) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Direct Rendering"};
 #endif
 		// Reallocate the rendertarget if necessary.
-		if (_cache_rt->get_color_format() != GS_RGBA) {
+		if (!_cache.output_rt || (_cache.output_rt->get_color_format() != GS_RGBA)) {
 			allocate_rendertarget(GS_RGBA);
 		}
 
 		{ // Render the source to the cache.
-			auto op = _cache_rt->render(width, height);
+			auto op = _cache.output_rt->render(width, height);
 			gs_ortho(0, 1, 0, 1, 0, 1);
 
 			prepare_effect();
@@ -516,7 +842,7 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 			gs_set_cull_mode(GS_NEITHER);
 
 			// Render the effect.
-			_effect.get_parameter("image").set_texture(_ccache_texture);
+			_effect.get_parameter("image").set_texture(_cache.input);
 			while (gs_effect_loop(_effect.get_object(), "Draw")) {
 				_gfx_util->draw_fullscreen_triangle();
 			}
@@ -526,15 +852,22 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 		}
 
 		// Try and retrieve the render cache as a texture.
-		_cache_rt->get_texture(_cache_texture);
+		_cache.output_rt->get_texture(_cache.output);
 
 		// Mark the render cache as valid.
-		_cache_fresh = true;
+		_cache.output_fresh = true;
 	}
-	if (!_cache_texture) {
+	if (!_cache.output) {
 		throw std::runtime_error("Failed to cache processed source.");
 	}
 
+	// Measure what we produced, which only costs a tiny copy as long as the output does not change.
+	if (_scopes_enabled) {
+		_scopes->update(output_was_fresh ? nullptr : _cache.output);
+	} else {
+		_scopes->release();
+	}
+
 	// 3. Render the output cache.
 	{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
@@ -545,14 +878,27 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 		gs_enable_color(true, true, true, true);
 		gs_set_cull_mode(GS_NEITHER);
 
+		// A StreamFX filter below may take the cache as it is, which saves drawing it here and capturing it there.
+		if ((shader == obs_get_base_effect(OBS_EFFECT_DEFAULT)) && streamfx::obs::gs::handoff::offer(_self, _cache.output)) {
+			return;
+		}
+
 		// Draw the render cache.
 		while (gs_effect_loop(shader, "Draw")) {
-			gs_effect_set_texture(gs_effect_get_param_by_name(shader, "image"), _cache_texture ? _cache_texture->get_object() : nullptr);
+			gs_effect_set_texture(gs_effect_get_param_by_name(shader, "image"), _cache.output ? _cache.output->get_object() : nullptr);
 			gs_draw_sprite(nullptr, 0, width, height);
 		}
 	}
 }
 
+void color_grade_instance::prepare()
+{
+	if (!_lut_attempted) {
+		initialize_lut();
+	}
+	select_effect_variant();
+}
+
 color_grade_factory::color_grade_factory()
 {
 	_info.id           = S_PREFIX "filter-color-grade";
@@ -607,6 +953,9 @@ void color_grade_factory::get_defaults2(obs_data_t* data)
 	obs_data_set_default_double(data, ST_KEY_CORRECTION_(ST_CONTRAST), 100.0);
 
 	obs_data_set_default_int(data, ST_KEY_RENDERMODE, -1);
+	obs_data_set_default_string(data, ST_KEY_LUT_FILE, "");
+	obs_data_set_default_bool(data, ST_KEY_STATIC, false);
+	obs_data_set_default_bool(data, ST_KEY_SCOPES, false);
 }
 
 obs_properties_t* color_grade_factory::get_properties2(color_grade_instance* data)
@@ -773,6 +1122,13 @@ obs_properties_t* color_grade_factory::get_properties2(color_grade_instance* dat
 		}
 	}
 
+	{
+		obs_properties_t* grp = obs_properties_create();
+		obs_properties_add_group(pr, ST_KEY_LUT, D_TRANSLATE(ST_I18N_LUT), OBS_GROUP_NORMAL, grp);
+
+		obs_properties_add_path(grp, ST_KEY_LUT_FILE, D_TRANSLATE(ST_I18N_LUT_FILE), OBS_PATH_FILE, "Cube LUT (*.cube);;* (*.*)", nullptr);
+	}
+
 	{
 		obs_properties_t* grp = obs_properties_create();
 		obs_properties_add_group(pr, S_ADVANCED, D_TRANSLATE(S_ADVANCED), OBS_GROUP_NORMAL, grp);
@@ -795,6 +1151,10 @@ obs_properties_t* color_grade_factory::get_properties2(color_grade_instance* dat
 
 		obs_properties_add_float_slider(grp, ST_KEY_TINT_EXPONENT, D_TRANSLATE(ST_I18N_TINT_EXPONENT), 0., 10., .01);
 
+		obs_properties_add_bool(grp, ST_KEY_STATIC, D_TRANSLATE(ST_I18N_STATIC));
+
+		obs_properties_add_bool(grp, ST_KEY_SCOPES, D_TRANSLATE(ST_I18N_SCOPES));
+
 		{
 			auto                            p     = obs_properties_add_list(grp, ST_KEY_RENDERMODE, D_TRANSLATE(ST_I18N_RENDERMODE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
 			std::pair<const char*, int64_t> els[] = {
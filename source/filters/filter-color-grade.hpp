@@ -3,8 +3,12 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "gfx/gfx-color-scopes.hpp"
+#include "gfx/gfx-frame-arena.hpp"
+#include "gfx/gfx-frame-budget.hpp"
 #include "gfx/gfx-mipmapper.hpp"
 #include "gfx/lut/gfx-lut-consumer.hpp"
+#include "gfx/lut/gfx-lut-file.hpp"
 #include "gfx/lut/gfx-lut-producer.hpp"
 #include "gfx/lut/gfx-lut.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
@@ -32,8 +36,49 @@ namespace streamfx::filter::color_grade {
 		Log10,
 	};
 
-	class color_grade_instance : public obs::source_instance {
+	/** Everything color grade keeps between frames, each stage is only redone once it or a stage before it is outdated. */
+	struct render_cache {
+		// Input, the source as rendered before this filter.
+		std::shared_ptr<streamfx::obs::gs::rendertarget> input_rt;
+		std::shared_ptr<streamfx::obs::gs::texture>      input;
+		bool                                             input_fresh;
+
+		// Grade, baked into a LUT.
+		std::shared_ptr<streamfx::obs::gs::rendertarget> lut_rt;
+		std::shared_ptr<streamfx::obs::gs::rendertarget> lut_file_rt;
+		std::shared_ptr<streamfx::obs::gs::texture>      lut;
+		std::shared_ptr<streamfx::obs::gs::texture>      lut_volume;
+		streamfx::gfx::lut::color_depth                  lut_depth;
+		bool                                             lut_fresh;
+
+		// Grades of merged filters below this one, two render targets each.
+		std::vector<std::shared_ptr<streamfx::obs::gs::rendertarget>> merge_rt;
+
+		// Output, the graded input.
+		std::shared_ptr<streamfx::obs::gs::rendertarget> output_rt;
+		std::shared_ptr<streamfx::obs::gs::texture>      output;
+		bool                                             output_fresh;
+
+		// Change Detection
+		uint32_t width;
+		uint32_t height;
+		int64_t  media_time;
+
+		render_cache();
+
+		/** A new frame started, the input is only kept if it is known to be unchanged. */
+		void next_frame(bool is_static, uint32_t width, uint32_t height, int64_t media_time);
+
+		/** The grade changed, so the LUT and everything rendered with it is outdated. */
+		void invalidate_grade();
+
+		/** Release the LUT, for when it can not be used anymore. */
+		void release_lut();
+	};
+
+	class color_grade_instance final : public obs::source_instance {
 		streamfx::obs::gs::effect            _effect;
+		std::string                          _effect_variant;
 		std::shared_ptr<streamfx::gfx::util> _gfx_util;
 
 		// User Configuration
@@ -50,24 +95,30 @@ namespace streamfx::filter::color_grade {
 		vec4                            _correction;
 		bool                            _lut_enabled;
 		streamfx::gfx::lut::color_depth _lut_depth;
+		bool                            _static;
 
-		// Capture Cache
-		std::shared_ptr<streamfx::obs::gs::rendertarget> _ccache_rt;
-		std::shared_ptr<streamfx::obs::gs::texture>      _ccache_texture;
-		bool                                             _ccache_fresh;
+		// LUT work flow, set up on the first render.
+		bool                                          _lut_attempted;
+		bool                                          _lut_initialized;
+		std::shared_ptr<streamfx::gfx::lut::producer> _lut_producer;
+		std::shared_ptr<streamfx::gfx::lut::consumer> _lut_consumer;
+		streamfx::gfx::frame_budget::job              _lut_job;
 
-		// LUT work flow
-		bool                                             _lut_initialized;
-		bool                                             _lut_dirty;
-		std::shared_ptr<streamfx::gfx::lut::producer>    _lut_producer;
-		std::shared_ptr<streamfx::gfx::lut::consumer>    _lut_consumer;
-		std::shared_ptr<streamfx::obs::gs::rendertarget> _lut_rt;
-		std::shared_ptr<streamfx::obs::gs::texture>      _lut_texture;
+		// LUT File
+		std::filesystem::path                     _lut_file_path;
+		std::shared_ptr<streamfx::gfx::lut::file> _lut_file;
+		bool                                      _lut_file_applied;
 
-		// Render Cache
-		std::shared_ptr<streamfx::obs::gs::rendertarget> _cache_rt;
-		std::shared_ptr<streamfx::obs::gs::texture>      _cache_texture;
-		bool                                             _cache_fresh;
+		// Merging
+		uint64_t                                                _version;
+		std::vector<std::pair<color_grade_instance*, uint64_t>> _merged;
+
+		// Scopes
+		bool                                         _scopes_enabled;
+		std::shared_ptr<streamfx::gfx::color_scopes> _scopes;
+
+		// Cache
+		render_cache _cache;
 
 		public:
 		color_grade_instance(obs_data_t* data, obs_source_t* self);
@@ -75,16 +126,40 @@ namespace streamfx::filter::color_grade {
 
 		void allocate_rendertarget(gs_color_format format);
 
+		void initialize_lut();
+
 		virtual void load(obs_data_t* data) override;
 		virtual void migrate(obs_data_t* data, uint64_t version) override;
 		virtual void update(obs_data_t* data) override;
 
+		/** Switch to the effect variant which only contains the stages and modes that are in use. */
+		void select_effect_variant();
+
 		void prepare_effect();
 
+		/** Apply this grade and LUT file to the given LUT, using the given render targets. */
+		std::shared_ptr<streamfx::obs::gs::texture> apply_to_lut(std::shared_ptr<streamfx::obs::gs::texture> lut, std::shared_ptr<streamfx::obs::gs::rendertarget>& grade_rt, std::shared_ptr<streamfx::obs::gs::rendertarget>& file_rt);
+
 		void rebuild_lut();
 
+		/** Proc handler 'get_scopes', see streamfx::gfx::color_scopes for the layout of the data. */
+		static void get_scopes(void* ptr, calldata_t* data);
+
+		/** Can this grade be baked into the LUT of another color grade filter stacked on top of it? */
+		bool is_mergeable();
+
+		color_grade_instance* find_filter_above(obs_source_t* parent);
+
+		/** All mergeable color grade filters directly below this one, the one closest to the source first. */
+		/** Grades merged into this one, in the order they apply. Only valid for the current frame. */
+		std::pmr::vector<color_grade_instance*> find_merged_filters();
+
+		static color_grade_instance* from_filter(obs_source_t* filter);
+
 		virtual void video_tick(float_t time) override;
+		virtual bool video_tick_skip_hidden() override;
 		virtual void video_render(gs_effect_t* effect) override;
+		virtual void prepare() override;
 	};
 
 	class color_grade_factory : public obs::source_factory<filter::color_grade::color_grade_factory, filter::color_grade::color_grade_instance> {
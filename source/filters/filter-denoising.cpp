@@ -6,6 +6,7 @@
 #include "obs/gs/gs-helper.hpp"
 #include "plugin.hpp"
 #include "util/util-logging.hpp"
+#include "util/utility.hpp"
 
 #include "warning-disable.hpp"
 #include <algorithm>
@@ -29,6 +30,8 @@
 #define ST_KEY_PROVIDER "Provider"
 #define ST_I18N_PROVIDER ST_I18N "." ST_KEY_PROVIDER
 #define ST_I18N_PROVIDER_NVIDIA_DENOISING ST_I18N_PROVIDER ".NVIDIA.Denoising"
+#define ST_KEY_INTERVAL "Interval"
+#define ST_I18N_INTERVAL ST_I18N "." ST_KEY_INTERVAL
 
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
 #define ST_KEY_NVIDIA_DENOISING "NVIDIA.Denoising"
@@ -74,31 +77,11 @@ std::string streamfx::filter::denoising::string(denoising_provider provider)
 denoising_instance::denoising_instance(obs_data_t* data, obs_source_t* self)
 	: obs::source_instance(data, self),
 
-	  _size(1, 1), _provider(denoising_provider::INVALID), _provider_ui(denoising_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(), _input(), _output()
+	  _size(1, 1), _provider(denoising_provider::INVALID), _provider_ui(denoising_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(), _input(), _output(), _dirty(true), _interval(1), _skipped(0), _chained(false)
 {
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 
-	{
-		::streamfx::obs::gs::context gctx;
-
-		// Create the render target for the input buffering.
-		_input = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
-		_input->render(1, 1); // Preallocate the RT on the driver and GPU.
-		_output = _input->get_texture();
-
-		// Load the required effect.
-		_standard_effect = std::make_shared<::streamfx::obs::gs::effect>(::streamfx::data_file_path("effects/standard.effect"));
-
-		// Create Samplers
-		_channel0_sampler = std::make_shared<::streamfx::obs::gs::sampler>();
-		_channel0_sampler->set_filter(gs_sample_filter::GS_FILTER_LINEAR);
-		_channel0_sampler->set_address_mode_u(GS_ADDRESS_CLAMP);
-		_channel0_sampler->set_address_mode_v(GS_ADDRESS_CLAMP);
-		_channel1_sampler = std::make_shared<::streamfx::obs::gs::sampler>();
-		_channel1_sampler->set_filter(gs_sample_filter::GS_FILTER_LINEAR);
-		_channel1_sampler->set_address_mode_u(GS_ADDRESS_CLAMP);
-		_channel1_sampler->set_address_mode_v(GS_ADDRESS_CLAMP);
-	}
+	// Graphics resources are created by allocate() on the first render, so that loading doesn't wait for the GPU.
 
 	if (data) {
 		load(data);
@@ -153,6 +136,8 @@ void denoising_instance::update(obs_data_t* data)
 		switch_provider(provider);
 	}
 
+	_interval = static_cast<uint32_t>(std::max<int64_t>(obs_data_get_int(data, ST_KEY_INTERVAL), 1));
+
 	if (_provider_ready) {
 		std::unique_lock<std::mutex> ul(_provider_lock);
 
@@ -191,6 +176,11 @@ uint32_t streamfx::filter::denoising::denoising_instance::get_height()
 	return std::max<uint32_t>(_size.second, 1);
 }
 
+bool denoising_instance::video_tick_skip_hidden()
+{
+	return true;
+}
+
 void denoising_instance::video_tick(float_t time)
 {
 	auto parent = obs_filter_get_parent(_self);
@@ -221,6 +211,26 @@ void denoising_instance::video_tick(float_t time)
 	_dirty = true;
 }
 
+void denoising_instance::allocate()
+{
+	// Load the required effect.
+	_standard_effect = std::make_shared<::streamfx::obs::gs::effect>(::streamfx::data_file_path("effects/standard.effect"));
+
+	// Create Samplers
+	_channel0_sampler = ::streamfx::obs::gs::sampler::get(GS_FILTER_LINEAR, GS_ADDRESS_CLAMP, GS_ADDRESS_CLAMP);
+	_channel1_sampler = ::streamfx::obs::gs::sampler::get(GS_FILTER_LINEAR, GS_ADDRESS_CLAMP, GS_ADDRESS_CLAMP);
+
+	// Create the render target for the input buffering last, as it marks everything as allocated.
+	_input = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+}
+
+void denoising_instance::prepare()
+{
+	if (!_input) {
+		allocate();
+	}
+}
+
 void denoising_instance::video_render(gs_effect_t* effect)
 {
 	auto parent = obs_filter_get_parent(_self);
@@ -247,6 +257,10 @@ void denoising_instance::video_render(gs_effect_t* effect)
 	::streamfx::obs::gs::debug_marker profiler0_0{::streamfx::obs::gs::debug_color_gray, "'%s' on '%s'", obs_source_get_name(_self), obs_source_get_name(parent)};
 #endif
 
+	if (!_input) {
+		allocate();
+	}
+
 	if (_dirty) { // Lock the provider from being changed.
 		std::unique_lock<std::mutex> ul(_provider_lock);
 
@@ -300,19 +314,37 @@ void denoising_instance::video_render(gs_effect_t* effect)
 			}
 		}
 
+		// The filter above may continue with the result in CUDA memory, in which case it never has to become a texture.
+		bool chained = false;
+#ifdef ENABLE_FILTER_DENOISING_NVIDIA
+		chained = (_provider == denoising_provider::NVIDIA_DENOISING) && ::streamfx::nvidia::vfx::handoff::requested(_self, _size.first, _size.second);
+#endif
+
+		// Between two processed frames, keep drawing the last result with the alpha of the current frame. The provider
+		// keeps its temporal state in the meantime, so the next processed frame continues where the last one left off.
+		bool reuse = (_interval > 1) && (_skipped + 1 < _interval) && (chained == _chained) && _output && (_output->get_width() == _size.first) && (_output->get_height() == _size.second);
+		if (reuse) {
+			_skipped++;
+		} else {
+			_skipped = 0;
+		}
+
 		try { // Process the captured input with the provider.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Process"};
 #endif
-			switch (_provider) {
+			if (!reuse) {
+				_chained = chained;
+				switch (_provider) {
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
-			case denoising_provider::NVIDIA_DENOISING:
-				nvvfx_denoising_process();
-				break;
+				case denoising_provider::NVIDIA_DENOISING:
+					nvvfx_denoising_process();
+					break;
 #endif
-			default:
-				_output.reset();
-				break;
+				default:
+					_output.reset();
+					break;
+				}
 			}
 		} catch (...) {
 			obs_source_skip_video_filter(_self);
@@ -334,6 +366,11 @@ void denoising_instance::video_render(gs_effect_t* effect)
 	{ // Draw the result for the next filter to use.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_render, "Render"};
+#endif
+#ifdef ENABLE_FILTER_DENOISING_NVIDIA
+		if (_chained && ::streamfx::nvidia::vfx::handoff::offer(_self, _nvidia_image, _input->get_texture())) {
+			return;
+		}
 #endif
 		if (_standard_effect->has_parameter("InputA", ::streamfx::obs::gs::effect_parameter::type::Texture)) {
 			_standard_effect->get_parameter("InputA").set_texture(_output);
@@ -385,7 +422,7 @@ void streamfx::filter::denoising::denoising_instance::switch_provider(denoising_
 	_provider     = provider;
 
 	// Then spawn a new task to switch provider.
-	_provider_task = streamfx::threadpool()->push(std::bind(&denoising_instance::task_switch_provider, this, std::placeholders::_1), spd);
+	_provider_task = streamfx::threadpool()->push(std::bind(&denoising_instance::task_switch_provider, this, std::placeholders::_1), spd, ::streamfx::util::threadpool::priority::BACKGROUND);
 }
 
 void streamfx::filter::denoising::denoising_instance::task_switch_provider(util::threadpool::task_data_t data)
@@ -415,6 +452,11 @@ void streamfx::filter::denoising::denoising_instance::task_switch_provider(util:
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
 		case denoising_provider::NVIDIA_DENOISING:
 			nvvfx_denoising_load();
+			{
+				auto data = obs_source_get_settings(_self);
+				nvvfx_denoising_update(data);
+				obs_data_release(data);
+			}
 			break;
 #endif
 		default:
@@ -434,11 +476,13 @@ void streamfx::filter::denoising::denoising_instance::task_switch_provider(util:
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
 void streamfx::filter::denoising::denoising_instance::nvvfx_denoising_load()
 {
-	_nvidia_fx = std::make_shared<::streamfx::nvidia::vfx::denoising>();
+	_nvidia_fx = ::streamfx::nvidia::warmup::get()->take<::streamfx::nvidia::vfx::denoising>();
 }
 
 void streamfx::filter::denoising::denoising_instance::nvvfx_denoising_unload()
 {
+	_nvidia_replacement.cancel();
+	_nvidia_image.reset();
 	_nvidia_fx.reset();
 }
 
@@ -448,17 +492,31 @@ void streamfx::filter::denoising::denoising_instance::nvvfx_denoising_size()
 		return;
 	}
 
+	// Swap in a replacement as soon as it is loaded, which starts over with a clean temporal state.
+	if (auto fx = _nvidia_replacement.take(); fx) {
+		_nvidia_fx = std::move(fx);
+		_nvidia_image.reset();
+	}
+
 	_nvidia_fx->size(_size);
 }
 
 void streamfx::filter::denoising::denoising_instance::nvvfx_denoising_process()
 {
 	if (!_nvidia_fx) {
-		_output = _input->get_texture();
+		_output  = _input->get_texture();
+		_chained = false;
 		return;
 	}
 
-	_output = _nvidia_fx->process(_input->get_texture());
+	if (_chained) {
+		// The capture still provides the alpha channel, which the effect doesn't keep.
+		_nvidia_image = _nvidia_fx->process_image(_input->get_texture());
+		_output       = _input->get_texture();
+	} else {
+		_nvidia_image.reset();
+		_output = _nvidia_fx->process(_input->get_texture());
+	}
 }
 
 void streamfx::filter::denoising::denoising_instance::nvvfx_denoising_properties(obs_properties_t* props)
@@ -478,7 +536,20 @@ void streamfx::filter::denoising::denoising_instance::nvvfx_denoising_update(obs
 	if (!_nvidia_fx)
 		return;
 
-	_nvidia_fx->set_strength(static_cast<float>(obs_data_get_int(data, ST_KEY_NVIDIA_DENOISING_STRENGTH) == 0 ? 0. : 1.));
+	float strength = static_cast<float>(obs_data_get_int(data, ST_KEY_NVIDIA_DENOISING_STRENGTH) == 0 ? 0. : 1.);
+	if (!_provider_ready) {
+		// Nothing uses it yet, so it may as well load on first use.
+		_nvidia_fx->set_strength(strength);
+	} else if (!::streamfx::util::math::is_close<float>(_nvidia_fx->strength(), strength, 0.01f)) {
+		// A different strength is a different model, keep using the current one until it is loaded.
+		auto size = _size;
+		_nvidia_replacement.request([strength, size](std::shared_ptr<::streamfx::nvidia::vfx::denoising> fx) {
+			fx->set_strength(strength);
+			fx->preload(size.first, size.second);
+		});
+	} else {
+		_nvidia_replacement.cancel();
+	}
 }
 
 #endif
@@ -494,25 +565,12 @@ denoising_factory::denoising_factory()
 
 	// 1. Try and load any configured providers.
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
-	try {
-		// Load CVImage and Video Effects SDK.
-		_nvcuda           = ::streamfx::nvidia::cuda::obs::get();
-		_nvcvi            = ::streamfx::nvidia::cv::cv::get();
-		_nvvfx            = ::streamfx::nvidia::vfx::vfx::get();
-		_nvidia_available = true;
-		any_available |= _nvidia_available;
-	} catch (const std::exception& ex) {
-		_nvidia_available = false;
-		_nvvfx.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA providers available due to error: %s", ex.what());
-	} catch (...) {
-		_nvidia_available = false;
-		_nvvfx.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA providers available with unknown error.", nullptr);
+	// Only look for the SDK here. It is loaded once a filter actually uses it, so that OBS doesn't pay for it on
+	// every start.
+	_nvidia_available = ::streamfx::nvidia::vfx::vfx::is_available();
+	any_available |= _nvidia_available;
+	if (!_nvidia_available) {
+		D_LOG_WARNING("Failed to make NVIDIA providers available, as the SDK is not installed.", nullptr);
 	}
 #endif
 
@@ -542,6 +600,7 @@ const char* denoising_factory::get_name()
 void denoising_factory::get_defaults2(obs_data_t* data)
 {
 	obs_data_set_default_int(data, ST_KEY_PROVIDER, static_cast<int64_t>(denoising_provider::AUTOMATIC));
+	obs_data_set_default_int(data, ST_KEY_INTERVAL, 1);
 
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
 	obs_data_set_default_double(data, ST_KEY_NVIDIA_DENOISING_STRENGTH, 1.);
@@ -585,6 +644,11 @@ obs_properties_t* denoising_factory::get_properties2(denoising_instance* data)
 			obs_property_list_add_int(p, D_TRANSLATE(S_STATE_AUTOMATIC), static_cast<int64_t>(denoising_provider::AUTOMATIC));
 			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_PROVIDER_NVIDIA_DENOISING), static_cast<int64_t>(denoising_provider::NVIDIA_DENOISING));
 		}
+
+		{
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_INTERVAL, D_TRANSLATE(ST_I18N_INTERVAL), 1, 8, 1);
+			obs_property_int_set_suffix(p, " frames");
+		}
 	}
 
 	return pr;
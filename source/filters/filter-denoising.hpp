@@ -18,6 +18,8 @@
 
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
 #include "nvidia/vfx/nvidia-vfx-denoising.hpp"
+#include "nvidia/vfx/nvidia-vfx-handoff.hpp"
+#include "nvidia/nvidia-warmup.hpp"
 #endif
 
 namespace streamfx::filter::denoising {
@@ -31,7 +33,7 @@ namespace streamfx::filter::denoising {
 
 	std::string string(denoising_provider provider);
 
-	class denoising_instance : public obs::source_instance {
+	class denoising_instance final : public obs::source_instance {
 		std::pair<uint32_t, uint32_t> _size;
 
 		denoising_provider                      _provider;
@@ -47,9 +49,14 @@ namespace streamfx::filter::denoising {
 		std::shared_ptr<::streamfx::obs::gs::rendertarget> _input;
 		std::shared_ptr<::streamfx::obs::gs::texture>      _output;
 		bool                                               _dirty;
+		uint32_t                                           _interval;
+		uint32_t                                           _skipped;
+		bool                                               _chained; // Result was only handed over in CUDA memory.
 
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
-		std::shared_ptr<::streamfx::nvidia::vfx::denoising> _nvidia_fx;
+		std::shared_ptr<::streamfx::nvidia::vfx::denoising>                 _nvidia_fx;
+		std::shared_ptr<::streamfx::nvidia::cv::image>                      _nvidia_image;
+		::streamfx::nvidia::replacement<::streamfx::nvidia::vfx::denoising> _nvidia_replacement;
 #endif
 
 		public:
@@ -65,9 +72,13 @@ namespace streamfx::filter::denoising {
 		uint32_t get_height() override;
 
 		void video_tick(float_t time) override;
+		bool video_tick_skip_hidden() override;
 		void video_render(gs_effect_t* effect) override;
+		void prepare() override;
 
 		private:
+		void allocate();
+
 		void switch_provider(denoising_provider provider);
 		void task_switch_provider(util::threadpool::task_data_t data);
 
@@ -83,10 +94,7 @@ namespace streamfx::filter::denoising {
 
 	class denoising_factory : public obs::source_factory<::streamfx::filter::denoising::denoising_factory, ::streamfx::filter::denoising::denoising_instance> {
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
-		bool                                           _nvidia_available;
-		std::shared_ptr<::streamfx::nvidia::cuda::obs> _nvcuda;
-		std::shared_ptr<::streamfx::nvidia::cv::cv>    _nvcvi;
-		std::shared_ptr<::streamfx::nvidia::vfx::vfx>  _nvvfx;
+		bool _nvidia_available;
 #endif
 
 		public:
@@ -6,10 +6,12 @@
 #include "filter-dynamic-mask.hpp"
 #include "strings.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/obs-tools.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
 #include <array>
+#include <list>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
@@ -42,6 +44,8 @@
 
 #define ST_I18N_INPUT "Filter.DynamicMask.Input"
 #define ST_KEY_INPUT "Filter.DynamicMask.Input"
+#define ST_I18N_INPUT_SHARED "Filter.DynamicMask.Input.Shared"
+#define ST_KEY_INPUT_SHARED "Filter.DynamicMask.Input.Shared"
 #define ST_I18N_CHANNEL "Filter.DynamicMask.Channel"
 #define ST_KEY_CHANNEL "Filter.DynamicMask.Channel"
 #define ST_I18N_CHANNEL_VALUE "Filter.DynamicMask.Channel.Value"
@@ -66,18 +70,13 @@ static std::pair<channel, const char*> channel_translations[] = {
 	{channel::Alpha, S_CHANNEL_ALPHA},
 };
 
-data::data()
-{
-	auto gctx = streamfx::obs::gs::context();
-
-	_channel_mask_fx = streamfx::obs::gs::effect::create(streamfx::data_file_path("effects/channel-mask.effect"));
-}
+data::data() : _channel_mask_fx(streamfx::data_file_path("effects/channel-mask.effect")) {}
 
 data::~data() {}
 
 streamfx::obs::gs::effect data::channel_mask_fx()
 {
-	return _channel_mask_fx;
+	return _channel_mask_fx.get();
 }
 
 std::shared_ptr<streamfx::filter::dynamic_mask::data> data::get()
@@ -108,16 +107,22 @@ dynamic_mask_instance::dynamic_mask_instance(obs_data_t* settings, obs_source_t*
 	  _base_tex(), //
 	  _base_color_space(GS_CS_SRGB), //
 	  _base_color_format(GS_RGBA), //
+	  _shared_name(), //
+	  _shared_masks(streamfx::gfx::shared_masks::get()), //
+	  _shared_rt(), //
 	  _have_input(false), //
-	  _input_rt(), //
+	  _input_cache(streamfx::gfx::source_texture_cache::get()), //
 	  _input_tex(), //
 	  _input_color_space(GS_CS_SRGB), //
 	  _input_color_format(GS_RGBA), //
 	  _have_final(false), //
 	  _final_rt(), //
 	  _final_tex(), //
+	  _cache(), //
 	  _channels(), //
 	  _precalc(), //
+	  _effect(), //
+	  _effect_variant(), //
 	  _debug_texture(-1) //
 {
 	update(settings);
@@ -144,6 +149,7 @@ void dynamic_mask_instance::update(obs_data_t* settings)
 	} else {
 		release();
 	}
+	_shared_name = obs_data_get_string(settings, ST_KEY_INPUT_SHARED);
 
 	// Update data store
 	for (auto kv1 : channel_translations) {
@@ -191,6 +197,9 @@ void dynamic_mask_instance::update(obs_data_t* settings)
 	}
 
 	_debug_texture = obs_data_get_int(settings, ST_KEY_DEBUG_TEXTURE);
+
+	// Any of the above may change the mask.
+	_cache.valid = false;
 }
 
 void dynamic_mask_instance::save(obs_data_t* settings)
@@ -228,6 +237,11 @@ gs_color_space dynamic_mask_instance::video_get_color_space(size_t count, const
 	return _base_color_space;
 }
 
+bool dynamic_mask_instance::video_tick_skip_hidden()
+{
+	return true;
+}
+
 void dynamic_mask_instance::video_tick(float time)
 {
 	{ // Base Information
@@ -235,18 +249,7 @@ void dynamic_mask_instance::video_tick(float time)
 
 		std::array<gs_color_space, 1> preferred_formats = {GS_CS_SRGB};
 		_base_color_space                               = obs_source_get_color_space(obs_filter_get_target(_self), preferred_formats.size(), preferred_formats.data());
-		switch (_base_color_space) {
-		case GS_CS_SRGB:
-			_base_color_format = GS_RGBA;
-			break;
-		case GS_CS_SRGB_16F:
-		case GS_CS_709_EXTENDED:
-		case GS_CS_709_SCRGB:
-			_base_color_format = GS_RGBA16F;
-			break;
-		default:
-			_base_color_format = GS_RGBA_UNORM;
-		}
+		_base_color_format = ::streamfx::obs::tools::color_format(_base_color_space);
 
 		if ((obs_source_get_output_flags(obs_filter_get_target(_self)) & OBS_SOURCE_SRGB) == OBS_SOURCE_SRGB) {
 			_base_srgb = (_base_color_space <= GS_CS_SRGB_16F);
@@ -260,18 +263,7 @@ void dynamic_mask_instance::video_tick(float time)
 
 		std::array<gs_color_space, 1> preferred_formats = {GS_CS_SRGB};
 		_input_color_space                              = obs_source_get_color_space(input, preferred_formats.size(), preferred_formats.data());
-		switch (_input_color_space) {
-		case GS_CS_SRGB:
-			_input_color_format = GS_RGBA;
-			break;
-		case GS_CS_SRGB_16F:
-		case GS_CS_709_EXTENDED:
-		case GS_CS_709_SCRGB:
-			_input_color_format = GS_RGBA16F;
-			break;
-		default:
-			_input_color_format = GS_RGBA_UNORM;
-		}
+		_input_color_format = ::streamfx::obs::tools::color_format(_input_color_space);
 
 		if ((input.output_flags() & OBS_SOURCE_SRGB) == OBS_SOURCE_SRGB) {
 			_input_srgb = (_base_color_space <= GS_CS_SRGB_16F);
@@ -289,7 +281,6 @@ void dynamic_mask_instance::video_tick(float time)
 void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 {
 	gs_effect_t*  default_effect = obs_get_base_effect(obs_base_effect::OBS_EFFECT_DEFAULT);
-	auto          effect         = _data->channel_mask_fx();
 	obs_source_t* parent         = obs_filter_get_parent(_self);
 	obs_source_t* target         = obs_filter_get_target(_self);
 	uint32_t      width          = obs_source_get_base_width(target);
@@ -309,8 +300,31 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 		return;
 	}
 
+	// Static inputs give the same mask as last time, so there is nothing to capture or calculate. Shared masks are
+	// rendered by someone else every frame, and debugging wants to see the inputs as they are.
+	bool is_static = false;
+	if (!_have_final && _shared_name.empty() && (_debug_texture < 0)) {
+		int64_t  base_time    = 0;
+		int64_t  input_time   = 0;
+		uint32_t input_width  = input ? input.width() : width;
+		uint32_t input_height = input ? input.height() : height;
+		is_static             = ::streamfx::obs::tools::filter_input_is_static(parent, target, base_time) && (!input || ::streamfx::obs::tools::source_is_static(input, input_time));
+		if (is_static && _cache.valid && _final_tex && (_cache.width == width) && (_cache.height == height) && (_cache.input_width == input_width) && (_cache.input_height == input_height) && (_cache.format == _base_color_format) && (_cache.base_time == base_time) && (_cache.input_time == input_time)) {
+			_have_final = true;
+		} else {
+			_cache.valid        = false;
+			_cache.width        = width;
+			_cache.height       = height;
+			_cache.input_width  = input_width;
+			_cache.input_height = input_height;
+			_cache.format       = _base_color_format;
+			_cache.base_time    = base_time;
+			_cache.input_time   = input_time;
+		}
+	}
+
 	// Capture the base texture for later rendering.
-	if (!_have_base) {
+	if (!_have_base && !_have_final) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_cache, "Base Texture"};
 #endif
@@ -331,10 +345,7 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 					auto op = _base_rt->render(width, height, _base_color_space);
 
 					// Push a new blend state to stack.
-					gs_blend_state_push();
-					gs_reset_blend_state();
-					gs_enable_blending(false);
-					gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+					streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 					try {
 						// Enable all channels.
 						gs_enable_color(true, true, true, true);
@@ -388,7 +399,17 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 	}
 
 	// Capture the input texture for later rendering.
-	if (!_have_input) {
+	if (!_have_input && !_have_final && !_shared_name.empty()) {
+		// Shared masks are already rendered, so there is nothing to capture. Drawn as linear, like the publisher does.
+		if ((_shared_rt = _shared_masks->find(_shared_name)); _shared_rt) {
+			_input_tex          = _shared_rt->get_texture();
+			_input_color_format = _shared_rt->get_color_format();
+			_input_color_space  = GS_CS_SRGB;
+			_input_srgb         = false;
+			_have_input         = static_cast<bool>(_input_tex);
+		}
+	}
+	if (!_have_input && !_have_final) {
 		if (!input) {
 			// Treat no selection as selecting the target filter.
 			_have_input         = _have_base;
@@ -399,71 +420,15 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_source, "Input '%s'", input.name().data()};
 #endif
-			// Ensure the Render Target matches the expected format.
-			if (!_input_rt || (_input_rt->get_color_format() != _input_color_format)) {
-				_input_rt = std::make_shared<streamfx::obs::gs::rendertarget>(_input_color_format, GS_ZS_NONE);
-			}
-
-			auto previous_lsrgb = gs_get_linear_srgb();
-			gs_set_linear_srgb(_input_srgb);
-			bool previous_srgb = gs_framebuffer_srgb_enabled();
-			gs_enable_framebuffer_srgb(false);
-
+			// Other filters using the same source in the same way share one render of it.
 			try {
-				{
-					auto op = _input_rt->render(input.width(), input.height(), _input_color_space);
-
-					// Push a new blend state to stack.
-					gs_blend_state_push();
-					gs_reset_blend_state();
-					gs_enable_blending(false);
-					gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-					try {
-						// Enable all channels.
-						gs_enable_color(true, true, true, true);
-
-						// Disable culling.
-						gs_set_cull_mode(GS_NEITHER);
-
-						// Disable depth testing.
-						gs_enable_depth_test(false);
-						gs_depth_function(GS_ALWAYS);
-
-						// Disable stencil testing
-						gs_enable_stencil_test(false);
-						gs_enable_stencil_write(false);
-						gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-						gs_stencil_op(GS_STENCIL_BOTH, GS_KEEP, GS_KEEP, GS_KEEP);
-
-						// Set up rendering matrix.
-						gs_ortho(0, static_cast<float>(input.width()), 0, static_cast<float>(input.height()), -1., 1.);
-
-						{ // Clear to black.
-							vec4 clr = {0., 0., 0., 0.};
-							gs_clear(GS_CLEAR_COLOR, &clr, 0., 0);
-						}
-
-						// Render the source.
-						obs_source_video_render(input);
-
-						// Pop the old blend state.
-						gs_blend_state_pop();
-					} catch (...) {
-						gs_blend_state_pop();
-						throw;
-					}
-				}
-
-				_have_input = true;
-				_input_rt->get_texture(_input_tex);
+				_input_tex  = _input_cache->render(input, input.width(), input.height(), _input_color_space, _input_color_format, _input_srgb);
+				_have_input = static_cast<bool>(_input_tex);
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Failed to capture input texture: %s", ex.what());
 			} catch (...) {
 				DLOG_ERROR("Failed to capture input texture.", nullptr);
 			}
-
-			gs_enable_framebuffer_srgb(previous_srgb);
-			gs_set_linear_srgb(previous_lsrgb);
 		}
 	}
 
@@ -473,6 +438,14 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_render, "Final Calculation"};
 #endif
 
+		// The generic effect is only needed if the variant failed, and is loaded in the background then.
+		select_effect_variant();
+		auto effect = _effect ? _effect : _data->channel_mask_fx();
+		if (!effect) {
+			obs_source_skip_video_filter(_self);
+			return;
+		}
+
 		// Ensure the Render Target matches the expected format.
 		if (!_final_rt || (_final_rt->get_color_format() != _base_color_format)) {
 			_final_rt = std::make_shared<streamfx::obs::gs::rendertarget>(_base_color_format, GS_ZS_NONE);
@@ -488,10 +461,7 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 				auto op = _final_rt->render(width, height);
 
 				// Push a new blend state to stack.
-				gs_blend_state_push();
-				gs_reset_blend_state();
-				gs_enable_blending(false);
-				gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+				streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 				try {
 					// Enable all channels.
 					gs_enable_color(true, true, true, true);
@@ -536,8 +506,9 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 				}
 			}
 
-			_final_tex  = _final_rt->get_texture();
-			_have_final = true;
+			_final_tex   = _final_rt->get_texture();
+			_have_final  = true;
+			_cache.valid = is_static;
 		} catch (const std::exception& ex) {
 			DLOG_ERROR("Failed to render final texture: %s", ex.what());
 		} catch (...) {
@@ -607,6 +578,43 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 	}
 }
 
+void dynamic_mask_instance::select_effect_variant()
+{
+	// The matrix holds one row per output channel, with one column per input channel.
+	std::list<std::string> defines;
+
+	std::pair<channel, const char*> inputs[] = {
+		{channel::Red, "MASK_SKIP_RED"},
+		{channel::Green, "MASK_SKIP_GREEN"},
+		{channel::Blue, "MASK_SKIP_BLUE"},
+		{channel::Alpha, "MASK_SKIP_ALPHA"},
+	};
+	for (auto kv : inputs) {
+		auto idx = static_cast<size_t>(kv.first);
+		if ((_precalc.matrix.x.ptr[idx] == 0.f) && (_precalc.matrix.y.ptr[idx] == 0.f) && (_precalc.matrix.z.ptr[idx] == 0.f) && (_precalc.matrix.t.ptr[idx] == 0.f)) {
+			defines.push_back(kv.second);
+		}
+	}
+
+	std::string variant = ";";
+	for (auto& define : defines) {
+		variant += define + ";";
+	}
+	if (variant == _effect_variant) {
+		return;
+	}
+	_effect_variant = variant;
+
+	// Variants are shared with every other instance using the same one.
+	auto file = streamfx::data_file_path("effects/channel-mask.effect");
+	try {
+		_effect = streamfx::obs::gs::effect::create_shared(file, defines);
+	} catch (std::exception& ex) {
+		_effect.reset();
+		DLOG_ERROR("Error loading variant '%s' of '%s': %s", variant.c_str(), file.u8string().c_str(), ex.what());
+	}
+}
+
 void dynamic_mask_instance::enum_active_sources(obs_source_enum_proc_t enum_callback, void* param)
 {
 	if (_input)
@@ -711,6 +719,7 @@ void dynamic_mask_factory::get_defaults2(obs_data_t* data)
 			obs_data_set_default_double(data, (std::string(ST_KEY_CHANNEL_INPUT) + "." + kv.second + "." + kv2.second).c_str(), 0.0);
 		}
 	}
+	obs_data_set_default_string(data, ST_KEY_INPUT_SHARED, "");
 	obs_data_set_default_int(data, ST_KEY_DEBUG_TEXTURE, -1);
 }
 
@@ -746,6 +755,12 @@ obs_properties_t* dynamic_mask_factory::get_properties2(dynamic_mask_instance* d
 				return false;
 			},
 			obs::source_tracker::filter_scenes);
+
+		p = obs_properties_add_list(props, ST_KEY_INPUT_SHARED, D_TRANSLATE(ST_I18N_INPUT_SHARED), OBS_COMBO_TYPE_EDITABLE, OBS_COMBO_FORMAT_STRING);
+		obs_property_set_long_description(p, D_TRANSLATE(ST_I18N_INPUT_SHARED ".Description"));
+		for (auto& name : streamfx::gfx::shared_masks::get()->names()) {
+			obs_property_list_add_string(p, name.c_str(), name.c_str());
+		}
 	}
 
 	const char* pri_chs[] = {S_CHANNEL_RED, S_CHANNEL_GREEN, S_CHANNEL_BLUE, S_CHANNEL_ALPHA};
@@ -4,6 +4,7 @@
 
 #pragma once
 #include "common.hpp"
+#include "gfx/gfx-shared-mask.hpp"
 #include "gfx/gfx-source-texture.hpp"
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-effect.hpp"
@@ -18,13 +19,14 @@
 #include "warning-disable.hpp"
 #include <list>
 #include <map>
+#include <string>
 #include "warning-enable.hpp"
 
 namespace streamfx::filter::dynamic_mask {
 	enum class channel : int8_t { Invalid = -1, Red, Green, Blue, Alpha };
 
 	class data {
-		streamfx::obs::gs::effect _channel_mask_fx;
+		streamfx::obs::gs::effect_loader _channel_mask_fx;
 
 		private:
 		data();
@@ -38,7 +40,7 @@ namespace streamfx::filter::dynamic_mask {
 		static std::shared_ptr<streamfx::filter::dynamic_mask::data> get();
 	};
 
-	class dynamic_mask_instance : public obs::source_instance {
+	class dynamic_mask_instance final : public obs::source_instance {
 		std::shared_ptr<streamfx::filter::dynamic_mask::data> _data;
 		std::shared_ptr<streamfx::gfx::util>                  _gfx_util;
 
@@ -57,18 +59,35 @@ namespace streamfx::filter::dynamic_mask {
 		gs_color_format                                  _base_color_format;
 		bool                                             _base_srgb;
 
-		bool                                             _have_input;
-		std::shared_ptr<streamfx::obs::gs::rendertarget> _input_rt;
-		std::shared_ptr<streamfx::obs::gs::texture>      _input_tex;
-		gs_color_space                                   _input_color_space;
-		gs_color_format                                  _input_color_format;
-		bool                                             _input_srgb;
+		// Shared mask published by another filter, used instead of the input source while it is available.
+		std::string                                      _shared_name;
+		std::shared_ptr<streamfx::gfx::shared_masks>     _shared_masks;
+		std::shared_ptr<streamfx::obs::gs::rendertarget> _shared_rt;
+
+		bool                                                 _have_input;
+		std::shared_ptr<streamfx::gfx::source_texture_cache> _input_cache;
+		std::shared_ptr<streamfx::obs::gs::texture>          _input_tex;
+		gs_color_space                                       _input_color_space;
+		gs_color_format                                      _input_color_format;
+		bool                                                 _input_srgb;
 
 		bool                                             _have_final;
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _final_rt;
 		std::shared_ptr<streamfx::obs::gs::texture>      _final_tex;
 		bool                                             _final_srgb;
 
+		// The mask of two static inputs stays the same until either of them or the settings change.
+		struct {
+			bool            valid; // _final_tex is the mask of the inputs below.
+			uint32_t        width;
+			uint32_t        height;
+			uint32_t        input_width;
+			uint32_t        input_height;
+			gs_color_format format;
+			int64_t         base_time; // Media time of either, as given by filter_input_is_static().
+			int64_t         input_time;
+		} _cache;
+
 		int64_t _debug_texture;
 
 		struct channel_data {
@@ -84,6 +103,9 @@ namespace streamfx::filter::dynamic_mask {
 			matrix4 matrix;
 		} _precalc;
 
+		streamfx::obs::gs::effect _effect;
+		std::string               _effect_variant;
+
 		public:
 		dynamic_mask_instance(obs_data_t* data, obs_source_t* self);
 		virtual ~dynamic_mask_instance();
@@ -95,6 +117,7 @@ namespace streamfx::filter::dynamic_mask {
 
 		virtual gs_color_space video_get_color_space(size_t count, const gs_color_space* preferred_spaces) override;
 		virtual void           video_tick(float_t time) override;
+		virtual bool           video_tick_skip_hidden() override;
 		virtual void           video_render(gs_effect_t* effect) override;
 
 		void enum_active_sources(obs_source_enum_proc_t enum_callback, void* param) override;
@@ -107,6 +130,10 @@ namespace streamfx::filter::dynamic_mask {
 
 		bool acquire(std::string_view name);
 		void release();
+
+		private:
+		/** Select the variant of the channel mask effect which leaves out unused input channels. Graphics thread only. */
+		void select_effect_variant();
 	};
 
 	class dynamic_mask_factory : public obs::source_factory<filter::dynamic_mask::dynamic_mask_factory, filter::dynamic_mask::dynamic_mask_instance> {
@@ -5,9 +5,12 @@
 #include "filter-sdf-effects.hpp"
 #include "strings.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/obs-tools.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
 #include "warning-enable.hpp"
 
@@ -95,45 +98,28 @@
 
 #define ST_I18N_SDF_SCALE "Filter.SDFEffects.SDF.Scale"
 #define ST_KEY_SDF_SCALE "Filter.SDFEffects.SDF.Scale"
+#define ST_I18N_SDF_SCALE_AUTOMATIC "Filter.SDFEffects.SDF.Scale.Automatic"
+#define ST_KEY_SDF_SCALE_AUTOMATIC "Filter.SDFEffects.SDF.Scale.Automatic"
+#define ST_I18N_SDF_PRECISION "Filter.SDFEffects.SDF.Precision"
+#define ST_KEY_SDF_PRECISION "Filter.SDFEffects.SDF.Precision"
+#define ST_I18N_SDF_PRECISION_FULL "Filter.SDFEffects.SDF.Precision.Full"
+#define ST_I18N_SDF_PRECISION_HALF "Filter.SDFEffects.SDF.Precision.Half"
 #define ST_I18N_SDF_THRESHOLD "Filter.SDFEffects.SDF.Threshold"
 #define ST_KEY_SDF_THRESHOLD "Filter.SDFEffects.SDF.Threshold"
+#define ST_I18N_SDF_MODE "Filter.SDFEffects.SDF.Mode"
+#define ST_KEY_SDF_MODE "Filter.SDFEffects.SDF.Mode"
+#define ST_I18N_SDF_MODE_ITERATIVE "Filter.SDFEffects.SDF.Mode.Iterative"
+#define ST_I18N_SDF_MODE_JUMPFLOOD "Filter.SDFEffects.SDF.Mode.JumpFlood"
+#define ST_I18N_SDF_STATIC "Filter.SDFEffects.SDF.Static"
+#define ST_KEY_SDF_STATIC "Filter.SDFEffects.SDF.Static"
 
 using namespace streamfx::filter::sdf_effects;
 
 static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-StreamFX/wiki/Filter-SDF-Effects";
 
-sdf_effects_instance::sdf_effects_instance(obs_data_t* settings, obs_source_t* self) : obs::source_instance(settings, self), _gfx_util(::streamfx::gfx::util::get()), _source_rendered(false), _sdf_scale(1.0), _sdf_threshold(), _output_rendered(false), _inner_shadow(false), _inner_shadow_color(), _inner_shadow_range_min(), _inner_shadow_range_max(), _inner_shadow_offset_x(), _inner_shadow_offset_y(), _outer_shadow(false), _outer_shadow_color(), _outer_shadow_range_min(), _outer_shadow_range_max(), _outer_shadow_offset_x(), _outer_shadow_offset_y(), _inner_glow(false), _inner_glow_color(), _inner_glow_width(), _inner_glow_sharpness(), _inner_glow_sharpness_inv(), _outer_glow(false), _outer_glow_color(), _outer_glow_width(), _outer_glow_sharpness(), _outer_glow_sharpness_inv(), _outline(false), _outline_color(), _outline_width(), _outline_offset(), _outline_sharpness(), _outline_sharpness_inv()
+sdf_effects_instance::sdf_effects_instance(obs_data_t* settings, obs_source_t* self) : obs::source_instance(settings, self), _sdf_producer_loader(streamfx::data_file_path("effects/sdf/sdf-producer.effect")), _sdf_consumer_loader(streamfx::data_file_path("effects/sdf/sdf-consumer.effect")), _gfx_util(::streamfx::gfx::util::get()), _rendertarget_pool(::streamfx::gfx::rendertarget_pool::get()), _source_rendered(false), _sdf_scale(1.0), _sdf_threshold(), _sdf_jump_flood(true), _sdf_half(false), _sdf_static(false), _sdf_valid(false), _sdf_media_time(0), _output_rendered(false), _output_valid(false), _inner_shadow(false), _inner_shadow_color(), _inner_shadow_range_min(), _inner_shadow_range_max(), _inner_shadow_offset_x(), _inner_shadow_offset_y(), _outer_shadow(false), _outer_shadow_color(), _outer_shadow_range_min(), _outer_shadow_range_max(), _outer_shadow_offset_x(), _outer_shadow_offset_y(), _inner_glow(false), _inner_glow_color(), _inner_glow_width(), _inner_glow_sharpness(), _inner_glow_sharpness_inv(), _outer_glow(false), _outer_glow_color(), _outer_glow_width(), _outer_glow_sharpness(), _outer_glow_sharpness_inv(), _outline(false), _outline_color(), _outline_width(), _outline_offset(), _outline_sharpness(), _outline_sharpness_inv()
 {
-	{
-		auto gctx        = streamfx::obs::gs::context();
-		vec4 transparent = {0, 0, 0, 0};
-
-		_source_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-		_sdf_write = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA32F, GS_ZS_NONE);
-		_sdf_read  = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA32F, GS_ZS_NONE);
-		_output_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-
-		std::shared_ptr<streamfx::obs::gs::rendertarget> initialize_rts[] = {_source_rt, _sdf_write, _sdf_read, _output_rt};
-		for (auto rt : initialize_rts) {
-			auto op = rt->render(1, 1);
-			gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &transparent, 0, 0);
-		}
-
-		std::pair<const char*, streamfx::obs::gs::effect&> load_arr[] = {
-			{"effects/sdf/sdf-producer.effect", _sdf_producer_effect},
-			{"effects/sdf/sdf-consumer.effect", _sdf_consumer_effect},
-		};
-		for (auto& kv : load_arr) {
-			auto file = streamfx::data_file_path(kv.first);
-			try {
-				kv.second = streamfx::obs::gs::effect::create(file);
-			} catch (std::exception& ex) {
-				D_LOG_ERROR("Error loading '%s': %s", file.u8string().c_str(), ex.what());
-				throw;
-			}
-		}
-	}
-
+	// Render targets are created on the first render, so that loading doesn't wait for the graphics thread.
 	update(settings);
 }
 
@@ -270,8 +256,50 @@ void sdf_effects_instance::update(obs_data_t* data)
 		}
 	}
 
-	_sdf_scale     = double_t(obs_data_get_double(data, ST_KEY_SDF_SCALE) / 100.0);
-	_sdf_threshold = float_t(obs_data_get_double(data, ST_KEY_SDF_THRESHOLD) / 100.0);
+	_sdf_scale      = double_t(obs_data_get_double(data, ST_KEY_SDF_SCALE) / 100.0);
+	_sdf_threshold  = float_t(obs_data_get_double(data, ST_KEY_SDF_THRESHOLD) / 100.0);
+	_sdf_jump_flood = obs_data_get_int(data, ST_KEY_SDF_MODE) == 1;
+	_sdf_half       = obs_data_get_int(data, ST_KEY_SDF_PRECISION) == 1;
+
+	if (obs_data_get_bool(data, ST_KEY_SDF_SCALE_AUTOMATIC)) {
+		// The further the effects reach, the less the field needs to resolve, as long as that reach spans 8 texels.
+		float_t radius = 0.f;
+		if (_outer_shadow) {
+			radius = std::max({radius, std::abs(_outer_shadow_range_min), std::abs(_outer_shadow_range_max)});
+		}
+		if (_inner_shadow) {
+			radius = std::max({radius, std::abs(_inner_shadow_range_min), std::abs(_inner_shadow_range_max)});
+		}
+		if (_outer_glow) {
+			radius = std::max(radius, _outer_glow_width);
+		}
+		if (_inner_glow) {
+			radius = std::max(radius, _inner_glow_width);
+		}
+		if (_outline) {
+			radius = std::max(radius, _outline_width + std::abs(_outline_offset));
+		}
+		_sdf_scale = (radius > 0.f) ? std::clamp(8.0 / radius, 0.25, 1.0) : 1.0;
+	}
+	_sdf_static     = obs_data_get_bool(data, ST_KEY_SDF_STATIC);
+	_sdf_valid      = false;
+	_output_valid   = false;
+}
+
+bool sdf_effects_instance::video_tick_skip_hidden()
+{
+	return true;
+}
+
+void sdf_effects_instance::video_hidden()
+{
+	// The distance field is the largest thing we own, and is rebuilt by allocate_buffers() on the next render.
+	auto gctx = streamfx::obs::gs::context();
+	_sdf_texture.reset();
+	_sdf_field.reset();
+	_sdf_write.reset();
+	_sdf_read.reset();
+	_sdf_valid = false;
 }
 
 void sdf_effects_instance::video_tick(float_t)
@@ -296,6 +324,12 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 		return;
 	}
 
+	// Effects are only loaded once we are shown, and the source is shown unchanged until they are ready.
+	if (!_sdf_producer_effect && !(_sdf_producer_effect = _sdf_producer_loader.get())) {
+		obs_source_skip_video_filter(_self);
+		return;
+	}
+
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 	streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_source, "SDF Effects '%s' on '%s'", obs_source_get_name(_self), obs_source_get_name(obs_filter_get_parent(_self))};
 #endif
@@ -303,22 +337,31 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 	auto gctx              = streamfx::obs::gs::context();
 	vec4 color_transparent = {0, 0, 0, 0};
 
-	try {
-		gs_blend_state_push();
-		gs_reset_blend_state();
-		gs_enable_blending(false);
-		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+	if (!_source_rt) {
+		_source_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		_output_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	}
 
-		gs_set_cull_mode(GS_NEITHER);
-		gs_enable_color(true, true, true, true);
-		gs_enable_depth_test(false);
-		gs_depth_function(GS_ALWAYS);
-		gs_enable_stencil_test(false);
-		gs_enable_stencil_write(false);
-		gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-		gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	// A complete distance field stays valid for as long as the source does not change.
+	if (!_source_rendered && _sdf_jump_flood && _sdf_valid && _source_texture) {
+		int64_t media_time = 0;
+		bool    is_static  = _sdf_static || ::streamfx::obs::tools::filter_input_is_static(parent, target, media_time);
+		if (is_static && (_source_texture->get_width() == baseW) && (_source_texture->get_height() == baseH) && (_sdf_static || (_sdf_media_time == media_time))) {
+			_source_rendered = true;
+
+			// Neither the source nor the settings changed, so neither does the result.
+			if (_output_valid && _output_texture) {
+				_output_rendered = true;
+			}
+		}
+	}
+
+	try {
+		streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
 		if (!_source_rendered) {
+			_output_valid = false;
+
 			// Store input texture.
 			{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
@@ -342,15 +385,18 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 
 			// Generate SDF Buffers
 			{
-				_sdf_read->get_texture(_sdf_texture);
-				if (!_sdf_texture) {
-					throw std::runtime_error("SDF Backbuffer empty");
-				}
-
 				if (!_sdf_producer_effect) {
 					throw std::runtime_error("SDF Effect no loaded");
 				}
 
+				allocate_buffers();
+				if (!_sdf_jump_flood) {
+					_sdf_read->get_texture(_sdf_texture);
+					if (!_sdf_texture) {
+						throw std::runtime_error("SDF Backbuffer empty");
+					}
+				}
+
 				// Scale SDF Size
 				double_t sdfW, sdfH;
 				sdfW = baseW * _sdf_scale;
@@ -362,7 +408,13 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 					sdfH = 1.0;
 				}
 
-				{
+				// Distances are always measured in source pixels, no matter the scale of the field.
+				_sdf_producer_effect.get_parameter("_distance_scale").set_float(float_t(baseW) / float_t(uint32_t(sdfW)));
+
+				if (_sdf_jump_flood) {
+					jump_flood(uint32_t(sdfW), uint32_t(sdfH));
+					::streamfx::obs::tools::filter_input_is_static(parent, target, _sdf_media_time);
+				} else {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 					streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Update Distance Field"};
 #endif
@@ -380,8 +432,13 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 						_gfx_util->draw_fullscreen_triangle();
 					}
 				}
-				std::swap(_sdf_read, _sdf_write);
-				_sdf_read->get_texture(_sdf_texture);
+				if (_sdf_jump_flood) {
+					_sdf_field->get_texture(_sdf_texture);
+				} else {
+					std::swap(_sdf_read, _sdf_write);
+					_sdf_read->get_texture(_sdf_texture);
+					_sdf_valid = false;
+				}
 				if (!_sdf_texture) {
 					throw std::runtime_error("SDF Backbuffer empty");
 				}
@@ -400,7 +457,9 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 	if (!_output_rendered) {
 		_output_texture = _source_texture;
 
-		if (!_sdf_consumer_effect) {
+		// Only load the separate passes if there is no single pass variant to use instead.
+		select_stack_variant();
+		if (!_sdf_stack_effect && !_sdf_consumer_effect && !(_sdf_consumer_effect = _sdf_consumer_loader.get())) {
 			obs_source_skip_video_filter(_self);
 			return;
 		}
@@ -430,77 +489,114 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 
 			gs_enable_blending(false);
 			gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-			auto param = gs_effect_get_param_by_name(default_effect, "image");
-			if (param) {
-				gs_effect_set_texture(param, _output_texture->get_object());
-			}
-			while (gs_effect_loop(default_effect, "Draw")) {
-				_gfx_util->draw_fullscreen_triangle();
-			}
 
-			gs_enable_blending(true);
-			gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_ONE);
-			if (_outer_shadow) {
-				_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
-				_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
-				_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
-				_sdf_consumer_effect.get_parameter("pShadowColor").set_float4(_outer_shadow_color);
-				_sdf_consumer_effect.get_parameter("pShadowMin").set_float(_outer_shadow_range_min);
-				_sdf_consumer_effect.get_parameter("pShadowMax").set_float(_outer_shadow_range_max);
-				_sdf_consumer_effect.get_parameter("pShadowOffset").set_float2(_outer_shadow_offset_x / float_t(baseW), _outer_shadow_offset_y / float_t(baseH));
-				while (gs_effect_loop(_sdf_consumer_effect.get_object(), "ShadowOuter")) {
-					_gfx_util->draw_fullscreen_triangle();
+			// Single pass: The source and every enabled effect are combined in the shader, sampling each texture once.
+			if (_sdf_stack_effect) {
+				_sdf_stack_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
+				_sdf_stack_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
+				_sdf_stack_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
+				if (_outer_shadow) {
+					_sdf_stack_effect.get_parameter("pShadowOuterColor").set_float4(_outer_shadow_color);
+					_sdf_stack_effect.get_parameter("pShadowOuterParams").set_float4(_outer_shadow_range_min, _outer_shadow_range_max, _outer_shadow_offset_x / float_t(baseW), _outer_shadow_offset_y / float_t(baseH));
 				}
-			}
-			if (_inner_shadow) {
-				_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
-				_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
-				_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
-				_sdf_consumer_effect.get_parameter("pShadowColor").set_float4(_inner_shadow_color);
-				_sdf_consumer_effect.get_parameter("pShadowMin").set_float(_inner_shadow_range_min);
-				_sdf_consumer_effect.get_parameter("pShadowMax").set_float(_inner_shadow_range_max);
-				_sdf_consumer_effect.get_parameter("pShadowOffset").set_float2(_inner_shadow_offset_x / float_t(baseW), _inner_shadow_offset_y / float_t(baseH));
-				while (gs_effect_loop(_sdf_consumer_effect.get_object(), "ShadowInner")) {
-					_gfx_util->draw_fullscreen_triangle();
+				if (_inner_shadow) {
+					_sdf_stack_effect.get_parameter("pShadowInnerColor").set_float4(_inner_shadow_color);
+					_sdf_stack_effect.get_parameter("pShadowInnerParams").set_float4(_inner_shadow_range_min, _inner_shadow_range_max, _inner_shadow_offset_x / float_t(baseW), _inner_shadow_offset_y / float_t(baseH));
 				}
-			}
-			if (_outer_glow) {
-				_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
-				_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
-				_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
-				_sdf_consumer_effect.get_parameter("pGlowColor").set_float4(_outer_glow_color);
-				_sdf_consumer_effect.get_parameter("pGlowWidth").set_float(_outer_glow_width);
-				_sdf_consumer_effect.get_parameter("pGlowSharpness").set_float(_outer_glow_sharpness);
-				_sdf_consumer_effect.get_parameter("pGlowSharpnessInverse").set_float(_outer_glow_sharpness_inv);
-				while (gs_effect_loop(_sdf_consumer_effect.get_object(), "GlowOuter")) {
-					_gfx_util->draw_fullscreen_triangle();
+				if (_outer_glow) {
+					_sdf_stack_effect.get_parameter("pGlowOuterColor").set_float4(_outer_glow_color);
+					_sdf_stack_effect.get_parameter("pGlowOuterParams").set_float3(_outer_glow_width, _outer_glow_sharpness, _outer_glow_sharpness_inv);
 				}
-			}
-			if (_inner_glow) {
-				_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
-				_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
-				_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
-				_sdf_consumer_effect.get_parameter("pGlowColor").set_float4(_inner_glow_color);
-				_sdf_consumer_effect.get_parameter("pGlowWidth").set_float(_inner_glow_width);
-				_sdf_consumer_effect.get_parameter("pGlowSharpness").set_float(_inner_glow_sharpness);
-				_sdf_consumer_effect.get_parameter("pGlowSharpnessInverse").set_float(_inner_glow_sharpness_inv);
-				while (gs_effect_loop(_sdf_consumer_effect.get_object(), "GlowInner")) {
+				if (_inner_glow) {
+					_sdf_stack_effect.get_parameter("pGlowInnerColor").set_float4(_inner_glow_color);
+					_sdf_stack_effect.get_parameter("pGlowInnerParams").set_float3(_inner_glow_width, _inner_glow_sharpness, _inner_glow_sharpness_inv);
+				}
+				if (_outline) {
+					_sdf_stack_effect.get_parameter("pOutlineColor").set_float4(_outline_color);
+					_sdf_stack_effect.get_parameter("pOutlineWidth").set_float(_outline_width);
+					_sdf_stack_effect.get_parameter("pOutlineOffset").set_float(_outline_offset);
+					_sdf_stack_effect.get_parameter("pOutlineSharpness").set_float(_outline_sharpness);
+					_sdf_stack_effect.get_parameter("pOutlineSharpnessInverse").set_float(_outline_sharpness_inv);
+				}
+				while (gs_effect_loop(_sdf_stack_effect.get_object(), "Stack")) {
 					_gfx_util->draw_fullscreen_triangle();
 				}
-			}
-			if (_outline) {
-				_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
-				_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
-				_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
-				_sdf_consumer_effect.get_parameter("pOutlineColor").set_float4(_outline_color);
-				_sdf_consumer_effect.get_parameter("pOutlineWidth").set_float(_outline_width);
-				_sdf_consumer_effect.get_parameter("pOutlineOffset").set_float(_outline_offset);
-				_sdf_consumer_effect.get_parameter("pOutlineSharpness").set_float(_outline_sharpness);
-				_sdf_consumer_effect.get_parameter("pOutlineSharpnessInverse").set_float(_outline_sharpness_inv);
-				while (gs_effect_loop(_sdf_consumer_effect.get_object(), "Outline")) {
+			} else {
+				// Multi pass fallback: The source followed by one blended pass per enabled effect.
+				auto param = gs_effect_get_param_by_name(default_effect, "image");
+				if (param) {
+					gs_effect_set_texture(param, _output_texture->get_object());
+				}
+				while (gs_effect_loop(default_effect, "Draw")) {
 					_gfx_util->draw_fullscreen_triangle();
 				}
+
+				gs_enable_blending(true);
+				gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_ONE);
+				if (_outer_shadow) {
+					_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
+					_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
+					_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
+					_sdf_consumer_effect.get_parameter("pShadowColor").set_float4(_outer_shadow_color);
+					_sdf_consumer_effect.get_parameter("pShadowMin").set_float(_outer_shadow_range_min);
+					_sdf_consumer_effect.get_parameter("pShadowMax").set_float(_outer_shadow_range_max);
+					_sdf_consumer_effect.get_parameter("pShadowOffset").set_float2(_outer_shadow_offset_x / float_t(baseW), _outer_shadow_offset_y / float_t(baseH));
+					while (gs_effect_loop(_sdf_consumer_effect.get_object(), "ShadowOuter")) {
+						_gfx_util->draw_fullscreen_triangle();
+					}
+				}
+				if (_inner_shadow) {
+					_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
+					_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
+					_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
+					_sdf_consumer_effect.get_parameter("pShadowColor").set_float4(_inner_shadow_color);
+					_sdf_consumer_effect.get_parameter("pShadowMin").set_float(_inner_shadow_range_min);
+					_sdf_consumer_effect.get_parameter("pShadowMax").set_float(_inner_shadow_range_max);
+					_sdf_consumer_effect.get_parameter("pShadowOffset").set_float2(_inner_shadow_offset_x / float_t(baseW), _inner_shadow_offset_y / float_t(baseH));
+					while (gs_effect_loop(_sdf_consumer_effect.get_object(), "ShadowInner")) {
+						_gfx_util->draw_fullscreen_triangle();
+					}
+				}
+				if (_outer_glow) {
+					_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
+					_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
+					_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
+					_sdf_consumer_effect.get_parameter("pGlowColor").set_float4(_outer_glow_color);
+					_sdf_consumer_effect.get_parameter("pGlowWidth").set_float(_outer_glow_width);
+					_sdf_consumer_effect.get_parameter("pGlowSharpness").set_float(_outer_glow_sharpness);
+					_sdf_consumer_effect.get_parameter("pGlowSharpnessInverse").set_float(_outer_glow_sharpness_inv);
+					while (gs_effect_loop(_sdf_consumer_effect.get_object(), "GlowOuter")) {
+						_gfx_util->draw_fullscreen_triangle();
+					}
+				}
+				if (_inner_glow) {
+					_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
+					_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
+					_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
+					_sdf_consumer_effect.get_parameter("pGlowColor").set_float4(_inner_glow_color);
+					_sdf_consumer_effect.get_parameter("pGlowWidth").set_float(_inner_glow_width);
+					_sdf_consumer_effect.get_parameter("pGlowSharpness").set_float(_inner_glow_sharpness);
+					_sdf_consumer_effect.get_parameter("pGlowSharpnessInverse").set_float(_inner_glow_sharpness_inv);
+					while (gs_effect_loop(_sdf_consumer_effect.get_object(), "GlowInner")) {
+						_gfx_util->draw_fullscreen_triangle();
+					}
+				}
+				if (_outline) {
+					_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
+					_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
+					_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
+					_sdf_consumer_effect.get_parameter("pOutlineColor").set_float4(_outline_color);
+					_sdf_consumer_effect.get_parameter("pOutlineWidth").set_float(_outline_width);
+					_sdf_consumer_effect.get_parameter("pOutlineOffset").set_float(_outline_offset);
+					_sdf_consumer_effect.get_parameter("pOutlineSharpness").set_float(_outline_sharpness);
+					_sdf_consumer_effect.get_parameter("pOutlineSharpnessInverse").set_float(_outline_sharpness_inv);
+					while (gs_effect_loop(_sdf_consumer_effect.get_object(), "Outline")) {
+						_gfx_util->draw_fullscreen_triangle();
+					}
+				}
 			}
+
+			_output_valid = true;
 		} catch (...) {
 		}
 
@@ -530,6 +626,136 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 	}
 }
 
+void sdf_effects_instance::prepare()
+{
+	// Start loading the effects, and compile the variant now instead of on the first frame that shows us.
+	if (!_sdf_producer_effect) {
+		_sdf_producer_effect = _sdf_producer_loader.get();
+	}
+	select_stack_variant();
+	if (!_sdf_stack_effect && !_sdf_consumer_effect) {
+		_sdf_consumer_effect = _sdf_consumer_loader.get();
+	}
+
+	if (!_source_rt) {
+		_source_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		_output_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	}
+}
+
+void sdf_effects_instance::select_stack_variant()
+{
+	std::list<std::string> defines;
+	if (_outer_shadow) {
+		defines.push_back("STACK_SHADOW_OUTER");
+	}
+	if (_inner_shadow) {
+		defines.push_back("STACK_SHADOW_INNER");
+	}
+	if (_outer_glow) {
+		defines.push_back("STACK_GLOW_OUTER");
+	}
+	if (_inner_glow) {
+		defines.push_back("STACK_GLOW_INNER");
+	}
+	if (_outline) {
+		defines.push_back("STACK_OUTLINE");
+	}
+
+	// Remember the variant even if it failed, so that a broken compiler is only asked once per combination.
+	std::string variant = ";";
+	for (auto& define : defines) {
+		variant += define + ";";
+	}
+	if (variant == _sdf_stack_variant) {
+		return;
+	}
+	_sdf_stack_variant = variant;
+
+	// Variants are shared with every other instance using the same one.
+	auto file = streamfx::data_file_path("effects/sdf/sdf-consumer.effect");
+	try {
+		_sdf_stack_effect = streamfx::obs::gs::effect::create_shared(file, defines);
+	} catch (std::exception& ex) {
+		_sdf_stack_effect.reset();
+		D_LOG_WARNING("Error loading variant '%s' of '%s', falling back to multiple passes: %s", variant.c_str(), file.u8string().c_str(), ex.what());
+	}
+}
+
+void sdf_effects_instance::jump_flood(uint32_t width, uint32_t height)
+{
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Jump Flood Distance Field"};
+#endif
+
+	_sdf_producer_effect.get_parameter("_image").set_texture(_source_texture);
+	_sdf_producer_effect.get_parameter("_size").set_float2(float_t(width), float_t(height));
+	_sdf_producer_effect.get_parameter("_threshold").set_float(_sdf_threshold);
+
+	// Seeds are recreated from the source every time, so the ping-pong targets are only borrowed for the passes.
+	gs_color_format                                  format = _sdf_half ? GS_RGBA16F : GS_RGBA32F;
+	std::shared_ptr<streamfx::obs::gs::rendertarget> read   = _rendertarget_pool->acquire(format, width, height);
+	std::shared_ptr<streamfx::obs::gs::rendertarget> write  = _rendertarget_pool->acquire(format, width, height);
+
+	// There are a dozen or more passes, so look the techniques up once instead of for each of them.
+	auto jfa_seed    = _sdf_producer_effect.get_technique("JFASeed");
+	auto jfa_step    = _sdf_producer_effect.get_technique("JFAStep");
+	auto jfa_resolve = _sdf_producer_effect.get_technique("JFAResolve");
+
+	auto pass = [this, width, height, &read](streamfx::obs::gs::effect_technique& technique, std::shared_ptr<streamfx::obs::gs::rendertarget> target) {
+		auto op = target->render(width, height);
+		gs_ortho(0, 1, 0, 1, -1, 1);
+
+		_sdf_producer_effect.get_parameter("_sdf").set_texture(read->get_texture());
+		technique.draw([this]() { _gfx_util->draw_fullscreen_triangle(); });
+	};
+
+	// Start at the largest power of two below the size, so that every pixel can reach every other pixel.
+	uint32_t step = 1;
+	while ((step << 1) < std::max(width, height)) {
+		step <<= 1;
+	}
+
+	pass(jfa_seed, write);
+	std::swap(read, write);
+	for (; step > 0; step >>= 1) {
+		_sdf_producer_effect.get_parameter("_jfa_step").set_float2(float_t(step) / float_t(width), float_t(step) / float_t(height));
+		pass(jfa_step, write);
+		std::swap(read, write);
+	}
+	pass(jfa_resolve, _sdf_field);
+
+	_sdf_valid = true;
+}
+
+void sdf_effects_instance::allocate_buffers()
+{
+	// Only the distances are kept in the field, Jump Flooding borrows the targets for the nearest pixels it tracks.
+	gs_color_format field_format = _sdf_half ? GS_RG16F : GS_RGBA32F;
+
+	if (_sdf_jump_flood) {
+		_sdf_write.reset();
+		_sdf_read.reset();
+	} else if (!_sdf_write || (_sdf_write->get_color_format() != field_format)) {
+		vec4 transparent = {0, 0, 0, 0};
+
+		_sdf_write = std::make_shared<streamfx::obs::gs::rendertarget>(field_format, GS_ZS_NONE);
+		_sdf_read  = std::make_shared<streamfx::obs::gs::rendertarget>(field_format, GS_ZS_NONE);
+		for (auto rt : {_sdf_write, _sdf_read}) {
+			auto op = rt->render(1, 1);
+			gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &transparent, 0, 0);
+		}
+		_sdf_valid = false;
+	}
+
+	if (!_sdf_jump_flood) {
+		_sdf_field.reset();
+	} else if (!_sdf_field || (_sdf_field->get_color_format() != field_format)) {
+		_sdf_field = std::make_shared<streamfx::obs::gs::rendertarget>(field_format, GS_ZS_NONE);
+		_sdf_valid = false;
+	}
+}
+
 sdf_effects_factory::sdf_effects_factory()
 {
 	_info.id           = S_PREFIX "filter-sdf-effects";
@@ -586,7 +812,11 @@ void sdf_effects_factory::get_defaults2(obs_data_t* data)
 	obs_data_set_default_double(data, ST_KEY_OUTLINE_SHARPNESS, 50.0);
 
 	obs_data_set_default_double(data, ST_KEY_SDF_SCALE, 100.0);
+	obs_data_set_default_bool(data, ST_KEY_SDF_SCALE_AUTOMATIC, true);
+	obs_data_set_default_int(data, ST_KEY_SDF_PRECISION, 1);
 	obs_data_set_default_double(data, ST_KEY_SDF_THRESHOLD, 50.0);
+	obs_data_set_default_int(data, ST_KEY_SDF_MODE, 1);
+	obs_data_set_default_bool(data, ST_KEY_SDF_STATIC, false);
 }
 
 obs_properties_t* sdf_effects_factory::get_properties2(sdf_effects_instance* data)
@@ -662,8 +892,23 @@ obs_properties_t* sdf_effects_factory::get_properties2(sdf_effects_instance* dat
 		auto pr = obs_properties_create();
 		obs_properties_add_group(prs, S_ADVANCED, D_TRANSLATE(S_ADVANCED), OBS_GROUP_NORMAL, pr);
 
+		obs_properties_add_bool(pr, ST_KEY_SDF_SCALE_AUTOMATIC, D_TRANSLATE(ST_I18N_SDF_SCALE_AUTOMATIC));
 		obs_properties_add_float_slider(pr, ST_KEY_SDF_SCALE, D_TRANSLATE(ST_I18N_SDF_SCALE), 0.1, 500.0, 0.1);
+
+		{
+			auto p = obs_properties_add_list(pr, ST_KEY_SDF_PRECISION, D_TRANSLATE(ST_I18N_SDF_PRECISION), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_SDF_PRECISION_FULL), 0);
+			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_SDF_PRECISION_HALF), 1);
+		}
 		obs_properties_add_float_slider(pr, ST_KEY_SDF_THRESHOLD, D_TRANSLATE(ST_I18N_SDF_THRESHOLD), 0.0, 100.0, 0.01);
+
+		{
+			auto p = obs_properties_add_list(pr, ST_KEY_SDF_MODE, D_TRANSLATE(ST_I18N_SDF_MODE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_SDF_MODE_ITERATIVE), 0);
+			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_SDF_MODE_JUMPFLOOD), 1);
+		}
+
+		obs_properties_add_bool(pr, ST_KEY_SDF_STATIC, D_TRANSLATE(ST_I18N_SDF_STATIC));
 	}
 
 	return prs;
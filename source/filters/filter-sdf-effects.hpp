@@ -4,6 +4,7 @@
 
 #pragma once
 #include "common.hpp"
+#include "gfx/gfx-rendertarget-pool.hpp"
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
@@ -13,10 +14,15 @@
 #include "obs/obs-source-factory.hpp"
 
 namespace streamfx::filter::sdf_effects {
-	class sdf_effects_instance : public obs::source_instance {
-		streamfx::obs::gs::effect            _sdf_producer_effect;
-		streamfx::obs::gs::effect            _sdf_consumer_effect;
-		std::shared_ptr<streamfx::gfx::util> _gfx_util;
+	class sdf_effects_instance final : public obs::source_instance {
+		streamfx::obs::gs::effect                         _sdf_producer_effect;
+		streamfx::obs::gs::effect                         _sdf_consumer_effect;
+		streamfx::obs::gs::effect_loader                  _sdf_producer_loader;
+		streamfx::obs::gs::effect_loader                  _sdf_consumer_loader;
+		streamfx::obs::gs::effect                         _sdf_stack_effect;
+		std::string                                       _sdf_stack_variant;
+		std::shared_ptr<streamfx::gfx::util>              _gfx_util;
+		std::shared_ptr<streamfx::gfx::rendertarget_pool> _rendertarget_pool;
 
 		// Input
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _source_rt;
@@ -24,14 +30,21 @@ namespace streamfx::filter::sdf_effects {
 		bool                                             _source_rendered;
 
 		// Distance Field
-		std::shared_ptr<streamfx::obs::gs::rendertarget> _sdf_write;
-		std::shared_ptr<streamfx::obs::gs::rendertarget> _sdf_read;
+		std::shared_ptr<streamfx::obs::gs::rendertarget> _sdf_write; // Only kept without Jump Flooding.
+		std::shared_ptr<streamfx::obs::gs::rendertarget> _sdf_read;  // Only kept without Jump Flooding.
+		std::shared_ptr<streamfx::obs::gs::rendertarget> _sdf_field;
 		std::shared_ptr<streamfx::obs::gs::texture>      _sdf_texture;
 		double_t                                         _sdf_scale;
 		float_t                                          _sdf_threshold;
+		bool                                             _sdf_jump_flood;
+		bool                                             _sdf_half;
+		bool                                             _sdf_static;
+		bool                                             _sdf_valid;
+		int64_t                                          _sdf_media_time;
 
 		// Effects
 		bool                                             _output_rendered;
+		bool                                             _output_valid;
 		std::shared_ptr<streamfx::obs::gs::texture>      _output_texture;
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _output_rt;
 		/// Inner Shadow
@@ -77,7 +90,20 @@ namespace streamfx::filter::sdf_effects {
 		virtual void update(obs_data_t* settings) override;
 
 		virtual void video_tick(float_t) override;
+		virtual bool video_tick_skip_hidden() override;
+		virtual void video_hidden() override;
 		virtual void video_render(gs_effect_t*) override;
+		virtual void prepare() override;
+
+		private:
+		/** Build the full distance field from the source texture with the Jump Flooding Algorithm. */
+		void jump_flood(uint32_t width, uint32_t height);
+
+		/** (Re-)Create the distance field buffers if they do not match the selected mode and precision. */
+		void allocate_buffers();
+
+		/** Select the single pass variant of the consumer for the enabled effects, or none if it failed to compile. */
+		void select_stack_variant();
 	};
 
 	class sdf_effects_factory : public obs::source_factory<filter::sdf_effects::sdf_effects_factory, filter::sdf_effects::sdf_effects_instance> {
@@ -35,7 +35,6 @@ static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-Stre
 shader_instance::shader_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self)
 {
 	_fx = std::make_shared<streamfx::gfx::shader::shader>(self, streamfx::gfx::shader::shader_mode::Filter);
-	_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 
 	update(data);
 }
@@ -95,6 +94,10 @@ void shader_instance::video_render(gs_effect_t* effect)
 		streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_source, "Shader Filter '%s' on '%s'", obs_source_get_name(_self), obs_source_get_name(obs_filter_get_parent(_self))};
 #endif
 
+		if (!_rt) {
+			_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		}
+
 		{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_source, "Cache"};
@@ -139,6 +142,13 @@ void shader_instance::video_render(gs_effect_t* effect)
 	}
 }
 
+void shader_instance::prepare()
+{
+	if (!_rt) {
+		_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	}
+}
+
 void streamfx::filter::shader::shader_instance::show()
 {
 	_fx->set_visible(true);
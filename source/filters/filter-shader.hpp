@@ -10,7 +10,7 @@
 #include "obs/obs-source-factory.hpp"
 
 namespace streamfx::filter::shader {
-	class shader_instance : public obs::source_instance {
+	class shader_instance final : public obs::source_instance {
 		std::shared_ptr<streamfx::gfx::shader::shader>   _fx;
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _rt;
 
@@ -29,6 +29,7 @@ namespace streamfx::filter::shader {
 
 		virtual void video_tick(float_t sec_since_last) override;
 		virtual void video_render(gs_effect_t* effect) override;
+		virtual void prepare() override;
 
 		void show() override;
 		void hide() override;
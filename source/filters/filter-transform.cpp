@@ -76,6 +76,8 @@
 #define ST_KEY_CORNERS_BOTTOMRIGHT "Corners.BottomRight."
 #define ST_I18N_MIPMAPPING ST_I18N ".Mipmapping"
 #define ST_KEY_MIPMAPPING "Mipmapping"
+#define ST_I18N_STATIC ST_I18N ".Static"
+#define ST_KEY_STATIC "Static"
 
 using namespace streamfx::filter::transform;
 
@@ -93,37 +95,15 @@ enum RotationOrder : int64_t {
 	ZYX = 5,
 };
 
-transform_instance::transform_instance(obs_data_t* data, obs_source_t* context) : obs::source_instance(data, context), _gfx_util(::streamfx::gfx::util::get()), _camera_mode(), _camera_fov(), _params(), _corners(), _standard_effect(), _transform_effect(), _sampler(), _cache_rendered(), _mipmap_enabled(), _source_rendered(), _source_size(), _update_mesh(true)
+transform_instance::transform_instance(obs_data_t* data, obs_source_t* context) : obs::source_instance(data, context), _gfx_util(::streamfx::gfx::util::get()), _camera_mode(), _camera_fov(), _params(), _corners(), _standard_effect_loader(streamfx::data_file_path("effects/standard.effect")), _transform_effect_loader(streamfx::data_file_path("effects/transform.effect")), _standard_effect(), _transform_effect(), _sampler(), _cache_rendered(), _cache(), _mipmap_enabled(), _mipmapper(::streamfx::gfx::mipmapper::get()), _source_rendered(), _source_size(), _update_mesh(true), _direct_render(false), _direct_matrix()
 {
+	// Render targets, the mesh and the effects are all created once we are first shown.
 	{
-		auto gctx = obs::gs::context();
-
-		_cache_rt      = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-		_source_rt     = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-		_vertex_buffer = std::make_shared<streamfx::obs::gs::vertex_buffer>(uint32_t(4u), uint8_t(1u));
-		{
-			auto file = streamfx::data_file_path("effects/standard.effect");
-			try {
-				_standard_effect = streamfx::obs::gs::effect::create(file);
-			} catch (const std::exception& ex) {
-				DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
-			}
-		}
-		{
-			auto file = streamfx::data_file_path("effects/transform.effect");
-			try {
-				_transform_effect = streamfx::obs::gs::effect::create(file);
-			} catch (const std::exception& ex) {
-				DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
-			}
-		}
-		{
-			_sampler.set_address_mode_u(GS_ADDRESS_CLAMP);
-			_sampler.set_address_mode_v(GS_ADDRESS_CLAMP);
-			_sampler.set_address_mode_w(GS_ADDRESS_CLAMP);
-			_sampler.set_filter(GS_FILTER_LINEAR);
-			_sampler.set_max_anisotropy(8);
-		}
+		_sampler.set_address_mode_u(GS_ADDRESS_CLAMP);
+		_sampler.set_address_mode_v(GS_ADDRESS_CLAMP);
+		_sampler.set_address_mode_w(GS_ADDRESS_CLAMP);
+		_sampler.set_filter(GS_FILTER_LINEAR);
+		_sampler.set_max_anisotropy(8);
 
 		vec3_set(&_params.position, 0, 0, 0);
 		vec3_set(&_params.rotation, 0, 0, 0);
@@ -236,9 +216,47 @@ void transform_instance::update(obs_data_t* settings)
 	_mipmap_enabled = obs_data_get_bool(settings, ST_KEY_MIPMAPPING);
 	_sampler.set_filter(_mipmap_enabled ? GS_FILTER_ANISOTROPIC : GS_FILTER_LINEAR);
 
+	// Caching
+	_cache.is_static = obs_data_get_bool(settings, ST_KEY_STATIC);
+	_cache.valid     = false;
+
 	_update_mesh = true;
 }
 
+bool transform_instance::is_source_static(obs_source_t* parent, obs_source_t* target, int64_t& media_time)
+{
+	media_time = 0;
+
+	if (_cache.is_static) {
+		return true;
+	}
+
+	// Any filter in between may change its output at any time, so only trust the source itself.
+	if (target != parent) {
+		return false;
+	}
+
+	// Paused or stopped media only changes when seeked, which moves its time.
+	if (obs_source_get_output_flags(parent) & OBS_SOURCE_CONTROLLABLE_MEDIA) {
+		switch (obs_source_media_get_state(parent)) {
+		case OBS_MEDIA_STATE_PAUSED:
+		case OBS_MEDIA_STATE_STOPPED:
+		case OBS_MEDIA_STATE_ENDED:
+			media_time = obs_source_media_get_time(parent);
+			return true;
+		default:
+			break;
+		}
+	}
+
+	return false;
+}
+
+bool transform_instance::video_tick_skip_hidden()
+{
+	return true;
+}
+
 void transform_instance::video_tick(float)
 {
 	uint32_t width  = 0;
@@ -261,6 +279,11 @@ void transform_instance::video_tick(float)
 
 	// Update Mesh
 	if (_update_mesh) {
+		if (!_vertex_buffer) {
+			auto gctx      = streamfx::obs::gs::context();
+			_vertex_buffer = std::make_shared<streamfx::obs::gs::vertex_buffer>(uint32_t(4u), uint8_t(1u));
+		}
+
 		_source_size.first  = width;
 		_source_size.second = height;
 
@@ -321,37 +344,46 @@ void transform_instance::video_tick(float)
 
 			/// Generate mesh
 			{
-				auto vtx   = _vertex_buffer->at(0);
-				*vtx.color = 0xFFFFFFFF;
-				vec4_set(vtx.uv[0], 0, 0, 0, 0);
-				vec3_set(vtx.position, -p_x + _params.shear.x, -p_y - _params.shear.y, 0);
-				vec3_transform(vtx.position, vtx.position, &ident);
-			}
-			{
-				auto vtx   = _vertex_buffer->at(1);
-				*vtx.color = 0xFFFFFFFF;
-				vec4_set(vtx.uv[0], 1, 0, 0, 0);
-				vec3_set(vtx.position, p_x + _params.shear.x, -p_y + _params.shear.y, 0);
-				vec3_transform(vtx.position, vtx.position, &ident);
-			}
-			{
-				auto vtx   = _vertex_buffer->at(2);
-				*vtx.color = 0xFFFFFFFF;
-				vec4_set(vtx.uv[0], 0, 1, 0, 0);
-				vec3_set(vtx.position, -p_x - _params.shear.x, p_y - _params.shear.y, 0);
-				vec3_transform(vtx.position, vtx.position, &ident);
-			}
-			{
-				auto vtx   = _vertex_buffer->at(3);
-				*vtx.color = 0xFFFFFFFF;
-				vec4_set(vtx.uv[0], 1, 1, 0, 0);
-				vec3_set(vtx.position, p_x - _params.shear.x, p_y + _params.shear.y, 0);
-				vec3_transform(vtx.position, vtx.position, &ident);
+				vec3* positions = _vertex_buffer->get_positions();
+				vec4* uvs       = _vertex_buffer->get_uv_layer(0);
+				vec3_set(&positions[0], -p_x + _params.shear.x, -p_y - _params.shear.y, 0);
+				vec3_set(&positions[1], p_x + _params.shear.x, -p_y + _params.shear.y, 0);
+				vec3_set(&positions[2], -p_x - _params.shear.x, p_y - _params.shear.y, 0);
+				vec3_set(&positions[3], p_x - _params.shear.x, p_y + _params.shear.y, 0);
+				vec4_set(&uvs[0], 0, 0, 0, 0);
+				vec4_set(&uvs[1], 1, 0, 0, 0);
+				vec4_set(&uvs[2], 0, 1, 0, 0);
+				vec4_set(&uvs[3], 1, 1, 0, 0);
+				_vertex_buffer->fill_colors(0xFFFFFFFF);
+				_vertex_buffer->transform_positions(&ident);
 			}
 		} else if (_camera_mode == transform_mode::CORNER_PIN) {
 			// Corner Pin is rendered in Fragment.
 		}
 
+		// Without perspective, the mesh is an affine transformation of the source. If it also stays within the bounds
+		// of the source, the source can be drawn with it directly, which gives the same result without two passes.
+		_direct_render = false;
+		if ((_camera_mode == transform_mode::ORTHOGRAPHIC) && !_mipmap_enabled) {
+			vec2 corners[4];
+			for (std::size_t idx = 0; idx < 4; idx++) {
+				auto vtx = _vertex_buffer->at(static_cast<uint32_t>(idx));
+				vec2_set(&corners[idx], (vtx.position->x + 1.f) * .5f * float(width), (vtx.position->y + 1.f) * .5f * float(height));
+			}
+
+			_direct_render = true;
+			for (auto& corner : corners) {
+				if ((corner.x < -.5f) || (corner.y < -.5f) || (corner.x > (float(width) + .5f)) || (corner.y > (float(height) + .5f))) {
+					_direct_render = false;
+				}
+			}
+
+			matrix4_identity(&_direct_matrix);
+			vec4_set(&_direct_matrix.x, (corners[1].x - corners[0].x) / float(width), (corners[1].y - corners[0].y) / float(width), 0.f, 0.f);
+			vec4_set(&_direct_matrix.y, (corners[2].x - corners[0].x) / float(height), (corners[2].y - corners[0].y) / float(height), 0.f, 0.f);
+			vec4_set(&_direct_matrix.t, corners[0].x, corners[0].y, 0.f, 1.f);
+		}
+
 		_vertex_buffer->update(true);
 		_update_mesh = false;
 	}
@@ -371,15 +403,44 @@ void transform_instance::video_render(gs_effect_t* effect)
 	if (!effect)
 		effect = default_effect;
 
-	if (!base_width || !base_height || !parent || !target || !_standard_effect || !_transform_effect) { // Skip if something is wrong.
+	// Effects are loaded in the background, and the source is shown unchanged until they are ready.
+	if (!_standard_effect) {
+		_standard_effect = _standard_effect_loader.get();
+	}
+	if (!_transform_effect) {
+		_transform_effect = _transform_effect_loader.get();
+	}
+
+	if (!base_width || !base_height || !parent || !target || !_standard_effect || !_transform_effect || !_vertex_buffer) { // Skip if something is wrong.
 		obs_source_skip_video_filter(_self);
 		return;
 	}
 
+	if (!_cache_rt) {
+		_cache_rt  = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		_source_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	}
+
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 	streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_source, "3D Transform '%s' on '%s'", obs_source_get_name(_self), obs_source_get_name(obs_filter_get_parent(_self))};
 #endif
 
+	if (_direct_render && (base_width == _source_size.first) && (base_height == _source_size.second)) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_render, "Direct"};
+#endif
+
+		if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
+			gs_matrix_push();
+			gs_matrix_mul(&_direct_matrix);
+			obs_source_process_filter_end(_self, effect, base_width, base_height);
+			gs_matrix_pop();
+		} else {
+			obs_source_skip_video_filter(_self);
+		}
+		return;
+	}
+
 	uint32_t cache_width  = base_width;
 	uint32_t cache_height = base_height;
 
@@ -396,6 +457,14 @@ void transform_instance::video_render(gs_effect_t* effect)
 		}
 	}
 
+	// Static sources only need to be captured and mip-mapped again if their size changed.
+	int64_t media_time = 0;
+	bool    is_static  = is_source_static(parent, target, media_time);
+	if (!_cache_rendered && _cache.valid && is_static && (_cache.width == cache_width) && (_cache.height == cache_height) && (_cache.media_time == media_time) && _cache_texture && (!_mipmap_enabled || _mipmap_texture)) {
+		_cache_rendered  = true;
+		_mipmap_rendered = _mipmap_enabled;
+	}
+
 	if (!_cache_rendered) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_cache, "Cache"};
@@ -428,28 +497,23 @@ void transform_instance::video_render(gs_effect_t* effect)
 			return;
 		}
 
-		_cache_rendered = true;
+		_cache_rendered  = true;
+		_mipmap_rendered = false;
+		_cache.valid     = false;
+		_cache_rt->get_texture(_cache_texture);
 	}
-	_cache_rt->get_texture(_cache_texture);
 	if (!_cache_texture) {
 		obs_source_skip_video_filter(_self);
 		return;
 	}
 
-	if (_mipmap_enabled) {
+	if (_mipmap_enabled && !_mipmap_rendered) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Mipmap"};
 #endif
 
-		if (!_mipmap_texture || (_mipmap_texture->get_width() != cache_width) || (_mipmap_texture->get_height() != cache_height)) {
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-			streamfx::obs::gs::debug_marker gdr{streamfx::obs::gs::debug_color_allocate, "Allocate Mipmapped Texture"};
-#endif
-
-			std::size_t mip_levels = _mipmapper.calculate_max_mip_level(cache_width, cache_height);
-			_mipmap_texture        = std::make_shared<streamfx::obs::gs::texture>(cache_width, cache_height, GS_RGBA, static_cast<uint32_t>(mip_levels), nullptr, streamfx::obs::gs::texture::flags::None);
-		}
-		_mipmapper.rebuild(_cache_texture, _mipmap_texture);
+		// Only we ask for the mip-maps of our own cache, so the chain stays intact for as long as the cache does.
+		_mipmap_texture = _mipmapper->generate(_cache_texture);
 
 		_mipmap_rendered = true;
 		if (!_mipmap_texture) {
@@ -458,6 +522,11 @@ void transform_instance::video_render(gs_effect_t* effect)
 		}
 	}
 
+	_cache.valid      = is_static;
+	_cache.width      = cache_width;
+	_cache.height     = cache_height;
+	_cache.media_time = media_time;
+
 	{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Transform"};
@@ -548,6 +617,25 @@ void transform_instance::video_render(gs_effect_t* effect)
 	}
 }
 
+void transform_instance::prepare()
+{
+	if (!_standard_effect) {
+		_standard_effect = _standard_effect_loader.get();
+	}
+	if (!_transform_effect) {
+		_transform_effect = _transform_effect_loader.get();
+	}
+
+	if (!_vertex_buffer) {
+		_vertex_buffer = std::make_shared<streamfx::obs::gs::vertex_buffer>(uint32_t(4u), uint8_t(1u));
+		_update_mesh   = true;
+	}
+	if (!_cache_rt) {
+		_cache_rt  = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		_source_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	}
+}
+
 transform_factory::transform_factory()
 {
 	_info.id           = S_PREFIX "filter-transform";
@@ -590,6 +678,7 @@ void transform_factory::get_defaults2(obs_data_t* settings)
 	obs_data_set_default_double(settings, ST_KEY_CORNERS_BOTTOMRIGHT "X", 100.);
 	obs_data_set_default_double(settings, ST_KEY_CORNERS_BOTTOMRIGHT "Y", 100.);
 	obs_data_set_default_bool(settings, ST_KEY_MIPMAPPING, false);
+	obs_data_set_default_bool(settings, ST_KEY_STATIC, false);
 }
 
 static bool modified_camera_mode(obs_properties_t* pr, obs_property_t*, obs_data_t* d) noexcept
@@ -780,6 +869,10 @@ obs_properties_t* transform_factory::get_properties2(transform_instance* data)
 			auto p = obs_properties_add_bool(grp, ST_KEY_MIPMAPPING, D_TRANSLATE(ST_I18N_MIPMAPPING));
 		}
 
+		{ // Caching
+			auto p = obs_properties_add_bool(grp, ST_KEY_STATIC, D_TRANSLATE(ST_I18N_STATIC));
+		}
+
 		{ // Order
 			auto p = obs_properties_add_list(grp, ST_KEY_ROTATION_ORDER, D_TRANSLATE(ST_I18N_ROTATION_ORDER), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
 			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_ROTATION_ORDER_XYZ), RotationOrder::XYZ);
@@ -22,7 +22,7 @@ namespace streamfx::filter::transform {
 		CORNER_PIN   = 2,
 	};
 
-	class transform_instance : public obs::source_instance {
+	class transform_instance final : public obs::source_instance {
 		std::shared_ptr<streamfx::gfx::util> _gfx_util;
 
 		// Settings
@@ -42,20 +42,29 @@ namespace streamfx::filter::transform {
 			vec2 br;
 		} _corners;
 
-		// Data
-		streamfx::obs::gs::effect  _standard_effect;
-		streamfx::obs::gs::effect  _transform_effect;
-		streamfx::obs::gs::sampler _sampler;
+		// Data, created once we are first rendered.
+		streamfx::obs::gs::effect_loader _standard_effect_loader;
+		streamfx::obs::gs::effect_loader _transform_effect_loader;
+		streamfx::obs::gs::effect        _standard_effect;
+		streamfx::obs::gs::effect        _transform_effect;
+		streamfx::obs::gs::sampler       _sampler;
 
 		// Cache
 		bool                                             _cache_rendered;
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _cache_rt;
 		std::shared_ptr<streamfx::obs::gs::texture>      _cache_texture;
+		struct {
+			bool     is_static; // Source never changes, as told by the user.
+			bool     valid;     // Cache and mip-maps still hold the source.
+			uint32_t width;
+			uint32_t height;
+			int64_t  media_time; // Media can be seeked while paused.
+		} _cache;
 
 		// Mip-mapping
 		bool                                        _mipmap_enabled;
 		bool                                        _mipmap_rendered;
-		streamfx::gfx::mipmapper                    _mipmapper;
+		std::shared_ptr<streamfx::gfx::mipmapper>   _mipmapper;
 		std::shared_ptr<streamfx::obs::gs::texture> _mipmap_texture;
 
 		// Input
@@ -68,6 +77,10 @@ namespace streamfx::filter::transform {
 		bool                                              _update_mesh;
 		std::shared_ptr<streamfx::obs::gs::vertex_buffer> _vertex_buffer;
 
+		// Direct Rendering
+		bool    _direct_render;
+		matrix4 _direct_matrix;
+
 		public:
 		transform_instance(obs_data_t*, obs_source_t*);
 		virtual ~transform_instance() override;
@@ -77,7 +90,12 @@ namespace streamfx::filter::transform {
 		virtual void update(obs_data_t*) override;
 
 		virtual void video_tick(float) override;
+		virtual bool video_tick_skip_hidden() override;
 		virtual void video_render(gs_effect_t*) override;
+		virtual void prepare() override;
+
+		private:
+		bool is_source_static(obs_source_t* parent, obs_source_t* target, int64_t& media_time);
 	};
 
 	class transform_factory : public obs::source_factory<filter::transform::transform_factory, filter::transform::transform_instance> {
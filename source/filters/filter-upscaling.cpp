@@ -4,11 +4,13 @@
 
 #include "filter-upscaling.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/obs-tools.hpp"
 #include "plugin.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
 #include <algorithm>
+#include <cmath>
 #include "warning-enable.hpp"
 
 #ifdef _DEBUG
@@ -29,6 +31,7 @@
 #define ST_KEY_PROVIDER "Provider"
 #define ST_I18N_PROVIDER ST_I18N "." ST_KEY_PROVIDER
 #define ST_I18N_PROVIDER_NVIDIA_SUPERRES ST_I18N_PROVIDER ".NVIDIA.SuperResolution"
+#define ST_I18N_PROVIDER_SPATIAL ST_I18N_PROVIDER ".Spatial"
 
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
 #define ST_KEY_NVIDIA_SUPERRES "NVIDIA.SuperRes"
@@ -41,17 +44,31 @@
 #define ST_I18N_NVIDIA_SUPERRES_SCALE ST_I18N "." ST_KEY_NVIDIA_SUPERRES_SCALE
 #endif
 
+#define ST_KEY_SPATIAL "Spatial"
+#define ST_I18N_SPATIAL ST_I18N "." ST_KEY_SPATIAL
+#define ST_KEY_SPATIAL_MODE "Spatial.Mode"
+#define ST_I18N_SPATIAL_MODE ST_I18N "." ST_KEY_SPATIAL_MODE
+#define ST_I18N_SPATIAL_MODE_EDGEADAPTIVE ST_I18N_SPATIAL_MODE ".EdgeAdaptive"
+#define ST_I18N_SPATIAL_MODE_LANCZOS ST_I18N_SPATIAL_MODE ".Lanczos"
+#define ST_KEY_SPATIAL_SCALE "Spatial.Scale"
+#define ST_I18N_SPATIAL_SCALE ST_I18N "." ST_KEY_SPATIAL_SCALE
+#define ST_KEY_SPATIAL_SHARPNESS "Spatial.Sharpness"
+#define ST_I18N_SPATIAL_SHARPNESS ST_I18N "." ST_KEY_SPATIAL_SHARPNESS
+
 using streamfx::filter::upscaling::upscaling_factory;
 using streamfx::filter::upscaling::upscaling_instance;
 using streamfx::filter::upscaling::upscaling_provider;
+using streamfx::filter::upscaling::spatial_mode;
 
 static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-StreamFX/wiki/Filter-Upscaling";
 
 /** Priority of providers for automatic selection if more than one is available.
  * 
+ * Spatial is last, as it works on every GPU but can't reconstruct detail the way the trained models can.
  */
 static upscaling_provider provider_priority[] = {
 	upscaling_provider::NVIDIA_SUPERRESOLUTION,
+	upscaling_provider::SPATIAL,
 };
 
 const char* streamfx::filter::upscaling::cstring(upscaling_provider provider)
@@ -63,6 +80,8 @@ const char* streamfx::filter::upscaling::cstring(upscaling_provider provider)
 		return D_TRANSLATE(S_STATE_AUTOMATIC);
 	case upscaling_provider::NVIDIA_SUPERRESOLUTION:
 		return D_TRANSLATE(ST_I18N_PROVIDER_NVIDIA_SUPERRES);
+	case upscaling_provider::SPATIAL:
+		return D_TRANSLATE(ST_I18N_PROVIDER_SPATIAL);
 	default:
 		throw std::runtime_error("Missing Conversion Entry");
 	}
@@ -76,31 +95,11 @@ std::string streamfx::filter::upscaling::string(upscaling_provider provider)
 //------------------------------------------------------------------------------
 // Instance
 //------------------------------------------------------------------------------
-upscaling_instance::upscaling_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self), _in_size(1, 1), _out_size(1, 1), _provider(upscaling_provider::INVALID), _provider_ui(upscaling_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(), _input(), _output(), _dirty(false)
+upscaling_instance::upscaling_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self), _in_size(1, 1), _out_size(1, 1), _provider(upscaling_provider::INVALID), _provider_ui(upscaling_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(), _qos(::streamfx::gfx::qos::get()), _input(), _output(), _alpha(), _dirty(true), _media_time(0), _bypassed(false), _spatial_effect(), _spatial_rt(), _spatial_mode(spatial_mode::EDGE_ADAPTIVE), _spatial_scale(1.5f), _spatial_sharpness(0.2f)
 {
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 
-	{
-		::streamfx::obs::gs::context gctx;
-
-		// Create the render target for the input buffering.
-		_input = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
-		_input->render(1, 1); // Preallocate the RT on the driver and GPU.
-		_output = _input->get_texture();
-
-		// Load the required effect.
-		_standard_effect = std::make_shared<::streamfx::obs::gs::effect>(::streamfx::data_file_path("effects/standard.effect"));
-
-		// Create Samplers
-		_channel0_sampler = std::make_shared<::streamfx::obs::gs::sampler>();
-		_channel0_sampler->set_filter(gs_sample_filter::GS_FILTER_LINEAR);
-		_channel0_sampler->set_address_mode_u(GS_ADDRESS_CLAMP);
-		_channel0_sampler->set_address_mode_v(GS_ADDRESS_CLAMP);
-		_channel1_sampler = std::make_shared<::streamfx::obs::gs::sampler>();
-		_channel1_sampler->set_filter(gs_sample_filter::GS_FILTER_LINEAR);
-		_channel1_sampler->set_address_mode_u(GS_ADDRESS_CLAMP);
-		_channel1_sampler->set_address_mode_v(GS_ADDRESS_CLAMP);
-	}
+	// Graphics resources are created by allocate() on the first render, so that loading doesn't wait for the GPU.
 
 	if (data) {
 		load(data);
@@ -114,10 +113,10 @@ upscaling_instance::~upscaling_instance()
 	{ // Unload the underlying effect ASAP.
 		std::unique_lock<std::mutex> ul(_provider_lock);
 
-		// De-queue the underlying task.
+		// Skip what is left of a switch, and wait for the step that might be running.
 		if (_provider_task) {
-			streamfx::threadpool()->pop(_provider_task);
-			_provider_task->await_completion();
+			_provider_task->cancel();
+			_provider_task->wait();
 			_provider_task.reset();
 		}
 
@@ -128,6 +127,9 @@ upscaling_instance::~upscaling_instance()
 			nvvfxsr_unload();
 			break;
 #endif
+		case upscaling_provider::SPATIAL:
+			spatial_unload();
+			break;
 		default:
 			break;
 		}
@@ -164,9 +166,15 @@ void upscaling_instance::update(obs_data_t* data)
 			nvvfxsr_update(data);
 			break;
 #endif
+		case upscaling_provider::SPATIAL:
+			spatial_update(data);
+			break;
 		default:
 			break;
 		}
+
+		// The same input now gives a different result.
+		_dirty = true;
 	}
 }
 
@@ -178,6 +186,9 @@ void streamfx::filter::upscaling::upscaling_instance::properties(obs_properties_
 		nvvfxsr_properties(properties);
 		break;
 #endif
+	case upscaling_provider::SPATIAL:
+		spatial_properties(properties);
+		break;
 	default:
 		break;
 	}
@@ -193,13 +204,21 @@ uint32_t streamfx::filter::upscaling::upscaling_instance::get_height()
 	return std::max<uint32_t>(_out_size.second, 1);
 }
 
+bool upscaling_instance::video_tick_skip_hidden()
+{
+	return true;
+}
+
 void upscaling_instance::video_tick(float_t time)
 {
-	auto target = obs_filter_get_target(_self);
-	auto width  = obs_source_get_base_width(target);
-	auto height = obs_source_get_base_height(target);
-	_in_size    = {width, height};
-	_out_size   = _in_size;
+	auto parent   = obs_filter_get_parent(_self);
+	auto target   = obs_filter_get_target(_self);
+	auto width    = obs_source_get_base_width(target);
+	auto height   = obs_source_get_base_height(target);
+	auto in_size  = _in_size;
+	auto out_size = _out_size;
+	_in_size      = {width, height};
+	_out_size     = _in_size;
 
 	// Allow the provider to restrict the size.
 	if (target && _provider_ready) {
@@ -211,12 +230,41 @@ void upscaling_instance::video_tick(float_t time)
 			nvvfxsr_size();
 			break;
 #endif
+		case upscaling_provider::SPATIAL:
+			spatial_size();
+			break;
 		default:
 			break;
 		}
 	}
 
-	_dirty = true;
+	// Inference is expensive, so reuse the last result for as long as the input is known not to have changed.
+	int64_t media_time = 0;
+	bool    is_static  = ::streamfx::obs::tools::filter_input_is_static(parent, target, media_time);
+	if (!is_static || (media_time != _media_time) || (in_size != _in_size) || (out_size != _out_size)) {
+		_dirty = true;
+	}
+	_media_time = media_time;
+}
+
+void upscaling_instance::allocate()
+{
+	// Load the required effect.
+	_standard_effect = std::make_shared<::streamfx::obs::gs::effect>(::streamfx::data_file_path("effects/standard.effect"));
+
+	// Create Samplers
+	_channel0_sampler = ::streamfx::obs::gs::sampler::get(GS_FILTER_LINEAR, GS_ADDRESS_CLAMP, GS_ADDRESS_CLAMP);
+	_channel1_sampler = ::streamfx::obs::gs::sampler::get(GS_FILTER_LINEAR, GS_ADDRESS_CLAMP, GS_ADDRESS_CLAMP);
+
+	// Create the render target for the input buffering last, as it marks everything as allocated.
+	_input = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+}
+
+void upscaling_instance::prepare()
+{
+	if (!_input) {
+		allocate();
+	}
 }
 
 void upscaling_instance::video_render(gs_effect_t* effect)
@@ -245,6 +293,16 @@ void upscaling_instance::video_render(gs_effect_t* effect)
 	::streamfx::obs::gs::debug_marker profiler0_0{::streamfx::obs::gs::debug_color_gray, "'%s' on '%s'", obs_source_get_name(_self), obs_source_get_name(parent)};
 #endif
 
+	// While OBS can't keep up, skip the provider and stretch the input instead, which is nearly free.
+	if (bool bypass = (_qos->level() >= 2); bypass != _bypassed) {
+		_bypassed = bypass;
+		_dirty    = true;
+	}
+
+	if (!_input) {
+		allocate();
+	}
+
 	if (_dirty) {
 		// Lock the provider from being changed.
 		std::unique_lock<std::mutex> ul(_provider_lock);
@@ -252,8 +310,28 @@ void upscaling_instance::video_render(gs_effect_t* effect)
 		{ // Capture the incoming frame.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_capture, "Capture"};
+#endif
+			// A NVIDIA filter below may hand over its result in CUDA memory, which makes the capture unnecessary.
+			bool handed = false;
+#ifdef ENABLE_FILTER_UPSCALING_NVIDIA
+			std::unique_ptr<::streamfx::nvidia::vfx::handoff> handoff;
+			if (!_bypassed && (_provider == upscaling_provider::NVIDIA_SUPERRESOLUTION) && _nvidia_fx) {
+				handoff = std::make_unique<::streamfx::nvidia::vfx::handoff>(target, _in_size.first, _in_size.second);
+			}
 #endif
 			if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
+#ifdef ENABLE_FILTER_UPSCALING_NVIDIA
+				if (handoff) {
+					_nvidia_image = handoff->take(_alpha);
+					handed        = static_cast<bool>(_nvidia_image);
+				}
+#endif
+			} else {
+				obs_source_skip_video_filter(_self);
+				return;
+			}
+
+			if (!handed) {
 				auto op = _input->render(_in_size.first, _in_size.second);
 
 				// Matrix
@@ -280,9 +358,8 @@ void upscaling_instance::video_render(gs_effect_t* effect)
 				// Reset GPU state
 				gs_blend_state_pop();
 				gs_matrix_pop();
-			} else {
-				obs_source_skip_video_filter(_self);
-				return;
+
+				_alpha = _input->get_texture();
 			}
 		}
 
@@ -290,15 +367,22 @@ void upscaling_instance::video_render(gs_effect_t* effect)
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Process"};
 #endif
-			switch (_provider) {
+			if (_bypassed) {
+				_output = _input->get_texture();
+			} else {
+				switch (_provider) {
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
-			case upscaling_provider::NVIDIA_SUPERRESOLUTION:
-				nvvfxsr_process();
-				break;
+				case upscaling_provider::NVIDIA_SUPERRESOLUTION:
+					nvvfxsr_process();
+					break;
 #endif
-			default:
-				_output.reset();
-				break;
+				case upscaling_provider::SPATIAL:
+					spatial_process();
+					break;
+				default:
+					_output.reset();
+					break;
+				}
 			}
 		} catch (...) {
 			obs_source_skip_video_filter(_self);
@@ -322,17 +406,22 @@ void upscaling_instance::video_render(gs_effect_t* effect)
 			_standard_effect->get_parameter("InputA").set_texture(_output);
 		}
 		if (_standard_effect->has_parameter("InputB", ::streamfx::obs::gs::effect_parameter::type::Texture)) {
-			_standard_effect->get_parameter("InputB").set_texture(_input->get_texture());
+			_standard_effect->get_parameter("InputB").set_texture(_alpha);
 		}
 		while (gs_effect_loop(_standard_effect->get_object(), "RestoreAlpha")) {
 			gs_draw_sprite(nullptr, 0, _out_size.first, _out_size.second);
 		}
 	}
-}
 
-struct switch_provider_data_t {
-	upscaling_provider provider;
-};
+#ifdef ENABLE_FILTER_UPSCALING_NVIDIA
+	// Whatever was handed over belongs to the filter below, so it has to be handed over again for the next render.
+	if (_nvidia_image) {
+		_nvidia_image.reset();
+		_alpha.reset();
+		_dirty = true;
+	}
+#endif
+}
 
 void streamfx::filter::upscaling::upscaling_instance::switch_provider(upscaling_provider provider)
 {
@@ -350,31 +439,28 @@ void streamfx::filter::upscaling::upscaling_instance::switch_provider(upscaling_
 	// Log information.
 	D_LOG_INFO("Instance '%s' is switching provider from '%s' to '%s'.", obs_source_get_name(_self), cstring(_provider), cstring(provider));
 
-	// If there is an existing task, attempt to cancel it.
+	// If there is an existing switch, skip what is left of it.
 	if (_provider_task) {
-		// De-queue it.
-		streamfx::threadpool()->pop(_provider_task);
-
-		// Await the death of the task itself.
-		_provider_task->await_completion();
-
-		// Clear any memory associated with it.
+		_provider_task->cancel();
+		_provider_task->wait();
 		_provider_task.reset();
 	}
 
-	// Build data to pass into the task.
-	auto spd      = std::make_shared<switch_provider_data_t>();
-	spd->provider = _provider;
-	_provider     = provider;
+	upscaling_provider previous = _provider;
+	_provider                   = provider;
 
-	// Then spawn a new task to switch provider.
-	_provider_task = streamfx::threadpool()->push(std::bind(&upscaling_instance::task_switch_provider, this, std::placeholders::_1), spd);
+	// Load in the background, and only publish the result to rendering once the graphics thread starts a new frame.
+	_provider_task = std::make_shared<util::threadpool::chain>();
+	_provider_task->then(util::threadpool::executor::BACKGROUND, [this, previous]() { task_switch_provider(previous); });
+	_provider_task->then(util::threadpool::executor::GRAPHICS, [this]() {
+		_dirty          = true;
+		_provider_ready = true;
+	});
+	_provider_task->start();
 }
 
-void streamfx::filter::upscaling::upscaling_instance::task_switch_provider(util::threadpool::task_data_t data)
+void streamfx::filter::upscaling::upscaling_instance::task_switch_provider(upscaling_provider previous)
 {
-	std::shared_ptr<switch_provider_data_t> spd = std::static_pointer_cast<switch_provider_data_t>(data);
-
 	// 1. Mark the provider as no longer ready.
 	_provider_ready = false;
 
@@ -383,12 +469,15 @@ void streamfx::filter::upscaling::upscaling_instance::task_switch_provider(util:
 
 	try {
 		// 3. Unload the previous provider.
-		switch (spd->provider) {
+		switch (previous) {
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
 		case upscaling_provider::NVIDIA_SUPERRESOLUTION:
 			nvvfxsr_unload();
 			break;
 #endif
+		case upscaling_provider::SPATIAL:
+			spatial_unload();
+			break;
 		default:
 			break;
 		}
@@ -405,29 +494,37 @@ void streamfx::filter::upscaling::upscaling_instance::task_switch_provider(util:
 			}
 			break;
 #endif
+		case upscaling_provider::SPATIAL:
+			spatial_load();
+			{
+				auto data = obs_source_get_settings(_self);
+				spatial_update(data);
+				obs_data_release(data);
+			}
+			break;
 		default:
 			break;
 		}
 
 		// Log information.
-		D_LOG_INFO("Instance '%s' switched provider from '%s' to '%s'.", obs_source_get_name(_self), cstring(spd->provider), cstring(_provider));
-
-		// 5. Set the new provider as valid.
-		_provider_ready = true;
+		D_LOG_INFO("Instance '%s' switched provider from '%s' to '%s'.", obs_source_get_name(_self), cstring(previous), cstring(_provider));
 	} catch (std::exception const& ex) {
-		// Log information.
+		// Log information, and stop the chain before the provider is published.
 		D_LOG_ERROR("Instance '%s' failed switching provider with error: %s", obs_source_get_name(_self), ex.what());
+		throw;
 	}
 }
 
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
 void streamfx::filter::upscaling::upscaling_instance::nvvfxsr_load()
 {
-	_nvidia_fx = std::make_shared<::streamfx::nvidia::vfx::superresolution>();
+	_nvidia_fx = ::streamfx::nvidia::warmup::get()->take<::streamfx::nvidia::vfx::superresolution>();
 }
 
 void streamfx::filter::upscaling::upscaling_instance::nvvfxsr_unload()
 {
+	_nvidia_replacement.cancel();
+	_nvidia_config = {-1.f, -1.f};
 	_nvidia_fx.reset();
 }
 
@@ -437,6 +534,11 @@ void streamfx::filter::upscaling::upscaling_instance::nvvfxsr_size()
 		return;
 	}
 
+	// Swap in a replacement as soon as it is loaded, before the sizes are picked for this frame.
+	if (auto fx = _nvidia_replacement.take(); fx) {
+		_nvidia_fx = std::move(fx);
+	}
+
 	auto in_size = _in_size;
 	_nvidia_fx->size(in_size, _in_size, _out_size);
 }
@@ -448,7 +550,12 @@ void streamfx::filter::upscaling::upscaling_instance::nvvfxsr_process()
 		return;
 	}
 
-	_output = _nvidia_fx->process(_input->get_texture());
+	if (_nvidia_image) {
+		// Handed over images range from 0 to 1, while the effect works with 0 to 255.
+		_output = _nvidia_fx->process(_nvidia_image, 255.f);
+	} else {
+		_output = _nvidia_fx->process(_input->get_texture());
+	}
 }
 
 void streamfx::filter::upscaling::upscaling_instance::nvvfxsr_properties(obs_properties_t* props)
@@ -473,12 +580,141 @@ void streamfx::filter::upscaling::upscaling_instance::nvvfxsr_update(obs_data_t*
 	if (!_nvidia_fx)
 		return;
 
-	_nvidia_fx->set_strength(static_cast<float>(obs_data_get_int(data, ST_KEY_NVIDIA_SUPERRES_STRENGTH) == 0 ? 0. : 1.));
-	_nvidia_fx->set_scale(static_cast<float>(obs_data_get_double(data, ST_KEY_NVIDIA_SUPERRES_SCALE) / 100.));
+	float strength = static_cast<float>(obs_data_get_int(data, ST_KEY_NVIDIA_SUPERRES_STRENGTH) == 0 ? 0. : 1.);
+	float scale    = static_cast<float>(obs_data_get_double(data, ST_KEY_NVIDIA_SUPERRES_SCALE) / 100.);
+	if (std::pair<float, float>{strength, scale} == _nvidia_config) {
+		return;
+	}
+	_nvidia_config = {strength, scale};
+
+	if (!_provider_ready) {
+		// Nothing uses it yet, so it may as well load on first use.
+		_nvidia_fx->set_strength(strength);
+		_nvidia_fx->set_scale(scale);
+		return;
+	}
+
+	// Both pick what the model is loaded for, keep upscaling with the current one until the new one is loaded.
+	std::pair<uint32_t, uint32_t> size = {obs_source_get_base_width(obs_filter_get_target(_self)), obs_source_get_base_height(obs_filter_get_target(_self))};
+	_nvidia_replacement.request([strength, scale, size](std::shared_ptr<::streamfx::nvidia::vfx::superresolution> fx) {
+		std::pair<uint32_t, uint32_t> in_size;
+		std::pair<uint32_t, uint32_t> out_size;
+		fx->set_strength(strength);
+		fx->set_scale(scale);
+		fx->size(size, in_size, out_size);
+		fx->preload(in_size.first, in_size.second);
+	});
 }
 
 #endif
 
+void streamfx::filter::upscaling::upscaling_instance::spatial_load()
+{
+	::streamfx::obs::gs::context gctx;
+
+	_spatial_effect = ::streamfx::obs::gs::effect::create_shared(::streamfx::data_file_path("effects/upscaling.effect"));
+	for (auto& rt : _spatial_rt) {
+		rt = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+	}
+}
+
+void streamfx::filter::upscaling::upscaling_instance::spatial_unload()
+{
+	::streamfx::obs::gs::context gctx;
+
+	for (auto& rt : _spatial_rt) {
+		rt.reset();
+	}
+	_spatial_effect.reset();
+}
+
+void streamfx::filter::upscaling::upscaling_instance::spatial_size()
+{
+	_out_size.first  = std::max<uint32_t>(static_cast<uint32_t>(std::lround(_in_size.first * _spatial_scale)), 1);
+	_out_size.second = std::max<uint32_t>(static_cast<uint32_t>(std::lround(_in_size.second * _spatial_scale)), 1);
+}
+
+void streamfx::filter::upscaling::upscaling_instance::spatial_process()
+{
+	if (!_spatial_effect || !_spatial_rt[0] || !_spatial_rt[1]) {
+		_output = _input->get_texture();
+		return;
+	}
+
+	// Every pass overwrites its whole target, so nothing may be blended with what was there before.
+	gs_blend_state_push();
+	gs_enable_color(true, true, true, true);
+	gs_enable_blending(false);
+	gs_enable_depth_test(false);
+	gs_enable_stencil_test(false);
+	gs_set_cull_mode(GS_NEITHER);
+
+	auto pass = [this](std::shared_ptr<::streamfx::obs::gs::rendertarget> rt, std::shared_ptr<::streamfx::obs::gs::texture> input, uint32_t width, uint32_t height, const char* technique) {
+		{
+			auto op = rt->render(width, height);
+			gs_matrix_push();
+			gs_ortho(0., 1., 0., 1., 0., 1.);
+
+			float_t iw = static_cast<float_t>(input->get_width());
+			float_t ih = static_cast<float_t>(input->get_height());
+			_spatial_effect.get_parameter("InputA").set_texture(input);
+			_spatial_effect.get_parameter("InputSize").set_float4(iw, ih, 1.f / iw, 1.f / ih);
+			while (gs_effect_loop(_spatial_effect.get_object(), technique)) {
+				gs_draw_sprite(nullptr, 0, 1, 1);
+			}
+
+			gs_matrix_pop();
+		}
+		return rt->get_texture();
+	};
+
+	auto input = _input->get_texture();
+	if (_spatial_mode == spatial_mode::LANCZOS) {
+		// Separable, so the horizontal pass only has to widen the image.
+		_spatial_effect.get_parameter("Direction").set_float2(1.f, 0.f);
+		auto horizontal = pass(_spatial_rt[0], input, _out_size.first, _in_size.second, "Lanczos");
+		_spatial_effect.get_parameter("Direction").set_float2(0.f, 1.f);
+		_output = pass(_spatial_rt[1], horizontal, _out_size.first, _out_size.second, "Lanczos");
+	} else {
+		auto upscaled = pass(_spatial_rt[0], input, _out_size.first, _out_size.second, "EASU");
+		_spatial_effect.get_parameter("Sharpness").set_float(_spatial_sharpness);
+		_output = pass(_spatial_rt[1], upscaled, _out_size.first, _out_size.second, "RCAS");
+	}
+
+	gs_blend_state_pop();
+}
+
+void streamfx::filter::upscaling::upscaling_instance::spatial_properties(obs_properties_t* props)
+{
+	obs_properties_t* grp = obs_properties_create();
+	obs_properties_add_group(props, ST_KEY_SPATIAL, D_TRANSLATE(ST_I18N_SPATIAL), OBS_GROUP_NORMAL, grp);
+
+	{
+		auto p = obs_properties_add_list(grp, ST_KEY_SPATIAL_MODE, D_TRANSLATE(ST_I18N_SPATIAL_MODE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_SPATIAL_MODE_EDGEADAPTIVE), static_cast<int64_t>(spatial_mode::EDGE_ADAPTIVE));
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_SPATIAL_MODE_LANCZOS), static_cast<int64_t>(spatial_mode::LANCZOS));
+	}
+
+	{
+		auto p = obs_properties_add_float_slider(grp, ST_KEY_SPATIAL_SCALE, D_TRANSLATE(ST_I18N_SPATIAL_SCALE), 100.00, 400.00, .01);
+		obs_property_float_set_suffix(p, " %");
+	}
+
+	{
+		auto p = obs_properties_add_float_slider(grp, ST_KEY_SPATIAL_SHARPNESS, D_TRANSLATE(ST_I18N_SPATIAL_SHARPNESS), 0.00, 100.00, .01);
+		obs_property_float_set_suffix(p, " %");
+	}
+}
+
+void streamfx::filter::upscaling::upscaling_instance::spatial_update(obs_data_t* data)
+{
+	_spatial_mode  = static_cast<spatial_mode>(obs_data_get_int(data, ST_KEY_SPATIAL_MODE));
+	_spatial_scale = static_cast<float_t>(std::clamp(obs_data_get_double(data, ST_KEY_SPATIAL_SCALE), 100., 400.) / 100.);
+
+	// RCAS takes the reduction in stops, where 0 is the strongest. Map 100% to 0 stops and 0% to 2 stops.
+	_spatial_sharpness = static_cast<float_t>((1. - std::clamp(obs_data_get_double(data, ST_KEY_SPATIAL_SHARPNESS), 0., 100.) / 100.) * 2.);
+}
+
 //------------------------------------------------------------------------------
 // Factory
 //------------------------------------------------------------------------------
@@ -486,39 +722,17 @@ upscaling_factory::~upscaling_factory() {}
 
 upscaling_factory::upscaling_factory()
 {
-	bool any_available = false;
-
 	// 1. Try and load any configured providers.
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
-	try {
-		// Load CVImage and Video Effects SDK.
-		_nvcuda           = ::streamfx::nvidia::cuda::obs::get();
-		_nvcvi            = ::streamfx::nvidia::cv::cv::get();
-		_nvvfx            = ::streamfx::nvidia::vfx::vfx::get();
-		_nvidia_available = true;
-		any_available |= _nvidia_available;
-	} catch (const std::exception& ex) {
-		_nvidia_available = false;
-		_nvvfx.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA Super-Resolution available due to error: %s", ex.what());
-	} catch (...) {
-		_nvidia_available = false;
-		_nvvfx.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA Super-Resolution available.", nullptr);
+	// Only look for the SDK here. It is loaded once a filter actually uses it, so that OBS doesn't pay for it on
+	// every start.
+	_nvidia_available = ::streamfx::nvidia::vfx::vfx::is_available();
+	if (!_nvidia_available) {
+		D_LOG_WARNING("Failed to make NVIDIA Super-Resolution available, as the SDK is not installed.", nullptr);
 	}
 #endif
 
-	// 2. Check if any of them managed to load at all.
-	if (!any_available) {
-		D_LOG_ERROR("All supported Super-Resolution providers failed to initialize, disabling effect.", 0);
-		return;
-	}
-
-	// 3. In any other case, register the filter!
+	// 2. Register the filter, the spatial provider only needs shaders and is always available.
 	_info.id           = S_PREFIX "filter-upscaling";
 	_info.type         = OBS_SOURCE_TYPE_FILTER;
 	_info.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW /*| OBS_SOURCE_SRGB*/;
@@ -543,6 +757,10 @@ void upscaling_factory::get_defaults2(obs_data_t* data)
 	obs_data_set_default_double(data, ST_KEY_NVIDIA_SUPERRES_SCALE, 150.);
 	obs_data_set_default_double(data, ST_KEY_NVIDIA_SUPERRES_STRENGTH, 0.);
 #endif
+
+	obs_data_set_default_int(data, ST_KEY_SPATIAL_MODE, static_cast<int64_t>(spatial_mode::EDGE_ADAPTIVE));
+	obs_data_set_default_double(data, ST_KEY_SPATIAL_SCALE, 150.);
+	obs_data_set_default_double(data, ST_KEY_SPATIAL_SHARPNESS, 90.);
 }
 
 static bool modified_provider(obs_properties_t* props, obs_property_t*, obs_data_t* settings) noexcept
@@ -580,7 +798,10 @@ obs_properties_t* upscaling_factory::get_properties2(upscaling_instance* data)
 			auto p = obs_properties_add_list(grp, ST_KEY_PROVIDER, D_TRANSLATE(ST_I18N_PROVIDER), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
 			obs_property_set_modified_callback(p, modified_provider);
 			obs_property_list_add_int(p, D_TRANSLATE(S_STATE_AUTOMATIC), static_cast<int64_t>(upscaling_provider::AUTOMATIC));
+#ifdef ENABLE_FILTER_UPSCALING_NVIDIA
 			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_PROVIDER_NVIDIA_SUPERRES), static_cast<int64_t>(upscaling_provider::NVIDIA_SUPERRESOLUTION));
+#endif
+			obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_PROVIDER_SPATIAL), static_cast<int64_t>(upscaling_provider::SPATIAL));
 		}
 	}
 
@@ -610,6 +831,8 @@ bool streamfx::filter::upscaling::upscaling_factory::is_provider_available(upsca
 	case upscaling_provider::NVIDIA_SUPERRESOLUTION:
 		return _nvidia_available;
 #endif
+	case upscaling_provider::SPATIAL:
+		return true;
 	default:
 		return false;
 	}
@@ -3,6 +3,7 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "gfx/gfx-qos.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
@@ -17,7 +18,9 @@
 #include "warning-enable.hpp"
 
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
+#include "nvidia/vfx/nvidia-vfx-handoff.hpp"
 #include "nvidia/vfx/nvidia-vfx-superresolution.hpp"
+#include "nvidia/nvidia-warmup.hpp"
 #endif
 
 namespace streamfx::filter::upscaling {
@@ -25,21 +28,29 @@ namespace streamfx::filter::upscaling {
 		INVALID                = -1,
 		AUTOMATIC              = 0,
 		NVIDIA_SUPERRESOLUTION = 1,
+		SPATIAL                = 2,
+	};
+
+	enum class spatial_mode : int64_t {
+		EDGE_ADAPTIVE = 0,
+		LANCZOS       = 1,
 	};
 
 	const char* cstring(upscaling_provider provider);
 
 	std::string string(upscaling_provider provider);
 
-	class upscaling_instance : public ::streamfx::obs::source_instance {
+	class upscaling_instance final : public ::streamfx::obs::source_instance {
 		std::pair<uint32_t, uint32_t> _in_size;
 		std::pair<uint32_t, uint32_t> _out_size;
 
-		std::atomic<upscaling_provider>         _provider;
-		upscaling_provider                      _provider_ui;
-		std::atomic<bool>                       _provider_ready;
-		std::mutex                              _provider_lock;
-		std::shared_ptr<util::threadpool::task> _provider_task;
+		std::atomic<upscaling_provider>          _provider;
+		upscaling_provider                       _provider_ui;
+		std::atomic<bool>                        _provider_ready;
+		std::mutex                               _provider_lock;
+		std::shared_ptr<util::threadpool::chain> _provider_task;
+
+		std::shared_ptr<::streamfx::gfx::qos> _qos;
 
 		std::shared_ptr<::streamfx::obs::gs::effect>  _standard_effect;
 		std::shared_ptr<::streamfx::obs::gs::sampler> _channel0_sampler;
@@ -47,12 +58,24 @@ namespace streamfx::filter::upscaling {
 
 		std::shared_ptr<::streamfx::obs::gs::rendertarget> _input;
 		std::shared_ptr<::streamfx::obs::gs::texture>      _output;
-		bool                                               _dirty;
+		std::shared_ptr<::streamfx::obs::gs::texture>      _alpha; // Alpha channel restored on the output.
+		std::atomic<bool>                                  _dirty;
+		int64_t                                            _media_time;
+		bool                                               _bypassed;
 
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
-		std::shared_ptr<::streamfx::nvidia::vfx::superresolution> _nvidia_fx;
+		std::shared_ptr<::streamfx::nvidia::vfx::superresolution>                 _nvidia_fx;
+		std::shared_ptr<::streamfx::nvidia::cv::image>                            _nvidia_image; // Handed over by the filter below.
+		::streamfx::nvidia::replacement<::streamfx::nvidia::vfx::superresolution> _nvidia_replacement;
+		std::pair<float, float>                                                   _nvidia_config = {-1.f, -1.f}; // Last requested strength and scale.
 #endif
 
+		::streamfx::obs::gs::effect                        _spatial_effect;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _spatial_rt[2];
+		spatial_mode                                       _spatial_mode;
+		float_t                                            _spatial_scale;
+		float_t                                            _spatial_sharpness;
+
 		public:
 		upscaling_instance(obs_data_t* data, obs_source_t* self);
 		~upscaling_instance() override;
@@ -66,11 +89,15 @@ namespace streamfx::filter::upscaling {
 		uint32_t get_height() override;
 
 		void video_tick(float_t time) override;
+		bool video_tick_skip_hidden() override;
 		void video_render(gs_effect_t* effect) override;
+		void prepare() override;
 
 		private:
+		void allocate();
+
 		void switch_provider(upscaling_provider provider);
-		void task_switch_provider(util::threadpool::task_data_t data);
+		void task_switch_provider(upscaling_provider previous);
 
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
 		void nvvfxsr_load();
@@ -80,14 +107,18 @@ namespace streamfx::filter::upscaling {
 		void nvvfxsr_properties(obs_properties_t* props);
 		void nvvfxsr_update(obs_data_t* data);
 #endif
+
+		void spatial_load();
+		void spatial_unload();
+		void spatial_size();
+		void spatial_process();
+		void spatial_properties(obs_properties_t* props);
+		void spatial_update(obs_data_t* data);
 	};
 
 	class upscaling_factory : public ::streamfx::obs::source_factory<::streamfx::filter::upscaling::upscaling_factory, ::streamfx::filter::upscaling::upscaling_instance> {
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
-		bool                                           _nvidia_available;
-		std::shared_ptr<::streamfx::nvidia::cuda::obs> _nvcuda;
-		std::shared_ptr<::streamfx::nvidia::cv::cv>    _nvcvi;
-		std::shared_ptr<::streamfx::nvidia::vfx::vfx>  _nvvfx;
+		bool _nvidia_available;
 #endif
 
 		public:
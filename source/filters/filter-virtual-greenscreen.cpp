@@ -9,6 +9,7 @@
 
 #include "warning-disable.hpp"
 #include <algorithm>
+#include <optional>
 #include "warning-enable.hpp"
 
 #ifdef _DEBUG
@@ -29,6 +30,15 @@
 #define ST_KEY_PROVIDER "Provider"
 #define ST_I18N_PROVIDER ST_I18N "." ST_KEY_PROVIDER
 #define ST_I18N_PROVIDER_NVIDIA_GREENSCREEN ST_I18N_PROVIDER ".NVIDIA.Greenscreen"
+#define ST_KEY_RESOLUTION "Resolution"
+#define ST_I18N_RESOLUTION ST_I18N "." ST_KEY_RESOLUTION
+#define ST_I18N_RESOLUTION_FULL ST_I18N_RESOLUTION ".Full"
+#define ST_KEY_TEMPORAL_INTERVAL "Temporal.Interval"
+#define ST_I18N_TEMPORAL_INTERVAL ST_I18N "." ST_KEY_TEMPORAL_INTERVAL
+#define ST_KEY_TEMPORAL_SMOOTHING "Temporal.Smoothing"
+#define ST_I18N_TEMPORAL_SMOOTHING ST_I18N "." ST_KEY_TEMPORAL_SMOOTHING
+#define ST_KEY_SHARE "Share"
+#define ST_I18N_SHARE ST_I18N "." ST_KEY_SHARE
 
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
 #define ST_KEY_NVIDIA_GREENSCREEN "NVIDIA.Greenscreen"
@@ -45,6 +55,28 @@ using streamfx::filter::virtual_greenscreen::virtual_greenscreen_provider;
 
 static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-StreamFX/wiki/Filter-Virtual-Greenscreen";
 
+/** Draws into a texture that doesn't belong to a render target, such as one a provider registered with CUDA. */
+class texture_target {
+	gs_texture_t*  _previous;
+	gs_zstencil_t* _previous_zs;
+
+	public:
+	~texture_target()
+	{
+		gs_set_render_target(_previous, _previous_zs);
+		gs_projection_pop();
+		gs_viewport_pop();
+	}
+
+	texture_target(std::shared_ptr<::streamfx::obs::gs::texture> texture) : _previous(gs_get_render_target()), _previous_zs(gs_get_zstencil_target())
+	{
+		gs_viewport_push();
+		gs_projection_push();
+		gs_set_render_target(texture->get_object(), nullptr);
+		gs_set_viewport(0, 0, static_cast<int>(texture->get_width()), static_cast<int>(texture->get_height()));
+	}
+};
+
 /** Priority of providers for automatic selection if more than one is available.
  * 
  */
@@ -77,39 +109,11 @@ std::string streamfx::filter::virtual_greenscreen::string(virtual_greenscreen_pr
 virtual_greenscreen_instance::virtual_greenscreen_instance(obs_data_t* data, obs_source_t* self)
 	: obs::source_instance(data, self),
 
-	  _size(1, 1), _provider(virtual_greenscreen_provider::INVALID), _provider_ui(virtual_greenscreen_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(), _effect(), _channel0_sampler(), _channel1_sampler(), _input(), _output_color(), _output_alpha(), _dirty(true)
+	  _size(1, 1), _provider(virtual_greenscreen_provider::INVALID), _provider_ui(virtual_greenscreen_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(), _qos(::streamfx::gfx::qos::get()), _effect(), _channel0_sampler(), _channel1_sampler(), _input(), _output_color(), _output_alpha(), _output_coefficients(), _dirty(true), _resolution(0), _reduced_size(1, 1), _reduced(), _coefficients(), _temporal_interval(1), _temporal_smoothing(0.), _temporal_frame(0), _temporal_size(0, 0), _temporal(), _temporal_index(0), _temporal_mask(), _shared_masks(::streamfx::gfx::shared_masks::get()), _share_name(), _share_rt(), _share_dirty(false)
 {
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 
-	{
-		::streamfx::obs::gs::context gctx;
-
-		// Create the render target for the input buffering.
-		_input = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
-		_input->render(1, 1); // Preallocate the RT on the driver and GPU.
-		_output_color = _input->get_texture();
-		_output_alpha = _input->get_texture();
-
-		// Load the required effect.
-		{
-			std::filesystem::path file = ::streamfx::data_file_path("effects/virtual-greenscreen.effect");
-			try {
-				_effect = std::make_shared<::streamfx::obs::gs::effect>(file);
-			} catch (...) {
-				D_LOG_ERROR("Failed to load '%s'.", file.generic_u8string().c_str());
-			}
-		}
-
-		// Create Samplers
-		_channel0_sampler = std::make_shared<::streamfx::obs::gs::sampler>();
-		_channel0_sampler->set_filter(gs_sample_filter::GS_FILTER_LINEAR);
-		_channel0_sampler->set_address_mode_u(GS_ADDRESS_CLAMP);
-		_channel0_sampler->set_address_mode_v(GS_ADDRESS_CLAMP);
-		_channel1_sampler = std::make_shared<::streamfx::obs::gs::sampler>();
-		_channel1_sampler->set_filter(gs_sample_filter::GS_FILTER_LINEAR);
-		_channel1_sampler->set_address_mode_u(GS_ADDRESS_CLAMP);
-		_channel1_sampler->set_address_mode_v(GS_ADDRESS_CLAMP);
-	}
+	// Graphics resources are created by allocate() on the first render, so that loading doesn't wait for the GPU.
 
 	if (data) {
 		load(data);
@@ -120,6 +124,8 @@ virtual_greenscreen_instance::~virtual_greenscreen_instance()
 {
 	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
 
+	_shared_masks->withdraw(this);
+
 	{ // Unload the underlying effect ASAP.
 		std::unique_lock<std::mutex> ul(_provider_lock);
 
@@ -164,6 +170,15 @@ void virtual_greenscreen_instance::update(obs_data_t* data)
 		switch_provider(provider);
 	}
 
+	_resolution         = static_cast<uint32_t>(std::max<int64_t>(obs_data_get_int(data, ST_KEY_RESOLUTION), 0));
+	_temporal_interval  = static_cast<uint32_t>(std::clamp<int64_t>(obs_data_get_int(data, ST_KEY_TEMPORAL_INTERVAL), 1, 4));
+	_temporal_smoothing = static_cast<float_t>(std::clamp(obs_data_get_double(data, ST_KEY_TEMPORAL_SMOOTHING), 0., 100.) / 100.);
+
+	if (const char* name = obs_data_get_string(data, ST_KEY_SHARE); _share_name != (name ? name : "")) {
+		_shared_masks->withdraw(this);
+		_share_name = name ? name : "";
+	}
+
 	if (_provider_ready) {
 		std::unique_lock<std::mutex> ul(_provider_lock);
 
@@ -202,6 +217,11 @@ uint32_t streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::ge
 	return std::max<uint32_t>(_size.second, 1);
 }
 
+bool virtual_greenscreen_instance::video_tick_skip_hidden()
+{
+	return true;
+}
+
 void virtual_greenscreen_instance::video_tick(float_t time)
 {
 	auto target = obs_filter_get_target(_self);
@@ -216,7 +236,7 @@ void virtual_greenscreen_instance::video_tick(float_t time)
 		switch (_provider) {
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
 		case virtual_greenscreen_provider::NVIDIA_GREENSCREEN:
-			nvvfxgs_size();
+			nvvfxgs_size(_size);
 			break;
 #endif
 		default:
@@ -227,6 +247,42 @@ void virtual_greenscreen_instance::video_tick(float_t time)
 	_dirty = true;
 }
 
+void virtual_greenscreen_instance::allocate()
+{
+	// Mask resolution and guided upsampling.
+	_reduced      = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+	_coefficients = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA16F, GS_ZS_NONE);
+
+	// Temporal smoothing of the mask, alternating between the previous and the next result.
+	for (auto& rt : _temporal) {
+		rt = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+	}
+
+	// Load the required effect.
+	{
+		std::filesystem::path file = ::streamfx::data_file_path("effects/virtual-greenscreen.effect");
+		try {
+			_effect = std::make_shared<::streamfx::obs::gs::effect>(file);
+		} catch (...) {
+			D_LOG_ERROR("Failed to load '%s'.", file.generic_u8string().c_str());
+		}
+	}
+
+	// Create Samplers
+	_channel0_sampler = ::streamfx::obs::gs::sampler::get(GS_FILTER_LINEAR, GS_ADDRESS_CLAMP, GS_ADDRESS_CLAMP);
+	_channel1_sampler = ::streamfx::obs::gs::sampler::get(GS_FILTER_LINEAR, GS_ADDRESS_CLAMP, GS_ADDRESS_CLAMP);
+
+	// Create the render target for the input buffering last, as it marks everything as allocated.
+	_input = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+}
+
+void virtual_greenscreen_instance::prepare()
+{
+	if (!_input) {
+		allocate();
+	}
+}
+
 void virtual_greenscreen_instance::video_render(gs_effect_t* effect)
 {
 	auto parent = obs_filter_get_parent(_self);
@@ -253,16 +309,61 @@ void virtual_greenscreen_instance::video_render(gs_effect_t* effect)
 	::streamfx::obs::gs::debug_marker profiler0_0{::streamfx::obs::gs::debug_color_gray, "'%s' on '%s'", obs_source_get_name(_self), obs_source_get_name(parent)};
 #endif
 
+	if (!_input) {
+		allocate();
+	}
+
 	if (_dirty) {
 		// Lock the provider from being changed.
 		std::unique_lock<std::mutex> ul(_provider_lock);
 
+		// Segment at a fixed lower resolution if the input is larger than it, so that the cost no longer grows with
+		// the input resolution. The mask is then brought back to full resolution with a guided filter.
+		uint32_t longest = std::max<uint32_t>(_size.first, _size.second);
+		bool     guided  = (_resolution > 0) && (longest > _resolution);
+		if (guided) {
+			double scale  = static_cast<double>(_resolution) / static_cast<double>(longest);
+			_reduced_size = {std::max<uint32_t>(static_cast<uint32_t>(std::lround(_size.first * scale)), 1), std::max<uint32_t>(static_cast<uint32_t>(std::lround(_size.second * scale)), 1)};
+			switch (_provider) {
+#ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
+			case virtual_greenscreen_provider::NVIDIA_GREENSCREEN:
+				nvvfxgs_size(_reduced_size);
+				break;
+#endif
+			default:
+				break;
+			}
+		}
+
+		// Draw the last step before processing straight into the texture the provider hands to CUDA, which saves a
+		// full copy of the frame. Falls back to our own render targets if the provider has none.
+		std::shared_ptr<::streamfx::obs::gs::texture> direct;
+		try {
+			switch (_provider) {
+#ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
+			case virtual_greenscreen_provider::NVIDIA_GREENSCREEN:
+				direct = nvvfxgs_input(guided ? _reduced_size : _size);
+				break;
+#endif
+			default:
+				break;
+			}
+		} catch (...) {
+			direct.reset();
+		}
+
 		{ // Capture the incoming frame.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_capture, "Capture"};
 #endif
 			if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
-				auto op = _input->render(_size.first, _size.second);
+				std::optional<::streamfx::obs::gs::rendertarget_op> op;
+				std::optional<texture_target>                       tt;
+				if (direct && !guided) {
+					tt.emplace(direct);
+				} else {
+					op.emplace(_input->render(_size.first, _size.second));
+				}
 
 				// Matrix
 				gs_matrix_push();
@@ -293,10 +394,55 @@ void virtual_greenscreen_instance::video_render(gs_effect_t* effect)
 				return;
 			}
 
-			_output_color = _input->get_texture();
+			_output_color = (direct && !guided) ? direct : _input->get_texture();
 			_output_alpha = _output_color;
 		}
 
+		// Only run the provider every few frames if asked to, and keep the previous mask in between. Resizing always
+		// runs it, as the previous mask no longer fits. While OBS can't keep up, it runs half as often.
+		uint32_t interval = (_qos->level() >= 1) ? (_temporal_interval * 2) : _temporal_interval;
+		bool     infer    = !_temporal_mask || (_temporal_size != _size) || (++_temporal_frame >= interval);
+		if (infer) {
+			_temporal_frame = 0;
+			_temporal_size  = _size;
+		}
+
+		std::shared_ptr<::streamfx::obs::gs::texture> source = _output_color;
+		_output_coefficients.reset();
+		if (guided && infer) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+			::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Reduce"};
+#endif
+			{
+				std::optional<::streamfx::obs::gs::rendertarget_op> op;
+				std::optional<texture_target>                       tt;
+				if (direct) {
+					tt.emplace(direct);
+				} else {
+					op.emplace(_reduced->render(_reduced_size.first, _reduced_size.second));
+				}
+				gs_matrix_push();
+				gs_ortho(0., 1., 0., 1., 0., 1.);
+
+				gs_blend_state_push();
+				gs_enable_color(true, true, true, true);
+				gs_enable_blending(false);
+				gs_enable_depth_test(false);
+				gs_enable_stencil_test(false);
+				gs_set_cull_mode(GS_NEITHER);
+
+				gs_effect_t* default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+				gs_effect_set_texture(gs_effect_get_param_by_name(default_effect, "image"), source->get_object());
+				while (gs_effect_loop(default_effect, "Draw")) {
+					gs_draw_sprite(nullptr, 0, 1, 1);
+				}
+
+				gs_blend_state_pop();
+				gs_matrix_pop();
+			}
+			source = direct ? direct : _reduced->get_texture();
+		}
+
 		try { // Process the captured input with the provider.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Process"};
@@ -304,7 +450,12 @@ void virtual_greenscreen_instance::video_render(gs_effect_t* effect)
 			switch (_provider) {
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
 			case virtual_greenscreen_provider::NVIDIA_GREENSCREEN:
-				nvvfxgs_process(_output_color, _output_alpha);
+				if (infer) {
+					nvvfxgs_process(source, _output_color, _output_alpha);
+				} else {
+					nvvfxgs_delay(_output_color);
+					_output_alpha = _temporal_mask;
+				}
 				break;
 #endif
 			default:
@@ -315,10 +466,97 @@ void virtual_greenscreen_instance::video_render(gs_effect_t* effect)
 			return;
 		}
 
-		_dirty = false;
+		if (infer && (_output_alpha != _output_color)) { // Blend the new mask with the previous one.
+			if ((_temporal_smoothing > 0.) && _temporal_mask && _effect) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+				::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Temporal"};
+#endif
+				auto rt = _temporal[_temporal_index];
+				{
+					auto op = rt->render(_output_alpha->get_width(), _output_alpha->get_height());
+					gs_matrix_push();
+					gs_ortho(0., 1., 0., 1., 0., 1.);
+
+					gs_blend_state_push();
+					gs_enable_color(true, true, true, true);
+					gs_enable_blending(false);
+					gs_enable_depth_test(false);
+					gs_enable_stencil_test(false);
+					gs_set_cull_mode(GS_NEITHER);
+
+					if (_effect->has_parameter("InputA", ::streamfx::obs::gs::effect_parameter::type::Texture)) {
+						_effect->get_parameter("InputA").set_texture(_output_alpha);
+					}
+					if (_effect->has_parameter("InputB", ::streamfx::obs::gs::effect_parameter::type::Texture)) {
+						_effect->get_parameter("InputB").set_texture(_temporal_mask);
+					}
+					if (_effect->has_parameter("TemporalFactor", ::streamfx::obs::gs::effect_parameter::type::Float)) {
+						_effect->get_parameter("TemporalFactor").set_float(_temporal_smoothing);
+					}
+					while (gs_effect_loop(_effect->get_object(), "TemporalBlend")) {
+						gs_draw_sprite(nullptr, 0, 1, 1);
+					}
+
+					gs_blend_state_pop();
+					gs_matrix_pop();
+				}
+				_output_alpha   = rt->get_texture();
+				_temporal_index = (_temporal_index + 1) % 2;
+			}
+			_temporal_mask = _output_alpha;
+		}
+
+		if (guided && (_output_alpha != _output_color)) { // Solve the guided filter at mask resolution.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+			::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Guide"};
+#endif
+			auto op = _coefficients->render(_output_alpha->get_width(), _output_alpha->get_height());
+			gs_matrix_push();
+			gs_ortho(0., 1., 0., 1., 0., 1.);
+
+			gs_blend_state_push();
+			gs_enable_color(true, true, true, true);
+			gs_enable_blending(false);
+			gs_enable_depth_test(false);
+			gs_enable_stencil_test(false);
+			gs_set_cull_mode(GS_NEITHER);
+
+			if (_effect->has_parameter("InputA", ::streamfx::obs::gs::effect_parameter::type::Texture)) {
+				_effect->get_parameter("InputA").set_texture(_output_color);
+			}
+			if (_effect->has_parameter("InputB", ::streamfx::obs::gs::effect_parameter::type::Texture)) {
+				_effect->get_parameter("InputB").set_texture(_output_alpha);
+			}
+			if (_effect->has_parameter("MaskTexel", ::streamfx::obs::gs::effect_parameter::type::Float2)) {
+				_effect->get_parameter("MaskTexel").set_float2(1.f / static_cast<float>(_output_alpha->get_width()), 1.f / static_cast<float>(_output_alpha->get_height()));
+			}
+			while (gs_effect_loop(_effect->get_object(), "GuidedCoefficients")) {
+				gs_draw_sprite(nullptr, 0, 1, 1);
+			}
+
+			gs_blend_state_pop();
+			gs_matrix_pop();
+
+			_output_coefficients = _coefficients->get_texture();
+		}
+
+		_dirty       = false;
+		_share_dirty = true;
+	}
+
+	// Others only get to use the output if it is kept around, so draw it into a render target of its own first.
+	std::optional<::streamfx::obs::gs::rendertarget_op> share_op;
+	if (!_share_name.empty() && _share_dirty) {
+		if (!_share_rt) {
+			_share_rt = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+		}
+		share_op.emplace(_share_rt->render(_size.first, _size.second));
+		gs_ortho(0., static_cast<float>(_size.first), 0., static_cast<float>(_size.second), -1., 1.);
+		gs_clear(GS_CLEAR_COLOR, &blank, 0, 0);
+		::streamfx::obs::gs::push_blend_state(::streamfx::obs::gs::blend_preset::REPLACE);
 	}
 
-	{ // Draw the result for the next filter to use.
+	if (share_op || _share_name.empty()) { // Draw the result for the next filter to use.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_render, "Render"};
 #endif
@@ -334,7 +572,36 @@ void virtual_greenscreen_instance::video_render(gs_effect_t* effect)
 		if (_effect->has_parameter("ThresholdRange", ::streamfx::obs::gs::effect_parameter::type::Float)) {
 			_effect->get_parameter("ThresholdRange").set_float(.333333);
 		}
-		while (gs_effect_loop(_effect->get_object(), "DrawAlphaThreshold")) {
+		if (_output_coefficients) {
+			if (_effect->has_parameter("InputC", ::streamfx::obs::gs::effect_parameter::type::Texture)) {
+				_effect->get_parameter("InputC").set_texture(_output_coefficients);
+			}
+			if (_effect->has_parameter("MaskTexel", ::streamfx::obs::gs::effect_parameter::type::Float2)) {
+				_effect->get_parameter("MaskTexel").set_float2(1.f / static_cast<float>(_output_coefficients->get_width()), 1.f / static_cast<float>(_output_coefficients->get_height()));
+			}
+			while (gs_effect_loop(_effect->get_object(), "DrawAlphaThresholdGuided")) {
+				gs_draw_sprite(nullptr, 0, _size.first, _size.second);
+			}
+		} else {
+			while (gs_effect_loop(_effect->get_object(), "DrawAlphaThreshold")) {
+				gs_draw_sprite(nullptr, 0, _size.first, _size.second);
+			}
+		}
+	}
+
+	if (share_op) {
+		gs_blend_state_pop();
+		share_op.reset();
+		_share_dirty = false;
+	}
+
+	if (!_share_name.empty() && _share_rt) {
+		// Published every frame, even if the mask was reused, so that others know it is still being updated.
+		_shared_masks->publish(_share_name, this, _share_rt);
+
+		gs_effect_t* default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+		gs_effect_set_texture(gs_effect_get_param_by_name(default_effect, "image"), _share_rt->get_object());
+		while (gs_effect_loop(default_effect, "Draw")) {
 			gs_draw_sprite(nullptr, 0, _size.first, _size.second);
 		}
 	}
@@ -378,7 +645,7 @@ void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::switch
 	_provider     = provider;
 
 	// Then spawn a new task to switch provider.
-	_provider_task = streamfx::threadpool()->push(std::bind(&virtual_greenscreen_instance::task_switch_provider, this, std::placeholders::_1), spd);
+	_provider_task = streamfx::threadpool()->push(std::bind(&virtual_greenscreen_instance::task_switch_provider, this, std::placeholders::_1), spd, ::streamfx::util::threadpool::priority::BACKGROUND);
 }
 
 void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::task_switch_provider(util::threadpool::task_data_t data)
@@ -433,7 +700,7 @@ void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::task_s
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
 void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxgs_load()
 {
-	_nvidia_fx = std::make_shared<::streamfx::nvidia::vfx::greenscreen>();
+	_nvidia_fx = ::streamfx::nvidia::warmup::get()->take<::streamfx::nvidia::vfx::greenscreen>();
 }
 
 void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxgs_unload()
@@ -441,25 +708,44 @@ void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxg
 	_nvidia_fx.reset();
 }
 
-void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxgs_size()
+void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxgs_size(std::pair<uint32_t, uint32_t>& size)
+{
+	if (!_nvidia_fx) {
+		return;
+	}
+
+	_nvidia_fx->size(size);
+}
+
+void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxgs_process(std::shared_ptr<::streamfx::obs::gs::texture> in, std::shared_ptr<::streamfx::obs::gs::texture>& color, std::shared_ptr<::streamfx::obs::gs::texture>& alpha)
 {
 	if (!_nvidia_fx) {
 		return;
 	}
 
-	_nvidia_fx->size(_size);
+	alpha = _nvidia_fx->process(in, color);
+	color = _nvidia_fx->get_color();
 }
 
-void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxgs_process(std::shared_ptr<::streamfx::obs::gs::texture>& color, std::shared_ptr<::streamfx::obs::gs::texture>& alpha)
+void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxgs_delay(std::shared_ptr<::streamfx::obs::gs::texture>& color)
 {
 	if (!_nvidia_fx) {
 		return;
 	}
 
-	alpha = _nvidia_fx->process(_input->get_texture());
+	_nvidia_fx->delay(color);
 	color = _nvidia_fx->get_color();
 }
 
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxgs_input(std::pair<uint32_t, uint32_t> size)
+{
+	if (!_nvidia_fx) {
+		return nullptr;
+	}
+
+	return _nvidia_fx->get_input(size);
+}
+
 void streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance::nvvfxgs_properties(obs_properties_t* props)
 {
 	obs_properties_t* grp = obs_properties_create();
@@ -493,25 +779,12 @@ virtual_greenscreen_factory::virtual_greenscreen_factory()
 
 	// 1. Try and load any configured providers.
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
-	try {
-		// Load CVImage and Video Effects SDK.
-		_nvcuda           = ::streamfx::nvidia::cuda::obs::get();
-		_nvcvi            = ::streamfx::nvidia::cv::cv::get();
-		_nvvfx            = ::streamfx::nvidia::vfx::vfx::get();
-		_nvidia_available = true;
-		any_available |= _nvidia_available;
-	} catch (const std::exception& ex) {
-		_nvidia_available = false;
-		_nvvfx.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA Greenscreen available due to error: %s", ex.what());
-	} catch (...) {
-		_nvidia_available = false;
-		_nvvfx.reset();
-		_nvcvi.reset();
-		_nvcuda.reset();
-		D_LOG_WARNING("Failed to make NVIDIA Greenscreen available.", nullptr);
+	// Only look for the SDK here. It is loaded once a filter actually uses it, so that OBS doesn't pay for it on
+	// every start.
+	_nvidia_available = ::streamfx::nvidia::vfx::vfx::is_available();
+	any_available |= _nvidia_available;
+	if (!_nvidia_available) {
+		D_LOG_WARNING("Failed to make NVIDIA Greenscreen available, as the SDK is not installed.", nullptr);
 	}
 #endif
 
@@ -538,6 +811,10 @@ const char* virtual_greenscreen_factory::get_name()
 void virtual_greenscreen_factory::get_defaults2(obs_data_t* data)
 {
 	obs_data_set_default_int(data, ST_KEY_PROVIDER, static_cast<int64_t>(virtual_greenscreen_provider::AUTOMATIC));
+	obs_data_set_default_int(data, ST_KEY_RESOLUTION, 0);
+	obs_data_set_default_int(data, ST_KEY_TEMPORAL_INTERVAL, 1);
+	obs_data_set_default_double(data, ST_KEY_TEMPORAL_SMOOTHING, 0.);
+	obs_data_set_default_string(data, ST_KEY_SHARE, "");
 
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
 	obs_data_set_default_int(data, ST_KEY_NVIDIA_GREENSCREEN_MODE, static_cast<int64_t>(::streamfx::nvidia::vfx::greenscreen_mode::QUALITY));
@@ -571,6 +848,29 @@ obs_properties_t* virtual_greenscreen_factory::get_properties2(virtual_greenscre
 		data->properties(pr);
 	}
 
+	{
+		auto p = obs_properties_add_list(pr, ST_KEY_RESOLUTION, D_TRANSLATE(ST_I18N_RESOLUTION), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+		obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_RESOLUTION_FULL), 0);
+		obs_property_list_add_int(p, "512px", 512);
+		obs_property_list_add_int(p, "768px", 768);
+		obs_property_list_add_int(p, "1024px", 1024);
+	}
+
+	{
+		auto p = obs_properties_add_int_slider(pr, ST_KEY_TEMPORAL_INTERVAL, D_TRANSLATE(ST_I18N_TEMPORAL_INTERVAL), 1, 4, 1);
+		obs_property_int_set_suffix(p, " frames");
+	}
+
+	{
+		auto p = obs_properties_add_float_slider(pr, ST_KEY_TEMPORAL_SMOOTHING, D_TRANSLATE(ST_I18N_TEMPORAL_SMOOTHING), 0., 100., .01);
+		obs_property_float_set_suffix(p, " %");
+	}
+
+	{
+		auto p = obs_properties_add_text(pr, ST_KEY_SHARE, D_TRANSLATE(ST_I18N_SHARE), OBS_TEXT_DEFAULT);
+		obs_property_set_long_description(p, D_TRANSLATE(ST_I18N_SHARE ".Description"));
+	}
+
 	{ // Advanced Settings
 		auto grp = obs_properties_create();
 		obs_properties_add_group(pr, S_ADVANCED, D_TRANSLATE(S_ADVANCED), OBS_GROUP_NORMAL, grp);
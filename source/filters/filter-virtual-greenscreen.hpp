@@ -3,6 +3,8 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "gfx/gfx-qos.hpp"
+#include "gfx/gfx-shared-mask.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
@@ -14,10 +16,12 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <string>
 #include "warning-enable.hpp"
 
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
 #include "nvidia/vfx/nvidia-vfx-greenscreen.hpp"
+#include "nvidia/nvidia-warmup.hpp"
 #endif
 
 namespace streamfx::filter::virtual_greenscreen {
@@ -31,7 +35,7 @@ namespace streamfx::filter::virtual_greenscreen {
 
 	std::string string(virtual_greenscreen_provider provider);
 
-	class virtual_greenscreen_instance : public ::streamfx::obs::source_instance {
+	class virtual_greenscreen_instance final : public ::streamfx::obs::source_instance {
 		std::pair<uint32_t, uint32_t> _size;
 
 		std::atomic<virtual_greenscreen_provider> _provider;
@@ -40,6 +44,8 @@ namespace streamfx::filter::virtual_greenscreen {
 		std::mutex                                _provider_lock;
 		std::shared_ptr<util::threadpool::task>   _provider_task;
 
+		std::shared_ptr<::streamfx::gfx::qos> _qos;
+
 		std::shared_ptr<::streamfx::obs::gs::effect>  _effect;
 		std::shared_ptr<::streamfx::obs::gs::sampler> _channel0_sampler;
 		std::shared_ptr<::streamfx::obs::gs::sampler> _channel1_sampler;
@@ -47,8 +53,27 @@ namespace streamfx::filter::virtual_greenscreen {
 		std::shared_ptr<::streamfx::obs::gs::rendertarget> _input;
 		std::shared_ptr<::streamfx::obs::gs::texture>      _output_color;
 		std::shared_ptr<::streamfx::obs::gs::texture>      _output_alpha;
+		std::shared_ptr<::streamfx::obs::gs::texture>      _output_coefficients;
 		bool                                               _dirty;
 
+		uint32_t                                           _resolution;
+		std::pair<uint32_t, uint32_t>                      _reduced_size;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _reduced;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _coefficients;
+
+		uint32_t                                           _temporal_interval;
+		float_t                                            _temporal_smoothing;
+		uint32_t                                           _temporal_frame;
+		std::pair<uint32_t, uint32_t>                      _temporal_size;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _temporal[2];
+		std::size_t                                        _temporal_index;
+		std::shared_ptr<::streamfx::obs::gs::texture>      _temporal_mask;
+
+		std::shared_ptr<::streamfx::gfx::shared_masks>     _shared_masks;
+		std::string                                        _share_name; // Others find the output under this name, if any.
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _share_rt;
+		bool                                               _share_dirty;
+
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
 		std::shared_ptr<::streamfx::nvidia::vfx::greenscreen> _nvidia_fx;
 #endif
@@ -66,28 +91,32 @@ namespace streamfx::filter::virtual_greenscreen {
 		uint32_t get_height() override;
 
 		void video_tick(float_t time) override;
+		bool video_tick_skip_hidden() override;
 		void video_render(gs_effect_t* effect) override;
+		void prepare() override;
 
 		private:
+		void allocate();
+
 		void switch_provider(virtual_greenscreen_provider provider);
 		void task_switch_provider(util::threadpool::task_data_t data);
 
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
 		void nvvfxgs_load();
 		void nvvfxgs_unload();
-		void nvvfxgs_size();
-		void nvvfxgs_process(std::shared_ptr<::streamfx::obs::gs::texture>& color, std::shared_ptr<::streamfx::obs::gs::texture>& alpha);
+		void nvvfxgs_size(std::pair<uint32_t, uint32_t>& size);
+		void nvvfxgs_process(std::shared_ptr<::streamfx::obs::gs::texture> in, std::shared_ptr<::streamfx::obs::gs::texture>& color, std::shared_ptr<::streamfx::obs::gs::texture>& alpha);
+		void nvvfxgs_delay(std::shared_ptr<::streamfx::obs::gs::texture>& color);
 		void nvvfxgs_properties(obs_properties_t* props);
 		void nvvfxgs_update(obs_data_t* data);
+
+		std::shared_ptr<::streamfx::obs::gs::texture> nvvfxgs_input(std::pair<uint32_t, uint32_t> size);
 #endif
 	};
 
 	class virtual_greenscreen_factory : public ::streamfx::obs::source_factory<::streamfx::filter::virtual_greenscreen::virtual_greenscreen_factory, ::streamfx::filter::virtual_greenscreen::virtual_greenscreen_instance> {
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
-		bool                                           _nvidia_available;
-		std::shared_ptr<::streamfx::nvidia::cuda::obs> _nvcuda;
-		std::shared_ptr<::streamfx::nvidia::cv::cv>    _nvcvi;
-		std::shared_ptr<::streamfx::nvidia::vfx::vfx>  _nvvfx;
+		bool _nvidia_available;
 #endif
 
 		public:
@@ -8,6 +8,8 @@
 #include <stdexcept>
 #include "warning-enable.hpp"
 
+streamfx::gfx::blur::base::base() : _precision(::streamfx::gfx::blur::precision::Automatic) {}
+
 void streamfx::gfx::blur::base::set_step_scale_x(double_t v)
 {
 	this->set_step_scale(v, this->get_step_scale_y());
@@ -32,6 +34,59 @@ double_t streamfx::gfx::blur::base::get_step_scale_y()
 	return y;
 }
 
+void streamfx::gfx::blur::base::set_precision(::streamfx::gfx::blur::precision precision)
+{
+	_precision = precision;
+}
+
+::streamfx::gfx::blur::precision streamfx::gfx::blur::base::get_precision()
+{
+	return _precision;
+}
+
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::base::render_capture(const capture_t&, uint32_t, uint32_t, gs_color_format)
+{
+	return nullptr;
+}
+
+gs_color_format streamfx::gfx::blur::base::get_color_format(gs_color_format input)
+{
+	switch (_precision) {
+	case ::streamfx::gfx::blur::precision::Low:
+		return GS_RGBA;
+	case ::streamfx::gfx::blur::precision::Half:
+		return GS_RGBA16F;
+	case ::streamfx::gfx::blur::precision::Full:
+		return GS_RGBA32F;
+	default:
+		break;
+	}
+
+	// Anything beyond 8-bit is visually indistinguishable from the input at 16-bit, at half the bandwidth of 32-bit.
+	switch (input) {
+	case GS_R10G10B10A2:
+	case GS_RGBA16:
+	case GS_R16:
+	case GS_RGBA16F:
+	case GS_RGBA32F:
+	case GS_RG16F:
+	case GS_RG32F:
+	case GS_R16F:
+	case GS_R32F:
+	case GS_RG16:
+		return GS_RGBA16F;
+	default:
+		return GS_RGBA;
+	}
+}
+
+void streamfx::gfx::blur::base::update_rendertarget(std::shared_ptr<::streamfx::obs::gs::rendertarget>& target, gs_color_format format)
+{
+	if (!target || (target->get_color_format() != format)) {
+		target = std::make_shared<::streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+	}
+}
+
 void streamfx::gfx::blur::base_center::set_center_x(double_t v)
 {
 	this->set_center(v, this->get_center_y());
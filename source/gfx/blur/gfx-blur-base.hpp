@@ -4,8 +4,13 @@
 
 #pragma once
 #include "common.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
 
+#include "warning-disable.hpp"
+#include <functional>
+#include "warning-enable.hpp"
+
 namespace streamfx::gfx {
 	namespace blur {
 		enum class type : int64_t {
@@ -16,8 +21,23 @@ namespace streamfx::gfx {
 			Zoom,
 		};
 
+		/** Format of the render targets used in between and for the result of blur passes. */
+		enum class precision : int64_t {
+			Automatic, // 16-bit floating point for high precision input, otherwise 8-bit.
+			Low,       // 8-bit per channel.
+			Half,      // 16-bit floating point per channel.
+			Full,      // 32-bit floating point per channel.
+		};
+
 		class base {
+			protected:
+			::streamfx::gfx::blur::precision _precision;
+
 			public:
+			/** Draws the input with the given effect and technique at its full size into the current render target. */
+			typedef std::function<void(gs_effect_t* effect, const char* technique)> capture_t;
+
+			base();
 			virtual ~base() {}
 
 			virtual void set_input(std::shared_ptr<::streamfx::obs::gs::texture> texture) = 0;
@@ -42,7 +62,25 @@ namespace streamfx::gfx {
 
 			virtual std::shared_ptr<::streamfx::obs::gs::texture> render() = 0;
 
+			/** Blur an input of width by height in the given format, which capture draws during the first pass.
+			 *
+			 * Saves drawing the input into a texture of its own only for the first pass to read it once. Returns nullptr
+			 * without calling capture if this blur can't do that, in which case the input has to go through set_input.
+			 */
+			virtual std::shared_ptr<::streamfx::obs::gs::texture> render_capture(const capture_t& capture, uint32_t width, uint32_t height, gs_color_format format);
+
 			virtual std::shared_ptr<::streamfx::obs::gs::texture> get() = 0;
+
+			virtual void set_precision(::streamfx::gfx::blur::precision precision);
+
+			virtual ::streamfx::gfx::blur::precision get_precision();
+
+			protected:
+			/** Color format to render in for the given input format. */
+			gs_color_format get_color_format(gs_color_format input);
+
+			/** Recreate the render target if it is not in the given format. */
+			void update_rendertarget(std::shared_ptr<::streamfx::obs::gs::rendertarget>& target, gs_color_format format);
 		};
 
 		class base_angle {
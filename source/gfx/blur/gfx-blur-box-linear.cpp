@@ -16,7 +16,7 @@
 
 #define ST_MAX_BLUR_SIZE 128 // Also change this in box-linear.effect if modified.
 
-streamfx::gfx::blur::box_linear_data::box_linear_data() : _gfx_util(::streamfx::gfx::util::get())
+streamfx::gfx::blur::box_linear_data::box_linear_data() : _gfx_util(::streamfx::gfx::util::get()), _rendertarget_pool(::streamfx::gfx::rendertarget_pool::get())
 {
 	auto gctx = streamfx::obs::gs::context();
 	{
@@ -40,6 +40,11 @@ std::shared_ptr<streamfx::gfx::util> streamfx::gfx::blur::box_linear_data::get_g
 	return _gfx_util;
 }
 
+std::shared_ptr<streamfx::gfx::rendertarget_pool> streamfx::gfx::blur::box_linear_data::get_rendertarget_pool()
+{
+	return _rendertarget_pool;
+}
+
 streamfx::obs::gs::effect streamfx::gfx::blur::box_linear_data::get_effect()
 {
 	return _effect;
@@ -175,8 +180,7 @@ std::shared_ptr<::streamfx::gfx::blur::box_linear_data> streamfx::gfx::blur::box
 
 streamfx::gfx::blur::box_linear::box_linear() : _data(::streamfx::gfx::blur::box_linear_factory::get().data()), _size(1.), _step_scale({1., 1.})
 {
-	_rendertarget  = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-	_rendertarget2 = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	_rendertarget = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 }
 
 streamfx::gfx::blur::box_linear::~box_linear() {}
@@ -236,6 +240,9 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_linear::r
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Box Linear Blur");
 #endif
 
+	gs_color_format format = get_color_format(_input_texture->get_color_format());
+	update_rendertarget(_rendertarget, format);
+
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
@@ -243,18 +250,17 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_linear::r
 	gs_enable_color(true, true, true, true);
 	gs_enable_depth_test(false);
 	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
 	// Two Pass Blur
 	streamfx::obs::gs::effect effect = _data->get_effect();
 	if (effect) {
+		// Both passes use the same technique, so only look it up once.
+		auto technique = effect.get_technique("Draw");
+
+		// Only needed in between the two passes, so borrow it from the pool.
+		auto scratch = _data->get_rendertarget_pool()->acquire(format, uint32_t(width), uint32_t(height));
+
 		// Pass 1
 		effect.get_parameter("pImage").set_texture(_input_texture);
 		effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width), 0.f);
@@ -267,15 +273,13 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_linear::r
 			auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Horizontal");
 #endif
 
-			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
+			auto op = scratch->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
-			while (gs_effect_loop(effect.get_object(), "Draw")) {
-				_data->get_gfx_util()->draw_fullscreen_triangle();
-			}
+			technique.draw([this]() { _data->get_gfx_util()->draw_fullscreen_triangle(); });
 		}
 
 		// Pass 2
-		effect.get_parameter("pImage").set_texture(_rendertarget2->get_texture());
+		effect.get_parameter("pImage").set_texture(scratch->get_texture());
 		effect.get_parameter("pImageTexel").set_float2(0., float_t(1.f / height));
 
 		{
@@ -285,9 +289,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_linear::r
 
 			auto op = _rendertarget->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
-			while (gs_effect_loop(effect.get_object(), "Draw")) {
-				_data->get_gfx_util()->draw_fullscreen_triangle();
-			}
+			technique.draw([this]() { _data->get_gfx_util()->draw_fullscreen_triangle(); });
 		}
 	}
 
@@ -326,21 +328,13 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_linear_di
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Box Linear Directional Blur");
 #endif
 
+	gs_color_format format = get_color_format(_input_texture->get_color_format());
+	update_rendertarget(_rendertarget, format);
+
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_color(true, true, true, true);
-	gs_enable_blending(false);
-	gs_enable_depth_test(false);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_set_cull_mode(GS_NEITHER);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
 	// One Pass Blur
 	streamfx::obs::gs::effect effect = _data->get_effect();
@@ -5,6 +5,7 @@
 
 #include "gfx-blur-box.hpp"
 #include "common.hpp"
+#include "gfx-blur-pyramid.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "plugin.hpp"
 
@@ -15,8 +16,10 @@
 #include "warning-enable.hpp"
 
 #define ST_MAX_BLUR_SIZE 128 // Also change this in box.effect if modified.
+#define ST_PYRAMID_MIN_SIZE 16 // Smallest kernel a reduced image is blurred with, box blurs show the reduction earlier.
+#define ST_PYRAMID_MAX_LEVELS 3
 
-streamfx::gfx::blur::box_data::box_data() : _gfx_util(::streamfx::gfx::util::get())
+streamfx::gfx::blur::box_data::box_data() : _gfx_util(::streamfx::gfx::util::get()), _rendertarget_pool(::streamfx::gfx::rendertarget_pool::get())
 {
 	auto gctx = streamfx::obs::gs::context();
 	{
@@ -40,6 +43,11 @@ std::shared_ptr<streamfx::gfx::util> streamfx::gfx::blur::box_data::get_gfx_util
 	return _gfx_util;
 }
 
+std::shared_ptr<streamfx::gfx::rendertarget_pool> streamfx::gfx::blur::box_data::get_rendertarget_pool()
+{
+	return _rendertarget_pool;
+}
+
 streamfx::obs::gs::effect streamfx::gfx::blur::box_data::get_effect()
 {
 	return _effect;
@@ -184,9 +192,8 @@ std::shared_ptr<::streamfx::gfx::blur::box_data> streamfx::gfx::blur::box_factor
 
 streamfx::gfx::blur::box::box() : _data(::streamfx::gfx::blur::box_factory::get().data()), _size(1.), _step_scale({1., 1.})
 {
-	auto gctx      = streamfx::obs::gs::context();
-	_rendertarget  = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-	_rendertarget2 = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	auto gctx     = streamfx::obs::gs::context();
+	_rendertarget = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 }
 
 streamfx::gfx::blur::box::~box() {}
@@ -246,46 +253,60 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box::render()
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Box Blur");
 #endif
 
-	float_t width  = float_t(_input_texture->get_width());
-	float_t height = float_t(_input_texture->get_height());
+	gs_color_format format = get_color_format(_input_texture->get_color_format());
+	update_rendertarget(_rendertarget, format);
+
+	// Wide blurs are done on a smaller copy of the image, see gfx-blur-pyramid.hpp.
+	std::size_t levels     = pyramid::calculate_levels(_size, ST_PYRAMID_MIN_SIZE, ST_PYRAMID_MAX_LEVELS);
+	double_t    size       = _size / static_cast<double_t>(1ull << levels);
+	uint32_t    out_width  = _input_texture->get_width();
+	uint32_t    out_height = _input_texture->get_height();
+	float_t     width      = float_t(pyramid::calculate_size(out_width, levels));
+	float_t     height     = float_t(pyramid::calculate_size(out_height, levels));
 
 	gs_set_cull_mode(GS_NEITHER);
 	gs_enable_color(true, true, true, true);
 	gs_enable_depth_test(false);
 	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
 	// Two Pass Blur
 	streamfx::obs::gs::effect effect = _data->get_effect();
 	if (effect) {
+		// Both passes use the same technique, so only look it up once.
+		auto technique = effect.get_technique("Draw");
+
+		auto                                               pool  = _data->get_rendertarget_pool();
+		std::shared_ptr<::streamfx::obs::gs::texture>      image = _input_texture;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> source;
+		if (levels > 0) {
+			source = pyramid::downsample(pool, _data->get_gfx_util(), _input_texture, levels, format);
+			image  = source->get_texture();
+		}
+
+		// Only needed in between the two passes, so borrow it from the pool.
+		auto scratch = pool->acquire(format, uint32_t(width), uint32_t(height));
+		auto target  = (levels > 0) ? pool->acquire(format, uint32_t(width), uint32_t(height)) : _rendertarget;
+
 		// Pass 1
-		effect.get_parameter("pImage").set_texture(_input_texture);
+		effect.get_parameter("pImage").set_texture(image);
 		effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width), 0.f);
 		effect.get_parameter("pStepScale").set_float2(float_t(_step_scale.first), float_t(_step_scale.second));
-		effect.get_parameter("pSize").set_float(float_t(_size));
-		effect.get_parameter("pSizeInverseMul").set_float(float_t(1.0f / (float_t(_size) * 2.0f + 1.0f)));
+		effect.get_parameter("pSize").set_float(float_t(size));
+		effect.get_parameter("pSizeInverseMul").set_float(float_t(1.0f / (float_t(size) * 2.0f + 1.0f)));
 
 		{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Horizontal");
 #endif
 
-			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
+			auto op = scratch->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
-			while (gs_effect_loop(effect.get_object(), "Draw")) {
-				_data->get_gfx_util()->draw_fullscreen_triangle();
-			}
+			technique.draw([this]() { _data->get_gfx_util()->draw_fullscreen_triangle(); });
 		}
 
 		// Pass 2
-		effect.get_parameter("pImage").set_texture(_rendertarget2->get_texture());
+		effect.get_parameter("pImage").set_texture(scratch->get_texture());
 		effect.get_parameter("pImageTexel").set_float2(0.f, float_t(1.f / height));
 
 		{
@@ -293,11 +314,13 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box::render()
 			auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Vertical");
 #endif
 
-			auto op = _rendertarget->render(uint32_t(width), uint32_t(height));
+			auto op = target->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
-			while (gs_effect_loop(effect.get_object(), "Draw")) {
-				_data->get_gfx_util()->draw_fullscreen_triangle();
-			}
+			technique.draw([this]() { _data->get_gfx_util()->draw_fullscreen_triangle(); });
+		}
+
+		if (levels > 0) {
+			pyramid::upsample(_data->get_gfx_util(), target->get_texture(), _rendertarget, out_width, out_height);
 		}
 	}
 
@@ -336,21 +359,13 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_direction
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Box Directional Blur");
 #endif
 
+	gs_color_format format = get_color_format(_input_texture->get_color_format());
+	update_rendertarget(_rendertarget, format);
+
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_color(true, true, true, true);
-	gs_enable_blending(false);
-	gs_enable_depth_test(false);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_set_cull_mode(GS_NEITHER);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
 	// One Pass Blur
 	streamfx::obs::gs::effect effect = _data->get_effect();
@@ -410,21 +425,13 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_rotationa
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Box Rotational Blur");
 #endif
 
+	gs_color_format format = get_color_format(_input_texture->get_color_format());
+	update_rendertarget(_rendertarget, format);
+
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_color(true, true, true, true);
-	gs_enable_blending(false);
-	gs_enable_depth_test(false);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_set_cull_mode(GS_NEITHER);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
 	// One Pass Blur
 	streamfx::obs::gs::effect effect = _data->get_effect();
@@ -476,21 +483,13 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_zoom::ren
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Box Zoom Blur");
 #endif
 
+	gs_color_format format = get_color_format(_input_texture->get_color_format());
+	update_rendertarget(_rendertarget, format);
+
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_color(true, true, true, true);
-	gs_enable_blending(false);
-	gs_enable_depth_test(false);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_set_cull_mode(GS_NEITHER);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
 	// One Pass Blur
 	streamfx::obs::gs::effect effect = _data->get_effect();
@@ -5,6 +5,7 @@
 #pragma once
 #include "common.hpp"
 #include "gfx-blur-base.hpp"
+#include "gfx/gfx-rendertarget-pool.hpp"
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
@@ -17,8 +18,9 @@
 namespace streamfx::gfx {
 	namespace blur {
 		class box_data {
-			streamfx::obs::gs::effect            _effect;
-			std::shared_ptr<streamfx::gfx::util> _gfx_util;
+			streamfx::obs::gs::effect                         _effect;
+			std::shared_ptr<streamfx::gfx::util>              _gfx_util;
+			std::shared_ptr<streamfx::gfx::rendertarget_pool> _rendertarget_pool;
 
 			public:
 			box_data();
@@ -26,6 +28,8 @@ namespace streamfx::gfx {
 
 			std::shared_ptr<streamfx::gfx::util> get_gfx_util();
 
+			std::shared_ptr<streamfx::gfx::rendertarget_pool> get_rendertarget_pool();
+
 			streamfx::obs::gs::effect get_effect();
 		};
 
@@ -82,9 +86,6 @@ namespace streamfx::gfx {
 			std::shared_ptr<::streamfx::obs::gs::texture>      _input_texture;
 			std::shared_ptr<::streamfx::obs::gs::rendertarget> _rendertarget;
 
-			private:
-			std::shared_ptr<::streamfx::obs::gs::rendertarget> _rendertarget2;
-
 			public:
 			box();
 			virtual ~box() override;
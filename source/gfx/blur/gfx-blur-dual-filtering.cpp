@@ -33,7 +33,7 @@
 
 #define ST_MAX_LEVELS 16
 
-streamfx::gfx::blur::dual_filtering_data::dual_filtering_data() : _gfx_util(::streamfx::gfx::util::get())
+streamfx::gfx::blur::dual_filtering_data::dual_filtering_data() : _gfx_util(::streamfx::gfx::util::get()), _rendertarget_pool(::streamfx::gfx::rendertarget_pool::get())
 {
 	auto gctx = streamfx::obs::gs::context();
 	{
@@ -43,12 +43,20 @@ streamfx::gfx::blur::dual_filtering_data::dual_filtering_data() : _gfx_util(::st
 		} catch (const std::exception& ex) {
 			DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
 		}
+
+		// Without this variant, the input is copied into a texture before it is blurred.
+		try {
+			_capture_effect = streamfx::obs::gs::effect(file, {"BLUR_CAPTURE"});
+		} catch (const std::exception& ex) {
+			DLOG_ERROR("Error loading variant 'BLUR_CAPTURE' of '%s': %s", file.generic_u8string().c_str(), ex.what());
+		}
 	}
 }
 
 streamfx::gfx::blur::dual_filtering_data::~dual_filtering_data()
 {
 	auto gctx = streamfx::obs::gs::context();
+	_capture_effect.reset();
 	_effect.reset();
 }
 
@@ -57,11 +65,21 @@ std::shared_ptr<streamfx::gfx::util> streamfx::gfx::blur::dual_filtering_data::g
 	return _gfx_util;
 }
 
+std::shared_ptr<streamfx::gfx::rendertarget_pool> streamfx::gfx::blur::dual_filtering_data::get_rendertarget_pool()
+{
+	return _rendertarget_pool;
+}
+
 streamfx::obs::gs::effect streamfx::gfx::blur::dual_filtering_data::get_effect()
 {
 	return _effect;
 }
 
+streamfx::obs::gs::effect streamfx::gfx::blur::dual_filtering_data::get_capture_effect()
+{
+	return _capture_effect;
+}
+
 streamfx::gfx::blur::dual_filtering_factory::dual_filtering_factory() {}
 
 streamfx::gfx::blur::dual_filtering_factory::~dual_filtering_factory() {}
@@ -171,16 +189,10 @@ std::shared_ptr<::streamfx::gfx::blur::dual_filtering_data> streamfx::gfx::blur:
 streamfx::gfx::blur::dual_filtering::dual_filtering() : _data(::streamfx::gfx::blur::dual_filtering_factory::get().data()), _size(0), _iterations(0)
 {
 	auto gctx = streamfx::obs::gs::context();
+
+	// Only the final result is kept, all smaller levels are borrowed from the pool while rendering.
 	_rts.resize(ST_MAX_LEVELS + 1);
-	for (std::size_t n = 0; n <= ST_MAX_LEVELS; n++) {
-		gs_color_format cf = GS_RGBA;
-#if 0
-		cf = GS_RGBA16F;
-#elif 0
-		cf = GS_RGBA32F;
-#endif
-		_rts[n] = std::make_shared<streamfx::obs::gs::rendertarget>(cf, GS_ZS_NONE);
-	}
+	_rts[0] = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 }
 
 streamfx::gfx::blur::dual_filtering::~dual_filtering() {}
@@ -211,6 +223,21 @@ void streamfx::gfx::blur::dual_filtering::set_step_scale(double_t, double_t) {}
 void streamfx::gfx::blur::dual_filtering::get_step_scale(double_t&, double_t&) {}
 
 std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::dual_filtering::render()
+{
+	return render_input({}, _input_texture->get_width(), _input_texture->get_height(), _input_texture->get_color_format());
+}
+
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::dual_filtering::render_capture(const capture_t& capture, uint32_t width, uint32_t height, gs_color_format format)
+{
+	// Without at least one level, the result is the input itself.
+	if ((_iterations == 0) || ((width >> 1) == 0) || ((height >> 1) == 0) || !_data->get_effect() || !_data->get_capture_effect()) {
+		return nullptr;
+	}
+
+	return render_input(capture, width, height, format);
+}
+
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::dual_filtering::render_input(const capture_t& capture, uint32_t width, uint32_t height, gs_color_format input_format)
 {
 	auto gctx = streamfx::obs::gs::context();
 
@@ -218,27 +245,17 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::dual_filterin
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Dual-Filtering Blur");
 #endif
 
+	gs_color_format format = get_color_format(input_format);
+	update_rendertarget(_rts[0], format);
+
 	auto effect = _data->get_effect();
 	if (!effect) {
-		return _input_texture;
+		return capture ? nullptr : _input_texture;
 	}
 
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_color(true, true, true, true);
-	gs_enable_blending(false);
-	gs_enable_depth_test(false);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_set_cull_mode(GS_NEITHER);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
-
-	uint32_t width      = _input_texture->get_width();
-	uint32_t height     = _input_texture->get_height();
-	size_t   iterations = _iterations;
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
+
+	size_t iterations = _iterations;
 
 	// Downsample
 	for (std::size_t n = 1; n <= iterations; n++) {
@@ -262,16 +279,24 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::dual_filterin
 			break;
 		}
 
-		// Apply
-		effect.get_parameter("pImage").set_texture(tex);
-		effect.get_parameter("pImageSize").set_float2(static_cast<float>(owidth), static_cast<float>(oheight));
-		effect.get_parameter("pImageTexel").set_float2(0.5f / static_cast<float>(owidth), 0.5f / static_cast<float>(oheight));
+		// Apply, where the first level may read straight from the capture.
+		bool from_capture = capture && (n == 1);
+		auto level        = from_capture ? _data->get_capture_effect() : effect;
+		_rts[n]           = _data->get_rendertarget_pool()->acquire(format, owidth, oheight);
+		level.get_parameter("pImageSize").set_float2(static_cast<float>(owidth), static_cast<float>(oheight));
+		level.get_parameter("pImageTexel").set_float2(0.5f / static_cast<float>(owidth), 0.5f / static_cast<float>(oheight));
 
 		{
 			auto op = _rts[n]->render(owidth, oheight);
-			gs_ortho(0., 1., 0., 1., 0., 1.);
-			while (gs_effect_loop(effect.get_object(), "Down")) {
-				_data->get_gfx_util()->draw_fullscreen_triangle();
+			if (from_capture) {
+				gs_ortho(0., static_cast<float>(width), 0., static_cast<float>(height), -1., 1.);
+				capture(level.get_object(), "Down");
+			} else {
+				effect.get_parameter("pImage").set_texture(tex);
+				gs_ortho(0., 1., 0., 1., 0., 1.);
+				while (gs_effect_loop(effect.get_object(), "Down")) {
+					_data->get_gfx_util()->draw_fullscreen_triangle();
+				}
 			}
 		}
 	}
@@ -307,6 +332,11 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::dual_filterin
 
 	gs_blend_state_pop();
 
+	// Return the smaller levels, so that other blurs can use them.
+	for (std::size_t n = 1; n <= ST_MAX_LEVELS; n++) {
+		_rts[n].reset();
+	}
+
 	return _rts[0]->get_texture();
 }
 
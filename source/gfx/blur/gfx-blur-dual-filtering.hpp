@@ -5,6 +5,7 @@
 #pragma once
 #include "common.hpp"
 #include "gfx-blur-base.hpp"
+#include "gfx/gfx-rendertarget-pool.hpp"
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
@@ -18,8 +19,10 @@
 namespace streamfx::gfx {
 	namespace blur {
 		class dual_filtering_data {
-			streamfx::obs::gs::effect            _effect;
-			std::shared_ptr<streamfx::gfx::util> _gfx_util;
+			streamfx::obs::gs::effect                         _effect;
+			streamfx::obs::gs::effect                         _capture_effect; // Reads "image" instead of "pImage".
+			std::shared_ptr<streamfx::gfx::util>              _gfx_util;
+			std::shared_ptr<streamfx::gfx::rendertarget_pool> _rendertarget_pool;
 
 			public:
 			dual_filtering_data();
@@ -27,7 +30,11 @@ namespace streamfx::gfx {
 
 			std::shared_ptr<streamfx::gfx::util> get_gfx_util();
 
+			std::shared_ptr<streamfx::gfx::rendertarget_pool> get_rendertarget_pool();
+
 			streamfx::obs::gs::effect get_effect();
+
+			streamfx::obs::gs::effect get_capture_effect();
 		};
 
 		class dual_filtering_factory : public ::streamfx::gfx::blur::ifactory {
@@ -102,7 +109,13 @@ namespace streamfx::gfx {
 
 			virtual std::shared_ptr<::streamfx::obs::gs::texture> render() override;
 
+			virtual std::shared_ptr<::streamfx::obs::gs::texture> render_capture(const capture_t& capture, uint32_t width, uint32_t height, gs_color_format format) override;
+
 			virtual std::shared_ptr<::streamfx::obs::gs::texture> get() override;
+
+			private:
+			/** Blur of either the input texture, or of what capture draws if it isn't empty. */
+			std::shared_ptr<::streamfx::obs::gs::texture> render_input(const capture_t& capture, uint32_t width, uint32_t height, gs_color_format input_format);
 		};
 	} // namespace blur
 } // namespace streamfx::gfx
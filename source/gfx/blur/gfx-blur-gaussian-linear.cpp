@@ -22,7 +22,68 @@
 #define ST_SEARCH_EXTENSION 1
 #define ST_SEARCH_RANGE ST_MAX_KERNEL_SIZE * 2
 
-streamfx::gfx::blur::gaussian_linear_data::gaussian_linear_data() : _gfx_util(::streamfx::gfx::util::get())
+struct kernel_table {
+	std::vector<std::vector<float_t>> weights;
+	std::vector<std::vector<float_t>> offsets;
+};
+
+static kernel_table const& get_kernel_table()
+{
+	// Kernels only depend on their size, so they are calculated once for the whole process and shared from then on.
+	static const kernel_table table = []() {
+		kernel_table table;
+		table.weights.reserve(ST_MAX_BLUR_SIZE);
+		table.offsets.reserve(ST_MAX_BLUR_SIZE);
+
+		// Precalculate Kernels
+		for (std::size_t kernel_size = 1; kernel_size <= ST_MAX_BLUR_SIZE; kernel_size++) {
+			std::vector<double_t> kernel_math(ST_MAX_KERNEL_SIZE);
+			std::vector<float_t>  kernel_data(ST_MAX_KERNEL_SIZE);
+			std::vector<float_t>  offset_data(ST_MAX_KERNEL_SIZE);
+			double_t              actual_width = 1.;
+
+			// Find actual kernel width.
+			for (double_t h = ST_SEARCH_DENSITY; h < ST_SEARCH_RANGE; h += ST_SEARCH_DENSITY) {
+				if (streamfx::util::math::gaussian<double_t>(double_t(kernel_size + ST_SEARCH_EXTENSION), h) > ST_SEARCH_THRESHOLD) {
+					actual_width = h;
+					break;
+				}
+			}
+
+			// Calculate and normalize
+			double_t sum = 0;
+			for (std::size_t p = 0; p <= kernel_size; p++) {
+				kernel_math[p] = streamfx::util::math::gaussian<double_t>(double_t(p), actual_width);
+				sum += kernel_math[p] * (p > 0 ? 2 : 1);
+			}
+
+			// Normalize to fill the entire 0..1 range over the width.
+			double_t inverse_sum = 1.0 / sum;
+			for (std::size_t p = 0; p <= kernel_size; p++) {
+				kernel_data.at(p) = float_t(kernel_math[p] * inverse_sum);
+			}
+
+			// A single linear sample between texel p and p + 1 weighs both correctly if it is placed closer to the heavier
+			// one, so store where that is for every pair the shader samples.
+			for (std::size_t p = 1; p < kernel_size; p += 2) {
+				double_t weight = kernel_math[p] + kernel_math[p + 1];
+				if (weight > std::numeric_limits<double_t>::epsilon()) {
+					offset_data.at(p) = float_t((kernel_math[p] * double_t(p) + kernel_math[p + 1] * double_t(p + 1)) / weight);
+				} else {
+					offset_data.at(p) = float_t(double_t(p) + 0.5);
+				}
+			}
+
+			table.weights.push_back(std::move(kernel_data));
+			table.offsets.push_back(std::move(offset_data));
+		}
+
+		return table;
+	}();
+	return table;
+}
+
+streamfx::gfx::blur::gaussian_linear_data::gaussian_linear_data() : _gfx_util(::streamfx::gfx::util::get()), _rendertarget_pool(::streamfx::gfx::rendertarget_pool::get())
 {
 	{
 		auto gctx = streamfx::obs::gs::context();
@@ -37,35 +98,8 @@ streamfx::gfx::blur::gaussian_linear_data::gaussian_linear_data() : _gfx_util(::
 		}
 	}
 
-	// Precalculate Kernels
-	for (std::size_t kernel_size = 1; kernel_size <= ST_MAX_BLUR_SIZE; kernel_size++) {
-		std::vector<double_t> kernel_math(ST_MAX_KERNEL_SIZE);
-		std::vector<float_t>  kernel_data(ST_MAX_KERNEL_SIZE);
-		double_t              actual_width = 1.;
-
-		// Find actual kernel width.
-		for (double_t h = ST_SEARCH_DENSITY; h < ST_SEARCH_RANGE; h += ST_SEARCH_DENSITY) {
-			if (streamfx::util::math::gaussian<double_t>(double_t(kernel_size + ST_SEARCH_EXTENSION), h) > ST_SEARCH_THRESHOLD) {
-				actual_width = h;
-				break;
-			}
-		}
-
-		// Calculate and normalize
-		double_t sum = 0;
-		for (std::size_t p = 0; p <= kernel_size; p++) {
-			kernel_math[p] = streamfx::util::math::gaussian<double_t>(double_t(p), actual_width);
-			sum += kernel_math[p] * (p > 0 ? 2 : 1);
-		}
-
-		// Normalize to fill the entire 0..1 range over the width.
-		double_t inverse_sum = 1.0 / sum;
-		for (std::size_t p = 0; p <= kernel_size; p++) {
-			kernel_data.at(p) = float_t(kernel_math[p] * inverse_sum);
-		}
-
-		_kernels.push_back(std::move(kernel_data));
-	}
+	// Make sure that the kernels are ready before the first frame is rendered.
+	get_kernel_table();
 }
 
 streamfx::gfx::blur::gaussian_linear_data::~gaussian_linear_data()
@@ -85,7 +119,13 @@ std::vector<float_t> const& streamfx::gfx::blur::gaussian_linear_data::get_kerne
 	if (width > ST_MAX_BLUR_SIZE)
 		width = ST_MAX_BLUR_SIZE;
 	width -= 1;
-	return _kernels[width];
+	return get_kernel_table().weights[width];
+}
+
+std::vector<float_t> const& streamfx::gfx::blur::gaussian_linear_data::get_kernel_offsets(std::size_t width)
+{
+	width = std::clamp<std::size_t>(width, 1, ST_MAX_BLUR_SIZE);
+	return get_kernel_table().offsets[width - 1];
 }
 
 std::shared_ptr<streamfx::gfx::util> streamfx::gfx::blur::gaussian_linear_data::get_gfx_util()
@@ -93,6 +133,11 @@ std::shared_ptr<streamfx::gfx::util> streamfx::gfx::blur::gaussian_linear_data::
 	return _gfx_util;
 }
 
+std::shared_ptr<streamfx::gfx::rendertarget_pool> streamfx::gfx::blur::gaussian_linear_data::get_rendertarget_pool()
+{
+	return _rendertarget_pool;
+}
+
 streamfx::gfx::blur::gaussian_linear_factory::gaussian_linear_factory() {}
 
 streamfx::gfx::blur::gaussian_linear_factory::~gaussian_linear_factory() {}
@@ -225,8 +270,7 @@ streamfx::gfx::blur::gaussian_linear::gaussian_linear() : _data(::streamfx::gfx:
 {
 	auto gctx = streamfx::obs::gs::context();
 
-	_rendertarget  = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-	_rendertarget2 = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	_rendertarget = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 }
 
 streamfx::gfx::blur::gaussian_linear::~gaussian_linear() {}
@@ -285,13 +329,20 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Gaussian Linear Blur");
 #endif
 
+	gs_color_format format = get_color_format(_input_texture->get_color_format());
+	update_rendertarget(_rendertarget, format);
+
 	streamfx::obs::gs::effect effect = _data->get_effect();
 	auto                      kernel = _data->get_kernel(size_t(_size));
+	auto                      offset = _data->get_kernel_offsets(size_t(_size));
 
 	if (!effect || ((_step_scale.first + _step_scale.second) < std::numeric_limits<double_t>::epsilon())) {
 		return _input_texture;
 	}
 
+	// Both passes use the same technique, so only look it up once.
+	auto technique = effect.get_technique("Draw");
+
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
@@ -300,22 +351,25 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 	gs_enable_color(true, true, true, true);
 	gs_enable_depth_test(false);
 	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
 	effect.get_parameter("pImage").set_texture(_input_texture);
 	effect.get_parameter("pStepScale").set_float2(float_t(_step_scale.first), float_t(_step_scale.second));
 	effect.get_parameter("pSize").set_float(float_t(_size));
 	effect.get_parameter("pKernel").set_value(kernel.data(), ST_MAX_KERNEL_SIZE);
+	effect.get_parameter("pKernelOffset").set_value(offset.data(), ST_MAX_KERNEL_SIZE);
+
+	// Only the final result is kept in our own render target, the first of two passes borrows one from the pool.
+	bool                                               vertical = _step_scale.second > std::numeric_limits<double_t>::epsilon();
+	std::shared_ptr<::streamfx::obs::gs::rendertarget> scratch;
 
 	// First Pass
 	if (_step_scale.first > std::numeric_limits<double_t>::epsilon()) {
+		if (vertical) {
+			scratch = _data->get_rendertarget_pool()->acquire(format, uint32_t(width), uint32_t(height));
+		}
+		auto target = vertical ? scratch : _rendertarget;
+
 		effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width), 0.f);
 
 		{
@@ -323,19 +377,16 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 			auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Horizontal");
 #endif
 
-			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
+			auto op = target->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
-			while (gs_effect_loop(effect.get_object(), "Draw")) {
-				_data->get_gfx_util()->draw_fullscreen_triangle();
-			}
+			technique.draw([this]() { _data->get_gfx_util()->draw_fullscreen_triangle(); });
 		}
 
-		std::swap(_rendertarget, _rendertarget2);
-		effect.get_parameter("pImage").set_texture(_rendertarget->get_texture());
+		effect.get_parameter("pImage").set_texture(target->get_texture());
 	}
 
 	// Second Pass
-	if (_step_scale.second > std::numeric_limits<double_t>::epsilon()) {
+	if (vertical) {
 		effect.get_parameter("pImageTexel").set_float2(0.f, float_t(1.f / height));
 
 		{
@@ -343,14 +394,10 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 			auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Vertical");
 #endif
 
-			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
+			auto op = _rendertarget->render(uint32_t(width), uint32_t(height));
 			gs_ortho(0, 1., 0, 1., 0, 1.);
-			while (gs_effect_loop(effect.get_object(), "Draw")) {
-				_data->get_gfx_util()->draw_fullscreen_triangle();
-			}
+			technique.draw([this]() { _data->get_gfx_util()->draw_fullscreen_triangle(); });
 		}
-
-		std::swap(_rendertarget, _rendertarget2);
 	}
 
 	gs_blend_state_pop();
@@ -390,8 +437,12 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Gaussian Linear Directional Blur");
 #endif
 
+	gs_color_format format = get_color_format(_input_texture->get_color_format());
+	update_rendertarget(_rendertarget, format);
+
 	streamfx::obs::gs::effect effect = _data->get_effect();
 	auto                      kernel = _data->get_kernel(size_t(_size));
+	auto                      offset = _data->get_kernel_offsets(size_t(_size));
 
 	if (!effect || ((_step_scale.first + _step_scale.second) < std::numeric_limits<double_t>::epsilon())) {
 		return _input_texture;
@@ -405,20 +456,14 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 	gs_enable_color(true, true, true, true);
 	gs_enable_depth_test(false);
 	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
 	effect.get_parameter("pImage").set_texture(_input_texture);
 	effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width * cos(_angle)), float_t(1.f / height * sin(_angle)));
 	effect.get_parameter("pStepScale").set_float2(float_t(_step_scale.first), float_t(_step_scale.second));
 	effect.get_parameter("pSize").set_float(float_t(_size));
 	effect.get_parameter("pKernel").set_value(kernel.data(), ST_MAX_KERNEL_SIZE);
+	effect.get_parameter("pKernelOffset").set_value(offset.data(), ST_MAX_KERNEL_SIZE);
 
 	// First Pass
 	{
@@ -5,6 +5,7 @@
 #pragma once
 #include "common.hpp"
 #include "gfx-blur-base.hpp"
+#include "gfx/gfx-rendertarget-pool.hpp"
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
@@ -18,9 +19,9 @@
 namespace streamfx::gfx {
 	namespace blur {
 		class gaussian_linear_data {
-			streamfx::obs::gs::effect            _effect;
-			std::shared_ptr<streamfx::gfx::util> _gfx_util;
-			std::vector<std::vector<float_t>>    _kernels;
+			streamfx::obs::gs::effect                         _effect;
+			std::shared_ptr<streamfx::gfx::util>              _gfx_util;
+			std::shared_ptr<streamfx::gfx::rendertarget_pool> _rendertarget_pool;
 
 			public:
 			gaussian_linear_data();
@@ -28,9 +29,14 @@ namespace streamfx::gfx {
 
 			std::shared_ptr<streamfx::gfx::util> get_gfx_util();
 
+			std::shared_ptr<streamfx::gfx::rendertarget_pool> get_rendertarget_pool();
+
 			streamfx::obs::gs::effect get_effect();
 
 			std::vector<float_t> const& get_kernel(std::size_t width);
+
+			/** Where to sample in between texel n and n + 1, for every odd n. */
+			std::vector<float_t> const& get_kernel_offsets(std::size_t width);
 		};
 
 		class gaussian_linear_factory : public ::streamfx::gfx::blur::ifactory {
@@ -86,9 +92,6 @@ namespace streamfx::gfx {
 			std::shared_ptr<::streamfx::obs::gs::texture>      _input_texture;
 			std::shared_ptr<::streamfx::obs::gs::rendertarget> _rendertarget;
 
-			private:
-			std::shared_ptr<::streamfx::obs::gs::rendertarget> _rendertarget2;
-
 			public:
 			gaussian_linear();
 			virtual ~gaussian_linear() override;
@@ -5,6 +5,7 @@
 
 #include "gfx-blur-gaussian.hpp"
 #include "common.hpp"
+#include "gfx-blur-pyramid.hpp"
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "plugin.hpp"
@@ -19,14 +20,78 @@
 #define ST_KERNEL_SIZE 128u
 #define ST_OVERSAMPLE_MULTIPLIER 2
 #define ST_MAX_BLUR_SIZE ST_KERNEL_SIZE / ST_OVERSAMPLE_MULTIPLIER
+#define ST_PYRAMID_MIN_SIZE 8 // Smallest kernel a reduced image is blurred with.
+#define ST_PYRAMID_MAX_LEVELS 3
 
-streamfx::gfx::blur::gaussian_data::gaussian_data() : _gfx_util(::streamfx::gfx::util::get())
+static std::vector<std::vector<float_t>> const& get_kernels()
 {
-	using namespace streamfx::util;
+	// Kernels only depend on their size, so they are calculated once for the whole process and shared from then on.
+	static const std::vector<std::vector<float_t>> kernels = []() {
+		using namespace streamfx::util;
 
-	std::array<double, ST_KERNEL_SIZE> kernel_dbl;
-	std::vector<float>                 kernel(ST_KERNEL_SIZE);
+		std::vector<std::vector<float_t>>  kernels;
+		std::array<double, ST_KERNEL_SIZE> kernel_dbl;
+		kernels.reserve(ST_MAX_BLUR_SIZE);
 
+		//#define ST_USE_PASCAL_TRIANGLE
+
+		// Pre-calculate Kernel Information for all Kernel sizes
+		for (size_t size = 1; size <= ST_MAX_BLUR_SIZE; size++) {
+			std::vector<float_t> kernel(ST_KERNEL_SIZE);
+#ifdef ST_USE_PASCAL_TRIANGLE
+			// The Pascal Triangle can be used to generate Gaussian Kernels, which is
+			// significantly faster than doing the same task with searching. It is also
+			// much more accurate at the same time, so it is a 2-in-1 solution.
+
+			// Generate the required row and sum.
+			size_t offset   = size;
+			size_t row      = size * 2;
+			auto   triangle = math::pascal_triangle<double>(row);
+			double sum      = pow(2, row);
+
+			// Convert all integers to floats.
+			double accum = 0.;
+			for (size_t idx = offset; idx < std::min<size_t>(triangle.size(), ST_KERNEL_SIZE); idx++) {
+				double v                 = static_cast<double>(triangle[idx]) / sum;
+				kernel_dbl[idx - offset] = v;
+				// Accumulator needed as we end up with float inaccuracies above a certain threshold.
+				accum += v * (idx > offset ? 2 : 1);
+			}
+
+			// Rescale all values back into useful ranges.
+			accum = 1. / accum;
+			for (size_t idx = offset; idx < ST_KERNEL_SIZE; idx++) {
+				kernel[idx - offset] = kernel_dbl[idx - offset] * accum;
+			}
+#else
+			size_t oversample = size * ST_OVERSAMPLE_MULTIPLIER;
+
+			// Generate initial weights and calculate a total from them.
+			double total = 0.;
+			for (size_t idx = 0; (idx < oversample) && (idx < ST_KERNEL_SIZE); idx++) {
+				kernel_dbl[idx] = math::gaussian<double>(static_cast<double>(idx), static_cast<double>(size));
+				total += kernel_dbl[idx] * (idx > 0 ? 2 : 1);
+			}
+
+			// Scale the weights according to the total gathered, and convert to float.
+			for (size_t idx = 0; (idx < oversample) && (idx < ST_KERNEL_SIZE); idx++) {
+				kernel_dbl[idx] /= total;
+				kernel[idx] = static_cast<float>(kernel_dbl[idx]);
+			}
+
+#endif
+
+			// Store Kernel
+			kernels.push_back(std::move(kernel));
+		}
+
+		return kernels;
+	}();
+	return kernels;
+}
+
+streamfx::gfx::blur::gaussian_data::gaussian_data() : _gfx_util(::streamfx::gfx::util::get()), _rendertarget_pool(::streamfx::gfx::rendertarget_pool::get())
+{
 	{
 		auto gctx = streamfx::obs::gs::context();
 
@@ -37,64 +102,24 @@ streamfx::gfx::blur::gaussian_data::gaussian_data() : _gfx_util(::streamfx::gfx:
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
 			}
-		}
-	}
-
-	//#define ST_USE_PASCAL_TRIANGLE
-
-	// Pre-calculate Kernel Information for all Kernel sizes
-	for (size_t size = 1; size <= ST_MAX_BLUR_SIZE; size++) {
-#ifdef ST_USE_PASCAL_TRIANGLE
-		// The Pascal Triangle can be used to generate Gaussian Kernels, which is
-		// significantly faster than doing the same task with searching. It is also
-		// much more accurate at the same time, so it is a 2-in-1 solution.
-
-		// Generate the required row and sum.
-		size_t offset   = size;
-		size_t row      = size * 2;
-		auto   triangle = math::pascal_triangle<double>(row);
-		double sum      = pow(2, row);
-
-		// Convert all integers to floats.
-		double accum = 0.;
-		for (size_t idx = offset; idx < std::min<size_t>(triangle.size(), ST_KERNEL_SIZE); idx++) {
-			double v                 = static_cast<double>(triangle[idx]) / sum;
-			kernel_dbl[idx - offset] = v;
-			// Accumulator needed as we end up with float inaccuracies above a certain threshold.
-			accum += v * (idx > offset ? 2 : 1);
-		}
-
-		// Rescale all values back into useful ranges.
-		accum = 1. / accum;
-		for (size_t idx = offset; idx < ST_KERNEL_SIZE; idx++) {
-			kernel[idx - offset] = kernel_dbl[idx - offset] * accum;
-		}
-#else
-		size_t oversample = size * ST_OVERSAMPLE_MULTIPLIER;
 
-		// Generate initial weights and calculate a total from them.
-		double total = 0.;
-		for (size_t idx = 0; (idx < oversample) && (idx < ST_KERNEL_SIZE); idx++) {
-			kernel_dbl[idx] = math::gaussian<double>(static_cast<double>(idx), static_cast<double>(size));
-			total += kernel_dbl[idx] * (idx > 0 ? 2 : 1);
-		}
-
-		// Scale the weights according to the total gathered, and convert to float.
-		for (size_t idx = 0; (idx < oversample) && (idx < ST_KERNEL_SIZE); idx++) {
-			kernel_dbl[idx] /= total;
-			kernel[idx] = static_cast<float>(kernel_dbl[idx]);
+			// Without this variant, the input is copied into a texture before it is blurred.
+			try {
+				_capture_effect = streamfx::obs::gs::effect(file, {"BLUR_CAPTURE"});
+			} catch (const std::exception& ex) {
+				DLOG_ERROR("Error loading variant 'BLUR_CAPTURE' of '%s': %s", file.generic_u8string().c_str(), ex.what());
+			}
 		}
-
-#endif
-
-		// Store Kernel
-		_kernels.insert_or_assign(size, kernel);
 	}
+
+	// Make sure that the kernels are ready before the first frame is rendered.
+	get_kernels();
 }
 
 streamfx::gfx::blur::gaussian_data::~gaussian_data()
 {
 	auto gctx = streamfx::obs::gs::context();
+	_capture_effect.reset();
 	_effect.reset();
 }
 
@@ -103,15 +128,25 @@ streamfx::obs::gs::effect streamfx::gfx::blur::gaussian_data::get_effect()
 	return _effect;
 }
 
+streamfx::obs::gs::effect streamfx::gfx::blur::gaussian_data::get_capture_effect()
+{
+	return _capture_effect;
+}
+
 std::shared_ptr<streamfx::gfx::util> streamfx::gfx::blur::gaussian_data::get_gfx_util()
 {
 	return _gfx_util;
 }
 
+std::shared_ptr<streamfx::gfx::rendertarget_pool> streamfx::gfx::blur::gaussian_data::get_rendertarget_pool()
+{
+	return _rendertarget_pool;
+}
+
 std::vector<float_t> const& streamfx::gfx::blur::gaussian_data::get_kernel(std::size_t width)
 {
 	width = std::clamp<size_t>(width, 1, ST_MAX_BLUR_SIZE);
-	return _kernels.at(width);
+	return get_kernels().at(width - 1);
 }
 
 streamfx::gfx::blur::gaussian_factory::gaussian_factory() {}
@@ -253,9 +288,8 @@ std::shared_ptr<::streamfx::gfx::blur::gaussian_data> streamfx::gfx::blur::gauss
 
 streamfx::gfx::blur::gaussian::gaussian() : _data(::streamfx::gfx::blur::gaussian_factory::get().data()), _size(1.), _step_scale({1., 1.})
 {
-	auto gctx      = streamfx::obs::gs::context();
-	_rendertarget  = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-	_rendertarget2 = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	auto gctx     = streamfx::obs::gs::context();
+	_rendertarget = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 }
 
 streamfx::gfx::blur::gaussian::~gaussian() {}
@@ -307,6 +341,25 @@ double_t streamfx::gfx::blur::gaussian::get_step_scale_y()
 }
 
 std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian::render()
+{
+	return render_input({}, _input_texture->get_width(), _input_texture->get_height(), _input_texture->get_color_format());
+}
+
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian::render_capture(const capture_t& capture, uint32_t width, uint32_t height, gs_color_format format)
+{
+	// Only the first pass may capture, which has to exist and must not depend on anything but the input.
+	if ((get_type() != ::streamfx::gfx::blur::type::Area) || !_data->get_effect() || !_data->get_capture_effect()) {
+		return nullptr;
+	}
+	bool downsample = pyramid::calculate_levels(_size, ST_PYRAMID_MIN_SIZE, ST_PYRAMID_MAX_LEVELS) > 0;
+	if (!downsample && (_step_scale.first <= std::numeric_limits<double_t>::epsilon())) {
+		return nullptr;
+	}
+
+	return render_input(capture, width, height, format);
+}
+
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian::render_input(const capture_t& capture, uint32_t out_width, uint32_t out_height, gs_color_format input_format)
 {
 	auto gctx = streamfx::obs::gs::context();
 
@@ -314,57 +367,87 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian::ren
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Gaussian Blur");
 #endif
 
+	gs_color_format format = get_color_format(input_format);
+	update_rendertarget(_rendertarget, format);
+
 	streamfx::obs::gs::effect effect = _data->get_effect();
 
 	if (!effect || ((_step_scale.first + _step_scale.second) < std::numeric_limits<double_t>::epsilon())) {
-		return _input_texture;
+		return capture ? nullptr : _input_texture;
 	}
 
-	auto    kernel = _data->get_kernel(size_t(_size));
-	float_t width  = float_t(_input_texture->get_width());
-	float_t height = float_t(_input_texture->get_height());
+	// Both passes use the same technique, so only look it up once.
+	auto technique = effect.get_technique("Draw");
+
+	// libobs offers no compute shaders, so the cost of a large kernel can only be cut by touching fewer texels. A wide
+	// Gaussian keeps nothing a smaller copy would lose, so blur that instead with a correspondingly smaller kernel and
+	// scale the result back up with linear filtering. Each level needs an eighth of the samples of the previous one.
+	std::size_t levels     = pyramid::calculate_levels(_size, ST_PYRAMID_MIN_SIZE, ST_PYRAMID_MAX_LEVELS);
+	bool        downsample = levels > 0;
+	double_t    size       = _size / static_cast<double_t>(1ull << levels);
+	uint32_t    width      = pyramid::calculate_size(out_width, levels);
+	uint32_t    height     = pyramid::calculate_size(out_height, levels);
+	auto        kernel     = _data->get_kernel(size_t(size));
+	bool        horizontal = _step_scale.first > std::numeric_limits<double_t>::epsilon();
+	bool        vertical   = _step_scale.second > std::numeric_limits<double_t>::epsilon();
+
+	// Only the final result is kept in our own render target, everything in between is borrowed from the pool.
+	auto                                               pool   = _data->get_rendertarget_pool();
+	std::shared_ptr<::streamfx::obs::gs::texture>      image  = _input_texture;
+	std::shared_ptr<::streamfx::obs::gs::rendertarget> source;
 
 	// Setup
 	gs_set_cull_mode(GS_NEITHER);
 	gs_enable_color(true, true, true, true);
 	gs_enable_depth_test(false);
 	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
-	effect.get_parameter("pStepScale").set_float2(float_t(_step_scale.first), float_t(_step_scale.second));
-	effect.get_parameter("pSize").set_float(float_t(_size * ST_OVERSAMPLE_MULTIPLIER));
-	effect.get_parameter("pKernel").set_value(kernel.data(), ST_KERNEL_SIZE);
+	if (downsample) {
+		source = capture ? pyramid::downsample(pool, _data->get_gfx_util(), capture, out_width, out_height, levels, format) : pyramid::downsample(pool, _data->get_gfx_util(), _input_texture, levels, format);
+		image  = source->get_texture();
+	}
+
+	// Without a smaller copy to start from, the horizontal pass reads straight from the capture instead.
+	bool                      capture_first = capture && !downsample;
+	streamfx::obs::gs::effect first_effect  = capture_first ? _data->get_capture_effect() : effect;
+	for (auto pass_effect : {effect, first_effect}) {
+		pass_effect.get_parameter("pStepScale").set_float2(float_t(_step_scale.first), float_t(_step_scale.second));
+		pass_effect.get_parameter("pSize").set_float(float_t(size * ST_OVERSAMPLE_MULTIPLIER));
+		pass_effect.get_parameter("pKernel").set_value(kernel.data(), ST_KERNEL_SIZE);
+	}
 
 	// First Pass
-	if (_step_scale.first > std::numeric_limits<double_t>::epsilon()) {
-		effect.get_parameter("pImage").set_texture(_input_texture);
-		effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width), 0.f);
+	if (horizontal) {
+		auto target = (vertical || downsample) ? pool->acquire(format, width, height) : _rendertarget;
+
+		first_effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width), 0.f);
 
 		{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Horizontal");
 #endif
 
-			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
-			gs_ortho(0, 1., 0, 1., 0, 1.);
-			while (gs_effect_loop(effect.get_object(), "Draw")) {
-				_data->get_gfx_util()->draw_fullscreen_triangle();
+			auto op = target->render(width, height);
+			if (capture_first) {
+				gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), -1., 1.);
+				capture(first_effect.get_object(), "Draw");
+			} else {
+				effect.get_parameter("pImage").set_texture(image);
+				gs_ortho(0, 1., 0, 1., 0, 1.);
+				technique.draw([this]() { _data->get_gfx_util()->draw_fullscreen_triangle(); });
 			}
 		}
 
-		std::swap(_rendertarget, _rendertarget2);
+		image  = target->get_texture();
+		source = target;
 	}
 
 	// Second Pass
-	if (_step_scale.second > std::numeric_limits<double_t>::epsilon()) {
-		effect.get_parameter("pImage").set_texture(_rendertarget->get_texture());
+	if (vertical) {
+		auto target = downsample ? pool->acquire(format, width, height) : _rendertarget;
+
+		effect.get_parameter("pImage").set_texture(image);
 		effect.get_parameter("pImageTexel").set_float2(0.f, float_t(1.f / height));
 
 		{
@@ -372,14 +455,17 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian::ren
 			auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Vertical");
 #endif
 
-			auto op = _rendertarget2->render(uint32_t(width), uint32_t(height));
+			auto op = target->render(width, height);
 			gs_ortho(0, 1., 0, 1., 0, 1.);
-			while (gs_effect_loop(effect.get_object(), "Draw")) {
-				_data->get_gfx_util()->draw_fullscreen_triangle();
-			}
+			technique.draw([this]() { _data->get_gfx_util()->draw_fullscreen_triangle(); });
 		}
 
-		std::swap(_rendertarget, _rendertarget2);
+		image  = target->get_texture();
+		source = target;
+	}
+
+	if (downsample) {
+		pyramid::upsample(_data->get_gfx_util(), image, _rendertarget, out_width, out_height);
 	}
 
 	gs_blend_state_pop();
@@ -419,6 +505,9 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_dire
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Gaussian Directional Blur");
 #endif
 
+	gs_color_format format = get_color_format(_input_texture->get_color_format());
+	update_rendertarget(_rendertarget, format);
+
 	streamfx::obs::gs::effect effect = _data->get_effect();
 
 	if (!effect || ((_step_scale.first + _step_scale.second) < std::numeric_limits<double_t>::epsilon())) {
@@ -434,14 +523,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_dire
 	gs_enable_color(true, true, true, true);
 	gs_enable_depth_test(false);
 	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
 	effect.get_parameter("pImage").set_texture(_input_texture);
 	effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width * cos(m_angle)), float_t(1.f / height * sin(m_angle)));
@@ -475,6 +557,9 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_rota
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Gaussian Rotational Blur");
 #endif
 
+	gs_color_format format = get_color_format(_input_texture->get_color_format());
+	update_rendertarget(_rendertarget, format);
+
 	streamfx::obs::gs::effect effect = _data->get_effect();
 
 	if (!effect || ((_step_scale.first + _step_scale.second) < std::numeric_limits<double_t>::epsilon())) {
@@ -490,14 +575,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_rota
 	gs_enable_color(true, true, true, true);
 	gs_enable_depth_test(false);
 	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
 	effect.get_parameter("pImage").set_texture(_input_texture);
 	effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width), float_t(1.f / height));
@@ -556,6 +634,9 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_zoom
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Gaussian Zoom Blur");
 #endif
 
+	gs_color_format format = get_color_format(_input_texture->get_color_format());
+	update_rendertarget(_rendertarget, format);
+
 	streamfx::obs::gs::effect effect = _data->get_effect();
 	auto                      kernel = _data->get_kernel(size_t(_size));
 
@@ -571,14 +652,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_zoom
 	gs_enable_color(true, true, true, true);
 	gs_enable_depth_test(false);
 	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
 
 	effect.get_parameter("pImage").set_texture(_input_texture);
 	effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width), float_t(1.f / height));
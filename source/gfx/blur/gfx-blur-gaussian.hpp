@@ -5,6 +5,7 @@
 #pragma once
 #include "common.hpp"
 #include "gfx-blur-base.hpp"
+#include "gfx/gfx-rendertarget-pool.hpp"
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
@@ -18,9 +19,10 @@
 namespace streamfx::gfx {
 	namespace blur {
 		class gaussian_data {
-			streamfx::obs::gs::effect            _effect;
-			std::shared_ptr<streamfx::gfx::util> _gfx_util;
-			std::map<size_t, std::vector<float>> _kernels;
+			streamfx::obs::gs::effect                         _effect;
+			streamfx::obs::gs::effect                         _capture_effect; // Reads "image" instead of "pImage".
+			std::shared_ptr<streamfx::gfx::util>              _gfx_util;
+			std::shared_ptr<streamfx::gfx::rendertarget_pool> _rendertarget_pool;
 
 			public:
 			gaussian_data();
@@ -28,8 +30,12 @@ namespace streamfx::gfx {
 
 			streamfx::obs::gs::effect get_effect();
 
+			streamfx::obs::gs::effect get_capture_effect();
+
 			std::shared_ptr<streamfx::gfx::util> get_gfx_util();
 
+			std::shared_ptr<streamfx::gfx::rendertarget_pool> get_rendertarget_pool();
+
 			std::vector<float_t> const& get_kernel(std::size_t width);
 		};
 
@@ -86,9 +92,6 @@ namespace streamfx::gfx {
 			std::shared_ptr<::streamfx::obs::gs::texture>      _input_texture;
 			std::shared_ptr<::streamfx::obs::gs::rendertarget> _rendertarget;
 
-			private:
-			std::shared_ptr<::streamfx::obs::gs::rendertarget> _rendertarget2;
-
 			public:
 			gaussian();
 			virtual ~gaussian() override;
@@ -111,7 +114,13 @@ namespace streamfx::gfx {
 
 			virtual std::shared_ptr<::streamfx::obs::gs::texture> render() override;
 
+			virtual std::shared_ptr<::streamfx::obs::gs::texture> render_capture(const capture_t& capture, uint32_t width, uint32_t height, gs_color_format format) override;
+
 			virtual std::shared_ptr<::streamfx::obs::gs::texture> get() override;
+
+			private:
+			/** Area blur of either the input texture, or of what capture draws if it isn't empty. */
+			std::shared_ptr<::streamfx::obs::gs::texture> render_input(const capture_t& capture, uint32_t out_width, uint32_t out_height, gs_color_format input_format);
 		};
 
 		class gaussian_directional : public ::streamfx::gfx::blur::gaussian, public ::streamfx::gfx::blur::base_angle {
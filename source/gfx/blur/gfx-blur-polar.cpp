@@ -0,0 +1,394 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-blur-polar.hpp"
+#include "common.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+#define ST_MAX_BLUR_SIZE 64
+#define ST_POLAR_MIN_RADIUS 1. // Smallest radius in the logarithmic polar image, in pixels.
+#define ST_POLAR_MIN_SIZE 16. // Fewest texels along the blurred axis.
+#define ST_POLAR_MAX_SIZE 8192. // Most texels along any axis.
+#define ST_POLAR_SIGMA_TEXELS 4. // Texels covered by the standard deviation, if the polar image has room for them.
+#define ST_POLAR_MAX_SIGMA_TEXELS 8. // Also change MAX_TAPS in polar.effect if modified, which must be 3 times this.
+
+streamfx::gfx::blur::polar_data::polar_data() : _gfx_util(::streamfx::gfx::util::get()), _rendertarget_pool(::streamfx::gfx::rendertarget_pool::get())
+{
+	auto gctx = streamfx::obs::gs::context();
+	{
+		auto file = streamfx::data_file_path("effects/blur/polar.effect");
+		try {
+			_effect = streamfx::obs::gs::effect::create(file);
+		} catch (const std::exception& ex) {
+			DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
+		}
+	}
+}
+
+streamfx::gfx::blur::polar_data::~polar_data()
+{
+	auto gctx = streamfx::obs::gs::context();
+	_effect.reset();
+}
+
+std::shared_ptr<streamfx::gfx::util> streamfx::gfx::blur::polar_data::get_gfx_util()
+{
+	return _gfx_util;
+}
+
+std::shared_ptr<streamfx::gfx::rendertarget_pool> streamfx::gfx::blur::polar_data::get_rendertarget_pool()
+{
+	return _rendertarget_pool;
+}
+
+streamfx::obs::gs::effect streamfx::gfx::blur::polar_data::get_effect()
+{
+	return _effect;
+}
+
+streamfx::gfx::blur::polar_factory::polar_factory() {}
+
+streamfx::gfx::blur::polar_factory::~polar_factory() {}
+
+bool streamfx::gfx::blur::polar_factory::is_type_supported(::streamfx::gfx::blur::type type)
+{
+	switch (type) {
+	case ::streamfx::gfx::blur::type::Rotational:
+	case ::streamfx::gfx::blur::type::Zoom:
+		return true;
+	default:
+		return false;
+	}
+}
+
+std::shared_ptr<::streamfx::gfx::blur::base> streamfx::gfx::blur::polar_factory::create(::streamfx::gfx::blur::type type)
+{
+	switch (type) {
+	case ::streamfx::gfx::blur::type::Rotational:
+		return std::make_shared<::streamfx::gfx::blur::polar_rotational>();
+	case ::streamfx::gfx::blur::type::Zoom:
+		return std::make_shared<::streamfx::gfx::blur::polar_zoom>();
+	default:
+		throw std::runtime_error("Invalid type.");
+	}
+}
+
+double_t streamfx::gfx::blur::polar_factory::get_min_size(::streamfx::gfx::blur::type)
+{
+	return double_t(1.0);
+}
+
+double_t streamfx::gfx::blur::polar_factory::get_step_size(::streamfx::gfx::blur::type)
+{
+	return double_t(1.0);
+}
+
+double_t streamfx::gfx::blur::polar_factory::get_max_size(::streamfx::gfx::blur::type)
+{
+	return double_t(ST_MAX_BLUR_SIZE);
+}
+
+double_t streamfx::gfx::blur::polar_factory::get_min_angle(::streamfx::gfx::blur::type v)
+{
+	switch (v) {
+	case ::streamfx::gfx::blur::type::Rotational:
+		return -180.0;
+	default:
+		return 0;
+	}
+}
+
+double_t streamfx::gfx::blur::polar_factory::get_step_angle(::streamfx::gfx::blur::type)
+{
+	return double_t(0.01);
+}
+
+double_t streamfx::gfx::blur::polar_factory::get_max_angle(::streamfx::gfx::blur::type v)
+{
+	switch (v) {
+	case ::streamfx::gfx::blur::type::Rotational:
+		return 180.0;
+	default:
+		return 0;
+	}
+}
+
+bool streamfx::gfx::blur::polar_factory::is_step_scale_supported(::streamfx::gfx::blur::type v)
+{
+	switch (v) {
+	case ::streamfx::gfx::blur::type::Zoom:
+		return true;
+	default:
+		return false;
+	}
+}
+
+double_t streamfx::gfx::blur::polar_factory::get_min_step_scale_x(::streamfx::gfx::blur::type)
+{
+	return double_t(0.01);
+}
+
+double_t streamfx::gfx::blur::polar_factory::get_step_step_scale_x(::streamfx::gfx::blur::type)
+{
+	return double_t(0.01);
+}
+
+double_t streamfx::gfx::blur::polar_factory::get_max_step_scale_x(::streamfx::gfx::blur::type)
+{
+	return double_t(1000.0);
+}
+
+double_t streamfx::gfx::blur::polar_factory::get_min_step_scale_y(::streamfx::gfx::blur::type)
+{
+	return double_t(0.01);
+}
+
+double_t streamfx::gfx::blur::polar_factory::get_step_step_scale_y(::streamfx::gfx::blur::type)
+{
+	return double_t(0.01);
+}
+
+double_t streamfx::gfx::blur::polar_factory::get_max_step_scale_y(::streamfx::gfx::blur::type)
+{
+	return double_t(1000.0);
+}
+
+std::shared_ptr<::streamfx::gfx::blur::polar_data> streamfx::gfx::blur::polar_factory::data()
+{
+	std::unique_lock<std::mutex>                       ulock(_data_lock);
+	std::shared_ptr<::streamfx::gfx::blur::polar_data> data = _data.lock();
+	if (!data) {
+		data  = std::make_shared<::streamfx::gfx::blur::polar_data>();
+		_data = data;
+	}
+	return data;
+}
+
+::streamfx::gfx::blur::polar_factory& streamfx::gfx::blur::polar_factory::get()
+{
+	static ::streamfx::gfx::blur::polar_factory instance;
+	return instance;
+}
+
+streamfx::gfx::blur::polar::polar() : _data(::streamfx::gfx::blur::polar_factory::get().data()), _size(1.), _step_scale({1., 1.}), _center({.5, .5})
+{
+	_rendertarget = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+}
+
+streamfx::gfx::blur::polar::~polar() {}
+
+void streamfx::gfx::blur::polar::set_input(std::shared_ptr<::streamfx::obs::gs::texture> texture)
+{
+	_input_texture = std::move(texture);
+}
+
+double_t streamfx::gfx::blur::polar::get_size()
+{
+	return _size;
+}
+
+void streamfx::gfx::blur::polar::set_size(double_t width)
+{
+	_size = std::clamp<double_t>(width, 1., ST_MAX_BLUR_SIZE);
+}
+
+void streamfx::gfx::blur::polar::set_step_scale(double_t x, double_t y)
+{
+	_step_scale = {x, y};
+}
+
+void streamfx::gfx::blur::polar::get_step_scale(double_t& x, double_t& y)
+{
+	x = _step_scale.first;
+	y = _step_scale.second;
+}
+
+double_t streamfx::gfx::blur::polar::get_step_scale_x()
+{
+	return _step_scale.first;
+}
+
+double_t streamfx::gfx::blur::polar::get_step_scale_y()
+{
+	return _step_scale.second;
+}
+
+void streamfx::gfx::blur::polar::set_center(double_t x, double_t y)
+{
+	_center = {x, y};
+}
+
+void streamfx::gfx::blur::polar::get_center(double_t& x, double_t& y)
+{
+	x = _center.first;
+	y = _center.second;
+}
+
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::polar::render()
+{
+	auto gctx = streamfx::obs::gs::context();
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Polar Blur");
+#endif
+
+	gs_color_format format = get_color_format(_input_texture->get_color_format());
+	update_rendertarget(_rendertarget, format);
+
+	double_t width  = double_t(_input_texture->get_width());
+	double_t height = double_t(_input_texture->get_height());
+
+	// The polar image has to reach the corner furthest away from the center.
+	double_t cx    = _center.first * width;
+	double_t cy    = _center.second * height;
+	double_t r_max = std::max({std::hypot(cx, cy), std::hypot(width - cx, cy), std::hypot(cx, height - cy), std::hypot(width - cx, height - cy), ST_POLAR_MIN_RADIUS * 2.});
+	double_t r_log = std::log(r_max / ST_POLAR_MIN_RADIUS);
+	double_t sigma = std::max(get_sigma(width), 0.000001);
+
+	// Along the blurred axis, the polar image only gets as many texels as the blur needs to look smooth, which is what
+	// keeps the blur short. The other axis has to keep the detail of the image, but is capped so that the outer edge of
+	// large images ends up slightly softer instead of exceeding texture size limits.
+	double_t angles = std::min(std::ceil(S_PI2 * r_max), ST_POLAR_MAX_SIZE);
+	double_t radii  = 0.;
+	double_t texels = 0.;
+	if (is_angular()) {
+		radii  = std::min(std::ceil(r_max), ST_POLAR_MAX_SIZE);
+		angles = std::clamp(std::ceil(S_PI2 * ST_POLAR_SIGMA_TEXELS / sigma), ST_POLAR_MIN_SIZE, std::max(angles, ST_POLAR_MIN_SIZE));
+		texels = sigma * angles / S_PI2;
+	} else {
+		radii  = std::min(std::ceil(r_log * r_max), ST_POLAR_MAX_SIZE);
+		radii  = std::clamp(std::ceil(r_log * ST_POLAR_SIGMA_TEXELS / sigma), ST_POLAR_MIN_SIZE, std::max(radii, ST_POLAR_MIN_SIZE));
+		texels = sigma * radii / r_log;
+	}
+	texels = std::min(texels, ST_POLAR_MAX_SIGMA_TEXELS);
+
+	gs_set_cull_mode(GS_NEITHER);
+	gs_enable_color(true, true, true, true);
+	gs_enable_depth_test(false);
+	gs_depth_function(GS_ALWAYS);
+	streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
+
+	streamfx::obs::gs::effect effect = _data->get_effect();
+	if (effect) {
+		// Only needed in between the passes, so borrow them from the pool.
+		auto to_polar = _data->get_rendertarget_pool()->acquire(format, uint32_t(angles), uint32_t(radii));
+		auto blurred  = _data->get_rendertarget_pool()->acquire(format, uint32_t(angles), uint32_t(radii));
+
+		effect.get_parameter("pImageSize").set_float2(float_t(width), float_t(height));
+		effect.get_parameter("pImageTexel").set_float2(float_t(1. / width), float_t(1. / height));
+		effect.get_parameter("pCenter").set_float2(float_t(_center.first), float_t(_center.second));
+		effect.get_parameter("pPolarTexel").set_float2(float_t(1. / angles), float_t(1. / radii));
+		effect.get_parameter("pRadius").set_float4(float_t(ST_POLAR_MIN_RADIUS), float_t(r_max), float_t(r_log), is_angular() ? 0.f : 1.f);
+		if (is_angular()) {
+			effect.get_parameter("pAxis").set_float2(1.f, 0.f);
+		} else {
+			effect.get_parameter("pAxis").set_float2(0.f, 1.f);
+		}
+		effect.get_parameter("pSigma").set_float(float_t(texels));
+
+		// Pass 1
+		effect.get_parameter("pImage").set_texture(_input_texture);
+		{
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+			auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "To Polar");
+#endif
+
+			auto op = to_polar->render(uint32_t(angles), uint32_t(radii));
+			gs_ortho(0, 1., 0, 1., 0, 1.);
+			while (gs_effect_loop(effect.get_object(), "ToPolar")) {
+				_data->get_gfx_util()->draw_fullscreen_triangle();
+			}
+		}
+
+		// Pass 2
+		effect.get_parameter("pImage").set_texture(to_polar->get_texture());
+		{
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+			auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Blur");
+#endif
+
+			auto op = blurred->render(uint32_t(angles), uint32_t(radii));
+			gs_ortho(0, 1., 0, 1., 0, 1.);
+			while (gs_effect_loop(effect.get_object(), "Blur")) {
+				_data->get_gfx_util()->draw_fullscreen_triangle();
+			}
+		}
+
+		// Pass 3
+		effect.get_parameter("pImage").set_texture(blurred->get_texture());
+		{
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+			auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "From Polar");
+#endif
+
+			auto op = _rendertarget->render(uint32_t(width), uint32_t(height));
+			gs_ortho(0, 1., 0, 1., 0, 1.);
+			while (gs_effect_loop(effect.get_object(), "FromPolar")) {
+				_data->get_gfx_util()->draw_fullscreen_triangle();
+			}
+		}
+	}
+
+	gs_blend_state_pop();
+
+	return _rendertarget->get_texture();
+}
+
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::polar::get()
+{
+	return _rendertarget->get_texture();
+}
+
+streamfx::gfx::blur::polar_rotational::polar_rotational() : _angle(0) {}
+
+::streamfx::gfx::blur::type streamfx::gfx::blur::polar_rotational::get_type()
+{
+	return ::streamfx::gfx::blur::type::Rotational;
+}
+
+double_t streamfx::gfx::blur::polar_rotational::get_angle()
+{
+	return D_RAD_TO_DEG(_angle);
+}
+
+void streamfx::gfx::blur::polar_rotational::set_angle(double_t angle)
+{
+	_angle = D_DEG_TO_RAD(angle);
+}
+
+bool streamfx::gfx::blur::polar_rotational::is_angular()
+{
+	return true;
+}
+
+double_t streamfx::gfx::blur::polar_rotational::get_sigma(double_t)
+{
+	// Matches the reach of the Gaussian rotational blur, which ignores the size as well.
+	return std::abs(_angle);
+}
+
+::streamfx::gfx::blur::type streamfx::gfx::blur::polar_zoom::get_type()
+{
+	return ::streamfx::gfx::blur::type::Zoom;
+}
+
+bool streamfx::gfx::blur::polar_zoom::is_angular()
+{
+	return false;
+}
+
+double_t streamfx::gfx::blur::polar_zoom::get_sigma(double_t width)
+{
+	// The Gaussian zoom blur moves each step by a share of the distance to the center, which on a logarithmic radius is
+	// a constant distance.
+	return _size * _step_scale.first / width;
+}
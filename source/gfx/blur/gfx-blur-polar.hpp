@@ -0,0 +1,149 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gfx-blur-base.hpp"
+#include "gfx/gfx-rendertarget-pool.hpp"
+#include "gfx/gfx-util.hpp"
+#include "obs/gs/gs-effect.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <mutex>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	namespace blur {
+		class polar_data {
+			streamfx::obs::gs::effect                         _effect;
+			std::shared_ptr<streamfx::gfx::util>              _gfx_util;
+			std::shared_ptr<streamfx::gfx::rendertarget_pool> _rendertarget_pool;
+
+			public:
+			polar_data();
+			virtual ~polar_data();
+
+			std::shared_ptr<streamfx::gfx::util> get_gfx_util();
+
+			std::shared_ptr<streamfx::gfx::rendertarget_pool> get_rendertarget_pool();
+
+			streamfx::obs::gs::effect get_effect();
+		};
+
+		/** Rotational and Zoom blur that cost about as much as a small linear blur, regardless of their strength.
+		 *
+		 * The image is remapped into polar coordinates, where rotating around the center is a move along the angle and
+		 * zooming is a move along the logarithm of the radius. The polar image only needs a few texels across the blur
+		 * along that axis, so a short 1D Gaussian blur is enough, after which the result is remapped back.
+		 */
+		class polar_factory : public ::streamfx::gfx::blur::ifactory {
+			std::mutex                                       _data_lock;
+			std::weak_ptr<::streamfx::gfx::blur::polar_data> _data;
+
+			public:
+			polar_factory();
+			virtual ~polar_factory() override;
+
+			virtual bool is_type_supported(::streamfx::gfx::blur::type type) override;
+
+			virtual std::shared_ptr<::streamfx::gfx::blur::base> create(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_min_size(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_step_size(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_max_size(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_min_angle(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_step_angle(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_max_angle(::streamfx::gfx::blur::type type) override;
+
+			virtual bool is_step_scale_supported(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_min_step_scale_x(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_step_step_scale_x(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_max_step_scale_x(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_min_step_scale_y(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_step_step_scale_y(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_max_step_scale_y(::streamfx::gfx::blur::type type) override;
+
+			std::shared_ptr<::streamfx::gfx::blur::polar_data> data();
+
+			public: // Singleton
+			static ::streamfx::gfx::blur::polar_factory& get();
+		};
+
+		class polar : public ::streamfx::gfx::blur::base, public ::streamfx::gfx::blur::base_center {
+			protected:
+			std::shared_ptr<::streamfx::gfx::blur::polar_data> _data;
+
+			double_t                                           _size;
+			std::pair<double_t, double_t>                      _step_scale;
+			std::pair<double_t, double_t>                      _center;
+			std::shared_ptr<::streamfx::obs::gs::texture>      _input_texture;
+			std::shared_ptr<::streamfx::obs::gs::rendertarget> _rendertarget;
+
+			public:
+			polar();
+			virtual ~polar() override;
+
+			virtual void set_input(std::shared_ptr<::streamfx::obs::gs::texture> texture) override;
+
+			virtual double_t get_size() override;
+			virtual void     set_size(double_t width) override;
+
+			virtual void     set_step_scale(double_t x, double_t y) override;
+			virtual void     get_step_scale(double_t& x, double_t& y) override;
+			virtual double_t get_step_scale_x() override;
+			virtual double_t get_step_scale_y() override;
+
+			virtual void set_center(double_t x, double_t y) override;
+			virtual void get_center(double_t& x, double_t& y) override;
+
+			virtual std::shared_ptr<::streamfx::obs::gs::texture> render() override;
+			virtual std::shared_ptr<::streamfx::obs::gs::texture> get() override;
+
+			protected:
+			/** Whether the blur runs along the angle instead of along the radius. */
+			virtual bool is_angular() = 0;
+
+			/** Standard deviation of the blur, in radians for an angular blur, otherwise in the logarithm of the radius. */
+			virtual double_t get_sigma(double_t width) = 0;
+		};
+
+		class polar_rotational : public ::streamfx::gfx::blur::polar, public ::streamfx::gfx::blur::base_angle {
+			double_t _angle;
+
+			public:
+			polar_rotational();
+
+			virtual ::streamfx::gfx::blur::type get_type() override;
+
+			virtual double_t get_angle() override;
+			virtual void     set_angle(double_t angle) override;
+
+			protected:
+			virtual bool     is_angular() override;
+			virtual double_t get_sigma(double_t width) override;
+		};
+
+		class polar_zoom : public ::streamfx::gfx::blur::polar {
+			public:
+			virtual ::streamfx::gfx::blur::type get_type() override;
+
+			protected:
+			virtual bool     is_angular() override;
+			virtual double_t get_sigma(double_t width) override;
+		};
+	} // namespace blur
+} // namespace streamfx::gfx
@@ -0,0 +1,98 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-blur-pyramid.hpp"
+#include "obs/gs/gs-helper.hpp"
+
+std::size_t streamfx::gfx::blur::pyramid::calculate_levels(double_t size, double_t min_size, std::size_t max_levels)
+{
+	std::size_t levels = 0;
+	while ((levels < max_levels) && ((size / 2.) >= min_size)) {
+		size /= 2.;
+		levels++;
+	}
+	return levels;
+}
+
+uint32_t streamfx::gfx::blur::pyramid::calculate_size(uint32_t size, std::size_t levels)
+{
+	for (std::size_t level = 0; level < levels; level++) {
+		size = std::max<uint32_t>((size + 1) / 2, 1);
+	}
+	return size;
+}
+
+static std::shared_ptr<streamfx::obs::gs::rendertarget> halve(std::shared_ptr<::streamfx::gfx::rendertarget_pool> pool, std::shared_ptr<::streamfx::gfx::util> gfx_util, std::shared_ptr<::streamfx::obs::gs::rendertarget> level, std::shared_ptr<::streamfx::obs::gs::texture> input, uint32_t width, uint32_t height, std::size_t first, std::size_t levels, gs_color_format format)
+{
+	gs_effect_t* effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+
+	// Each level halves the previous one, where sampling in between four texels averages them for free. Halving once
+	// per level instead of scaling down in one go makes sure that no texel is skipped.
+	for (std::size_t n = first; n <= levels; n++) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Down %" PRIuMAX, n);
+#endif
+
+		width       = streamfx::gfx::blur::pyramid::calculate_size(width, 1);
+		height      = streamfx::gfx::blur::pyramid::calculate_size(height, 1);
+		auto target = pool->acquire(format, width, height);
+
+		gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), level ? level->get_object() : input->get_object());
+		{
+			auto op = target->render(width, height);
+			gs_ortho(0, 1., 0, 1., 0, 1.);
+			while (gs_effect_loop(effect, "Draw")) {
+				gfx_util->draw_fullscreen_triangle();
+			}
+		}
+
+		level = target;
+	}
+
+	return level;
+}
+
+std::shared_ptr<streamfx::obs::gs::rendertarget> streamfx::gfx::blur::pyramid::downsample(std::shared_ptr<::streamfx::gfx::rendertarget_pool> pool, std::shared_ptr<::streamfx::gfx::util> gfx_util, std::shared_ptr<::streamfx::obs::gs::texture> input, std::size_t levels, gs_color_format format)
+{
+	return halve(pool, gfx_util, nullptr, input, input->get_width(), input->get_height(), 1, levels, format);
+}
+
+std::shared_ptr<streamfx::obs::gs::rendertarget> streamfx::gfx::blur::pyramid::downsample(std::shared_ptr<::streamfx::gfx::rendertarget_pool> pool, std::shared_ptr<::streamfx::gfx::util> gfx_util, const ::streamfx::gfx::blur::base::capture_t& capture, uint32_t width, uint32_t height, std::size_t levels, gs_color_format format)
+{
+	if (levels == 0) {
+		return nullptr;
+	}
+
+	// The first level is drawn straight from the input, scaled to half of its size by the orthographic projection.
+	uint32_t                                           half_width  = calculate_size(width, 1);
+	uint32_t                                           half_height = calculate_size(height, 1);
+	std::shared_ptr<::streamfx::obs::gs::rendertarget> level       = pool->acquire(format, half_width, half_height);
+	{
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Down 1");
+#endif
+
+		auto op = level->render(half_width, half_height);
+		gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), -1., 1.);
+		capture(obs_get_base_effect(OBS_EFFECT_DEFAULT), "Draw");
+	}
+
+	return halve(pool, gfx_util, level, nullptr, half_width, half_height, 2, levels, format);
+}
+
+void streamfx::gfx::blur::pyramid::upsample(std::shared_ptr<::streamfx::gfx::util> gfx_util, std::shared_ptr<::streamfx::obs::gs::texture> input, std::shared_ptr<::streamfx::obs::gs::rendertarget> target, uint32_t width, uint32_t height)
+{
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Upsample");
+#endif
+
+	gs_effect_t* effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), input->get_object());
+
+	auto op = target->render(width, height);
+	gs_ortho(0, 1., 0, 1., 0, 1.);
+	while (gs_effect_loop(effect, "Draw")) {
+		gfx_util->draw_fullscreen_triangle();
+	}
+}
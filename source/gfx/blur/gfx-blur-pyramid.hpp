@@ -0,0 +1,36 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gfx-blur-base.hpp"
+#include "gfx/gfx-rendertarget-pool.hpp"
+#include "gfx/gfx-util.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+/* Wide blurs spend most of their time sampling texels which barely differ from their neighbours. Blurring a smaller
+ *  copy of the image with a correspondingly smaller kernel gives the same result at a fraction of the cost, as long as
+ *  the kernel stays large enough to hide the lower resolution.
+ */
+
+namespace streamfx::gfx::blur::pyramid {
+	/** How often a blur of the given size can be halved while remaining at least min_size wide. */
+	std::size_t calculate_levels(double_t size, double_t min_size, std::size_t max_levels);
+
+	/** Size of the image after halving it the given number of times. */
+	uint32_t calculate_size(uint32_t size, std::size_t levels);
+
+	/** Halve the input the given number of times, using render targets in the given format borrowed from the pool.
+	 *
+	 * @return The render target containing the smallest level, nullptr if levels is 0.
+	 */
+	std::shared_ptr<::streamfx::obs::gs::rendertarget> downsample(std::shared_ptr<::streamfx::gfx::rendertarget_pool> pool, std::shared_ptr<::streamfx::gfx::util> gfx_util, std::shared_ptr<::streamfx::obs::gs::texture> input, std::size_t levels, gs_color_format format);
+
+	/** Same as above, but the first level is drawn by capture from an input of width by height that isn't a texture yet. */
+	std::shared_ptr<::streamfx::obs::gs::rendertarget> downsample(std::shared_ptr<::streamfx::gfx::rendertarget_pool> pool, std::shared_ptr<::streamfx::gfx::util> gfx_util, const ::streamfx::gfx::blur::base::capture_t& capture, uint32_t width, uint32_t height, std::size_t levels, gs_color_format format);
+
+	/** Scale the input up to the given size with linear filtering. */
+	void upsample(std::shared_ptr<::streamfx::gfx::util> gfx_util, std::shared_ptr<::streamfx::obs::gs::texture> input, std::shared_ptr<::streamfx::obs::gs::rendertarget> target, uint32_t width, uint32_t height);
+} // namespace streamfx::gfx::blur::pyramid
@@ -0,0 +1,295 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-calibration.hpp"
+#include "configuration.hpp"
+#include "plugin.hpp"
+#include "gfx/gfx-opengl.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/obs-tools.hpp"
+#include "util/util-logging.hpp"
+#include "util/util-platform.hpp"
+#ifdef ENABLE_FILTER_BLUR
+#include "gfx/blur/gfx-blur-box-linear.hpp"
+#include "gfx/blur/gfx-blur-box.hpp"
+#endif
+
+#include "warning-disable.hpp"
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#ifdef _WIN32
+#include <Windows.h>
+#include <d3d11.h>
+#include <dxgi.h>
+#endif
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<gfx::calibration> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_CFG_CALIBRATION "Calibration"
+#define ST_CFG_CALIBRATION_DEVICE "Device"
+#define ST_CFG_CALIBRATION_BLUR_TYPE "Blur.Type"
+#define ST_CFG_CALIBRATION_BLUR_PRECISION "Blur.Precision"
+
+// Size of the image that candidates are rendered at, and how often each of them is rendered after warming up.
+constexpr uint32_t bench_width   = 1920;
+constexpr uint32_t bench_height  = 1080;
+constexpr uint32_t bench_samples = 8;
+
+// A candidate has to be at least this much faster to replace the built-in default, which hides measurement noise.
+constexpr double_t faster_ratio = 0.95;
+
+// 16-bit floating point intermediates are only given up if they cost this much more than 8-bit ones.
+constexpr double_t precision_ratio = 1.5;
+
+#ifdef ENABLE_FILTER_BLUR
+/** Wait for the GPU to finish everything up to the given texture, by reading back a single pixel of it. */
+static void finish(std::shared_ptr<streamfx::obs::gs::rendertarget>& pixel, gs_stagesurf_t* surface, std::shared_ptr<streamfx::obs::gs::texture> texture)
+{
+	{
+		auto op = pixel->render(1, 1);
+		gs_ortho(0, 1., 0, 1., 0, 1.);
+
+		gs_effect_t* effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+		gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), texture->get_object());
+		while (gs_effect_loop(effect, "Draw")) {
+			gs_draw_sprite(texture->get_object(), 0, 1, 1);
+		}
+	}
+	gs_stage_texture(surface, pixel->get_object());
+
+	uint8_t* data     = nullptr;
+	uint32_t linesize = 0;
+	if (gs_stagesurface_map(surface, &data, &linesize)) {
+		gs_stagesurface_unmap(surface);
+	}
+}
+
+/** Milliseconds it takes the blur to render the input once, after warming it up. */
+static double_t time_blur(std::shared_ptr<streamfx::gfx::blur::base> blur, std::shared_ptr<streamfx::obs::gs::texture> input, std::shared_ptr<streamfx::obs::gs::rendertarget>& pixel, gs_stagesurf_t* surface)
+{
+	blur->set_input(input);
+	blur->set_size(16.);
+	blur->set_step_scale(1., 1.);
+
+	// The first render compiles and allocates whatever the blur needs.
+	finish(pixel, surface, blur->render());
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (uint32_t n = 0; n < bench_samples; n++) {
+		blur->render();
+	}
+	finish(pixel, surface, blur->get());
+	auto duration = std::chrono::high_resolution_clock::now() - start;
+
+	return std::chrono::duration<double_t, std::milli>(duration).count() / static_cast<double_t>(bench_samples);
+}
+#endif
+
+streamfx::gfx::calibration::~calibration()
+{
+	if (_task) {
+		_task->cancel();
+		_task->wait();
+	}
+}
+
+streamfx::gfx::calibration::calibration() : _lock(), _ready(false), _device(), _task()
+{
+#ifdef ENABLE_FILTER_BLUR
+	_blur_type      = "box";
+	_blur_precision = ::streamfx::gfx::blur::precision::Automatic;
+#endif
+
+	{
+		auto gctx = streamfx::obs::gs::context();
+		_device   = identify();
+	}
+
+	auto                        config = streamfx::configuration::instance();
+	auto                        data   = config->get();
+	std::shared_ptr<obs_data_t> cfg(obs_data_get_obj(data.get(), ST_CFG_CALIBRATION), streamfx::obs::obs_data_deleter);
+	if (cfg && (_device == obs_data_get_string(cfg.get(), ST_CFG_CALIBRATION_DEVICE))) {
+#ifdef ENABLE_FILTER_BLUR
+		_blur_type      = obs_data_get_string(cfg.get(), ST_CFG_CALIBRATION_BLUR_TYPE);
+		_blur_precision = static_cast<::streamfx::gfx::blur::precision>(obs_data_get_int(cfg.get(), ST_CFG_CALIBRATION_BLUR_PRECISION));
+		if ((_blur_type != "box") && (_blur_type != "box_linear")) {
+			_blur_type = "box";
+		}
+		if ((_blur_precision != ::streamfx::gfx::blur::precision::Automatic) && (_blur_precision != ::streamfx::gfx::blur::precision::Low)) {
+			_blur_precision = ::streamfx::gfx::blur::precision::Automatic;
+		}
+#endif
+		_ready = true;
+		return;
+	}
+
+	// New adapter or driver, so measure again once the graphics thread is free to do so.
+	D_LOG_INFO("Calibrating for '%s' at the start of the next frame.", _device.c_str());
+	_task = std::make_shared<::streamfx::util::threadpool::chain>();
+	_task->then(::streamfx::util::threadpool::executor::GRAPHICS, [this]() { measure(); });
+	_task->start();
+}
+
+std::string streamfx::gfx::calibration::identify()
+{
+	std::string device = gs_get_device_name();
+
+#ifdef _WIN32
+	if (gs_get_device_type() == GS_DEVICE_DIRECT3D_11) {
+		auto          d3d     = reinterpret_cast<ID3D11Device*>(gs_get_device_obj());
+		IDXGIDevice*  dxgi    = nullptr;
+		IDXGIAdapter* adapter = nullptr;
+		if (d3d && SUCCEEDED(d3d->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&dxgi)))) {
+			if (SUCCEEDED(dxgi->GetAdapter(&adapter))) {
+				DXGI_ADAPTER_DESC desc = {};
+				LARGE_INTEGER     umd  = {};
+				adapter->GetDesc(&desc);
+				adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umd);
+
+				char ids[64];
+				snprintf(ids, sizeof(ids), " %04" PRIX32 ":%04" PRIX32 " %" PRIu32 ".%" PRIu32 ".%" PRIu32 ".%" PRIu32, static_cast<uint32_t>(desc.VendorId), static_cast<uint32_t>(desc.DeviceId), static_cast<uint32_t>(HIWORD(umd.HighPart)), static_cast<uint32_t>(LOWORD(umd.HighPart)), static_cast<uint32_t>(HIWORD(umd.LowPart)), static_cast<uint32_t>(LOWORD(umd.LowPart)));
+				device += " " + streamfx::util::platform::native_to_utf8(std::wstring(desc.Description)) + ids;
+				adapter->Release();
+			}
+			dxgi->Release();
+		}
+	}
+#endif
+	if (gs_get_device_type() == GS_DEVICE_OPENGL) {
+		auto gl = streamfx::gfx::opengl::get();
+		device += " " + std::string(gl->get_renderer()) + " " + std::string(gl->get_version());
+	}
+
+	return device;
+}
+
+void streamfx::gfx::calibration::measure()
+{
+	auto gctx = streamfx::obs::gs::context();
+
+#ifdef ENABLE_FILTER_BLUR
+	std::string                      blur_type      = "box";
+	::streamfx::gfx::blur::precision blur_precision = ::streamfx::gfx::blur::precision::Automatic;
+	gs_stagesurf_t*                  surface        = gs_stagesurface_create(1, 1, GS_RGBA);
+	if (!surface) {
+		throw std::runtime_error("Failed to create staging surface.");
+	}
+	try {
+		auto pixel = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		auto image = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		{
+			auto op   = image->render(bench_width, bench_height);
+			vec4 gray = {};
+			vec4_set(&gray, 0.5f, 0.5f, 0.5f, 1.f);
+			gs_clear(GS_CLEAR_COLOR, &gray, 0, 0);
+		}
+		auto input = image->get_texture();
+
+		auto box = ::streamfx::gfx::blur::box_factory::get().create(::streamfx::gfx::blur::type::Area);
+		box->set_precision(::streamfx::gfx::blur::precision::Low);
+		double_t box_low = time_blur(box, input, pixel, surface);
+		box->set_precision(::streamfx::gfx::blur::precision::Half);
+		double_t box_half = time_blur(box, input, pixel, surface);
+
+		auto box_linear = ::streamfx::gfx::blur::box_linear_factory::get().create(::streamfx::gfx::blur::type::Area);
+		box_linear->set_precision(::streamfx::gfx::blur::precision::Low);
+		double_t box_linear_low = time_blur(box_linear, input, pixel, surface);
+
+		if (box_linear_low < (box_low * faster_ratio)) {
+			blur_type = "box_linear";
+		}
+		if (box_half > (box_low * precision_ratio)) {
+			blur_precision = ::streamfx::gfx::blur::precision::Low;
+		}
+		D_LOG_INFO("Box blur takes %.3f ms at 8-bit and %.3f ms at 16-bit precision, Linear Box blur %.3f ms.", box_low, box_half, box_linear_low);
+	} catch (...) {
+		gs_stagesurface_destroy(surface);
+		throw;
+	}
+	gs_stagesurface_destroy(surface);
+#endif
+
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+#ifdef ENABLE_FILTER_BLUR
+		_blur_type      = blur_type;
+		_blur_precision = blur_precision;
+#endif
+		_ready = true;
+	}
+
+	// Keep the results, so that the next launch on the same adapter and driver doesn't measure again.
+	auto                        config = streamfx::configuration::instance();
+	auto                        data   = config->get();
+	std::shared_ptr<obs_data_t> cfg(obs_data_create(), streamfx::obs::obs_data_deleter);
+	obs_data_set_string(cfg.get(), ST_CFG_CALIBRATION_DEVICE, _device.c_str());
+#ifdef ENABLE_FILTER_BLUR
+	obs_data_set_string(cfg.get(), ST_CFG_CALIBRATION_BLUR_TYPE, blur_type.c_str());
+	obs_data_set_int(cfg.get(), ST_CFG_CALIBRATION_BLUR_PRECISION, static_cast<int64_t>(blur_precision));
+#endif
+	obs_data_set_obj(data.get(), ST_CFG_CALIBRATION, cfg.get());
+	config->save();
+
+	D_LOG_INFO("Calibrated for '%s'.", _device.c_str());
+}
+
+bool streamfx::gfx::calibration::is_ready()
+{
+	std::lock_guard<std::mutex> lg(_lock);
+	return _ready;
+}
+
+#ifdef ENABLE_FILTER_BLUR
+std::string streamfx::gfx::calibration::blur_type()
+{
+	std::lock_guard<std::mutex> lg(_lock);
+	return _blur_type;
+}
+
+::streamfx::gfx::blur::precision streamfx::gfx::calibration::blur_precision()
+{
+	std::lock_guard<std::mutex> lg(_lock);
+	return _blur_precision;
+}
+#endif
+
+std::shared_ptr<streamfx::gfx::calibration> streamfx::gfx::calibration::get()
+{
+	static std::weak_ptr<streamfx::gfx::calibration> instance;
+	static std::mutex                                lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (instance.expired()) {
+		auto hard_instance = std::shared_ptr<streamfx::gfx::calibration>(new streamfx::gfx::calibration());
+		instance           = hard_instance;
+		return hard_instance;
+	}
+	return instance.lock();
+}
+
+static std::shared_ptr<streamfx::gfx::calibration> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		loader_instance = streamfx::gfx::calibration::get();
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::LOW);
@@ -0,0 +1,63 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#ifdef ENABLE_FILTER_BLUR
+#include "gfx/blur/gfx-blur-base.hpp"
+#endif
+
+#include "warning-disable.hpp"
+#include <memory>
+#include <mutex>
+#include <string>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Defaults that suit the performance of this machine, measured once per graphics adapter and driver.
+	 *
+	 * Unless the global configuration already holds results for the same adapter and driver, a short benchmark runs on
+	 * the graphics thread at the start of the first frame after StreamFX was loaded. It renders each candidate a fixed
+	 * number of times at 1080p, which takes a few dozen milliseconds on most GPUs. Results are kept in the
+	 * "Calibration" object of the global configuration, and the built-in defaults apply until they are known.
+	 */
+	class calibration {
+		std::mutex  _lock;
+		bool        _ready;
+		std::string _device;
+
+#ifdef ENABLE_FILTER_BLUR
+		std::string                      _blur_type;
+		::streamfx::gfx::blur::precision _blur_precision;
+#endif
+
+		std::shared_ptr<::streamfx::util::threadpool::chain> _task;
+
+		public:
+		~calibration();
+
+		private:
+		calibration();
+
+		/** Adapter and driver version, which the results are only valid for. Graphics context required. */
+		static std::string identify();
+
+		void measure();
+
+		public:
+		/** Have the results been measured or loaded yet? */
+		bool is_ready();
+
+#ifdef ENABLE_FILTER_BLUR
+		/** Faster of the two equivalent box blurs, "box" until measured. */
+		std::string blur_type();
+
+		/** Precision for intermediate results, Low only if 16-bit floating point render targets are much slower. */
+		::streamfx::gfx::blur::precision blur_precision();
+#endif
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::gfx::calibration> get();
+	};
+} // namespace streamfx::gfx
@@ -0,0 +1,162 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-capture.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<gfx::capture> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+streamfx::gfx::input_capture::~input_capture()
+{
+	{
+		auto gctx = streamfx::obs::gs::context();
+		for (auto& stage : _stage) {
+			if (stage) {
+				gs_stagesurface_destroy(stage);
+				stage = nullptr;
+			}
+		}
+		_rt.reset();
+	}
+
+	if (_writer) {
+		D_LOG_INFO("Recorded %" PRIu32 " of %" PRIu32 " frames into '%s', %" PRIu64 " were dropped.", _submitted, _frames, _path.c_str(), _writer->dropped());
+		_writer.reset();
+	}
+}
+
+streamfx::gfx::input_capture::input_capture(obs_source_t* filter, const std::string& path, uint32_t frames) : _path(path), _frames(frames), _submitted(0), _last_frame(0), _writer(), _rt(), _stage(), _stage_frame(), _staged(), _index(0)
+{
+	if (!filter || (obs_source_get_type(filter) != OBS_SOURCE_TYPE_FILTER)) {
+		throw std::invalid_argument("Only the input of filters can be recorded.");
+	}
+	if (path.empty() || (frames == 0)) {
+		throw std::invalid_argument("Nothing to record.");
+	}
+
+	// Replaying needs to know what to replay through, and with which settings.
+	obs_data_t* sidecar  = obs_data_create();
+	obs_data_t* settings = obs_source_get_settings(filter);
+	obs_data_set_string(sidecar, "id", obs_source_get_id(filter));
+	obs_data_set_string(sidecar, "name", obs_source_get_name(filter));
+	obs_data_set_obj(sidecar, "settings", settings);
+	bool saved = obs_data_save_json(sidecar, (path + ".json").c_str());
+	obs_data_release(settings);
+	obs_data_release(sidecar);
+	if (!saved) {
+		throw std::runtime_error("Failed to write '" + path + ".json'.");
+	}
+
+	D_LOG_INFO("Recording %" PRIu32 " frames of input of '%s' into '%s'.", frames, obs_source_get_name(filter), path.c_str());
+}
+
+bool streamfx::gfx::input_capture::record(obs_source_t* filter)
+{
+	auto     gctx  = streamfx::obs::gs::context();
+	uint64_t frame = obs_get_video_frame_time();
+
+	// The oldest copy is the one about to be replaced, the GPU finished it at least a frame ago.
+	if (_staged[_index] && (_stage_frame[_index] != frame)) {
+		collect(_index);
+	}
+
+	if (_submitted >= _frames) {
+		// Stay around until every staged copy made it to the writer.
+		for (std::size_t idx = 0; idx < ring; idx++) {
+			if (_staged[idx] && (_stage_frame[idx] != frame)) {
+				collect(idx);
+			}
+		}
+		return std::any_of(_staged.begin(), _staged.end(), [](bool v) { return v; });
+	}
+
+	// Only record once per frame, even if we are rendered more often than that.
+	if (_last_frame == frame) {
+		return true;
+	}
+
+	obs_source_t* target = obs_filter_get_target(filter);
+	if (!target) {
+		return true;
+	}
+	uint32_t width  = obs_source_get_base_width(target);
+	uint32_t height = obs_source_get_base_height(target);
+	if (!width || !height) {
+		return true;
+	}
+
+	if (!_writer) {
+		_writer = std::make_unique<::streamfx::util::capture::writer>(_path, width, height);
+		_rt     = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		for (auto& stage : _stage) {
+			stage = gs_stagesurface_create(width, height, GS_RGBA);
+			if (!stage) {
+				D_LOG_ERROR("Failed to create staging surfaces, stopping.");
+				return false;
+			}
+		}
+	} else if ((width != _writer->width()) || (height != _writer->height())) {
+		// Frames are fixed size, so that they can be found without reading the ones before them.
+		D_LOG_WARNING("Input changed size from %" PRIu32 "x%" PRIu32 " to %" PRIu32 "x%" PRIu32 ", stopping.", _writer->width(), _writer->height(), width, height);
+		_frames = _submitted;
+		return true;
+	}
+
+	{
+		auto op = _rt->render(width, height);
+		gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), -1., 1.);
+
+		vec4 black = {};
+		gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
+
+		streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
+		obs_source_skip_video_filter(filter);
+		gs_blend_state_pop();
+	}
+
+	gs_stage_texture(_stage[_index], _rt->get_object());
+	_stage_frame[_index] = frame;
+	_staged[_index]      = true;
+	_index               = (_index + 1) % ring;
+	_last_frame          = frame;
+	_submitted++;
+	return true;
+}
+
+void streamfx::gfx::input_capture::collect(std::size_t index)
+{
+	uint32_t             width    = _writer->width();
+	uint32_t             height   = _writer->height();
+	std::vector<uint8_t> pixels(static_cast<std::size_t>(width) * height * 4);
+	uint8_t*             data     = nullptr;
+	uint32_t             linesize = 0;
+	if (gs_stagesurface_map(_stage[index], &data, &linesize)) {
+		for (uint32_t y = 0; y < height; y++) {
+			memcpy(pixels.data() + (static_cast<std::size_t>(y) * width * 4), data + (static_cast<std::size_t>(y) * linesize), width * 4);
+		}
+		gs_stagesurface_unmap(_stage[index]);
+		_writer->push(_stage_frame[index], std::move(pixels));
+	}
+	_staged[index] = false;
+}
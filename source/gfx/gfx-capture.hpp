@@ -0,0 +1,55 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "util/util-capture.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <memory>
+#include <string>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Records what a filter gets as its input, so that it can be replayed through the same filter later on.
+	 *
+	 * The input is rendered a second time into a render target of our own, and copied into a ring of staging surfaces
+	 * which is only read back once the GPU is guaranteed to be done with it. Input is recorded as 8-bit RGBA, no matter
+	 * what color space the filter would have asked for.
+	 */
+	class input_capture {
+		public:
+		static constexpr std::size_t ring = 3; // Staging surfaces in flight, which is also the latency in frames.
+
+		private:
+		std::string _path;
+		uint32_t    _frames;    // Frames to record.
+		uint32_t    _submitted; // Frames staged so far.
+		uint64_t    _last_frame;
+
+		std::unique_ptr<::streamfx::util::capture::writer> _writer;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _rt;
+		std::array<gs_stagesurf_t*, ring>                  _stage;
+		std::array<uint64_t, ring>                         _stage_frame;
+		std::array<bool, ring>                             _staged;
+		std::size_t                                        _index;
+
+		public:
+		~input_capture();
+
+		/** Start recording the input of a filter into path, and its current settings into path plus ".json". */
+		input_capture(obs_source_t* filter, const std::string& path, uint32_t frames);
+
+		/** Record the current input of the filter. Graphics thread only.
+		 *
+		 * Returns false once all frames are recorded, or recording can not continue.
+		 */
+		bool record(obs_source_t* filter);
+
+		private:
+		void collect(std::size_t index);
+	};
+} // namespace streamfx::gfx
@@ -0,0 +1,110 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-color-scopes.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "util/util-simd.hpp"
+#include "util/util-threadpool.hpp"
+
+#include "warning-disable.hpp"
+#include <cstring>
+#include "warning-enable.hpp"
+
+streamfx::gfx::color_scopes::~color_scopes()
+{
+	release();
+}
+
+streamfx::gfx::color_scopes::color_scopes() : _readback(), _shared(std::make_shared<shared>())
+{
+	_shared->busy = false;
+}
+
+void streamfx::gfx::color_scopes::update(std::shared_ptr<streamfx::obs::gs::texture> texture)
+{
+	if (!_readback) {
+		_readback = std::make_unique<streamfx::obs::gs::readback>(width, height, GS_RGBA, [this](const streamfx::obs::gs::readback::frame& frame) { consume(frame); });
+	}
+
+	if (texture) {
+		_readback->stage(texture->get_object());
+	} else {
+		_readback->collect();
+	}
+}
+
+void streamfx::gfx::color_scopes::release()
+{
+	_readback.reset();
+}
+
+std::shared_ptr<const streamfx::gfx::color_scopes::data> streamfx::gfx::color_scopes::get()
+{
+	std::lock_guard<std::mutex> lock(_shared->lock);
+	return _shared->result;
+}
+
+void streamfx::gfx::color_scopes::consume(const streamfx::obs::gs::readback::frame& frame)
+{
+	bool busy = false;
+	{
+		std::lock_guard<std::mutex> lock(_shared->lock);
+		busy          = _shared->busy;
+		_shared->busy = true;
+	}
+
+	// Drop the copy if the previous one is still being counted, there will be another one soon.
+	if (busy) {
+		return;
+	}
+
+	auto pixels = std::make_shared<std::vector<uint8_t>>(static_cast<std::size_t>(width) * height * 4);
+	for (uint32_t y = 0; y < height; y++) {
+		memcpy(pixels->data() + (static_cast<std::size_t>(y) * width * 4), frame.data + (static_cast<std::size_t>(y) * frame.linesize), width * 4);
+	}
+
+	std::weak_ptr<shared> wshared  = _shared;
+	uint64_t              measured = frame.timestamp;
+	streamfx::util::threadpool::threadpool::instance()->push([wshared, pixels, measured](streamfx::util::threadpool::task_data_t) {
+		auto result = analyze(*pixels, measured);
+		if (auto state = wshared.lock(); state) {
+			std::lock_guard<std::mutex> lock(state->lock);
+			state->result = result;
+			state->busy   = false;
+		}
+	});
+}
+
+std::shared_ptr<const streamfx::gfx::color_scopes::data> streamfx::gfx::color_scopes::analyze(const std::vector<uint8_t>& pixels, uint64_t frame)
+{
+	auto result   = std::make_shared<data>();
+	result->frame = frame;
+	result->luma.fill(0);
+	result->red.fill(0);
+	result->green.fill(0);
+	result->blue.fill(0);
+	result->waveform.resize(static_cast<std::size_t>(width) * bins, 0);
+
+	// Luma is computed a row at a time, which vectorizes well, unlike the counting.
+	auto                       luma_rgba8 = streamfx::util::simd::get().luma_rgba8;
+	std::array<uint8_t, width> luma;
+	for (uint32_t y = 0; y < height; y++) {
+		const uint8_t* row = pixels.data() + (static_cast<std::size_t>(y) * width * 4);
+		luma_rgba8(luma.data(), row, width);
+		for (uint32_t x = 0; x < width; x++) {
+			uint32_t r = row[x * 4 + 0];
+			uint32_t g = row[x * 4 + 1];
+			uint32_t b = row[x * 4 + 2];
+			uint32_t l = luma[x];
+
+			result->red[r]++;
+			result->green[g]++;
+			result->blue[b]++;
+			result->luma[l]++;
+			result->waveform[x * bins + l]++;
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,65 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "obs/gs/gs-readback.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <mutex>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Histograms and a luma waveform of a texture.
+	 *
+	 * The texture is scaled down on the GPU and read back a few frames later, once the GPU is done with it. Counting
+	 * happens in the thread pool, so the render thread never waits.
+	 */
+	class color_scopes {
+		public:
+		static constexpr uint32_t    width  = 256; // Width of the measured copy, and columns of the waveform.
+		static constexpr uint32_t    height = 144; // Height of the measured copy.
+		static constexpr std::size_t bins   = 256; // Bins of each histogram, and levels of the waveform.
+
+		struct data {
+			uint64_t                   frame; // Video frame time at which the measured texture was rendered.
+			std::array<uint32_t, bins> luma;
+			std::array<uint32_t, bins> red;
+			std::array<uint32_t, bins> green;
+			std::array<uint32_t, bins> blue;
+			std::vector<uint32_t>      waveform; // Luma per column, stored as [column * bins + level].
+		};
+
+		private:
+		struct shared {
+			std::mutex                  lock;
+			bool                        busy;
+			std::shared_ptr<const data> result;
+		};
+
+		std::unique_ptr<streamfx::obs::gs::readback> _readback;
+		std::shared_ptr<shared>                      _shared;
+
+		public:
+		~color_scopes();
+		color_scopes();
+
+		/** Measure the given texture, or only collect previous measurements if there is none. Graphics thread only. */
+		void update(std::shared_ptr<streamfx::obs::gs::texture> texture);
+
+		/** Release all graphics resources, for when no measurements are needed for a while. Graphics thread only. */
+		void release();
+
+		/** Latest completed measurement, or nullptr if there is none yet. */
+		std::shared_ptr<const data> get();
+
+		private:
+		void consume(const streamfx::obs::gs::readback::frame& frame);
+
+		static std::shared_ptr<const data> analyze(const std::vector<uint8_t>& pixels, uint64_t frame);
+	};
+} // namespace streamfx::gfx
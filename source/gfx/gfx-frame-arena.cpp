@@ -0,0 +1,76 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-frame-arena.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <numeric>
+#include "warning-enable.hpp"
+
+// Size of the first block, which is enough for the temporaries of a handful of filters.
+constexpr std::size_t initial_block_size = 64 * 1024;
+
+streamfx::gfx::frame_arena::~frame_arena() {}
+
+streamfx::gfx::frame_arena::frame_arena() : _blocks(), _sizes(), _offset(0), _frame(0) {}
+
+void* streamfx::gfx::frame_arena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+	next_frame();
+
+	// Try the current block first, and fall back to a new one twice as large or fitting the allocation.
+	if (!_blocks.empty()) {
+		auto        base   = reinterpret_cast<std::uintptr_t>(_blocks.back().get());
+		std::size_t offset = ((base + _offset + alignment - 1) & ~(alignment - 1)) - base;
+		if ((offset + bytes) <= _sizes.back()) {
+			_offset = offset + bytes;
+			return _blocks.back().get() + offset;
+		}
+	}
+
+	std::size_t size = std::max(_sizes.empty() ? initial_block_size : _sizes.back() * 2, bytes + alignment);
+	_blocks.emplace_back(new std::byte[size]);
+	_sizes.push_back(size);
+
+	auto        base   = reinterpret_cast<std::uintptr_t>(_blocks.back().get());
+	std::size_t offset = ((base + alignment - 1) & ~(alignment - 1)) - base;
+	_offset            = offset + bytes;
+	return _blocks.back().get() + offset;
+}
+
+void streamfx::gfx::frame_arena::do_deallocate(void*, std::size_t, std::size_t)
+{
+	// Released all at once by the next frame.
+}
+
+bool streamfx::gfx::frame_arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+	return this == &other;
+}
+
+void streamfx::gfx::frame_arena::next_frame()
+{
+	uint64_t frame = obs_get_video_frame_time();
+	if (frame == _frame) {
+		return;
+	}
+	_frame  = frame;
+	_offset = 0;
+
+	// Merge the blocks, so that a frame like the last one fits into a single block.
+	if (_blocks.size() > 1) {
+		std::size_t size = std::accumulate(_sizes.begin(), _sizes.end(), std::size_t{0});
+		_blocks.clear();
+		_sizes.clear();
+		_blocks.emplace_back(new std::byte[size]);
+		_sizes.push_back(size);
+	}
+}
+
+streamfx::gfx::frame_arena* streamfx::gfx::frame_arena::get()
+{
+	thread_local streamfx::gfx::frame_arena instance;
+	return &instance;
+}
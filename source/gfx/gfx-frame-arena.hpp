@@ -0,0 +1,46 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Memory for temporaries of video_tick and video_render, which are thrown away within the same frame.
+	 *
+	 * Allocating only moves a pointer forward, and freeing does nothing. Everything is released at once by the first
+	 * allocation of the next frame, so nothing allocated from it may be kept beyond the frame it was allocated in.
+	 * If a frame needed more than one block, the blocks are merged into one large enough for it.
+	 *
+	 * Each thread has its own arena, but only the graphics thread knows when a frame ends.
+	 */
+	class frame_arena : public std::pmr::memory_resource {
+		std::vector<std::unique_ptr<std::byte[]>> _blocks;
+		std::vector<std::size_t>                  _sizes;
+		std::size_t                               _offset;
+		uint64_t                                  _frame;
+
+		public:
+		~frame_arena();
+		frame_arena();
+
+		protected:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+		void  do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+		bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+		private:
+		/** Release everything if a new frame started since the last allocation. */
+		void next_frame();
+
+		public /* Singleton */:
+		static streamfx::gfx::frame_arena* get();
+	};
+} // namespace streamfx::gfx
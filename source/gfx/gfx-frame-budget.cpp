@@ -0,0 +1,126 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-frame-budget.hpp"
+#include "configuration.hpp"
+#include "obs/obs-tools.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <util/platform.h>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<gfx::frame_budget> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_CFG_FRAMEBUDGET "FrameBudget"
+#define ST_CFG_FRAMEBUDGET_BUDGET "Budget"
+
+// A job that has been told to wait this many frames runs regardless of the budget.
+constexpr uint64_t starve_frames = 30;
+
+streamfx::gfx::frame_budget::job::scope::~scope()
+{
+	auto cpu = std::chrono::nanoseconds(os_gettime_ns() - _start);
+	_parent->_gpu.end();
+
+	// GPU timings arrive a few frames late, so the last one that did arrive has to do.
+	auto cost = cpu + _parent->_gpu.latest();
+	if (_parent->_cost.count() == 0) {
+		_parent->_cost = cost;
+	} else {
+		_parent->_cost = (_parent->_cost * 3 + cost) / 4;
+	}
+	_parent->_waited = 0;
+	_parent->_parent->spend(cost);
+}
+
+streamfx::gfx::frame_budget::job::scope::scope(job& parent) : _parent(&parent), _start(os_gettime_ns())
+{
+	_parent->_gpu.begin();
+}
+
+streamfx::gfx::frame_budget::job::~job() {}
+
+streamfx::gfx::frame_budget::job::job() : _parent(streamfx::gfx::frame_budget::get()), _cost(0), _waited(0), _gpu() {}
+
+bool streamfx::gfx::frame_budget::job::admit()
+{
+	if (_parent->admit(_cost, _waited)) {
+		return true;
+	}
+	++_waited;
+	return false;
+}
+
+streamfx::gfx::frame_budget::~frame_budget() {}
+
+streamfx::gfx::frame_budget::frame_budget() : _lock(), _budget(std::chrono::milliseconds(2)), _frame(0), _spent(0)
+{
+	auto                        config = streamfx::configuration::instance();
+	auto                        data   = config->get();
+	std::shared_ptr<obs_data_t> cfg(obs_data_get_obj(data.get(), ST_CFG_FRAMEBUDGET), streamfx::obs::obs_data_deleter);
+	if (!cfg) {
+		return;
+	}
+	obs_data_set_default_double(cfg.get(), ST_CFG_FRAMEBUDGET_BUDGET, 2.);
+
+	_budget = std::chrono::nanoseconds(static_cast<int64_t>(std::max(obs_data_get_double(cfg.get(), ST_CFG_FRAMEBUDGET_BUDGET), 0.) * 1000000.));
+	D_LOG_INFO("Spending up to %.3f ms per frame on deferrable work.", static_cast<double_t>(_budget.count()) / 1000000.);
+}
+
+bool streamfx::gfx::frame_budget::admit(std::chrono::nanoseconds cost, uint64_t waited)
+{
+	std::unique_lock<std::mutex> lock(_lock);
+	next_frame();
+
+	// Jobs that have never run have no cost yet, so they only fit in an empty frame.
+	if ((_budget.count() == 0) || (_spent.count() == 0) || (waited >= starve_frames)) {
+		return true;
+	}
+	return (cost.count() > 0) && ((_spent + cost) <= _budget);
+}
+
+void streamfx::gfx::frame_budget::spend(std::chrono::nanoseconds cost)
+{
+	std::unique_lock<std::mutex> lock(_lock);
+	next_frame();
+
+	// Even a job that measured nothing took up the slot of the frame.
+	_spent += std::max(cost, std::chrono::nanoseconds(1));
+}
+
+void streamfx::gfx::frame_budget::next_frame()
+{
+	if (uint64_t frame = obs_get_video_frame_time(); frame != _frame) {
+		_frame = frame;
+		_spent = std::chrono::nanoseconds(0);
+	}
+}
+
+std::shared_ptr<streamfx::gfx::frame_budget> streamfx::gfx::frame_budget::get()
+{
+	static std::weak_ptr<streamfx::gfx::frame_budget> instance;
+	static std::mutex                                 lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (instance.expired()) {
+		auto hard_instance = std::shared_ptr<streamfx::gfx::frame_budget>(new streamfx::gfx::frame_budget());
+		instance           = hard_instance;
+		return hard_instance;
+	}
+	return instance.lock();
+}
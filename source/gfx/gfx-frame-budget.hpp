@@ -0,0 +1,84 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "obs/gs/gs-timer.hpp"
+
+#include "warning-disable.hpp"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Spreads occasional expensive work, such as rebuilding a LUT, across frames instead of doing it all at once.
+	 *
+	 * Every frame has a budget of time for such work. Jobs ask before they run, and are told to wait for a later frame
+	 * if their expected cost no longer fits, in which case their owner keeps showing its previous result. The first job
+	 * of a frame always runs, and so does a job that has been waiting for too long, so that nothing waits forever.
+	 *
+	 * Configured in the "FrameBudget" object of the global configuration:
+	 * - "Budget": Milliseconds per frame, 2 by default. 0 disables the budget, and every job runs immediately.
+	 *
+	 * Graphics thread only.
+	 */
+	class frame_budget {
+		std::mutex               _lock;
+		std::chrono::nanoseconds _budget;
+		uint64_t                 _frame;
+		std::chrono::nanoseconds _spent;
+
+		public:
+		/** Work of a single owner that is done from time to time, which learns its own cost from previous runs. */
+		class job {
+			std::shared_ptr<frame_budget> _parent;
+			std::chrono::nanoseconds      _cost;
+			uint64_t                      _waited;
+			::streamfx::obs::gs::timer    _gpu;
+
+			public:
+			class scope {
+				job*     _parent;
+				uint64_t _start;
+
+				public:
+				~scope();
+				scope(job& parent);
+
+				scope(const scope&)            = delete;
+				scope& operator=(const scope&) = delete;
+			};
+
+			public:
+			~job();
+			job();
+
+			/** Ask whether the job may run in this frame. If it may, run it right away within run(). */
+			bool admit();
+
+			/** Measure the job until the returned object goes out of scope. */
+			scope run()
+			{
+				return scope(*this);
+			}
+		};
+
+		public:
+		~frame_budget();
+
+		private:
+		frame_budget();
+
+		bool admit(std::chrono::nanoseconds cost, uint64_t waited);
+
+		void spend(std::chrono::nanoseconds cost);
+
+		/** Start counting from zero if this is the first call in a new frame. */
+		void next_frame();
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::gfx::frame_budget> get();
+	};
+} // namespace streamfx::gfx
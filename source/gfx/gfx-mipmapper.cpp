@@ -3,10 +3,12 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "gfx-mipmapper.hpp"
+#include "gfx/gfx-opengl.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "plugin.hpp"
 
 #include "warning-disable.hpp"
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 // Direct3D 11
@@ -20,6 +22,33 @@
 #include "glad/gl.h"
 #include "warning-enable.hpp"
 
+#ifdef _WIN32
+// Direct3D 11 can only generate mip-maps for render targets created with D3D11_RESOURCE_MISC_GENERATE_MIPS, which
+// libobs never does, so the chain is generated in a matching scratch texture and then copied over.
+struct d3d_scratch {
+	D3D11_TEXTURE2D_DESC      desc    = {};
+	ID3D11Texture2D*          texture = nullptr;
+	ID3D11ShaderResourceView* view    = nullptr;
+
+	~d3d_scratch()
+	{
+		if (view) {
+			view->Release();
+		}
+		if (texture) {
+			texture->Release();
+		}
+	}
+};
+#endif
+
+struct streamfx::gfx::mipmapper::hardware {
+	bool available = true;
+#ifdef _WIN32
+	d3d_scratch d3d;
+#endif
+};
+
 #ifdef _WIN32
 struct d3d_info {
 	ID3D11Device*        device  = nullptr;
@@ -41,11 +70,94 @@ void d3d_copy_subregion(d3d_info& info, std::shared_ptr<streamfx::obs::gs::textu
 	info.context->CopySubresourceRegion(info.target, mip_level, 0, 0, 0, source_ref, 0, &box);
 }
 
+DXGI_FORMAT d3d_view_format(DXGI_FORMAT format)
+{
+	// libobs creates 8-bit textures as typeless, and picks the view format depending on the sRGB mode.
+	switch (format) {
+	case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+		return gs_get_linear_srgb() ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+	case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+		return gs_get_linear_srgb() ? DXGI_FORMAT_B8G8R8A8_UNORM_SRGB : DXGI_FORMAT_B8G8R8A8_UNORM;
+	case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+		return gs_get_linear_srgb() ? DXGI_FORMAT_B8G8R8X8_UNORM_SRGB : DXGI_FORMAT_B8G8R8X8_UNORM;
+	case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+		return DXGI_FORMAT_R10G10B10A2_UNORM;
+	case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+	case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+	case DXGI_FORMAT_R16G16_TYPELESS:
+	case DXGI_FORMAT_R32G32_TYPELESS:
+	case DXGI_FORMAT_R16_TYPELESS:
+	case DXGI_FORMAT_R32_TYPELESS:
+	case DXGI_FORMAT_R8_TYPELESS:
+	case DXGI_FORMAT_R8G8_TYPELESS:
+		return DXGI_FORMAT_UNKNOWN;
+	default:
+		return format;
+	}
+}
+
+bool d3d_generate_mips(d3d_info& info, d3d_scratch& scratch, std::shared_ptr<streamfx::obs::gs::texture> source, uint32_t width, uint32_t height)
+{
+	D3D11_TEXTURE2D_DESC desc;
+	reinterpret_cast<ID3D11Texture2D*>(info.target)->GetDesc(&desc);
+
+	// (Re-)Create the scratch texture if it no longer matches the target.
+	if (!scratch.texture || (scratch.desc.Width != desc.Width) || (scratch.desc.Height != desc.Height) || (scratch.desc.MipLevels != desc.MipLevels) || (scratch.desc.Format != desc.Format)) {
+		if (scratch.view) {
+			scratch.view->Release();
+			scratch.view = nullptr;
+		}
+		if (scratch.texture) {
+			scratch.texture->Release();
+			scratch.texture = nullptr;
+		}
+
+		UINT        support = 0;
+		DXGI_FORMAT format  = d3d_view_format(desc.Format);
+		if ((format == DXGI_FORMAT_UNKNOWN) || FAILED(info.device->CheckFormatSupport(format, &support)) || !(support & D3D11_FORMAT_SUPPORT_MIP_AUTOGEN)) {
+			return false;
+		}
+
+		D3D11_TEXTURE2D_DESC sdesc = desc;
+		sdesc.ArraySize            = 1;
+		sdesc.SampleDesc.Count     = 1;
+		sdesc.SampleDesc.Quality   = 0;
+		sdesc.Usage                = D3D11_USAGE_DEFAULT;
+		sdesc.BindFlags            = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+		sdesc.CPUAccessFlags       = 0;
+		sdesc.MiscFlags            = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+		if (FAILED(info.device->CreateTexture2D(&sdesc, nullptr, &scratch.texture))) {
+			return false;
+		}
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC vdesc = {};
+		vdesc.Format                          = format;
+		vdesc.ViewDimension                   = D3D11_SRV_DIMENSION_TEXTURE2D;
+		vdesc.Texture2D.MostDetailedMip       = 0;
+		vdesc.Texture2D.MipLevels             = static_cast<UINT>(-1);
+		if (FAILED(info.device->CreateShaderResourceView(scratch.texture, &vdesc, &scratch.view))) {
+			scratch.texture->Release();
+			scratch.texture = nullptr;
+			return false;
+		}
+
+		scratch.desc = desc;
+	}
+
+	D3D11_BOX box        = {0, 0, 0, width, height, 1};
+	auto      source_ref = reinterpret_cast<ID3D11Resource*>(gs_texture_get_obj(source->get_object()));
+	info.context->CopySubresourceRegion(scratch.texture, 0, 0, 0, 0, source_ref, 0, &box);
+	info.context->GenerateMips(scratch.view);
+	info.context->CopyResource(info.target, scratch.texture);
+	return true;
+}
+
 #endif
 
 struct opengl_info {
-	GLuint target = 0;
-	GLuint fbo    = 0;
+	GLuint                                 target = 0;
+	GLuint                                 fbo    = 0;
+	std::shared_ptr<streamfx::gfx::opengl> gl;
 };
 
 std::string opengl_translate_error(GLenum error)
@@ -108,6 +220,7 @@ std::string opengl_translate_framebuffer_status(GLenum error)
 void opengl_initialize(opengl_info& info, std::shared_ptr<streamfx::obs::gs::texture> source, std::shared_ptr<streamfx::obs::gs::texture> target)
 {
 	info.target = *reinterpret_cast<GLuint*>(gs_texture_get_obj(target->get_object()));
+	info.gl     = streamfx::gfx::opengl::get();
 
 	glGenFramebuffers(1, &info.fbo);
 }
@@ -121,6 +234,11 @@ void opengl_copy_subregion(opengl_info& info, std::shared_ptr<streamfx::obs::gs:
 {
 	GLuint source_ref = *reinterpret_cast<GLuint*>(gs_texture_get_obj(source->get_object()));
 
+	// Copy between the textures directly if possible, which avoids rebinding the framebuffer and texture units.
+	if (info.gl->copy_image(source_ref, 0, info.target, static_cast<int32_t>(mip_level), width, height)) {
+		return;
+	}
+
 	// Source -> Texture Unit 0, Read Color Framebuffer
 	glActiveTexture(GL_TEXTURE0);
 	D_OPENGL_CHECK_ERROR("glActiveTexture(GL_TEXTURE0);");
@@ -162,13 +280,47 @@ void opengl_copy_subregion(opengl_info& info, std::shared_ptr<streamfx::obs::gs:
 	D_OPENGL_CHECK_ERROR("glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);");
 }
 
+void opengl_generate_mips(opengl_info& info)
+{
+	glActiveTexture(GL_TEXTURE1);
+	D_OPENGL_CHECK_ERROR("glActiveTexture(GL_TEXTURE1);");
+	glBindTexture(GL_TEXTURE_2D, info.target);
+	D_OPENGL_CHECK_ERROR("glBindTexture(GL_TEXTURE_2D, info.target);");
+	glGenerateMipmap(GL_TEXTURE_2D);
+	D_OPENGL_CHECK_ERROR("glGenerateMipmap(GL_TEXTURE_2D);");
+	glBindTexture(GL_TEXTURE_2D, 0);
+	D_OPENGL_CHECK_ERROR("glBindTexture(GL_TEXTURE_2D, 0);");
+	glActiveTexture(GL_TEXTURE0);
+	D_OPENGL_CHECK_ERROR("glActiveTexture(GL_TEXTURE0);");
+}
+
+// Pooled render targets and chains are released once they have not been used for this long.
+static constexpr uint64_t unused_timeout = 1'000'000'000; // ns
+
+std::shared_ptr<streamfx::gfx::mipmapper> streamfx::gfx::mipmapper::get()
+{
+	static std::weak_ptr<streamfx::gfx::mipmapper> instance;
+	static std::mutex                              lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (instance.expired()) {
+		auto hard_instance = std::shared_ptr<streamfx::gfx::mipmapper>(new streamfx::gfx::mipmapper());
+		instance           = hard_instance;
+		return hard_instance;
+	}
+	return instance.lock();
+}
+
 streamfx::gfx::mipmapper::~mipmapper()
 {
-	_rt.reset();
+	auto gctx = streamfx::obs::gs::context();
+	_chains.clear();
+	_rts.clear();
 	_effect.reset();
+	_hardware.reset();
 }
 
-streamfx::gfx::mipmapper::mipmapper() : _gfx_util(::streamfx::gfx::util::get())
+streamfx::gfx::mipmapper::mipmapper() : _rts(), _chains(), _gfx_util(::streamfx::gfx::util::get()), _hardware(std::make_unique<hardware>())
 {
 	auto gctx = streamfx::obs::gs::context();
 
@@ -215,11 +367,6 @@ void streamfx::gfx::mipmapper::rebuild(std::shared_ptr<streamfx::obs::gs::textur
 	// Get a unique lock on the graphics context.
 	auto gctx = streamfx::obs::gs::context();
 
-	// Do we need to recreate the render target for a different format?
-	if ((!_rt) || (source->get_color_format() != _rt->get_color_format())) {
-		_rt = std::make_unique<streamfx::obs::gs::rendertarget>(source->get_color_format(), GS_ZS_NONE);
-	}
-
 	// Initialize API Handlers.
 	opengl_info oglinfo;
 	if (gs_get_device_type() == GS_DEVICE_OPENGL) {
@@ -238,75 +385,111 @@ void streamfx::gfx::mipmapper::rebuild(std::shared_ptr<streamfx::obs::gs::textur
 		uint32_t height        = source->get_height();
 		size_t   max_mip_level = calculate_max_mip_level(width, height);
 
-		{
+		// Let the backend generate the whole chain if it can.
+		bool generated = false;
+		if (_hardware->available) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-			auto cctr = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Mip Level %" PRId64 "", 0);
+			auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Hardware");
 #endif
 
-			// Retrieve maximum mip map level.
+			try {
 #ifdef _WIN32
-			if (gs_get_device_type() == GS_DEVICE_DIRECT3D_11) {
-				d3d_copy_subregion(d3dinfo, source, 0, width, height);
-			}
+				if (gs_get_device_type() == GS_DEVICE_DIRECT3D_11) {
+					generated = d3d_generate_mips(d3dinfo, _hardware->d3d, source, width, height);
+				}
 #endif
-			if (gs_get_device_type() == GS_DEVICE_OPENGL) {
-				opengl_copy_subregion(oglinfo, source, 0, width, height);
+				if (gs_get_device_type() == GS_DEVICE_OPENGL) {
+					opengl_copy_subregion(oglinfo, source, 0, width, height);
+					opengl_generate_mips(oglinfo);
+					generated = true;
+				}
+			} catch (const std::exception& ex) {
+				DLOG_WARNING("Hardware mip-map generation failed, falling back to shaders: %s", ex.what());
 			}
+
+			// Don't retry something that is not going to work.
+			_hardware->available = generated;
 		}
 
-		// Set up rendering state.
-		gs_blend_state_push();
-		gs_reset_blend_state();
-		gs_enable_blending(false);
-		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-		gs_enable_color(true, true, true, true);
-		gs_enable_depth_test(false);
-		gs_enable_stencil_test(false);
-		gs_enable_stencil_write(false);
-		gs_set_cull_mode(GS_NEITHER);
-
-		// sRGB support.
-		bool old_srgb = gs_framebuffer_srgb_enabled();
-		gs_enable_framebuffer_srgb(gs_get_linear_srgb());
-
-		// Render each mip map level.
-		for (size_t mip = 1; mip < max_mip_level; mip++) {
+		if (!generated) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-			auto cctr = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Mip Level %" PRIuMAX, mip);
+			auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Shader");
 #endif
 
-			uint32_t cwidth  = std::max<uint32_t>(width >> mip, 1);
-			uint32_t cheight = std::max<uint32_t>(height >> mip, 1);
-			float_t  iwidth  = 1.f / static_cast<float_t>(cwidth);
-			float_t  iheight = 1.f / static_cast<float_t>(cheight);
+			{
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+				auto cctr = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Mip Level %" PRId64 "", 0);
+#endif
 
-			try {
-				auto op = _rt->render(cwidth, cheight);
-				gs_ortho(0, 1, 0, 1, 0, 1);
-
-				_effect.get_parameter("image").set_texture(target, gs_get_linear_srgb());
-				_effect.get_parameter("imageTexel").set_float2(iwidth, iheight);
-				_effect.get_parameter("level").set_int(int32_t(mip - 1));
-				while (gs_effect_loop(_effect.get_object(), "Draw")) {
-					_gfx_util->draw_fullscreen_triangle();
+				// Retrieve maximum mip map level.
+#ifdef _WIN32
+				if (gs_get_device_type() == GS_DEVICE_DIRECT3D_11) {
+					d3d_copy_subregion(d3dinfo, source, 0, width, height);
+				}
+#endif
+				if (gs_get_device_type() == GS_DEVICE_OPENGL) {
+					opengl_copy_subregion(oglinfo, source, 0, width, height);
 				}
-			} catch (...) {
 			}
 
-			// Copy from the render target to the target mip level.
+			// Set up rendering state.
+			streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
+
+			// sRGB support.
+			bool old_srgb = gs_framebuffer_srgb_enabled();
+			gs_enable_framebuffer_srgb(gs_get_linear_srgb());
+
+			// Every level is rendered into the corner of a render target the size of the largest one, as a change in size
+			// would re-create the render target for each level of every rebuild.
+			uint32_t rt_width  = std::max<uint32_t>(width >> 1, 1);
+			uint32_t rt_height = std::max<uint32_t>(height >> 1, 1);
+			auto     rt        = acquire_rendertarget(source->get_color_format(), rt_width, rt_height);
+
+			// Render each mip map level.
+			for (size_t mip = 1; mip < max_mip_level; mip++) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+				auto cctr = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Mip Level %" PRIuMAX, mip);
+#endif
+
+				uint32_t cwidth  = std::max<uint32_t>(width >> mip, 1);
+				uint32_t cheight = std::max<uint32_t>(height >> mip, 1);
+				float_t  iwidth  = 1.f / static_cast<float_t>(cwidth);
+				float_t  iheight = 1.f / static_cast<float_t>(cheight);
+
+				try {
+					auto op = rt->render(rt_width, rt_height);
+					if (gs_get_device_type() == GS_DEVICE_OPENGL) {
+						// Viewports are top-down, but copies read bottom-up in OpenGL.
+						gs_set_viewport(0, static_cast<int>(rt_height - cheight), static_cast<int>(cwidth), static_cast<int>(cheight));
+					} else {
+						gs_set_viewport(0, 0, static_cast<int>(cwidth), static_cast<int>(cheight));
+					}
+					gs_ortho(0, 1, 0, 1, 0, 1);
+
+					_effect.get_parameter("image").set_texture(target, gs_get_linear_srgb());
+					_effect.get_parameter("imageTexel").set_float2(iwidth, iheight);
+					_effect.get_parameter("level").set_int(int32_t(mip - 1));
+					while (gs_effect_loop(_effect.get_object(), "Draw")) {
+						_gfx_util->draw_fullscreen_triangle();
+					}
+				} catch (...) {
+				}
+
+				// Copy from the render target to the target mip level.
 #ifdef _WIN32
-			if (gs_get_device_type() == GS_DEVICE_DIRECT3D_11) {
-				d3d_copy_subregion(d3dinfo, _rt->get_texture(), static_cast<uint32_t>(mip), cwidth, cheight);
-			}
+				if (gs_get_device_type() == GS_DEVICE_DIRECT3D_11) {
+					d3d_copy_subregion(d3dinfo, rt->get_texture(), static_cast<uint32_t>(mip), cwidth, cheight);
+				}
 #endif
-			if (gs_get_device_type() == GS_DEVICE_OPENGL) {
-				opengl_copy_subregion(oglinfo, _rt->get_texture(), static_cast<uint32_t>(mip), cwidth, cheight);
+				if (gs_get_device_type() == GS_DEVICE_OPENGL) {
+					opengl_copy_subregion(oglinfo, rt->get_texture(), static_cast<uint32_t>(mip), cwidth, cheight);
+				}
 			}
-		}
 
-		// Clean up rendering state.
-		gs_enable_framebuffer_srgb(old_srgb);
-		gs_blend_state_pop();
+			// Clean up rendering state.
+			gs_enable_framebuffer_srgb(old_srgb);
+			gs_blend_state_pop();
+		}
 
 	} else {
 		throw std::runtime_error("Only 2D Textures support Mip-mapping.");
@@ -322,3 +505,64 @@ void streamfx::gfx::mipmapper::rebuild(std::shared_ptr<streamfx::obs::gs::textur
 	}
 #endif
 }
+
+std::shared_ptr<streamfx::obs::gs::texture> streamfx::gfx::mipmapper::generate(std::shared_ptr<streamfx::obs::gs::texture> source)
+{
+	if (!source) {
+		return nullptr;
+	}
+
+	auto     gctx  = streamfx::obs::gs::context();
+	uint64_t frame = obs_get_video_frame_time();
+	collect_garbage();
+
+	uint32_t width  = source->get_width();
+	uint32_t height = source->get_height();
+	auto&    entry  = _chains[source->get_object()];
+	entry.used      = frame;
+
+	// Someone else already asked for this texture during this frame.
+	if (entry.texture && (entry.frame == frame) && (entry.texture->get_width() == width) && (entry.texture->get_height() == height) && (entry.texture->get_color_format() == source->get_color_format())) {
+		return entry.texture;
+	}
+
+	if (!entry.texture || (entry.texture->get_width() != width) || (entry.texture->get_height() != height) || (entry.texture->get_color_format() != source->get_color_format())) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		auto gdr = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_allocate, "Allocate Mipmapped Texture");
+#endif
+		entry.texture = std::make_shared<streamfx::obs::gs::texture>(width, height, source->get_color_format(), calculate_max_mip_level(width, height), nullptr, streamfx::obs::gs::texture::flags::None);
+	}
+
+	rebuild(source, entry.texture);
+	entry.frame = frame;
+	return entry.texture;
+}
+
+std::shared_ptr<streamfx::obs::gs::rendertarget> streamfx::gfx::mipmapper::acquire_rendertarget(gs_color_format format, uint32_t width, uint32_t height)
+{
+	auto& entry = _rts[{format, width, height}];
+	if (!entry.rt) {
+		entry.rt = std::make_shared<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+	}
+	entry.used = obs_get_video_frame_time();
+	return entry.rt;
+}
+
+void streamfx::gfx::mipmapper::collect_garbage()
+{
+	uint64_t now = obs_get_video_frame_time();
+	for (auto iter = _chains.begin(); iter != _chains.end();) {
+		if ((now - iter->second.used) > unused_timeout) {
+			iter = _chains.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+	for (auto iter = _rts.begin(); iter != _rts.end();) {
+		if ((now - iter->second.used) > unused_timeout) {
+			iter = _rts.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+}
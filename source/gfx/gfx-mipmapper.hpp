@@ -10,6 +10,12 @@
 #include "obs/gs/gs-texture.hpp"
 #include "obs/gs/gs-vertexbuffer.hpp"
 
+#include "warning-disable.hpp"
+#include <map>
+#include <memory>
+#include <tuple>
+#include "warning-enable.hpp"
+
 /* gs::mipmapper is an attempt at adding dynamic mip-map generation to a software
  *  which only supports static mip-maps. It is effectively an incredibly bad hack
  *  instead of a proper solution - can break any time and likely already has.
@@ -20,20 +26,61 @@
  * 
  * So instead we render to a render target and copy from there to the actual
  *  resource. Super wasteful, but what else can we actually do?
+ *
+ * Where the backend can generate mip-maps itself (GenerateMips in Direct3D 11,
+ *  glGenerateMipmap in OpenGL), we use that instead, which produces the same
+ *  2x2 box filtered chain without a draw and a copy per level.
+ *
+ * There is only one mipmapper, shared by everything that needs mip-maps, so that
+ *  intermediate render targets are pooled, and so that consumers asking for the
+ *  mip-maps of the same texture in the same frame share one chain.
  */
 
 namespace streamfx::gfx {
 	class mipmapper {
-		std::unique_ptr<streamfx::obs::gs::rendertarget> _rt;
-		streamfx::obs::gs::effect                        _effect;
-		std::shared_ptr<streamfx::gfx::util>             _gfx_util;
+		struct hardware;
+
+		struct pooled_rendertarget {
+			std::shared_ptr<streamfx::obs::gs::rendertarget> rt;
+			uint64_t                                         used;
+		};
+
+		struct chain {
+			std::shared_ptr<streamfx::obs::gs::texture> texture;
+			uint64_t                                    frame;
+			uint64_t                                    used;
+		};
+
+		std::map<std::tuple<gs_color_format, uint32_t, uint32_t>, pooled_rendertarget> _rts;
+		std::map<gs_texture_t*, chain>                                                 _chains;
+		streamfx::obs::gs::effect                                                      _effect;
+		std::shared_ptr<streamfx::gfx::util>                                           _gfx_util;
+		std::unique_ptr<hardware>                                                      _hardware;
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::gfx::mipmapper> get();
+
+		private:
+		mipmapper();
 
 		public:
 		~mipmapper();
-		mipmapper();
 
 		uint32_t calculate_max_mip_level(uint32_t width, uint32_t height);
 
+		/** Build the mip chain of source into target, which must have the same size, type and format. */
 		void rebuild(std::shared_ptr<streamfx::obs::gs::texture> source, std::shared_ptr<streamfx::obs::gs::texture> target);
+
+		/** Mip-mapped copy of source, shared with everyone else asking for the same texture in the same frame.
+		 *
+		 * The contents of source are expected to not change within a frame. The returned texture is only valid until the
+		 * next frame, and must not be modified.
+		 */
+		std::shared_ptr<streamfx::obs::gs::texture> generate(std::shared_ptr<streamfx::obs::gs::texture> source);
+
+		private:
+		std::shared_ptr<streamfx::obs::gs::rendertarget> acquire_rendertarget(gs_color_format format, uint32_t width, uint32_t height);
+
+		void collect_garbage();
 	};
 } // namespace streamfx::gfx
@@ -49,7 +49,7 @@ std::shared_ptr<streamfx::gfx::opengl> streamfx::gfx::opengl::get()
 	return instance.lock();
 }
 
-streamfx::gfx::opengl::opengl()
+streamfx::gfx::opengl::opengl() : _copy_image(false), _vendor(), _renderer(), _version()
 {
 	int version = gladLoaderLoadGL();
 #ifdef D_PLATFORM_WINDOWS
@@ -60,6 +60,19 @@ streamfx::gfx::opengl::opengl()
 	//gladLoaderLoadGLX();
 #endif // D_PLATFORM_LINUX
 	D_LOG_INFO("Version %d.%d initialized.", GLAD_VERSION_MAJOR(version), GLAD_VERSION_MINOR(version));
+
+	_copy_image = (GLAD_GL_VERSION_4_3 || GLAD_GL_ARB_copy_image) && (glCopyImageSubData != nullptr);
+	D_LOG_INFO("Direct texture copies are %s.", _copy_image ? "available" : "unavailable");
+
+	if (auto vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR)); vendor) {
+		_vendor = vendor;
+	}
+	if (auto renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER)); renderer) {
+		_renderer = renderer;
+	}
+	if (auto version = reinterpret_cast<const char*>(glGetString(GL_VERSION)); version) {
+		_version = version;
+	}
 }
 
 streamfx::gfx::opengl::~opengl()
@@ -74,3 +87,39 @@ streamfx::gfx::opengl::~opengl()
 #endif
 	D_LOG_INFO("Finalized.", "");
 }
+
+bool streamfx::gfx::opengl::has_copy_image()
+{
+	return _copy_image;
+}
+
+bool streamfx::gfx::opengl::copy_image(uint32_t source, int32_t source_level, uint32_t target, int32_t target_level, uint32_t width, uint32_t height)
+{
+	if (!_copy_image) {
+		return false;
+	}
+
+	glCopyImageSubData(source, GL_TEXTURE_2D, source_level, 0, 0, 0, target, GL_TEXTURE_2D, target_level, 0, 0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height), 1);
+	if (auto err = glGetError(); err != GL_NO_ERROR) {
+		// Formats that are only compatible in theory, or driver bugs. Either way, the caller has a slower path.
+		D_LOG_WARNING("glCopyImageSubData failed with error 0x%04X, disabling direct texture copies.", err);
+		_copy_image = false;
+		return false;
+	}
+	return true;
+}
+
+std::string_view streamfx::gfx::opengl::get_vendor()
+{
+	return _vendor;
+}
+
+std::string_view streamfx::gfx::opengl::get_renderer()
+{
+	return _renderer;
+}
+
+std::string_view streamfx::gfx::opengl::get_version()
+{
+	return _version;
+}
@@ -3,11 +3,19 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "warning-disable.hpp"
+#include <cinttypes>
 #include <memory>
+#include <string>
+#include <string_view>
 #include "warning-enable.hpp"
 
 namespace streamfx::gfx {
 	class opengl {
+		bool        _copy_image;
+		std::string _vendor;
+		std::string _renderer;
+		std::string _version;
+
 		public /* Singleton */:
 		static std::shared_ptr<streamfx::gfx::opengl> get();
 
@@ -16,5 +24,23 @@ namespace streamfx::gfx {
 
 		public:
 		~opengl();
+
+		/** Whether copy_image() is supported, which needs OpenGL 4.3 or ARB_copy_image. */
+		bool has_copy_image();
+
+		/** Copy a region between two textures of the same format without binding either to a framebuffer.
+		 *
+		 * @return false if the driver can't do this, in which case nothing was copied.
+		 */
+		bool copy_image(uint32_t source, int32_t source_level, uint32_t target, int32_t target_level, uint32_t width, uint32_t height);
+
+		/** Vendor of the OpenGL implementation, as reported by GL_VENDOR. */
+		std::string_view get_vendor();
+
+		/** Name of the device, as reported by GL_RENDERER. */
+		std::string_view get_renderer();
+
+		/** Version of the OpenGL implementation, including the driver version, as reported by GL_VERSION. */
+		std::string_view get_version();
 	};
 } // namespace streamfx::gfx
@@ -0,0 +1,130 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-qos.hpp"
+#include "configuration.hpp"
+#include "obs/obs-tools.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <util/platform.h>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<gfx::qos> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_CFG_QOS "QoS"
+#define ST_CFG_QOS_MAXLEVEL "MaxLevel"
+
+// Length of a measurement window.
+constexpr uint64_t window_ns = 1000000000ull;
+
+// Render time above this share of the frame interval lowers quality, below the other one it may recover.
+constexpr uint64_t overload_percent = 90;
+constexpr uint64_t headroom_percent = 60;
+
+// Windows in a row with enough headroom before quality is raised again, which keeps it from bouncing between levels.
+constexpr uint32_t recover_windows = 5;
+
+streamfx::gfx::qos::~qos() {}
+
+streamfx::gfx::qos::qos() : _lock(), _max_level(2), _level(0), _frame(0), _window_start(0), _window_lagged(0), _headroom_windows(0)
+{
+	auto                        config = streamfx::configuration::instance();
+	auto                        data   = config->get();
+	std::shared_ptr<obs_data_t> cfg(obs_data_get_obj(data.get(), ST_CFG_QOS), streamfx::obs::obs_data_deleter);
+	if (!cfg) {
+		return;
+	}
+	obs_data_set_default_int(cfg.get(), ST_CFG_QOS_MAXLEVEL, 2);
+
+	_max_level = static_cast<uint32_t>(std::clamp<int64_t>(obs_data_get_int(cfg.get(), ST_CFG_QOS_MAXLEVEL), 0, 2));
+	if (_max_level == 0) {
+		D_LOG_INFO("Automatic quality reduction is disabled.");
+	}
+}
+
+void streamfx::gfx::qos::update()
+{
+	if (_max_level == 0) {
+		return;
+	}
+
+	// Only look once per frame, no matter how many filters ask.
+	if (uint64_t frame = obs_get_video_frame_time(); frame != _frame) {
+		_frame = frame;
+	} else {
+		return;
+	}
+
+	uint64_t now = os_gettime_ns();
+	if (_window_start == 0) {
+		_window_start  = now;
+		_window_lagged = obs_get_lagged_frames();
+		return;
+	} else if ((now - _window_start) < window_ns) {
+		return;
+	}
+
+	uint32_t lagged   = obs_get_lagged_frames();
+	uint64_t interval = obs_get_frame_interval_ns();
+	uint64_t average  = obs_get_average_frame_time_ns();
+	bool     overload = (lagged != _window_lagged) || ((average * 100) > (interval * overload_percent));
+	bool     headroom = !overload && ((average * 100) < (interval * headroom_percent));
+	_window_start     = now;
+	_window_lagged    = lagged;
+
+	uint32_t level = _level.load();
+	uint32_t next  = level;
+	if (overload) {
+		_headroom_windows = 0;
+		next              = std::min(level + 1, _max_level);
+	} else if (headroom && (level > 0)) {
+		if (++_headroom_windows >= recover_windows) {
+			_headroom_windows = 0;
+			next              = level - 1;
+		}
+	} else {
+		_headroom_windows = 0;
+	}
+
+	if (next != level) {
+		D_LOG_INFO("Quality level changed from %" PRIu32 " to %" PRIu32 ", rendering takes %.2f ms of %.2f ms with %" PRIu32 " lagged frames.", level, next, static_cast<double_t>(average) / 1000000., static_cast<double_t>(interval) / 1000000., lagged);
+		_level.store(next);
+	}
+}
+
+uint32_t streamfx::gfx::qos::level()
+{
+	std::unique_lock<std::mutex> lock(_lock);
+	update();
+	return _level.load();
+}
+
+std::shared_ptr<streamfx::gfx::qos> streamfx::gfx::qos::get()
+{
+	static std::weak_ptr<streamfx::gfx::qos> instance;
+	static std::mutex                        lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (instance.expired()) {
+		auto hard_instance = std::shared_ptr<streamfx::gfx::qos>(new streamfx::gfx::qos());
+		instance           = hard_instance;
+		return hard_instance;
+	}
+	return instance.lock();
+}
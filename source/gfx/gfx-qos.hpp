@@ -0,0 +1,52 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Lowers the quality of expensive filters while OBS takes longer to render a frame than it has time for.
+	 *
+	 * Render time and lagged frames are checked once per second. If rendering took too long, the quality level is
+	 * raised by one step, and after several seconds with enough headroom it is lowered again. What a level means is up
+	 * to each filter, with higher levels being cheaper:
+	 * - 1: Blur uses half the samples, Virtual Greenscreen runs inference half as often, Shaders render at 75% size.
+	 * - 2: Upscaling is bypassed, Shaders render at 50% size.
+	 *
+	 * Configured in the "QoS" object of the global configuration:
+	 * - "MaxLevel": Highest level that may be reached, 2 by default. 0 disables this.
+	 *
+	 * Every change of level is logged.
+	 */
+	class qos {
+		std::mutex            _lock;
+		uint32_t              _max_level;
+		std::atomic<uint32_t> _level;
+		uint64_t              _frame;
+		uint64_t              _window_start;
+		uint32_t              _window_lagged;
+		uint32_t              _headroom_windows;
+
+		public:
+		~qos();
+
+		private:
+		qos();
+
+		void update();
+
+		public:
+		/** Current quality level, 0 being full quality. Graphics thread only. */
+		uint32_t level();
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::gfx::qos> get();
+	};
+} // namespace streamfx::gfx
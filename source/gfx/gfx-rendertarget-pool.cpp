@@ -0,0 +1,120 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-rendertarget-pool.hpp"
+#include "obs/gs/gs-helper.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <util/platform.h>
+#include "warning-enable.hpp"
+
+// Targets which have not been used for this many frames are destroyed.
+constexpr uint64_t evict_frames = 3;
+
+static std::atomic<uint64_t> statistics_hits{0};
+static std::atomic<uint64_t> statistics_misses{0};
+static std::atomic<uint64_t> statistics_idle{0};
+
+std::shared_ptr<streamfx::gfx::rendertarget_pool> streamfx::gfx::rendertarget_pool::get()
+{
+	static std::weak_ptr<streamfx::gfx::rendertarget_pool> instance;
+	static std::mutex                                      lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (instance.expired()) {
+		auto hard_instance = std::shared_ptr<streamfx::gfx::rendertarget_pool>(new streamfx::gfx::rendertarget_pool());
+		instance           = hard_instance;
+		return hard_instance;
+	}
+	return instance.lock();
+}
+
+streamfx::gfx::rendertarget_pool::statistics streamfx::gfx::rendertarget_pool::get_statistics()
+{
+	return {statistics_hits.load(), statistics_misses.load(), statistics_idle.load()};
+}
+
+streamfx::gfx::rendertarget_pool::rendertarget_pool() : _lock(), _free(), _vram("rendertarget_pool", [this]() { trim(); }) {}
+
+streamfx::gfx::rendertarget_pool::~rendertarget_pool()
+{
+	auto gctx = streamfx::obs::gs::context();
+	for (auto& kv : _free) {
+		statistics_idle -= kv.second.size();
+	}
+	_free.clear();
+}
+
+std::shared_ptr<streamfx::obs::gs::rendertarget> streamfx::gfx::rendertarget_pool::acquire(gs_color_format format, uint32_t width, uint32_t height)
+{
+	return acquire(format, GS_ZS_NONE, width, height);
+}
+
+std::shared_ptr<streamfx::obs::gs::rendertarget> streamfx::gfx::rendertarget_pool::acquire(gs_color_format format, gs_zstencil_format zs_format, uint32_t width, uint32_t height)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	key_t                        key = {format, zs_format, width, height};
+
+	// Only ever called while rendering, which makes this a good place to get rid of what nobody needs anymore.
+	evict(os_gettime_ns());
+
+	_vram.touch();
+
+	std::unique_ptr<streamfx::obs::gs::rendertarget> target;
+	if (auto kv = _free.find(key); (kv != _free.end()) && !kv->second.empty()) {
+		// Reuse the most recently released target, so that the others can expire.
+		target = std::move(kv->second.back().target);
+		kv->second.pop_back();
+		++statistics_hits;
+		--statistics_idle;
+	} else {
+		// Charged to the pool instead of whoever asked first, as it is shared with everyone after them.
+		::streamfx::gfx::vram::scope vscope(_vram.get_account());
+		target = std::make_unique<streamfx::obs::gs::rendertarget>(format, zs_format);
+		++statistics_misses;
+	}
+
+	std::weak_ptr<streamfx::gfx::rendertarget_pool> wself = weak_from_this();
+	return std::shared_ptr<streamfx::obs::gs::rendertarget>(target.release(), [wself, key](streamfx::obs::gs::rendertarget* rt) {
+		if (auto self = wself.lock(); self) {
+			self->release(key, rt);
+		} else {
+			auto gctx = streamfx::obs::gs::context();
+			delete rt;
+		}
+	});
+}
+
+void streamfx::gfx::rendertarget_pool::release(key_t key, streamfx::obs::gs::rendertarget* target)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	_free[key].push_back({std::unique_ptr<streamfx::obs::gs::rendertarget>(target), os_gettime_ns()});
+	++statistics_idle;
+}
+
+void streamfx::gfx::rendertarget_pool::evict(uint64_t now)
+{
+	uint64_t timeout = obs_get_frame_interval_ns() * evict_frames;
+
+	for (auto kv = _free.begin(); kv != _free.end();) {
+		std::size_t before = kv->second.size();
+		kv->second.remove_if([now, timeout](const entry& v) { return (now - v.released) > timeout; });
+		statistics_idle -= before - kv->second.size();
+		if (kv->second.empty()) {
+			kv = _free.erase(kv);
+		} else {
+			kv++;
+		}
+	}
+}
+
+void streamfx::gfx::rendertarget_pool::trim()
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	for (auto& kv : _free) {
+		statistics_idle -= kv.second.size();
+	}
+	_free.clear();
+}
@@ -0,0 +1,69 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gfx/gfx-vram.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+
+#include "warning-disable.hpp"
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Shares render targets that are only needed while rendering, such as the intermediate passes of a blur.
+	 *
+	 * Targets are handed out by format and size, and return to the pool once the last reference to them is gone. Targets
+	 * which have not been used for a few frames are destroyed, so memory usage follows what is rendered concurrently
+	 * instead of how many users there are.
+	 */
+	class rendertarget_pool : public std::enable_shared_from_this<rendertarget_pool> {
+		typedef std::tuple<gs_color_format, gs_zstencil_format, uint32_t, uint32_t> key_t;
+
+		struct entry {
+			std::unique_ptr<::streamfx::obs::gs::rendertarget> target;
+			uint64_t                                           released;
+		};
+
+		std::mutex                        _lock;
+		std::map<key_t, std::list<entry>> _free;
+		::streamfx::gfx::vram::cache      _vram; // Idle targets are given up when over budget.
+
+		public:
+		struct statistics {
+			uint64_t hits;   // Acquired targets that were reused.
+			uint64_t misses; // Acquired targets that had to be created.
+			uint64_t idle;   // Targets waiting to be reused.
+		};
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::gfx::rendertarget_pool> get();
+
+		/** Usage since the plugin was loaded, safe to call from any thread without holding on to the pool. */
+		static statistics get_statistics();
+
+		private:
+		rendertarget_pool();
+
+		public:
+		~rendertarget_pool();
+
+		/** Retrieve a render target of the given format and size, which is only valid until released. */
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> acquire(gs_color_format format, uint32_t width, uint32_t height);
+
+		/** Retrieve a render target of the given formats and size, which is only valid until released. */
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> acquire(gs_color_format format, gs_zstencil_format zs_format, uint32_t width, uint32_t height);
+
+		private:
+		void release(key_t key, ::streamfx::obs::gs::rendertarget* target);
+
+		void evict(uint64_t now);
+
+		void trim();
+	};
+} // namespace streamfx::gfx
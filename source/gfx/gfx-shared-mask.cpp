@@ -0,0 +1,74 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-shared-mask.hpp"
+#include "obs/gs/gs-helper.hpp"
+
+streamfx::gfx::shared_masks::shared_masks() : _lock(), _entries() {}
+
+streamfx::gfx::shared_masks::~shared_masks()
+{
+	auto gctx = streamfx::obs::gs::context();
+	_entries.clear();
+}
+
+void streamfx::gfx::shared_masks::publish(const std::string& name, const void* publisher, std::shared_ptr<streamfx::obs::gs::rendertarget> target)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	auto&                        entry = _entries[name];
+	entry.publisher                    = publisher;
+	entry.target                       = std::move(target);
+	entry.frame                        = obs_get_video_frame_time();
+}
+
+void streamfx::gfx::shared_masks::withdraw(const void* publisher)
+{
+	// The last reference to a target may be ours, so release them with the context held.
+	auto                         gctx = streamfx::obs::gs::context();
+	std::unique_lock<std::mutex> ul(_lock);
+	for (auto iter = _entries.begin(); iter != _entries.end();) {
+		if (iter->second.publisher == publisher) {
+			iter = _entries.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+}
+
+std::shared_ptr<streamfx::obs::gs::rendertarget> streamfx::gfx::shared_masks::find(const std::string& name)
+{
+	uint64_t now = obs_get_video_frame_time();
+
+	std::unique_lock<std::mutex> ul(_lock);
+	auto                         iter = _entries.find(name);
+	if ((iter == _entries.end()) || ((now - iter->second.frame) > obs_get_frame_interval_ns())) {
+		return nullptr;
+	}
+	return iter->second.target;
+}
+
+std::list<std::string> streamfx::gfx::shared_masks::names()
+{
+	std::list<std::string> result;
+
+	std::unique_lock<std::mutex> ul(_lock);
+	for (auto& kv : _entries) {
+		result.push_back(kv.first);
+	}
+	return result;
+}
+
+std::shared_ptr<streamfx::gfx::shared_masks> streamfx::gfx::shared_masks::get()
+{
+	static std::weak_ptr<streamfx::gfx::shared_masks> instance;
+	static std::mutex                                 lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (instance.expired()) {
+		auto hard_instance = std::shared_ptr<streamfx::gfx::shared_masks>(new streamfx::gfx::shared_masks());
+		instance           = hard_instance;
+		return hard_instance;
+	}
+	return instance.lock();
+}
@@ -0,0 +1,59 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+
+#include "warning-disable.hpp"
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Masks that one filter computes and any number of others use, so that segmentation runs once per frame.
+	 *
+	 * Publishers render their mask into the alpha channel of a render target of their own, and publish it under a name
+	 * the user picked. Consumers look it up by that name while rendering, and only get it if it was rendered recently,
+	 * as a publisher on a hidden source no longer updates it. A consumer rendered before the publisher in the same
+	 * frame sees the mask of the previous frame. Graphics thread only, apart from names().
+	 */
+	class shared_masks {
+		struct entry {
+			const void*                                      publisher;
+			std::shared_ptr<streamfx::obs::gs::rendertarget> target;
+			uint64_t                                         frame; // Video frame time of the last update.
+		};
+
+		std::mutex                   _lock;
+		std::map<std::string, entry> _entries;
+
+		private:
+		shared_masks();
+
+		public:
+		~shared_masks();
+
+		/** Mark the mask under name as updated for this frame, replacing what anyone else published under it. */
+		void publish(const std::string& name, const void* publisher, std::shared_ptr<streamfx::obs::gs::rendertarget> target);
+
+		/** Remove every mask of a publisher, for example when it is destroyed or its mask was renamed. */
+		void withdraw(const void* publisher);
+
+		/** The mask under name if it was updated in this or the previous frame, or nullptr otherwise.
+		 *
+		 * Don't hold on to it past the current frame, so that the publisher can let go of it.
+		 */
+		std::shared_ptr<streamfx::obs::gs::rendertarget> find(const std::string& name);
+
+		/** Names of all published masks, for the user to pick from. */
+		std::list<std::string> names();
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::gfx::shared_masks> get();
+	};
+} // namespace streamfx::gfx
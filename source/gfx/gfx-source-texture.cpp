@@ -7,9 +7,119 @@
 #include "obs/obs-tools.hpp"
 
 #include "warning-disable.hpp"
+#include <mutex>
 #include <stdexcept>
 #include "warning-enable.hpp"
 
+// Entries are released once their source has not been rendered for this long.
+static constexpr uint64_t unused_timeout = 1'000'000'000; // ns
+
+std::shared_ptr<streamfx::gfx::source_texture_cache> streamfx::gfx::source_texture_cache::get()
+{
+	static std::weak_ptr<streamfx::gfx::source_texture_cache> instance;
+	static std::mutex                                         lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (instance.expired()) {
+		auto hard_instance = std::shared_ptr<streamfx::gfx::source_texture_cache>(new streamfx::gfx::source_texture_cache());
+		instance           = hard_instance;
+		return hard_instance;
+	}
+	return instance.lock();
+}
+
+streamfx::gfx::source_texture_cache::source_texture_cache()
+	: _entries(), _vram("source_texture_cache", [this]() {
+		  // Graphics tasks run before the next frame starts, so keep only what the last frame rendered.
+		  uint64_t frame = obs_get_video_frame_time();
+		  for (auto iter = _entries.begin(); iter != _entries.end();) {
+			  if (iter->second.frame != frame) {
+				  iter = _entries.erase(iter);
+			  } else {
+				  iter++;
+			  }
+		  }
+	  })
+{}
+
+streamfx::gfx::source_texture_cache::~source_texture_cache()
+{
+	auto gctx = streamfx::obs::gs::context();
+	_entries.clear();
+}
+
+std::shared_ptr<streamfx::obs::gs::texture> streamfx::gfx::source_texture_cache::render(obs_source_t* source, uint32_t width, uint32_t height, gs_color_space space, gs_color_format format, bool linear_srgb)
+{
+	uint64_t frame = obs_get_video_frame_time();
+
+	// Forget about sources nobody asked for in a while.
+	for (auto iter = _entries.begin(); iter != _entries.end();) {
+		if ((frame - iter->second.frame) > unused_timeout) {
+			iter = _entries.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+
+	_vram.touch();
+
+	auto& entry = _entries[{source, width, height, space, format, linear_srgb}];
+	if (entry.texture && (entry.frame == frame)) {
+		return entry.texture;
+	}
+
+	if (!entry.rt) {
+		::streamfx::gfx::vram::scope vscope(_vram.get_account());
+		entry.rt = std::make_shared<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+	}
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	auto cctr = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_capture, "gfx::source_texture_cache '%s'", obs_source_get_name(source));
+#endif
+
+	auto previous_lsrgb = gs_get_linear_srgb();
+	gs_set_linear_srgb(linear_srgb);
+	bool previous_srgb = gs_framebuffer_srgb_enabled();
+	gs_enable_framebuffer_srgb(false);
+	gs_blend_state_push();
+
+	try {
+		auto op = entry.rt->render(width, height, space);
+
+		gs_reset_blend_state();
+		gs_enable_blending(false);
+		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+		gs_enable_color(true, true, true, true);
+		gs_set_cull_mode(GS_NEITHER);
+		gs_enable_depth_test(false);
+		gs_depth_function(GS_ALWAYS);
+		gs_enable_stencil_test(false);
+		gs_enable_stencil_write(false);
+		gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
+		gs_stencil_op(GS_STENCIL_BOTH, GS_KEEP, GS_KEEP, GS_KEEP);
+
+		gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), -1., 1.);
+		vec4 black;
+		vec4_zero(&black);
+		gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
+
+		obs_source_video_render(source);
+	} catch (...) {
+		gs_blend_state_pop();
+		gs_enable_framebuffer_srgb(previous_srgb);
+		gs_set_linear_srgb(previous_lsrgb);
+		throw;
+	}
+
+	gs_blend_state_pop();
+	gs_enable_framebuffer_srgb(previous_srgb);
+	gs_set_linear_srgb(previous_lsrgb);
+
+	entry.rt->get_texture(entry.texture);
+	entry.frame = frame;
+	return entry.texture;
+}
+
 streamfx::gfx::source_texture::~source_texture()
 {
 	if (_child && _parent) {
@@ -31,7 +141,7 @@ streamfx::gfx::source_texture::source_texture(streamfx::obs::source child, strea
 		throw std::runtime_error("Child contains Parent");
 	}
 
-	_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	_cache = streamfx::gfx::source_texture_cache::get();
 }
 
 obs_source_t* streamfx::gfx::source_texture::get_object()
@@ -67,19 +177,15 @@ std::shared_ptr<streamfx::obs::gs::texture> streamfx::gfx::source_texture::rende
 		return nullptr;
 	}
 
-	if (_child) {
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		auto cctr = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_capture, "gfx::source_texture '%s'", obs_source_get_name(_child.get()));
-#endif
-		auto op = _rt->render(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
-		vec4 black;
-		vec4_zero(&black);
-		gs_ortho(0, static_cast<float>(width), 0, static_cast<float_t>(height), 0, 1);
-		gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
-		obs_source_video_render(_child.get());
-	}
+	// Shared with everyone else rendering the same source this frame.
+	return _cache->render(_child.get(), static_cast<uint32_t>(width), static_cast<uint32_t>(height), GS_CS_SRGB, GS_RGBA, gs_get_linear_srgb());
+}
 
-	std::shared_ptr<streamfx::obs::gs::texture> tex;
-	_rt->get_texture(tex);
-	return tex;
+bool streamfx::gfx::source_texture::read_back(streamfx::obs::gs::readback& target, std::size_t width, std::size_t height)
+{
+	auto texture = render(width, height);
+	if (!texture) {
+		return false;
+	}
+	return target.stage(texture->get_object());
 }
@@ -4,6 +4,8 @@
 
 #pragma once
 #include "common.hpp"
+#include "gfx/gfx-vram.hpp"
+#include "obs/gs/gs-readback.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
 #include "obs/obs-source.hpp"
@@ -11,14 +13,39 @@
 
 #include "warning-disable.hpp"
 #include <map>
+#include <tuple>
 #include "warning-enable.hpp"
 
 namespace streamfx::gfx {
+	/** Renders each source at most once per frame, no matter how many filters sample it at the same size and format. */
+	class source_texture_cache {
+		struct entry {
+			std::shared_ptr<streamfx::obs::gs::rendertarget> rt;
+			std::shared_ptr<streamfx::obs::gs::texture>      texture;
+			uint64_t                                         frame;
+		};
+
+		std::map<std::tuple<obs_source_t*, uint32_t, uint32_t, gs_color_space, gs_color_format, bool>, entry> _entries;
+		::streamfx::gfx::vram::cache                                                                          _vram; // Sources not rendered this frame are given up when over budget.
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::gfx::source_texture_cache> get();
+
+		private:
+		source_texture_cache();
+
+		public:
+		~source_texture_cache();
+
+		/** Texture of source as rendered during this frame, which must not be modified. Graphics thread only. */
+		std::shared_ptr<streamfx::obs::gs::texture> render(obs_source_t* source, uint32_t width, uint32_t height, gs_color_space space, gs_color_format format, bool linear_srgb);
+	};
+
 	class source_texture {
 		streamfx::obs::source _parent;
 		streamfx::obs::source _child;
 
-		std::shared_ptr<streamfx::obs::gs::rendertarget> _rt;
+		std::shared_ptr<streamfx::gfx::source_texture_cache> _cache;
 
 		public:
 		~source_texture();
@@ -35,6 +62,9 @@ namespace streamfx::gfx {
 		public:
 		std::shared_ptr<streamfx::obs::gs::texture> render(std::size_t width, std::size_t height);
 
+		/** Render the source and queue a copy of it for reading back, see obs::gs::readback::stage(). */
+		bool read_back(streamfx::obs::gs::readback& target, std::size_t width, std::size_t height);
+
 		public: // Unsafe Methods
 		void clear();
 
@@ -26,6 +26,9 @@
 #define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
 #endif
 
+// Vertices collected before they have to be drawn. Every draw uploads all of them, so this shouldn't be too large.
+constexpr uint32_t batch_capacity = 1024;
+
 std::shared_ptr<streamfx::gfx::util> streamfx::gfx::util::get()
 {
 	static std::weak_ptr<streamfx::gfx::util> instance;
@@ -40,12 +43,13 @@ std::shared_ptr<streamfx::gfx::util> streamfx::gfx::util::get()
 	return instance.lock();
 }
 
-streamfx::gfx::util::util()
+streamfx::gfx::util::util() : _effect(), _effect_color(nullptr), _batch_vb(), _batch_mode(GS_LINES), _batch_size(0), _fstri_vb()
 {
 	{
 		std::filesystem::path file = ::streamfx::data_file_path("effects/standard.effect");
 		try {
-			_effect = std::make_shared<::streamfx::obs::gs::effect>(file);
+			_effect       = std::make_shared<::streamfx::obs::gs::effect>(file);
+			_effect_color = _effect->get_technique("Color");
 		} catch (...) {
 			D_LOG_ERROR("Failed to load '%s'.", file.generic_u8string().c_str());
 		}
@@ -56,69 +60,25 @@ streamfx::gfx::util::~util()
 {
 	obs::gs::context gctx{};
 
-	_point_vb.reset();
-	_line_vb.reset();
-	_arrow_vb.reset();
-	_quad_vb.reset();
+	_batch_vb.reset();
+	_fstri_vb.reset();
 }
 
 void streamfx::gfx::util::draw_point(float x, float y, uint32_t color)
 {
-	obs::gs::context gctx{};
-
-	if (!_point_vb) {
-		_point_vb = std::make_shared<obs::gs::vertex_buffer>(uint32_t{1}, uint8_t{1});
-	}
-
-	{
-		auto vtx = _point_vb->at(0);
-		vec3_set(vtx.position, x, y, 0.);
-		*vtx.color = color;
-	}
-
-	gs_load_indexbuffer(nullptr);
-	gs_load_vertexbuffer(_point_vb->update(true));
-	while (gs_effect_loop(_effect->get_object(), "Color")) {
-		gs_draw(GS_POINTS, 0, 1);
-	}
-	gs_load_vertexbuffer(nullptr);
+	reserve(GS_POINTS, 1);
+	push(x, y, color);
 }
 
 void streamfx::gfx::util::draw_line(float x, float y, float x2, float y2, uint32_t color /*= 0xFFFFFFFF*/)
 {
-	obs::gs::context gctx{};
-
-	if (!_line_vb) {
-		_line_vb = std::make_shared<obs::gs::vertex_buffer>(uint32_t{2}, uint8_t{1});
-	}
-
-	{
-		auto vtx = _line_vb->at(0);
-		vec3_set(vtx.position, x, y, 0.);
-		*vtx.color = color;
-	}
-	{
-		auto vtx = _line_vb->at(1);
-		vec3_set(vtx.position, x2, y2, 0.);
-		*vtx.color = color;
-	}
-
-	gs_load_indexbuffer(nullptr);
-	gs_load_vertexbuffer(_line_vb->update(true));
-	while (gs_effect_loop(_effect->get_object(), "Color")) {
-		gs_draw(GS_LINES, 0, 2);
-	}
-	gs_load_vertexbuffer(nullptr);
+	reserve(GS_LINES, 2);
+	push(x, y, color);
+	push(x2, y2, color);
 }
 
 void streamfx::gfx::util::draw_arrow(float x, float y, float x2, float y2, float w /*= 0.*/, uint32_t color /*= 0xFFFFFFFF*/)
 {
-	obs::gs::context gctx{};
-
-	if (!_arrow_vb) {
-		_arrow_vb = std::make_shared<obs::gs::vertex_buffer>(uint32_t{5}, uint8_t{1});
-	}
-
 	float dx  = x2 - x;
 	float dy  = y2 - y;
 	float ang = atan2(-dx, dy);
@@ -134,120 +94,81 @@ void streamfx::gfx::util::draw_arrow(float x, float y, float x2, float y2, float
 	vec3 offset;
 	vec3_set(&offset, x, y, 0.);
 
-	{
-		auto vtx = _arrow_vb->at(0);
-		vec3_set(vtx.position, 0, 0, 0.);
-		vec3_transform(vtx.position, vtx.position, &rotator);
-		vec3_add(vtx.position, vtx.position, &offset);
-		*vtx.color = color;
-	}
-	{
-		auto vtx = _arrow_vb->at(1);
-		vec3_set(vtx.position, 0, len, 0.);
-		vec3_transform(vtx.position, vtx.position, &rotator);
-		vec3_add(vtx.position, vtx.position, &offset);
-		*vtx.color = color;
-	}
-	{
-		auto vtx = _arrow_vb->at(2);
-		vec3_set(vtx.position, -w, len - w, 0.);
-		vec3_transform(vtx.position, vtx.position, &rotator);
-		vec3_add(vtx.position, vtx.position, &offset);
-		*vtx.color = color;
-	}
-	{
-		auto vtx = _arrow_vb->at(3);
-		vec3_set(vtx.position, w, len - w, 0.);
-		vec3_transform(vtx.position, vtx.position, &rotator);
-		vec3_add(vtx.position, vtx.position, &offset);
-		*vtx.color = color;
-	}
-	{
-		auto vtx = _arrow_vb->at(4);
-		vec3_set(vtx.position, 0, len, 0.);
-		vec3_transform(vtx.position, vtx.position, &rotator);
-		vec3_add(vtx.position, vtx.position, &offset);
-		*vtx.color = color;
+	// Shaft, and the head as a triangle outline around the tip.
+	vec3 points[4];
+	vec3_set(&points[0], 0, 0, 0.);
+	vec3_set(&points[1], 0, len, 0.);
+	vec3_set(&points[2], -w, len - w, 0.);
+	vec3_set(&points[3], w, len - w, 0.);
+	for (auto& point : points) {
+		vec3_transform(&point, &point, &rotator);
+		vec3_add(&point, &point, &offset);
 	}
 
-	gs_load_indexbuffer(nullptr);
-	gs_load_vertexbuffer(_arrow_vb->update(true));
-	while (gs_effect_loop(_effect->get_object(), "Color")) {
-		gs_draw(GS_LINESTRIP, 0, 5);
+	reserve(GS_LINES, 8);
+	for (auto [from, to] : {std::pair{0, 1}, std::pair{1, 2}, std::pair{2, 3}, std::pair{3, 1}}) {
+		push(points[from].x, points[from].y, color);
+		push(points[to].x, points[to].y, color);
 	}
-	gs_load_vertexbuffer(nullptr);
 }
 
 void streamfx::gfx::util::draw_rectangle(float x, float y, float w, float h, bool frame, uint32_t color /*= 0xFFFFFFFF*/)
 {
-	obs::gs::context gctx{};
+	if (frame) {
+		reserve(GS_LINES, 8);
+		push(x, y, color);
+		push(x + w, y, color);
+		push(x + w, y, color);
+		push(x + w, y + h, color);
+		push(x + w, y + h, color);
+		push(x, y + h, color);
+		push(x, y + h, color);
+		push(x, y, color);
+	} else {
+		reserve(GS_TRIS, 6);
+		push(x, y, color);
+		push(x + w, y, color);
+		push(x, y + h, color);
+		push(x + w, y, color);
+		push(x + w, y + h, color);
+		push(x, y + h, color);
+	}
+}
 
-	if (!_quad_vb) {
-		_quad_vb = std::make_shared<obs::gs::vertex_buffer>(uint32_t{5}, uint8_t{1});
+void streamfx::gfx::util::flush()
+{
+	if (_batch_size == 0) {
+		return;
 	}
 
-	if (frame) {
-		{
-			auto vtx = _quad_vb->at(0);
-			vec3_set(vtx.position, x, y, 0.);
-			*vtx.color = color;
-		}
-		{
-			auto vtx = _quad_vb->at(1);
-			vec3_set(vtx.position, x + w, y, 0.);
-			*vtx.color = color;
-		}
-		{
-			auto vtx = _quad_vb->at(2);
-			vec3_set(vtx.position, x + w, y + h, 0.);
-			*vtx.color = color;
-		}
-		{
-			auto vtx = _quad_vb->at(3);
-			vec3_set(vtx.position, x, y + h, 0.);
-			*vtx.color = color;
-		}
-		{
-			auto vtx = _quad_vb->at(4);
-			vec3_set(vtx.position, x, y, 0.);
-			*vtx.color = color;
-		}
+	obs::gs::context gctx{};
 
-		gs_load_indexbuffer(nullptr);
-		gs_load_vertexbuffer(_quad_vb->update(true));
-		while (gs_effect_loop(_effect->get_object(), "Color")) {
-			gs_draw(GS_LINESTRIP, 0, 5);
-		}
-		gs_load_vertexbuffer(nullptr);
-	} else {
-		{
-			auto vtx = _quad_vb->at(0);
-			vec3_set(vtx.position, x, y, 0.);
-			*vtx.color = color;
-		}
-		{
-			auto vtx = _quad_vb->at(1);
-			vec3_set(vtx.position, x + w, y, 0.);
-			*vtx.color = color;
-		}
-		{
-			auto vtx = _quad_vb->at(2);
-			vec3_set(vtx.position, x, y + h, 0.);
-			*vtx.color = color;
-		}
-		{
-			auto vtx = _quad_vb->at(3);
-			vec3_set(vtx.position, x + w, y + h, 0.);
-			*vtx.color = color;
-		}
+	gs_load_indexbuffer(nullptr);
+	gs_load_vertexbuffer(_batch_vb->update(true));
+	_effect_color.draw([this]() { gs_draw(_batch_mode, 0, _batch_size); });
+	gs_load_vertexbuffer(nullptr);
 
-		gs_load_indexbuffer(nullptr);
-		gs_load_vertexbuffer(_quad_vb->update(true));
-		while (gs_effect_loop(_effect->get_object(), "Color")) {
-			gs_draw(GS_TRISTRIP, 0, 4);
-		}
-		gs_load_vertexbuffer(nullptr);
+	_batch_size = 0;
+}
+
+void streamfx::gfx::util::reserve(gs_draw_mode mode, uint32_t vertices)
+{
+	if (!_batch_vb) {
+		obs::gs::context gctx{};
+		_batch_vb = std::make_shared<obs::gs::vertex_buffer>(batch_capacity, uint8_t{1});
 	}
+
+	if ((mode != _batch_mode) || ((_batch_size + vertices) > _batch_vb->capacity())) {
+		flush();
+	}
+	_batch_mode = mode;
+}
+
+void streamfx::gfx::util::push(float x, float y, uint32_t color)
+{
+	auto vtx = _batch_vb->at(_batch_size++);
+	vec3_set(vtx.position, x, y, 0.);
+	*vtx.color = color;
 }
 
 void streamfx::gfx::util::draw_fullscreen_triangle()
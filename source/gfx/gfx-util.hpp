@@ -11,12 +11,18 @@
 #include "warning-enable.hpp"
 
 namespace streamfx::gfx {
+	/** Simple shapes in a single color, mostly for debug views.
+	 *
+	 * Points, lines, arrows and rectangles are collected into one vertex buffer and drawn together, with one draw for
+	 * each run of the same kind of primitive. Anything collected is drawn by flush(), which has to be called before
+	 * changing the render target, matrices or blend state, and before the end of the render callback.
+	 */
 	class util {
 		std::shared_ptr<::streamfx::obs::gs::effect>        _effect;
-		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _point_vb;
-		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _line_vb;
-		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _arrow_vb;
-		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _quad_vb;
+		::streamfx::obs::gs::effect_technique               _effect_color;
+		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _batch_vb;
+		gs_draw_mode                                        _batch_mode;
+		uint32_t                                            _batch_size;
 		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _fstri_vb;
 
 		public /* Singleton */:
@@ -36,6 +42,15 @@ namespace streamfx::gfx {
 
 		void draw_rectangle(float x, float y, float w, float h, bool frame, uint32_t color = 0xFFFFFFFF);
 
+		/** Draw everything collected so far. */
+		void flush();
+
 		void draw_fullscreen_triangle();
+
+		private:
+		/** Make room for a primitive, drawing what was collected if it is of a different kind or doesn't fit. */
+		void reserve(gs_draw_mode mode, uint32_t vertices);
+
+		void push(float x, float y, uint32_t color);
 	};
 } // namespace streamfx::gfx
@@ -0,0 +1,259 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-vram.hpp"
+#include "configuration.hpp"
+#include "obs/obs-tools.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <list>
+#include <mutex>
+#include <util/platform.h>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<gfx::vram> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_CFG_VRAM "VRAM"
+#define ST_CFG_VRAM_BUDGET "Budget"
+
+static std::atomic<uint64_t> totals[streamfx::gfx::vram::kinds];
+static std::atomic<uint64_t> budget{0};
+static std::atomic<uint64_t> statistics_trims{0};
+static std::atomic<bool>     trim_queued{false};
+
+static thread_local std::shared_ptr<streamfx::gfx::vram::account> current_account;
+
+// Caches in no particular order, the eviction order is decided when trimming.
+static std::mutex& caches_lock()
+{
+	static std::mutex lock;
+	return lock;
+}
+
+static std::list<streamfx::gfx::vram::cache*>& caches()
+{
+	static std::list<streamfx::gfx::vram::cache*> list;
+	return list;
+}
+
+static uint64_t total_bytes()
+{
+	uint64_t bytes = 0;
+	for (auto& total : totals) {
+		bytes += total.load();
+	}
+	return bytes;
+}
+
+streamfx::gfx::vram::account::account() : _bytes(0) {}
+
+uint64_t streamfx::gfx::vram::account::bytes()
+{
+	return _bytes.load();
+}
+
+void streamfx::gfx::vram::account::add(int64_t bytes)
+{
+	_bytes += static_cast<uint64_t>(bytes);
+}
+
+streamfx::gfx::vram::allocation::~allocation()
+{
+	resize(0);
+}
+
+streamfx::gfx::vram::allocation::allocation(kind type, uint64_t bytes) : _account(current()), _kind(type), _bytes(0)
+{
+	resize(bytes);
+}
+
+void streamfx::gfx::vram::allocation::resize(uint64_t bytes)
+{
+	int64_t difference = static_cast<int64_t>(bytes) - static_cast<int64_t>(_bytes);
+	if (difference == 0) {
+		return;
+	}
+
+	_bytes = bytes;
+	if (_account) {
+		_account->add(difference);
+	}
+	charge(_kind, difference);
+}
+
+uint64_t streamfx::gfx::vram::allocation::bytes()
+{
+	return _bytes;
+}
+
+streamfx::gfx::vram::scope::~scope()
+{
+	current_account = std::move(_previous);
+}
+
+streamfx::gfx::vram::scope::scope(std::shared_ptr<account> owner) : _previous(std::move(current_account))
+{
+	current_account = std::move(owner);
+}
+
+streamfx::gfx::vram::cache::~cache()
+{
+	std::lock_guard<std::mutex> lg(caches_lock());
+	caches().remove(this);
+}
+
+streamfx::gfx::vram::cache::cache(std::string name, std::function<void()> trim) : _name(std::move(name)), _account(std::make_shared<account>()), _trim(std::move(trim)), _used(os_gettime_ns())
+{
+	std::lock_guard<std::mutex> lg(caches_lock());
+	caches().push_back(this);
+}
+
+void streamfx::gfx::vram::cache::touch()
+{
+	_used = os_gettime_ns();
+}
+
+std::shared_ptr<streamfx::gfx::vram::account> streamfx::gfx::vram::cache::get_account()
+{
+	return _account;
+}
+
+std::shared_ptr<streamfx::gfx::vram::account> streamfx::gfx::vram::current()
+{
+	return current_account;
+}
+
+uint64_t streamfx::gfx::vram::texture_size(gs_color_format format, uint32_t width, uint32_t height, uint32_t depth, uint32_t levels)
+{
+	uint64_t bits = 0;
+	for (uint32_t level = 0; level < std::max<uint32_t>(levels, 1); level++) {
+		bits += static_cast<uint64_t>(std::max<uint32_t>(width >> level, 1)) * std::max<uint32_t>(height >> level, 1) * std::max<uint32_t>(depth >> level, 1) * gs_get_format_bpp(format);
+	}
+	return bits / 8;
+}
+
+uint64_t streamfx::gfx::vram::zstencil_size(gs_zstencil_format format, uint32_t width, uint32_t height)
+{
+	uint64_t pixels = static_cast<uint64_t>(width) * height;
+	switch (format) {
+	case GS_Z16:
+		return pixels * 2;
+	case GS_Z24_S8:
+	case GS_Z32F:
+		return pixels * 4;
+	case GS_Z32F_S8X24:
+		return pixels * 8;
+	default:
+		return 0;
+	}
+}
+
+streamfx::gfx::vram::statistics streamfx::gfx::vram::get_statistics()
+{
+	statistics result = {};
+	for (std::size_t idx = 0; idx < kinds; idx++) {
+		result.bytes[idx] = totals[idx].load();
+	}
+	result.budget = budget.load();
+	result.trims  = statistics_trims.load();
+
+	std::lock_guard<std::mutex> lg(caches_lock());
+	for (auto entry : caches()) {
+		result.caches.emplace_back(entry->_name, entry->_account->bytes());
+	}
+	return result;
+}
+
+void streamfx::gfx::vram::set_budget(uint64_t bytes)
+{
+	budget = bytes;
+	if (bytes > 0) {
+		D_LOG_INFO("Trimming caches while above %" PRIu64 " MiB of video memory.", bytes >> 20);
+	}
+}
+
+void streamfx::gfx::vram::charge(kind type, int64_t bytes)
+{
+	totals[static_cast<std::size_t>(type)] += static_cast<uint64_t>(bytes);
+
+	// Only growing can take us above the budget. Trimming right here could free what the caller is rendering with.
+	uint64_t limit = budget.load();
+	if ((bytes > 0) && (limit > 0) && (total_bytes() > limit) && !trim_queued.exchange(true)) {
+		obs_queue_task(
+			OBS_TASK_GRAPHICS,
+			[](void*) {
+				trim_queued = false;
+				trim();
+			},
+			nullptr, false);
+	}
+}
+
+void streamfx::gfx::vram::trim()
+{
+	uint64_t limit = budget.load();
+	if (limit == 0) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lg(caches_lock());
+	std::vector<cache*>         order(caches().begin(), caches().end());
+	std::sort(order.begin(), order.end(), [](cache* a, cache* b) { return a->_used.load() < b->_used.load(); });
+
+	for (auto entry : order) {
+		if (total_bytes() <= limit) {
+			break;
+		}
+		if (entry->_account->bytes() == 0) {
+			continue;
+		}
+
+		entry->_trim();
+		++statistics_trims;
+		D_LOG_DEBUG("Trimmed '%s' to %" PRIu64 " bytes.", entry->_name.c_str(), entry->_account->bytes());
+	}
+
+	// Whatever is left is in use, and only the instances holding it can give it up.
+	static bool warned = false;
+	if (uint64_t bytes = total_bytes(); bytes > limit) {
+		if (!warned) {
+			D_LOG_WARNING("Still holding %" PRIu64 " MiB of video memory after trimming all caches, which is above the budget of %" PRIu64 " MiB.", bytes >> 20, limit >> 20);
+			warned = true;
+		}
+	} else {
+		warned = false;
+	}
+}
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		auto                        config = streamfx::configuration::instance();
+		auto                        data   = config->get();
+		std::shared_ptr<obs_data_t> cfg(obs_data_get_obj(data.get(), ST_CFG_VRAM), streamfx::obs::obs_data_deleter);
+		if (!cfg) {
+			return;
+		}
+		obs_data_set_default_int(cfg.get(), ST_CFG_VRAM_BUDGET, 0);
+		streamfx::gfx::vram::set_budget(static_cast<uint64_t>(std::max<int64_t>(obs_data_get_int(cfg.get(), ST_CFG_VRAM_BUDGET), 0)) << 20);
+	},
+	[]() { // Finalizer
+		streamfx::gfx::vram::set_budget(0);
+	},
+	streamfx::loader_priority::NORMAL);
@@ -0,0 +1,134 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	/** Accounting of the video memory held by StreamFX, with an optional budget that caches are trimmed down to.
+	 *
+	 * Every texture, render target and CUDA buffer that StreamFX creates is charged to the account that was current on
+	 * the creating thread, which is the instance while one of its callbacks runs, or the cache that creates it.
+	 * Allocations made outside of either only count towards the totals.
+	 *
+	 * Configured in the "VRAM" object of the global configuration:
+	 * - "Budget": MiB that StreamFX should stay below, 0 for no limit (default).
+	 *
+	 * The budget is soft: going above it never fails an allocation, but has the caches give up memory at the start of
+	 * the next frame, least recently used first, until the totals are back below it or nothing is left to give up.
+	 */
+	class vram {
+		public:
+		enum class kind : uint8_t {
+			TEXTURE,
+			RENDERTARGET,
+			CUDA,
+		};
+		static constexpr std::size_t kinds = 3;
+
+		/** Bytes held on behalf of one owner. Thread-safe. */
+		class account {
+			std::atomic<uint64_t> _bytes;
+
+			public:
+			account();
+
+			uint64_t bytes();
+
+			void add(int64_t bytes);
+		};
+
+		/** Memory held by one object, charged to the account that was current when it was created. */
+		class allocation {
+			std::shared_ptr<account> _account;
+			kind                     _kind;
+			uint64_t                 _bytes;
+
+			public:
+			~allocation();
+			allocation(kind type, uint64_t bytes = 0);
+
+			allocation(const allocation&)            = delete;
+			allocation& operator=(const allocation&) = delete;
+
+			/** Change the size, such as when a render target is rendered at a different size. */
+			void resize(uint64_t bytes);
+
+			uint64_t bytes();
+		};
+
+		/** Charges everything created on this thread to the account while it exists. */
+		class scope {
+			std::shared_ptr<account> _previous;
+
+			public:
+			~scope();
+			scope(std::shared_ptr<account> owner);
+
+			scope(const scope&)            = delete;
+			scope& operator=(const scope&) = delete;
+		};
+
+		/** Memory that can be given up when over budget, such as idle render targets.
+		 *
+		 * The trim function runs on the graphics thread, outside of any rendering, and must not create or destroy caches.
+		 */
+		class cache {
+			friend class vram;
+
+			std::string              _name;
+			std::shared_ptr<account> _account;
+			std::function<void()>    _trim;
+			std::atomic<uint64_t>    _used;
+
+			public:
+			~cache();
+			cache(std::string name, std::function<void()> trim);
+
+			cache(const cache&)            = delete;
+			cache& operator=(const cache&) = delete;
+
+			/** Mark as used right now, which moves it to the back of the eviction order. */
+			void touch();
+
+			/** Account to create the memory of this cache with. */
+			std::shared_ptr<account> get_account();
+		};
+
+		struct statistics {
+			uint64_t                                      bytes[kinds];
+			uint64_t                                      budget; // 0 if there is none.
+			uint64_t                                      trims;  // Caches that gave up memory for the budget.
+			std::vector<std::pair<std::string, uint64_t>> caches; // Memory held by each cache, by name.
+		};
+
+		public:
+		/** Account that new objects are charged to on this thread, may be nullptr. */
+		static std::shared_ptr<account> current();
+
+		/** Size of a texture in bytes, in the format and with the mip levels given. */
+		static uint64_t texture_size(gs_color_format format, uint32_t width, uint32_t height, uint32_t depth = 1, uint32_t levels = 1);
+
+		/** Size of a depth and stencil buffer in bytes. */
+		static uint64_t zstencil_size(gs_zstencil_format format, uint32_t width, uint32_t height);
+
+		/** Totals and the memory held by each cache, safe to call from any thread. */
+		static statistics get_statistics();
+
+		static void set_budget(uint64_t bytes);
+
+		private:
+		static void charge(kind type, int64_t bytes);
+
+		static void trim();
+	};
+} // namespace streamfx::gfx
@@ -6,20 +6,51 @@
 #include "gfx-lut-consumer.hpp"
 #include "obs/gs/gs-helper.hpp"
 
-streamfx::gfx::lut::consumer::consumer()
+#include "warning-disable.hpp"
+#include <cstring>
+#include <vector>
+#include "warning-enable.hpp"
+
+static std::size_t pixel_size(gs_color_format format)
+{
+	switch (format) {
+	case GS_RGBA:
+	case GS_R10G10B10A2:
+		return 4;
+	case GS_RGBA16:
+		return 8;
+	case GS_RGBA32F:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+streamfx::gfx::lut::consumer::consumer() : _stage(nullptr), _stage_depth(streamfx::gfx::lut::color_depth::Invalid), _stage_format(GS_UNKNOWN), _stage_frame(0), _stage_pending(false), _volume_supported(true)
 {
+	// The effects are only loaded once the first LUT is used, see prepare() and stage().
 	_data = streamfx::gfx::lut::data::instance();
-	if (!_data->consumer_effect())
-		throw std::runtime_error("Unable to get LUT consumer effect.");
 }
 
-streamfx::gfx::lut::consumer::~consumer() = default;
+streamfx::gfx::lut::consumer::~consumer()
+{
+	if (_stage) {
+		auto gctx = streamfx::obs::gs::context();
+		gs_stagesurface_destroy(_stage);
+	}
+}
 
 std::shared_ptr<streamfx::obs::gs::effect> streamfx::gfx::lut::consumer::prepare(streamfx::gfx::lut::color_depth depth, std::shared_ptr<streamfx::obs::gs::texture> lut)
 {
 	auto gctx = streamfx::obs::gs::context();
 
 	auto effect = _data->consumer_effect();
+	if (!effect) {
+		throw std::runtime_error("Unable to get LUT consumer effect.");
+	}
+	if (lut && (lut->get_type() == streamfx::obs::gs::texture::type::Volume) && _data->consumer_volume_effect()) {
+		effect = _data->consumer_volume_effect();
+	}
 
 	int32_t idepth         = static_cast<int32_t>(depth);
 	int32_t size           = static_cast<int32_t>(pow(2l, idepth));
@@ -45,6 +76,80 @@ std::shared_ptr<streamfx::obs::gs::effect> streamfx::gfx::lut::consumer::prepare
 	return effect;
 }
 
+void streamfx::gfx::lut::consumer::stage(streamfx::gfx::lut::color_depth depth, std::shared_ptr<streamfx::obs::gs::texture> lut)
+{
+	_stage_pending = false;
+	if (_volume_supported && !_data->consumer_volume_effect()) {
+		_volume_supported = false;
+	}
+	if (!_volume_supported || !lut || (pixel_size(lut->get_color_format()) == 0)) {
+		return;
+	}
+
+	auto gctx = streamfx::obs::gs::context();
+
+	if (!_stage || (gs_stagesurface_get_color_format(_stage) != lut->get_color_format()) || (gs_stagesurface_get_width(_stage) != lut->get_width()) || (gs_stagesurface_get_height(_stage) != lut->get_height())) {
+		if (_stage) {
+			gs_stagesurface_destroy(_stage);
+		}
+		_stage = gs_stagesurface_create(lut->get_width(), lut->get_height(), lut->get_color_format());
+		if (!_stage) {
+			return;
+		}
+	}
+
+	gs_stage_texture(_stage, lut->get_object());
+	_stage_depth   = depth;
+	_stage_format  = lut->get_color_format();
+	_stage_frame   = obs_get_video_frame_time();
+	_stage_pending = true;
+}
+
+std::shared_ptr<streamfx::obs::gs::texture> streamfx::gfx::lut::consumer::volume()
+{
+	// Mapping in the same frame as the copy would wait for the GPU to catch up.
+	if (!_stage_pending || (_stage_frame == obs_get_video_frame_time())) {
+		return nullptr;
+	}
+	_stage_pending = false;
+
+	auto gctx = streamfx::obs::gs::context();
+
+	std::size_t bpp       = pixel_size(_stage_format);
+	uint32_t    idepth    = static_cast<uint32_t>(_stage_depth);
+	uint32_t    size      = 1u << idepth;
+	uint32_t    grid_size = 1u << (idepth / 2);
+
+	// Each blue slice is a size x size cell in the grid, see lut.effect.
+	std::vector<uint8_t> buffer(static_cast<std::size_t>(size) * size * size * bpp);
+	{
+		uint8_t* data     = nullptr;
+		uint32_t linesize = 0;
+		if (!gs_stagesurface_map(_stage, &data, &linesize)) {
+			return nullptr;
+		}
+
+		for (uint32_t b = 0; b < size; b++) {
+			std::size_t cell_x = (b % grid_size) * size;
+			std::size_t cell_y = (b / grid_size) * size;
+			for (uint32_t g = 0; g < size; g++) {
+				memcpy(buffer.data() + ((static_cast<std::size_t>(b) * size + g) * size * bpp), data + ((cell_y + g) * linesize) + (cell_x * bpp), size * bpp);
+			}
+		}
+
+		gs_stagesurface_unmap(_stage);
+	}
+
+	try {
+		const uint8_t* mip_data[] = {buffer.data()};
+		return std::make_shared<streamfx::obs::gs::texture>(size, size, size, _stage_format, 1, mip_data, streamfx::obs::gs::texture::flags::None);
+	} catch (const std::exception& ex) {
+		DLOG_WARNING("Volume textures are unavailable, LUTs stay packed: %s", ex.what());
+		_volume_supported = false;
+		return nullptr;
+	}
+}
+
 void streamfx::gfx::lut::consumer::consume(streamfx::gfx::lut::color_depth depth, std::shared_ptr<streamfx::obs::gs::texture> lut, std::shared_ptr<streamfx::obs::gs::texture> texture)
 {
 	auto gctx = streamfx::obs::gs::context();
@@ -15,12 +15,27 @@ namespace streamfx::gfx::lut {
 	class consumer {
 		std::shared_ptr<streamfx::gfx::lut::data> _data;
 
+		// Conversion into a volume texture.
+		gs_stagesurf_t*                 _stage;
+		streamfx::gfx::lut::color_depth _stage_depth;
+		gs_color_format                 _stage_format;
+		uint64_t                        _stage_frame;
+		bool                            _stage_pending;
+		bool                            _volume_supported;
+
 		public:
 		consumer();
 		~consumer();
 
+		/** Prepare the effect for a LUT, volume textures use a single hardware filtered fetch instead of the manual slice blend. */
 		std::shared_ptr<streamfx::obs::gs::effect> prepare(streamfx::gfx::lut::color_depth depth, std::shared_ptr<streamfx::obs::gs::texture> lut);
 
+		/** Start converting a packed LUT into a volume texture, which volume() returns in a later frame. */
+		void stage(streamfx::gfx::lut::color_depth depth, std::shared_ptr<streamfx::obs::gs::texture> lut);
+
+		/** The volume texture for the last staged LUT, or nullptr if it is not ready yet or not supported. */
+		std::shared_ptr<streamfx::obs::gs::texture> volume();
+
 		void consume(streamfx::gfx::lut::color_depth depth, std::shared_ptr<streamfx::obs::gs::texture> lut, std::shared_ptr<streamfx::obs::gs::texture> texture);
 	};
 } // namespace streamfx::gfx::lut
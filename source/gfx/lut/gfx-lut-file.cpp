@@ -0,0 +1,286 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-lut-file.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "util/util-platform.hpp"
+#include "util/util-threadpool.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include "warning-enable.hpp"
+
+// Largest LUT_3D_SIZE accepted, anything above is far beyond what any tool produces.
+constexpr uint32_t max_cube_size = 256;
+
+static inline bool is_space(char c)
+{
+	return (c == ' ') || (c == '\t') || (c == '\r');
+}
+
+static inline void skip_space(const char*& p, const char* end)
+{
+	while ((p < end) && is_space(*p)) {
+		p++;
+	}
+}
+
+// Locale independent, as '.cube' files always use '.' as the decimal separator.
+static bool parse_float(const char*& p, const char* end, float& result)
+{
+	skip_space(p, end);
+
+	bool negative = false;
+	if ((p < end) && ((*p == '-') || (*p == '+'))) {
+		negative = (*p == '-');
+		p++;
+	}
+
+	double   value  = 0.;
+	int32_t  scale  = 0;
+	uint32_t digits = 0;
+	for (; (p < end) && (*p >= '0') && (*p <= '9'); p++, digits++) {
+		value = value * 10. + (*p - '0');
+	}
+	if ((p < end) && (*p == '.')) {
+		for (p++; (p < end) && (*p >= '0') && (*p <= '9'); p++, digits++) {
+			value = value * 10. + (*p - '0');
+			scale--;
+		}
+	}
+	if (digits == 0) {
+		return false;
+	}
+	if ((p < end) && ((*p == 'e') || (*p == 'E'))) {
+		p++;
+		bool    exp_negative = false;
+		int32_t exponent     = 0;
+		if ((p < end) && ((*p == '-') || (*p == '+'))) {
+			exp_negative = (*p == '-');
+			p++;
+		}
+		for (; (p < end) && (*p >= '0') && (*p <= '9'); p++) {
+			exponent = std::min(exponent * 10 + (*p - '0'), 1000);
+		}
+		scale += exp_negative ? -exponent : exponent;
+	}
+
+	result = static_cast<float>((negative ? -value : value) * std::pow(10., scale));
+	return true;
+}
+
+streamfx::gfx::lut::file::file() : _lock(), _ready(false), _depth(streamfx::gfx::lut::color_depth::Invalid), _data(), _texture() {}
+
+streamfx::gfx::lut::file::~file()
+{
+	if (_texture) {
+		auto gctx = streamfx::obs::gs::context();
+		_texture.reset();
+	}
+}
+
+bool streamfx::gfx::lut::file::ready()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	return _ready;
+}
+
+streamfx::gfx::lut::color_depth streamfx::gfx::lut::file::depth()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	return _depth;
+}
+
+std::shared_ptr<streamfx::obs::gs::texture> streamfx::gfx::lut::file::get_texture()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	if (!_texture && !_data.empty()) {
+		uint32_t idepth         = static_cast<uint32_t>(_depth);
+		uint32_t container_size = 1u << (idepth + (idepth / 2));
+
+		const uint8_t* mip_data[] = {reinterpret_cast<const uint8_t*>(_data.data())};
+		_texture                  = std::make_shared<streamfx::obs::gs::texture>(container_size, container_size, GS_RGBA32F, 1, mip_data, streamfx::obs::gs::texture::flags::None);
+
+		// The texture is immutable, so the memory copy is no longer needed.
+		_data.clear();
+		_data.shrink_to_fit();
+	}
+	return _texture;
+}
+
+void streamfx::gfx::lut::file::parse(const std::filesystem::path& path)
+{
+	std::string buffer;
+	{
+		std::ifstream stream(path, std::ios::binary | std::ios::ate);
+		if (!stream) {
+			throw std::runtime_error("Unable to open file.");
+		}
+		buffer.resize(static_cast<std::size_t>(stream.tellg()));
+		stream.seekg(0);
+		stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+	}
+
+	uint32_t           size      = 0;
+	float              domain[6] = {0.f, 0.f, 0.f, 1.f, 1.f, 1.f};
+	std::vector<float> table;
+
+	// Stream through the file a line at a time, without copying any of it.
+	const char* end = buffer.data() + buffer.size();
+	for (const char* line = buffer.data(); line < end;) {
+		const char* line_end = reinterpret_cast<const char*>(memchr(line, '\n', static_cast<std::size_t>(end - line)));
+		if (!line_end) {
+			line_end = end;
+		}
+
+		const char* p = line;
+		line          = line_end + 1;
+
+		skip_space(p, line_end);
+		if ((p == line_end) || (*p == '#')) {
+			continue;
+		}
+
+		if (((*p >= 'A') && (*p <= 'Z')) || ((*p >= 'a') && (*p <= 'z'))) {
+			const char* keyword = p;
+			while ((p < line_end) && !is_space(*p)) {
+				p++;
+			}
+			std::string_view key(keyword, static_cast<std::size_t>(p - keyword));
+
+			if (key == "LUT_3D_SIZE") {
+				float value = 0;
+				if (!parse_float(p, line_end, value) || (value < 2.f) || (value > static_cast<float>(max_cube_size))) {
+					throw std::runtime_error("Invalid LUT_3D_SIZE.");
+				}
+				size = static_cast<uint32_t>(value);
+				table.reserve(static_cast<std::size_t>(size) * size * size * 3);
+			} else if (key == "LUT_1D_SIZE") {
+				throw std::runtime_error("1D LUTs are not supported.");
+			} else if ((key == "DOMAIN_MIN") || (key == "DOMAIN_MAX")) {
+				float* values = domain + ((key == "DOMAIN_MIN") ? 0 : 3);
+				for (std::size_t idx = 0; idx < 3; idx++) {
+					if (!parse_float(p, line_end, values[idx])) {
+						throw std::runtime_error("Invalid domain.");
+					}
+				}
+			}
+			// Everything else (TITLE, LUT_3D_INPUT_RANGE, ...) has no effect on the result.
+			continue;
+		}
+
+		for (std::size_t idx = 0; idx < 3; idx++) {
+			float value;
+			if (!parse_float(p, line_end, value)) {
+				throw std::runtime_error("Invalid table entry.");
+			}
+			table.push_back(value);
+		}
+	}
+
+	if ((size == 0) || (table.size() != (static_cast<std::size_t>(size) * size * size * 3))) {
+		throw std::runtime_error("Table does not match LUT_3D_SIZE.");
+	}
+
+	// Resample into the smallest power of two layout which does not lose precision, with even depths only.
+	uint32_t idepth = 2;
+	while (((1u << idepth) < (size - 1)) && (idepth < 8)) {
+		idepth += 2;
+	}
+	uint32_t lsize          = 1u << idepth;
+	uint32_t grid_size      = 1u << (idepth / 2);
+	uint32_t container_size = lsize * grid_size;
+
+	std::vector<float> data(static_cast<std::size_t>(container_size) * container_size * 4);
+	auto               at = [&table, size](uint32_t r, uint32_t g, uint32_t b) { return &table[((static_cast<std::size_t>(b) * size + g) * size + r) * 3]; };
+	for (uint32_t b = 0; b < lsize; b++) {
+		for (uint32_t g = 0; g < lsize; g++) {
+			for (uint32_t r = 0; r < lsize; r++) {
+				// Position of this entry in the table, as the table may cover a different domain.
+				float    pos[3];
+				uint32_t lo[3];
+				uint32_t hi[3];
+				float    fr[3];
+				uint32_t rgb[3] = {r, g, b};
+				for (std::size_t idx = 0; idx < 3; idx++) {
+					float v  = static_cast<float>(rgb[idx]) / static_cast<float>(lsize - 1);
+					float t  = (domain[3 + idx] != domain[idx]) ? (v - domain[idx]) / (domain[3 + idx] - domain[idx]) : v;
+					pos[idx] = std::clamp(t, 0.f, 1.f) * static_cast<float>(size - 1);
+					lo[idx]  = std::min(static_cast<uint32_t>(pos[idx]), size - 2);
+					hi[idx]  = lo[idx] + 1;
+					fr[idx]  = pos[idx] - static_cast<float>(lo[idx]);
+				}
+
+				float* out = &data[((static_cast<std::size_t>((b / grid_size) * lsize + g) * container_size) + ((b % grid_size) * lsize + r)) * 4];
+				for (std::size_t c = 0; c < 3; c++) {
+					float c00 = at(lo[0], lo[1], lo[2])[c] * (1.f - fr[0]) + at(hi[0], lo[1], lo[2])[c] * fr[0];
+					float c10 = at(lo[0], hi[1], lo[2])[c] * (1.f - fr[0]) + at(hi[0], hi[1], lo[2])[c] * fr[0];
+					float c01 = at(lo[0], lo[1], hi[2])[c] * (1.f - fr[0]) + at(hi[0], lo[1], hi[2])[c] * fr[0];
+					float c11 = at(lo[0], hi[1], hi[2])[c] * (1.f - fr[0]) + at(hi[0], hi[1], hi[2])[c] * fr[0];
+					float c0  = c00 * (1.f - fr[1]) + c10 * fr[1];
+					float c1  = c01 * (1.f - fr[1]) + c11 * fr[1];
+					out[c]    = c0 * (1.f - fr[2]) + c1 * fr[2];
+				}
+				out[3] = 1.f;
+			}
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(_lock);
+	_depth = static_cast<streamfx::gfx::lut::color_depth>(idepth);
+	_data  = std::move(data);
+}
+
+std::shared_ptr<streamfx::gfx::lut::file> streamfx::gfx::lut::file::load(const std::filesystem::path& path)
+{
+	static std::mutex                                                     lock;
+	static std::map<std::string, std::weak_ptr<streamfx::gfx::lut::file>> files;
+
+	std::error_code ec;
+	auto            mtime = std::filesystem::last_write_time(path, ec);
+	std::string     key   = path.generic_u8string() + "|" + std::to_string(static_cast<long long>(mtime.time_since_epoch().count()));
+
+	std::unique_lock<std::mutex> ul(lock);
+	for (auto iter = files.begin(); iter != files.end();) {
+		if (iter->second.expired()) {
+			iter = files.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+	if (auto kv = files.find(key); kv != files.end()) {
+		if (auto entry = kv->second.lock(); entry) {
+			return entry;
+		}
+	}
+
+	auto entry = std::make_shared<streamfx::gfx::lut::file>();
+	files[key] = entry;
+
+	std::weak_ptr<streamfx::gfx::lut::file> wentry = entry;
+	streamfx::util::threadpool::threadpool::instance()->push([wentry, path](streamfx::util::threadpool::task_data_t) {
+		auto entry = wentry.lock();
+		if (!entry) {
+			return;
+		}
+
+		try {
+			entry->parse(path);
+		} catch (const std::exception& ex) {
+			DLOG_ERROR("Failed to load LUT '%s': %s", streamfx::util::platform::native_to_utf8(path).generic_u8string().c_str(), ex.what());
+		}
+
+		std::lock_guard<std::mutex> lock(entry->_lock);
+		entry->_ready = true;
+	}, nullptr, ::streamfx::util::threadpool::priority::BACKGROUND);
+
+	return entry;
+}
@@ -0,0 +1,46 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "gfx-lut.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx::lut {
+	/** A 3D LUT from a '.cube' file, resampled into the same packed layout the producer generates.
+	 *
+	 * Files are parsed on the thread pool and shared by everyone using the same file, until it is modified.
+	 */
+	class file {
+		std::mutex                                  _lock;
+		bool                                        _ready;
+		streamfx::gfx::lut::color_depth             _depth;
+		std::vector<float>                          _data;
+		std::shared_ptr<streamfx::obs::gs::texture> _texture;
+
+		public:
+		file();
+		~file();
+
+		/** Has parsing finished? Files which failed to parse are ready, but have no texture. */
+		bool ready();
+
+		streamfx::gfx::lut::color_depth depth();
+
+		/** Retrieve the LUT, uploading it first if necessary. Requires the graphics context. */
+		std::shared_ptr<streamfx::obs::gs::texture> get_texture();
+
+		private:
+		void parse(const std::filesystem::path& path);
+
+		public:
+		static std::shared_ptr<streamfx::gfx::lut::file> load(const std::filesystem::path& path);
+	};
+} // namespace streamfx::gfx::lut
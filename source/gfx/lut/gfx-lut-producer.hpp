@@ -13,9 +13,7 @@
 
 namespace streamfx::gfx::lut {
 	class producer {
-		std::shared_ptr<streamfx::gfx::lut::data>        _data;
-		std::shared_ptr<streamfx::obs::gs::rendertarget> _rt;
-		std::shared_ptr<streamfx::gfx::util>             _gfx_util;
+		std::shared_ptr<streamfx::gfx::lut::data> _data;
 
 		public:
 		producer();
@@ -42,9 +42,45 @@ std::shared_ptr<streamfx::gfx::lut::data> streamfx::gfx::lut::data::instance()
 	return reference;
 }
 
-streamfx::gfx::lut::data::data() : _producer_effect(), _consumer_effect()
+static gs_color_format format_from_depth(streamfx::gfx::lut::color_depth depth)
+{
+	switch (depth) {
+	case streamfx::gfx::lut::color_depth::_2:
+	case streamfx::gfx::lut::color_depth::_4:
+	case streamfx::gfx::lut::color_depth::_6:
+	case streamfx::gfx::lut::color_depth::_8:
+		return gs_color_format::GS_RGBA;
+	case streamfx::gfx::lut::color_depth::_10:
+		return gs_color_format::GS_R10G10B10A2;
+	case streamfx::gfx::lut::color_depth::_12:
+	case streamfx::gfx::lut::color_depth::_14:
+	case streamfx::gfx::lut::color_depth::_16:
+		return gs_color_format::GS_RGBA16;
+	default:
+		return GS_RGBA32F;
+	}
+}
+
+streamfx::gfx::lut::data::data() : _effect_lock(), _effects_loaded(false), _producer_effect(), _consumer_effect(), _consumer_volume_effect(), _gfx_util(::streamfx::gfx::util::get()), _identity_lock(), _identity() {}
+
+streamfx::gfx::lut::data::~data()
 {
 	auto gctx = streamfx::obs::gs::context();
+	_identity.clear();
+	_producer_effect.reset();
+	_consumer_effect.reset();
+	_consumer_volume_effect.reset();
+}
+
+void streamfx::gfx::lut::data::load_effects()
+{
+	// Compiling needs the graphics context, so take it before the lock to keep the order the same everywhere.
+	auto                        gctx = streamfx::obs::gs::context();
+	std::lock_guard<std::mutex> lock(_effect_lock);
+	if (_effects_loaded) {
+		return;
+	}
+	_effects_loaded = true;
 
 	std::filesystem::path lut_producer_path = streamfx::data_file_path("effects/lut-producer.effect");
 	if (std::filesystem::exists(lut_producer_path)) {
@@ -63,11 +99,76 @@ streamfx::gfx::lut::data::data() : _producer_effect(), _consumer_effect()
 			D_LOG_ERROR("Loading LUT Consumer effect failed: %s", ex.what());
 		}
 	}
+
+	std::filesystem::path lut_consumer_volume_path = streamfx::data_file_path("effects/lut-consumer-volume.effect");
+	if (std::filesystem::exists(lut_consumer_volume_path)) {
+		try {
+			_consumer_volume_effect = std::make_shared<streamfx::obs::gs::effect>(lut_consumer_volume_path);
+		} catch (std::exception const& ex) {
+			D_LOG_WARNING("Loading LUT Consumer effect for volume textures failed, falling back to packed LUTs: %s", ex.what());
+		}
+	}
 }
 
-streamfx::gfx::lut::data::~data()
+std::shared_ptr<streamfx::obs::gs::effect> streamfx::gfx::lut::data::producer_effect()
 {
+	load_effects();
+	return _producer_effect;
+}
+
+std::shared_ptr<streamfx::obs::gs::effect> streamfx::gfx::lut::data::consumer_effect()
+{
+	load_effects();
+	return _consumer_effect;
+}
+
+std::shared_ptr<streamfx::obs::gs::effect> streamfx::gfx::lut::data::consumer_volume_effect()
+{
+	load_effects();
+	return _consumer_volume_effect;
+}
+
+std::shared_ptr<streamfx::obs::gs::texture> streamfx::gfx::lut::data::identity(streamfx::gfx::lut::color_depth depth)
+{
+	std::lock_guard<std::mutex> lock(_identity_lock);
+	if (auto kv = _identity.find(depth); kv != _identity.end()) {
+		return kv->second->get_texture();
+	}
+
+	if (!producer_effect()) {
+		return nullptr;
+	}
+
 	auto gctx = streamfx::obs::gs::context();
-	_producer_effect.reset();
-	_consumer_effect.reset();
+	auto rt   = std::make_shared<streamfx::obs::gs::rendertarget>(format_from_depth(depth), GS_ZS_NONE);
+
+	int32_t idepth         = static_cast<int32_t>(depth);
+	int32_t size           = static_cast<int32_t>(pow(2l, idepth));
+	int32_t grid_size      = static_cast<int32_t>(pow(2l, (idepth / 2)));
+	int32_t container_size = static_cast<int32_t>(pow(2l, (idepth + (idepth / 2))));
+
+	{
+		auto op = rt->render(static_cast<uint32_t>(container_size), static_cast<uint32_t>(container_size));
+
+		gs_blend_state_push();
+		gs_enable_color(true, true, true, false);
+		gs_enable_blending(false);
+		gs_enable_stencil_test(false);
+		gs_enable_stencil_write(false);
+		gs_ortho(0, 1, 0, 1, 0, 1);
+
+		if (streamfx::obs::gs::effect_parameter efp = _producer_effect->get_parameter("lut_params_0"); efp) {
+			efp.set_int4(size, grid_size, container_size, 0l);
+		}
+
+		while (gs_effect_loop(_producer_effect->get_object(), "Draw")) {
+			_gfx_util->draw_fullscreen_triangle();
+		}
+
+		gs_enable_color(true, true, true, true);
+		gs_blend_state_pop();
+	}
+
+	_identity.emplace(depth, rt);
+	return rt->get_texture();
 }
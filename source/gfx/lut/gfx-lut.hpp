@@ -3,16 +3,40 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-effect.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/gs/gs-texture.hpp"
 
 #include "warning-disable.hpp"
+#include <map>
 #include <memory>
+#include <mutex>
 #include "warning-enable.hpp"
 
 namespace streamfx::gfx::lut {
+	enum class color_depth {
+		Invalid = 0,
+		_2      = 2,
+		_4      = 4,
+		_6      = 6,
+		_8      = 8,
+		_10     = 10,
+		_12     = 12,
+		_14     = 14,
+		_16     = 16,
+	};
+
 	class data {
+		std::mutex                                 _effect_lock;
+		bool                                       _effects_loaded;
 		std::shared_ptr<streamfx::obs::gs::effect> _producer_effect;
 		std::shared_ptr<streamfx::obs::gs::effect> _consumer_effect;
+		std::shared_ptr<streamfx::obs::gs::effect> _consumer_volume_effect;
+		std::shared_ptr<streamfx::gfx::util>       _gfx_util;
+
+		std::mutex                                                                                  _identity_lock;
+		std::map<streamfx::gfx::lut::color_depth, std::shared_ptr<streamfx::obs::gs::rendertarget>> _identity;
 
 		public:
 		static std::shared_ptr<data> instance();
@@ -20,29 +44,20 @@ namespace streamfx::gfx::lut {
 		private:
 		data();
 
+		void load_effects();
+
 		public:
 		~data();
 
-		inline std::shared_ptr<streamfx::obs::gs::effect> producer_effect()
-		{
-			return _producer_effect;
-		};
+		/** The effects are loaded by whichever of these is called first, which only happens once rendering starts. */
+		std::shared_ptr<streamfx::obs::gs::effect> producer_effect();
 
-		inline std::shared_ptr<streamfx::obs::gs::effect> consumer_effect()
-		{
-			return _consumer_effect;
-		};
-	};
+		std::shared_ptr<streamfx::obs::gs::effect> consumer_effect();
 
-	enum class color_depth {
-		Invalid = 0,
-		_2      = 2,
-		_4      = 4,
-		_6      = 6,
-		_8      = 8,
-		_10     = 10,
-		_12     = 12,
-		_14     = 14,
-		_16     = 16,
+		/** Consumer for LUTs stored as volume textures, empty if the backend can not compile it. */
+		std::shared_ptr<streamfx::obs::gs::effect> consumer_volume_effect();
+
+		/** The identity LUT for a depth, rendered once and never modified afterwards. */
+		std::shared_ptr<streamfx::obs::gs::texture> identity(streamfx::gfx::lut::color_depth depth);
 	};
 } // namespace streamfx::gfx::lut
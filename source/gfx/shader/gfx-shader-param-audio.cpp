@@ -1,3 +1,309 @@
 // AUTOGENERATED COPYRIGHT HEADER START
 // Copyright (C) 2019-2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
 // AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-shader-param-audio.hpp"
+#include "strings.hpp"
+#include "gfx-shader.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "obs/obs-source-tracker.hpp"
+#include "util/util-simd.hpp"
+#include "util/util-threadpool.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <sstream>
+#include "warning-enable.hpp"
+
+#define ST_I18N "Shader.Parameter.Audio"
+#define ST_KEY_SOURCE ".Source"
+#define ST_I18N_SOURCE ST_I18N ".Source"
+
+static constexpr std::string_view _annotation_bins = "bins";
+
+static constexpr double_t pi = 3.14159265358979323846;
+
+namespace streamfx::gfx::shader {
+	/** Everything shared between the audio thread, the thread pool and the graphics thread.
+	 *
+	 * All memory is allocated up front, neither the audio thread nor the analysis ever allocate.
+	 */
+	struct audio_state {
+		std::size_t bins;
+		std::size_t size; // FFT size, always 2 * bins.
+
+		// Ring of mono samples, only ever written by the audio thread.
+		std::vector<float_t>     ring;
+		std::atomic<std::size_t> written;
+
+		// Analysis workspace, only ever touched by the analysis task.
+		std::atomic<bool>     busy;
+		std::vector<float_t>  samples;
+		std::vector<float_t>  window;
+		std::vector<float_t>  re;
+		std::vector<float_t>  im;
+		std::vector<float_t>  twiddle_re;
+		std::vector<float_t>  twiddle_im;
+		std::vector<uint32_t> bitrev;
+		float_t               scale;
+
+		// Latest result, waveform followed by spectrum.
+		std::mutex           lock;
+		std::vector<float_t> result;
+		bool                 fresh;
+
+		audio_state(std::size_t p_bins)
+			: bins(p_bins), size(p_bins * 2), ring(p_bins * 16), written(0), busy(false), samples(size), window(size), re(size), im(size), twiddle_re(size / 2), twiddle_im(size / 2), bitrev(size), scale(0), lock(), result(p_bins * 2), fresh(false)
+		{
+			std::size_t bits = 0;
+			while ((std::size_t{1} << bits) < size) {
+				bits++;
+			}
+
+			double_t window_sum = 0;
+			for (std::size_t idx = 0; idx < size; idx++) {
+				window[idx] = static_cast<float_t>(0.5 - 0.5 * cos((2. * pi * static_cast<double_t>(idx)) / static_cast<double_t>(size - 1)));
+				window_sum += window[idx];
+
+				uint32_t rev = 0;
+				for (std::size_t bit = 0; bit < bits; bit++) {
+					rev |= static_cast<uint32_t>(((idx >> bit) & 1) << (bits - 1 - bit));
+				}
+				bitrev[idx] = rev;
+			}
+			for (std::size_t idx = 0; idx < (size / 2); idx++) {
+				twiddle_re[idx] = static_cast<float_t>(cos((2. * pi * static_cast<double_t>(idx)) / static_cast<double_t>(size)));
+				twiddle_im[idx] = static_cast<float_t>(-sin((2. * pi * static_cast<double_t>(idx)) / static_cast<double_t>(size)));
+			}
+
+			// Normalize so that a full scale sine results in a magnitude of 1.
+			scale = static_cast<float_t>(2. / window_sum);
+		}
+
+		void push(const audio_data* audio, bool muted)
+		{
+			std::size_t channels = 0;
+			for (std::size_t idx = 0; idx < MAX_AV_PLANES; idx++) {
+				if (audio->data[idx]) {
+					channels = idx + 1;
+				}
+			}
+
+			std::size_t pos  = written.load(std::memory_order_relaxed);
+			std::size_t mask = ring.size() - 1;
+			for (std::size_t frame = 0; frame < audio->frames; frame++) {
+				float_t value = 0;
+				if (!muted && channels) {
+					for (std::size_t ch = 0; ch < channels; ch++) {
+						if (audio->data[ch]) {
+							value += reinterpret_cast<const float_t*>(audio->data[ch])[frame];
+						}
+					}
+					value /= static_cast<float_t>(channels);
+				}
+				ring[(pos + frame) & mask] = value;
+			}
+			written.store(pos + audio->frames, std::memory_order_release);
+		}
+
+		void analyze()
+		{
+			// Snapshot the most recent samples, the ring is large enough that the audio thread can not lap us.
+			std::size_t end  = written.load(std::memory_order_acquire);
+			std::size_t mask = ring.size() - 1;
+			for (std::size_t idx = 0; idx < size; idx++) {
+				samples[idx] = (end + idx >= size) ? ring[(end + idx - size) & mask] : 0.f;
+			}
+
+			// Apply the window.
+			auto& simd = streamfx::util::simd::get();
+			simd.multiply(re.data(), samples.data(), window.data(), size);
+			std::fill(im.begin(), im.end(), 0.f);
+
+			fft();
+
+			// Magnitude of the lower half of the spectrum, everything above is mirrored.
+			std::vector<float_t>& magnitude = im; // Reuse, the imaginary part is no longer needed afterwards.
+			simd.magnitude(magnitude.data(), re.data(), im.data(), scale, bins);
+
+			std::unique_lock<std::mutex> ul(lock);
+			std::copy(samples.begin() + static_cast<std::ptrdiff_t>(size - bins), samples.end(), result.begin());
+			std::copy(magnitude.begin(), magnitude.begin() + static_cast<std::ptrdiff_t>(bins), result.begin() + static_cast<std::ptrdiff_t>(bins));
+			fresh = true;
+		}
+
+		void fft()
+		{
+			// Iterative radix-2 Cooley-Tukey, in place.
+			for (std::size_t idx = 0; idx < size; idx++) {
+				std::size_t jdx = bitrev[idx];
+				if (jdx > idx) {
+					std::swap(re[idx], re[jdx]);
+					std::swap(im[idx], im[jdx]);
+				}
+			}
+
+			for (std::size_t len = 2; len <= size; len <<= 1) {
+				std::size_t half = len >> 1;
+				std::size_t step = size / len;
+				for (std::size_t base = 0; base < size; base += len) {
+					for (std::size_t k = 0; k < half; k++) {
+						float_t     wr = twiddle_re[k * step];
+						float_t     wi = twiddle_im[k * step];
+						std::size_t a  = base + k;
+						std::size_t b  = a + half;
+						float_t     tr = re[b] * wr - im[b] * wi;
+						float_t     ti = re[b] * wi + im[b] * wr;
+						re[b]          = re[a] - tr;
+						im[b]          = im[a] - ti;
+						re[a] += tr;
+						im[a] += ti;
+					}
+				}
+			}
+		}
+	};
+} // namespace streamfx::gfx::shader
+
+streamfx::gfx::shader::audio_parameter::audio_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix) : parameter(parent, param, prefix), _keys(), _bins(256), _source_name(), _dirty(true), _dirty_ts(std::chrono::high_resolution_clock::now()), _state(), _signal(), _upload(), _texture()
+{
+	_keys.emplace_back(std::string(get_key()) + ST_KEY_SOURCE);
+
+	if (auto anno = get_parameter().get_annotation(_annotation_bins); anno) {
+		std::size_t bins = static_cast<size_t>(std::clamp<int32_t>(anno.get_default_int(), 16, 4096));
+		_bins            = 16;
+		while (_bins < bins) {
+			_bins <<= 1;
+		}
+	}
+	_upload.resize(_bins * 2);
+}
+
+streamfx::gfx::shader::audio_parameter::~audio_parameter()
+{
+	// Stop the audio thread first, any running analysis only holds on to the state.
+	_signal.reset();
+	_state.reset();
+}
+
+void streamfx::gfx::shader::audio_parameter::defaults(obs_data_t* settings)
+{
+	obs_data_set_default_string(settings, _keys[0].c_str(), "");
+}
+
+void streamfx::gfx::shader::audio_parameter::properties(obs_properties_t* props, obs_data_t* settings)
+{
+	if (!is_visible())
+		return;
+
+	obs_properties_t* pr = obs_properties_create();
+	{
+		auto p = obs_properties_add_group(props, get_key().data(), has_name() ? get_name().data() : get_key().data(), OBS_GROUP_NORMAL, pr);
+		if (has_description())
+			obs_property_set_long_description(p, get_description().data());
+	}
+
+	{
+		auto p = obs_properties_add_list(pr, _keys[0].c_str(), D_TRANSLATE(ST_I18N_SOURCE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+		obs_property_list_add_string(p, "", "");
+		obs::source_tracker::instance()->enumerate(
+			[&p](std::string name, ::streamfx::obs::source) {
+				std::stringstream sstr;
+				sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SOURCE) << ")";
+				obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
+				return false;
+			},
+			obs::source_tracker::filter_audio_sources);
+	}
+}
+
+void streamfx::gfx::shader::audio_parameter::update(obs_data_t* settings)
+{
+	// Value is assigned elsewhere.
+	if (is_automatic())
+		return;
+
+	const char* source_name = obs_data_get_string(settings, _keys[0].c_str());
+	if (_source_name != source_name) {
+		_source_name = source_name;
+		_dirty       = true;
+		_dirty_ts    = std::chrono::high_resolution_clock::now() - std::chrono::milliseconds(1);
+	}
+}
+
+void streamfx::gfx::shader::audio_parameter::assign()
+{
+	if (is_automatic())
+		return;
+
+	// Reattach to the source if it changed, retrying every few seconds if it doesn't exist (yet).
+	if (_dirty && ((_dirty_ts - std::chrono::high_resolution_clock::now()) < std::chrono::milliseconds(0))) {
+		try {
+			_signal.reset();
+			_state.reset();
+
+			if (!_source_name.empty()) {
+				auto source = ::streamfx::obs::source(_source_name);
+				if (!source) {
+					throw std::runtime_error("Specified Source does not exist.");
+				}
+
+				auto state  = std::make_shared<audio_state>(_bins);
+				auto signal = std::make_shared<streamfx::obs::audio_signal_handler>(source);
+				signal->event.add([state](::streamfx::obs::source, const audio_data* audio, bool muted) { state->push(audio, muted); });
+
+				_state  = state;
+				_signal = signal;
+			}
+
+			_dirty = false;
+		} catch (...) {
+			_dirty_ts = std::chrono::high_resolution_clock::now() + std::chrono::milliseconds(5000);
+		}
+	}
+
+	if (!_texture) {
+		_texture = std::make_shared<streamfx::obs::gs::texture>(static_cast<uint32_t>(_bins), 2u, GS_R32F, 1u, nullptr, streamfx::obs::gs::texture::flags::Dynamic);
+		std::fill(_upload.begin(), _upload.end(), 0.f);
+		gs_texture_set_image(_texture->get_object(), reinterpret_cast<const uint8_t*>(_upload.data()), static_cast<uint32_t>(_bins * sizeof(float_t)), false);
+		invalidate();
+	}
+
+	if (auto state = _state; state) {
+		// Upload the latest finished analysis, if there is a new one.
+		bool fresh = false;
+		{
+			std::unique_lock<std::mutex> ul(state->lock);
+			if (state->fresh) {
+				std::copy(state->result.begin(), state->result.end(), _upload.begin());
+				state->fresh = false;
+				fresh        = true;
+			}
+		}
+		if (fresh) {
+			gs_texture_set_image(_texture->get_object(), reinterpret_cast<const uint8_t*>(_upload.data()), static_cast<uint32_t>(_bins * sizeof(float_t)), false);
+		}
+
+		// Queue the next analysis, unless the previous one is still running.
+		if (!state->busy.exchange(true)) {
+			streamfx::util::threadpool::threadpool::instance()->push([state](streamfx::util::threadpool::task_data_t) {
+				state->analyze();
+				state->busy = false;
+			});
+		}
+	}
+
+	// The texture itself never changes, only its content does.
+	if (take_changed()) {
+		get_parameter().set_texture(_texture, false);
+	}
+}
+
+bool streamfx::gfx::shader::audio_parameter::is_static()
+{
+	// Silence stays silent, unless we are still trying to attach to a source.
+	return !_state && !_dirty;
+}
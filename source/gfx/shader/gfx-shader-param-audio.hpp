@@ -1,3 +1,61 @@
 // AUTOGENERATED COPYRIGHT HEADER START
 // Copyright (C) 2019-2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
 // AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gfx-shader-param.hpp"
+#include "obs/gs/gs-texture.hpp"
+#include "obs/obs-signal-handler.hpp"
+
+#include "warning-disable.hpp"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	namespace shader {
+		struct audio_state;
+
+		/** Audio of a source as a 'bins' x 2 R32F texture.
+		 *
+		 * Row 0 holds the most recent samples as a mono waveform (-1..1), row 1 holds the linear magnitude spectrum of
+		 * a Hann windowed FFT over the last 2 * 'bins' samples. Selected with 'string type = "audio";' on a texture,
+		 * the 'bins' annotation sets the width (rounded up to a power of two, 16 to 4096, default 256).
+		 */
+		struct audio_parameter : public parameter {
+			// Descriptor
+			std::vector<std::string> _keys;
+			std::size_t              _bins;
+
+			// Data
+			std::string                                    _source_name;
+			bool                                           _dirty;
+			std::chrono::high_resolution_clock::time_point _dirty_ts;
+
+			// Capture and Analysis
+			std::shared_ptr<audio_state>                         _state;
+			std::shared_ptr<streamfx::obs::audio_signal_handler> _signal;
+
+			// Upload
+			std::vector<float_t>                        _upload;
+			std::shared_ptr<streamfx::obs::gs::texture> _texture;
+
+			public:
+			audio_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix);
+			virtual ~audio_parameter();
+
+			void defaults(obs_data_t* settings) override;
+
+			void properties(obs_properties_t* props, obs_data_t* settings) override;
+
+			void update(obs_data_t* settings) override;
+
+			void assign() override;
+
+			bool is_static() override;
+		};
+	} // namespace shader
+} // namespace streamfx::gfx
@@ -8,6 +8,8 @@
 
 #include "warning-disable.hpp"
 #include <algorithm>
+#include <limits>
+#include <locale>
 #include <map>
 #include <sstream>
 #include <stdexcept>
@@ -51,6 +53,26 @@ inline bool get_annotation_float(streamfx::obs::gs::effect_parameter param, std:
 	return false;
 }
 
+// Vectors are written as constructors, so that the define can be used wherever the uniform could.
+static std::string build_define(std::string_view name, std::string_view type, const std::vector<std::string>& values)
+{
+	std::stringstream ss;
+	ss << "SPECIALIZED_" << name << " ";
+	if (values.size() > 1) {
+		ss << type << values.size() << "(";
+	}
+	for (std::size_t idx = 0; idx < values.size(); idx++) {
+		if (idx > 0) {
+			ss << ", ";
+		}
+		ss << values[idx];
+	}
+	if (values.size() > 1) {
+		ss << ")";
+	}
+	return ss.str();
+}
+
 streamfx::gfx::shader::basic_field_type streamfx::gfx::shader::get_field_type_from_string(std::string_view v)
 {
 	std::map<std::string, basic_field_type> matches = {
@@ -190,13 +212,28 @@ void streamfx::gfx::shader::bool_parameter::update(obs_data_t* settings)
 	if (get_size() == 1) {
 		_data[0] = static_cast<int32_t>(obs_data_get_int(settings, get_key().data()));
 	}
+	invalidate();
 }
 
 void streamfx::gfx::shader::bool_parameter::assign()
 {
+	if (!take_changed())
+		return;
+
 	get_parameter().set_value(_data.data(), _data.size());
 }
 
+std::string streamfx::gfx::shader::bool_parameter::get_define()
+{
+	// TODO: Support for bool[]
+	if (!is_specialized() || (get_size() != 1)) {
+		return {};
+	}
+
+	// As a number, so that the preprocessor can test it with #if.
+	return build_define(get_key(), "bool", {_data[0] ? "1" : "0"});
+}
+
 streamfx::gfx::shader::float_parameter::float_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix) : basic_parameter(parent, param, prefix)
 {
 	_data.resize(get_size());
@@ -289,15 +326,35 @@ void streamfx::gfx::shader::float_parameter::update(obs_data_t* settings)
 	for (std::size_t idx = 0; idx < get_size(); idx++) {
 		_data[idx].f32 = static_cast<float_t>(obs_data_get_double(settings, key_at(idx).data())) * _scale[idx].f32;
 	}
+	invalidate();
 }
 
 void streamfx::gfx::shader::float_parameter::assign()
 {
-	if (is_automatic())
+	if (is_automatic() || !take_changed())
 		return;
 
 	get_parameter().set_value(_data.data(), get_size());
 }
+
+std::string streamfx::gfx::shader::float_parameter::get_define()
+{
+	// Matrices have no constructor that takes a flat list of values.
+	if (!is_specialized() || (get_size() > 4)) {
+		return {};
+	}
+
+	std::vector<std::string> values;
+	for (std::size_t idx = 0; idx < get_size(); idx++) {
+		std::stringstream ss;
+		ss.imbue(std::locale::classic());
+		ss.precision(std::numeric_limits<float_t>::max_digits10);
+		ss << std::showpoint << _data[idx].f32;
+		values.push_back(ss.str());
+	}
+	return build_define(get_key(), "float", values);
+}
+
 static inline obs_property_t* build_int_property(streamfx::gfx::shader::basic_field_type ft, obs_properties_t* props, const char* key, const char* name, int32_t min, int32_t max, int32_t step, std::list<streamfx::gfx::shader::basic_enum_data> edata)
 {
 	switch (ft) {
@@ -389,12 +446,27 @@ void streamfx::gfx::shader::int_parameter::update(obs_data_t* settings)
 	for (std::size_t idx = 0; idx < get_size(); idx++) {
 		_data[idx].i32 = static_cast<int32_t>(obs_data_get_int(settings, key_at(idx).data()) * _scale[idx].i32);
 	}
+	invalidate();
 }
 
 void streamfx::gfx::shader::int_parameter::assign()
 {
-	if (is_automatic())
+	if (is_automatic() || !take_changed())
 		return;
 
 	get_parameter().set_value(_data.data(), get_size());
 }
+
+std::string streamfx::gfx::shader::int_parameter::get_define()
+{
+	// There are no integer vectors with more than 4 components.
+	if (!is_specialized() || (get_size() > 4)) {
+		return {};
+	}
+
+	std::vector<std::string> values;
+	for (std::size_t idx = 0; idx < get_size(); idx++) {
+		values.push_back(std::to_string(_data[idx].i32));
+	}
+	return build_define(get_key(), "int", values);
+}
@@ -99,6 +99,8 @@ namespace streamfx::gfx {
 			void update(obs_data_t* settings) override;
 
 			void assign() override;
+
+			std::string get_define() override;
 		};
 
 		struct float_parameter : public basic_parameter {
@@ -115,6 +117,8 @@ namespace streamfx::gfx {
 			void update(obs_data_t* settings) override;
 
 			void assign() override;
+
+			std::string get_define() override;
 		};
 
 		struct int_parameter : public basic_parameter {
@@ -131,6 +135,8 @@ namespace streamfx::gfx {
 			void update(obs_data_t* settings) override;
 
 			void assign() override;
+
+			std::string get_define() override;
 		};
 
 	} // namespace shader
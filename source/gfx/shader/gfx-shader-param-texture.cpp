@@ -11,15 +11,17 @@
 #include "obs/gs/gs-helper.hpp"
 #include "obs/obs-source-tracker.hpp"
 #include "util/util-platform.hpp"
+#include "util/util-threadpool.hpp"
 
 #include "warning-disable.hpp"
 #include <map>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
+#include <system_error>
 #include "warning-enable.hpp"
 
 // TODO:
-// - FFT Audio Conversion
 // - FFT Variable Size...
 
 // UI:
@@ -44,6 +46,101 @@ static constexpr std::string_view _annotation_default         = "default";
 static constexpr std::string_view _annotation_enum_entry      = "enum_%zu";
 static constexpr std::string_view _annotation_enum_entry_name = "enum_%zu_name";
 
+namespace streamfx::gfx::shader {
+	/** An image file, decoded on the thread pool and uploaded by whoever needs it first once that is done. */
+	struct texture_file {
+		std::mutex                                  lock;
+		bool                                        ready  = false;
+		uint8_t*                                    data   = nullptr;
+		gs_color_format                             format = GS_UNKNOWN;
+		uint32_t                                    width  = 0;
+		uint32_t                                    height = 0;
+		std::shared_ptr<streamfx::obs::gs::texture> texture;
+
+		~texture_file()
+		{
+			if (data) {
+				bfree(data);
+			}
+		}
+
+		/** Upload the decoded image if necessary, requires the graphics context. Returns false if decoding failed. */
+		bool get(std::shared_ptr<streamfx::obs::gs::texture>& result)
+		{
+			std::unique_lock<std::mutex> ul(lock);
+			if (!ready) {
+				return true;
+			}
+
+			if (!texture && data) {
+				const uint8_t* mip_data[] = {data};
+				texture                   = std::make_shared<streamfx::obs::gs::texture>(width, height, format, 1, mip_data, streamfx::obs::gs::texture::flags::None);
+				bfree(data);
+				data = nullptr;
+			}
+
+			result = texture;
+			return static_cast<bool>(texture);
+		}
+	};
+} // namespace streamfx::gfx::shader
+
+// Images are decoded and uploaded once for as long as anyone uses them, a changed file is a new image.
+static std::shared_ptr<streamfx::gfx::shader::texture_file> acquire_file(const std::filesystem::path& path)
+{
+	static std::mutex                                                                lock;
+	static std::map<std::string, std::weak_ptr<streamfx::gfx::shader::texture_file>> textures;
+
+	std::error_code ec;
+	auto            mtime = std::filesystem::last_write_time(path, ec);
+	std::string     key   = path.generic_u8string() + "|" + std::to_string(static_cast<long long>(mtime.time_since_epoch().count()));
+
+	std::unique_lock<std::mutex> ul(lock);
+	for (auto iter = textures.begin(); iter != textures.end();) {
+		if (iter->second.expired()) {
+			iter = textures.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+	if (auto kv = textures.find(key); kv != textures.end()) {
+		if (auto file = kv->second.lock(); file) {
+			return file;
+		}
+	}
+
+	// Decoding a large image takes far longer than a frame, so it must never happen on the graphics thread.
+	auto file     = std::make_shared<streamfx::gfx::shader::texture_file>();
+	textures[key] = file;
+
+	std::weak_ptr<streamfx::gfx::shader::texture_file> wfile = file;
+	std::string                                        name  = streamfx::util::platform::native_to_utf8(path).generic_u8string();
+	streamfx::util::threadpool::threadpool::instance()->push([wfile, name](streamfx::util::threadpool::task_data_t) {
+		// Nobody wants this image anymore.
+		auto file = wfile.lock();
+		if (!file) {
+			return;
+		}
+
+		gs_color_format format = GS_UNKNOWN;
+		uint32_t        width  = 0;
+		uint32_t        height = 0;
+		uint8_t*        data   = gs_create_texture_file_data(name.c_str(), &format, &width, &height);
+		if (!data) {
+			DLOG_ERROR("Failed to load image '%s'.", name.c_str());
+		}
+
+		std::unique_lock<std::mutex> ul(file->lock);
+		file->data   = data;
+		file->format = format;
+		file->width  = width;
+		file->height = height;
+		file->ready  = true;
+	}, nullptr, ::streamfx::util::threadpool::priority::BACKGROUND);
+
+	return file;
+}
+
 streamfx::gfx::shader::texture_field_type streamfx::gfx::shader::get_texture_field_type_from_string(std::string_view v)
 {
 	std::map<std::string, texture_field_type> matches = {
@@ -59,7 +156,7 @@ streamfx::gfx::shader::texture_field_type streamfx::gfx::shader::get_texture_fie
 	return texture_field_type::Input;
 }
 
-streamfx::gfx::shader::texture_parameter::texture_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix) : parameter(parent, param, prefix), _field_type(texture_field_type::Input), _keys(), _values(), _type(texture_type::File), _active(false), _visible(false), _dirty(true), _dirty_ts(std::chrono::high_resolution_clock::now()), _file_path(), _file_texture(), _source_name(), _source(), _source_child(), _source_active(), _source_visible(), _source_rendertarget()
+streamfx::gfx::shader::texture_parameter::texture_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix) : parameter(parent, param, prefix), _field_type(texture_field_type::Input), _keys(), _values(), _type(texture_type::File), _active(false), _visible(false), _dirty(true), _dirty_ts(std::chrono::high_resolution_clock::now()), _file_path(), _file(), _file_texture(), _source_name(), _source(), _source_child(), _source_active(), _source_visible(), _source_cache(), _source_texture()
 {
 	char string_buffer[256];
 
@@ -263,12 +360,16 @@ void streamfx::gfx::shader::texture_parameter::assign()
 			_source_child.reset();
 			_source_active.reset();
 			_source_visible.reset();
-			_source_rendertarget.reset();
-			_file_texture.reset();
+			_source_cache.reset();
+			_source_texture.reset();
+			_file.reset();
 
 			if (((field_type() == texture_field_type::Input) && (_type == texture_type::File)) || (field_type() == texture_field_type::Enum)) {
+				// The previous texture stays in use until the new one is ready.
 				if (!_file_path.empty()) {
-					_file_texture = std::make_shared<streamfx::obs::gs::texture>(streamfx::util::platform::native_to_utf8(_file_path).generic_u8string().c_str());
+					_file = acquire_file(_file_path);
+				} else {
+					_file_texture.reset();
 				}
 			} else if ((field_type() == texture_field_type::Input) && (_type == texture_type::Source)) {
 				// Try and grab the source itself.
@@ -290,18 +391,18 @@ void streamfx::gfx::shader::texture_parameter::assign()
 					visible = ::streamfx::obs::source_showing_reference::add_showing_reference(source);
 				}
 
-				// Create the necessary render target to capture the source.
-				auto rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-
 				// Propagate all of this into the storage.
-				_source_rendertarget = rt;
-				_source_visible      = std::move(visible);
-				_source_active       = std::move(active);
-				_source_child        = child;
-				_source              = source;
+				_source_cache   = ::streamfx::gfx::source_texture_cache::get();
+				_source_visible = std::move(visible);
+				_source_active  = std::move(active);
+				_source_child   = child;
+				_source         = source;
+				_file_texture.reset();
 			}
 
 			_dirty = false;
+			invalidate();
+			get_parent()->invalidate_render();
 		} catch (const std::exception&) {
 			_dirty_ts = std::chrono::high_resolution_clock::now() + std::chrono::milliseconds(5000);
 		} catch (...) {
@@ -310,7 +411,7 @@ void streamfx::gfx::shader::texture_parameter::assign()
 	}
 
 	// If this is a source and active or visible, capture it.
-	if ((_type == texture_type::Source) && (_active || _visible) && _source_rendertarget) {
+	if ((_type == texture_type::Source) && (_active || _visible) && _source_cache) {
 		auto source = _source.lock();
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_capture, "Parameter '%s'", get_key().data()};
@@ -319,41 +420,43 @@ void streamfx::gfx::shader::texture_parameter::assign()
 		uint32_t width  = source.width();
 		uint32_t height = source.height();
 
-		auto op = _source_rendertarget->render(width, height);
-
-		gs_matrix_push();
-		gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), 0, 1);
-
-		// ToDo: Figure out if this breaks some sources.
-		gs_blend_state_push();
-		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-		gs_enable_blending(false);
-
-		gs_enable_color(true, true, true, true);
-
-		obs_source_video_render(source.get());
-
-		gs_blend_state_pop();
-		gs_matrix_pop();
+		// Only the first user in a frame renders, everyone else reuses the result.
+		if ((width > 0) && (height > 0)) {
+			_source_texture = _source_cache->render(source.get(), width, height, GS_CS_SRGB, GS_RGBA, gs_get_linear_srgb());
+		}
 	}
 
 	if (_type == texture_type::Source) {
-		if (_source_rendertarget) {
-			auto tex = _source_rendertarget->get_texture();
-			if (tex) {
-				get_parameter().set_texture(_source_rendertarget->get_texture(), false);
-			} else {
-				get_parameter().set_texture(nullptr, false);
-			}
+		if (_source_cache && _source_texture) {
+			get_parameter().set_texture(_source_texture, false);
 		} else {
 			get_parameter().set_texture(nullptr, false);
 		}
 	} else if (_type == texture_type::File) {
-		if (_file_texture) {
-			// Loaded files are always linear.
-			get_parameter().set_texture(_file_texture, false);
-		} else {
-			get_parameter().set_texture(nullptr, false);
+		if (_file) {
+			std::shared_ptr<streamfx::obs::gs::texture> texture;
+			if (!_file->get(texture)) {
+				// Try again later, same as any other failure to load.
+				_file.reset();
+				_file_texture.reset();
+				_dirty    = true;
+				_dirty_ts = std::chrono::high_resolution_clock::now() + std::chrono::milliseconds(5000);
+				invalidate();
+				get_parent()->invalidate_render();
+			} else if (texture && (texture != _file_texture)) {
+				_file_texture = texture;
+				invalidate();
+				get_parent()->invalidate_render();
+			}
+		}
+
+		if (take_changed()) {
+			if (_file_texture) {
+				// Loaded files are always linear.
+				get_parameter().set_texture(_file_texture, false);
+			} else {
+				get_parameter().set_texture(nullptr, false);
+			}
 		}
 	}
 }
@@ -383,3 +486,9 @@ void streamfx::gfx::shader::texture_parameter::active(bool active)
 		_source_active.reset();
 	}
 }
+
+bool streamfx::gfx::shader::texture_parameter::is_static()
+{
+	// Files only change through update() or when they finish loading, which invalidates the render on its own.
+	return (_type != texture_type::Source);
+}
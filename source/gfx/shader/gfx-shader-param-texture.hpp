@@ -7,6 +7,7 @@
 #pragma once
 #include "common.hpp"
 #include "gfx-shader-param.hpp"
+#include "gfx/gfx-source-texture.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
 #include "obs/obs-source-active-child.hpp"
@@ -38,6 +39,8 @@ namespace streamfx::gfx {
 			std::filesystem::path file;
 		};
 
+		struct texture_file;
+
 		struct texture_enum_data {
 			std::string  name;
 			texture_data data;
@@ -63,6 +66,7 @@ namespace streamfx::gfx {
 
 			// Data: File
 			std::filesystem::path                       _file_path;
+			std::shared_ptr<texture_file>               _file;
 			std::shared_ptr<streamfx::obs::gs::texture> _file_texture;
 
 			// Data: Source
@@ -71,7 +75,8 @@ namespace streamfx::gfx {
 			std::shared_ptr<streamfx::obs::source_active_child>      _source_child;
 			std::shared_ptr<streamfx::obs::source_active_reference>  _source_active;
 			std::shared_ptr<streamfx::obs::source_showing_reference> _source_visible;
-			std::shared_ptr<streamfx::obs::gs::rendertarget>         _source_rendertarget;
+			std::shared_ptr<streamfx::gfx::source_texture_cache>     _source_cache;
+			std::shared_ptr<streamfx::obs::gs::texture>              _source_texture;
 
 			public:
 			texture_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix);
@@ -91,6 +96,8 @@ namespace streamfx::gfx {
 
 			void active(bool enabled) override;
 
+			bool is_static() override;
+
 			public:
 			inline texture_field_type field_type()
 			{
@@ -5,6 +5,7 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "gfx-shader-param.hpp"
+#include "gfx-shader-param-audio.hpp"
 #include "gfx-shader-param-basic.hpp"
 #include "gfx-shader-param-texture.hpp"
 
@@ -16,6 +17,7 @@
 #define ST_ANNO_ORDER "order"
 #define ST_ANNO_VISIBILITY "visible"
 #define ST_ANNO_AUTOMATIC "automatic"
+#define ST_ANNO_SPECIALIZE "specialize"
 #define ST_ANNO_NAME "name"
 #define ST_ANNO_DESCRIPTION "description"
 #define ST_ANNO_TYPE "type"
@@ -95,6 +97,9 @@ streamfx::gfx::shader::parameter_type streamfx::gfx::shader::get_type_from_strin
 	if ((v == "sampler")) {
 		return parameter_type::Sampler;
 	}
+	if ((v == "audio")) {
+		return parameter_type::Audio;
+	}
 	/* To decide on in the future:
 	 * - Double support?
 	 * - Half Support?
@@ -103,7 +108,7 @@ streamfx::gfx::shader::parameter_type streamfx::gfx::shader::get_type_from_strin
 	throw std::invalid_argument("Invalid parameter type string.");
 }
 
-streamfx::gfx::shader::parameter::parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string key_prefix) : _parent(parent), _param(param), _order(0), _key(_param.get_name()), _visible(true), _automatic(false), _name(_key), _description()
+streamfx::gfx::shader::parameter::parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string key_prefix) : _parent(parent), _param(param), _order(0), _key(_param.get_name()), _visible(true), _automatic(false), _specialized(false), _name(_key), _description(), _changed(true)
 {
 	{
 		std::stringstream ss;
@@ -118,6 +123,9 @@ streamfx::gfx::shader::parameter::parameter(streamfx::gfx::shader::shader* paren
 	if (auto anno = _param.get_annotation(ST_ANNO_AUTOMATIC); anno) {
 		_automatic = anno.get_default_bool();
 	}
+	if (auto anno = _param.get_annotation(ST_ANNO_SPECIALIZE); anno) {
+		_specialized = anno.get_default_bool();
+	}
 
 	// Read Order
 	if (auto anno = _param.get_annotation(ST_ANNO_ORDER); anno) {
@@ -171,6 +179,24 @@ void streamfx::gfx::shader::parameter::visible(bool visible) {}
 
 void streamfx::gfx::shader::parameter::active(bool active) {}
 
+bool streamfx::gfx::shader::parameter::is_static()
+{
+	return true;
+}
+
+std::string streamfx::gfx::shader::parameter::get_define()
+{
+	return {};
+}
+
+bool streamfx::gfx::shader::parameter::wants_specialization(streamfx::obs::gs::effect_parameter param)
+{
+	if (auto anno = param.get_annotation(ST_ANNO_SPECIALIZE); anno) {
+		return anno.get_default_bool();
+	}
+	return false;
+}
+
 std::shared_ptr<streamfx::gfx::shader::parameter> streamfx::gfx::shader::parameter::make_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix)
 {
 	if (!parent || !param) {
@@ -180,7 +206,7 @@ std::shared_ptr<streamfx::gfx::shader::parameter> streamfx::gfx::shader::paramet
 	parameter_type real_type = get_type_from_effect_type(param.get_type());
 	if (auto anno = param.get_annotation(ST_ANNO_TYPE); anno) {
 		// We have a type override.
-		real_type = get_type_from_string(param.get_default_string());
+		real_type = get_type_from_string(anno.get_default_string());
 	}
 
 	switch (real_type) {
@@ -192,6 +218,11 @@ std::shared_ptr<streamfx::gfx::shader::parameter> streamfx::gfx::shader::paramet
 		return std::make_shared<streamfx::gfx::shader::float_parameter>(parent, param, prefix);
 	case parameter_type::Texture:
 		return std::make_shared<streamfx::gfx::shader::texture_parameter>(parent, param, prefix);
+	case parameter_type::Audio:
+		if (param.get_type() != streamfx::obs::gs::effect_parameter::type::Texture) {
+			return nullptr;
+		}
+		return std::make_shared<streamfx::gfx::shader::audio_parameter>(parent, param, prefix);
 	default:
 		return nullptr;
 	}
@@ -8,6 +8,7 @@
 #include "obs/gs/gs-effect-parameter.hpp"
 
 #include "warning-disable.hpp"
+#include <atomic>
 #include <list>
 #include <string>
 #include "warning-enable.hpp"
@@ -30,7 +31,9 @@ namespace streamfx::gfx {
 			// Texture with dimensions stored in size (1 = Texture1D, 2 = Texture2D, 3 = Texture3D, 6 = TextureCube).
 			Texture,
 			// Sampler for Textures.
-			Sampler
+			Sampler,
+			// Texture filled with the waveform and spectrum of an audio source.
+			Audio,
 		};
 
 		parameter_type get_type_from_effect_type(streamfx::obs::gs::effect_parameter::type type);
@@ -61,14 +64,30 @@ namespace streamfx::gfx {
 			// Visibility, name and description.
 			bool        _visible;
 			bool        _automatic;
+			bool        _specialized;
 			std::string _name;
 			std::string _description;
 
+			// Has the value changed since it was last assigned to the effect?
+			std::atomic<bool> _changed;
+
 			protected:
 			parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string key_prefix);
 			virtual ~parameter(){};
 
+			/** Check and reset the changed state, assign() only uploads if this returns true. */
+			inline bool take_changed()
+			{
+				return _changed.exchange(false);
+			}
+
 			public:
+			/** Mark the value as changed, called by update() and whenever the effect may hold someone else's value. */
+			inline void invalidate()
+			{
+				_changed = true;
+			}
+
 			virtual void defaults(obs_data_t* settings);
 
 			virtual void properties(obs_properties_t* props, obs_data_t* settings);
@@ -81,6 +100,17 @@ namespace streamfx::gfx {
 
 			virtual void active(bool enabled);
 
+			/** Does the value only ever change through update()? If any parameter isn't, the shader renders every frame. */
+			virtual bool is_static();
+
+			/** Define that compiles the current value into the shader, or nothing if the value is uploaded instead.
+			 *
+			 * Declared by the "specialize" annotation, which only basic types that aren't automatic support. The value
+			 * is then available as SPECIALIZED_ followed by the name of the uniform, which lets loops over it unroll and branches on it disappear.
+			 * Changing it compiles another variant of the shader.
+			 */
+			virtual std::string get_define();
+
 			public:
 			inline streamfx::gfx::shader::shader* get_parent()
 			{
@@ -122,6 +152,11 @@ namespace streamfx::gfx {
 				return _automatic;
 			}
 
+			inline bool is_specialized()
+			{
+				return _specialized && !_automatic;
+			}
+
 			inline bool has_name()
 			{
 				return _name.length() > 0;
@@ -143,6 +178,9 @@ namespace streamfx::gfx {
 			}
 
 			public:
+			/** Does the parameter ask to be specialized? Checked without creating it. */
+			static bool wants_specialization(streamfx::obs::gs::effect_parameter param);
+
 			static std::shared_ptr<parameter> make_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param, std::string prefix);
 		};
 	} // namespace shader
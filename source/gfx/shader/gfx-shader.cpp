@@ -8,11 +8,15 @@
 #include "obs/gs/gs-helper.hpp"
 #include "obs/obs-tools.hpp"
 #include "plugin.hpp"
+#include "util/util-threadpool.hpp"
 
 #include "warning-disable.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstring>
+#include <map>
+#include <mutex>
 #include "warning-enable.hpp"
 
 #define ST_I18N "Shader"
@@ -30,22 +34,80 @@
 #define ST_KEY_SHADER_SIZE_WIDTH ST_KEY_SHADER_SIZE ".Width"
 #define ST_I18N_SHADER_SIZE_HEIGHT ST_I18N_SHADER_SIZE ".Height"
 #define ST_KEY_SHADER_SIZE_HEIGHT ST_KEY_SHADER_SIZE ".Height"
+#define ST_I18N_SHADER_SCALE ST_I18N_SHADER ".Scale"
+#define ST_KEY_SHADER_SCALE ST_KEY_SHADER ".Scale"
 #define ST_I18N_SHADER_SEED ST_I18N_SHADER ".Seed"
 #define ST_KEY_SHADER_SEED ST_KEY_SHADER ".Seed"
+#define ST_I18N_SHADER_RATE ST_I18N_SHADER ".Rate"
+#define ST_KEY_SHADER_RATE ST_KEY_SHADER ".Rate"
+#define ST_I18N_SHADER_RATE_BLEND ST_I18N_SHADER_RATE ".Blend"
+#define ST_KEY_SHADER_RATE_BLEND ST_KEY_SHADER_RATE ".Blend"
 #define ST_I18N_PARAMETERS ST_I18N ".Parameters"
 #define ST_KEY_PARAMETERS "Shader.Parameters"
 
+// Annotations of a texture that is rendered by another technique of the shader.
+#define ST_ANNO_PASS "pass"
+#define ST_ANNO_PASS_SCALE "pass_scale"
+#define ST_ANNO_PASS_FORMAT "pass_format"
+
+// Variants that stay compiled per instance, so that switching back and forth between values does not compile again.
+#define ST_MAX_VARIANTS 4
+
+// Longest interval at which the technique may run, in frames.
+#define ST_MAX_RATE 8
+
+// Effects are shared between instances, so remember who assigned parameters last. Anyone else has to assign everything.
+static std::mutex                                                    effect_owners_lock;
+static std::map<gs_effect_t*, const streamfx::gfx::shader::shader*> effect_owners;
+
+static gs_color_format get_format_from_string(std::string_view v)
+{
+	static const std::map<std::string_view, gs_color_format> formats = {
+		{"rgba", GS_RGBA_UNORM}, {"rgba10", GS_R10G10B10A2}, {"rgba16f", GS_RGBA16F}, {"rgba32f", GS_RGBA32F}, {"r8", GS_R8}, {"r16f", GS_R16F}, {"r32f", GS_R32F}, {"rg16f", GS_RG16F}, {"rg32f", GS_RG32F},
+	};
+	if (auto kv = formats.find(v); kv != formats.end()) {
+		return kv->second;
+	}
+	return GS_UNKNOWN;
+}
+
+// Index of the frame being rendered, the same for every instance.
+static uint64_t current_frame()
+{
+	return obs_get_video_frame_time() / std::max<uint64_t>(obs_get_frame_interval_ns(), 1);
+}
+
+static void forget_effect_owner(const streamfx::gfx::shader::shader* owner)
+{
+	std::unique_lock<std::mutex> lock(effect_owners_lock);
+	for (auto iter = effect_owners.begin(); iter != effect_owners.end();) {
+		if (iter->second == owner) {
+			iter = effect_owners.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+}
+
 streamfx::gfx::shader::shader::shader(obs_source_t* self, shader_mode mode)
-	: _self(self), _gfx_util(::streamfx::gfx::util::get()), _mode(mode), _base_width(1), _base_height(1), _active(true),
+	: _self(self), _gfx_util(::streamfx::gfx::util::get()), _qos(::streamfx::gfx::qos::get()), _rt_pool(::streamfx::gfx::rendertarget_pool::get()), _mode(mode), _base_width(1), _base_height(1), _active(true),
 
-	  _shader(), _shader_file(), _shader_tech("Draw"), _shader_file_mt(), _shader_file_sz(), _shader_file_tick(0),
+	  _shader(), _shader_file(), _shader_tech("Draw"), _technique(nullptr), _shader_file_mt(), _shader_file_sz(), _specialization(), _variants(), _param_time(), _param_view_size(), _param_random(), _param_random_seed(), _assigned_view_size(), _assigned_random_seed(0), _transition_passthrough(0.f, 1.f), _buffers(),
 
-	  _width_type(size_type::Percent), _width_value(1.0), _height_type(size_type::Percent), _height_value(1.0),
+	  _file_watcher(::streamfx::util::file_watcher::instance()), _shader_file_watch(), _compile_lock(), _compile(),
+
+	  _width_type(size_type::Percent), _width_value(1.0), _height_type(size_type::Percent), _height_value(1.0), _render_scale(1.0), _qos_scale(1.0), _rate(1), _rate_blend(false),
 
 	  _have_current_params(false), _time(0), _time_loop(0), _loops(0), _random(), _random_seed(0),
 
-	  _rt_up_to_date(false), _rt(std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE))
+	  _rt_up_to_date(false), _rt_dynamic(true), _reads_dynamic(true), _rt_size(), _rt(std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE)),
+
+	  _rate_phase(0), _rate_frame(0), _rt_previous(), _rt_blend(), _mix_effect(), _mix_effect_loader(streamfx::data_file_path("effects/mask.effect"))
 {
+	// Consecutive instances run on consecutive frames, which spreads them out evenly for any rate.
+	static std::atomic<uint32_t> next_phase{0};
+	_rate_phase = next_phase.fetch_add(1) % ST_MAX_RATE;
+
 	// Initialize random values.
 	_random.seed(static_cast<unsigned long long>(_random_seed));
 	for (size_t idx = 0; idx < 16; idx++) {
@@ -53,7 +115,10 @@ streamfx::gfx::shader::shader::shader(obs_source_t* self, shader_mode mode)
 	}
 }
 
-streamfx::gfx::shader::shader::~shader() = default;
+streamfx::gfx::shader::shader::~shader()
+{
+	forget_effect_owner(this);
+}
 
 bool streamfx::gfx::shader::shader::is_shader_different(const std::filesystem::path& file)
 {
@@ -101,82 +166,306 @@ bool streamfx::gfx::shader::shader::load_shader(const std::filesystem::path& fil
 
 		// Update Shader
 		if (shader_dirty) {
-			_shader           = streamfx::obs::gs::effect(file);
-			_shader_file_mt   = std::filesystem::last_write_time(file);
-			_shader_file_sz   = std::filesystem::file_size(file);
-			_shader_file      = file;
-			_shader_file_tick = 0;
+			std::list<std::string> defines;
+			{ // A synchronous load supersedes any asynchronous one.
+				std::unique_lock<std::mutex> lock(_compile_lock);
+				_compile.reset();
+
+				// Another file has other parameters, which are specialized once they have been loaded.
+				if (file != _shader_file) {
+					_specialization.clear();
+				}
+				defines = _specialization;
+			}
+
+			auto file_mt = std::filesystem::last_write_time(file);
+			auto file_sz = std::filesystem::file_size(file);
+			set_shader(streamfx::obs::gs::effect::create_shared(file, defines), file, file_mt, file_sz);
 		}
 
 		// Update Params
 		if (param_dirty) {
-			auto settings = std::shared_ptr<obs_data_t>(obs_source_get_settings(_self), [](obs_data_t* p) { obs_data_release(p); });
+			load_parameters(tech);
+		}
 
-			bool have_valid_tech = false;
-			for (std::size_t idx = 0; idx < _shader.count_techniques(); idx++) {
-				if (_shader.get_technique(idx).name() == tech) {
-					have_valid_tech = true;
-					break;
-				}
-			}
-			if (have_valid_tech) {
-				_shader_tech = tech;
-			} else {
-				_shader_tech = _shader.get_technique(0).name();
+		return true;
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Loading shader '%s' failed with error: %s", file.c_str(), ex.what());
+		return false;
+	} catch (...) {
+		return false;
+	}
+}
 
-				// Update source data.
-				obs_data_set_string(settings.get(), ST_KEY_SHADER_TECHNIQUE, _shader_tech.c_str());
-			}
+void streamfx::gfx::shader::shader::load_shader_async(const std::filesystem::path& file, std::string_view tech)
+{
+	auto result   = std::make_shared<compile_result>();
+	result->ready = false;
+	result->file  = file;
+	result->tech  = tech;
+
+	{ // Replaces any compile still in progress, its result is simply dropped.
+		std::unique_lock<std::mutex> lock(_compile_lock);
+		if (file != _shader_file) {
+			_specialization.clear();
+		}
+		result->defines = _specialization;
+		_compile        = result;
+	}
+
+	// The task only holds on to the result, so the instance may go away while it is running.
+	streamfx::util::threadpool::threadpool::instance()->push([result](streamfx::util::threadpool::task_data_t) {
+		std::filesystem::file_time_type file_mt;
+		uintmax_t                       file_sz = 0;
+		streamfx::obs::gs::effect       effect;
+		try {
+			file_mt = std::filesystem::last_write_time(result->file);
+			file_sz = std::filesystem::file_size(result->file);
+			effect  = streamfx::obs::gs::effect::create_shared(result->file, result->defines);
+		} catch (const std::exception& ex) {
+			DLOG_ERROR("Loading shader '%s' failed with error: %s", result->file.c_str(), ex.what());
+		}
+
+		std::unique_lock<std::mutex> lock(result->lock);
+		result->file_mt = file_mt;
+		result->file_sz = file_sz;
+		result->effect  = effect;
+		result->ready   = true;
+	}, nullptr, ::streamfx::util::threadpool::priority::BACKGROUND);
+}
+
+void streamfx::gfx::shader::shader::set_shader(streamfx::obs::gs::effect effect, const std::filesystem::path& file, std::filesystem::file_time_type file_mt, uintmax_t file_sz)
+{
+	// The shared effect cache only remembers effects that are still in use, so hold on to the last few variants.
+	if (file != _shader_file) {
+		_variants.clear();
+	}
+	_variants.remove_if([&effect](const streamfx::obs::gs::effect& v) { return v.get() == effect.get(); });
+	_variants.push_front(effect);
+	while (_variants.size() > ST_MAX_VARIANTS) {
+		_variants.pop_back();
+	}
+
+	_shader         = effect;
+	_shader_file_mt = file_mt;
+	_shader_file_sz = file_sz;
+	_shader_file    = file;
+
+	// Whatever we assigned before is gone, so the next frame has to assign everything.
+	forget_effect_owner(this);
+
+	// Look up built-in parameters once, instead of by name every frame.
+	auto find_builtin = [this](std::string_view name, streamfx::obs::gs::effect_parameter::type type) {
+		if (auto el = _shader.get_parameter(name); el && (el.get_type() == type)) {
+			return el;
+		}
+		return streamfx::obs::gs::effect_parameter();
+	};
+	_param_time        = find_builtin("Time", streamfx::obs::gs::effect_parameter::type::Float4);
+	_param_view_size   = find_builtin("ViewSize", streamfx::obs::gs::effect_parameter::type::Float4);
+	_param_random      = find_builtin("Random", streamfx::obs::gs::effect_parameter::type::Matrix);
+	_param_random_seed = find_builtin("RandomSeed", streamfx::obs::gs::effect_parameter::type::Integer);
+
+	// Transitions may widen or disable (with a value outside of 0..1) the range in which they just show one input.
+	_transition_passthrough = {0.f, 1.f};
+	if (auto el = find_builtin("TransitionTime", streamfx::obs::gs::effect_parameter::type::Float); el) {
+		if (auto anno = el.get_annotation("passthrough_a"); anno && (anno.get_type() == streamfx::obs::gs::effect_parameter::type::Float)) {
+			_transition_passthrough.first = anno.get_default_float();
+		}
+		if (auto anno = el.get_annotation("passthrough_b"); anno && (anno.get_type() == streamfx::obs::gs::effect_parameter::type::Float)) {
+			_transition_passthrough.second = anno.get_default_float();
+		}
+	}
 
-			// Clear the shader parameters map and rebuild.
-			_shader_params.clear();
-			auto etech = _shader.get_technique(_shader_tech);
-			for (std::size_t idx = 0; idx < etech.count_passes(); idx++) {
-				auto pass         = etech.get_pass(idx);
-				auto fetch_params = [&](std::size_t count, std::function<streamfx::obs::gs::effect_parameter(std::size_t)> get_func) {
-					for (std::size_t vidx = 0; vidx < count; vidx++) {
-						auto el = get_func(vidx);
-						if (!el)
-							continue;
-
-						auto el_name = el.get_name();
-						auto fnd     = _shader_params.find(el_name);
-						if (fnd != _shader_params.end())
-							continue;
-
-						auto param = streamfx::gfx::shader::parameter::make_parameter(this, el, ST_KEY_PARAMETERS);
-
-						if (param) {
-							_shader_params.insert_or_assign(el_name, param);
-							param->defaults(settings.get());
-							param->update(settings.get());
-						}
-					}
-				};
-
-				auto gvp = [&](std::size_t idx) { return pass.get_vertex_parameter(idx); };
-				fetch_params(pass.count_vertex_parameters(), gvp);
-				auto gpp = [&](std::size_t idx) { return pass.get_pixel_parameter(idx); };
-				fetch_params(pass.count_pixel_parameters(), gpp);
+	// Textures naming a technique in their "pass" annotation are rendered by it, in the order they are declared, so
+	// that techniques can read what earlier ones wrote. They are borrowed from the pool only while rendering.
+	_buffers.clear();
+	for (std::size_t idx = 0; idx < _shader.count_parameters(); idx++) {
+		auto el = _shader.get_parameter(idx);
+		if (!el || (el.get_type() != streamfx::obs::gs::effect_parameter::type::Texture))
+			continue;
+
+		auto anno = el.get_annotation(ST_ANNO_PASS);
+		if (!anno || (anno.get_type() != streamfx::obs::gs::effect_parameter::type::String))
+			continue;
+
+		buffer buf{el, anno.get_default_string(), nullptr, 1.f, GS_RGBA_UNORM};
+		if (buf.technique = _shader.get_technique(buf.tech); !buf.technique) {
+			DLOG_WARNING("Buffer '%s' is rendered by technique '%s', which does not exist.", el.get_name().data(), buf.tech.c_str());
+			continue;
+		}
+		if (auto anno2 = el.get_annotation(ST_ANNO_PASS_SCALE); anno2 && (anno2.get_type() == streamfx::obs::gs::effect_parameter::type::Float)) {
+			buf.scale = std::clamp(anno2.get_default_float(), 0.01f, 1.f);
+		}
+		if (auto anno2 = el.get_annotation(ST_ANNO_PASS_FORMAT); anno2 && (anno2.get_type() == streamfx::obs::gs::effect_parameter::type::String)) {
+			if (auto format = get_format_from_string(anno2.get_default_string()); format != GS_UNKNOWN) {
+				buf.format = format;
+			} else {
+				DLOG_WARNING("Buffer '%s' has an unknown format '%s', using 'rgba' instead.", el.get_name().data(), anno2.get_default_string().c_str());
 			}
 		}
+		_buffers.push_back(buf);
+	}
+
+	// Reloading is driven by the file watcher, so that tick() never has to touch the file system.
+	_shader_file_watch = _file_watcher->watch(file);
+}
+
+bool streamfx::gfx::shader::shader::apply_async_shader()
+{
+	std::shared_ptr<compile_result> result;
+	{
+		std::unique_lock<std::mutex> lock(_compile_lock);
+		if (!_compile) {
+			return false;
+		}
+		std::unique_lock<std::mutex> rlock(_compile->lock);
+		if (!_compile->ready) {
+			return false;
+		}
+		result = _compile;
+		_compile.reset();
+	}
 
+	// A failed compile keeps the previous shader, the error has already been logged.
+	if (!result->effect) {
+		return false;
+	}
+
+	try {
+		set_shader(result->effect, result->file, result->file_mt, result->file_sz);
+		load_parameters(result->tech);
+		update_specialization();
+		_rt_up_to_date = false;
 		return true;
 	} catch (const std::exception& ex) {
-		DLOG_ERROR("Loading shader '%s' failed with error: %s", file.c_str(), ex.what());
-		return false;
-	} catch (...) {
+		DLOG_ERROR("Loading shader '%s' failed with error: %s", result->file.c_str(), ex.what());
 		return false;
 	}
 }
 
+void streamfx::gfx::shader::shader::load_parameters(std::string_view tech)
+{
+	auto settings = std::shared_ptr<obs_data_t>(obs_source_get_settings(_self), [](obs_data_t* p) { obs_data_release(p); });
+
+	bool have_valid_tech = false;
+	for (std::size_t idx = 0; idx < _shader.count_techniques(); idx++) {
+		if (_shader.get_technique(idx).name() == tech) {
+			have_valid_tech = true;
+			break;
+		}
+	}
+	if (have_valid_tech) {
+		_shader_tech = tech;
+	} else {
+		_shader_tech = _shader.get_technique(0).name();
+
+		// Update source data.
+		obs_data_set_string(settings.get(), ST_KEY_SHADER_TECHNIQUE, _shader_tech.c_str());
+	}
+	_technique = _shader.get_technique(_shader_tech);
+
+	// Clear the shader parameters map and rebuild.
+	_shader_params.clear();
+	_reads_dynamic    = false;
+	auto fetch_params = [&](std::size_t count, std::function<streamfx::obs::gs::effect_parameter(std::size_t)> get_func) {
+		for (std::size_t vidx = 0; vidx < count; vidx++) {
+			auto el = get_func(vidx);
+			if (!el)
+				continue;
+
+			auto el_name = el.get_name();
+			if ((el_name == "Time") || (el_name == "Random")) {
+				// Passes only list the parameters their shaders actually read.
+				_reads_dynamic = true;
+			}
+
+			auto fnd = _shader_params.find(el_name);
+			if (fnd != _shader_params.end())
+				continue;
+
+			// Buffers are rendered by the shader itself.
+			if (std::find_if(_buffers.begin(), _buffers.end(), [&el_name](buffer& v) { return v.param.get_name() == el_name; }) != _buffers.end())
+				continue;
+
+			auto param = streamfx::gfx::shader::parameter::make_parameter(this, el, ST_KEY_PARAMETERS);
+
+			if (param) {
+				_shader_params.insert_or_assign(el_name, param);
+				param->defaults(settings.get());
+				param->update(settings.get());
+			}
+		}
+	};
+
+	// Techniques that render buffers have parameters too.
+	std::list<std::string> techs = {_shader_tech};
+	for (auto& buf : _buffers) {
+		techs.push_back(buf.tech);
+	}
+	for (auto& tech_name : techs) {
+		auto etech = _shader.get_technique(tech_name);
+		for (std::size_t idx = 0; idx < etech.count_passes(); idx++) {
+			auto pass = etech.get_pass(idx);
+			auto gvp  = [&](std::size_t idx) { return pass.get_vertex_parameter(idx); };
+			fetch_params(pass.count_vertex_parameters(), gvp);
+			auto gpp = [&](std::size_t idx) { return pass.get_pixel_parameter(idx); };
+			fetch_params(pass.count_pixel_parameters(), gpp);
+		}
+	}
+
+	// A variant no longer reads its specialized parameters, but they still need to be shown and provide their value.
+	for (std::size_t idx = 0; idx < _shader.count_parameters(); idx++) {
+		auto el = _shader.get_parameter(idx);
+		if (!el || (_shader_params.find(el.get_name()) != _shader_params.end()) || !streamfx::gfx::shader::parameter::wants_specialization(el))
+			continue;
+
+		auto param = streamfx::gfx::shader::parameter::make_parameter(this, el, ST_KEY_PARAMETERS);
+		if (param) {
+			_shader_params.insert_or_assign(el.get_name(), param);
+			param->defaults(settings.get());
+			param->update(settings.get());
+		}
+	}
+}
+
+void streamfx::gfx::shader::shader::update_specialization()
+{
+	if (!_shader)
+		return;
+
+	std::list<std::string> defines;
+	for (auto kv : _shader_params) {
+		if (auto define = kv.second->get_define(); !define.empty()) {
+			defines.push_back(std::move(define));
+		}
+	}
+
+	{ // Only compile once per change, no matter how often the same values are set.
+		std::unique_lock<std::mutex> lock(_compile_lock);
+		if (_compile && (_compile->file != _shader_file)) {
+			// Another file is on its way, and is specialized once its parameters are known.
+			return;
+		}
+		if (defines == _specialization)
+			return;
+		_specialization = std::move(defines);
+	}
+
+	// The current variant keeps rendering until the new one is ready.
+	load_shader_async(_shader_file, _shader_tech);
+}
+
 void streamfx::gfx::shader::shader::defaults(obs_data_t* data)
 {
 	obs_data_set_default_string(data, ST_KEY_SHADER_FILE, "");
 	obs_data_set_default_string(data, ST_KEY_SHADER_TECHNIQUE, "");
 	obs_data_set_default_string(data, ST_KEY_SHADER_SIZE_WIDTH, "100.0 %");
 	obs_data_set_default_string(data, ST_KEY_SHADER_SIZE_HEIGHT, "100.0 %");
+	obs_data_set_default_double(data, ST_KEY_SHADER_SCALE, 100.0);
 	obs_data_set_default_int(data, ST_KEY_SHADER_SEED, static_cast<long long>(time(NULL)));
+	obs_data_set_default_int(data, ST_KEY_SHADER_RATE, 1);
+	obs_data_set_default_bool(data, ST_KEY_SHADER_RATE_BLEND, false);
 }
 
 void streamfx::gfx::shader::shader::properties(obs_properties_t* pr)
@@ -217,9 +506,25 @@ void streamfx::gfx::shader::shader::properties(obs_properties_t* pr)
 			}
 		}
 
+		{
+			auto p = obs_properties_add_float_slider(grp, ST_KEY_SHADER_SCALE, D_TRANSLATE(ST_I18N_SHADER_SCALE), 10.0, 100.0, 0.01);
+			obs_property_float_set_suffix(p, " %");
+		}
+
 		{
 			auto p = obs_properties_add_int_slider(grp, ST_KEY_SHADER_SEED, D_TRANSLATE(ST_I18N_SHADER_SEED), std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), 1);
 		}
+
+		if (_mode != shader_mode::Transition) {
+			{
+				auto p = obs_properties_add_int_slider(grp, ST_KEY_SHADER_RATE, D_TRANSLATE(ST_I18N_SHADER_RATE), 1, ST_MAX_RATE, 1);
+				obs_property_int_set_suffix(p, " frames");
+				obs_property_set_long_description(p, D_TRANSLATE(ST_I18N_SHADER_RATE ".Description"));
+			}
+			{
+				auto p = obs_properties_add_bool(grp, ST_KEY_SHADER_RATE_BLEND, D_TRANSLATE(ST_I18N_SHADER_RATE_BLEND));
+			}
+		}
 	}
 	{
 		auto grp = obs_properties_create();
@@ -326,8 +631,20 @@ inline std::pair<streamfx::gfx::shader::size_type, double_t> parse_text_as_size(
 
 void streamfx::gfx::shader::shader::update(obs_data_t* data)
 {
-	bool v1, v2;
-	update_shader(data, v1, v2);
+	{
+		const char*           file_c = obs_data_get_string(data, ST_KEY_SHADER_FILE);
+		std::filesystem::path file   = file_c ? file_c : "";
+		const char*           tech_c = obs_data_get_string(data, ST_KEY_SHADER_TECHNIQUE);
+		std::string           tech   = tech_c ? tech_c : "Draw";
+
+		// Switching to another file compiles in the background, so that the current shader keeps rendering.
+		if (_shader && !file.empty() && (file != _shader_file)) {
+			load_shader_async(file, tech);
+		} else {
+			bool v1, v2;
+			load_shader(file, tech, v1, v2);
+		}
+	}
 
 	{
 		auto sz_x    = parse_text_as_size(obs_data_get_string(data, ST_KEY_SHADER_SIZE_WIDTH));
@@ -337,6 +654,18 @@ void streamfx::gfx::shader::shader::update(obs_data_t* data)
 		auto sz_y     = parse_text_as_size(obs_data_get_string(data, ST_KEY_SHADER_SIZE_HEIGHT));
 		_height_type  = sz_y.first;
 		_height_value = std::clamp(sz_y.second, 0.01, 8192.0);
+
+		_render_scale = std::clamp(obs_data_get_double(data, ST_KEY_SHADER_SCALE) / 100.0, 0.1, 1.0);
+	}
+
+	// Transitions are over too quickly to be worth it, and have to follow the transition time exactly.
+	if (_mode != shader_mode::Transition) {
+		_rate       = static_cast<uint32_t>(std::clamp<long long>(obs_data_get_int(data, ST_KEY_SHADER_RATE), 1, ST_MAX_RATE));
+		_rate_blend = obs_data_get_bool(data, ST_KEY_SHADER_RATE_BLEND);
+	}
+	if ((_rate <= 1) || !_rate_blend) {
+		_rt_previous.reset();
+		_rt_blend.reset();
 	}
 
 	if (int32_t seed = static_cast<int32_t>(obs_data_get_int(data, ST_KEY_SHADER_SEED)); _random_seed != seed) {
@@ -351,6 +680,9 @@ void streamfx::gfx::shader::shader::update(obs_data_t* data)
 		kv.second->defaults(data);
 		kv.second->update(data);
 	}
+	update_specialization();
+
+	invalidate_render();
 }
 
 uint32_t streamfx::gfx::shader::shader::width()
@@ -399,14 +731,22 @@ uint32_t streamfx::gfx::shader::shader::base_height()
 	return _base_height;
 }
 
+uint32_t streamfx::gfx::shader::shader::render_width()
+{
+	return std::max(static_cast<uint32_t>(width() * _render_scale * _qos_scale), 1u);
+}
+
+uint32_t streamfx::gfx::shader::shader::render_height()
+{
+	return std::max(static_cast<uint32_t>(height() * _render_scale * _qos_scale), 1u);
+}
+
 bool streamfx::gfx::shader::shader::tick(float_t time)
 {
-	_shader_file_tick = static_cast<float_t>(static_cast<double_t>(_shader_file_tick) + static_cast<double_t>(time));
-	if (_shader_file_tick >= 1.0f / 3.0f) {
-		_shader_file_tick -= 1.0f / 3.0f;
-		bool v1, v2;
-		load_shader(_shader_file, _shader_tech, v1, v2);
+	if (_shader_file_watch && _shader_file_watch->changed()) {
+		load_shader_async(_shader_file, _shader_tech);
 	}
+	apply_async_shader();
 
 	// Update State
 	_time += time;
@@ -425,9 +765,6 @@ bool streamfx::gfx::shader::shader::tick(float_t time)
 		_random_values[8 + idx] = static_cast<float_t>(static_cast<double_t>(_random()) / static_cast<double_t>(_random.max()));
 	}
 
-	// Flag Render Target as outdated.
-	_rt_up_to_date = false;
-
 	return false;
 }
 
@@ -436,38 +773,76 @@ void streamfx::gfx::shader::shader::prepare_render()
 	if (!_shader)
 		return;
 
-	// Assign user parameters
+	// If another instance used the effect since our last frame, none of the values in it are ours.
+	bool force = false;
+	{
+		std::unique_lock<std::mutex> lock(effect_owners_lock);
+		auto&                        owner = effect_owners[_shader.get()];
+		if (owner != this) {
+			owner = this;
+			force = true;
+		}
+	}
+	if (force) {
+		for (auto kv : _shader_params) {
+			kv.second->invalidate();
+		}
+	}
+
+	// Assign user parameters, each only uploads if it changed.
 	for (auto kv : _shader_params) {
 		kv.second->assign();
 	}
 
 	// float4 Time: (Time in Seconds), (Time in Current Second), (Time in Seconds only), (Random Value)
-	if (streamfx::obs::gs::effect_parameter el = _shader.get_parameter("Time"); el != nullptr) {
-		if (el.get_type() == streamfx::obs::gs::effect_parameter::type::Float4) {
-			el.set_float4(_time, _time_loop, static_cast<float_t>(_loops), static_cast<float_t>(static_cast<double_t>(_random()) / static_cast<double_t>(_random.max())));
-		}
+	if (_param_time) {
+		_param_time.set_float4(_time, _time_loop, static_cast<float_t>(_loops), static_cast<float_t>(static_cast<double_t>(_random()) / static_cast<double_t>(_random.max())));
+	}
+
+	// Render at a smaller size while OBS can't keep up, the result is upscaled like with a lower render scale.
+	switch (_qos->level()) {
+	case 0:
+		_qos_scale = 1.0;
+		break;
+	case 1:
+		_qos_scale = 0.75;
+		break;
+	default:
+		_qos_scale = 0.5;
+		break;
 	}
 
 	// float4 ViewSize: (Width), (Height), (1.0 / Width), (1.0 / Height)
-	if (auto el = _shader.get_parameter("ViewSize"); el != nullptr) {
-		if (el.get_type() == streamfx::obs::gs::effect_parameter::type::Float4) {
-			el.set_float4(static_cast<float_t>(width()), static_cast<float_t>(height()), 1.0f / static_cast<float_t>(width()), 1.0f / static_cast<float_t>(height()));
-		}
+	if (std::pair<uint32_t, uint32_t> size{render_width(), render_height()}; _param_view_size && (force || (size != _assigned_view_size))) {
+		_param_view_size.set_float4(static_cast<float_t>(size.first), static_cast<float_t>(size.second), 1.0f / static_cast<float_t>(size.first), 1.0f / static_cast<float_t>(size.second));
+		_assigned_view_size = size;
 	}
 
 	// float4x4 Random: float4[Per-Instance Random], float4[Per-Activation Random], float4x2[Per-Frame Random]
-	if (auto el = _shader.get_parameter("Random"); el != nullptr) {
-		if (el.get_type() == streamfx::obs::gs::effect_parameter::type::Matrix) {
-			el.set_value(_random_values, 16);
-		}
+	if (_param_random) {
+		_param_random.set_value(_random_values, 16);
 	}
 
 	// int32 RandomSeed: Seed used for random generation
-	if (auto el = _shader.get_parameter("RandomSeed"); el != nullptr) {
-		if (el.get_type() == streamfx::obs::gs::effect_parameter::type::Integer) {
-			el.set_int(_random_seed);
+	if (_param_random_seed && (force || (_random_seed != _assigned_random_seed))) {
+		_param_random_seed.set_int(_random_seed);
+		_assigned_random_seed = _random_seed;
+	}
+
+	// Sources whose output only depends on their parameters render once and then keep drawing the cached result.
+	bool dynamic = (_mode != shader_mode::Source) || _reads_dynamic;
+	for (auto kv : _shader_params) {
+		dynamic = dynamic || !kv.second->is_static();
+	}
+	if (bool resized = (_rt_size != std::pair<uint32_t, uint32_t>{render_width(), render_height()}); dynamic || _rt_dynamic || resized) {
+		// At a reduced rate, only every few frames run the technique, the others keep drawing the last result.
+		uint64_t frame = current_frame();
+		bool     due   = (frame != _rate_frame) && ((((frame + _rate_phase) % _rate) == 0) || ((frame - _rate_frame) >= _rate));
+		if (!dynamic || resized || (_rate <= 1) || due) {
+			_rt_up_to_date = false;
 		}
 	}
+	_rt_dynamic = dynamic;
 
 	return;
 }
@@ -480,16 +855,27 @@ void streamfx::gfx::shader::shader::render(gs_effect* effect)
 	if (!effect)
 		effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
 
+	// Fading between results needs to keep the previous one around.
+	bool blend = _rt_dynamic && (_rate > 1) && _rate_blend;
+	if (blend && !_mix_effect) {
+		_mix_effect = _mix_effect_loader.get();
+	}
+
 	if (!_rt_up_to_date) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_cache, "Render Cache"};
 #endif
 
-		auto op = _rt->render(width(), height());
+		if (blend) {
+			if (!_rt_previous) {
+				_rt_previous = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+			}
+			std::swap(_rt, _rt_previous);
+		}
 
-		vec4 zero = {0, 0, 0, 0};
-		gs_clear(GS_CLEAR_COLOR, &zero, 0, 0);
-		gs_ortho(0, 1, 0, 1, 0, 1);
+		_rt_size    = {render_width(), render_height()};
+		_rate_frame = current_frame();
+		vec4 zero   = {0, 0, 0, 0};
 
 		// Update Blend State
 		gs_blend_state_push();
@@ -503,8 +889,44 @@ void streamfx::gfx::shader::shader::render(gs_effect* effect)
 		bool old_srgb = gs_framebuffer_srgb_enabled();
 		gs_enable_framebuffer_srgb(false);
 
-		while (gs_effect_loop(_shader.get_object(), _shader_tech.c_str())) {
-			_gfx_util->draw_fullscreen_triangle();
+		// Buffers are held until the technique is done, as anything after them may read them.
+		std::list<std::shared_ptr<streamfx::obs::gs::rendertarget>> buffers;
+		for (auto& buf : _buffers) {
+			uint32_t width  = std::max(static_cast<uint32_t>(_rt_size.first * buf.scale), 1u);
+			uint32_t height = std::max(static_cast<uint32_t>(_rt_size.second * buf.scale), 1u);
+			auto     rt     = _rt_pool->acquire(buf.format, width, height);
+
+			// Each technique sees the size it renders at.
+			if (_param_view_size) {
+				_param_view_size.set_float4(static_cast<float_t>(width), static_cast<float_t>(height), 1.0f / static_cast<float_t>(width), 1.0f / static_cast<float_t>(height));
+				_assigned_view_size = {width, height};
+			}
+
+			{
+				auto op = rt->render(width, height);
+				gs_clear(GS_CLEAR_COLOR, &zero, 0, 0);
+				gs_ortho(0, 1, 0, 1, 0, 1);
+				buf.technique.draw([this]() { _gfx_util->draw_fullscreen_triangle(); });
+			}
+
+			buf.param.set_texture(rt->get_texture());
+			buffers.push_back(rt);
+		}
+		if (_param_view_size && (_assigned_view_size != _rt_size)) {
+			_param_view_size.set_float4(static_cast<float_t>(_rt_size.first), static_cast<float_t>(_rt_size.second), 1.0f / static_cast<float_t>(_rt_size.first), 1.0f / static_cast<float_t>(_rt_size.second));
+			_assigned_view_size = _rt_size;
+		}
+
+		{
+			auto op = _rt->render(_rt_size.first, _rt_size.second);
+			gs_clear(GS_CLEAR_COLOR, &zero, 0, 0);
+			gs_ortho(0, 1, 0, 1, 0, 1);
+			_technique.draw([this]() { _gfx_util->draw_fullscreen_triangle(); });
+		}
+
+		// The buffers go back to the pool, where anyone may reuse or destroy them.
+		for (auto& buf : _buffers) {
+			buf.param.set_texture(static_cast<gs_texture_t*>(nullptr));
 		}
 
 		// Restore sRGB Status
@@ -516,11 +938,39 @@ void streamfx::gfx::shader::shader::render(gs_effect* effect)
 		_rt_up_to_date = true;
 	}
 
-	if (auto tex = _rt->get_texture(); tex) {
+	auto tex = _rt->get_texture();
+	if (auto previous = _rt_previous ? _rt_previous->get_texture() : nullptr; blend && _mix_effect && tex && previous && (previous->get_width() == tex->get_width()) && (previous->get_height() == tex->get_height())) {
+		// Mix linearly over the interval, so that the newest result is reached right before the next one is rendered.
+		float_t factor = std::clamp<float_t>(static_cast<float_t>(current_frame() - _rate_frame + 1) / static_cast<float_t>(_rate), 0., 1.);
+		if (factor < 1.) {
+			if (!_rt_blend) {
+				_rt_blend = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+			}
+
+			streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
+			{
+				auto op = _rt_blend->render(tex->get_width(), tex->get_height());
+				gs_ortho(0, 1., 0, 1., -1., 1.);
+
+				_mix_effect.get_parameter("image_orig").set_texture(previous);
+				_mix_effect.get_parameter("image_blur").set_texture(tex);
+				_mix_effect.get_parameter("mix_factor").set_float(factor);
+				while (gs_effect_loop(_mix_effect.get_object(), "Mix")) {
+					_gfx_util->draw_fullscreen_triangle();
+				}
+			}
+			gs_blend_state_pop();
+
+			tex = _rt_blend->get_texture();
+		}
+	}
+
+	if (tex) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_render, "Draw Cache"};
 #endif
 
+		// The default effect samples linearly, which doubles as the upscale when rendering at a reduced scale.
 		gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), tex->get_object());
 		while (gs_effect_loop(effect, "Draw")) {
 			gs_draw_sprite(nullptr, 0, width(), height());
@@ -528,6 +978,11 @@ void streamfx::gfx::shader::shader::render(gs_effect* effect)
 	}
 }
 
+void streamfx::gfx::shader::shader::invalidate_render()
+{
+	_rt_up_to_date = false;
+}
+
 void streamfx::gfx::shader::shader::set_size(uint32_t w, uint32_t h)
 {
 	_base_width  = w;
@@ -597,6 +1052,11 @@ void streamfx::gfx::shader::shader::set_transition_size(uint32_t w, uint32_t h)
 	}
 }
 
+std::pair<float_t, float_t> streamfx::gfx::shader::shader::transition_passthrough()
+{
+	return _transition_passthrough;
+}
+
 void streamfx::gfx::shader::shader::set_visible(bool visible)
 {
 	_visible = visible;
@@ -6,15 +6,19 @@
 
 #pragma once
 #include "common.hpp"
+#include "gfx/gfx-qos.hpp"
+#include "gfx/gfx-rendertarget-pool.hpp"
 #include "gfx/gfx-util.hpp"
 #include "gfx/shader/gfx-shader-param.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
+#include "util/util-file-watcher.hpp"
 
 #include "warning-disable.hpp"
 #include <filesystem>
 #include <list>
 #include <map>
+#include <mutex>
 #include <random>
 #include "warning-enable.hpp"
 
@@ -36,7 +40,9 @@ namespace streamfx::gfx {
 		class shader {
 			obs_source_t* _self;
 
-			std::shared_ptr<streamfx::gfx::util> _gfx_util;
+			std::shared_ptr<streamfx::gfx::util>              _gfx_util;
+			std::shared_ptr<streamfx::gfx::qos>               _qos;
+			std::shared_ptr<streamfx::gfx::rendertarget_pool> _rt_pool;
 
 			// Inputs
 			shader_mode _mode;
@@ -46,19 +52,62 @@ namespace streamfx::gfx {
 			bool        _visible;
 
 			// Shader
-			streamfx::obs::gs::effect       _shader;
-			std::filesystem::path           _shader_file;
-			std::string                     _shader_tech;
-			std::filesystem::file_time_type _shader_file_mt;
-			uintmax_t                       _shader_file_sz;
-			float_t                         _shader_file_tick;
-			shader_param_map_t              _shader_params;
+			streamfx::obs::gs::effect            _shader;
+			std::filesystem::path                _shader_file;
+			std::string                          _shader_tech;
+			streamfx::obs::gs::effect_technique  _technique; // Resolved from _shader_tech whenever either changes.
+			std::filesystem::file_time_type      _shader_file_mt;
+			uintmax_t                            _shader_file_sz;
+			shader_param_map_t                   _shader_params;
+			std::list<std::string>               _specialization; // Defines of specialized parameters, as last requested.
+			std::list<streamfx::obs::gs::effect> _variants;       // Recently used variants, so that switching back is instant.
+
+			// Built-in Parameters
+			streamfx::obs::gs::effect_parameter _param_time;
+			streamfx::obs::gs::effect_parameter _param_view_size;
+			streamfx::obs::gs::effect_parameter _param_random;
+			streamfx::obs::gs::effect_parameter _param_random_seed;
+			std::pair<uint32_t, uint32_t>       _assigned_view_size;
+			int32_t                             _assigned_random_seed;
+			std::pair<float_t, float_t>         _transition_passthrough;
+
+			// Intermediate Buffers, rendered by the technique named in their "pass" annotation before the selected one.
+			struct buffer {
+				streamfx::obs::gs::effect_parameter param;
+				std::string                         tech;
+				streamfx::obs::gs::effect_technique technique;
+				float_t                             scale;
+				gs_color_format                     format;
+			};
+			std::list<buffer> _buffers;
+
+			// Shader Reloading
+			std::shared_ptr<streamfx::util::file_watcher>               _file_watcher;
+			std::shared_ptr<streamfx::util::file_watcher::subscription> _shader_file_watch;
+
+			// Asynchronous Compilation
+			struct compile_result {
+				std::mutex                      lock;
+				bool                            ready;
+				std::filesystem::path           file;
+				std::string                     tech;
+				std::filesystem::file_time_type file_mt;
+				uintmax_t                       file_sz;
+				std::list<std::string>          defines;
+				streamfx::obs::gs::effect       effect;
+			};
+			std::mutex                      _compile_lock;
+			std::shared_ptr<compile_result> _compile;
 
 			// Options
 			size_type _width_type;
 			double_t  _width_value;
 			size_type _height_type;
 			double_t  _height_value;
+			double_t  _render_scale;
+			double_t  _qos_scale;
+			uint32_t  _rate;       // Run the technique on every _rate-th frame only.
+			bool      _rate_blend; // Fade from the previous result to the newest one in between.
 
 			// Cache
 			bool            _have_current_params;
@@ -71,8 +120,19 @@ namespace streamfx::gfx {
 
 			// Rendering
 			bool                                             _rt_up_to_date;
+			bool                                             _rt_dynamic;
+			bool                                             _reads_dynamic; // Technique reads Time or Random.
+			std::pair<uint32_t, uint32_t>                    _rt_size;
 			std::shared_ptr<streamfx::obs::gs::rendertarget> _rt;
 
+			// Reduced Rate
+			uint32_t                                         _rate_phase; // Frames are counted from here, so that instances don't all run on the same one.
+			uint64_t                                         _rate_frame; // Frame the technique last ran on.
+			std::shared_ptr<streamfx::obs::gs::rendertarget> _rt_previous;
+			std::shared_ptr<streamfx::obs::gs::rendertarget> _rt_blend;
+			streamfx::obs::gs::effect                        _mix_effect;
+			streamfx::obs::gs::effect_loader                 _mix_effect_loader;
+
 			public:
 			shader(obs_source_t* self, shader_mode mode);
 			~shader();
@@ -83,6 +143,21 @@ namespace streamfx::gfx {
 
 			bool load_shader(const std::filesystem::path& file, std::string_view tech, bool& shader_dirty, bool& param_dirty);
 
+			/** Compile a shader on the thread pool, the current shader keeps rendering until tick() swaps it in. */
+			void load_shader_async(const std::filesystem::path& file, std::string_view tech);
+
+			private:
+			void set_shader(streamfx::obs::gs::effect effect, const std::filesystem::path& file, std::filesystem::file_time_type file_mt, uintmax_t file_sz);
+
+			void load_parameters(std::string_view tech);
+
+			/** Compile another variant if the value of a specialized parameter changed. */
+			void update_specialization();
+
+			bool apply_async_shader();
+
+			public:
+
 			static void defaults(obs_data_t* data);
 
 			void properties(obs_properties_t* props);
@@ -103,12 +178,20 @@ namespace streamfx::gfx {
 
 			uint32_t base_height();
 
+			/** Size the technique actually runs at, render() upscales the result to width() x height(). */
+			uint32_t render_width();
+
+			uint32_t render_height();
+
 			bool tick(float_t time);
 
 			void prepare_render();
 
 			void render(gs_effect* effect);
 
+			/** Run the technique again on the next render(), instead of drawing the cached result. */
+			void invalidate_render();
+
 			obs_source_t* get();
 
 			std::filesystem::path get_shader_file();
@@ -124,6 +207,13 @@ namespace streamfx::gfx {
 
 			void set_transition_size(uint32_t w, uint32_t h);
 
+			/** Transition times up to which the output is InputA, and from which it is InputB.
+			 *
+			 * Declared by the "passthrough_a" and "passthrough_b" annotations of TransitionTime, only the endpoints by
+			 * default. The shader does not need to run for these times, the visible input is drawn as is.
+			 */
+			std::pair<float_t, float_t> transition_passthrough();
+
 			void set_visible(bool visible);
 
 			void set_active(bool active);
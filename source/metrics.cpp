@@ -0,0 +1,373 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "metrics.hpp"
+#include "configuration.hpp"
+#include "gfx/gfx-rendertarget-pool.hpp"
+#include "gfx/gfx-vram.hpp"
+#include "obs/obs-encoder-factory.hpp"
+#include "obs/obs-source-tracker.hpp"
+#include "obs/obs-tools.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <util/platform.h>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<metrics> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_CFG_METRICS "Metrics"
+#define ST_CFG_METRICS_PATH "Path"
+#define ST_CFG_METRICS_INTERVAL "Interval"
+#define ST_CFG_METRICS_FORMAT "Format"
+
+static void add_source(std::vector<streamfx::metrics::element>& elements, obs_source_t* source, std::string parent)
+{
+	// Only StreamFX sources answer this.
+	calldata_t data;
+	calldata_init(&data);
+	if (!proc_handler_call(obs_source_get_proc_handler(source), "get_timings", &data)) {
+		calldata_free(&data);
+		return;
+	}
+
+	streamfx::metrics::element entry = {};
+	switch (obs_source_get_type(source)) {
+	case OBS_SOURCE_TYPE_FILTER:
+		entry.kind = "filter";
+		break;
+	case OBS_SOURCE_TYPE_TRANSITION:
+		entry.kind = "transition";
+		break;
+	default:
+		entry.kind = "source";
+		break;
+	}
+	entry.name   = obs_source_get_name(source);
+	entry.parent = std::move(parent);
+	entry.type   = obs_source_get_id(source);
+	entry.stages.push_back({"cpu", static_cast<uint64_t>(calldata_int(&data, "cpu_calls")), static_cast<uint64_t>(calldata_int(&data, "cpu_total")), calldata_float(&data, "cpu_p95")});
+	entry.stages.push_back({"gpu", static_cast<uint64_t>(calldata_int(&data, "gpu_frames")), static_cast<uint64_t>(calldata_int(&data, "gpu_total")), calldata_float(&data, "gpu_p95")});
+	calldata_free(&data);
+
+	calldata_init(&data);
+	if (proc_handler_call(obs_source_get_proc_handler(source), "get_vram", &data)) {
+		entry.vram = static_cast<uint64_t>(calldata_int(&data, "bytes"));
+	}
+	calldata_free(&data);
+
+	elements.push_back(std::move(entry));
+}
+
+static std::string escape_json(const std::string& text)
+{
+	std::string result;
+	result.reserve(text.size() + 2);
+	for (char chr : text) {
+		switch (chr) {
+		case '"':
+			result += "\\\"";
+			break;
+		case '\\':
+			result += "\\\\";
+			break;
+		default:
+			if (static_cast<unsigned char>(chr) < 0x20) {
+				char buffer[8];
+				snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned int>(chr));
+				result += buffer;
+			} else {
+				result += chr;
+			}
+			break;
+		}
+	}
+	return result;
+}
+
+static std::string escape_label(const std::string& text)
+{
+	std::string result;
+	result.reserve(text.size());
+	for (char chr : text) {
+		switch (chr) {
+		case '"':
+			result += "\\\"";
+			break;
+		case '\\':
+			result += "\\\\";
+			break;
+		case '\n':
+			result += "\\n";
+			break;
+		default:
+			result += chr;
+			break;
+		}
+	}
+	return result;
+}
+
+streamfx::metrics::~metrics()
+{
+	if (_thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lg(_lock);
+			_stop = true;
+			_cv.notify_all();
+		}
+		_thread.join();
+	}
+}
+
+streamfx::metrics::metrics() : _path(), _interval(10), _format(format::JSON), _lock(), _cv(), _stop(false), _thread()
+{
+	auto                        config = streamfx::configuration::instance();
+	auto                        data   = config->get();
+	std::shared_ptr<obs_data_t> cfg(obs_data_get_obj(data.get(), ST_CFG_METRICS), streamfx::obs::obs_data_deleter);
+	if (!cfg) {
+		return;
+	}
+	obs_data_set_default_string(cfg.get(), ST_CFG_METRICS_PATH, "");
+	obs_data_set_default_int(cfg.get(), ST_CFG_METRICS_INTERVAL, 10);
+	obs_data_set_default_string(cfg.get(), ST_CFG_METRICS_FORMAT, "json");
+
+	std::string path = obs_data_get_string(cfg.get(), ST_CFG_METRICS_PATH);
+	if (path.empty()) {
+		return;
+	}
+	_path     = std::filesystem::u8path(path);
+	_interval = std::chrono::seconds(std::max<int64_t>(obs_data_get_int(cfg.get(), ST_CFG_METRICS_INTERVAL), 1));
+	if (std::string_view(obs_data_get_string(cfg.get(), ST_CFG_METRICS_FORMAT)) == "prometheus") {
+		_format = format::PROMETHEUS;
+	}
+
+	D_LOG_INFO("Writing metrics to '%s' every %" PRId64 " seconds.", _path.u8string().c_str(), static_cast<int64_t>(_interval.count()));
+	_thread = std::thread(&streamfx::metrics::work, this);
+}
+
+void streamfx::metrics::work()
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	while (!_stop) {
+		if (_cv.wait_for(ul, _interval, [this]() { return _stop; })) {
+			break;
+		}
+
+		ul.unlock();
+		try {
+			write();
+		} catch (const std::exception& ex) {
+			D_LOG_WARNING("Failed to write metrics: %s", ex.what());
+		}
+		ul.lock();
+	}
+}
+
+void streamfx::metrics::write()
+{
+	auto        elements = collect();
+	std::string text     = (_format == format::PROMETHEUS) ? to_prometheus(elements) : to_json(elements);
+
+	// Write next to the target and then replace it, so that readers only ever see complete files.
+	std::filesystem::path temporary = _path;
+	temporary += ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			throw std::runtime_error("Failed to open file for writing.");
+		}
+		file.write(text.data(), static_cast<std::streamsize>(text.size()));
+		if (!file) {
+			throw std::runtime_error("Failed to write file.");
+		}
+	}
+	std::filesystem::rename(temporary, _path);
+}
+
+std::vector<streamfx::metrics::element> streamfx::metrics::collect()
+{
+	std::vector<element> elements;
+
+	// Filters aren't looked up by name, as their names are only unique per source.
+	streamfx::obs::source_tracker::instance()->enumerate([&elements](std::string name, ::streamfx::obs::source source) {
+		if (obs_source_get_type(source.get()) == OBS_SOURCE_TYPE_FILTER) {
+			return false;
+		}
+		add_source(elements, source.get(), "");
+
+		struct context_t {
+			std::vector<element>* elements;
+			std::string           parent;
+		} context{&elements, name};
+		obs_source_enum_filters(
+			source.get(),
+			[](obs_source_t*, obs_source_t* filter, void* param) {
+				auto ctx = reinterpret_cast<context_t*>(param);
+				add_source(*ctx->elements, filter, ctx->parent);
+			},
+			&context);
+		return false;
+	});
+
+	streamfx::obs::encoder_instance::enumerate([&elements](streamfx::obs::encoder_instance& instance) {
+		element entry = {};
+		entry.kind    = "encoder";
+		entry.name = obs_encoder_get_name(instance.get());
+		entry.type = obs_encoder_get_id(instance.get());
+		instance.enumerate_timings([&entry](const char* name, const ::streamfx::util::histogram& timings) {
+			entry.stages.push_back({name, timings.count(), static_cast<uint64_t>(timings.total_duration().count()), static_cast<double_t>(timings.percentile(0.95).count()) / 1000000.0});
+		});
+		instance.enumerate_counters([&entry](const char* name, uint64_t value) { entry.counters.emplace_back(name, value); });
+		elements.push_back(std::move(entry));
+	});
+
+	return elements;
+}
+
+std::string streamfx::metrics::to_json(const std::vector<element>& elements)
+{
+	auto               pool = streamfx::gfx::rendertarget_pool::get_statistics();
+	auto               vram = streamfx::gfx::vram::get_statistics();
+	std::ostringstream out;
+
+	out << "{\"time\":" << (os_gettime_ns() / 1000000) << ",\"frame_interval_ns\":" << obs_get_frame_interval_ns();
+	out << ",\"rendertarget_pool\":{\"hits\":" << pool.hits << ",\"misses\":" << pool.misses << ",\"idle\":" << pool.idle << "}";
+	out << ",\"vram\":{\"texture\":" << vram.bytes[0] << ",\"rendertarget\":" << vram.bytes[1] << ",\"cuda\":" << vram.bytes[2] << ",\"budget\":" << vram.budget << ",\"trims\":" << vram.trims << ",\"caches\":{";
+	for (std::size_t idx = 0; idx < vram.caches.size(); idx++) {
+		out << (idx ? "," : "") << "\"" << escape_json(vram.caches[idx].first) << "\":" << vram.caches[idx].second;
+	}
+	out << "}}";
+	out << ",\"elements\":[";
+	for (std::size_t idx = 0; idx < elements.size(); idx++) {
+		auto& entry = elements[idx];
+		out << (idx ? "," : "") << "{\"kind\":\"" << entry.kind << "\",\"name\":\"" << escape_json(entry.name) << "\",\"parent\":\"" << escape_json(entry.parent) << "\",\"type\":\"" << escape_json(entry.type) << "\",\"vram_bytes\":" << entry.vram;
+		out << ",\"stages\":{";
+		for (std::size_t sdx = 0; sdx < entry.stages.size(); sdx++) {
+			auto& stage = entry.stages[sdx];
+			out << (sdx ? "," : "") << "\"" << stage.name << "\":{\"count\":" << stage.count << ",\"total_ns\":" << stage.total << ",\"p95_ms\":" << stage.p95 << "}";
+		}
+		out << "},\"counters\":{";
+		for (std::size_t cdx = 0; cdx < entry.counters.size(); cdx++) {
+			out << (cdx ? "," : "") << "\"" << entry.counters[cdx].first << "\":" << entry.counters[cdx].second;
+		}
+		out << "}}";
+	}
+	out << "]}\n";
+
+	return out.str();
+}
+
+std::string streamfx::metrics::to_prometheus(const std::vector<element>& elements)
+{
+	auto               pool = streamfx::gfx::rendertarget_pool::get_statistics();
+	auto               vram = streamfx::gfx::vram::get_statistics();
+	std::ostringstream out;
+
+	out << "# TYPE streamfx_frame_interval_seconds gauge\n";
+	out << "streamfx_frame_interval_seconds " << (static_cast<double_t>(obs_get_frame_interval_ns()) / 1000000000.) << "\n";
+	out << "# TYPE streamfx_rendertarget_pool_hits_total counter\n";
+	out << "streamfx_rendertarget_pool_hits_total " << pool.hits << "\n";
+	out << "# TYPE streamfx_rendertarget_pool_misses_total counter\n";
+	out << "streamfx_rendertarget_pool_misses_total " << pool.misses << "\n";
+	out << "# TYPE streamfx_rendertarget_pool_idle gauge\n";
+	out << "streamfx_rendertarget_pool_idle " << pool.idle << "\n";
+	out << "# TYPE streamfx_vram_bytes gauge\n";
+	out << "streamfx_vram_bytes{kind=\"texture\"} " << vram.bytes[0] << "\n";
+	out << "streamfx_vram_bytes{kind=\"rendertarget\"} " << vram.bytes[1] << "\n";
+	out << "streamfx_vram_bytes{kind=\"cuda\"} " << vram.bytes[2] << "\n";
+	out << "# TYPE streamfx_vram_budget_bytes gauge\n";
+	out << "streamfx_vram_budget_bytes " << vram.budget << "\n";
+	out << "# TYPE streamfx_vram_trims_total counter\n";
+	out << "streamfx_vram_trims_total " << vram.trims << "\n";
+	out << "# TYPE streamfx_vram_cache_bytes gauge\n";
+	for (auto& cache : vram.caches) {
+		out << "streamfx_vram_cache_bytes{cache=\"" << escape_label(cache.first) << "\"} " << cache.second << "\n";
+	}
+
+	auto labels = [](const element& entry) {
+		return "kind=\"" + entry.kind + "\",name=\"" + escape_label(entry.name) + "\",parent=\"" + escape_label(entry.parent) + "\",type=\"" + escape_label(entry.type) + "\"";
+	};
+
+	// Every sample of a metric has to follow its TYPE line, so go through the elements once per metric.
+	out << "# TYPE streamfx_stage_seconds_total counter\n";
+	for (auto& entry : elements) {
+		for (auto& stage : entry.stages) {
+			out << "streamfx_stage_seconds_total{" << labels(entry) << ",stage=\"" << stage.name << "\"} " << (static_cast<double_t>(stage.total) / 1000000000.) << "\n";
+		}
+	}
+	out << "# TYPE streamfx_stage_calls_total counter\n";
+	for (auto& entry : elements) {
+		for (auto& stage : entry.stages) {
+			out << "streamfx_stage_calls_total{" << labels(entry) << ",stage=\"" << stage.name << "\"} " << stage.count << "\n";
+		}
+	}
+	out << "# TYPE streamfx_stage_p95_seconds gauge\n";
+	for (auto& entry : elements) {
+		for (auto& stage : entry.stages) {
+			out << "streamfx_stage_p95_seconds{" << labels(entry) << ",stage=\"" << stage.name << "\"} " << (stage.p95 / 1000.) << "\n";
+		}
+	}
+	out << "# TYPE streamfx_element_vram_bytes gauge\n";
+	for (auto& entry : elements) {
+		if (entry.kind != "encoder") {
+			out << "streamfx_element_vram_bytes{" << labels(entry) << "} " << entry.vram << "\n";
+		}
+	}
+	out << "# TYPE streamfx_counter_total counter\n";
+	for (auto& entry : elements) {
+		for (auto& counter : entry.counters) {
+			out << "streamfx_counter_total{" << labels(entry) << ",counter=\"" << counter.first << "\"} " << counter.second << "\n";
+		}
+	}
+
+	return out.str();
+}
+
+std::shared_ptr<streamfx::metrics> streamfx::metrics::get()
+{
+	static std::weak_ptr<streamfx::metrics> winst;
+	static std::mutex                       mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::metrics>(new streamfx::metrics());
+		winst    = instance;
+	}
+	return instance;
+}
+
+static std::shared_ptr<streamfx::metrics> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		try {
+			loader_instance = streamfx::metrics::get();
+		} catch (const std::exception& ex) {
+			D_LOG_WARNING("Failed to start writing metrics: %s", ex.what());
+		}
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::LOWEST, streamfx::loader_mode::DEFERRED); // Nothing to report before OBS has loaded.
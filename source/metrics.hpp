@@ -0,0 +1,86 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx {
+	/** Periodically writes the timings and counters of every StreamFX instance to a file, for external monitoring.
+	 *
+	 * Configured in the "Metrics" object of the global configuration:
+	 * - "Path": File to write, nothing is written if empty (default).
+	 * - "Interval": Seconds between writes, 10 by default.
+	 * - "Format": "json" (default), or "prometheus" for the text format read by the node_exporter textfile collector.
+	 *
+	 * The file is replaced as a whole on every write, so readers never see a partial file. Totals count from when an
+	 * instance was created, rates are left to whoever reads them. Video memory is reported as it is right now, see
+	 * gfx::vram.
+	 */
+	class metrics {
+		public:
+		enum class format {
+			JSON,
+			PROMETHEUS,
+		};
+
+		struct stage {
+			std::string name;
+			uint64_t    count;
+			uint64_t    total; // Nanoseconds.
+			double_t    p95;   // Milliseconds.
+		};
+
+		struct element {
+			std::string                                   kind; // "source", "filter", "transition" or "encoder".
+			std::string                                   name;
+			std::string                                   parent; // Source a filter belongs to, empty otherwise.
+			std::string                                   type;
+			std::vector<stage>                            stages;
+			std::vector<std::pair<std::string, uint64_t>> counters;
+			uint64_t                                      vram; // Bytes of video memory held, 0 for encoders.
+		};
+
+		private:
+		std::filesystem::path _path;
+		std::chrono::seconds  _interval;
+		format                _format;
+
+		std::mutex              _lock;
+		std::condition_variable _cv;
+		bool                    _stop;
+		std::thread             _thread;
+
+		public:
+		~metrics();
+
+		private:
+		metrics();
+
+		void work();
+
+		void write();
+
+		public:
+		/** Timings and counters of every instance that exists right now. */
+		static std::vector<element> collect();
+
+		static std::string to_json(const std::vector<element>& elements);
+
+		static std::string to_prometheus(const std::vector<element>& elements);
+
+		public:
+		static std::shared_ptr<streamfx::metrics> get();
+	};
+} // namespace streamfx
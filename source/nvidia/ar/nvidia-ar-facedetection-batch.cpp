@@ -0,0 +1,230 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "nvidia-ar-facedetection-batch.hpp"
+#include "nvidia/nvidia-warmup.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<nvidia::ar::facedetection_batch> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+streamfx::nvidia::ar::facedetection_batch::client::~client()
+{
+	_parent->remove(this);
+}
+
+streamfx::nvidia::ar::facedetection_batch::client::client(std::shared_ptr<facedetection_batch> parent) : _parent(parent), _key(0, 0), _results(), _ready(false) {}
+
+bool streamfx::nvidia::ar::facedetection_batch::client::submit(std::shared_ptr<::streamfx::obs::gs::texture> in)
+{
+	auto     gctx   = ::streamfx::obs::gs::context();
+	uint32_t width  = in->get_width();
+	uint32_t height = in->get_height();
+	uint64_t frame  = obs_get_video_frame_time();
+
+	std::unique_lock<std::mutex> ul(_parent->_lock);
+
+	// Leave the group of the previous size, if it changed.
+	if (_key != std::pair<uint32_t, uint32_t>{width, height}) {
+		ul.unlock();
+		_parent->remove(this);
+		ul.lock();
+		_key = {width, height};
+	}
+
+	std::shared_ptr<group> grp;
+	if (auto kv = _parent->_groups.find(_key); kv != _parent->_groups.end()) {
+		grp = kv->second;
+	} else {
+		grp        = std::make_shared<group>();
+		grp->frame = 0;
+		grp->atlas = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+		_parent->_groups.emplace(_key, grp);
+	}
+
+	// Start the previous batch, so that the atlas is free for this frame.
+	_parent->poll(_key, *grp);
+
+	// Already queued, or no space left in the atlas?
+	if (std::find(grp->tiles.begin(), grp->tiles.end(), this) != grp->tiles.end()) {
+		return true;
+	} else if (grp->tiles.size() >= (tiles_x * tiles_y)) {
+		return false;
+	}
+
+	{ // Draw the input into the next free tile.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "NvAR Face Detection Batch Tile"};
+#endif
+		size_t   tile = grp->tiles.size();
+		uint32_t tw   = std::max<uint32_t>(width / tiles_x, 1);
+		uint32_t th   = std::max<uint32_t>(height / tiles_y, 1);
+
+		auto op = grp->atlas->render(width, height);
+		gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), 0, 1);
+		if (tile == 0) {
+			vec4 blank = vec4{0, 0, 0, 1};
+			gs_clear(GS_CLEAR_COLOR, &blank, 0, 0);
+		}
+
+		gs_blend_state_push();
+		gs_enable_blending(false);
+		gs_enable_color(true, true, true, true);
+		gs_enable_depth_test(false);
+		gs_enable_stencil_test(false);
+		gs_set_cull_mode(GS_NEITHER);
+
+		gs_matrix_push();
+		gs_matrix_identity();
+		gs_matrix_translate3f(static_cast<float>((tile % tiles_x) * tw), static_cast<float>((tile / tiles_x) * th), 0.);
+
+		gs_effect_t* effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+		gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), in->get_object());
+		while (gs_effect_loop(effect, "Draw")) {
+			gs_draw_sprite(nullptr, 0, tw, th);
+		}
+
+		gs_matrix_pop();
+		gs_blend_state_pop();
+
+		grp->tiles.push_back(this);
+		grp->frame = frame;
+	}
+
+	return true;
+}
+
+bool streamfx::nvidia::ar::facedetection_batch::client::collect(std::pmr::vector<detection>& results)
+{
+	std::unique_lock<std::mutex> ul(_parent->_lock);
+
+	if (auto kv = _parent->_groups.find(_key); kv != _parent->_groups.end()) {
+		_parent->poll(_key, *kv->second);
+	}
+
+	if (!_ready) {
+		return false;
+	}
+
+	results.assign(_results.begin(), _results.end());
+	_results.clear();
+	_ready = false;
+	return true;
+}
+
+streamfx::nvidia::ar::facedetection_batch::~facedetection_batch()
+{
+	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+
+	auto gctx = ::streamfx::obs::gs::context();
+	_groups.clear();
+}
+
+streamfx::nvidia::ar::facedetection_batch::facedetection_batch() : _lock(), _groups()
+{
+	D_LOG_DEBUG("Initializing... (Addr: 0x%" PRIuPTR ")", this);
+}
+
+void streamfx::nvidia::ar::facedetection_batch::poll(std::pair<uint32_t, uint32_t> key, group& grp)
+{
+	// Hand out the results of the detection in flight, once it has completed.
+	if (grp.fx && grp.fx->pending()) {
+		if (!grp.fx->collect()) {
+			return;
+		}
+
+		float tw = static_cast<float>(std::max<uint32_t>(key.first / tiles_x, 1));
+		float th = static_cast<float>(std::max<uint32_t>(key.second / tiles_y, 1));
+
+		for (auto cl : grp.running) {
+			if (cl) {
+				cl->_results.clear();
+			}
+		}
+		for (size_t idx = 0, edx = grp.fx->count(); idx < edx; idx++) {
+			float confidence = 0.;
+			auto  rect       = grp.fx->at(idx, confidence);
+
+			// Detections belong to the tile their center is in.
+			auto tx   = static_cast<size_t>(std::clamp<float>((rect.x + rect.z / 2.f) / tw, 0.f, tiles_x - 1.f));
+			auto ty   = static_cast<size_t>(std::clamp<float>((rect.y + rect.w / 2.f) / th, 0.f, tiles_y - 1.f));
+			auto tile = ty * tiles_x + tx;
+			if ((tile >= grp.running.size()) || !grp.running[tile]) {
+				continue;
+			}
+
+			detection det;
+			det.rect.x     = (rect.x - static_cast<float>(tx) * tw) * tiles_x;
+			det.rect.y     = (rect.y - static_cast<float>(ty) * th) * tiles_y;
+			det.rect.z     = rect.z * tiles_x;
+			det.rect.w     = rect.w * tiles_y;
+			det.confidence = confidence;
+			grp.running[tile]->_results.push_back(det);
+		}
+		for (auto cl : grp.running) {
+			if (cl) {
+				cl->_ready = true;
+			}
+		}
+		grp.running.clear();
+	}
+
+	// Run the atlas once the frame it was drawn in is over, so that every client had the chance to submit.
+	if (!grp.tiles.empty() && (grp.frame != obs_get_video_frame_time())) {
+		try {
+			if (!grp.fx) {
+				grp.fx = ::streamfx::nvidia::warmup::get()->take<::streamfx::nvidia::ar::facedetection>();
+				grp.fx->set_tracking_limit(grp.fx->tracking_limit_range().second);
+			}
+
+			grp.fx->enqueue(grp.atlas->get_texture());
+			grp.running.swap(grp.tiles);
+		} catch (const std::exception& ex) {
+			D_LOG_ERROR("Failed to run batched face detection: %s", ex.what());
+		}
+		grp.tiles.clear();
+	}
+}
+
+void streamfx::nvidia::ar::facedetection_batch::remove(client* cl)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+
+	if (auto kv = _groups.find(cl->_key); kv != _groups.end()) {
+		// Tiles and detections are assigned by position, so keep the place of clients that are gone.
+		auto& grp = *kv->second;
+		std::replace(grp.tiles.begin(), grp.tiles.end(), cl, static_cast<client*>(nullptr));
+		std::replace(grp.running.begin(), grp.running.end(), cl, static_cast<client*>(nullptr));
+	}
+}
+
+std::shared_ptr<streamfx::nvidia::ar::facedetection_batch> streamfx::nvidia::ar::facedetection_batch::get()
+{
+	static std::weak_ptr<streamfx::nvidia::ar::facedetection_batch> instance;
+	static std::mutex                                               lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (instance.expired()) {
+		auto hard_instance = std::shared_ptr<streamfx::nvidia::ar::facedetection_batch>(new streamfx::nvidia::ar::facedetection_batch());
+		instance           = hard_instance;
+		return hard_instance;
+	}
+	return instance.lock();
+}
@@ -0,0 +1,82 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "nvidia-ar-facedetection.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::nvidia::ar {
+	/** Face detection shared between many inputs of the same size.
+	 *
+	 * Inputs submitted during a frame are scaled down into the tiles of an atlas, which is then detected with a single
+	 * run once the next frame starts. Every detection is handed back to the client whose tile it was found in, as soon
+	 * as the GPU has finished with it.
+	 */
+	class facedetection_batch {
+		public:
+		static constexpr uint32_t tiles_x = 2;
+		static constexpr uint32_t tiles_y = 2;
+
+		struct detection {
+			rect_t rect;
+			float  confidence;
+		};
+
+		class client {
+			friend class facedetection_batch;
+
+			std::shared_ptr<facedetection_batch> _parent;
+			std::pair<uint32_t, uint32_t>        _key;
+			std::vector<detection>               _results;
+			bool                                 _ready;
+
+			public:
+			~client();
+			client(std::shared_ptr<facedetection_batch> parent);
+
+			/** Queue the texture for the next batch. Returns false if there's no space left, try again next frame.
+			 *
+			 * Must be in a graphics context when calling.
+			 */
+			bool submit(std::shared_ptr<::streamfx::obs::gs::texture> in);
+
+			/** Retrieve the detections of the last submitted texture, if they are ready. Does not wait. */
+			bool collect(std::pmr::vector<detection>& results);
+		};
+
+		private:
+		struct group {
+			std::shared_ptr<::streamfx::nvidia::ar::facedetection> fx;
+			std::shared_ptr<::streamfx::obs::gs::rendertarget>     atlas;
+			uint64_t                                               frame;   // Video frame time the tiles were drawn at.
+			std::vector<client*>                                   tiles;   // Clients in the atlas being filled.
+			std::vector<client*>                                   running; // Clients in the detection in flight.
+		};
+
+		std::mutex                                                        _lock;
+		std::map<std::pair<uint32_t, uint32_t>, std::shared_ptr<group>> _groups;
+
+		public:
+		~facedetection_batch();
+
+		private:
+		facedetection_batch();
+
+		void poll(std::pair<uint32_t, uint32_t> key, group& grp);
+
+		void remove(client* cl);
+
+		public:
+		static std::shared_ptr<facedetection_batch> get();
+	};
+} // namespace streamfx::nvidia::ar
@@ -34,14 +34,20 @@ using namespace ::streamfx::nvidia;
 streamfx::nvidia::ar::facedetection::~facedetection()
 {
 	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+
+	// Wait for any pending detection, as it still uses our buffers.
+	if (_pending) {
+		auto cctx = _nvcuda->get_context()->enter();
+		_event->synchronize();
+	}
 }
 
-streamfx::nvidia::ar::facedetection::facedetection() : feature(FEATURE_FACE_DETECTION), _input(), _source(), _tmp(), _rects(), _rects_confidence(), _bboxes(), _dirty(true)
+streamfx::nvidia::ar::facedetection::facedetection() : feature(FEATURE_FACE_DETECTION), _input(), _source(), _tmp(), _rects(), _rects_confidence(), _bboxes(), _event(), _pending(false), _dirty(true)
 {
 	D_LOG_DEBUG("Initializing... (Addr: 0x%" PRIuPTR ")", this);
 
 	// Assign CUDA Stream object.
-	if (auto err = set(P_NVAR_CONFIG "CUDAStream", _nvcuda->get_stream()); err != cv::result::SUCCESS) {
+	if (auto err = set(P_NVAR_CONFIG "CUDAStream", _stream); err != cv::result::SUCCESS) {
 		throw cv::exception("CUDAStream", err);
 	}
 
@@ -72,6 +78,19 @@ void ar::facedetection::set_tracking_limit(size_t v)
 {
 	// Ensure there is always at least one face being tracked.
 	v = std::max<size_t>(v, 1);
+	if (_bboxes.rects && (v == _rects.size())) {
+		return;
+	}
+
+	// Only switching between temporal and non-temporal tracking changes the model, the outputs can just be replaced.
+	bool reload = !_bboxes.rects || ((v == 1) != (_rects.size() == 1));
+
+	// A pending detection still writes into the current buffers, so it has to finish first.
+	if (_pending) {
+		auto cctx = _nvcuda->get_context()->enter();
+		_event->synchronize();
+		_pending = false;
+	}
 
 	// Resize all data.
 	_rects.resize(v);
@@ -89,20 +108,47 @@ void ar::facedetection::set_tracking_limit(size_t v)
 	if (auto err = set(P_NVAR_OUTPUT "BoundingBoxesConfidence", _rects_confidence); err != cv::result::SUCCESS) {
 		throw cv::exception("BoundingBoxesConfidence", err);
 	}
-	if (auto err = set(P_NVAR_CONFIG "Temporal", (v == 1)); err != cv::result::SUCCESS) {
-		throw cv::exception("Temporal", err);
-	}
+	if (reload) {
+		if (auto err = set(P_NVAR_CONFIG "Temporal", (v == 1)); err != cv::result::SUCCESS) {
+			throw cv::exception("Temporal", err);
+		}
 
-	// Mark effect dirty for reload.
-	_dirty = true;
+		// Mark effect dirty for reload.
+		_dirty = true;
+	}
 }
 
 void ar::facedetection::process(std::shared_ptr<::streamfx::obs::gs::texture> in)
 {
+	auto cctx = _nvcuda->get_context()->enter();
+
+	// Finish anything still in flight, as its results would be replaced anyway.
+	if (_pending) {
+		_event->synchronize();
+		_pending = false;
+	}
+
+	enqueue(in);
+	_event->synchronize();
+	_pending = false;
+}
+
+void ar::facedetection::enqueue(std::shared_ptr<::streamfx::obs::gs::texture> in)
+{
+	// Don't touch any buffers the previous detection may still be using.
+	if (_pending) {
+		return;
+	}
+
 	// Enter Graphics and CUDA context.
 	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = _nvcuda->get_context()->enter();
 
+	if (!_event) {
+		_event = std::make_shared<::streamfx::nvidia::cuda::event>();
+	}
+	_timer->begin();
+
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_magenta, "NvAR Face Detection"};
 #endif
@@ -126,7 +172,7 @@ void ar::facedetection::process(std::shared_ptr<::streamfx::obs::gs::texture> in
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Copy Input -> Source"};
 #endif
-		if (auto res = _nvcv->NvCVImage_Transfer(_input->get_image(), _source->get_image(), 1.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		if (auto res = _nvcv->NvCVImage_Transfer(_input->get_image(), _source->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
 			D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcv->NvCV_GetErrorStringFromCode(res));
 			throw std::runtime_error("Transfer failed.");
 		}
@@ -140,6 +186,31 @@ void ar::facedetection::process(std::shared_ptr<::streamfx::obs::gs::texture> in
 			throw cv::exception("Run", err);
 		}
 	}
+
+	// Mark the end of the queued work, so that collect() can tell when the results are ready.
+	_timer->end();
+	_event->record(_stream);
+	_pending = true;
+}
+
+bool ar::facedetection::collect()
+{
+	if (!_pending) {
+		return false;
+	}
+
+	auto cctx = _nvcuda->get_context()->enter();
+	if (!_event->query()) {
+		return false;
+	}
+
+	_pending = false;
+	return true;
+}
+
+bool ar::facedetection::pending()
+{
+	return _pending;
 }
 
 size_t streamfx::nvidia::ar::facedetection::count()
@@ -203,10 +274,15 @@ void streamfx::nvidia::ar::facedetection::load()
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
 	// Assign CUDA Stream object.
-	if (auto err = set(P_NVAR_CONFIG "CUDAStream", _nvcuda->get_stream()); err != cv::result::SUCCESS) {
+	if (auto err = set(P_NVAR_CONFIG "CUDAStream", _stream); err != cv::result::SUCCESS) {
 		throw cv::exception("CUDAStream", err);
 	}
 
+	// Capture the kernels into a CUDA graph on first run and replay it afterwards. Not every SDK version supports this.
+	if (auto err = set(P_NVAR_CONFIG "UseCudaGraph", static_cast<uint32_t>(1)); err != cv::result::SUCCESS) {
+		D_LOG_DEBUG("CUDA graphs are not supported, error: %s", _nvcv->NvCV_GetErrorStringFromCode(err));
+	}
+
 	// Attempt to load the feature.
 	if (auto err = feature::load(); err != cv::result::SUCCESS) {
 		throw cv::exception("Load", err);
@@ -4,6 +4,7 @@
 
 #pragma once
 #include "nvidia-ar-feature.hpp"
+#include "nvidia/cuda/nvidia-cuda-event.hpp"
 #include "nvidia/cuda/nvidia-cuda-gs-texture.hpp"
 #include "nvidia/cuda/nvidia-cuda-obs.hpp"
 #include "nvidia/cuda/nvidia-cuda.hpp"
@@ -21,6 +22,9 @@ namespace streamfx::nvidia::ar {
 		std::vector<float>  _rects_confidence;
 		bounds_t            _bboxes;
 
+		std::shared_ptr<::streamfx::nvidia::cuda::event> _event;
+		bool                                             _pending;
+
 		bool _dirty;
 
 		public:
@@ -36,10 +40,26 @@ namespace streamfx::nvidia::ar {
 
 		size_t tracking_limit();
 
+		/** Only needs the model to be loaded again when switching between one and several faces. */
 		void set_tracking_limit(size_t v);
 
+		/** Detect faces in the texture and wait for the results. */
 		void process(std::shared_ptr<::streamfx::obs::gs::texture> in);
 
+		/** Queue face detection for the texture without waiting for it to complete.
+		 *
+		 * Results only become available through count() and at() once collect() returned true. Nothing is queued while
+		 * a previous detection is still pending.
+		 *
+		 * Must be in a graphics context when calling.
+		 */
+		void enqueue(std::shared_ptr<::streamfx::obs::gs::texture> in);
+
+		/** Check if the queued detection completed, in which case its results are now available. Does not wait. */
+		bool collect();
+
+		bool pending();
+
 		size_t count();
 
 		rect_t const& at(size_t index);
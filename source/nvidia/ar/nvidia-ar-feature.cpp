@@ -24,9 +24,17 @@
 streamfx::nvidia::ar::feature::~feature()
 {
 	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+
+	if (_timer && (_timer->count() > 0)) {
+		D_LOG_INFO("Timings: %" PRIu64 " frames, %.3f ms transfer, %.3f ms run on average.", _timer->count(), _timer->average_transfer(), _timer->average_run());
+	}
+
+	auto gctx = ::streamfx::obs::gs::context();
+	auto cctx = _nvcuda->get_context()->enter();
+	_timer.reset();
 }
 
-streamfx::nvidia::ar::feature::feature(feature_t feature) : _nvcuda(::streamfx::nvidia::cuda::obs::get()), _nvcv(::streamfx::nvidia::cv::cv::get()), _nvar(::streamfx::nvidia::ar::ar::get()), _fx()
+streamfx::nvidia::ar::feature::feature(feature_t feature) : _nvcuda(::streamfx::nvidia::cuda::obs::get()), _stream(_nvcuda->acquire_stream(::streamfx::nvidia::cuda::stream_priority::NORMAL)), _nvcv(::streamfx::nvidia::cv::cv::get()), _nvar(::streamfx::nvidia::ar::ar::get()), _fx(), _model_path(), _timer()
 {
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 	auto gctx = ::streamfx::obs::gs::context();
@@ -38,9 +46,10 @@ streamfx::nvidia::ar::feature::feature(feature_t feature) : _nvcuda(::streamfx::
 		throw cv::exception("Failed to create feature.", res);
 	}
 	_fx = std::shared_ptr<void>(handle, [this](::streamfx::nvidia::ar::handle_t handle) { _nvar->NvAR_Destroy(handle); });
+	_timer = std::make_shared<::streamfx::nvidia::cuda::run_timer>(_stream);
 
 	// Set CUDA stream and model directory.
-	set(P_NVAR_CONFIG "CUDAStream", _nvcuda->get_stream());
+	set(P_NVAR_CONFIG "CUDAStream", _stream);
 	_model_path = _nvar->get_model_path().generic_u8string();
 	set(P_NVAR_CONFIG "ModelDir", _model_path);
 }
@@ -4,6 +4,7 @@
 
 #pragma once
 #include "nvidia/ar/nvidia-ar.hpp"
+#include "nvidia/cuda/nvidia-cuda-event.hpp"
 #include "nvidia/cuda/nvidia-cuda-obs.hpp"
 #include "nvidia/cv/nvidia-cv-image.hpp"
 #include "nvidia/cv/nvidia-cv-texture.hpp"
@@ -16,11 +17,13 @@
 namespace streamfx::nvidia::ar {
 	class feature {
 		protected:
-		std::shared_ptr<::streamfx::nvidia::cuda::obs> _nvcuda;
-		std::shared_ptr<::streamfx::nvidia::cv::cv>    _nvcv;
-		std::shared_ptr<::streamfx::nvidia::ar::ar>    _nvar;
-		std::shared_ptr<void>                          _fx;
-		std::string                                    _model_path;
+		std::shared_ptr<::streamfx::nvidia::cuda::obs>       _nvcuda;
+		std::shared_ptr<::streamfx::nvidia::cuda::stream>    _stream;
+		std::shared_ptr<::streamfx::nvidia::cv::cv>          _nvcv;
+		std::shared_ptr<::streamfx::nvidia::ar::ar>          _nvar;
+		std::shared_ptr<void>                                _fx;
+		std::string                                          _model_path;
+		std::shared_ptr<::streamfx::nvidia::cuda::run_timer> _timer;
 
 		public:
 		~feature();
@@ -31,6 +34,12 @@ namespace streamfx::nvidia::ar {
 			return _fx.get();
 		}
 
+		/** GPU time spent in run(), and around it between begin() and end() of the timer. */
+		std::shared_ptr<::streamfx::nvidia::cuda::run_timer> timer()
+		{
+			return _timer;
+		}
+
 		public /* Int32 */:
 		inline cv::result set(parameter_t param, uint32_t const value)
 		{
@@ -186,7 +195,10 @@ namespace streamfx::nvidia::ar {
 
 		inline cv::result run()
 		{
-			return _nvar->NvAR_Run(_fx.get());
+			_timer->run_begin();
+			cv::result res = _nvar->NvAR_Run(_fx.get());
+			_timer->run_end();
+			return res;
 		}
 	};
 } // namespace streamfx::nvidia::ar
@@ -5,6 +5,7 @@
 #include "nvidia-ar.hpp"
 #include "nvidia/cuda/nvidia-cuda-obs.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
 #include "util/util-logging.hpp"
 #include "util/util-platform.hpp"
 
@@ -46,44 +47,19 @@
 			throw std::runtime_error("Failed to load '" #NAME "' from '" ST_LIBRARY_NAME "'."); \
 	}
 
-streamfx::nvidia::ar::ar::~ar()
+static void find_sdk_path(std::filesystem::path& sdk_path, std::filesystem::path& model_path)
 {
-	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
-
-#ifdef WIN32
-	// Remove the DLL directory from the library loader paths.
-	if (_extra != nullptr) {
-		RemoveDllDirectory(reinterpret_cast<DLL_DIRECTORY_COOKIE>(_extra));
-	}
-#endif
-
-	{ // The library may need to release Graphics and CUDA resources.
-		auto gctx = ::streamfx::obs::gs::context();
-		auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
-		_library.reset();
-	}
-}
-
-streamfx::nvidia::ar::ar::ar() : _library(), _model_path()
-{
-	std::filesystem::path sdk_path;
-	auto                  gctx = ::streamfx::obs::gs::context();
-	auto                  cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
-
-	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
-
-	// Figure out where the Augmented Reality SDK is, if it is installed.
 #ifdef WIN32
 	{
 		// NVAR SDK only defines NVAR_MODEL_PATH, so we'll use that as our baseline.
 		DWORD env_size = GetEnvironmentVariableW(L"NVAR_MODEL_PATH", nullptr, 0);
 		if (env_size > 0) {
 			std::vector<wchar_t> buffer(static_cast<size_t>(env_size) + 1, 0);
-			env_size    = GetEnvironmentVariableW(L"NVAR_MODEL_PATH", buffer.data(), static_cast<DWORD>(buffer.size()));
-			_model_path = std::wstring(buffer.data(), buffer.size());
+			env_size   = GetEnvironmentVariableW(L"NVAR_MODEL_PATH", buffer.data(), static_cast<DWORD>(buffer.size()));
+			model_path = std::wstring(buffer.data(), buffer.size());
 
 			// The SDK is location one directory "up" from the model path.
-			sdk_path = std::filesystem::path(_model_path) / "..";
+			sdk_path = std::filesystem::path(model_path) / "..";
 		}
 
 		// If the environment variable wasn't set and our model path is still undefined, guess!
@@ -97,18 +73,48 @@ streamfx::nvidia::ar::ar::ar() : _library(), _model_path()
 				CoTaskMemFree(str);
 
 				// Model path is in 'models' subdirectory.
-				_model_path = sdk_path;
-				_model_path /= "models";
+				model_path = sdk_path;
+				model_path /= "models";
 			}
 		}
 
 		// Figure out absolute paths to everything.
-		_model_path = streamfx::util::platform::native_to_utf8(std::filesystem::absolute(_model_path));
-		sdk_path    = streamfx::util::platform::native_to_utf8(std::filesystem::absolute(sdk_path));
+		model_path = streamfx::util::platform::native_to_utf8(std::filesystem::absolute(model_path));
+		sdk_path   = streamfx::util::platform::native_to_utf8(std::filesystem::absolute(sdk_path));
 	}
 #else
 	throw std::runtime_error("Not yet implemented.");
 #endif
+}
+
+streamfx::nvidia::ar::ar::~ar()
+{
+	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+
+#ifdef WIN32
+	// Remove the DLL directory from the library loader paths.
+	if (_extra != nullptr) {
+		RemoveDllDirectory(reinterpret_cast<DLL_DIRECTORY_COOKIE>(_extra));
+	}
+#endif
+
+	{ // The library may need to release Graphics and CUDA resources.
+		auto gctx = ::streamfx::obs::gs::context();
+		auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
+		_library.reset();
+	}
+}
+
+streamfx::nvidia::ar::ar::ar() : _library(), _model_path()
+{
+	std::filesystem::path sdk_path;
+	auto                  gctx = ::streamfx::obs::gs::context();
+	auto                  cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
+
+	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
+
+	// Figure out where the Augmented Reality SDK is, if it is installed.
+	find_sdk_path(sdk_path, _model_path);
 
 	// Check if any of the found paths are valid.
 	if (!std::filesystem::exists(sdk_path)) {
@@ -202,6 +208,19 @@ std::filesystem::path const& streamfx::nvidia::ar::ar::get_model_path()
 	return _model_path;
 }
 
+bool streamfx::nvidia::ar::ar::is_available()
+{
+	try {
+		std::filesystem::path sdk_path, model_path;
+		find_sdk_path(sdk_path, model_path);
+		return std::filesystem::exists(sdk_path / ST_LIBRARY_NAME);
+	} catch (...) {
+		return false;
+	}
+}
+
+static std::shared_ptr<streamfx::nvidia::ar::ar> loader_instance;
+
 std::shared_ptr<streamfx::nvidia::ar::ar> streamfx::nvidia::ar::ar::get()
 {
 	static std::weak_ptr<streamfx::nvidia::ar::ar> instance;
@@ -211,7 +230,17 @@ std::shared_ptr<streamfx::nvidia::ar::ar> streamfx::nvidia::ar::ar::get()
 	if (instance.expired()) {
 		auto hard_instance = std::make_shared<streamfx::nvidia::ar::ar>();
 		instance           = hard_instance;
+		loader_instance    = hard_instance; // Stay loaded until the plugin unloads.
 		return hard_instance;
 	}
 	return instance.lock();
 }
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		// Loaded on first use, so that nothing is paid for it unless an NVIDIA feature is used.
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::HIGH);
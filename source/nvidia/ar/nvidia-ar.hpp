@@ -161,5 +161,8 @@ namespace streamfx::nvidia::ar {
 
 		public:
 		static std::shared_ptr<::streamfx::nvidia::ar::ar> get();
+
+		/** Is the SDK installed? Only looks for the library, without loading it. */
+		static bool is_available();
 	};
 } // namespace streamfx::nvidia::ar
@@ -68,6 +68,20 @@ streamfx::nvidia::cuda::context::context(ID3D11Device* device) : context()
 		throw std::runtime_error("Failed to get device index for device.");
 	}
 
+	attach();
+}
+#endif
+
+streamfx::nvidia::cuda::context::context(::streamfx::nvidia::cuda::device_t device) : context()
+{
+	_device = device;
+	attach();
+}
+
+void streamfx::nvidia::cuda::context::attach()
+{
+	using namespace streamfx::nvidia::cuda;
+
 	_cuda->cuDevicePrimaryCtxSetFlags(_device, context_flags::SCHEDULER_BLOCKING_SYNC);
 
 	// Acquire Context
@@ -97,13 +111,18 @@ streamfx::nvidia::cuda::context::context(ID3D11Device* device) : context()
 
 	_has_device = true;
 }
-#endif
 
 ::streamfx::nvidia::cuda::context_t streamfx::nvidia::cuda::context::get()
 {
 	return _ctx;
 }
 
+bool streamfx::nvidia::cuda::context::get_device(::streamfx::nvidia::cuda::device_t& device)
+{
+	device = _device;
+	return _has_device;
+}
+
 std::shared_ptr<::streamfx::nvidia::cuda::context_stack> streamfx::nvidia::cuda::context::enter()
 {
 	return std::make_shared<::streamfx::nvidia::cuda::context_stack>(shared_from_this());
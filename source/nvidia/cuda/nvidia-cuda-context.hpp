@@ -25,13 +25,21 @@ namespace streamfx::nvidia::cuda {
 		private:
 		context();
 
+		void attach();
+
 		public:
 #ifdef WIN32
 		context(ID3D11Device* device);
 #endif
 
+		/** Use the primary context of a device, for work that doesn't have to be on the device OBS renders on. */
+		context(::streamfx::nvidia::cuda::device_t device);
+
 		::streamfx::nvidia::cuda::context_t get();
 
+		/** Device the context was created for, if it was created for one. */
+		bool get_device(::streamfx::nvidia::cuda::device_t& device);
+
 		void push();
 		void pop();
 
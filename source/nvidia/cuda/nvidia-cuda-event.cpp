@@ -0,0 +1,148 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "nvidia-cuda-event.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<nvidia::cuda::event> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+streamfx::nvidia::cuda::event::~event()
+{
+	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+
+	_cuda->cuEventDestroy(_event);
+}
+
+streamfx::nvidia::cuda::event::event(::streamfx::nvidia::cuda::event_flags flags) : _cuda(::streamfx::nvidia::cuda::cuda::get()), _event()
+{
+	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
+
+	if (auto res = _cuda->cuEventCreate(&_event, flags); res != ::streamfx::nvidia::cuda::result::SUCCESS) {
+		throw std::runtime_error("Failed to create CUevent object.");
+	}
+}
+
+::streamfx::nvidia::cuda::event_t streamfx::nvidia::cuda::event::get()
+{
+	return _event;
+}
+
+void streamfx::nvidia::cuda::event::record(std::shared_ptr<::streamfx::nvidia::cuda::stream> stream)
+{
+	if (auto res = _cuda->cuEventRecord(_event, stream->get()); res != ::streamfx::nvidia::cuda::result::SUCCESS) {
+		throw ::streamfx::nvidia::cuda::cuda_error(res);
+	}
+}
+
+bool streamfx::nvidia::cuda::event::query()
+{
+	switch (auto res = _cuda->cuEventQuery(_event); res) {
+	case ::streamfx::nvidia::cuda::result::SUCCESS:
+		return true;
+	case ::streamfx::nvidia::cuda::result::NOT_READY:
+		return false;
+	default:
+		throw ::streamfx::nvidia::cuda::cuda_error(res);
+	}
+}
+
+void streamfx::nvidia::cuda::event::synchronize()
+{
+	if (auto res = _cuda->cuEventSynchronize(_event); res != ::streamfx::nvidia::cuda::result::SUCCESS) {
+		throw ::streamfx::nvidia::cuda::cuda_error(res);
+	}
+}
+
+float streamfx::nvidia::cuda::event::elapsed_since(std::shared_ptr<::streamfx::nvidia::cuda::event> const& start)
+{
+	float milliseconds = 0;
+	if (auto res = _cuda->cuEventElapsedTime(&milliseconds, start->get(), _event); res != ::streamfx::nvidia::cuda::result::SUCCESS) {
+		throw ::streamfx::nvidia::cuda::cuda_error(res);
+	}
+	return milliseconds;
+}
+
+streamfx::nvidia::cuda::run_timer::~run_timer() {}
+
+streamfx::nvidia::cuda::run_timer::run_timer(std::shared_ptr<::streamfx::nvidia::cuda::stream> stream) : _stream(stream), _events(), _stage(0), _pending(false), _count(0), _transfer_total(0), _run_total(0)
+{
+	for (auto& ev : _events) {
+		ev = std::make_shared<::streamfx::nvidia::cuda::event>(::streamfx::nvidia::cuda::event_flags::DEFAULT);
+	}
+}
+
+void streamfx::nvidia::cuda::run_timer::begin()
+{
+	if (_pending && _events[3]->query()) {
+		float run = _events[2]->elapsed_since(_events[1]);
+		_transfer_total += _events[3]->elapsed_since(_events[0]) - run;
+		_run_total += run;
+		_count++;
+		_pending = false;
+	}
+
+	// Events can't be recorded again until the GPU is done with them, so skip this frame.
+	_stage = _pending ? _events.size() : 0;
+	mark(0);
+}
+
+void streamfx::nvidia::cuda::run_timer::run_begin()
+{
+	mark(1);
+}
+
+void streamfx::nvidia::cuda::run_timer::run_end()
+{
+	mark(2);
+}
+
+void streamfx::nvidia::cuda::run_timer::end()
+{
+	mark(3);
+	if (_stage == _events.size()) {
+		_pending = true;
+	}
+}
+
+uint64_t streamfx::nvidia::cuda::run_timer::count()
+{
+	return _count;
+}
+
+double streamfx::nvidia::cuda::run_timer::average_transfer()
+{
+	return _count ? (_transfer_total / static_cast<double>(_count)) : 0.;
+}
+
+double streamfx::nvidia::cuda::run_timer::average_run()
+{
+	return _count ? (_run_total / static_cast<double>(_count)) : 0.;
+}
+
+void streamfx::nvidia::cuda::run_timer::mark(std::size_t stage)
+{
+	// Stages out of order, such as after an error half way through, make the frame unusable.
+	if (_stage != stage) {
+		_stage = _events.size() + 1;
+		return;
+	}
+	_events[stage]->record(_stream);
+	_stage++;
+}
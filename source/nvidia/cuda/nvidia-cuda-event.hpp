@@ -0,0 +1,78 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "nvidia-cuda-stream.hpp"
+#include "nvidia-cuda.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <memory>
+#include "warning-enable.hpp"
+
+namespace streamfx::nvidia::cuda {
+	class event {
+		std::shared_ptr<::streamfx::nvidia::cuda::cuda> _cuda;
+		::streamfx::nvidia::cuda::event_t               _event;
+
+		public:
+		~event();
+		event(::streamfx::nvidia::cuda::event_flags flags = ::streamfx::nvidia::cuda::event_flags::DISABLE_TIMING);
+
+		::streamfx::nvidia::cuda::event_t get();
+
+		/** Capture all work currently queued on the stream. */
+		void record(std::shared_ptr<::streamfx::nvidia::cuda::stream> stream);
+
+		/** Check if all work captured by the last record() has completed, without waiting. */
+		bool query();
+
+		void synchronize();
+
+		/** Milliseconds between the completion of start and this event. Both must have completed, and allow timing. */
+		float elapsed_since(std::shared_ptr<::streamfx::nvidia::cuda::event> const& start);
+	};
+
+	/** Splits the GPU time of processing a frame into the time of Run() and the time of everything around it, such as
+	 * transfers and conversions.
+	 *
+	 * Each measurement is collected on the next begin() if the GPU finished it by then, so nothing ever waits. Frames
+	 * that are processed while the previous measurement is still in flight are not measured.
+	 */
+	class run_timer {
+		std::shared_ptr<::streamfx::nvidia::cuda::stream>               _stream;
+		std::array<std::shared_ptr<::streamfx::nvidia::cuda::event>, 4> _events; // Begin, before Run(), after Run(), end.
+		std::size_t                                                     _stage;  // Events recorded for the current frame.
+		bool                                                            _pending;
+
+		uint64_t _count;
+		double   _transfer_total; // Milliseconds.
+		double   _run_total;      // Milliseconds.
+
+		public:
+		~run_timer();
+		run_timer(std::shared_ptr<::streamfx::nvidia::cuda::stream> stream);
+
+		/** Mark the start of processing a frame. Must be in the CUDA context of the stream. */
+		void begin();
+
+		/** Mark the start of Run(). */
+		void run_begin();
+
+		/** Mark the end of Run(). */
+		void run_end();
+
+		/** Mark the end of processing the frame. */
+		void end();
+
+		uint64_t count();
+
+		double average_transfer();
+
+		double average_run();
+
+		private:
+		void mark(std::size_t stage);
+	};
+} // namespace streamfx::nvidia::cuda
@@ -3,9 +3,11 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "nvidia-cuda-memory.hpp"
+#include "nvidia-cuda-obs.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include "warning-enable.hpp"
 
@@ -23,24 +25,160 @@
 #define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
 #endif
 
-streamfx::nvidia::cuda::memory::~memory()
+// Freed blocks beyond this are given back to the driver right away.
+constexpr std::size_t max_cached_bytes = 256ull << 20;
+
+// Round up to a quarter of the power of two below the size, so reuse doesn't depend on exact sizes.
+static std::size_t size_class(std::size_t size)
+{
+	constexpr std::size_t min_size = 4096;
+	if (size <= min_size) {
+		return min_size;
+	}
+
+	std::size_t power = min_size;
+	while ((power << 1) <= size) {
+		power <<= 1;
+	}
+	std::size_t step = power >> 2;
+	return (size + step - 1) & ~(step - 1);
+}
+
+streamfx::nvidia::cuda::memory_pool::~memory_pool()
 {
 	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
 
-	_cuda->cuMemFree(_pointer);
+	auto cctx = _context->enter();
+	if (_pool) {
+		uint64_t reserved = 0;
+		_cuda->cuMemPoolGetAttribute(_pool, mem_pool_attribute::RESERVED_MEM_HIGH, &reserved);
+		D_LOG_INFO("Served %zu allocations, peak usage was %zu bytes with %" PRIu64 " bytes reserved by the driver.", _allocations, _peak_used, reserved);
+
+		// Give the memory back, now that nothing in StreamFX uses it.
+		uint64_t threshold = 0;
+		_cuda->cuMemPoolSetAttribute(_pool, mem_pool_attribute::RELEASE_THRESHOLD, &threshold);
+		_cuda->cuMemPoolTrimTo(_pool, 0);
+	} else {
+		D_LOG_INFO("Served %zu allocations, %zu of them (%.1f%%) from the cache, peak usage was %zu bytes with at most %zu bytes cached.", _allocations, _hits, (_allocations > 0) ? (_hits * 100.0 / _allocations) : 0.0, _peak_used, _peak_cached);
+
+		for (auto& kv : _cache) {
+			for (auto pointer : kv.second) {
+				_cuda->cuMemFree(pointer);
+			}
+		}
+	}
 }
 
-streamfx::nvidia::cuda::memory::memory(size_t size) : _cuda(::streamfx::nvidia::cuda::cuda::get()), _pointer(), _size(size)
+streamfx::nvidia::cuda::memory_pool::memory_pool() : _cuda(::streamfx::nvidia::cuda::cuda::get()), _context(::streamfx::nvidia::cuda::obs::get()->get_context()), _pool(), _lock(), _cache(), _cached(0), _used(0), _allocations(0), _hits(0), _peak_used(0), _peak_cached(0)
 {
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 
-	::streamfx::nvidia::cuda::result res = _cuda->cuMemAlloc(&_pointer, _size);
-	switch (res) {
-	case ::streamfx::nvidia::cuda::result::SUCCESS:
-		break;
-	default:
-		throw std::runtime_error("nvidia::cuda::memory: cuMemAlloc failed.");
+	::streamfx::nvidia::cuda::device_t device;
+	if (_cuda->cuMemAllocAsync && _cuda->cuMemFreeAsync && _cuda->cuDeviceGetDefaultMemPool && _cuda->cuMemPoolGetAttribute && _cuda->cuMemPoolSetAttribute && _cuda->cuMemPoolTrimTo && _context->get_device(device)) {
+		if (auto res = _cuda->cuDeviceGetDefaultMemPool(&_pool, device); res == ::streamfx::nvidia::cuda::result::SUCCESS) {
+			// By default the pool gives memory back to the driver whenever a stream synchronizes, which is every frame.
+			uint64_t threshold = UINT64_MAX;
+			_cuda->cuMemPoolSetAttribute(_pool, mem_pool_attribute::RELEASE_THRESHOLD, &threshold);
+		} else {
+			_pool = nullptr;
+		}
+	}
+
+	D_LOG_INFO("Using %s.", _pool ? "the stream ordered allocator of the driver" : "a cache of freed blocks");
+}
+
+streamfx::nvidia::cuda::device_ptr_t streamfx::nvidia::cuda::memory_pool::allocate(std::size_t size)
+{
+	::streamfx::nvidia::cuda::device_ptr_t pointer = 0;
+
+	if (_pool) {
+		if (auto res = _cuda->cuMemAllocAsync(&pointer, size, nullptr); res != ::streamfx::nvidia::cuda::result::SUCCESS) {
+			throw std::runtime_error("nvidia::cuda::memory_pool: cuMemAllocAsync failed.");
+		}
+
+		std::unique_lock<std::mutex> ul(_lock);
+		_allocations++;
+		_used += size;
+		_peak_used = std::max(_peak_used, _used);
+		return pointer;
+	}
+
+	std::size_t                  bytes = size_class(size);
+	std::unique_lock<std::mutex> ul(_lock);
+	_allocations++;
+	if (auto kv = _cache.find(bytes); (kv != _cache.end()) && !kv->second.empty()) {
+		pointer = kv->second.back();
+		kv->second.pop_back();
+		_cached -= bytes;
+		_hits++;
+	} else if (_cuda->cuMemAlloc(&pointer, bytes) != ::streamfx::nvidia::cuda::result::SUCCESS) {
+		// Whatever is cached might be what stands in the way.
+		for (auto& kv2 : _cache) {
+			for (auto cached : kv2.second) {
+				_cuda->cuMemFree(cached);
+			}
+		}
+		_cache.clear();
+		_cached = 0;
+
+		if (_cuda->cuMemAlloc(&pointer, bytes) != ::streamfx::nvidia::cuda::result::SUCCESS) {
+			throw std::runtime_error("nvidia::cuda::memory_pool: cuMemAlloc failed.");
+		}
+	}
+	_used += bytes;
+	_peak_used = std::max(_peak_used, _used);
+	return pointer;
+}
+
+void streamfx::nvidia::cuda::memory_pool::free(::streamfx::nvidia::cuda::device_ptr_t pointer, std::size_t size)
+{
+	if (_pool) {
+		_cuda->cuMemFreeAsync(pointer, nullptr);
+
+		std::unique_lock<std::mutex> ul(_lock);
+		_used -= size;
+		return;
+	}
+
+	std::size_t                  bytes = size_class(size);
+	std::unique_lock<std::mutex> ul(_lock);
+	_used -= bytes;
+	if ((_cached + bytes) > max_cached_bytes) {
+		_cuda->cuMemFree(pointer);
+		return;
+	}
+	_cache[bytes].push_back(pointer);
+	_cached += bytes;
+	_peak_cached = std::max(_peak_cached, _cached);
+}
+
+std::shared_ptr<::streamfx::nvidia::cuda::memory_pool> streamfx::nvidia::cuda::memory_pool::get()
+{
+	static std::weak_ptr<::streamfx::nvidia::cuda::memory_pool> instance;
+	static std::mutex                                           lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (instance.expired()) {
+		auto hard_instance = std::shared_ptr<::streamfx::nvidia::cuda::memory_pool>(new ::streamfx::nvidia::cuda::memory_pool());
+		instance           = hard_instance;
+		return hard_instance;
 	}
+	return instance.lock();
+}
+
+streamfx::nvidia::cuda::memory::~memory()
+{
+	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+
+	_pool->free(_pointer, _size);
+}
+
+streamfx::nvidia::cuda::memory::memory(size_t size) : _pool(::streamfx::nvidia::cuda::memory_pool::get()), _pointer(), _size(size), _vram(::streamfx::gfx::vram::kind::CUDA)
+{
+	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
+
+	_pointer = _pool->allocate(_size);
+	_vram.resize(_size);
 }
 
 streamfx::nvidia::cuda::device_ptr_t streamfx::nvidia::cuda::memory::get()
@@ -3,18 +3,64 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "nvidia-cuda-context.hpp"
 #include "nvidia-cuda.hpp"
+#include "gfx/gfx-vram.hpp"
 
 #include "warning-disable.hpp"
 #include <cstddef>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::nvidia::cuda {
+	/** Device memory allocator shared by everything in StreamFX that needs CUDA memory.
+	 *
+	 * Effects reallocate their buffers whenever the source changes size, and cuMemAlloc/cuMemFree synchronize the
+	 * whole device. With CUDA 11.2 or newer, allocations are stream ordered on the legacy default stream, which every
+	 * StreamFX stream synchronizes with, and the default memory pool of the device is told to keep freed memory.
+	 * Older drivers get a cache of freed blocks, rounded up to a quarter of their power of two.
+	 *
+	 * The CUDA context must be current when allocating or freeing.
+	 */
+	class memory_pool {
+		std::shared_ptr<::streamfx::nvidia::cuda::cuda>    _cuda;
+		std::shared_ptr<::streamfx::nvidia::cuda::context> _context;
+		::streamfx::nvidia::cuda::mem_pool_t               _pool;
+
+		std::mutex                                                                 _lock;
+		std::map<std::size_t, std::vector<::streamfx::nvidia::cuda::device_ptr_t>> _cache;
+		std::size_t                                                                _cached;
+		std::size_t                                                                _used;
+
+		std::size_t _allocations;
+		std::size_t _hits;
+		std::size_t _peak_used;
+		std::size_t _peak_cached;
+
+		private:
+		memory_pool();
+
+		public:
+		~memory_pool();
+
+		/** Allocate device memory, which may be larger than requested. */
+		::streamfx::nvidia::cuda::device_ptr_t allocate(std::size_t size);
+
+		/** Return device memory, with the same size as was requested. */
+		void free(::streamfx::nvidia::cuda::device_ptr_t pointer, std::size_t size);
+
+		public /* Singleton */:
+		static std::shared_ptr<::streamfx::nvidia::cuda::memory_pool> get();
+	};
+
 	class memory {
-		std::shared_ptr<::streamfx::nvidia::cuda::cuda> _cuda;
-		device_ptr_t                                    _pointer;
-		size_t                                          _size;
+		std::shared_ptr<::streamfx::nvidia::cuda::memory_pool> _pool;
+		device_ptr_t                                           _pointer;
+		size_t                                                 _size;
+		::streamfx::gfx::vram::allocation                      _vram;
 
 		public:
 		~memory();
@@ -3,7 +3,9 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "nvidia-cuda-obs.hpp"
+#include "configuration.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
 #include "util/util-logging.hpp"
 
 #ifdef _DEBUG
@@ -20,6 +22,12 @@
 #define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
 #endif
 
+// Maximum number of streams per priority, beyond which users have to share.
+#define ST_STREAM_POOL_SIZE 4
+
+// CUDA device ordinal to run NVIDIA effects on, or -1 for the GPU OBS renders on.
+#define ST_CFG_COMPUTE_DEVICE "NVIDIA.ComputeDevice"
+
 streamfx::nvidia::cuda::obs::~obs()
 {
 	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
@@ -29,8 +37,14 @@ streamfx::nvidia::cuda::obs::~obs()
 		auto stack = _context->enter();
 		_stream->synchronize();
 		_context->synchronize();
+		_stream_pool.clear();
 		_stream.reset();
 	}
+	if (_compute != _context) {
+		auto stack = _compute->enter();
+		_compute->synchronize();
+	}
+	_compute.reset();
 	_context.reset();
 	_cuda.reset();
 }
@@ -52,10 +66,77 @@ streamfx::nvidia::cuda::obs::obs() : _cuda(::streamfx::nvidia::cuda::cuda::get()
 	}
 
 	// Create Stream
-	auto stack = _context->enter();
-	_stream    = std::make_shared<::streamfx::nvidia::cuda::stream>();
+	{
+		auto stack = _context->enter();
+		_stream    = std::make_shared<::streamfx::nvidia::cuda::stream>();
+	}
+
+	// Create the context effects run in.
+	_compute = _context;
+	try {
+		auto ordinal = get_configured_device();
+		if (ordinal >= 0) {
+			_compute = create_compute_context(ordinal);
+		}
+	} catch (const std::exception& ex) {
+		D_LOG_WARNING("Unable to use the configured compute device, NVIDIA effects will run on the GPU OBS renders on: %s", ex.what());
+		_compute = _context;
+	}
 }
 
+int32_t streamfx::nvidia::cuda::obs::get_configured_device()
+{
+	auto data = streamfx::configuration::instance()->get();
+	obs_data_set_default_int(data.get(), ST_CFG_COMPUTE_DEVICE, -1);
+	return static_cast<int32_t>(obs_data_get_int(data.get(), ST_CFG_COMPUTE_DEVICE));
+}
+
+std::shared_ptr<streamfx::nvidia::cuda::context> streamfx::nvidia::cuda::obs::create_compute_context(int32_t ordinal)
+{
+	::streamfx::nvidia::cuda::device_t render_device;
+	::streamfx::nvidia::cuda::device_t compute_device;
+	int32_t                            count = 0;
+	if (!_context->get_device(render_device)) {
+		throw std::runtime_error("The GPU OBS renders on is unknown.");
+	}
+	if ((_cuda->cuDeviceGetCount(&count) != ::streamfx::nvidia::cuda::result::SUCCESS) || (ordinal >= count)) {
+		throw std::runtime_error("There is no CUDA device with that number.");
+	}
+	if (_cuda->cuDeviceGet(&compute_device, ordinal) != ::streamfx::nvidia::cuda::result::SUCCESS) {
+		throw std::runtime_error("Failed to get the CUDA device.");
+	}
+	if (compute_device == render_device) {
+		return _context;
+	}
+
+	// Frames are copied directly between the two GPUs, which needs peer access in both directions.
+	int32_t to_compute = 0;
+	int32_t to_render  = 0;
+	if (!_cuda->cuDeviceCanAccessPeer || !_cuda->cuCtxEnablePeerAccess || !_cuda->cuMemcpyPeerAsync) {
+		throw std::runtime_error("The installed driver can't copy memory between GPUs.");
+	}
+	_cuda->cuDeviceCanAccessPeer(&to_compute, render_device, compute_device);
+	_cuda->cuDeviceCanAccessPeer(&to_render, compute_device, render_device);
+	if (!to_compute || !to_render) {
+		throw std::runtime_error("The GPUs can't access each others memory.");
+	}
+
+	auto compute = std::make_shared<::streamfx::nvidia::cuda::context>(compute_device);
+	auto enable  = [this](std::shared_ptr<::streamfx::nvidia::cuda::context> from, std::shared_ptr<::streamfx::nvidia::cuda::context> to) {
+		auto stack = from->enter();
+		if (auto res = _cuda->cuCtxEnablePeerAccess(to->get(), 0); (res != ::streamfx::nvidia::cuda::result::SUCCESS) && (res != ::streamfx::nvidia::cuda::result::PEER_ACCESS_ENABLED)) {
+			throw std::runtime_error("Failed to enable peer access between the GPUs.");
+		}
+	};
+	enable(_context, compute);
+	enable(compute, _context);
+
+	D_LOG_INFO("NVIDIA effects will run on CUDA device %" PRId32 ".", ordinal);
+	return compute;
+}
+
+static std::shared_ptr<streamfx::nvidia::cuda::obs> loader_instance;
+
 std::shared_ptr<streamfx::nvidia::cuda::obs> streamfx::nvidia::cuda::obs::get()
 {
 	static std::weak_ptr<streamfx::nvidia::cuda::obs> instance;
@@ -64,8 +145,9 @@ std::shared_ptr<streamfx::nvidia::cuda::obs> streamfx::nvidia::cuda::obs::get()
 	std::unique_lock<std::mutex> ul(lock);
 	if (instance.expired()) {
 		std::shared_ptr<streamfx::nvidia::cuda::obs> hard_instance;
-		hard_instance = std::make_shared<streamfx::nvidia::cuda::obs>();
-		instance      = hard_instance;
+		hard_instance   = std::make_shared<streamfx::nvidia::cuda::obs>();
+		instance        = hard_instance;
+		loader_instance = hard_instance; // Stay loaded until the plugin unloads.
 		return hard_instance;
 	}
 	return instance.lock();
@@ -85,3 +167,48 @@ std::shared_ptr<streamfx::nvidia::cuda::stream> streamfx::nvidia::cuda::obs::get
 {
 	return _stream;
 }
+
+std::shared_ptr<streamfx::nvidia::cuda::context> streamfx::nvidia::cuda::obs::get_compute_context()
+{
+	return _compute;
+}
+
+std::shared_ptr<streamfx::nvidia::cuda::stream> streamfx::nvidia::cuda::obs::acquire_stream(::streamfx::nvidia::cuda::stream_priority priority)
+{
+	std::unique_lock<std::mutex> ul(_stream_pool_lock);
+	auto&                        pool = _stream_pool[priority];
+
+	// Prefer a stream nobody else is using.
+	std::shared_ptr<::streamfx::nvidia::cuda::stream>* least_used = nullptr;
+	for (auto& stream : pool) {
+		if (!least_used || (stream.use_count() < least_used->use_count())) {
+			least_used = &stream;
+		}
+	}
+	if (least_used && ((least_used->use_count() == 1) || (pool.size() >= ST_STREAM_POOL_SIZE))) {
+		return *least_used;
+	}
+
+	// Otherwise create a new one, with the highest priority if requested and supported.
+	auto    stack      = _context->enter();
+	int32_t cuda_prio  = 0;
+	int32_t least_prio = 0;
+	if ((priority == ::streamfx::nvidia::cuda::stream_priority::HIGH) && _cuda->cuStreamCreateWithPriority) {
+		if (_cuda->cuCtxGetStreamPriorityRange(&least_prio, &cuda_prio) != ::streamfx::nvidia::cuda::result::SUCCESS) {
+			cuda_prio = 0;
+		}
+	}
+
+	auto stream = std::make_shared<::streamfx::nvidia::cuda::stream>(::streamfx::nvidia::cuda::stream_flags::DEFAULT, cuda_prio);
+	pool.push_back(stream);
+	return stream;
+}
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		// Loaded on first use, so that nothing is paid for it unless an NVIDIA feature is used.
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::HIGHER);
@@ -8,23 +8,55 @@
 #include "nvidia-cuda.hpp"
 
 #include "warning-disable.hpp"
+#include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::nvidia::cuda {
+	enum class stream_priority : int32_t {
+		NORMAL = 0,
+		HIGH   = 1, // Highest priority the context supports.
+	};
+
 	class obs {
 		std::shared_ptr<::streamfx::nvidia::cuda::cuda>    _cuda;
 		std::shared_ptr<::streamfx::nvidia::cuda::context> _context;
 		std::shared_ptr<::streamfx::nvidia::cuda::stream>  _stream;
+		std::shared_ptr<::streamfx::nvidia::cuda::context> _compute;
+
+		std::mutex                                                                                   _stream_pool_lock;
+		std::map<::streamfx::nvidia::cuda::stream_priority, std::vector<std::shared_ptr<::streamfx::nvidia::cuda::stream>>> _stream_pool;
 
 		public:
 		~obs();
 		obs();
 
+		private:
+		int32_t get_configured_device();
+
+		std::shared_ptr<::streamfx::nvidia::cuda::context> create_compute_context(int32_t ordinal);
+
+		public:
+
 		std::shared_ptr<::streamfx::nvidia::cuda::cuda>    get_cuda();
 		std::shared_ptr<::streamfx::nvidia::cuda::context> get_context();
 		std::shared_ptr<::streamfx::nvidia::cuda::stream>  get_stream();
 
+		/** Context that NVIDIA effects run their inference in.
+		 *
+		 * This is the context of a secondary GPU if one was configured and can access the memory of the GPU OBS
+		 * renders on directly, and the context of the OBS GPU otherwise.
+		 */
+		std::shared_ptr<::streamfx::nvidia::cuda::context> get_compute_context();
+
+		/** Get one of a small pool of streams, so that work from different users can overlap on the GPU.
+		 *
+		 * The least used stream of the priority is returned, and new streams are only created until the pool is full.
+		 */
+		std::shared_ptr<::streamfx::nvidia::cuda::stream> acquire_stream(::streamfx::nvidia::cuda::stream_priority priority);
+
 		public:
 		static std::shared_ptr<::streamfx::nvidia::cuda::obs> get();
 	};
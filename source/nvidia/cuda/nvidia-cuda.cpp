@@ -105,6 +105,8 @@ streamfx::nvidia::cuda::cuda::cuda() : _library()
 		P_CUDA_LOAD_SYMBOL(cuDeviceGetName);
 		P_CUDA_LOAD_SYMBOL(cuDeviceGetLuid);
 		P_CUDA_LOAD_SYMBOL(cuDeviceGetUuid);
+		P_CUDA_LOAD_SYMBOL(cuDeviceGet);
+		P_CUDA_LOAD_SYMBOL(cuDeviceGetCount);
 
 		// Primary Context Management
 		P_CUDA_LOAD_SYMBOL(cuDevicePrimaryCtxRetain);
@@ -144,6 +146,7 @@ streamfx::nvidia::cuda::cuda::cuda() : _library()
 		P_CUDA_LOAD_SYMBOL_OPT_V2(cuMemcpyHtoAAsync);
 		P_CUDA_LOAD_SYMBOL_OPT_V2(cuMemcpyHtoD);
 		P_CUDA_LOAD_SYMBOL_OPT_V2(cuMemcpyHtoDAsync);
+		P_CUDA_LOAD_SYMBOL_OPT(cuMemcpyPeerAsync);
 		P_CUDA_LOAD_SYMBOL_OPT_V2(cuMemHostGetDevicePointer);
 		P_CUDA_LOAD_SYMBOL_V2(cuMemsetD8);
 		P_CUDA_LOAD_SYMBOL(cuMemsetD8Async);
@@ -155,8 +158,13 @@ streamfx::nvidia::cuda::cuda::cuda() : _library()
 		// Virtual Memory Management
 		// - Not yet needed.
 
-		// Stream Ordered Memory Allocator
-		// - Not yet needed.
+		// Stream Ordered Memory Allocator (CUDA 11.2+)
+		P_CUDA_LOAD_SYMBOL_OPT(cuMemAllocAsync);
+		P_CUDA_LOAD_SYMBOL_OPT(cuMemFreeAsync);
+		P_CUDA_LOAD_SYMBOL_OPT(cuDeviceGetDefaultMemPool);
+		P_CUDA_LOAD_SYMBOL_OPT(cuMemPoolGetAttribute);
+		P_CUDA_LOAD_SYMBOL_OPT(cuMemPoolSetAttribute);
+		P_CUDA_LOAD_SYMBOL_OPT(cuMemPoolTrimTo);
 
 		// Unified Addressing
 		// - Not yet needed.
@@ -169,7 +177,12 @@ streamfx::nvidia::cuda::cuda::cuda() : _library()
 		P_CUDA_LOAD_SYMBOL_OPT(cuStreamGetPriority);
 
 		// Event Management
-		// - Not yet needed.
+		P_CUDA_LOAD_SYMBOL(cuEventCreate);
+		P_CUDA_LOAD_SYMBOL_V2(cuEventDestroy);
+		P_CUDA_LOAD_SYMBOL(cuEventElapsedTime);
+		P_CUDA_LOAD_SYMBOL(cuEventQuery);
+		P_CUDA_LOAD_SYMBOL(cuEventRecord);
+		P_CUDA_LOAD_SYMBOL(cuEventSynchronize);
 
 		// External Resource Interoperability (CUDA 11.1+)
 		// - Not yet needed.
@@ -193,7 +206,8 @@ streamfx::nvidia::cuda::cuda::cuda() : _library()
 		// - Not yet needed.
 
 		// Peer Context Memory Access
-		// - Not yet needed.
+		P_CUDA_LOAD_SYMBOL_OPT(cuDeviceCanAccessPeer);
+		P_CUDA_LOAD_SYMBOL_OPT(cuCtxEnablePeerAccess);
 
 		// Graphics Interoperability
 		P_CUDA_LOAD_SYMBOL(cuGraphicsMapResources);
@@ -41,6 +41,8 @@ namespace streamfx::nvidia::cuda {
 		ALREADY_MAPPED           = 208,
 		NOT_MAPPED               = 211,
 		INVALID_GRAPHICS_CONTEXT = 219,
+		NOT_READY                = 600,
+		PEER_ACCESS_ENABLED      = 704,
 		// Still missing some.
 	};
 
@@ -83,16 +85,36 @@ namespace streamfx::nvidia::cuda {
 		NVSCIBUF                     = 8,
 	};
 
+	enum class mem_pool_attribute : uint32_t {
+		REUSE_FOLLOW_EVENT_DEPENDENCIES   = 1,
+		REUSE_ALLOW_OPPORTUNISTIC         = 2,
+		REUSE_ALLOW_INTERNAL_DEPENDENCIES = 3,
+		RELEASE_THRESHOLD                 = 4, // uint64_t
+		RESERVED_MEM_CURRENT              = 5, // uint64_t
+		RESERVED_MEM_HIGH                 = 6, // uint64_t
+		USED_MEM_CURRENT                  = 7, // uint64_t
+		USED_MEM_HIGH                     = 8, // uint64_t
+	};
+
 	enum class stream_flags : uint32_t {
 		DEFAULT      = 0x0,
 		NON_BLOCKING = 0x1,
 	};
 
+	enum class event_flags : uint32_t {
+		DEFAULT        = 0x0,
+		BLOCKING_SYNC  = 0x1,
+		DISABLE_TIMING = 0x2,
+		INTERPROCESS   = 0x4,
+	};
+
 	typedef void*    array_t;
 	typedef void*    context_t;
 	typedef uint64_t device_ptr_t;
+	typedef void*    event_t;
 	typedef void*    external_memory_t;
 	typedef void*    graphics_resource_t;
+	typedef void*    mem_pool_t;
 	typedef void*    stream_t;
 	typedef int32_t  device_t;
 
@@ -206,6 +228,8 @@ namespace streamfx::nvidia::cuda {
 		P_CUDA_DEFINE_FUNCTION(cuDeviceGetName, char* name, int32_t length, device_t device);
 		P_CUDA_DEFINE_FUNCTION(cuDeviceGetLuid, luid_t* luid, uint32_t* device_node_mask, device_t device);
 		P_CUDA_DEFINE_FUNCTION(cuDeviceGetUuid, uuid_t* uuid, device_t device);
+		P_CUDA_DEFINE_FUNCTION(cuDeviceGet, device_t* device, int32_t ordinal);
+		P_CUDA_DEFINE_FUNCTION(cuDeviceGetCount, int32_t* count);
 		// - Not yet needed.
 
 		// Primary Context Management
@@ -247,6 +271,7 @@ namespace streamfx::nvidia::cuda {
 		P_CUDA_DEFINE_FUNCTION(cuMemcpyHtoAAsync, array_t dst, std::size_t dstOffset, void* src, std::size_t byteCount);
 		P_CUDA_DEFINE_FUNCTION(cuMemcpyHtoD, device_ptr_t dst, void* src, std::size_t byteCount);
 		P_CUDA_DEFINE_FUNCTION(cuMemcpyHtoDAsync, device_ptr_t dst, void* src, std::size_t byteCount);
+		P_CUDA_DEFINE_FUNCTION(cuMemcpyPeerAsync, device_ptr_t dst, context_t dst_ctx, device_ptr_t src, context_t src_ctx, std::size_t byteCount, stream_t stream);
 		P_CUDA_DEFINE_FUNCTION(cuMemsetD8, device_ptr_t dst, uint8_t d, size_t byteCount);
 		P_CUDA_DEFINE_FUNCTION(cuMemsetD8Async, device_ptr_t dst, uint8_t d, size_t byteCount, stream_t stream);
 		P_CUDA_DEFINE_FUNCTION(cuMemsetD16, device_ptr_t dst, uint16_t d, size_t byteCount);
@@ -257,8 +282,13 @@ namespace streamfx::nvidia::cuda {
 		// Virtual Memory Management
 		// - Not yet needed.
 
-		// Stream Ordered Memory Allocator
-		// - Not yet needed.
+		// Stream Ordered Memory Allocator (CUDA 11.2+)
+		P_CUDA_DEFINE_FUNCTION(cuMemAllocAsync, device_ptr_t* ptr, std::size_t bytes, stream_t stream);
+		P_CUDA_DEFINE_FUNCTION(cuMemFreeAsync, device_ptr_t ptr, stream_t stream);
+		P_CUDA_DEFINE_FUNCTION(cuDeviceGetDefaultMemPool, mem_pool_t* pool, device_t device);
+		P_CUDA_DEFINE_FUNCTION(cuMemPoolGetAttribute, mem_pool_t pool, mem_pool_attribute attribute, void* value);
+		P_CUDA_DEFINE_FUNCTION(cuMemPoolSetAttribute, mem_pool_t pool, mem_pool_attribute attribute, void* value);
+		P_CUDA_DEFINE_FUNCTION(cuMemPoolTrimTo, mem_pool_t pool, std::size_t min_bytes_to_keep);
 
 		// Unified Addressing
 		// - Not yet needed.
@@ -271,7 +301,12 @@ namespace streamfx::nvidia::cuda {
 		P_CUDA_DEFINE_FUNCTION(cuStreamGetPriority, stream_t stream, int32_t* priority);
 
 		// Event Management
-		// - Not yet needed.
+		P_CUDA_DEFINE_FUNCTION(cuEventCreate, event_t* event, event_flags flags);
+		P_CUDA_DEFINE_FUNCTION(cuEventDestroy, event_t event);
+		P_CUDA_DEFINE_FUNCTION(cuEventElapsedTime, float* milliseconds, event_t start, event_t end);
+		P_CUDA_DEFINE_FUNCTION(cuEventQuery, event_t event);
+		P_CUDA_DEFINE_FUNCTION(cuEventRecord, event_t event, stream_t stream);
+		P_CUDA_DEFINE_FUNCTION(cuEventSynchronize, event_t event);
 
 		// External Resource Interoperability (CUDA 11.1+)
 		// - Not yet needed.
@@ -295,7 +330,8 @@ namespace streamfx::nvidia::cuda {
 		// - Not yet needed.
 
 		// Peer Context Memory Access
-		// - Not yet needed.
+		P_CUDA_DEFINE_FUNCTION(cuDeviceCanAccessPeer, int32_t* can_access, device_t device, device_t peer);
+		P_CUDA_DEFINE_FUNCTION(cuCtxEnablePeerAccess, context_t peer, uint32_t flags);
 
 		// Graphics Interoperability
 		P_CUDA_DEFINE_FUNCTION(cuGraphicsMapResources, uint32_t count, graphics_resource_t* resources, stream_t stream);
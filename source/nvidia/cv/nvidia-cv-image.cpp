@@ -7,9 +7,14 @@
 // - NVIDIA Augmented Reality SDK
 
 #include "nvidia-cv-image.hpp"
+#include "nvidia/cuda/nvidia-cuda-memory.hpp"
 #include "nvidia/cuda/nvidia-cuda-obs.hpp"
 #include "obs/gs/gs-helper.hpp"
 
+#include "warning-disable.hpp"
+#include <algorithm>
+#include "warning-enable.hpp"
+
 #ifdef _DEBUG
 #define ST_PREFIX "<%s> "
 #define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
@@ -27,26 +32,38 @@
 using ::streamfx::nvidia::cv::image;
 using ::streamfx::nvidia::cv::result;
 
+static void release_memory(void* pointer)
+{
+	delete reinterpret_cast<::streamfx::nvidia::cuda::memory*>(pointer);
+}
+
 image::~image()
 {
 	auto gctx = ::streamfx::obs::gs::context();
-	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
+	auto cctx = _context->enter();
 
 	_cv->NvCVImage_Dealloc(&_image);
 }
 
-image::image() : _cv(::streamfx::nvidia::cv::cv::get()), _image(), _alignment(1)
+image::image() : _cv(::streamfx::nvidia::cv::cv::get()), _context(::streamfx::nvidia::cuda::obs::get()->get_context()), _image(), _alignment(1)
 {
 	// Forcefully clear the image storage.
 	memset(&_image, sizeof(_image), 0);
 }
 
-image::image(uint32_t width, uint32_t height, pixel_format pix_fmt, component_type cmp_type, component_layout cmp_layout, memory_location location, uint32_t alignment) : image()
+image::image(uint32_t width, uint32_t height, pixel_format pix_fmt, component_type cmp_type, component_layout cmp_layout, memory_location location, uint32_t alignment) : image(::streamfx::nvidia::cuda::obs::get()->get_context(), width, height, pix_fmt, cmp_type, cmp_layout, location, alignment) {}
+
+image::image(std::shared_ptr<::streamfx::nvidia::cuda::context> context, uint32_t width, uint32_t height, pixel_format pix_fmt, component_type cmp_type, component_layout cmp_layout, memory_location location, uint32_t alignment) : image()
 {
+	_context = context;
+
 	auto gctx = ::streamfx::obs::gs::context();
-	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
+	auto cctx = _context->enter();
 
 	_alignment = alignment;
+	if (allocate_pooled(width, height, pix_fmt, cmp_type, cmp_layout, location, alignment)) {
+		return;
+	}
 	if (auto res = _cv->NvCVImage_Alloc(&_image, width, height, pix_fmt, cmp_type, static_cast<uint32_t>(cmp_layout), static_cast<uint32_t>(location), _alignment); res != result::SUCCESS) {
 		throw std::runtime_error(_cv->NvCV_GetErrorStringFromCode(res));
 	}
@@ -55,14 +72,63 @@ image::image(uint32_t width, uint32_t height, pixel_format pix_fmt, component_ty
 void streamfx::nvidia::cv::image::reallocate(uint32_t width, uint32_t height, pixel_format pix_fmt, component_type cmp_type, component_layout cmp_layout, memory_location location, uint32_t alignment)
 {
 	auto gctx = ::streamfx::obs::gs::context();
-	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
+	auto cctx = _context->enter();
 
+	if (allocate_pooled(width, height, pix_fmt, cmp_type, cmp_layout, location, alignment)) {
+		_alignment = alignment;
+		return;
+	}
 	if (auto res = _cv->NvCVImage_Realloc(&_image, width, height, pix_fmt, cmp_type, static_cast<uint32_t>(cmp_layout), static_cast<uint32_t>(location), alignment); res != result::SUCCESS) {
 		throw std::runtime_error(_cv->NvCV_GetErrorStringFromCode(res));
 	}
 	_alignment = alignment;
 }
 
+bool streamfx::nvidia::cv::image::allocate_pooled(uint32_t width, uint32_t height, pixel_format pix_fmt, component_type cmp_type, component_layout cmp_layout, memory_location location, uint32_t alignment)
+{
+	if ((location != memory_location::GPU) || ((cmp_layout != component_layout::INTERLEAVED) && (cmp_layout != component_layout::PLANAR))) {
+		return false;
+	}
+	if (_context != ::streamfx::nvidia::cuda::obs::get()->get_context()) { // The pool only serves the GPU OBS renders on.
+		return false;
+	}
+
+	// Let the SDK work out the size of a pixel, then lay the buffer out the same way NvCVImage_Alloc would.
+	image_t info = {};
+	if (auto res = _cv->NvCVImage_Init(&info, width, height, 0, nullptr, pix_fmt, cmp_type, cmp_layout, location); res != result::SUCCESS) {
+		return false;
+	}
+	bool planar = (cmp_layout == component_layout::PLANAR);
+	auto layout = [&info, planar, alignment](uint32_t w, uint32_t h, uint32_t& pitch) {
+		uint32_t align = std::max<uint32_t>(alignment, 1);
+		pitch          = (w * (planar ? info.component_bytes : info.pixel_bytes) + align - 1) / align * align;
+		return static_cast<std::size_t>(pitch) * h * (planar ? info.num_components : 1);
+	};
+	uint32_t    pitch = 0;
+	std::size_t bytes = layout(width, height, pitch);
+
+	// Keep the current buffer if the new image still fits.
+	::streamfx::nvidia::cuda::memory* buffer = nullptr;
+	if ((_image.delete_function == &release_memory) && (reinterpret_cast<::streamfx::nvidia::cuda::memory*>(_image.delete_pointer)->size() >= bytes)) {
+		buffer                 = reinterpret_cast<::streamfx::nvidia::cuda::memory*>(_image.delete_pointer);
+		_image.delete_function = nullptr;
+	} else {
+		uint32_t capacity_pitch = 0;
+		buffer                  = new ::streamfx::nvidia::cuda::memory(layout((width + capacity_step - 1) / capacity_step * capacity_step, (height + capacity_step - 1) / capacity_step * capacity_step, capacity_pitch));
+		_cv->NvCVImage_Dealloc(&_image);
+	}
+
+	if (auto res = _cv->NvCVImage_Init(&_image, width, height, pitch, reinterpret_cast<void*>(buffer->get()), pix_fmt, cmp_type, cmp_layout, location); res != result::SUCCESS) {
+		delete buffer;
+		_image = {};
+		throw std::runtime_error(_cv->NvCV_GetErrorStringFromCode(res));
+	}
+	_image.delete_pointer  = buffer;
+	_image.delete_function = &release_memory;
+	_image.buffer_bytes    = buffer->size();
+	return true;
+}
+
 void streamfx::nvidia::cv::image::resize(uint32_t width, uint32_t height)
 {
 	reallocate(width, height, _image.pxl_format, _image.comp_type, static_cast<component_layout>(_image.comp_layout), static_cast<memory_location>(_image.mem_location), _alignment);
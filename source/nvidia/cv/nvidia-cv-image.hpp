@@ -3,10 +3,12 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "nvidia/cuda/nvidia-cuda-context.hpp"
 #include "nvidia/cv/nvidia-cv.hpp"
 
 #include "warning-disable.hpp"
 #include <cinttypes>
+#include <memory>
 #include "warning-enable.hpp"
 
 namespace streamfx::nvidia::cv {
@@ -15,11 +17,15 @@ namespace streamfx::nvidia::cv {
 	using ::streamfx::nvidia::cv::memory_location;
 	using ::streamfx::nvidia::cv::pixel_format;
 
+	/** Images grow in steps of this many pixels, so that small changes in size reuse what is already allocated. */
+	static constexpr uint32_t capacity_step = 64;
+
 	class image {
 		protected:
-		std::shared_ptr<::streamfx::nvidia::cv::cv> _cv;
-		image_t                                     _image;
-		uint32_t                                    _alignment;
+		std::shared_ptr<::streamfx::nvidia::cv::cv>        _cv;
+		std::shared_ptr<::streamfx::nvidia::cuda::context> _context;
+		image_t                                            _image;
+		uint32_t                                           _alignment;
 
 		public:
 		virtual ~image();
@@ -30,11 +36,24 @@ namespace streamfx::nvidia::cv {
 		public:
 		image(uint32_t width, uint32_t height, pixel_format pix_fmt, component_type cmp_type, component_layout cmp_layout, memory_location location, uint32_t alignment);
 
+		/** Create the image in a different CUDA context than the one of the GPU OBS renders on. */
+		image(std::shared_ptr<::streamfx::nvidia::cuda::context> context, uint32_t width, uint32_t height, pixel_format pix_fmt, component_type cmp_type, component_layout cmp_layout, memory_location location, uint32_t alignment);
+
 		virtual void reallocate(uint32_t width, uint32_t height, pixel_format pix_fmt, component_type cmp_type, component_layout cmp_layout, memory_location location, uint32_t alignment);
 
 		virtual void resize(uint32_t width, uint32_t height);
 
 		virtual ::streamfx::nvidia::cv::image_t* get_image();
+
+		protected:
+		/** Place GPU images in memory from the StreamFX CUDA memory pool, instead of a fresh allocation each time.
+		 *
+		 * The memory is kept as long as the image still fits into it, and new memory has room for the size rounded up
+		 * to the next capacity step.
+		 *
+		 * @return false if the image can't be placed in pooled memory, and the SDK has to allocate it itself.
+		 */
+		bool allocate_pooled(uint32_t width, uint32_t height, pixel_format pix_fmt, component_type cmp_type, component_layout cmp_layout, memory_location location, uint32_t alignment);
 	};
 
 } // namespace streamfx::nvidia::cv
@@ -11,6 +11,10 @@
 #include "obs/gs/gs-helper.hpp"
 #include "util/util-logging.hpp"
 
+#include "warning-disable.hpp"
+#include <algorithm>
+#include "warning-enable.hpp"
+
 #ifdef _DEBUG
 #define ST_PREFIX "<%s> "
 #define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
@@ -30,6 +34,93 @@ using ::streamfx::nvidia::cv::component_type;
 using ::streamfx::nvidia::cv::pixel_format;
 using ::streamfx::nvidia::cv::result;
 using ::streamfx::nvidia::cv::texture;
+using ::streamfx::nvidia::cv::texture_pool;
+
+// Textures that stay unused for longer than this are unregistered and destroyed.
+#define ST_POOL_TIMEOUT std::chrono::seconds(10)
+
+texture_pool::~texture_pool()
+{
+	auto gctx = ::streamfx::obs::gs::context();
+	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
+
+	for (auto& kv : _entries) {
+		destroy(kv.second);
+	}
+	_entries.clear();
+}
+
+texture_pool::texture_pool() : _cv(::streamfx::nvidia::cv::cv::get()), _lock(), _entries() {}
+
+bool texture_pool::acquire(uint32_t width, uint32_t height, gs_color_format format, ::streamfx::obs::gs::texture::flags flags, std::shared_ptr<::streamfx::obs::gs::texture>& texture, image_t& image)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	collect_garbage();
+
+	auto kv = _entries.find(key_t{width, height, format, flags});
+	if (kv == _entries.end()) {
+		return false;
+	}
+
+	texture = kv->second.texture;
+	image   = kv->second.image;
+	_entries.erase(kv);
+	return true;
+}
+
+void texture_pool::release(std::shared_ptr<::streamfx::obs::gs::texture> texture, ::streamfx::obs::gs::texture::flags flags, image_t& image)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+
+	entry el;
+	el.texture  = texture;
+	el.image    = image;
+	el.released = std::chrono::steady_clock::now();
+	_entries.emplace(key_t{texture->get_width(), texture->get_height(), texture->get_color_format(), flags}, el);
+	image = {};
+
+	collect_garbage();
+}
+
+void texture_pool::collect_garbage()
+{
+	auto now = std::chrono::steady_clock::now();
+	for (auto kv = _entries.begin(); kv != _entries.end();) {
+		if ((now - kv->second.released) > ST_POOL_TIMEOUT) {
+			destroy(kv->second);
+			kv = _entries.erase(kv);
+		} else {
+			++kv;
+		}
+	}
+}
+
+void texture_pool::destroy(entry& el)
+{
+	auto gctx  = ::streamfx::obs::gs::context();
+	auto cctx  = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
+	auto nvobs = ::streamfx::nvidia::cuda::obs::get();
+
+	if (auto res = _cv->NvCVImage_UnmapResource(&el.image, nvobs->get_stream()->get()); res != result::SUCCESS) {
+		D_LOG_ERROR("Failed NvCVImage_UnmapResource call with error: %s", _cv->NvCV_GetErrorStringFromCode(res));
+	}
+	_cv->NvCVImage_Dealloc(&el.image);
+	el.texture.reset();
+}
+
+std::shared_ptr<texture_pool> texture_pool::get()
+{
+	static std::weak_ptr<texture_pool> instance;
+	static std::mutex                  lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (instance.expired()) {
+		auto hard_instance = std::shared_ptr<texture_pool>(new texture_pool());
+		instance           = hard_instance;
+		return hard_instance;
+	}
+	return instance.lock();
+}
 
 texture::~texture()
 {
@@ -37,17 +128,14 @@ texture::~texture()
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
 	free();
-	_texture.reset();
 }
 
-texture::texture(uint32_t width, uint32_t height, gs_color_format pix_fmt)
+texture::texture(uint32_t width, uint32_t height, gs_color_format pix_fmt, ::streamfx::obs::gs::texture::flags flags, bool capacity) : _pool(texture_pool::get()), _flags(flags), _capacity(capacity), _largest(), _view()
 {
 	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
-	// Allocate a new Texture
-	_texture = std::make_shared<::streamfx::obs::gs::texture>(width, height, pix_fmt, 1, nullptr, ::streamfx::obs::gs::texture::flags::None);
-	alloc();
+	alloc(width, height, pix_fmt);
 }
 
 void texture::resize(uint32_t width, uint32_t height)
@@ -55,12 +143,23 @@ void texture::resize(uint32_t width, uint32_t height)
 	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
+	// Keep using the texture while the new size still fits into it.
+	if (_capacity && (width <= _texture->get_width()) && (height <= _texture->get_height())) {
+		update_view(width, height);
+		return;
+	}
+
 	D_LOG_DEBUG("Resizing object 0x%" PRIxPTR " to %" PRIu32 "x%" PRIu32 "...", this, width, height);
 
-	// Allocate a new Texture
+	// Swap for a texture of the new size.
+	auto pix_fmt = _texture->get_color_format();
 	free();
-	_texture = std::make_shared<::streamfx::obs::gs::texture>(width, height, _texture->get_color_format(), 1, nullptr, ::streamfx::obs::gs::texture::flags::None);
-	alloc();
+	alloc(width, height, pix_fmt);
+}
+
+streamfx::nvidia::cv::image_t* texture::get_image()
+{
+	return &_view;
 }
 
 std::shared_ptr<::streamfx::obs::gs::texture> texture::get_texture()
@@ -68,13 +167,30 @@ std::shared_ptr<::streamfx::obs::gs::texture> texture::get_texture()
 	return _texture;
 }
 
-void streamfx::nvidia::cv::texture::alloc()
+void streamfx::nvidia::cv::texture::alloc(uint32_t width, uint32_t height, gs_color_format pix_fmt)
 {
 	auto gctx  = ::streamfx::obs::gs::context();
 	auto cctx  = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 	auto nvobs = ::streamfx::nvidia::cuda::obs::get();
 
-	// Allocate any relevant CV buffers and Map it.
+	// Grow to the largest size seen so far, rounded up to the next capacity step. This also gives the pool more
+	// chances to have a matching texture.
+	uint32_t texture_width  = width;
+	uint32_t texture_height = height;
+	if (_capacity) {
+		_largest       = {std::max(_largest.first, width), std::max(_largest.second, height)};
+		texture_width  = (_largest.first + capacity_step - 1) / capacity_step * capacity_step;
+		texture_height = (_largest.second + capacity_step - 1) / capacity_step * capacity_step;
+	}
+
+	// Reuse an already registered texture if possible.
+	if (_pool->acquire(texture_width, texture_height, pix_fmt, _flags, _texture, _image)) {
+		update_view(width, height);
+		return;
+	}
+
+	// Allocate a new Texture, then allocate any relevant CV buffers and Map it.
+	_texture = std::make_shared<::streamfx::obs::gs::texture>(texture_width, texture_height, pix_fmt, 1, nullptr, _flags);
 	if (auto res = _cv->NvCVImage_InitFromD3D11Texture(&_image, reinterpret_cast<ID3D11Texture2D*>(gs_texture_get_obj(_texture->get_object()))); res != result::SUCCESS) {
 		D_LOG_ERROR("Object 0x%" PRIxPTR " failed NvCVImage_InitFromD3D11Texture call with error: %s", this, _cv->NvCV_GetErrorStringFromCode(res));
 		throw std::runtime_error("NvCVImage_InitFromD3D11Texture");
@@ -83,18 +199,34 @@ void streamfx::nvidia::cv::texture::alloc()
 		D_LOG_ERROR("Object 0x%" PRIxPTR " failed NvCVImage_MapResource call with error: %s", this, _cv->NvCV_GetErrorStringFromCode(res));
 		throw std::runtime_error("NvCVImage_MapResource");
 	}
+
+	// Users work on their own streams, which are not ordered against the mapping.
+	nvobs->get_stream()->synchronize();
+
+	update_view(width, height);
 }
 
 void streamfx::nvidia::cv::texture::free()
 {
-	auto gctx  = ::streamfx::obs::gs::context();
-	auto cctx  = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
-	auto nvobs = ::streamfx::nvidia::cuda::obs::get();
+	if (!_texture) {
+		return;
+	}
+
+	// Hand the still registered texture to the pool, which unmaps it once nobody wants it anymore.
+	_pool->release(_texture, _flags, _image);
+	_texture.reset();
+	_view = {};
+}
+
+void streamfx::nvidia::cv::texture::update_view(uint32_t width, uint32_t height)
+{
+	if ((width == _image.width) && (height == _image.height)) {
+		_view = _image;
+		return;
+	}
 
-	// Unmap and deallocate any relevant CV buffers.
-	if (auto res = _cv->NvCVImage_UnmapResource(&_image, nvobs->get_stream()->get()); res != result::SUCCESS) {
-		D_LOG_ERROR("Object 0x%" PRIxPTR " failed NvCVImage_UnmapResource call with error: %s", this, _cv->NvCV_GetErrorStringFromCode(res));
-		throw std::runtime_error("NvCVImage_UnmapResource");
+	if (auto res = _cv->NvCVImage_InitView(&_view, &_image, 0, 0, width, height); res != result::SUCCESS) {
+		D_LOG_ERROR("Object 0x%" PRIxPTR " failed NvCVImage_InitView call with error: %s", this, _cv->NvCV_GetErrorStringFromCode(res));
+		throw std::runtime_error("NvCVImage_InitView");
 	}
-	_cv->NvCVImage_Dealloc(&_image);
 }
@@ -7,7 +7,13 @@
 #include "obs/gs/gs-texture.hpp"
 
 #include "warning-disable.hpp"
+#include <chrono>
 #include <cinttypes>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
 #include "warning-enable.hpp"
 
 namespace streamfx::nvidia::cv {
@@ -17,20 +23,75 @@ namespace streamfx::nvidia::cv {
 	using ::streamfx::nvidia::cv::memory_location;
 	using ::streamfx::nvidia::cv::pixel_format;
 
+	/** Textures that are no longer in use, but still registered with and mapped for CUDA.
+	 *
+	 * Registering a texture is expensive, so textures are kept around for a while after they have been released, for
+	 * any NVIDIA effect that requests the same size and format.
+	 */
+	class texture_pool {
+		typedef std::tuple<uint32_t, uint32_t, gs_color_format, ::streamfx::obs::gs::texture::flags> key_t;
+
+		struct entry {
+			std::shared_ptr<::streamfx::obs::gs::texture> texture;
+			image_t                                       image;
+			std::chrono::steady_clock::time_point         released;
+		};
+
+		std::shared_ptr<::streamfx::nvidia::cv::cv> _cv;
+		std::mutex                                  _lock;
+		std::multimap<key_t, entry>                 _entries;
+
+		public:
+		~texture_pool();
+
+		private:
+		texture_pool();
+
+		public:
+		/** Take a registered texture out of the pool. Returns false if there is none. */
+		bool acquire(uint32_t width, uint32_t height, gs_color_format format, ::streamfx::obs::gs::texture::flags flags, std::shared_ptr<::streamfx::obs::gs::texture>& texture, image_t& image);
+
+		/** Return a registered texture to the pool, which takes ownership of the image. */
+		void release(std::shared_ptr<::streamfx::obs::gs::texture> texture, ::streamfx::obs::gs::texture::flags flags, image_t& image);
+
+		private:
+		void collect_garbage();
+
+		void destroy(entry& el);
+
+		public:
+		static std::shared_ptr<::streamfx::nvidia::cv::texture_pool> get();
+	};
+
 	class texture : public image {
-		std::shared_ptr<::streamfx::obs::gs::texture> _texture;
+		std::shared_ptr<::streamfx::nvidia::cv::texture_pool> _pool;
+		std::shared_ptr<::streamfx::obs::gs::texture>         _texture;
+		::streamfx::obs::gs::texture::flags                   _flags;
+		bool                                                  _capacity;
+		std::pair<uint32_t, uint32_t>                         _largest;
+		image_t                                               _view;
 
 		public:
 		~texture() override;
-		texture(uint32_t width, uint32_t height, gs_color_format pix_fmt);
+
+		/** @param flags Use RenderTarget to draw into the texture directly, instead of copying into it.
+		 * @param capacity Grow the texture in capacity steps and only use the top left of it, so that a change in size
+		 *                 rarely needs a new texture registered with CUDA. Only for textures that are copied into, as
+		 *                 anything sampling the whole texture would see the unused part.
+		 */
+		texture(uint32_t width, uint32_t height, gs_color_format pix_fmt, ::streamfx::obs::gs::texture::flags flags = ::streamfx::obs::gs::texture::flags::None, bool capacity = false);
 
 		void resize(uint32_t width, uint32_t height) override;
 
+		/** Image of the used part of the texture. */
+		::streamfx::nvidia::cv::image_t* get_image() override;
+
 		std::shared_ptr<::streamfx::obs::gs::texture> get_texture();
 
 		private:
-		void alloc();
+		void alloc(uint32_t width, uint32_t height, gs_color_format pix_fmt);
 		void free();
+		void update_view(uint32_t width, uint32_t height);
 	};
 
 } // namespace streamfx::nvidia::cv
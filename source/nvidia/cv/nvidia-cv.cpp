@@ -9,6 +9,7 @@
 #include "nvidia-cv.hpp"
 #include "nvidia/cuda/nvidia-cuda-obs.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
 #include "util/util-logging.hpp"
 #include "util/util-platform.hpp"
 
@@ -222,6 +223,8 @@ streamfx::nvidia::cv::cv::cv()
 	}
 }
 
+static std::shared_ptr<streamfx::nvidia::cv::cv> loader_instance;
+
 std::shared_ptr<streamfx::nvidia::cv::cv> streamfx::nvidia::cv::cv::get()
 {
 	static std::weak_ptr<streamfx::nvidia::cv::cv> instance;
@@ -231,7 +234,17 @@ std::shared_ptr<streamfx::nvidia::cv::cv> streamfx::nvidia::cv::cv::get()
 	if (instance.expired()) {
 		auto hard_instance = std::make_shared<streamfx::nvidia::cv::cv>();
 		instance           = hard_instance;
+		loader_instance    = hard_instance; // Stay loaded until the plugin unloads.
 		return hard_instance;
 	}
 	return instance.lock();
 }
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		// Loaded on first use, so that nothing is paid for it unless an NVIDIA feature is used.
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::HIGH);
@@ -0,0 +1,224 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "nvidia-warmup.hpp"
+#include "configuration.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-texture.hpp"
+#include "obs/obs-tools.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+
+#ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
+#include "nvidia/ar/nvidia-ar-facedetection.hpp"
+#endif
+#ifdef ENABLE_FILTER_DENOISING_NVIDIA
+#include "nvidia/vfx/nvidia-vfx-denoising.hpp"
+#endif
+#ifdef ENABLE_FILTER_UPSCALING_NVIDIA
+#include "nvidia/vfx/nvidia-vfx-superresolution.hpp"
+#endif
+#ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
+#include "nvidia/vfx/nvidia-vfx-greenscreen.hpp"
+#endif
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <chrono>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<nvidia::warmup> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_CFG_WARMUP "NVIDIA.Warmup"
+#define ST_CFG_WARMUP_WIDTH "Width"
+#define ST_CFG_WARMUP_HEIGHT "Height"
+#define ST_CFG_WARMUP_DENOISING "Denoising"
+#define ST_CFG_WARMUP_SUPERRESOLUTION "SuperResolution"
+#define ST_CFG_WARMUP_GREENSCREEN "Greenscreen"
+#define ST_CFG_WARMUP_FACEDETECTION "FaceDetection"
+
+struct warmup_data_t {
+	uint32_t width;
+	uint32_t height;
+	bool     denoising;
+	bool     superresolution;
+	bool     greenscreen;
+	bool     facedetection;
+};
+
+template<typename T>
+static std::shared_ptr<T> warm(const char* name, uint32_t width, uint32_t height, void (*fn)(std::shared_ptr<T>, uint32_t, uint32_t))
+{
+	try {
+		auto start    = std::chrono::high_resolution_clock::now();
+		auto instance = std::make_shared<T>();
+		fn(instance, width, height);
+		auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+		D_LOG_INFO("Loaded '%s' at %" PRIu32 "x%" PRIu32 " in %" PRIu64 " ms.", name, width, height, static_cast<uint64_t>(time.count()));
+		return instance;
+	} catch (const std::exception& ex) {
+		D_LOG_WARNING("Failed to load '%s': %s", name, ex.what());
+	} catch (...) {
+		D_LOG_WARNING("Failed to load '%s'.", name);
+	}
+	return nullptr;
+}
+
+static inline std::shared_ptr<::streamfx::obs::gs::texture> warm_texture(uint32_t width, uint32_t height)
+{
+	auto gctx = ::streamfx::obs::gs::context();
+	return std::make_shared<::streamfx::obs::gs::texture>(width, height, GS_RGBA_UNORM, 1, nullptr, ::streamfx::obs::gs::texture::flags::None);
+}
+
+// Processing a blank frame once resizes the effect to the resolution and loads the model for it.
+#ifdef ENABLE_FILTER_DENOISING_NVIDIA
+static void warm_denoising(std::shared_ptr<::streamfx::nvidia::vfx::denoising> fx, uint32_t width, uint32_t height)
+{
+	std::pair<uint32_t, uint32_t> size{width, height};
+	fx->size(size);
+	fx->process(warm_texture(size.first, size.second));
+}
+#endif
+
+#ifdef ENABLE_FILTER_UPSCALING_NVIDIA
+static void warm_superresolution(std::shared_ptr<::streamfx::nvidia::vfx::superresolution> fx, uint32_t width, uint32_t height)
+{
+	std::pair<uint32_t, uint32_t> in_size;
+	std::pair<uint32_t, uint32_t> out_size;
+	fx->size({width, height}, in_size, out_size);
+	fx->process(warm_texture(in_size.first, in_size.second));
+}
+#endif
+
+#ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
+static void warm_greenscreen(std::shared_ptr<::streamfx::nvidia::vfx::greenscreen> fx, uint32_t width, uint32_t height)
+{
+	std::pair<uint32_t, uint32_t> size{width, height};
+	fx->size(size);
+	fx->process(warm_texture(size.first, size.second));
+}
+#endif
+
+#ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
+static void warm_facedetection(std::shared_ptr<::streamfx::nvidia::ar::facedetection> fx, uint32_t width, uint32_t height)
+{
+	fx->process(warm_texture(width, height));
+}
+#endif
+
+streamfx::nvidia::warmup::~warmup()
+{
+	if (_task) {
+		streamfx::threadpool()->pop(_task);
+		_task->await_completion();
+		_task.reset();
+	}
+}
+
+streamfx::nvidia::warmup::warmup() : _lock(), _ready(), _task()
+{
+	auto                        config = streamfx::configuration::instance();
+	auto                        data   = config->get();
+	std::shared_ptr<obs_data_t> cfg(obs_data_get_obj(data.get(), ST_CFG_WARMUP), streamfx::obs::obs_data_deleter);
+	if (!cfg) {
+		return;
+	}
+	obs_data_set_default_int(cfg.get(), ST_CFG_WARMUP_WIDTH, 1920);
+	obs_data_set_default_int(cfg.get(), ST_CFG_WARMUP_HEIGHT, 1080);
+
+	auto wd             = std::make_shared<warmup_data_t>();
+	wd->width           = static_cast<uint32_t>(std::max<int64_t>(obs_data_get_int(cfg.get(), ST_CFG_WARMUP_WIDTH), 1));
+	wd->height          = static_cast<uint32_t>(std::max<int64_t>(obs_data_get_int(cfg.get(), ST_CFG_WARMUP_HEIGHT), 1));
+	wd->denoising       = obs_data_get_bool(cfg.get(), ST_CFG_WARMUP_DENOISING);
+	wd->superresolution = obs_data_get_bool(cfg.get(), ST_CFG_WARMUP_SUPERRESOLUTION);
+	wd->greenscreen     = obs_data_get_bool(cfg.get(), ST_CFG_WARMUP_GREENSCREEN);
+	wd->facedetection   = obs_data_get_bool(cfg.get(), ST_CFG_WARMUP_FACEDETECTION);
+	if (!wd->denoising && !wd->superresolution && !wd->greenscreen && !wd->facedetection) {
+		return;
+	}
+
+	_task = streamfx::threadpool()->push(std::bind(&warmup::task, this, std::placeholders::_1), wd, ::streamfx::util::threadpool::priority::BACKGROUND);
+}
+
+void streamfx::nvidia::warmup::task(::streamfx::util::threadpool::task_data_t data)
+{
+	auto wd    = std::static_pointer_cast<warmup_data_t>(data);
+	auto start = std::chrono::high_resolution_clock::now();
+
+#ifdef ENABLE_FILTER_DENOISING_NVIDIA
+	if (wd->denoising) {
+		if (auto fx = warm<::streamfx::nvidia::vfx::denoising>("Denoising", wd->width, wd->height, warm_denoising); fx) {
+			store(fx);
+		}
+	}
+#endif
+
+#ifdef ENABLE_FILTER_UPSCALING_NVIDIA
+	if (wd->superresolution) {
+		if (auto fx = warm<::streamfx::nvidia::vfx::superresolution>("SuperResolution", wd->width, wd->height, warm_superresolution); fx) {
+			store(fx);
+		}
+	}
+#endif
+
+#ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
+	if (wd->greenscreen) {
+		if (auto fx = warm<::streamfx::nvidia::vfx::greenscreen>("Greenscreen", wd->width, wd->height, warm_greenscreen); fx) {
+			store(fx);
+		}
+	}
+#endif
+
+#ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
+	if (wd->facedetection) {
+		if (auto fx = warm<::streamfx::nvidia::ar::facedetection>("FaceDetection", wd->width, wd->height, warm_facedetection); fx) {
+			store(fx);
+		}
+	}
+#endif
+
+	auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+	D_LOG_INFO("Finished loading effects in %" PRIu64 " ms.", static_cast<uint64_t>(time.count()));
+}
+
+std::shared_ptr<streamfx::nvidia::warmup> streamfx::nvidia::warmup::get()
+{
+	static std::weak_ptr<streamfx::nvidia::warmup> winst;
+	static std::mutex                              mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::nvidia::warmup>(new streamfx::nvidia::warmup());
+		winst    = instance;
+	}
+	return instance;
+}
+
+static std::shared_ptr<streamfx::nvidia::warmup> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		try {
+			loader_instance = streamfx::nvidia::warmup::get();
+		} catch (const std::exception& ex) {
+			D_LOG_WARNING("Failed to start loading effects: %s", ex.what());
+		}
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::LOWEST); // Load after everything else is ready.
@@ -0,0 +1,141 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+#include "util/util-threadpool.hpp"
+
+#include "warning-disable.hpp"
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include "warning-enable.hpp"
+
+namespace streamfx::nvidia {
+	/** Loads NVIDIA effects ahead of time, so that the first filter to use one doesn't stall.
+	 *
+	 * Loading a model and building its engines takes several seconds, most of which is spent the first time an effect
+	 * is loaded at a resolution. The configured effects are loaded at the configured resolution in the thread pool at
+	 * plugin start, and then handed to the first filter that asks for one through take().
+	 *
+	 * Configured in the "NVIDIA.Warmup" object of the global configuration:
+	 * - "Width", "Height": Resolution to load at, 1920x1080 by default.
+	 * - "Denoising", "SuperResolution", "Greenscreen", "FaceDetection": Whether to load the effect, off by default.
+	 */
+	class warmup {
+		std::mutex                                                  _lock;
+		std::map<std::type_index, std::list<std::shared_ptr<void>>> _ready;
+		std::shared_ptr<::streamfx::util::threadpool::task>         _task;
+
+		public:
+		~warmup();
+
+		private:
+		warmup();
+
+		void task(::streamfx::util::threadpool::task_data_t data);
+
+		template<typename T>
+		void store(std::shared_ptr<T> instance)
+		{
+			std::unique_lock<std::mutex> ul(_lock);
+			_ready[std::type_index(typeid(T))].push_back(instance);
+		}
+
+		public:
+		/** Take a loaded instance if there is one, or create a new one otherwise. */
+		template<typename T>
+		std::shared_ptr<T> take()
+		{
+			{
+				std::unique_lock<std::mutex> ul(_lock);
+				if (auto kv = _ready.find(std::type_index(typeid(T))); (kv != _ready.end()) && !kv->second.empty()) {
+					auto instance = std::static_pointer_cast<T>(kv->second.front());
+					kv->second.pop_front();
+					return instance;
+				}
+			}
+			return std::make_shared<T>();
+		}
+
+		public:
+		static std::shared_ptr<::streamfx::nvidia::warmup> get();
+	};
+
+	/** Loads a replacement for an effect in the thread pool, for changes that need the model to be loaded again.
+	 *
+	 * The current instance keeps running until the replacement is ready, so that changing a setting doesn't stall
+	 * rendering for however long loading takes. Only the replacement for the newest request is kept, and nothing in
+	 * the thread pool refers to the owner, so it can go away at any time.
+	 */
+	template<typename T>
+	class replacement {
+		struct state {
+			std::mutex         lock;
+			uint64_t           requested = 0;
+			std::shared_ptr<T> ready;
+		};
+
+		std::shared_ptr<state> _state;
+
+		public:
+		replacement() : _state(std::make_shared<state>()) {}
+
+		/** Create a new instance in the thread pool, and let configure set it up and load it there. */
+		void request(std::function<void(std::shared_ptr<T>)> configure)
+		{
+			uint64_t id = 0;
+			{
+				std::unique_lock<std::mutex> ul(_state->lock);
+				id = ++_state->requested;
+				_state->ready.reset();
+			}
+
+			streamfx::threadpool()->push(
+				[state = _state, id, configure](::streamfx::util::threadpool::task_data_t) {
+					{ // Skip requests which were outdated before they even started.
+						std::unique_lock<std::mutex> ul(state->lock);
+						if (state->requested != id) {
+							return;
+						}
+					}
+
+					try {
+						auto instance = std::make_shared<T>();
+						configure(instance);
+
+						std::unique_lock<std::mutex> ul(state->lock);
+						if (state->requested == id) {
+							state->ready = std::move(instance);
+						}
+					} catch (const std::exception& ex) {
+						P_LOG_WARN("<nvidia::replacement> Failed to load replacement, keeping the current instance: %s", ex.what());
+					} catch (...) {
+						P_LOG_WARN("<nvidia::replacement> Failed to load replacement, keeping the current instance.");
+					}
+				},
+				nullptr, ::streamfx::util::threadpool::priority::BACKGROUND);
+		}
+
+		/** Drop the pending request, if any. */
+		void cancel()
+		{
+			std::unique_lock<std::mutex> ul(_state->lock);
+			++_state->requested;
+			_state->ready.reset();
+		}
+
+		/** The replacement if it is ready, which is then no longer held here. */
+		std::shared_ptr<T> take()
+		{
+			std::unique_lock<std::mutex> ul(_state->lock);
+			return std::move(_state->ready);
+		}
+	};
+} // namespace streamfx::nvidia
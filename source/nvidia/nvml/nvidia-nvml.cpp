@@ -0,0 +1,100 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "nvidia-nvml.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<nvidia::nvml> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#if defined(_WIN32) || defined(_WIN64)
+#define ST_NVML_NAME "nvml.dll"
+#else
+#define ST_NVML_NAME "libnvidia-ml.so.1"
+#endif
+
+#define P_NVML_LOAD_SYMBOL(NAME)                                                             \
+	{                                                                                        \
+		NAME = reinterpret_cast<decltype(NAME)>(_library->load_symbol(#NAME));               \
+		if (!NAME)                                                                           \
+			throw std::runtime_error("Failed to load '" #NAME "' from '" ST_NVML_NAME "'."); \
+	}
+
+streamfx::nvidia::nvml::nvml::~nvml()
+{
+	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+
+	nvmlShutdown();
+}
+
+streamfx::nvidia::nvml::nvml::nvml() : _library()
+{
+	D_LOG_DEBUG("Initializing... (Addr: 0x%" PRIuPTR ")", this);
+
+	_library = streamfx::util::library::load(std::string_view(ST_NVML_NAME));
+
+	P_NVML_LOAD_SYMBOL(nvmlInit_v2);
+	P_NVML_LOAD_SYMBOL(nvmlShutdown);
+	P_NVML_LOAD_SYMBOL(nvmlDeviceGetHandleByUUID);
+	P_NVML_LOAD_SYMBOL(nvmlDeviceGetEncoderUtilization);
+	P_NVML_LOAD_SYMBOL(nvmlDeviceGetEncoderStats);
+
+	if (auto res = nvmlInit_v2(); res != result::SUCCESS) {
+		throw std::runtime_error("Failed to initialize NVML.");
+	}
+}
+
+bool streamfx::nvidia::nvml::nvml::get_encoder_load(const ::streamfx::nvidia::cuda::uuid_t& uuid, encoder_load& load)
+{
+	// NVML spells UUIDs out the way nvidia-smi shows them.
+	auto b = reinterpret_cast<const uint8_t*>(uuid.bytes);
+	char name[48];
+	snprintf(name, sizeof(name), "GPU-%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x", b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7], b[8], b[9], b[10], b[11], b[12], b[13], b[14], b[15]);
+
+	device_t device = nullptr;
+	if (nvmlDeviceGetHandleByUUID(name, &device) != result::SUCCESS) {
+		return false;
+	}
+
+	uint32_t period  = 0;
+	uint32_t latency = 0;
+	if (nvmlDeviceGetEncoderUtilization(device, &load.utilization, &period) != result::SUCCESS) {
+		return false;
+	}
+	if (nvmlDeviceGetEncoderStats(device, &load.sessions, &load.average_fps, &latency) != result::SUCCESS) {
+		return false;
+	}
+	return true;
+}
+
+std::shared_ptr<streamfx::nvidia::nvml::nvml> streamfx::nvidia::nvml::nvml::get()
+{
+	static std::weak_ptr<streamfx::nvidia::nvml::nvml> instance;
+	static std::mutex                                  lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (instance.expired()) {
+		auto hard_instance = std::make_shared<streamfx::nvidia::nvml::nvml>();
+		instance           = hard_instance;
+		return hard_instance;
+	}
+	return instance.lock();
+}
@@ -0,0 +1,67 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "nvidia/cuda/nvidia-cuda.hpp"
+#include "util/util-library.hpp"
+
+#include "warning-disable.hpp"
+#include <cinttypes>
+#include <memory>
+#include "warning-enable.hpp"
+
+#define P_NVML_DEFINE_FUNCTION(name, ...)                             \
+	private:                                                          \
+	typedef ::streamfx::nvidia::nvml::result (*t##name)(__VA_ARGS__); \
+                                                                      \
+	public:                                                           \
+	t##name name = nullptr;
+
+namespace streamfx::nvidia::nvml {
+	enum class result : int32_t {
+		SUCCESS            = 0,
+		UNINITIALIZED      = 1,
+		INVALID_ARGUMENT   = 2,
+		NOT_SUPPORTED      = 3,
+		NO_PERMISSION      = 4,
+		NOT_FOUND          = 6,
+		FUNCTION_NOT_FOUND = 13,
+		GPU_IS_LOST        = 15,
+		UNKNOWN            = 999,
+	};
+
+	typedef struct device* device_t;
+
+	/** Encoder load of a GPU, as sampled by the driver. */
+	struct encoder_load {
+		uint32_t utilization; // Percentage of time the NVENC engines were busy during the last sampling period.
+		uint32_t sessions;    // Active encoding sessions, across all processes.
+		uint32_t average_fps; // Average frames per second across all sessions.
+	};
+
+	/** NVIDIA Management Library, which reports what the GPU is busy with.
+	 *
+	 * Driver installations without it are fine, everything that uses it is optional.
+	 */
+	class nvml {
+		std::shared_ptr<streamfx::util::library> _library;
+
+		public:
+		~nvml();
+		nvml();
+
+		/** Load of the GPU that CUDA knows by this UUID. Returns false if NVML can't tell. */
+		bool get_encoder_load(const ::streamfx::nvidia::cuda::uuid_t& uuid, encoder_load& load);
+
+		public:
+		P_NVML_DEFINE_FUNCTION(nvmlInit_v2);
+		P_NVML_DEFINE_FUNCTION(nvmlShutdown);
+		P_NVML_DEFINE_FUNCTION(nvmlDeviceGetHandleByUUID, const char* uuid, device_t* device);
+		P_NVML_DEFINE_FUNCTION(nvmlDeviceGetEncoderUtilization, device_t device, uint32_t* utilization, uint32_t* sampling_period_us);
+		P_NVML_DEFINE_FUNCTION(nvmlDeviceGetEncoderStats, device_t device, uint32_t* session_count, uint32_t* average_fps, uint32_t* average_latency);
+
+		public:
+		static std::shared_ptr<::streamfx::nvidia::nvml::nvml> get();
+	};
+} // namespace streamfx::nvidia::nvml
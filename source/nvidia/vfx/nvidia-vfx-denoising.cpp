@@ -9,6 +9,7 @@
 
 #include "warning-disable.hpp"
 #include <cmath>
+#include <string>
 #include <utility>
 #include "warning-enable.hpp"
 
@@ -31,8 +32,11 @@ streamfx::nvidia::vfx::denoising::~denoising()
 	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
-	// Clean up state buffer.
-	_nvcuda->get_cuda()->cuMemFree(_state);
+	// Clean up state buffer, which lives on the GPU the effect runs on.
+	{
+		auto cctx2 = _compute->enter();
+		_nvcuda->get_cuda()->cuMemFree(_state);
+	}
 
 	// Clean up any CUDA resources in use.
 	_input.reset();
@@ -44,10 +48,9 @@ streamfx::nvidia::vfx::denoising::~denoising()
 	_tmp.reset();
 }
 
-streamfx::nvidia::vfx::denoising::denoising() : effect(EFFECT_DENOISING), _dirty(true), _input(), _convert_to_fp32(), _source(), _destination(), _convert_to_u8(), _output(), _tmp(), _state(0), _state_size(0), _strength(1.)
+streamfx::nvidia::vfx::denoising::denoising() : effect(EFFECT_DENOISING), _dirty(true), _input(), _convert_to_fp32(), _source(), _destination(), _convert_to_u8(), _output(), _tmp(), _direct_in(true), _direct_out(true), _state(0), _state_size(0), _strength(1.)
 {
-	// Enter Graphics and CUDA context.
-	auto gctx = ::streamfx::obs::gs::context();
+	// Only enter the CUDA context, loading can take a while and doesn't need the graphics context.
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
 	// Set the strength, scale and buffers.
@@ -62,16 +65,10 @@ void streamfx::nvidia::vfx::denoising::set_strength(float strength)
 {
 	std::swap(_strength, strength);
 
-	// If anything was changed, flag the effect as dirty.
+	// If anything was changed, flag the effect as dirty. The effect itself is only updated by load(), as it may be
+	// shared with other instances until then.
 	if (!::streamfx::util::math::is_close<float>(_strength, strength, 0.01f))
 		_dirty = true;
-
-	// Update Effect
-	auto gctx = ::streamfx::obs::gs::context();
-	auto cctx = _nvcuda->get_context()->enter();
-	if (auto res = set(PARAMETER_STRENGTH, _strength); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-		D_LOG_ERROR("Failed to set '%s' to %1.3f.", PARAMETER_STRENGTH, _strength);
-	};
 }
 
 float streamfx::nvidia::vfx::denoising::strength()
@@ -105,11 +102,62 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::nvidia::vfx::denoising::
 	// Enter Graphics and CUDA context.
 	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = _nvcuda->get_context()->enter();
+	_timer->begin();
 
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_magenta, "NvVFX Denoising"};
 #endif
 
+	run_effect(in);
+
+	{ // Convert Destination to Output format
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Convert Destination -> Output"};
+#endif
+		if (_direct_out) {
+			if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _output->get_image(), 255.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+				D_LOG_WARNING("Converting destination to output in a single transfer failed, falling back to two transfers: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+				_direct_out = false;
+				resize(in->get_width(), in->get_height());
+			}
+		}
+		if (!_direct_out) {
+			if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _convert_to_u8->get_image(), 255.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+				D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+				throw std::runtime_error("Transfer failed.");
+			}
+			if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_u8->get_image(), _output->get_image(), 1., _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+				D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+				throw std::runtime_error("Transfer failed.");
+			}
+		}
+	}
+
+	// Return output.
+	_timer->end();
+	return _output->get_texture();
+}
+
+std::shared_ptr<::streamfx::nvidia::cv::image> streamfx::nvidia::vfx::denoising::process_image(std::shared_ptr<::streamfx::obs::gs::texture> in)
+{
+	// Enter Graphics and CUDA context.
+	auto gctx = ::streamfx::obs::gs::context();
+	auto cctx = _nvcuda->get_context()->enter();
+	_timer->begin();
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_magenta, "NvVFX Denoising"};
+#endif
+
+	run_effect(in);
+
+	// Return destination, without converting it.
+	_timer->end();
+	return _destination;
+}
+
+void streamfx::nvidia::vfx::denoising::run_effect(std::shared_ptr<::streamfx::obs::gs::texture> in)
+{
 	// Resize if the size or scale was changed.
 	resize(in->get_width(), in->get_height());
 
@@ -122,26 +170,29 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::nvidia::vfx::denoising::
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy In -> Input"};
 #endif
-		gs_copy_texture(_input->get_texture()->get_object(), in->get_object());
+		gs_copy_texture_region(_input->get_texture()->get_object(), 0, 0, in->get_object(), 0, 0, in->get_width(), in->get_height());
 	}
 
 	{ // Convert Input to Source format
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Convert Input -> Source"};
 #endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _convert_to_fp32->get_image(), 1.f / 255.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-			throw std::runtime_error("Transfer failed.");
+		if (_direct_in) {
+			if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _source->get_image(), 1.f / 255.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+				D_LOG_WARNING("Converting input to source in a single transfer failed, falling back to two transfers: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+				_direct_in = false;
+				resize(in->get_width(), in->get_height());
+			}
 		}
-	}
-
-	{ // Copy input to source.
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy Input -> Source"};
-#endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_fp32->get_image(), _source->get_image(), 1.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-			throw std::runtime_error("Transfer failed.");
+		if (!_direct_in) {
+			if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _convert_to_fp32->get_image(), 1.f / 255.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+				D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+				throw std::runtime_error("Transfer failed.");
+			}
+			if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_fp32->get_image(), _source->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+				D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+				throw std::runtime_error("Transfer failed.");
+			}
 		}
 	}
 
@@ -149,34 +200,17 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::nvidia::vfx::denoising::
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_cache, "Process"};
 #endif
+		if (is_shared()) {
+			bind();
+		}
+
+		_timer->run_begin();
 		if (auto res = _nvvfx->NvVFX_Run(_fx.get(), 0); res != ::streamfx::nvidia::cv::result::SUCCESS) {
 			D_LOG_ERROR("Failed to process due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
 			throw std::runtime_error("Run failed.");
 		}
+		_timer->run_end();
 	}
-
-	{ // Convert Destination to Output format
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Convert Destination -> Output"};
-#endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _convert_to_u8->get_image(), 255.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-			throw std::runtime_error("Transfer failed.");
-		}
-	}
-
-	{ // Copy destination to output.
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy Destination -> Output"};
-#endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_u8->get_image(), _output->get_image(), 1., _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-			throw std::runtime_error("Transfer failed.");
-		}
-	}
-
-	// Return output.
-	return _output->get_texture();
 }
 
 void streamfx::nvidia::vfx::denoising::resize(uint32_t width, uint32_t height)
@@ -184,6 +218,8 @@ void streamfx::nvidia::vfx::denoising::resize(uint32_t width, uint32_t height)
 	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
+	bool resized = false;
+
 	if (!_tmp) {
 		_tmp = std::make_shared<::streamfx::nvidia::cv::image>(width, height, ::streamfx::nvidia::cv::pixel_format::RGBA, ::streamfx::nvidia::cv::component_type::UINT8, ::streamfx::nvidia::cv::component_layout::PLANAR, ::streamfx::nvidia::cv::memory_location::GPU, 1);
 	}
@@ -192,11 +228,11 @@ void streamfx::nvidia::vfx::denoising::resize(uint32_t width, uint32_t height)
 		if (_input) {
 			_input->resize(width, height);
 		} else {
-			_input = std::make_shared<::streamfx::nvidia::cv::texture>(width, height, GS_RGBA_UNORM);
+			_input = std::make_shared<::streamfx::nvidia::cv::texture>(width, height, GS_RGBA_UNORM, ::streamfx::obs::gs::texture::flags::None, true);
 		}
 	}
 
-	if (!_convert_to_fp32 || (_convert_to_fp32->get_image()->width != width) || (_convert_to_fp32->get_image()->height != height)) {
+	if (!_direct_in && (!_convert_to_fp32 || (_convert_to_fp32->get_image()->width != width) || (_convert_to_fp32->get_image()->height != height))) {
 		if (_convert_to_fp32) {
 			_convert_to_fp32->resize(width, height);
 		} else {
@@ -217,7 +253,8 @@ void streamfx::nvidia::vfx::denoising::resize(uint32_t width, uint32_t height)
 			throw std::runtime_error("SetImage failed.");
 		}
 
-		_dirty = true;
+		resized = true;
+		_dirty  = true;
 	}
 
 	if (!_destination || (_destination->get_image()->width != width) || (_destination->get_image()->height != height)) {
@@ -236,7 +273,7 @@ void streamfx::nvidia::vfx::denoising::resize(uint32_t width, uint32_t height)
 		_dirty = true;
 	}
 
-	if (!_convert_to_u8 || (_convert_to_u8->get_image()->width != width) || (_convert_to_u8->get_image()->height != height)) {
+	if (!_direct_out && (!_convert_to_u8 || (_convert_to_u8->get_image()->width != width) || (_convert_to_u8->get_image()->height != height))) {
 		if (_convert_to_u8) {
 			_convert_to_u8->resize(width, height);
 		} else {
@@ -253,13 +290,23 @@ void streamfx::nvidia::vfx::denoising::resize(uint32_t width, uint32_t height)
 	}
 
 	if (!_state || _dirty) { // Reallocate and clean state.
-		if (_state) {
-			_nvcuda->get_cuda()->cuMemFree(_state);
+		// The state holds the temporal history of the denoiser, so it is kept for as long as the resolution doesn't
+		// change. This allows a reload, or the source being hidden and shown again, to continue where it left off.
+		auto     cctx2      = _compute->enter();
+		uint32_t state_size = 0;
+		_nvvfx->NvVFX_GetU32(_fx.get(), ::streamfx::nvidia::vfx::PARAMETER_STATE_SIZE, &state_size);
+		if (!_state || (state_size != _state_size)) {
+			if (_state) {
+				_nvcuda->get_cuda()->cuMemFree(_state);
+			}
+
+			_state_size = state_size;
+			_nvcuda->get_cuda()->cuMemAlloc(&_state, _state_size);
+			resized = true;
+		}
+		if (resized) {
+			_nvcuda->get_cuda()->cuMemsetD8(_state, 0, _state_size);
 		}
-
-		_nvvfx->NvVFX_GetU32(_fx.get(), ::streamfx::nvidia::vfx::PARAMETER_STATE_SIZE, &_state_size);
-		_nvcuda->get_cuda()->cuMemAlloc(&_state, _state_size);
-		_nvcuda->get_cuda()->cuMemsetD8(_state, 0, _state_size);
 
 		_states[0] = reinterpret_cast<void*>(_state);
 		if (auto res = _nvvfx->NvVFX_SetObject(_fx.get(), ::streamfx::nvidia::vfx::PARAMETER_STATE, reinterpret_cast<void*>(_states)); res != ::streamfx::nvidia::cv::result::SUCCESS) {
@@ -271,15 +318,54 @@ void streamfx::nvidia::vfx::denoising::resize(uint32_t width, uint32_t height)
 	}
 }
 
+void streamfx::nvidia::vfx::denoising::preload(uint32_t width, uint32_t height)
+{
+	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
+
+	resize(width, height);
+	if (_dirty) {
+		load();
+	}
+}
+
 void streamfx::nvidia::vfx::denoising::load()
 {
-	auto gctx = ::streamfx::obs::gs::context();
+	// Callers that also render hold the graphics context already, everyone else has no need for it.
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
-	if (auto res = effect::load(); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-		D_LOG_ERROR("Failed to initialize effect due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-		throw std::runtime_error("Load failed.");
+	// Instances at the same size and strength use the same model, each with its own images and state.
+	std::string key = std::to_string(_source->get_image()->width) + "x" + std::to_string(_source->get_image()->height) + "|" + std::to_string(_strength);
+	if (!share(key)) {
+		if (auto res = set(PARAMETER_STRENGTH, _strength); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+			D_LOG_ERROR("Failed to set '%s' to %1.3f.", PARAMETER_STRENGTH, _strength);
+		};
+		bind();
+
+		if (auto res = effect::load(key); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+			D_LOG_ERROR("Failed to initialize effect due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+			throw std::runtime_error("Load failed.");
+		}
 	}
 
 	_dirty = false;
 }
+
+void streamfx::nvidia::vfx::denoising::bind()
+{
+	if (auto res = set(::streamfx::nvidia::vfx::PARAMETER_CUDA_STREAM, _compute_stream); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		D_LOG_ERROR("Failed to set stream due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+		throw std::runtime_error("SetCudaStream failed.");
+	}
+	if (auto res = set(::streamfx::nvidia::vfx::PARAMETER_INPUT_IMAGE_0, _source); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		D_LOG_ERROR("Failed to set input image due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+		throw std::runtime_error("SetImage failed.");
+	}
+	if (auto res = set(::streamfx::nvidia::vfx::PARAMETER_OUTPUT_IMAGE_0, _destination); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		D_LOG_ERROR("Failed to set output image due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+		throw std::runtime_error("SetImage failed.");
+	}
+	if (auto res = set_object(::streamfx::nvidia::vfx::PARAMETER_STATE, reinterpret_cast<void*>(_states)); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		D_LOG_ERROR("Failed to set state due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+		throw std::runtime_error("SetObject failed.");
+	}
+}
@@ -23,6 +23,8 @@ namespace streamfx::nvidia::vfx {
 		std::shared_ptr<::streamfx::nvidia::cv::image>   _convert_to_u8;
 		std::shared_ptr<::streamfx::nvidia::cv::texture> _output;
 		std::shared_ptr<::streamfx::nvidia::cv::image>   _tmp;
+		bool                                             _direct_in;  // Convert input to source in one transfer.
+		bool                                             _direct_out; // Convert destination to output in one transfer.
 
 		void*                                  _states[1];
 		::streamfx::nvidia::cuda::device_ptr_t _state;
@@ -34,6 +36,7 @@ namespace streamfx::nvidia::vfx {
 		~denoising();
 		denoising();
 
+		/** Picks the weak or the strong model, so it only applies once the effect is loaded again. */
 		void  set_strength(float strength);
 		float strength();
 
@@ -41,9 +44,26 @@ namespace streamfx::nvidia::vfx {
 
 		std::shared_ptr<::streamfx::obs::gs::texture> process(std::shared_ptr<::streamfx::obs::gs::texture> in);
 
+		/** Like process(), but leaves the result in CUDA memory for another effect to continue with.
+		 *
+		 * The image is planar BGR in 32-bit floats from 0 to 1, and is overwritten by the next call.
+		 */
+		std::shared_ptr<::streamfx::nvidia::cv::image> process_image(std::shared_ptr<::streamfx::obs::gs::texture> in);
+
+		/** Set up for the given size and load the model for it, such as in the thread pool before first use.
+		 *
+		 * The graphics context is only held while buffers are created, not while the model is loaded.
+		 */
+		void preload(uint32_t width, uint32_t height);
+
 		private:
+		void run_effect(std::shared_ptr<::streamfx::obs::gs::texture> in);
+
 		void resize(uint32_t width, uint32_t height);
 
 		void load();
+
+		/** Assign our own images, state and stream, which a shared effect needs before every run. */
+		void bind();
 	};
 } // namespace streamfx::nvidia::vfx
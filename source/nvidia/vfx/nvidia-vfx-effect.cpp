@@ -7,6 +7,7 @@
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <mutex>
 #include <string_view>
 #include "warning-enable.hpp"
 
@@ -26,32 +27,66 @@
 
 using namespace ::streamfx::nvidia;
 
+// Loaded effects by what they were loaded for, so that every instance with the same configuration uses the same model
+// and engine, instead of holding another copy of them in video memory.
+static std::mutex                                 loaded_lock;
+static std::map<std::string, std::weak_ptr<void>> loaded;
+
 streamfx::nvidia::vfx::effect::~effect()
 {
 	auto gctx = ::streamfx::obs::gs::context();
-	auto cctx = cuda::obs::get()->get_context()->enter();
+	auto cctx = _compute->enter();
 
+	_compute_stream->synchronize();
+	if (_timer && (_timer->count() > 0)) {
+		D_LOG_INFO("Timings: %" PRIu64 " frames, %.3f ms transfer, %.3f ms run on average.", _timer->count(), _timer->average_transfer(), _timer->average_run());
+	}
+	{
+		auto octx = _nvcuda->get_context()->enter();
+		_timer.reset();
+	}
 	_fx.reset();
+	_staging.clear();
+	_compute_stream.reset();
+	_compute.reset();
 	_nvvfx.reset();
 	_nvcvi.reset();
+	_stream.reset();
 	_nvcuda.reset();
 }
 
-streamfx::nvidia::vfx::effect::effect(effect_t effect) : _nvcuda(cuda::obs::get()), _nvcvi(cv::cv::get()), _nvvfx(vfx::vfx::get()), _fx()
+streamfx::nvidia::vfx::effect::effect(effect_t effect) : _nvcuda(cuda::obs::get()), _stream(_nvcuda->acquire_stream(cuda::stream_priority::HIGH)), _compute(_nvcuda->get_compute_context()), _compute_stream(_stream), _nvcvi(cv::cv::get()), _nvvfx(vfx::vfx::get()), _fx(), _timer(), _name(effect), _shared(false), _staging()
 {
 	auto gctx = ::streamfx::obs::gs::context();
-	auto cctx = cuda::obs::get()->get_context()->enter();
+	auto cctx = _compute->enter();
+
+	// Offloaded effects get a stream on their own GPU.
+	if (is_offloaded()) {
+		_compute_stream = std::make_shared<cuda::stream>(cuda::stream_flags::NON_BLOCKING);
+	}
+
+	create();
+
+	// Timings are taken on the stream of the GPU OBS renders on, which is where processing starts and ends.
+	{
+		auto octx = _nvcuda->get_context()->enter();
+		_timer    = std::make_shared<cuda::run_timer>(_stream);
+	}
+}
 
+void streamfx::nvidia::vfx::effect::create()
+{
 	// Create the Effect/Feature.
 	::vfx::handle_t handle;
-	if (cv::result res = _nvvfx->NvVFX_CreateEffect(effect, &handle); res != cv::result::SUCCESS) {
+	if (cv::result res = _nvvfx->NvVFX_CreateEffect(_name.c_str(), &handle); res != cv::result::SUCCESS) {
 		D_LOG_ERROR("Unable to create effect: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
 		throw std::runtime_error("Unable to create effect.");
 	}
-	_fx = std::shared_ptr<void>(handle, [](::vfx::handle_t handle) { ::vfx::vfx::get()->NvVFX_DestroyEffect(handle); });
+	_fx     = std::shared_ptr<void>(handle, [](::vfx::handle_t handle) { ::vfx::vfx::get()->NvVFX_DestroyEffect(handle); });
+	_shared = false;
 
 	// Assign CUDA Stream object.
-	if (auto v = set(PARAMETER_CUDA_STREAM, _nvcuda->get_stream()); v != cv::result::SUCCESS) {
+	if (auto v = set(PARAMETER_CUDA_STREAM, _compute_stream); v != cv::result::SUCCESS) {
 		throw ::streamfx::nvidia::cv::exception(PARAMETER_CUDA_STREAM, v);
 	}
 
@@ -62,6 +97,54 @@ streamfx::nvidia::vfx::effect::effect(effect_t effect) : _nvcuda(cuda::obs::get(
 	}
 }
 
+std::string streamfx::nvidia::vfx::effect::shared_key(std::string_view key)
+{
+	std::string result = _name;
+	result.append("|").append(_model_path).append("|").append(key);
+	return result;
+}
+
+bool streamfx::nvidia::vfx::effect::share(std::string_view key)
+{
+	auto cctx = _compute->enter();
+
+	{
+		std::unique_lock<std::mutex> lock(loaded_lock);
+		auto                         iter = loaded.find(shared_key(key));
+		if (iter != loaded.end()) {
+			if (auto fx = iter->second.lock(); fx) {
+				_fx     = fx;
+				_shared = true;
+				return true;
+			}
+			loaded.erase(iter);
+		}
+	}
+
+	// Others may still be using what we shared before, so start over with an effect of our own.
+	if (_shared) {
+		create();
+	}
+	return false;
+}
+
+cv::result streamfx::nvidia::vfx::effect::load(std::string_view key)
+{
+	auto cctx = _compute->enter();
+	if (auto res = _nvvfx->NvVFX_Load(_fx.get()); res != cv::result::SUCCESS) {
+		return res;
+	}
+
+	// If someone else was faster, keep theirs registered. Both work, ours just isn't shared.
+	std::unique_lock<std::mutex> lock(loaded_lock);
+	auto&                        entry = loaded[shared_key(key)];
+	if (entry.expired()) {
+		entry   = _fx;
+		_shared = true;
+	}
+	return cv::result::SUCCESS;
+}
+
 cv::result streamfx::nvidia::vfx::effect::get(parameter_t param, std::string_view& value)
 {
 	const char* cvalue = nullptr;
@@ -89,3 +172,77 @@ cv::result streamfx::nvidia::vfx::effect::get(parameter_t param, std::string& va
 	}
 	return res;
 }
+
+cv::result streamfx::nvidia::vfx::effect::set(parameter_t param, std::shared_ptr<cv::image> const& value)
+{
+	if (!is_offloaded()) {
+		return _nvvfx->NvVFX_SetImage(_fx.get(), param, value->get_image());
+	}
+
+	auto  image   = value->get_image();
+	auto& staging = _staging[param];
+	auto  cctx    = _compute->enter();
+	if (!staging.remote) {
+		staging.remote = std::make_shared<cv::image>(_compute, image->width, image->height, image->pxl_format, image->comp_type, static_cast<cv::component_layout>(image->comp_layout), cv::memory_location::GPU, 1);
+	} else if ((staging.remote->get_image()->width != image->width) || (staging.remote->get_image()->height != image->height) || (staging.remote->get_image()->pxl_format != image->pxl_format) || (staging.remote->get_image()->comp_type != image->comp_type)) {
+		staging.remote->reallocate(image->width, image->height, image->pxl_format, image->comp_type, static_cast<cv::component_layout>(image->comp_layout), cv::memory_location::GPU, 1);
+	}
+	staging.local  = value;
+	staging.output = (std::string_view(param).rfind("Dst", 0) == 0);
+
+	return _nvvfx->NvVFX_SetImage(_fx.get(), param, staging.remote->get_image());
+}
+
+cv::result streamfx::nvidia::vfx::effect::run(bool async)
+{
+	_timer->run_begin();
+	cv::result res = is_offloaded() ? run_offloaded() : _nvvfx->NvVFX_Run(_fx.get(), async ? 1 : 0);
+	_timer->run_end();
+	return res;
+}
+
+cv::result streamfx::nvidia::vfx::effect::run_offloaded()
+{
+	// Inputs are converted on the stream of the GPU OBS renders on, which has to be done before they can be copied.
+	_stream->synchronize();
+
+	auto cctx = _compute->enter();
+	for (auto& kv : _staging) {
+		if (!kv.second.output) {
+			if (auto res = copy(kv.second.remote->get_image(), _compute, kv.second.local->get_image(), _nvcuda->get_context()); res != cv::result::SUCCESS) {
+				return res;
+			}
+		}
+	}
+
+	if (auto res = _nvvfx->NvVFX_Run(_fx.get(), 1); res != cv::result::SUCCESS) {
+		return res;
+	}
+
+	for (auto& kv : _staging) {
+		if (kv.second.output) {
+			if (auto res = copy(kv.second.local->get_image(), _nvcuda->get_context(), kv.second.remote->get_image(), _compute); res != cv::result::SUCCESS) {
+				return res;
+			}
+		}
+	}
+
+	// Outputs are read on the stream of the GPU OBS renders on right after this.
+	_compute_stream->synchronize();
+	return cv::result::SUCCESS;
+}
+
+cv::result streamfx::nvidia::vfx::effect::copy(cv::image_t* dst, std::shared_ptr<cuda::context> const& dst_ctx, cv::image_t* src, std::shared_ptr<cuda::context> const& src_ctx)
+{
+	// Both sides are laid out the same way for the same size and format, so a single linear copy is enough.
+	if ((dst->pitch != src->pitch) || (dst->height != src->height) || (dst->comp_layout != src->comp_layout) || (dst->num_components != src->num_components)) {
+		return cv::result::ERROR_MISMATCH;
+	}
+	std::size_t planes = (static_cast<cv::component_layout>(src->comp_layout) == cv::component_layout::PLANAR) ? src->num_components : 1;
+	std::size_t bytes  = static_cast<std::size_t>(src->pitch) * src->height * planes;
+
+	if (_nvcuda->get_cuda()->cuMemcpyPeerAsync(reinterpret_cast<cuda::device_ptr_t>(dst->pixels), dst_ctx->get(), reinterpret_cast<cuda::device_ptr_t>(src->pixels), src_ctx->get(), bytes, _compute_stream->get()) != cuda::result::SUCCESS) {
+		return cv::result::ERROR_CUDA_BASE;
+	}
+	return cv::result::SUCCESS;
+}
@@ -4,6 +4,7 @@
 
 #pragma once
 #include "nvidia-vfx.hpp"
+#include "nvidia/cuda/nvidia-cuda-event.hpp"
 #include "nvidia/cuda/nvidia-cuda-obs.hpp"
 #include "nvidia/cuda/nvidia-cuda-stream.hpp"
 #include "nvidia/cuda/nvidia-cuda.hpp"
@@ -13,6 +14,7 @@
 #include "nvidia/vfx/nvidia-vfx.hpp"
 
 #include "warning-disable.hpp"
+#include <map>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -22,12 +24,27 @@ namespace streamfx::nvidia::vfx {
 	using namespace ::streamfx::nvidia;
 
 	class effect {
+		struct staging_t {
+			std::shared_ptr<cv::image> local;  // Image on the GPU OBS renders on, which the effect code works with.
+			std::shared_ptr<cv::image> remote; // Copy of it on the GPU the effect runs on.
+			bool                       output;
+		};
+
 		protected:
-		std::shared_ptr<cuda::obs> _nvcuda;
-		std::shared_ptr<cv::cv>    _nvcvi;
-		std::shared_ptr<vfx>       _nvvfx;
-		std::shared_ptr<void>      _fx;
-		std::string                _model_path;
+		std::shared_ptr<cuda::obs>       _nvcuda;
+		std::shared_ptr<cuda::stream>    _stream;
+		std::shared_ptr<cuda::context>   _compute;
+		std::shared_ptr<cuda::stream>    _compute_stream;
+		std::shared_ptr<cv::cv>          _nvcvi;
+		std::shared_ptr<vfx>             _nvvfx;
+		std::shared_ptr<void>            _fx;
+		std::string                      _model_path;
+		std::shared_ptr<cuda::run_timer> _timer;
+
+		private:
+		std::string                      _name;
+		bool                             _shared; // _fx is in the registry of loaded effects.
+		std::map<std::string, staging_t> _staging;
 
 		public:
 		~effect();
@@ -38,6 +55,22 @@ namespace streamfx::nvidia::vfx {
 			return _fx.get();
 		}
 
+		/** Does the effect run on a different GPU than the one OBS renders on? */
+		inline bool is_offloaded()
+		{
+			return _compute != _nvcuda->get_context();
+		}
+
+		/** Is the loaded effect shared with other instances?
+		 *
+		 * Shared effects are used by every instance in turn, so each has to assign its own images, state and stream
+		 * again before running, and nothing else may be changed on them.
+		 */
+		inline bool is_shared()
+		{
+			return _shared;
+		}
+
 		public /* Int32 */:
 		inline cv::result set(parameter_t param, uint32_t const value)
 		{
@@ -135,10 +168,12 @@ namespace streamfx::nvidia::vfx {
 			return _nvvfx->NvVFX_GetImage(_fx.get(), param, value);
 		};
 
-		inline cv::result set(parameter_t param, std::shared_ptr<cv::image> const& value)
-		{
-			return _nvvfx->NvVFX_SetImage(_fx.get(), param, value->get_image());
-		};
+		/** Assign an image on the GPU OBS renders on.
+		 *
+		 * If the effect is offloaded, it is given a copy on its own GPU instead, which run() keeps up to date. Images
+		 * for parameters starting with "Dst" are copied back after running, all others are copied over before.
+		 */
+		cv::result set(parameter_t param, std::shared_ptr<cv::image> const& value);
 		inline cv::result get(parameter_t param, std::shared_ptr<cv::image>& value)
 		{
 			return _nvvfx->NvVFX_GetImage(_fx.get(), param, value->get_image());
@@ -147,7 +182,7 @@ namespace streamfx::nvidia::vfx {
 		public /* CV Texture */:
 		inline cv::result set(parameter_t param, std::shared_ptr<cv::texture> const& value)
 		{
-			return _nvvfx->NvVFX_SetImage(_fx.get(), param, value->get_image());
+			return set(param, std::static_pointer_cast<cv::image>(value));
 		};
 		//cv::result get(parameter_t param, std::shared_ptr<cv::texture>& value);
 
@@ -164,12 +199,40 @@ namespace streamfx::nvidia::vfx {
 		public /* Control */:
 		inline cv::result load()
 		{
+			auto cctx = _compute->enter();
 			return _nvvfx->NvVFX_Load(_fx.get());
 		};
 
-		inline cv::result run(bool async = false)
+		/** Switch to an effect that another instance already loaded for the same key, if there is one.
+		 *
+		 * The key has to cover everything that was assigned before loading, such as the mode and the image sizes. If
+		 * there is none, the effect is left unloaded and unshared, ready to be configured and passed to load(key).
+		 */
+		bool share(std::string_view key);
+
+		/** Load the effect, and let other instances share it under the key from then on. */
+		cv::result load(std::string_view key);
+
+		/** Run the effect.
+		 *
+		 * Offloaded effects wait for the stream of the GPU OBS renders on, copy their inputs across, run, and copy
+		 * their outputs back, so they are always synchronous.
+		 */
+		cv::result run(bool async = false);
+
+		/** GPU time spent in run(), and around it between begin() and end() of the timer. */
+		std::shared_ptr<cuda::run_timer> timer()
 		{
-			return _nvvfx->NvVFX_Run(_fx.get(), async ? 1 : 0);
-		};
+			return _timer;
+		}
+
+		private:
+		void create();
+
+		std::string shared_key(std::string_view key);
+
+		cv::result run_offloaded();
+
+		cv::result copy(cv::image_t* dst, std::shared_ptr<cuda::context> const& dst_ctx, cv::image_t* src, std::shared_ptr<cuda::context> const& src_ctx);
 	};
 } // namespace streamfx::nvidia::vfx
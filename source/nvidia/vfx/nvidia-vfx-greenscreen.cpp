@@ -83,10 +83,16 @@ void streamfx::nvidia::vfx::greenscreen::set_mode(greenscreen_mode mode)
 }
 
 std::shared_ptr<streamfx::obs::gs::texture> streamfx::nvidia::vfx::greenscreen::process(std::shared_ptr<::streamfx::obs::gs::texture> in)
+{
+	return process(in, in);
+}
+
+std::shared_ptr<streamfx::obs::gs::texture> streamfx::nvidia::vfx::greenscreen::process(std::shared_ptr<::streamfx::obs::gs::texture> in, std::shared_ptr<::streamfx::obs::gs::texture> color)
 {
 	// Enter Graphics and CUDA context.
 	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = _nvcuda->get_context()->enter();
+	_timer->begin();
 
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_magenta, "NvVFX Background Removal"};
@@ -100,25 +106,20 @@ std::shared_ptr<streamfx::obs::gs::texture> streamfx::nvidia::vfx::greenscreen::
 		load();
 	}
 
-	{ // Copy parameter to input.
+	if (in != _input->get_texture()) { // Copy parameter to input, unless it was rendered there already.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy In -> Input"};
 #endif
 		gs_copy_texture(_input->get_texture()->get_object(), in->get_object());
 	}
 
-	{ // Enqueue into buffer (back is newest).
-		auto el = _buffer.front();
-		gs_copy_texture(el->get_object(), in->get_object());
-		_buffer.push_back(el);
-		_buffer.pop_front();
-	}
+	delay(color);
 
 	{ // Copy input to source.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy Input -> Source"};
 #endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _source->get_image(), 1.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _source->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
 			D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
 			throw std::runtime_error("Transfer failed.");
 		}
@@ -138,16 +139,43 @@ std::shared_ptr<streamfx::obs::gs::texture> streamfx::nvidia::vfx::greenscreen::
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy Destination -> Output"};
 #endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _output->get_image(), 1., _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _output->get_image(), 1., _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
 			D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
 			throw std::runtime_error("Transfer failed.");
 		}
 	}
 
 	// Return output.
+	_timer->end();
 	return _output->get_texture();
 }
 
+void streamfx::nvidia::vfx::greenscreen::delay(std::shared_ptr<::streamfx::obs::gs::texture> color)
+{
+	auto gctx = ::streamfx::obs::gs::context();
+
+	if (_buffer.empty() || (_buffer.front()->get_width() != color->get_width()) || (_buffer.front()->get_height() != color->get_height())) {
+		_buffer.clear();
+		for (size_t idx = 0; idx < LATENCY_BUFFER; idx++) {
+			auto el = std::make_shared<::streamfx::obs::gs::texture>(color->get_width(), color->get_height(), GS_RGBA_UNORM, 1, nullptr, ::streamfx::obs::gs::texture::flags::None);
+			_buffer.push_back(el);
+		}
+	}
+
+	{ // Enqueue into buffer (back is newest).
+		auto el = _buffer.front();
+		gs_copy_texture(el->get_object(), color->get_object());
+		_buffer.push_back(el);
+		_buffer.pop_front();
+	}
+}
+
+std::shared_ptr<streamfx::obs::gs::texture> streamfx::nvidia::vfx::greenscreen::get_input(std::pair<uint32_t, uint32_t> size)
+{
+	resize(size.first, size.second);
+	return _input->get_texture();
+}
+
 std::shared_ptr<streamfx::obs::gs::texture> streamfx::nvidia::vfx::greenscreen::get_color()
 {
 	//return _input->get_texture();
@@ -172,18 +200,10 @@ void streamfx::nvidia::vfx::greenscreen::resize(uint32_t width, uint32_t height)
 	}
 
 	if (!_input || (in_size.first != _input->get_texture()->get_width()) || (in_size.second != _input->get_texture()->get_height())) {
-		{
-			_buffer.clear();
-			for (size_t idx = 0; idx < LATENCY_BUFFER; idx++) {
-				auto el = std::make_shared<::streamfx::obs::gs::texture>(width, height, GS_RGBA_UNORM, 1, nullptr, ::streamfx::obs::gs::texture::flags::None);
-				_buffer.push_back(el);
-			}
-		}
-
 		if (_input) {
 			_input->resize(in_size.first, in_size.second);
 		} else {
-			_input = std::make_shared<::streamfx::nvidia::cv::texture>(in_size.first, in_size.second, GS_RGBA_UNORM);
+			_input = std::make_shared<::streamfx::nvidia::cv::texture>(in_size.first, in_size.second, GS_RGBA_UNORM, ::streamfx::obs::gs::texture::flags::RenderTarget);
 		}
 
 		_dirty = true;
@@ -234,10 +254,15 @@ void streamfx::nvidia::vfx::greenscreen::load()
 	auto cctx = _nvcuda->get_context()->enter();
 
 	// Assign CUDA Stream object.
-	if (auto v = set(PARAMETER_CUDA_STREAM, _nvcuda->get_stream()); v != cv::result::SUCCESS) {
+	if (auto v = set(PARAMETER_CUDA_STREAM, _stream); v != cv::result::SUCCESS) {
 		throw ::streamfx::nvidia::cv::exception(PARAMETER_CUDA_STREAM, v);
 	}
 
+	// Capture the kernels into a CUDA graph on first run and replay it afterwards. Not every SDK version supports this.
+	if (auto v = set(PARAMETER_CUDA_GRAPH, static_cast<uint32_t>(1)); v != cv::result::SUCCESS) {
+		D_LOG_DEBUG("CUDA graphs are not supported, error: %s", _nvcvi->NvCV_GetErrorStringFromCode(v));
+	}
+
 	if (auto v = effect::load(); v != ::streamfx::nvidia::cv::result::SUCCESS) {
 		throw ::streamfx::nvidia::cv::exception("load", v);
 	}
@@ -37,6 +37,16 @@ namespace streamfx::nvidia::vfx {
 
 		std::shared_ptr<::streamfx::obs::gs::texture> process(std::shared_ptr<::streamfx::obs::gs::texture> in);
 
+		/** Process 'in', but delay 'color' for get_color() instead, which may be larger than 'in'. */
+		std::shared_ptr<::streamfx::obs::gs::texture> process(std::shared_ptr<::streamfx::obs::gs::texture> in, std::shared_ptr<::streamfx::obs::gs::texture> color);
+
+		/** Delay 'color' for get_color() like process() does, for frames that keep the previous mask instead. */
+		void delay(std::shared_ptr<::streamfx::obs::gs::texture> color);
+
+		/** The texture that is handed to CUDA, resized for 'size'. Rendering straight into it and passing it to process()
+		 * skips the copy into it. Only valid until the next call to size() or process() with a different size. */
+		std::shared_ptr<::streamfx::obs::gs::texture> get_input(std::pair<uint32_t, uint32_t> size);
+
 		std::shared_ptr<::streamfx::obs::gs::texture> get_color();
 
 		std::shared_ptr<::streamfx::obs::gs::texture> get_mask();
@@ -0,0 +1,49 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "nvidia-vfx-handoff.hpp"
+
+// Requests nest as filters capture each other, the innermost one is the only one that can be answered.
+static thread_local streamfx::nvidia::vfx::handoff* current = nullptr;
+
+streamfx::nvidia::vfx::handoff::~handoff()
+{
+	current = _previous;
+}
+
+streamfx::nvidia::vfx::handoff::handoff(obs_source_t* target, uint32_t width, uint32_t height) : _previous(current), _target(target), _width(width), _height(height), _image(), _alpha()
+{
+	current = this;
+}
+
+std::shared_ptr<::streamfx::nvidia::cv::image> streamfx::nvidia::vfx::handoff::take(std::shared_ptr<::streamfx::obs::gs::texture>& alpha)
+{
+	// Anything rendered after this point is no longer part of the capture.
+	if (current == this) {
+		current = _previous;
+	}
+	alpha = std::move(_alpha);
+	return std::move(_image);
+}
+
+bool streamfx::nvidia::vfx::handoff::requested(obs_source_t* self, uint32_t width, uint32_t height)
+{
+	return current && (current->_target == self) && !current->_image && (current->_width == width) && (current->_height == height);
+}
+
+bool streamfx::nvidia::vfx::handoff::offer(obs_source_t* self, std::shared_ptr<::streamfx::nvidia::cv::image> image, std::shared_ptr<::streamfx::obs::gs::texture> alpha)
+{
+	if (!image || !alpha || !requested(self, image->get_image()->width, image->get_image()->height)) {
+		return false;
+	}
+
+	// The effects run at the size of the capture, so anything else would be drawn scaled instead.
+	if ((alpha->get_width() != current->_width) || (alpha->get_height() != current->_height)) {
+		return false;
+	}
+
+	current->_image = std::move(image);
+	current->_alpha = std::move(alpha);
+	return true;
+}
@@ -0,0 +1,49 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "nvidia/cv/nvidia-cv-image.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <memory>
+#include "warning-enable.hpp"
+
+namespace streamfx::nvidia::vfx {
+	/** Passes the result of an effect directly to the effect of the filter above it, without leaving CUDA memory.
+	 *
+	 * Works like streamfx::obs::gs::handoff, except that what is handed over is the image the effect produced, which
+	 * saves converting it into a texture and then right back into CUDA memory again. The colors are planar BGR in
+	 * 32-bit floats from 0 to 1, and the alpha channel comes separately in a texture of the same size, as the effects
+	 * don't keep it. Both belong to the filter below, and must not be kept past the current render. Graphics thread only.
+	 */
+	class handoff {
+		handoff* _previous;
+
+		obs_source_t*                                  _target;
+		uint32_t                                       _width;
+		uint32_t                                       _height;
+		std::shared_ptr<::streamfx::nvidia::cv::image> _image;
+		std::shared_ptr<::streamfx::obs::gs::texture>  _alpha;
+
+		public:
+		~handoff();
+
+		/** Ask target to hand over its result, which must be a width by height image. */
+		handoff(obs_source_t* target, uint32_t width, uint32_t height);
+
+		handoff(const handoff&)            = delete;
+		handoff& operator=(const handoff&) = delete;
+
+		/** Call after obs_source_process_filter_begin(). If this returns an image, skip obs_source_process_filter_end(). */
+		std::shared_ptr<::streamfx::nvidia::cv::image> take(std::shared_ptr<::streamfx::obs::gs::texture>& alpha);
+
+		/** Whether a result of this size would be taken, so that the effect can skip converting it into a texture. */
+		static bool requested(obs_source_t* self, uint32_t width, uint32_t height);
+
+		/** Call while rendering instead of drawing the result; false if nobody asked for it, which means draw as usual. */
+		static bool offer(obs_source_t* self, std::shared_ptr<::streamfx::nvidia::cv::image> image, std::shared_ptr<::streamfx::obs::gs::texture> alpha);
+	};
+} // namespace streamfx::nvidia::vfx
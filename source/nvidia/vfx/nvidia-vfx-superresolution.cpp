@@ -10,6 +10,7 @@
 
 #include "warning-disable.hpp"
 #include <cmath>
+#include <string>
 #include <utility>
 #include <vector>
 #include "warning-enable.hpp"
@@ -74,10 +75,9 @@ streamfx::nvidia::vfx::superresolution::~superresolution()
 	_tmp.reset();
 }
 
-streamfx::nvidia::vfx::superresolution::superresolution() : effect(EFFECT_SUPERRESOLUTION), _dirty(true), _input(), _convert_to_fp32(), _source(), _destination(), _convert_to_u8(), _output(), _tmp(), _strength(1.), _scale(1.5), _cache_input_size(), _cache_output_size(), _cache_scale()
+streamfx::nvidia::vfx::superresolution::superresolution() : effect(EFFECT_SUPERRESOLUTION), _dirty(true), _input(), _convert_to_fp32(), _source(), _destination(), _convert_to_u8(), _output(), _tmp(), _direct_in(true), _direct_out(true), _strength(1.), _scale(1.5), _cache_input_size(), _cache_output_size(), _cache_scale()
 {
-	// Enter Graphics and CUDA context.
-	auto gctx = ::streamfx::obs::gs::context();
+	// Only enter the CUDA context, loading can take a while and doesn't need the graphics context.
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
 	// Set the strength, scale and buffers.
@@ -94,17 +94,10 @@ void streamfx::nvidia::vfx::superresolution::set_strength(float strength)
 	strength = (strength >= .5f) ? 1.f : 0.f;
 	std::swap(_strength, strength);
 
-	// If anything was changed, flag the effect as dirty.
+	// If anything was changed, flag the effect as dirty. The effect itself is only updated by load(), as it may be
+	// shared with other instances until then.
 	if (!::streamfx::util::math::is_close<float>(_strength, strength, 0.01f))
 		_dirty = true;
-
-	// Update Effect
-	uint32_t value = (_strength >= .5f) ? 1u : 0u;
-	auto     gctx  = ::streamfx::obs::gs::context();
-	auto     cctx  = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
-	if (auto res = set(::streamfx::nvidia::vfx::PARAMETER_STRENGTH, value); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-		D_LOG_ERROR("Failed to set '%s' to %lu.", ::streamfx::nvidia::vfx::PARAMETER_STRENGTH, value);
-	};
 }
 
 float streamfx::nvidia::vfx::superresolution::strength()
@@ -202,6 +195,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::nvidia::vfx::superresolu
 	// Enter Graphics and CUDA context.
 	auto gctx = ::streamfx::obs::gs::context();
 	auto cctx = _nvcuda->get_context()->enter();
+	_timer->begin();
 
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_magenta, "NvVFX Super-Resolution"};
@@ -219,33 +213,93 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::nvidia::vfx::superresolu
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy In -> Input"};
 #endif
-		gs_copy_texture(_input->get_texture()->get_object(), in->get_object());
+		gs_copy_texture_region(_input->get_texture()->get_object(), 0, 0, in->get_object(), 0, 0, in->get_width(), in->get_height());
 	}
 
 	{ // Convert Input to Source format
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Convert Input -> Source"};
 #endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _convert_to_fp32->get_image(), 1.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-			throw std::runtime_error("Transfer failed.");
+		if (_direct_in) {
+			if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _source->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+				D_LOG_WARNING("Converting input to source in a single transfer failed, falling back to two transfers: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+				_direct_in = false;
+				resize(in->get_width(), in->get_height());
+			}
+		}
+		if (!_direct_in) {
+			if (auto res = _nvcvi->NvCVImage_Transfer(_input->get_image(), _convert_to_fp32->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+				D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+				throw std::runtime_error("Transfer failed.");
+			}
+			if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_fp32->get_image(), _source->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+				D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+				throw std::runtime_error("Transfer failed.");
+			}
 		}
 	}
 
-	{ // Copy input to source.
+	auto output = run_effect(in->get_width(), in->get_height());
+
+	// Return output.
+	_timer->end();
+	return output;
+}
+
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::nvidia::vfx::superresolution::process(std::shared_ptr<::streamfx::nvidia::cv::image> in, float scale)
+{
+	// Enter Graphics and CUDA context.
+	auto gctx = ::streamfx::obs::gs::context();
+	auto cctx = _nvcuda->get_context()->enter();
+	_timer->begin();
+
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy Input -> Source"};
+	::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_magenta, "NvVFX Super-Resolution"};
+#endif
+
+	// Resize if the size or scale was changed.
+	uint32_t width  = in->get_image()->width;
+	uint32_t height = in->get_image()->height;
+	resize(width, height);
+
+	// Reload effect if dirty.
+	if (_dirty) {
+		load();
+	}
+
+	// A transfer can't scale the image, so it has to be exactly the size the effect was set up for.
+	if ((_source->get_image()->width != width) || (_source->get_image()->height != height)) {
+		D_LOG_ERROR("Image size %" PRIu32 "x%" PRIu32 " is not supported.", width, height);
+		throw std::runtime_error("Unsupported size.");
+	}
+
+	{ // Convert Image to Source format, which never leaves CUDA memory.
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Convert Image -> Source"};
 #endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_fp32->get_image(), _source->get_image(), 1.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to transfer input to processing source due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+		if (auto res = _nvcvi->NvCVImage_Transfer(in->get_image(), _source->get_image(), scale, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+			D_LOG_ERROR("Failed to transfer image to processing source due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
 			throw std::runtime_error("Transfer failed.");
 		}
 	}
 
+	auto output = run_effect(width, height);
+
+	// Return output.
+	_timer->end();
+	return output;
+}
+
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::nvidia::vfx::superresolution::run_effect(uint32_t width, uint32_t height)
+{
 	{ // Process source to destination.
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_cache, "Process"};
 #endif
+		if (is_shared()) {
+			bind();
+		}
+
 		if (auto res = run(); res != ::streamfx::nvidia::cv::result::SUCCESS) {
 			D_LOG_ERROR("Failed to process due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
 			throw std::runtime_error("Run failed.");
@@ -256,23 +310,25 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::nvidia::vfx::superresolu
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Convert Destination -> Output"};
 #endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _convert_to_u8->get_image(), 1.f, _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-			throw std::runtime_error("Transfer failed.");
+		if (_direct_out) {
+			if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _output->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+				D_LOG_WARNING("Converting destination to output in a single transfer failed, falling back to two transfers: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+				_direct_out = false;
+				resize(width, height);
+			}
 		}
-	}
-
-	{ // Copy destination to output.
-#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_copy, "Copy Destination -> Output"};
-#endif
-		if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_u8->get_image(), _output->get_image(), 1., _nvcuda->get_stream()->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-			D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-			throw std::runtime_error("Transfer failed.");
+		if (!_direct_out) {
+			if (auto res = _nvcvi->NvCVImage_Transfer(_destination->get_image(), _convert_to_u8->get_image(), 1.f, _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+				D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+				throw std::runtime_error("Transfer failed.");
+			}
+			if (auto res = _nvcvi->NvCVImage_Transfer(_convert_to_u8->get_image(), _output->get_image(), 1., _stream->get(), _tmp->get_image()); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+				D_LOG_ERROR("Failed to transfer processing result to output due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+				throw std::runtime_error("Transfer failed.");
+			}
 		}
 	}
 
-	// Return output.
 	return _output->get_texture();
 }
 
@@ -292,11 +348,11 @@ void streamfx::nvidia::vfx::superresolution::resize(uint32_t width, uint32_t hei
 		if (_input) {
 			_input->resize(_cache_input_size.first, _cache_input_size.second);
 		} else {
-			_input = std::make_shared<::streamfx::nvidia::cv::texture>(_cache_input_size.first, _cache_input_size.second, GS_RGBA_UNORM);
+			_input = std::make_shared<::streamfx::nvidia::cv::texture>(_cache_input_size.first, _cache_input_size.second, GS_RGBA_UNORM, ::streamfx::obs::gs::texture::flags::None, true);
 		}
 	}
 
-	if (!_convert_to_fp32 || (_convert_to_fp32->get_image()->width != _cache_input_size.first) || (_convert_to_fp32->get_image()->height != _cache_input_size.second)) {
+	if (!_direct_in && (!_convert_to_fp32 || (_convert_to_fp32->get_image()->width != _cache_input_size.first) || (_convert_to_fp32->get_image()->height != _cache_input_size.second))) {
 		if (_convert_to_fp32) {
 			_convert_to_fp32->resize(_cache_input_size.first, _cache_input_size.second);
 		} else {
@@ -334,7 +390,7 @@ void streamfx::nvidia::vfx::superresolution::resize(uint32_t width, uint32_t hei
 		_dirty = true;
 	}
 
-	if (!_convert_to_u8 || (_convert_to_u8->get_image()->width != _cache_output_size.first) || (_convert_to_u8->get_image()->height != _cache_output_size.second)) {
+	if (!_direct_out && (!_convert_to_u8 || (_convert_to_u8->get_image()->width != _cache_output_size.first) || (_convert_to_u8->get_image()->height != _cache_output_size.second))) {
 		if (_convert_to_u8) {
 			_convert_to_u8->resize(_cache_output_size.first, _cache_output_size.second);
 		} else {
@@ -351,15 +407,51 @@ void streamfx::nvidia::vfx::superresolution::resize(uint32_t width, uint32_t hei
 	}
 }
 
+void streamfx::nvidia::vfx::superresolution::preload(uint32_t width, uint32_t height)
+{
+	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
+
+	resize(width, height);
+	if (_dirty) {
+		load();
+	}
+}
+
 void streamfx::nvidia::vfx::superresolution::load()
 {
-	auto gctx = ::streamfx::obs::gs::context();
+	// Callers that also render hold the graphics context already, everyone else has no need for it.
 	auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
 
-	if (auto res = effect::load(); res != ::streamfx::nvidia::cv::result::SUCCESS) {
-		D_LOG_ERROR("Failed to initialize effect due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
-		throw std::runtime_error("Load failed.");
+	// Instances with the same sizes and mode use the same model, each with its own images.
+	uint32_t    value = (_strength >= .5f) ? 1u : 0u;
+	std::string key   = std::to_string(_source->get_image()->width) + "x" + std::to_string(_source->get_image()->height) + "|" + std::to_string(_destination->get_image()->width) + "x" + std::to_string(_destination->get_image()->height) + "|" + std::to_string(value);
+	if (!share(key)) {
+		if (auto res = set(::streamfx::nvidia::vfx::PARAMETER_STRENGTH, value); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+			D_LOG_ERROR("Failed to set '%s' to %lu.", ::streamfx::nvidia::vfx::PARAMETER_STRENGTH, value);
+		};
+		bind();
+
+		if (auto res = effect::load(key); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+			D_LOG_ERROR("Failed to initialize effect due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+			throw std::runtime_error("Load failed.");
+		}
 	}
 
 	_dirty = false;
 }
+
+void streamfx::nvidia::vfx::superresolution::bind()
+{
+	if (auto res = set(::streamfx::nvidia::vfx::PARAMETER_CUDA_STREAM, _compute_stream); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		D_LOG_ERROR("Failed to set stream due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+		throw std::runtime_error("SetCudaStream failed.");
+	}
+	if (auto res = set(::streamfx::nvidia::vfx::PARAMETER_INPUT_IMAGE_0, _source); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		D_LOG_ERROR("Failed to set input image due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+		throw std::runtime_error("SetImage failed.");
+	}
+	if (auto res = set(::streamfx::nvidia::vfx::PARAMETER_OUTPUT_IMAGE_0, _destination); res != ::streamfx::nvidia::cv::result::SUCCESS) {
+		D_LOG_ERROR("Failed to set output image due to error: %s", _nvcvi->NvCV_GetErrorStringFromCode(res));
+		throw std::runtime_error("SetImage failed.");
+	}
+}
@@ -22,6 +22,8 @@ namespace streamfx::nvidia::vfx {
 		std::shared_ptr<::streamfx::nvidia::cv::image>   _convert_to_u8;
 		std::shared_ptr<::streamfx::nvidia::cv::texture> _output;
 		std::shared_ptr<::streamfx::nvidia::cv::image>   _tmp;
+		bool                                             _direct_in;  // Convert input to source in one transfer.
+		bool                                             _direct_out; // Convert destination to output in one transfer.
 
 		float _strength;
 		float _scale;
@@ -34,9 +36,11 @@ namespace streamfx::nvidia::vfx {
 		~superresolution();
 		superresolution();
 
+		/** Picks the mode the model is loaded for, so it only applies once the effect is loaded again. */
 		void  set_strength(float strength);
 		float strength();
 
+		/** Changes the output size, so it only applies once the effect is loaded again. */
 		void  set_scale(float scale);
 		float scale();
 
@@ -44,9 +48,27 @@ namespace streamfx::nvidia::vfx {
 
 		std::shared_ptr<::streamfx::obs::gs::texture> process(std::shared_ptr<::streamfx::obs::gs::texture> in);
 
+		/** Upscale an image that is already in CUDA memory, such as the result of another effect.
+		 *
+		 * The image has to be planar BGR in 32-bit floats, at an input size that size() would pick. Its values are
+		 * multiplied by scale, which brings them into the range of 0 to 255 the effect works with.
+		 */
+		std::shared_ptr<::streamfx::obs::gs::texture> process(std::shared_ptr<::streamfx::nvidia::cv::image> in, float scale);
+
+		/** Set up for the given input size and load the model for it, such as in the thread pool before first use.
+		 *
+		 * The graphics context is only held while buffers are created, not while the model is loaded.
+		 */
+		void preload(uint32_t width, uint32_t height);
+
 		private:
+		std::shared_ptr<::streamfx::obs::gs::texture> run_effect(uint32_t width, uint32_t height);
+
 		void resize(uint32_t width, uint32_t height);
 
 		void load();
+
+		/** Assign our own images and stream, which a shared effect needs before every run. */
+		void bind();
 	};
 } // namespace streamfx::nvidia::vfx
@@ -5,6 +5,7 @@
 #include "nvidia-vfx.hpp"
 #include "nvidia/cuda/nvidia-cuda-obs.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
 #include "util/util-logging.hpp"
 #include "util/util-platform.hpp"
 
@@ -48,33 +49,10 @@
 			throw std::runtime_error("Failed to load '" #NAME "' from '" LIB_NAME "'."); \
 	}
 
-streamfx::nvidia::vfx::vfx::~vfx()
-{
-	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
-
-#ifdef WIN32
-	// Remove the DLL directory from the library loader paths.
-	if (_extra != nullptr) {
-		RemoveDllDirectory(reinterpret_cast<DLL_DIRECTORY_COOKIE>(_extra));
-	}
-#endif
-
-	{ // The library may need to release Graphics and CUDA resources.
-		auto gctx = ::streamfx::obs::gs::context();
-		auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
-		_library.reset();
-	}
-}
-
-streamfx::nvidia::vfx::vfx::vfx()
+static std::filesystem::path find_sdk_path()
 {
 	std::filesystem::path sdk_path;
-	auto                  gctx = ::streamfx::obs::gs::context();
-	auto                  cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
-
-	D_LOG_DEBUG("Initializing... (Addr: 0x%" PRIuPTR ")", this);
 
-	// Figure out the location of the Video Effects SDK, if it is installed.
 #ifdef WIN32
 	{
 		DWORD                env_size;
@@ -100,6 +78,38 @@ streamfx::nvidia::vfx::vfx::vfx()
 	throw std::runtime_error("Not yet implemented.");
 #endif
 
+	return sdk_path;
+}
+
+streamfx::nvidia::vfx::vfx::~vfx()
+{
+	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
+
+#ifdef WIN32
+	// Remove the DLL directory from the library loader paths.
+	if (_extra != nullptr) {
+		RemoveDllDirectory(reinterpret_cast<DLL_DIRECTORY_COOKIE>(_extra));
+	}
+#endif
+
+	{ // The library may need to release Graphics and CUDA resources.
+		auto gctx = ::streamfx::obs::gs::context();
+		auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
+		_library.reset();
+	}
+}
+
+streamfx::nvidia::vfx::vfx::vfx()
+{
+	std::filesystem::path sdk_path;
+	auto                  gctx = ::streamfx::obs::gs::context();
+	auto                  cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
+
+	D_LOG_DEBUG("Initializing... (Addr: 0x%" PRIuPTR ")", this);
+
+	// Figure out the location of the Video Effects SDK, if it is installed.
+	sdk_path = find_sdk_path();
+
 	// Check if any of the found paths are valid.
 	if (!std::filesystem::exists(sdk_path)) {
 		D_LOG_ERROR("No supported NVIDIA SDK is installed to provide '%s'.", LIB_NAME);
@@ -184,12 +194,17 @@ streamfx::nvidia::vfx::vfx::vfx()
 		NVVFX_LOAD_SYMBOL(NvVFX_Load);
 	}
 
-	{ // Assign proper GPU.
-		auto cctx = ::streamfx::nvidia::cuda::obs::get()->get_context()->enter();
-		NvVFX_SetU32(nullptr, PARAMETER_GPU, 0);
+	{ // Assign proper GPU, which is the one effects run on.
+		auto                               compute = ::streamfx::nvidia::cuda::obs::get()->get_compute_context();
+		auto                               cctx    = compute->enter();
+		::streamfx::nvidia::cuda::device_t device  = 0;
+		compute->get_device(device);
+		NvVFX_SetU32(nullptr, PARAMETER_GPU, static_cast<uint32_t>(device));
 	}
 }
 
+static std::shared_ptr<streamfx::nvidia::vfx::vfx> loader_instance;
+
 std::shared_ptr<::streamfx::nvidia::vfx::vfx> streamfx::nvidia::vfx::vfx::get()
 {
 	static std::weak_ptr<streamfx::nvidia::vfx::vfx> instance;
@@ -199,12 +214,31 @@ std::shared_ptr<::streamfx::nvidia::vfx::vfx> streamfx::nvidia::vfx::vfx::get()
 	if (instance.expired()) {
 		auto hard_instance = std::make_shared<streamfx::nvidia::vfx::vfx>();
 		instance           = hard_instance;
+		loader_instance    = hard_instance; // Stay loaded until the plugin unloads.
 		return hard_instance;
 	}
 	return instance.lock();
 }
 
+bool streamfx::nvidia::vfx::vfx::is_available()
+{
+	try {
+		return std::filesystem::exists(find_sdk_path() / LIB_NAME);
+	} catch (...) {
+		return false;
+	}
+}
+
 std::filesystem::path const& streamfx::nvidia::vfx::vfx::model_path()
 {
 	return _model_path;
 }
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		// Loaded on first use, so that nothing is paid for it unless an NVIDIA feature is used.
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::HIGH);
@@ -35,6 +35,7 @@ namespace streamfx::nvidia::vfx {
 	static constexpr parameter_t PARAMETER_OUTPUT_IMAGE_0  = "DstImage0";
 	static constexpr parameter_t PARAMETER_MODEL_DIRECTORY = "ModelDir";
 	static constexpr parameter_t PARAMETER_CUDA_STREAM     = "CudaStream";
+	static constexpr parameter_t PARAMETER_CUDA_GRAPH      = "CudaGraph";
 	static constexpr parameter_t PARAMETER_INFO            = "Info";
 	static constexpr parameter_t PARAMETER_SCALE           = "Scale";
 	static constexpr parameter_t PARAMETER_STRENGTH        = "Strength";
@@ -87,5 +88,8 @@ namespace streamfx::nvidia::vfx {
 
 		public:
 		static std::shared_ptr<::streamfx::nvidia::vfx::vfx> get();
+
+		/** Is the SDK installed? Only looks for the library, without loading it. */
+		static bool is_available();
 	};
 } // namespace streamfx::nvidia::vfx
@@ -21,5 +21,28 @@ namespace streamfx::obs::gs {
 		streamfx::obs::gs::effect_pass get_pass(std::size_t idx);
 		streamfx::obs::gs::effect_pass get_pass(std::string_view name);
 		bool                           has_pass(std::string_view name);
+
+		/** Run fn once for each pass, with the pass applied, as a loop over gs_effect_loop would.
+		 *
+		 * gs_effect_loop looks the technique up by name each time it is called, so render paths that draw every frame
+		 * resolve their techniques once when the effect is loaded and draw with this instead.
+		 */
+		template<typename T>
+		void draw(T&& fn)
+		{
+			gs_technique_t* technique = get();
+			if (!technique) {
+				return;
+			}
+
+			std::size_t passes = gs_technique_begin(technique);
+			for (std::size_t idx = 0; idx < passes; idx++) {
+				if (gs_technique_begin_pass(technique, idx)) {
+					fn();
+					gs_technique_end_pass(technique);
+				}
+			}
+			gs_technique_end(technique);
+		}
 	};
 } // namespace streamfx::obs::gs
@@ -6,9 +6,14 @@
 #include "gs-effect.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "util/util-platform.hpp"
+#include "util/util-threadpool.hpp"
 
 #include "warning-disable.hpp"
+#include <chrono>
 #include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
@@ -16,7 +21,13 @@
 
 #define MAX_EFFECT_SIZE 32 * 1024 * 1024 // 32 MiB, big enough for everything.
 
-static std::string load_file_as_code(const std::filesystem::path& shader_file, bool is_top_level = true)
+struct streamfx::obs::gs::effect::lookup_cache {
+	std::mutex                                                              lock;
+	std::map<std::string, streamfx::obs::gs::effect_parameter, std::less<>> parameters;
+	std::map<std::string, streamfx::obs::gs::effect_technique, std::less<>> techniques;
+};
+
+static std::string load_file_as_code(const std::filesystem::path& shader_file, bool is_top_level = true, const std::list<std::string>& defines = {})
 {
 	std::stringstream           shader_stream;
 	const std::filesystem::path shader_path = std::filesystem::absolute(shader_file.native());
@@ -46,6 +57,10 @@ static std::string load_file_as_code(const std::filesystem::path& shader_file, b
 			shader_stream << "#define GS_DEVICE_OPENGL" << std::endl;
 			break;
 		}
+
+		for (auto& define : defines) {
+			shader_stream << "#define " << define << std::endl;
+		}
 	}
 
 	// Pre-process the shader.
@@ -89,21 +104,76 @@ streamfx::obs::gs::effect::effect(std::string_view code, std::string_view name)
 {
 	auto gctx = streamfx::obs::gs::context();
 
+	// libOBS only accepts effect source and compiles it inside the graphics backend, so the best we can do is to tell
+	// where startup time goes.
+	auto         start        = std::chrono::high_resolution_clock::now();
 	char*        error_buffer = nullptr;
 	gs_effect_t* effect       = gs_effect_create(code.data(), name.data(), &error_buffer);
+	DLOG_DEBUG("Compiling effect '%s' took %" PRId64 "ms.", name.data(), static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count()));
 
 	if (!effect) {
 		throw error_buffer ? std::runtime_error(error_buffer) : std::runtime_error("Unknown error during effect compile.");
 	}
 
 	reset(effect, [](gs_effect_t* ptr) { gs_effect_destroy(ptr); });
+	_lookups = std::make_shared<lookup_cache>();
 }
 
 streamfx::obs::gs::effect::effect(std::filesystem::path file) : effect(load_file_as_code(file), streamfx::util::platform::utf8_to_native(std::filesystem::absolute(file)).generic_u8string()) {}
 
+streamfx::obs::gs::effect::effect(std::filesystem::path file, const std::list<std::string>& defines) : effect(load_file_as_code(file, true, defines), streamfx::util::platform::utf8_to_native(std::filesystem::absolute(file)).generic_u8string()) {}
+
+streamfx::obs::gs::effect streamfx::obs::gs::effect::create_shared(const std::filesystem::path& file, const std::list<std::string>& defines)
+{
+	static std::mutex                                        lock;
+	static std::map<std::string, std::weak_ptr<gs_effect_t>> cache;
+
+	// Expanding the includes is cheap compared to compiling, and catches changes to included files too.
+	std::string code = load_file_as_code(file, true, defines);
+	std::string name = streamfx::util::platform::utf8_to_native(std::filesystem::absolute(file)).generic_u8string();
+	std::string key  = std::filesystem::weakly_canonical(file).generic_u8string() + "|" + std::to_string(std::hash<std::string>{}(code));
+
+	streamfx::obs::gs::effect fx;
+	{
+		std::unique_lock<std::mutex> ul(lock);
+		for (auto iter = cache.begin(); iter != cache.end();) {
+			if (iter->second.expired()) {
+				iter = cache.erase(iter);
+			} else {
+				iter++;
+			}
+		}
+
+		if (auto kv = cache.find(key); kv != cache.end()) {
+			if (auto ptr = kv->second.lock(); ptr) {
+				static_cast<std::shared_ptr<gs_effect_t>&>(fx) = ptr;
+				fx._lookups                                     = std::make_shared<lookup_cache>();
+				return fx;
+			}
+		}
+	}
+
+	// Compile without holding the lock, as compiling requires the graphics context.
+	streamfx::obs::gs::effect compiled(code, name);
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (auto kv = cache.find(key); kv != cache.end()) {
+		if (auto ptr = kv->second.lock(); ptr) {
+			// Someone else was faster, use theirs so that there is only one.
+			static_cast<std::shared_ptr<gs_effect_t>&>(fx) = ptr;
+			fx._lookups                                     = std::make_shared<lookup_cache>();
+			return fx;
+		}
+	}
+	cache[key] = compiled;
+	return compiled;
+}
+
 streamfx::obs::gs::effect::~effect()
 {
+	// The cached parameters and techniques keep the effect alive too, so release them while we still hold the context.
 	auto gctx = streamfx::obs::gs::context();
+	_lookups.reset();
 	reset();
 }
 
@@ -123,14 +193,28 @@ streamfx::obs::gs::effect_technique streamfx::obs::gs::effect::get_technique(std
 
 streamfx::obs::gs::effect_technique streamfx::obs::gs::effect::get_technique(std::string_view name)
 {
+	// Same as with parameters, but callers that draw every frame should hold on to the technique instead.
+	if (_lookups) {
+		std::unique_lock<std::mutex> lock(_lookups->lock);
+		if (auto kv = _lookups->techniques.find(name); kv != _lookups->techniques.end()) {
+			return kv->second;
+		}
+	}
+
+	streamfx::obs::gs::effect_technique found = nullptr;
 	for (std::size_t idx = 0; idx < count_techniques(); idx++) {
 		auto ptr = get()->techniques.array + idx;
 		if (strcmp(ptr->name, name.data()) == 0) {
-			return streamfx::obs::gs::effect_technique(ptr, *this);
+			found = streamfx::obs::gs::effect_technique(ptr, *this);
+			break;
 		}
 	}
 
-	return nullptr;
+	if (_lookups) {
+		std::unique_lock<std::mutex> lock(_lookups->lock);
+		_lookups->techniques.emplace(std::string(name), found);
+	}
+	return found;
 }
 
 bool streamfx::obs::gs::effect::has_technique(std::string_view name)
@@ -156,14 +240,28 @@ streamfx::obs::gs::effect_parameter streamfx::obs::gs::effect::get_parameter(std
 
 streamfx::obs::gs::effect_parameter streamfx::obs::gs::effect::get_parameter(std::string_view name)
 {
+	// Most lookups happen every frame with the same names, so remember the result, even if there was none.
+	if (_lookups) {
+		std::unique_lock<std::mutex> lock(_lookups->lock);
+		if (auto kv = _lookups->parameters.find(name); kv != _lookups->parameters.end()) {
+			return kv->second;
+		}
+	}
+
+	streamfx::obs::gs::effect_parameter found = nullptr;
 	for (std::size_t idx = 0; idx < count_parameters(); idx++) {
 		auto ptr = get()->params.array + idx;
 		if (strcmp(ptr->name, name.data()) == 0) {
-			return streamfx::obs::gs::effect_parameter(ptr, *this);
+			found = streamfx::obs::gs::effect_parameter(ptr, *this);
+			break;
 		}
 	}
 
-	return nullptr;
+	if (_lookups) {
+		std::unique_lock<std::mutex> lock(_lookups->lock);
+		_lookups->parameters.emplace(std::string(name), found);
+	}
+	return found;
 }
 
 bool streamfx::obs::gs::effect::has_parameter(std::string_view name)
@@ -180,3 +278,53 @@ bool streamfx::obs::gs::effect::has_parameter(std::string_view name, effect_para
 		return eprm.get_type() == type;
 	return false;
 }
+
+struct streamfx::obs::gs::effect_loader::state {
+	std::mutex                lock;
+	bool                      started;
+	bool                      ready;
+	streamfx::obs::gs::effect effect;
+};
+
+streamfx::obs::gs::effect_loader::~effect_loader() {}
+
+streamfx::obs::gs::effect_loader::effect_loader(std::filesystem::path file, bool shared) : _file(std::move(file)), _shared(shared), _state(std::make_shared<state>()), _effect()
+{
+	_state->started = false;
+	_state->ready   = false;
+}
+
+streamfx::obs::gs::effect streamfx::obs::gs::effect_loader::get()
+{
+	if (_effect) {
+		return _effect;
+	}
+
+	std::unique_lock<std::mutex> ul(_state->lock);
+	if (_state->ready) {
+		_effect = std::move(_state->effect);
+		return _effect;
+	}
+	if (_state->started) {
+		return {};
+	}
+	_state->started = true;
+
+	// The task only holds on to the state, so the loader may go away while it is running.
+	std::shared_ptr<state> state  = _state;
+	std::filesystem::path  file   = _file;
+	bool                   shared = _shared;
+	streamfx::util::threadpool::threadpool::instance()->push([state, file, shared](streamfx::util::threadpool::task_data_t) {
+		streamfx::obs::gs::effect effect;
+		try {
+			effect = shared ? streamfx::obs::gs::effect::create_shared(file) : streamfx::obs::gs::effect(file);
+		} catch (const std::exception& ex) {
+			DLOG_ERROR("Loading effect '%s' failed with error: %s", file.u8string().c_str(), ex.what());
+		}
+
+		std::unique_lock<std::mutex> ul(state->lock);
+		state->effect = std::move(effect);
+		state->ready  = true;
+	});
+	return {};
+}
@@ -11,14 +11,22 @@
 #include "warning-disable.hpp"
 #include <filesystem>
 #include <list>
+#include <memory>
 #include "warning-enable.hpp"
 
 namespace streamfx::obs::gs {
 	class effect : public std::shared_ptr<gs_effect_t> {
+		// Parameter and technique lookups by name, shared by all copies of this effect.
+		struct lookup_cache;
+		std::shared_ptr<lookup_cache> _lookups;
+
 		public:
 		effect() = default;
 		effect(std::string_view code, std::string_view name);
 		effect(std::filesystem::path file);
+
+		/** Load an effect file as if each of the defines was written at its top, for compile time specialization. */
+		effect(std::filesystem::path file, const std::list<std::string>& defines);
 		~effect();
 
 		std::size_t                         count_techniques();
@@ -52,5 +60,33 @@ namespace streamfx::obs::gs {
 		{
 			return streamfx::obs::gs::effect(file);
 		};
+
+		/** Load an effect file, reusing the compiled effect of any other user of the same file and contents.
+		 *
+		 * Parameter values live in the shared effect, so users must assign every parameter they rely on before drawing.
+		 */
+		static streamfx::obs::gs::effect create_shared(const std::filesystem::path& file, const std::list<std::string>& defines = {});
+	};
+
+	/** Loads an effect file in the thread pool the first time it is asked for.
+	 *
+	 * get() never waits, and returns an empty effect until loading is done. Callers need something cheap to show in the
+	 * meantime, such as their input unchanged. A file that failed to load is logged once and not retried.
+	 */
+	class effect_loader {
+		struct state;
+		std::filesystem::path  _file;
+		bool                   _shared;
+		std::shared_ptr<state> _state;
+		effect                 _effect;
+
+		public:
+		~effect_loader();
+
+		/** @param shared Load through effect::create_shared, with the same rules for parameters. */
+		effect_loader(std::filesystem::path file, bool shared = false);
+
+		/** The effect if it finished loading, or an empty one otherwise. */
+		effect get();
 	};
 } // namespace streamfx::obs::gs
@@ -0,0 +1,42 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gs-handoff.hpp"
+
+// Requests nest as filters capture each other, the innermost one is the only one that can be answered.
+static thread_local streamfx::obs::gs::handoff* current = nullptr;
+
+streamfx::obs::gs::handoff::~handoff()
+{
+	current = _previous;
+}
+
+streamfx::obs::gs::handoff::handoff(obs_source_t* target, uint32_t width, uint32_t height, gs_color_format format) : _previous(current), _target(target), _width(width), _height(height), _format(format), _texture()
+{
+	current = this;
+}
+
+std::shared_ptr<streamfx::obs::gs::texture> streamfx::obs::gs::handoff::take()
+{
+	// Anything rendered after this point is no longer part of the capture.
+	if (current == this) {
+		current = _previous;
+	}
+	return std::move(_texture);
+}
+
+bool streamfx::obs::gs::handoff::offer(obs_source_t* self, std::shared_ptr<streamfx::obs::gs::texture> output)
+{
+	if (!current || (current->_target != self) || current->_texture || !output) {
+		return false;
+	}
+
+	// The capture would have been in the requested format and size, anything else has to be drawn to be converted.
+	if ((output->get_width() != current->_width) || (output->get_height() != current->_height) || (output->get_color_format() != current->_format)) {
+		return false;
+	}
+
+	current->_texture = std::move(output);
+	return true;
+}
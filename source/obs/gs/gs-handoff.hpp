@@ -0,0 +1,48 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <memory>
+#include "warning-enable.hpp"
+
+namespace streamfx::obs::gs {
+	/** Passes the output of a filter directly to the filter below it, instead of drawing it into a capture.
+	 *
+	 * Capturing the target of a filter makes OBS render the filter above it right away. If the capturing filter asked
+	 * for a handoff, the filter above may hand over its finished output instead of drawing it, and the capturing filter
+	 * skips drawing the capture. This saves two full size draws for every pair of adjacent StreamFX filters. A handed
+	 * over texture belongs to the filter above, and must not be kept past the current render. Graphics thread only.
+	 */
+	class handoff {
+		handoff* _previous;
+
+		obs_source_t*                                _target;
+		uint32_t                                     _width;
+		uint32_t                                     _height;
+		gs_color_format                              _format;
+		std::shared_ptr<streamfx::obs::gs::texture> _texture;
+
+		public:
+		~handoff();
+
+		/** Ask target to hand over its output, which must be a width by height texture of the given format. */
+		handoff(obs_source_t* target, uint32_t width, uint32_t height, gs_color_format format = GS_RGBA);
+
+		handoff(const handoff&)            = delete;
+		handoff& operator=(const handoff&) = delete;
+
+		/** Call after obs_source_process_filter_begin(). If this returns a texture, skip obs_source_process_filter_end(). */
+		std::shared_ptr<streamfx::obs::gs::texture> take();
+
+		/** Call while rendering instead of drawing the output; false if nobody asked for it, which means draw as usual.
+		 *
+		 * Only offer outputs that would otherwise be drawn unchanged with the default effect.
+		 */
+		static bool offer(obs_source_t* self, std::shared_ptr<streamfx::obs::gs::texture> output);
+	};
+} // namespace streamfx::obs::gs
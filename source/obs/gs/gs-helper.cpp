@@ -3,3 +3,29 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "gs-helper.hpp"
+
+void streamfx::obs::gs::push_blend_state(blend_preset preset)
+{
+	gs_blend_state_push();
+	gs_reset_blend_state();
+
+	switch (preset) {
+	case blend_preset::REPLACE:
+		gs_enable_blending(false);
+		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+		break;
+	case blend_preset::PREMULTIPLIED_ALPHA:
+		gs_enable_blending(true);
+		gs_blend_function_separate(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+		break;
+	}
+
+	gs_enable_color(true, true, true, true);
+	gs_enable_depth_test(false);
+	gs_depth_function(GS_ALWAYS);
+	gs_enable_stencil_test(false);
+	gs_enable_stencil_write(false);
+	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
+	gs_stencil_op(GS_STENCIL_BOTH, GS_KEEP, GS_KEEP, GS_KEEP);
+	gs_set_cull_mode(GS_NEITHER);
+}
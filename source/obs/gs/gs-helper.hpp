@@ -25,6 +25,20 @@ namespace streamfx::obs::gs {
 		}
 	};
 
+	enum class blend_preset {
+		/** Output overwrites the target: no blending, all channels written, no depth, stencil or culling. */
+		REPLACE,
+		/** Like REPLACE, but color is blended with premultiplied alpha and alpha is accumulated. */
+		PREMULTIPLIED_ALPHA,
+	};
+
+	/** Push the blend state and set up one of the common presets in its place.
+	 *
+	 * libobs has no way to query the current state, so a preset is the cheapest way to get a known one. Undo it with
+	 * gs_blend_state_pop() as usual.
+	 */
+	void push_blend_state(blend_preset preset);
+
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 	static constexpr float_t debug_color_white[4]           = {1.f, 1.f, 1.f, 1.f};
 	static constexpr float_t debug_color_gray[4]            = {.5f, .5f, .5f, 1.f};
@@ -0,0 +1,176 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gs-readback.hpp"
+#include "obs/gs/gs-helper.hpp"
+
+#include "warning-disable.hpp"
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+streamfx::obs::gs::readback::~readback()
+{
+	release();
+}
+
+streamfx::obs::gs::readback::readback(uint32_t width, uint32_t height, gs_color_format format, callback_t callback) : _width(width), _height(height), _format(format), _callback(callback), _rt(), _slots(), _index(0)
+{
+	if (!_callback) {
+		throw std::invalid_argument("callback");
+	}
+}
+
+bool streamfx::obs::gs::readback::stage(gs_texture_t* texture)
+{
+	auto     gctx = streamfx::obs::gs::context();
+	uint64_t now  = obs_get_video_frame_time();
+
+	collect();
+	if (!texture) {
+		return false;
+	}
+
+	// Only copy once per frame, even if we are rendered more often than that.
+	std::size_t previous = (_index + ring - 1) % ring;
+	if (_slots[previous].staged && (_slots[previous].timestamp == now)) {
+		return false;
+	}
+
+	uint32_t        texture_width  = gs_texture_get_width(texture);
+	uint32_t        texture_height = gs_texture_get_height(texture);
+	gs_color_format texture_format = gs_texture_get_color_format(texture);
+	uint32_t        width          = _width ? _width : texture_width;
+	uint32_t        height         = _height ? _height : texture_height;
+	gs_color_format format         = (_format != GS_UNKNOWN) ? _format : texture_format;
+	if ((width == 0) || (height == 0)) {
+		return false;
+	}
+
+	// Still not read back, but it is the oldest copy and the GPU had the most time to finish it, so mapping it waits briefly at most.
+	slot& entry = _slots[_index];
+	if (entry.staged) {
+		deliver(entry);
+	}
+
+	if (!entry.surface || (entry.width != width) || (entry.height != height) || (entry.format != format)) {
+		if (entry.surface) {
+			gs_stagesurface_destroy(entry.surface);
+		}
+		entry.surface = gs_stagesurface_create(width, height, format);
+		entry.width   = width;
+		entry.height  = height;
+		entry.format  = format;
+		if (!entry.surface) {
+			return false;
+		}
+	}
+
+	gs_texture_t* source = texture;
+	if ((texture_width != width) || (texture_height != height) || (texture_format != format)) {
+		if (!_rt || (_rt->get_color_format() != format)) {
+			_rt = std::make_shared<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+		}
+
+		{
+			auto op = _rt->render(width, height);
+			gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), -1., 1.);
+
+			streamfx::obs::gs::push_blend_state(streamfx::obs::gs::blend_preset::REPLACE);
+			gs_effect_t* effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+			gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), texture);
+			while (gs_effect_loop(effect, "Draw")) {
+				gs_draw_sprite(texture, 0, width, height);
+			}
+			gs_blend_state_pop();
+		}
+
+		source = _rt->get_object();
+	}
+
+	gs_stage_texture(entry.surface, source);
+	entry.timestamp = now;
+	entry.staged    = true;
+	_index          = (_index + 1) % ring;
+	return true;
+}
+
+void streamfx::obs::gs::readback::collect()
+{
+	auto     gctx = streamfx::obs::gs::context();
+	uint64_t now  = obs_get_video_frame_time();
+	uint64_t age  = latency * obs_get_frame_interval_ns();
+
+	// Oldest first, so that copies are delivered in the order they were staged.
+	for (std::size_t idx = 0; idx < ring; idx++) {
+		slot& entry = _slots[(_index + idx) % ring];
+		if (entry.staged && ((now - entry.timestamp) >= age)) {
+			deliver(entry);
+		}
+	}
+}
+
+void streamfx::obs::gs::readback::flush()
+{
+	auto gctx = streamfx::obs::gs::context();
+	for (std::size_t idx = 0; idx < ring; idx++) {
+		slot& entry = _slots[(_index + idx) % ring];
+		if (entry.staged) {
+			deliver(entry);
+		}
+	}
+}
+
+std::size_t streamfx::obs::gs::readback::pending()
+{
+	std::size_t count = 0;
+	for (auto& entry : _slots) {
+		if (entry.staged) {
+			count++;
+		}
+	}
+	return count;
+}
+
+void streamfx::obs::gs::readback::release()
+{
+	if (!_rt && !_slots[0].surface) {
+		return;
+	}
+
+	auto gctx = streamfx::obs::gs::context();
+	for (auto& entry : _slots) {
+		if (entry.surface) {
+			gs_stagesurface_destroy(entry.surface);
+		}
+		entry = slot();
+	}
+	_rt.reset();
+	_index = 0;
+}
+
+void streamfx::obs::gs::readback::deliver(slot& entry)
+{
+	entry.staged = false;
+
+	uint8_t* data     = nullptr;
+	uint32_t linesize = 0;
+	if (!gs_stagesurface_map(entry.surface, &data, &linesize)) {
+		return;
+	}
+
+	frame info     = {};
+	info.timestamp = entry.timestamp;
+	info.width     = entry.width;
+	info.height    = entry.height;
+	info.linesize  = linesize;
+	info.format    = entry.format;
+	info.data      = data;
+	try {
+		_callback(info);
+	} catch (...) {
+		gs_stagesurface_unmap(entry.surface);
+		throw;
+	}
+	gs_stagesurface_unmap(entry.surface);
+}
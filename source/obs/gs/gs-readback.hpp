@@ -0,0 +1,88 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gs-rendertarget.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <functional>
+#include <memory>
+#include "warning-enable.hpp"
+
+namespace streamfx::obs::gs {
+	/** Reads textures back to the CPU without waiting for the GPU.
+	 *
+	 * Textures are copied into a ring of staging surfaces, which are only mapped once the GPU had a few frames to finish
+	 * the copy. If the texture doesn't match the requested size or format, it is drawn into a render target of that size
+	 * and format first, so that only what is actually needed crosses the bus. Graphics thread only.
+	 */
+	class readback {
+		public:
+		static constexpr std::size_t ring    = 3;        // Staging surfaces in flight.
+		static constexpr uint64_t    latency = ring - 1; // Frames after which a copy is read back.
+
+		struct frame {
+			uint64_t        timestamp; // Video frame time at which the copy was staged.
+			uint32_t        width;
+			uint32_t        height;
+			uint32_t        linesize;
+			gs_color_format format;
+			const uint8_t*  data; // Only valid during the callback.
+		};
+
+		/** Called with each finished copy, in order. Copy what is needed and hand the work to the thread pool. */
+		typedef std::function<void(const frame&)> callback_t;
+
+		private:
+		struct slot {
+			gs_stagesurf_t* surface   = nullptr;
+			uint32_t        width     = 0;
+			uint32_t        height    = 0;
+			gs_color_format format    = GS_UNKNOWN;
+			uint64_t        timestamp = 0;
+			bool            staged    = false;
+		};
+
+		uint32_t        _width;
+		uint32_t        _height;
+		gs_color_format _format;
+		callback_t      _callback;
+
+		std::shared_ptr<streamfx::obs::gs::rendertarget> _rt;
+		std::array<slot, ring>                           _slots;
+		std::size_t                                      _index;
+
+		public:
+		~readback();
+
+		/** Read back copies of width by height in the given format. Zeros and GS_UNKNOWN keep the texture's own. */
+		readback(uint32_t width, uint32_t height, gs_color_format format, callback_t callback);
+
+		readback(const readback&)            = delete;
+		readback& operator=(const readback&) = delete;
+
+		/** Queue a copy of the texture, at most once per frame. Also delivers the copies that are ready.
+		 *
+		 * Returns false if this frame already has a copy, or no copy could be made.
+		 */
+		bool stage(gs_texture_t* texture);
+
+		/** Deliver the copies that are ready, for frames in which there is nothing new to copy. */
+		void collect();
+
+		/** Deliver every pending copy right away, which waits for the GPU to finish them. */
+		void flush();
+
+		/** Copies which have not been delivered yet. */
+		std::size_t pending();
+
+		/** Release all graphics resources and drop pending copies, for when nothing is read back for a while. */
+		void release();
+
+		private:
+		void deliver(slot& entry);
+	};
+} // namespace streamfx::obs::gs
@@ -5,6 +5,7 @@
 
 #include "gs-rendertarget.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-readback.hpp"
 
 #include "warning-disable.hpp"
 #include <stdexcept>
@@ -16,7 +17,7 @@ streamfx::obs::gs::rendertarget::~rendertarget()
 	gs_texrender_destroy(_render_target);
 }
 
-streamfx::obs::gs::rendertarget::rendertarget(gs_color_format colorFormat, gs_zstencil_format zsFormat) : _color_format(colorFormat), _zstencil_format(zsFormat)
+streamfx::obs::gs::rendertarget::rendertarget(gs_color_format colorFormat, gs_zstencil_format zsFormat) : _color_format(colorFormat), _zstencil_format(zsFormat), _vram(::streamfx::gfx::vram::kind::RENDERTARGET)
 {
 	_is_being_rendered = false;
 	auto gctx          = streamfx::obs::gs::context();
@@ -73,6 +74,11 @@ gs_zstencil_format streamfx::obs::gs::rendertarget::get_zstencil_format()
 	return _zstencil_format;
 }
 
+bool streamfx::obs::gs::rendertarget::read_back(streamfx::obs::gs::readback& target)
+{
+	return target.stage(get_object());
+}
+
 streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertarget* rt, uint32_t width, uint32_t height) : parent(rt)
 {
 	if (parent == nullptr)
@@ -86,6 +92,7 @@ streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertar
 		throw std::runtime_error("Failed to begin rendering to render target.");
 	}
 	parent->_is_being_rendered = true;
+	parent->_vram.resize(::streamfx::gfx::vram::texture_size(parent->_color_format, width, height) + ::streamfx::gfx::vram::zstencil_size(parent->_zstencil_format, width, height));
 }
 
 streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertarget* rt, uint32_t width, uint32_t height, gs_color_space cs) : parent(rt)
@@ -101,6 +108,7 @@ streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertar
 		throw std::runtime_error("Failed to begin rendering to render target.");
 	}
 	parent->_is_being_rendered = true;
+	parent->_vram.resize(::streamfx::gfx::vram::texture_size(parent->_color_format, width, height) + ::streamfx::gfx::vram::zstencil_size(parent->_zstencil_format, width, height));
 }
 
 streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertarget_op&& r) noexcept
@@ -8,6 +8,7 @@
 #include "gs-texture.hpp"
 
 namespace streamfx::obs::gs {
+	class readback;
 	class rendertarget_op;
 
 	class rendertarget {
@@ -20,6 +21,8 @@ namespace streamfx::obs::gs {
 		gs_color_format    _color_format;
 		gs_zstencil_format _zstencil_format;
 
+		::streamfx::gfx::vram::allocation _vram; // Follows the size last rendered at.
+
 		public:
 		~rendertarget();
 
@@ -39,6 +42,9 @@ namespace streamfx::obs::gs {
 
 		gs_zstencil_format get_zstencil_format();
 
+		/** Queue a copy of the current content for reading back, see readback::stage(). */
+		bool read_back(streamfx::obs::gs::readback& target);
+
 		streamfx::obs::gs::rendertarget_op render(uint32_t width, uint32_t height);
 
 		streamfx::obs::gs::rendertarget_op render(uint32_t width, uint32_t height, gs_color_space cs);
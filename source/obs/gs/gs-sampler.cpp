@@ -3,9 +3,13 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "gs-sampler.hpp"
+#include "obs/gs/gs-helper.hpp"
 
 #include "warning-disable.hpp"
+#include <map>
+#include <mutex>
 #include <stdexcept>
+#include <tuple>
 #include "warning-enable.hpp"
 
 streamfx::obs::gs::sampler::sampler()
@@ -15,10 +19,38 @@ streamfx::obs::gs::sampler::sampler()
 	_sampler_state = nullptr;
 }
 
+streamfx::obs::gs::sampler::sampler(const gs_sampler_info& info) : sampler()
+{
+	_sampler_info = info;
+}
+
 streamfx::obs::gs::sampler::~sampler()
 {
-	if (_sampler_state)
+	if (_sampler_state) {
+		// Shared samplers go away with whoever held on to them last, which may be outside of a graphics context.
+		streamfx::obs::gs::context gctx;
 		gs_samplerstate_destroy(_sampler_state);
+	}
+}
+
+std::shared_ptr<streamfx::obs::gs::sampler> streamfx::obs::gs::sampler::get(gs_sample_filter filter, gs_address_mode address_u, gs_address_mode address_v, gs_address_mode address_w, int32_t max_anisotropy, uint32_t border_color)
+{
+	typedef std::tuple<gs_sample_filter, gs_address_mode, gs_address_mode, gs_address_mode, int32_t, uint32_t> key_t;
+
+	static std::map<key_t, std::weak_ptr<streamfx::obs::gs::sampler>> instances;
+	static std::mutex                                                 lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	key_t                        key{filter, address_u, address_v, address_w, max_anisotropy, border_color};
+	if (auto kv = instances.find(key); kv != instances.end()) {
+		if (auto instance = kv->second.lock(); instance) {
+			return instance;
+		}
+	}
+
+	auto instance = std::make_shared<streamfx::obs::gs::sampler>(gs_sampler_info{filter, address_u, address_v, address_w, max_anisotropy, border_color});
+	instances.insert_or_assign(key, instance);
+	return instance;
 }
 
 void streamfx::obs::gs::sampler::set_filter(gs_sample_filter v)
@@ -5,12 +5,23 @@
 #pragma once
 #include "common.hpp"
 
+#include "warning-disable.hpp"
+#include <memory>
+#include "warning-enable.hpp"
+
 namespace streamfx::obs::gs {
 	class sampler {
 		public:
 		sampler();
+		sampler(const gs_sampler_info& info);
 		~sampler();
 
+		/** Shared sampler with the given settings, so that instances don't each create an identical one.
+		 *
+		 * The returned sampler is shared with everyone else who asked for the same settings, and must not be changed.
+		 */
+		static std::shared_ptr<streamfx::obs::gs::sampler> get(gs_sample_filter filter, gs_address_mode address_u, gs_address_mode address_v, gs_address_mode address_w = GS_ADDRESS_WRAP, int32_t max_anisotropy = 1, uint32_t border_color = 0);
+
 		void             set_filter(gs_sample_filter v);
 		gs_sample_filter get_filter();
 
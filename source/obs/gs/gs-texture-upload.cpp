@@ -0,0 +1,160 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gs-texture-upload.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <cstring>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+streamfx::obs::gs::texture_upload::~texture_upload()
+{
+	// Fills that are still running hold on to their own reference, and are thrown away once they finish.
+	{
+		std::unique_lock<std::mutex> ul(_shared->lock);
+		_shared->deferred = nullptr;
+	}
+
+	if (_texture) {
+		auto gctx = streamfx::obs::gs::context();
+		_texture.reset();
+	}
+}
+
+streamfx::obs::gs::texture_upload::texture_upload() : _shared(std::make_shared<shared>()), _texture() {}
+
+void streamfx::obs::gs::texture_upload::submit(producer_t producer)
+{
+	if (!producer) {
+		throw std::invalid_argument("producer");
+	}
+
+	std::unique_lock<std::mutex> ul(_shared->lock);
+	if (!start(producer)) {
+		// Replaces any older request that was waiting, nobody would get to see it anyway.
+		_shared->deferred = std::move(producer);
+	}
+}
+
+void streamfx::obs::gs::texture_upload::submit_file(const std::string& file)
+{
+	submit([file](staging& buffer) {
+		gs_color_format format = GS_UNKNOWN;
+		uint32_t        width  = 0;
+		uint32_t        height = 0;
+		uint8_t*        data   = gs_create_texture_file_data(file.c_str(), &format, &width, &height);
+		if (!data) {
+			DLOG_ERROR("Failed to load image '%s'.", file.c_str());
+			return false;
+		}
+
+		buffer.width    = width;
+		buffer.height   = height;
+		buffer.format   = format;
+		buffer.linesize = width * gs_get_format_bpp(format) / 8;
+		buffer.data.resize(static_cast<std::size_t>(buffer.linesize) * height);
+		memcpy(buffer.data.data(), data, buffer.data.size());
+		bfree(data);
+		return true;
+	});
+}
+
+bool streamfx::obs::gs::texture_upload::update()
+{
+	slot* newest = nullptr;
+	{
+		std::unique_lock<std::mutex> ul(_shared->lock);
+		for (auto& entry : _shared->slots) {
+			if (entry.state != status::Ready) {
+				continue;
+			}
+
+			if (entry.sequence <= _shared->committed) {
+				// Something newer was already copied.
+				entry.state = status::Free;
+			} else if (!newest || (entry.sequence > newest->sequence)) {
+				newest = &entry;
+			}
+		}
+
+		if (newest) {
+			for (auto& entry : _shared->slots) {
+				if ((entry.state == status::Ready) && (&entry != newest)) {
+					entry.state = status::Free;
+				}
+			}
+			newest->state      = status::Uploading;
+			_shared->committed = newest->sequence;
+		}
+
+		if (_shared->deferred && start(_shared->deferred)) {
+			_shared->deferred = nullptr;
+		}
+	}
+	if (!newest) {
+		return false;
+	}
+
+	// Nobody else touches a slot that is being uploaded, so the copy happens without holding the lock.
+	bool     changed = false;
+	staging& buffer  = newest->buffer;
+	if ((buffer.width > 0) && (buffer.height > 0) && (buffer.data.size() >= (static_cast<std::size_t>(buffer.linesize) * buffer.height))) {
+		try {
+			auto gctx = streamfx::obs::gs::context();
+			if (!_texture || (_texture->get_width() != buffer.width) || (_texture->get_height() != buffer.height) || (_texture->get_color_format() != buffer.format)) {
+				_texture = std::make_shared<streamfx::obs::gs::texture>(buffer.width, buffer.height, buffer.format, 1, nullptr, streamfx::obs::gs::texture::flags::Dynamic);
+			}
+			gs_texture_set_image(_texture->get_object(), buffer.data.data(), buffer.linesize, false);
+			changed = true;
+		} catch (const std::exception& ex) {
+			DLOG_ERROR("Failed to upload %" PRIu32 "x%" PRIu32 " texture: %s", buffer.width, buffer.height, ex.what());
+		}
+	}
+
+	std::unique_lock<std::mutex> ul(_shared->lock);
+	newest->state = status::Free;
+	return changed;
+}
+
+std::shared_ptr<streamfx::obs::gs::texture> streamfx::obs::gs::texture_upload::get_texture()
+{
+	return _texture;
+}
+
+bool streamfx::obs::gs::texture_upload::start(producer_t& producer)
+{
+	// Prefer an unused buffer, otherwise overwrite the oldest content that hasn't been copied yet.
+	slot* target = nullptr;
+	for (auto& entry : _shared->slots) {
+		if (entry.state == status::Free) {
+			target = &entry;
+			break;
+		} else if ((entry.state == status::Ready) && (!target || (entry.sequence < target->sequence))) {
+			target = &entry;
+		}
+	}
+	if (!target) {
+		return false;
+	}
+
+	target->state    = status::Filling;
+	target->sequence = ++_shared->submitted;
+
+	std::shared_ptr<shared> state = _shared;
+	streamfx::util::threadpool::threadpool::instance()->push([state, target, producer = std::move(producer)](streamfx::util::threadpool::task_data_t) {
+		bool filled = false;
+		try {
+			filled = producer(target->buffer);
+		} catch (const std::exception& ex) {
+			DLOG_ERROR("Failed to produce texture content: %s", ex.what());
+		}
+
+		std::unique_lock<std::mutex> ul(state->lock);
+		target->state = filled ? status::Ready : status::Free;
+	});
+	return true;
+}
@@ -0,0 +1,96 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gs-texture.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::obs::gs {
+	/** Updates a texture without the graphics thread ever waiting for the content.
+	 *
+	 * New content is produced on the thread pool into one of a ring of staging buffers, and copied into the texture by
+	 * the next call to update(), which should happen once at the start of a frame. Only the newest finished content is
+	 * ever copied, content that was overtaken by newer content before it could be copied is skipped. The texture is
+	 * dynamic so that the copy writes into fresh memory instead of waiting for the GPU to stop using the old content.
+	 */
+	class texture_upload {
+		public:
+		static constexpr std::size_t ring = 3;
+
+		/** Content to upload, rows are linesize bytes apart. */
+		struct staging {
+			uint32_t             width    = 0;
+			uint32_t             height   = 0;
+			uint32_t             linesize = 0;
+			gs_color_format      format   = GS_UNKNOWN;
+			std::vector<uint8_t> data;
+		};
+
+		/** Fills the staging buffer on the thread pool, returns false if there is no new content after all.
+		 *
+		 * The buffer still holds whatever it was last filled with, so that its memory can be reused.
+		 */
+		typedef std::function<bool(staging&)> producer_t;
+
+		private:
+		enum class status : uint8_t {
+			Free,
+			Filling,
+			Ready,
+			Uploading,
+		};
+
+		struct slot {
+			status   state    = status::Free;
+			uint64_t sequence = 0;
+			staging  buffer;
+		};
+
+		struct shared {
+			std::mutex             lock;
+			std::array<slot, ring> slots;
+			uint64_t               submitted = 0;
+			uint64_t               committed = 0;
+			producer_t             deferred;
+		};
+
+		std::shared_ptr<shared>                     _shared;
+		std::shared_ptr<streamfx::obs::gs::texture> _texture;
+
+		public:
+		~texture_upload();
+		texture_upload();
+
+		texture_upload(const texture_upload&)            = delete;
+		texture_upload& operator=(const texture_upload&) = delete;
+
+		/** Queue new content. If every staging buffer is busy, the newest request waits for the next update(). */
+		void submit(producer_t producer);
+
+		/** Queue the decoded content of an image file. */
+		void submit_file(const std::string& file);
+
+		/** Copy the newest finished content into the texture. Returns true if the content changed.
+		 *
+		 * The texture is replaced if the size or format changed, so anyone holding on to the previous one keeps the
+		 * content it had. Takes the graphics context.
+		 */
+		bool update();
+
+		/** The texture with the newest content copied so far, or nullptr if there wasn't any yet. */
+		std::shared_ptr<streamfx::obs::gs::texture> get_texture();
+
+		private:
+		bool start(producer_t& producer);
+	};
+} // namespace streamfx::obs::gs
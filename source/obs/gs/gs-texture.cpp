@@ -6,6 +6,7 @@
 #include "obs/gs/gs-helper.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
 #include <fstream>
 #include <stdexcept>
 #include <sys/stat.h>
@@ -22,9 +23,21 @@ static uint32_t decode_flags(streamfx::obs::gs::texture::flags texture_flags)
 		flags |= GS_SHARED_TEX;
 	if (has(texture_flags, streamfx::obs::gs::texture::flags::GlobalShared))
 		flags |= GS_SHARED_KM_TEX;
+	if (has(texture_flags, streamfx::obs::gs::texture::flags::RenderTarget))
+		flags |= GS_RENDER_TARGET;
 	return flags;
 }
 
+// Levels of a full mip chain, which is what GS_BUILD_MIPMAPS creates.
+static uint32_t mip_levels_of(uint32_t width, uint32_t height, uint32_t depth)
+{
+	uint32_t levels = 1;
+	for (uint32_t size = std::max(std::max(width, height), depth); size > 1; size >>= 1) {
+		levels++;
+	}
+	return levels;
+}
+
 streamfx::obs::gs::texture::texture(uint32_t width, uint32_t height, gs_color_format format, uint32_t mip_levels, const uint8_t** mip_data, streamfx::obs::gs::texture::flags texture_flags)
 {
 	if (width == 0)
@@ -49,6 +62,7 @@ streamfx::obs::gs::texture::texture(uint32_t width, uint32_t height, gs_color_fo
 		throw std::runtime_error("Failed to create texture.");
 
 	_type = type::Normal;
+	_vram = std::make_shared<::streamfx::gfx::vram::allocation>(::streamfx::gfx::vram::kind::TEXTURE, ::streamfx::gfx::vram::texture_size(format, width, height, 1, has(texture_flags, flags::BuildMipMaps) ? mip_levels_of(width, height, 1) : mip_levels));
 }
 
 streamfx::obs::gs::texture::texture(uint32_t width, uint32_t height, uint32_t depth, gs_color_format format, uint32_t mip_levels, const uint8_t** mip_data, streamfx::obs::gs::texture::flags texture_flags)
@@ -77,6 +91,7 @@ streamfx::obs::gs::texture::texture(uint32_t width, uint32_t height, uint32_t de
 		throw std::runtime_error("Failed to create texture.");
 
 	_type = type::Volume;
+	_vram = std::make_shared<::streamfx::gfx::vram::allocation>(::streamfx::gfx::vram::kind::TEXTURE, ::streamfx::gfx::vram::texture_size(format, width, height, depth, has(texture_flags, flags::BuildMipMaps) ? mip_levels_of(width, height, depth) : mip_levels));
 }
 
 streamfx::obs::gs::texture::texture(uint32_t size, gs_color_format format, uint32_t mip_levels, const uint8_t** mip_data, streamfx::obs::gs::texture::flags texture_flags)
@@ -101,6 +116,7 @@ streamfx::obs::gs::texture::texture(uint32_t size, gs_color_format format, uint3
 		throw std::runtime_error("Failed to create texture.");
 
 	_type = type::Cube;
+	_vram = std::make_shared<::streamfx::gfx::vram::allocation>(::streamfx::gfx::vram::kind::TEXTURE, ::streamfx::gfx::vram::texture_size(format, size, size, 1, has(texture_flags, flags::BuildMipMaps) ? mip_levels_of(size, size, 1) : mip_levels) * 6);
 }
 
 streamfx::obs::gs::texture::texture(std::string file)
@@ -114,6 +130,8 @@ streamfx::obs::gs::texture::texture(std::string file)
 
 	if (!_texture)
 		throw std::runtime_error("Failed to load texture.");
+
+	_vram = std::make_shared<::streamfx::gfx::vram::allocation>(::streamfx::gfx::vram::kind::TEXTURE, ::streamfx::gfx::vram::texture_size(gs_texture_get_color_format(_texture), gs_texture_get_width(_texture), gs_texture_get_height(_texture)));
 }
 
 streamfx::obs::gs::texture::~texture()
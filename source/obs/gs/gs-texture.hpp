@@ -4,6 +4,7 @@
 
 #pragma once
 #include "common.hpp"
+#include "gfx/gfx-vram.hpp"
 
 namespace streamfx::obs::gs {
 	class texture {
@@ -11,11 +12,12 @@ namespace streamfx::obs::gs {
 		enum class type : uint8_t { Normal, Volume, Cube };
 
 		enum class flags : uint8_t {
-			None,
-			Dynamic,
-			BuildMipMaps,
-			Shared,
-			GlobalShared,
+			None         = 0,
+			Dynamic      = 1 << 0,
+			BuildMipMaps = 1 << 1,
+			Shared       = 1 << 2,
+			GlobalShared = 1 << 3,
+			RenderTarget = 1 << 4,
 		};
 
 		protected:
@@ -23,6 +25,9 @@ namespace streamfx::obs::gs {
 		bool          _is_owner = true;
 		type          _type     = type::Normal;
 
+		// Shared, as textures that don't own their object are copied around.
+		std::shared_ptr<::streamfx::gfx::vram::allocation> _vram;
+
 		public:
 		~texture();
 
@@ -0,0 +1,126 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gs-timer.hpp"
+#include "obs/gs/gs-helper.hpp"
+
+streamfx::obs::gs::timer::~timer()
+{
+	release();
+}
+
+streamfx::obs::gs::timer::timer() : _queries(), _index(0), _active(false), _supported(true), _latest(0), _timings(), _aggregate(nullptr)
+{
+	for (auto& entry : _queries) {
+		entry = {nullptr, nullptr, false};
+	}
+}
+
+void streamfx::obs::gs::timer::aggregate(::streamfx::util::histogram* histogram)
+{
+	_aggregate = histogram;
+}
+
+void streamfx::obs::gs::timer::begin()
+{
+	if (!_supported || _active) {
+		return;
+	}
+
+	collect();
+
+	// The GPU hasn't finished the oldest measurement yet, skip this one instead of waiting.
+	auto& entry = _queries[_index];
+	if (entry.pending) {
+		return;
+	}
+
+	if (!entry.range) {
+		entry.range = gs_timer_range_create();
+		entry.timer = gs_timer_create();
+		if (!entry.range || !entry.timer) {
+			// Not every graphics backend has timestamp queries.
+			_supported = false;
+			release();
+			return;
+		}
+	}
+
+	gs_timer_range_begin(entry.range);
+	gs_timer_begin(entry.timer);
+	_active = true;
+}
+
+void streamfx::obs::gs::timer::end()
+{
+	if (!_active) {
+		return;
+	}
+
+	auto& entry = _queries[_index];
+	gs_timer_end(entry.timer);
+	gs_timer_range_end(entry.range);
+	entry.pending = true;
+	_active       = false;
+	_index        = (_index + 1) % ring;
+}
+
+std::chrono::nanoseconds streamfx::obs::gs::timer::latest() const
+{
+	return std::chrono::nanoseconds(_latest.load(std::memory_order_relaxed));
+}
+
+const streamfx::util::histogram& streamfx::obs::gs::timer::timings() const
+{
+	return _timings;
+}
+
+void streamfx::obs::gs::timer::collect()
+{
+	// Oldest first, so that the newest result is the one that stays in _latest.
+	for (std::size_t offset = 0; offset < ring; offset++) {
+		auto& entry = _queries[(_index + offset) % ring];
+		if (!entry.pending) {
+			continue;
+		}
+
+		bool     disjoint  = false;
+		uint64_t frequency = 0;
+		uint64_t ticks     = 0;
+		if (!gs_timer_range_get_data(entry.range, &disjoint, &frequency) || !gs_timer_get_data(entry.timer, &ticks)) {
+			continue;
+		}
+		entry.pending = false;
+
+		// Disjoint means the clock changed in between, such as from power management, which makes ticks meaningless.
+		if (disjoint || (frequency == 0)) {
+			continue;
+		}
+
+		auto duration = std::chrono::nanoseconds(static_cast<int64_t>((static_cast<double_t>(ticks) * 1000000000.) / static_cast<double_t>(frequency)));
+		_latest.store(duration.count(), std::memory_order_relaxed);
+		_timings.track(duration);
+		if (_aggregate) {
+			_aggregate->track(duration);
+		}
+	}
+}
+
+void streamfx::obs::gs::timer::release()
+{
+	if (!_queries[0].range && !_queries[0].timer) {
+		return;
+	}
+
+	auto gctx = streamfx::obs::gs::context();
+	for (auto& entry : _queries) {
+		if (entry.timer) {
+			gs_timer_destroy(entry.timer);
+		}
+		if (entry.range) {
+			gs_timer_range_destroy(entry.range);
+		}
+		entry = {nullptr, nullptr, false};
+	}
+}
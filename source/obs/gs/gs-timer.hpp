@@ -0,0 +1,80 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "util/util-profiler.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include "warning-enable.hpp"
+
+namespace streamfx::obs::gs {
+	/** GPU time spent between begin() and end(), measured with timestamp queries.
+	 *
+	 * Queries are read back a few frames late from a small ring, so measuring never waits for the GPU. If the GPU is
+	 * further behind than that, the frame simply isn't measured. Graphics thread only, except for the results.
+	 */
+	class timer {
+		static constexpr std::size_t ring = 4;
+
+		struct query {
+			gs_timer_range_t* range;
+			gs_timer_t*       timer;
+			bool              pending;
+		};
+
+		std::array<query, ring>      _queries;
+		std::size_t                  _index;
+		bool                         _active;
+		bool                         _supported;
+		std::atomic<int64_t>         _latest; // Nanoseconds, read from other threads.
+		::streamfx::util::histogram  _timings;
+		::streamfx::util::histogram* _aggregate;
+
+		public:
+		class scope {
+			timer* _parent;
+
+			public:
+			scope(timer& parent) : _parent(&parent)
+			{
+				_parent->begin();
+			}
+			~scope()
+			{
+				_parent->end();
+			}
+		};
+
+		public:
+		~timer();
+		timer();
+
+		/** Also track every measurement in the given histogram, which has to outlive us. */
+		void aggregate(::streamfx::util::histogram* histogram);
+
+		void begin();
+
+		void end();
+
+		/** Measure until the returned object goes out of scope. */
+		scope track()
+		{
+			return scope(*this);
+		}
+
+		/** Most recent measurement that was read back. */
+		std::chrono::nanoseconds latest() const;
+
+		const ::streamfx::util::histogram& timings() const;
+
+		private:
+		void collect();
+
+		void release();
+	};
+} // namespace streamfx::obs::gs
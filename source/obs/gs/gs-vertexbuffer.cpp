@@ -8,6 +8,9 @@
 
 #include "warning-disable.hpp"
 #include <stdexcept>
+#if defined(D_PLATFORM_INSTR_X86)
+#include <immintrin.h>
+#endif
 #include "warning-enable.hpp"
 
 void streamfx::obs::gs::vertex_buffer::initialize(uint32_t capacity, uint8_t layers)
@@ -20,6 +23,8 @@ void streamfx::obs::gs::vertex_buffer::initialize(uint32_t capacity, uint8_t lay
 	if (layers > MAXIMUM_UVW_LAYERS) {
 		throw std::out_of_range("layers");
 	}
+	_capacity = capacity;
+	_layers   = layers;
 
 	// Allocate memory for data.
 	_data          = std::make_shared<decltype(_data)::element_type>();
@@ -47,26 +52,35 @@ void streamfx::obs::gs::vertex_buffer::initialize(uint32_t capacity, uint8_t lay
 		}
 	}
 
-	// Allocate actual GPU vertex buffer.
-	{
-		auto gctx = streamfx::obs::gs::context();
-		_buffer   = decltype(_buffer)(gs_vertexbuffer_create(_data.get(), GS_DYNAMIC | GS_DUP_BUFFER), [this](gs_vertbuffer_t* v) {
+	// Allocate actual GPU vertex buffer, the rest of the ring is only created once it is needed.
+	_index      = 0;
+	_flushed    = false;
+	_buffers[0] = create_buffer();
+}
+
+std::shared_ptr<gs_vertbuffer_t> streamfx::obs::gs::vertex_buffer::create_buffer()
+{
+	auto                             gctx = streamfx::obs::gs::context();
+	std::shared_ptr<gs_vertbuffer_t> buffer;
+	if (gs_vertbuffer_t* vb = gs_vertexbuffer_create(_data.get(), GS_DYNAMIC | GS_DUP_BUFFER); vb) {
+		gs_vb_data* obs_data = gs_vertexbuffer_get_data(vb);
+		buffer               = std::shared_ptr<gs_vertbuffer_t>(vb, [obs_data](gs_vertbuffer_t* v) {
             try {
                 auto gctx = streamfx::obs::gs::context();
                 gs_vertexbuffer_destroy(v);
             } catch (...) {
                 if (obs_get_version() < MAKE_SEMANTIC_VERSION(26, 0, 0)) {
                     // Fixes a memory leak with OBS Studio versions older than 26.x.
-                    gs_vbdata_destroy(_obs_data);
+                    gs_vbdata_destroy(obs_data);
                 }
             }
         });
-		_obs_data = gs_vertexbuffer_get_data(_buffer.get());
 	}
 
-	if (!_buffer) {
+	if (!buffer) {
 		throw std::runtime_error("Failed to create vertex buffer.");
 	}
+	return buffer;
 }
 
 void streamfx::obs::gs::vertex_buffer::finalize()
@@ -81,7 +95,9 @@ void streamfx::obs::gs::vertex_buffer::finalize()
 		streamfx::util::free_aligned(_uvs[n]);
 	}
 
-	_buffer.reset();
+	for (auto& buffer : _buffers) {
+		buffer.reset();
+	}
 	_data.reset();
 }
 
@@ -93,11 +109,9 @@ streamfx::obs::gs::vertex_buffer::~vertex_buffer()
 streamfx::obs::gs::vertex_buffer::vertex_buffer(uint32_t size, uint8_t layers)
 	: _capacity(size), _size(size), _layers(layers),
 
-	  _buffer(nullptr), _data(nullptr),
-
-	  _positions(nullptr), _normals(nullptr), _tangents(nullptr), _colors(nullptr), _uv_layers(nullptr), _uvs(),
+	  _buffers(), _index(0), _flushed(false), _data(nullptr),
 
-	  _obs_data(nullptr)
+	  _positions(nullptr), _normals(nullptr), _tangents(nullptr), _colors(nullptr), _uv_layers(nullptr), _uvs()
 {
 	initialize(_size, _layers);
 }
@@ -105,11 +119,9 @@ streamfx::obs::gs::vertex_buffer::vertex_buffer(uint32_t size, uint8_t layers)
 streamfx::obs::gs::vertex_buffer::vertex_buffer(gs_vertbuffer_t* vb)
 	: _capacity(0), _size(0), _layers(0),
 
-	  _buffer(nullptr), _data(nullptr),
-
-	  _positions(nullptr), _normals(nullptr), _tangents(nullptr), _colors(nullptr), _uv_layers(nullptr), _uvs(),
+	  _buffers(), _index(0), _flushed(false), _data(nullptr),
 
-	  _obs_data(nullptr)
+	  _positions(nullptr), _normals(nullptr), _tangents(nullptr), _colors(nullptr), _uv_layers(nullptr), _uvs()
 {
 	auto        gctx = streamfx::obs::gs::context();
 	gs_vb_data* vbd  = gs_vertexbuffer_get_data(vb);
@@ -175,7 +187,9 @@ streamfx::obs::gs::vertex_buffer::vertex_buffer(vertex_buffer const&& other) noe
 	_capacity  = other._capacity;
 	_size      = other._size;
 	_layers    = other._layers;
-	_buffer    = other._buffer;
+	_buffers   = other._buffers;
+	_index     = other._index;
+	_flushed   = other._flushed;
 	_data      = other._data;
 	_positions = other._positions;
 	_normals   = other._normals;
@@ -185,7 +199,6 @@ streamfx::obs::gs::vertex_buffer::vertex_buffer(vertex_buffer const&& other) noe
 	for (std::size_t n = 0; n < MAXIMUM_UVW_LAYERS; n++) {
 		_uvs[n] = other._uvs[n];
 	}
-	_obs_data = other._obs_data;
 }
 
 void streamfx::obs::gs::vertex_buffer::operator=(vertex_buffer const&& other) noexcept
@@ -195,7 +208,9 @@ void streamfx::obs::gs::vertex_buffer::operator=(vertex_buffer const&& other) no
 	_capacity  = other._capacity;
 	_size      = other._size;
 	_layers    = other._layers;
-	_buffer    = other._buffer;
+	_buffers   = other._buffers;
+	_index     = other._index;
+	_flushed   = other._flushed;
 	_data      = other._data;
 	_positions = other._positions;
 	_normals   = other._normals;
@@ -205,7 +220,6 @@ void streamfx::obs::gs::vertex_buffer::operator=(vertex_buffer const&& other) no
 	for (std::size_t n = 0; n < MAXIMUM_UVW_LAYERS; n++) {
 		_uvs[n] = other._uvs[n];
 	}
-	_obs_data = other._obs_data;
 }
 
 void streamfx::obs::gs::vertex_buffer::resize(uint32_t size)
@@ -287,14 +301,83 @@ vec4* streamfx::obs::gs::vertex_buffer::get_uv_layer(uint8_t idx)
 	return _uvs[idx];
 }
 
+void streamfx::obs::gs::vertex_buffer::transform_positions(const matrix4* matrix)
+{
+#if defined(D_PLATFORM_INSTR_X86)
+	// Positions are row vectors with an implicit w of 1, and the result has a w of 0 just like vec3_transform.
+	__m128 mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+	__m128 mx   = _mm_and_ps(_mm_loadu_ps(&matrix->x.x), mask);
+	__m128 my   = _mm_and_ps(_mm_loadu_ps(&matrix->y.x), mask);
+	__m128 mz   = _mm_and_ps(_mm_loadu_ps(&matrix->z.x), mask);
+	__m128 mt   = _mm_and_ps(_mm_loadu_ps(&matrix->t.x), mask);
+	for (uint32_t idx = 0; idx < _size; idx++) {
+		__m128 p = _mm_load_ps(&_positions[idx].x);
+		__m128 r = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0)), mx), mt);
+		r        = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)), my), r);
+		r        = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2)), mz), r);
+		_mm_store_ps(&_positions[idx].x, r);
+	}
+#else
+	for (uint32_t idx = 0; idx < _size; idx++) {
+		vec3_transform(&_positions[idx], &_positions[idx], matrix);
+	}
+#endif
+}
+
+void streamfx::obs::gs::vertex_buffer::fill_colors(uint32_t color)
+{
+	std::fill_n(_colors, _size, color);
+}
+
+void streamfx::obs::gs::vertex_buffer::fill_grid(uint32_t columns, uint32_t rows, const vec2* minimum, const vec2* maximum)
+{
+	if ((columns == 0) || (rows == 0)) {
+		throw std::invalid_argument("columns and rows must be at least 1");
+	}
+	if ((static_cast<uint64_t>(columns) * rows * 6) > _capacity) {
+		throw std::out_of_range("grid larger than capacity");
+	}
+	resize(columns * rows * 6);
+
+	float_t step_x = (maximum->x - minimum->x) / static_cast<float_t>(columns);
+	float_t step_y = (maximum->y - minimum->y) / static_cast<float_t>(rows);
+	float_t uv_x   = 1.f / static_cast<float_t>(columns);
+	float_t uv_y   = 1.f / static_cast<float_t>(rows);
+	vec3*   pos    = _positions;
+	vec4*   uv     = _layers > 0 ? _uvs[0] : nullptr;
+
+	// Two triangles per cell, with the same winding as the quads drawn elsewhere.
+	const uint32_t corners[6][2] = {{0, 0}, {1, 0}, {0, 1}, {0, 1}, {1, 0}, {1, 1}};
+	for (uint32_t y = 0; y < rows; y++) {
+		for (uint32_t x = 0; x < columns; x++) {
+			for (const auto& corner : corners) {
+				uint32_t cx = x + corner[0];
+				uint32_t cy = y + corner[1];
+				vec3_set(pos++, minimum->x + step_x * static_cast<float_t>(cx), minimum->y + step_y * static_cast<float_t>(cy), 0.f);
+				if (uv) {
+					vec4_set(uv++, uv_x * static_cast<float_t>(cx), uv_y * static_cast<float_t>(cy), 0.f, 0.f);
+				}
+			}
+		}
+	}
+}
+
 gs_vertbuffer_t* streamfx::obs::gs::vertex_buffer::update(bool refreshGPU)
 {
 	if (refreshGPU) {
 		auto gctx = streamfx::obs::gs::context();
-		gs_vertexbuffer_flush_direct(_buffer.get(), _data.get());
-		_obs_data = gs_vertexbuffer_get_data(_buffer.get());
+
+		// Buffers that are only ever uploaded once never need more than the first buffer.
+		if (_flushed) {
+			_index = (_index + 1) % _buffers.size();
+			if (!_buffers[_index]) {
+				_buffers[_index] = create_buffer();
+			}
+		}
+		gs_vertexbuffer_flush_direct(_buffers[_index].get(), _data.get());
+		_flushed = true;
 	}
-	return _buffer.get();
+	return _buffers[_index].get();
 }
 
 gs_vertbuffer_t* streamfx::obs::gs::vertex_buffer::update()
@@ -8,15 +8,26 @@
 #include "gs-limits.hpp"
 #include "gs-vertex.hpp"
 
+#include "warning-disable.hpp"
+#include <array>
+#include "warning-enable.hpp"
+
 namespace streamfx::obs::gs {
 	class vertex_buffer {
+		public:
+		// GPU buffers that updates rotate through, so that an update never overwrites the one the last draw used.
+		static constexpr std::size_t ring = 3;
+
+		private:
 		uint32_t _capacity;
 		uint32_t _size;
 		uint8_t  _layers;
 
 		// OBS GS Data
-		std::shared_ptr<gs_vertbuffer_t> _buffer;
-		std::shared_ptr<gs_vb_data>      _data;
+		std::array<std::shared_ptr<gs_vertbuffer_t>, ring> _buffers;
+		std::size_t                                        _index;
+		bool                                               _flushed;
+		std::shared_ptr<gs_vb_data>                        _data;
 
 		// Memory Storage
 		vec3*          _positions;
@@ -26,12 +37,11 @@ namespace streamfx::obs::gs {
 		gs_tvertarray* _uv_layers;
 		vec4*          _uvs[MAXIMUM_UVW_LAYERS];
 
-		// OBS compatability
-		gs_vb_data* _obs_data;
-
 		void initialize(uint32_t capacity, uint8_t layers);
 		void finalize();
 
+		std::shared_ptr<gs_vertbuffer_t> create_buffer();
+
 		public:
 		virtual ~vertex_buffer();
 
@@ -155,8 +165,42 @@ namespace streamfx::obs::gs {
 		*/
 		vec4* get_uv_layer(uint8_t idx);
 
+		/*!
+		* \brief Transform the positions of all vertices by a matrix
+		* Same result as vec3_transform on each position, but four components at a time.
+		*
+		* \param matrix Matrix to transform by.
+		*/
+		void transform_positions(const matrix4* matrix);
+
+		/*!
+		* \brief Set the color of all vertices
+		*
+		* \param color Color to set, in the same format as get_colors().
+		*/
+		void fill_colors(uint32_t color);
+
+		/*!
+		* \brief Fill the buffer with a grid of quads, drawn as a GS_TRIS list
+		* Resizes the buffer to 6 vertices per cell, spanning from minimum to maximum with uv layer 0 from 0 to 1.
+		*
+		* \param columns Number of cells horizontally.
+		* \param rows Number of cells vertically.
+		* \param minimum Position of the top left corner.
+		* \param maximum Position of the bottom right corner.
+		*/
+		void fill_grid(uint32_t columns, uint32_t rows, const vec2* minimum, const vec2* maximum);
+
 		gs_vertbuffer_t* update();
 
+		/*!
+		* \brief Get the GPU buffer, optionally uploading the current data first
+		* Every upload after the first goes to the next buffer of the ring, the previous ones stay untouched until the
+		* ring wraps around. libobs always uploads all attributes of all vertices, so there are no partial updates.
+		*
+		* \param refreshGPU Upload the current data before returning the buffer.
+		* \return The buffer holding the most recently uploaded data.
+		*/
 		gs_vertbuffer_t* update(bool refreshGPU);
 	};
 } // namespace streamfx::obs::gs
@@ -3,3 +3,31 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "obs-encoder-factory.hpp"
+
+#include "warning-disable.hpp"
+#include <mutex>
+#include <set>
+#include "warning-enable.hpp"
+
+static std::mutex                                 instances_lock;
+static std::set<streamfx::obs::encoder_instance*> instances;
+
+streamfx::obs::encoder_instance::encoder_instance(obs_data_t* settings, obs_encoder_t* self, bool is_hw) : _self(self), _cpu_timings()
+{
+	std::lock_guard<std::mutex> lg(instances_lock);
+	instances.insert(this);
+}
+
+streamfx::obs::encoder_instance::~encoder_instance()
+{
+	std::lock_guard<std::mutex> lg(instances_lock);
+	instances.erase(this);
+}
+
+void streamfx::obs::encoder_instance::enumerate(const std::function<void(encoder_instance&)>& fn)
+{
+	std::lock_guard<std::mutex> lg(instances_lock);
+	for (auto instance : instances) {
+		fn(*instance);
+	}
+}
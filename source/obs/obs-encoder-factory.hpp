@@ -7,14 +7,45 @@
 #include "common.hpp"
 #include "plugin.hpp"
 
+#include "warning-disable.hpp"
+#include <functional>
+#include <utility>
+#include "warning-enable.hpp"
+
+// OBS Studio 30 can also hand textures to encoders on platforms that have no shared texture handles.
+#if defined(D_PLATFORM_LINUX) && (LIBOBS_API_MAJOR_VER >= 30)
+#define D_ENCODER_TEXTURE2
+#endif
+
 namespace streamfx::obs {
 	class encoder_instance {
 		protected:
 		obs_encoder_t* _self;
 
+		private:
+		::streamfx::util::histogram _cpu_timings; // CPU time of every encode call.
+
 		public:
-		encoder_instance(obs_data_t* settings, obs_encoder_t* self, bool is_hw) : _self(self) {}
-		virtual ~encoder_instance(){};
+		encoder_instance(obs_data_t* settings, obs_encoder_t* self, bool is_hw);
+		virtual ~encoder_instance();
+
+		/** CPU time of every encode call, which for hardware encoders is mostly spent waiting for the GPU. */
+		::streamfx::util::histogram& cpu_timings()
+		{
+			return _cpu_timings;
+		}
+
+		/** Report every timing this encoder keeps, by stage name. */
+		virtual void enumerate_timings(const std::function<void(const char*, const ::streamfx::util::histogram&)>& fn)
+		{
+			fn("encode", _cpu_timings);
+		}
+
+		/** Report every counter this encoder keeps, such as pool hits, by name. */
+		virtual void enumerate_counters(const std::function<void(const char*, uint64_t)>& fn) {}
+
+		/** Call fn for every encoder instance that currently exists, which stay alive until it returns. */
+		static void enumerate(const std::function<void(encoder_instance&)>& fn);
 
 		virtual void migrate(obs_data_t* settings, uint64_t version) {}
 
@@ -49,6 +80,13 @@ namespace streamfx::obs {
 			return false;
 		};
 
+#ifdef D_ENCODER_TEXTURE2
+		virtual bool encode_video(struct encoder_texture* texture, int64_t pts, uint64_t lock_key, uint64_t* next_key, struct encoder_packet* packet, bool* received_packet)
+		{
+			return encode_video(texture->handle, pts, lock_key, next_key, packet, received_packet);
+		};
+#endif
+
 		virtual size_t get_frame_size()
 		{
 			return 0;
@@ -115,6 +153,9 @@ namespace streamfx::obs {
 			}
 			if (_info.caps & OBS_ENCODER_CAP_PASS_TEXTURE) {
 				_info.encode_texture = _encode_texture;
+#ifdef D_ENCODER_TEXTURE2
+				_info.encode_texture2 = _encode_texture2;
+#endif
 
 				memcpy(&_info_fallback, &_info, sizeof(obs_encoder_info));
 				_info_fallback_id             = std::string(_info.id) + "_sw";
@@ -122,6 +163,9 @@ namespace streamfx::obs {
 				_info_fallback.caps           = (_info_fallback.caps & ~OBS_ENCODER_CAP_PASS_TEXTURE) | OBS_ENCODER_CAP_DEPRECATED;
 				_info_fallback.create         = _create;
 				_info_fallback.encode_texture = nullptr;
+#ifdef D_ENCODER_TEXTURE2
+				_info_fallback.encode_texture2 = nullptr;
+#endif
 				obs_register_encoder(&_info_fallback);
 			} else {
 				_info.create = _create;
@@ -285,35 +329,71 @@ namespace streamfx::obs {
 			}
 		}
 
-		static bool _encode(void* data, struct encoder_frame* frame, struct encoder_packet* packet, bool* received_packet) noexcept
+		// Encoding calls the concrete instance type, so that a final instance is called directly instead of through its
+		// vtable. If the instance declares encode_video() noexcept, the exception handling is left out as well.
+		template<typename... _args>
+		static FORCE_INLINE bool _encode_dispatch(void* data, _args... args)
 		{
-			try {
-				if (data)
-					return reinterpret_cast<encoder_instance*>(data)->encode_video(frame, packet, received_packet);
-				return false;
-			} catch (const std::exception& ex) {
-				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
-				return false;
-			} catch (...) {
-				DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+			if (!data)
 				return false;
+
+			auto instance = reinterpret_cast<_instance*>(data);
+			auto timing   = instance->cpu_timings().track();
+			return instance->encode_video(args...);
+		}
+
+		static bool _encode(void* data, struct encoder_frame* frame, struct encoder_packet* packet, bool* received_packet) noexcept
+		{
+			if constexpr (noexcept(std::declval<_instance&>().encode_video(frame, packet, received_packet))) {
+				return _encode_dispatch(data, frame, packet, received_packet);
+			} else {
+				try {
+					return _encode_dispatch(data, frame, packet, received_packet);
+				} catch (const std::exception& ex) {
+					DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+					return false;
+				} catch (...) {
+					DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+					return false;
+				}
 			}
 		}
 
 		static bool _encode_texture(void* data, uint32_t handle, int64_t pts, uint64_t lock_key, uint64_t* next_key, struct encoder_packet* packet, bool* received_packet) noexcept
 		{
-			try {
-				if (data)
-					return reinterpret_cast<encoder_instance*>(data)->encode_video(handle, pts, lock_key, next_key, packet, received_packet);
-				return false;
-			} catch (const std::exception& ex) {
-				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
-				return false;
-			} catch (...) {
-				DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
-				return false;
+			if constexpr (noexcept(std::declval<_instance&>().encode_video(handle, pts, lock_key, next_key, packet, received_packet))) {
+				return _encode_dispatch(data, handle, pts, lock_key, next_key, packet, received_packet);
+			} else {
+				try {
+					return _encode_dispatch(data, handle, pts, lock_key, next_key, packet, received_packet);
+				} catch (const std::exception& ex) {
+					DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+					return false;
+				} catch (...) {
+					DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+					return false;
+				}
+			}
+		}
+
+#ifdef D_ENCODER_TEXTURE2
+		static bool _encode_texture2(void* data, struct encoder_texture* texture, int64_t pts, uint64_t lock_key, uint64_t* next_key, struct encoder_packet* packet, bool* received_packet) noexcept
+		{
+			if constexpr (noexcept(std::declval<_instance&>().encode_video(texture, pts, lock_key, next_key, packet, received_packet))) {
+				return _encode_dispatch(data, texture, pts, lock_key, next_key, packet, received_packet);
+			} else {
+				try {
+					return _encode_dispatch(data, texture, pts, lock_key, next_key, packet, received_packet);
+				} catch (const std::exception& ex) {
+					DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+					return false;
+				} catch (...) {
+					DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+					return false;
+				}
 			}
 		}
+#endif
 
 		static size_t _get_frame_size(void* data) noexcept
 		{
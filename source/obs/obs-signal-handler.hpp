@@ -47,9 +47,10 @@ namespace streamfx::obs {
 		}
 		virtual ~signal_handler()
 		{
-			event.clear();
+			// Disconnecting waits for signals in flight, which the event no longer does.
 			signal_handler_t* sh = obs_source_get_signal_handler(_keepalive.get());
 			signal_handler_disconnect(sh, _signal.c_str(), handle_signal, this);
+			event.clear();
 		}
 	};
 
@@ -75,8 +76,9 @@ namespace streamfx::obs {
 		}
 		virtual ~audio_signal_handler()
 		{
-			event.clear();
+			// Removing the callback waits for audio in flight, which the event no longer does.
 			obs_source_remove_audio_capture_callback(_keepalive, handle_audio, this);
+			event.clear();
 		}
 
 		streamfx::util::event<::streamfx::obs::source, const struct audio_data*, bool> event;
@@ -3,3 +3,66 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "obs-source-factory.hpp"
+#include "gfx/gfx-capture.hpp"
+#include "obs/gs/gs-helper.hpp"
+
+void streamfx::obs::source_instance::video_capture() noexcept
+{
+	std::shared_ptr<::streamfx::gfx::input_capture> capture;
+	{
+		std::unique_lock<std::mutex> ul(_capture_lock);
+		capture = _capture;
+	}
+	if (!capture) {
+		return;
+	}
+
+	bool recording = false;
+	try {
+		recording = capture->record(_self.get());
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Failed to record input of '%s': %s", obs_source_get_name(_self.get()), ex.what());
+	} catch (...) {
+		DLOG_ERROR("Failed to record input of '%s'.", obs_source_get_name(_self.get()));
+	}
+
+	if (!recording) {
+		std::unique_lock<std::mutex> ul(_capture_lock);
+		if (_capture == capture) {
+			_capture.reset();
+		}
+	}
+}
+
+void streamfx::obs::source_instance::_capture_input(void* ptr, calldata_t* data)
+{
+	auto        self   = reinterpret_cast<source_instance*>(ptr);
+	const char* path   = nullptr;
+	long long   frames = 0;
+	calldata_get_string(data, "path", &path);
+	calldata_get_int(data, "frames", &frames);
+
+	try {
+		auto capture = std::make_shared<::streamfx::gfx::input_capture>(self->_self.get(), path ? path : "", static_cast<uint32_t>(std::max<long long>(frames, 0)));
+
+		std::unique_lock<std::mutex> ul(self->_capture_lock);
+		self->_capture = capture;
+		calldata_set_bool(data, "success", true);
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Failed to record input of '%s': %s", obs_source_get_name(self->_self.get()), ex.what());
+		calldata_set_bool(data, "success", false);
+	}
+}
+
+void streamfx::obs::source_instance::_prepare(void* ptr, calldata_t* data)
+{
+	auto self = reinterpret_cast<source_instance*>(ptr);
+	try {
+		auto gctx = ::streamfx::obs::gs::context();
+		self->prepare();
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Failed to prepare '%s': %s", obs_source_get_name(self->_self.get()), ex.what());
+	} catch (...) {
+		DLOG_ERROR("Failed to prepare '%s'.", obs_source_get_name(self->_self.get()));
+	}
+}
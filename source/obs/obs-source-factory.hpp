@@ -6,6 +6,18 @@
 #pragma once
 #include "common.hpp"
 #include "obs-source.hpp"
+#include "gfx/gfx-vram.hpp"
+#include "obs/gs/gs-timer.hpp"
+
+#include "warning-disable.hpp"
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "warning-enable.hpp"
+
+namespace streamfx::gfx {
+	class input_capture;
+}
 
 namespace streamfx::obs {
 	template<class _factory, typename _instance>
@@ -14,6 +26,7 @@ namespace streamfx::obs {
 		obs_source_info                                         _info = {};
 		std::map<std::string, std::shared_ptr<obs_source_info>> _proxies;
 		std::set<std::string>                                   _proxy_names;
+		::streamfx::util::histogram                             _gpu_timings; // GPU time of every instance combined.
 
 		public:
 		source_factory(obs_source_type type = OBS_SOURCE_TYPE_INPUT)
@@ -31,7 +44,12 @@ namespace streamfx::obs {
 			_info.save            = _save;
 			_info.filter_remove   = _filter_remove;
 		}
-		virtual ~source_factory() = default;
+		virtual ~source_factory()
+		{
+			if (_gpu_timings.count() > 0) {
+				DLOG_INFO("GPU time of '%s': %" PRIu64 " frames, %.3f ms average, %.3f ms 95th percentile, %.3f ms 99th percentile.", _info.id, _gpu_timings.count(), _gpu_timings.average_duration() / 1000000.0, static_cast<double_t>(_gpu_timings.percentile(0.95).count()) / 1000000.0, static_cast<double_t>(_gpu_timings.percentile(0.99).count()) / 1000000.0);
+			}
+		}
 
 		protected:
 		void finish_setup()
@@ -146,7 +164,15 @@ namespace streamfx::obs {
 		static void* _create(obs_data_t* settings, obs_source_t* source) noexcept
 		{
 			try {
-				return reinterpret_cast<_factory*>(obs_source_get_type_data(source))->create(settings, source);
+				auto factory = reinterpret_cast<_factory*>(obs_source_get_type_data(source));
+
+				// Whatever the instance creates from here on is charged to it, see source_instance::vram().
+				::streamfx::gfx::vram::scope vscope(std::make_shared<::streamfx::gfx::vram::account>());
+				auto                         instance = factory->create(settings, source);
+				if (instance) {
+					reinterpret_cast<_instance*>(instance)->gpu_timer().aggregate(&factory->_gpu_timings);
+				}
+				return instance;
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 				return nullptr;
@@ -233,42 +259,85 @@ namespace streamfx::obs {
 			}
 		}
 
+		// Per-frame callbacks call the concrete instance type, so that a final instance is called directly instead of
+		// through its vtable. If the instance declares the callback noexcept, the exception handling is left out as well.
 		static void _video_tick(void* data, float seconds) noexcept
 		{
-			try {
-				if (data)
-					reinterpret_cast<_instance*>(data)->video_tick(seconds);
-			} catch (const std::exception& ex) {
-				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
-			} catch (...) {
-				DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+			if constexpr (noexcept(std::declval<_instance&>().video_tick(seconds))) {
+				_video_tick_dispatch(data, seconds);
+			} else {
+				try {
+					_video_tick_dispatch(data, seconds);
+				} catch (const std::exception& ex) {
+					DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+				} catch (...) {
+					DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+				}
+			}
+		}
+
+		static FORCE_INLINE void _video_tick_dispatch(void* data, float_t seconds)
+		{
+			if (!data)
+				return;
+
+			auto instance = reinterpret_cast<_instance*>(data);
+			if (instance->video_tick_begin(seconds)) {
+				auto                         timing = instance->cpu_timings().track();
+				::streamfx::gfx::vram::scope vscope(instance->vram());
+				instance->video_tick(seconds);
 			}
 		}
 
 		static void _video_render(void* data, gs_effect_t* effect) noexcept
 		{
-			try {
-				if (data)
-					reinterpret_cast<_instance*>(data)->video_render(effect);
-			} catch (const std::exception& ex) {
-				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
-			} catch (...) {
-				DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+			if constexpr (noexcept(std::declval<_instance&>().video_tick(0.f)) && noexcept(std::declval<_instance&>().video_render(effect))) {
+				_video_render_dispatch(data, effect, false);
+			} else {
+				try {
+					_video_render_dispatch(data, effect, false);
+				} catch (const std::exception& ex) {
+					DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+				} catch (...) {
+					DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+				}
 			}
 		}
 
 		static void _video_render_filter(void* data, gs_effect_t* effect) noexcept
 		{
-			try {
-				if (data)
-					reinterpret_cast<_instance*>(data)->video_render(effect);
-			} catch (const std::exception& ex) {
-				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
-				obs_source_skip_video_filter(reinterpret_cast<_instance*>(data)->get());
-			} catch (...) {
-				DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
-				obs_source_skip_video_filter(reinterpret_cast<_instance*>(data)->get());
+			if constexpr (noexcept(std::declval<_instance&>().video_tick(0.f)) && noexcept(std::declval<_instance&>().video_render(effect))) {
+				_video_render_dispatch(data, effect, true);
+			} else {
+				try {
+					_video_render_dispatch(data, effect, true);
+				} catch (const std::exception& ex) {
+					DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+					obs_source_skip_video_filter(reinterpret_cast<_instance*>(data)->get());
+				} catch (...) {
+					DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+					obs_source_skip_video_filter(reinterpret_cast<_instance*>(data)->get());
+				}
+			}
+		}
+
+		static FORCE_INLINE void _video_render_dispatch(void* data, gs_effect_t* effect, bool filter)
+		{
+			if (!data)
+				return;
+
+			auto                         instance = reinterpret_cast<_instance*>(data);
+			::streamfx::gfx::vram::scope vscope(instance->vram());
+			if (float_t seconds = instance->video_tick_pending(); seconds > 0) {
+				instance->video_tick(seconds);
+			}
+			if (filter) {
+				instance->video_capture();
 			}
+
+			auto cpu_timing = instance->cpu_timings().track();
+			auto gpu_timing = instance->gpu_timer().track();
+			instance->video_render(effect);
 		}
 
 		static struct obs_source_frame* _filter_video(void* data, struct obs_source_frame* frame) noexcept
@@ -289,16 +358,22 @@ namespace streamfx::obs {
 		public /* Instance > Audio */:
 		static struct obs_audio_data* _filter_audio(void* data, struct obs_audio_data* frame) noexcept
 		{
-			try {
+			if constexpr (noexcept(std::declval<_instance&>().filter_audio(frame))) {
 				if (data)
 					return reinterpret_cast<_instance*>(data)->filter_audio(frame);
 				return frame;
-			} catch (const std::exception& ex) {
-				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
-				return frame;
-			} catch (...) {
-				DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
-				return frame;
+			} else {
+				try {
+					if (data)
+						return reinterpret_cast<_instance*>(data)->filter_audio(frame);
+					return frame;
+				} catch (const std::exception& ex) {
+					DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+					return frame;
+				} catch (...) {
+					DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+					return frame;
+				}
 			}
 		}
 
@@ -448,7 +523,8 @@ namespace streamfx::obs {
 			try {
 				auto priv = reinterpret_cast<_instance*>(data);
 				if (priv) {
-					uint64_t version = static_cast<uint64_t>(obs_data_get_int(settings, S_VERSION));
+					::streamfx::gfx::vram::scope vscope(priv->vram());
+					uint64_t                     version = static_cast<uint64_t>(obs_data_get_int(settings, S_VERSION));
 					priv->migrate(settings, version);
 					obs_data_set_int(settings, S_VERSION, static_cast<int64_t>(STREAMFX_VERSION));
 					obs_data_set_string(settings, S_COMMIT, STREAMFX_VERSION_BUILD);
@@ -464,8 +540,10 @@ namespace streamfx::obs {
 		static void _update(void* data, obs_data_t* settings) noexcept
 		{
 			try {
-				if (data)
+				if (data) {
+					::streamfx::gfx::vram::scope vscope(reinterpret_cast<_instance*>(data)->vram());
 					reinterpret_cast<_instance*>(data)->update(settings);
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 			} catch (...) {
@@ -833,8 +911,36 @@ namespace streamfx::obs {
 		protected:
 		::streamfx::obs::source _self;
 
+		private:
+		bool                        _hidden;      // Ticks are being skipped, as nothing shows us.
+		float_t                     _hidden_time; // Time since the last tick that actually happened.
+		::streamfx::util::histogram _cpu_timings; // CPU time of video_tick() and video_render().
+		::streamfx::obs::gs::timer  _gpu_timer;   // GPU time of video_render().
+
+		std::mutex                                      _capture_lock;
+		std::shared_ptr<::streamfx::gfx::input_capture> _capture; // Recording of the input, for replaying it later.
+
+		std::shared_ptr<::streamfx::gfx::vram::account> _vram;
+
 		public:
-		source_instance(obs_data_t* settings, obs_source_t* source) : _self(source, false, false) {}
+		source_instance(obs_data_t* settings, obs_source_t* source) : _self(source, false, false), _hidden(false), _hidden_time(0), _cpu_timings(), _gpu_timer(), _capture_lock(), _capture(), _vram(::streamfx::gfx::vram::current())
+		{
+			if (!_vram) {
+				_vram = std::make_shared<::streamfx::gfx::vram::account>();
+			}
+
+			if (source) {
+				proc_handler_add(obs_source_get_proc_handler(source), "void get_timings(out int cpu_calls, out int cpu_total, out float cpu_p95, out int gpu_frames, out int gpu_total, out float gpu_latest, out float gpu_p95)", _get_timings, this);
+				proc_handler_add(obs_source_get_proc_handler(source), "void get_vram(out int bytes)", _get_vram, this);
+				proc_handler_add(obs_source_get_proc_handler(source), "void prepare()", _prepare, this);
+
+				// Only synchronous video filters have an input texture to record.
+				uint32_t flags = obs_source_get_output_flags(source);
+				if ((obs_source_get_type(source) == OBS_SOURCE_TYPE_FILTER) && ((flags & OBS_SOURCE_ASYNC_VIDEO) == OBS_SOURCE_VIDEO)) {
+					proc_handler_add(obs_source_get_proc_handler(source), "void capture_input(in string path, in int frames, out bool success)", _capture_input, this);
+				}
+			}
+		}
 		virtual ~source_instance(){};
 
 		virtual ::streamfx::obs::source get()
@@ -842,6 +948,24 @@ namespace streamfx::obs {
 			return _self;
 		}
 
+		/** CPU time of video_tick() and video_render(), each tracked as their own call. */
+		::streamfx::util::histogram& cpu_timings()
+		{
+			return _cpu_timings;
+		}
+
+		/** GPU time of video_render(), which includes whatever it renders, such as the filters before it. */
+		::streamfx::obs::gs::timer& gpu_timer()
+		{
+			return _gpu_timer;
+		}
+
+		/** Video memory created by this instance, which does not include what it borrows from shared caches. */
+		std::shared_ptr<::streamfx::gfx::vram::account> vram()
+		{
+			return _vram;
+		}
+
 		virtual void filter_remove(obs_source_t* source) {}
 
 		public /* Instance > Video */:
@@ -915,6 +1039,70 @@ namespace streamfx::obs {
 
 		virtual void hide() {}
 
+		/** Skip video_tick() while no view shows the source (or the parent of a filter)?
+		 *
+		 * Skipped ticks are caught up on right before the next video_render(), so anything that renders us without
+		 * showing us still sees up to date state.
+		 */
+		virtual bool video_tick_skip_hidden()
+		{
+			return false;
+		}
+
+		/** Called when ticks start being skipped, to release whatever is cheap to recreate on the next render. */
+		virtual void video_hidden() {}
+
+		bool is_showing()
+		{
+			obs_source_t* source = _self.get();
+			if (source && (obs_source_get_type(source) == OBS_SOURCE_TYPE_FILTER)) {
+				source = obs_filter_get_parent(source);
+			}
+			return source && obs_source_showing(source);
+		}
+
+		/** Called before every tick, returns false if the tick is skipped as nothing shows us.
+		 *
+		 * Once ticks resume, seconds is increased by the time that was skipped.
+		 */
+		bool video_tick_begin(float_t& seconds)
+		{
+			if (video_tick_skip_hidden() && !is_showing()) {
+				if (!_hidden) {
+					_hidden = true;
+					video_hidden();
+				}
+				_hidden_time += seconds;
+				return false;
+			}
+
+			seconds += _hidden_time;
+			_hidden      = false;
+			_hidden_time = 0;
+			return true;
+		}
+
+		/** Time of skipped ticks to catch up on before rendering, or zero if there are none. */
+		float_t video_tick_pending()
+		{
+			if (!_hidden || (_hidden_time <= 0)) {
+				return 0;
+			}
+
+			float_t seconds = _hidden_time;
+			_hidden_time    = 0;
+			return seconds;
+		}
+
+		/** Record the input for an ongoing capture_input() call, if any. Never throws, a failed capture just ends. */
+		void video_capture() noexcept;
+
+		/** Create ahead of time whatever the first video_render() would, such as the resources of a filter on a scene that
+		 * a transition is about to show. Called on the graphics thread while something else is still shown, anything that
+		 * can load on the thread pool should be started there instead of waited for.
+		 */
+		virtual void prepare() {}
+
 		public /* Instance > Interaction */:
 		virtual void mouse_click(const obs_mouse_event* event, int32_t type, bool mouse_up, uint32_t click_count) {}
 
@@ -959,6 +1147,33 @@ namespace streamfx::obs {
 		{
 			return nullptr;
 		};
+
+		private:
+		// Records the next frames of input into a file, see streamfx::util::capture for the format.
+		static void _capture_input(void* ptr, calldata_t* data);
+
+		// Calls prepare(), see there.
+		static void _prepare(void* ptr, calldata_t* data);
+
+		// Totals are in nanoseconds since creation, so that callers can compute their own rates from two calls.
+		static void _get_timings(void* ptr, calldata_t* data)
+		{
+			auto  self = reinterpret_cast<source_instance*>(ptr);
+			auto& gpu  = self->_gpu_timer.timings();
+			calldata_set_int(data, "cpu_calls", static_cast<long long>(self->_cpu_timings.count()));
+			calldata_set_int(data, "cpu_total", static_cast<long long>(self->_cpu_timings.total_duration().count()));
+			calldata_set_float(data, "cpu_p95", static_cast<double_t>(self->_cpu_timings.percentile(0.95).count()) / 1000000.0);
+			calldata_set_int(data, "gpu_frames", static_cast<long long>(gpu.count()));
+			calldata_set_int(data, "gpu_total", static_cast<long long>(gpu.total_duration().count()));
+			calldata_set_float(data, "gpu_latest", static_cast<double_t>(self->_gpu_timer.latest().count()) / 1000000.0);
+			calldata_set_float(data, "gpu_p95", static_cast<double_t>(gpu.percentile(0.95).count()) / 1000000.0);
+		}
+
+		static void _get_vram(void* ptr, calldata_t* data)
+		{
+			auto self = reinterpret_cast<source_instance*>(ptr);
+			calldata_set_int(data, "bytes", static_cast<long long>(self->_vram->bytes()));
+		}
 	};
 
 } // namespace streamfx::obs
@@ -26,7 +26,7 @@
 #define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
 #endif
 
-streamfx::obs::source_tracker::source_tracker() : _sources(), _mutex()
+streamfx::obs::source_tracker::source_tracker() : _sources(), _mutex(), _version(0), _snapshot()
 {
 	auto osi = obs_get_signal_handler();
 	if (osi) {
@@ -57,18 +57,105 @@ streamfx::obs::source_tracker::~source_tracker()
 	}
 
 	this->_sources.clear();
+	this->_snapshot.reset();
+}
+
+static uint32_t categorize(obs_source_t* source)
+{
+	uint32_t categories = 1 << static_cast<std::size_t>(streamfx::obs::source_tracker::category::ALL);
+	uint32_t flags      = obs_source_get_output_flags(source);
+	switch (obs_source_get_type(source)) {
+	case OBS_SOURCE_TYPE_INPUT:
+		categories |= 1 << static_cast<std::size_t>(streamfx::obs::source_tracker::category::SOURCES);
+		if (flags & OBS_SOURCE_AUDIO) {
+			categories |= 1 << static_cast<std::size_t>(streamfx::obs::source_tracker::category::AUDIO_SOURCES);
+		}
+		if (flags & OBS_SOURCE_VIDEO) {
+			categories |= 1 << static_cast<std::size_t>(streamfx::obs::source_tracker::category::VIDEO_SOURCES);
+		}
+		break;
+	case OBS_SOURCE_TYPE_TRANSITION:
+		categories |= 1 << static_cast<std::size_t>(streamfx::obs::source_tracker::category::TRANSITIONS);
+		break;
+	case OBS_SOURCE_TYPE_SCENE:
+		categories |= 1 << static_cast<std::size_t>(streamfx::obs::source_tracker::category::SCENES);
+		break;
+	default:
+		break;
+	}
+	return categories;
+}
+
+uint64_t streamfx::obs::source_tracker::version()
+{
+	return _version.load();
+}
+
+std::shared_ptr<const streamfx::obs::source_tracker::snapshot> streamfx::obs::source_tracker::get_snapshot()
+{
+	std::lock_guard<decltype(_mutex)> lock(_mutex);
+	uint64_t                          version = _version.load();
+	if (_snapshot && (_snapshot->version == version)) {
+		return _snapshot;
+	}
+
+	// Anyone still enumerating keeps the previous snapshot alive for as long as they need it.
+	auto snap     = std::make_shared<snapshot>();
+	snap->version = version;
+	for (auto& kv : _sources) {
+		for (std::size_t idx = 0; idx < snap->lists.size(); idx++) {
+			if (kv.second.categories & (1 << idx)) {
+				snap->lists[idx].emplace_back(kv.first, kv.second.source);
+			}
+		}
+	}
+	_snapshot = snap;
+	return _snapshot;
+}
+
+void streamfx::obs::source_tracker::enumerate(enumerate_cb_t ecb, category filter)
+{
+	auto snap = get_snapshot();
+	for (auto& kv : snap->lists[static_cast<std::size_t>(filter)]) {
+		try {
+			auto source = kv.second.lock();
+			if (!source) {
+				continue;
+			}
+
+			if (ecb) {
+				if (ecb(kv.first, source)) {
+					break;
+				}
+			}
+		} catch (...) {
+			continue;
+		}
+	}
 }
 
 void streamfx::obs::source_tracker::enumerate(enumerate_cb_t ecb, filter_cb_t fcb)
 {
-	// Need func-local copy, otherwise we risk corruption if a new source is created or destroyed.
-	decltype(_sources) _clone;
-	{
-		std::lock_guard<decltype(_mutex)> lock(_mutex);
-		_clone = _sources;
+	// The well known filters have a category of their own, which doesn't need to look at any other source.
+	if (auto fn = fcb ? fcb.target<bool (*)(std::string, ::streamfx::obs::source)>() : nullptr; fn || !fcb) {
+		static const std::map<bool (*)(std::string, ::streamfx::obs::source), category> known = {
+			{&filter_sources, category::SOURCES},
+			{&filter_audio_sources, category::AUDIO_SOURCES},
+			{&filter_video_sources, category::VIDEO_SOURCES},
+			{&filter_transitions, category::TRANSITIONS},
+			{&filter_scenes, category::SCENES},
+		};
+		if (!fcb) {
+			enumerate(ecb, category::ALL);
+			return;
+		} else if (auto kv = known.find(*fn); kv != known.end()) {
+			enumerate(ecb, kv->second);
+			return;
+		}
 	}
 
-	for (auto kv : _clone) {
+	auto snap = get_snapshot();
+	for (auto& kv : snap->lists[static_cast<std::size_t>(category::ALL)]) {
 		auto wsource = kv.second;
 		try {
 			auto source = wsource.lock();
@@ -101,8 +188,10 @@ void streamfx::obs::source_tracker::insert_source(obs_source_t* source)
 	}
 
 	// Insert the newly tracked source into the map.
+	uint32_t                          categories = categorize(source);
 	std::lock_guard<decltype(_mutex)> lock(_mutex);
-	_sources.emplace(std::string{name}, ::streamfx::obs::weak_source{source});
+	_sources.emplace(std::string{name}, entry{::streamfx::obs::weak_source{source}, categories});
+	_version++;
 }
 
 void streamfx::obs::source_tracker::remove_source(obs_source_t* source)
@@ -114,14 +203,16 @@ void streamfx::obs::source_tracker::remove_source(obs_source_t* source)
 	if (name) {
 		if (auto kv = _sources.find(std::string{name}); kv != _sources.end()) {
 			_sources.erase(kv);
+			_version++;
 			return;
 		}
 	}
 
 	// Try and find the source by pointer.
 	for (auto kv = _sources.begin(); kv != _sources.end(); kv++) {
-		if (kv->second == source) {
+		if (kv->second.source == source) {
 			_sources.erase(kv);
+			_version++;
 			return;
 		}
 	}
@@ -139,6 +230,7 @@ void streamfx::obs::source_tracker::rename_source(std::string_view old_name, std
 		throw std::runtime_error("New and old name are identical.");
 	}
 
+	uint32_t                          categories = categorize(source);
 	std::lock_guard<decltype(_mutex)> lock(_mutex);
 
 	// Remove the previously tracked entry.
@@ -147,7 +239,8 @@ void streamfx::obs::source_tracker::rename_source(std::string_view old_name, std
 	}
 
 	// And then add the new entry.
-	_sources.emplace(std::string{new_name}, ::streamfx::obs::weak_source{source});
+	_sources.emplace(std::string{new_name}, entry{::streamfx::obs::weak_source{source}, categories});
+	_version++;
 }
 
 bool streamfx::obs::source_tracker::filter_sources(std::string, ::streamfx::obs::source source)
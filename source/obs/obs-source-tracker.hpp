@@ -7,15 +7,45 @@
 #include "obs/obs-weak-source.hpp"
 
 #include "warning-disable.hpp"
+#include <array>
+#include <atomic>
 #include <functional>
 #include <map>
 #include <mutex>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::obs {
 	class source_tracker {
-		std::map<std::string, ::streamfx::obs::weak_source> _sources;
-		std::mutex                                          _mutex;
+		public:
+		// Categories matching the filter_* functions, which are enumerated without looking at any other source.
+		enum class category : std::size_t {
+			ALL,
+			SOURCES,
+			AUDIO_SOURCES,
+			VIDEO_SOURCES,
+			TRANSITIONS,
+			SCENES,
+			MAX,
+		};
+
+		private:
+		struct entry {
+			::streamfx::obs::weak_source source;
+			uint32_t                     categories; // Bit mask of category.
+		};
+
+		// Immutable list of sources per category, rebuilt on the next enumeration after the tracked sources changed.
+		typedef std::vector<std::pair<std::string, ::streamfx::obs::weak_source>> list_t;
+		struct snapshot {
+			uint64_t                                                     version;
+			std::array<list_t, static_cast<std::size_t>(category::MAX)> lists;
+		};
+
+		std::map<std::string, entry>    _sources;
+		std::mutex                      _mutex;
+		std::atomic<uint64_t>           _version;
+		std::shared_ptr<const snapshot> _snapshot;
 
 		public:
 		// Callback function for enumerating sources.
@@ -44,6 +74,18 @@ namespace streamfx::obs {
 		// @param filter_cb Filter function to narrow down results.
 		void enumerate(enumerate_cb_t enumerate_cb, filter_cb_t filter_cb = nullptr);
 
+		//! Enumerate all tracked sources in a category
+		//
+		// @param enumerate_cb The function called for each tracked source.
+		// @param filter Category to enumerate.
+		void enumerate(enumerate_cb_t enumerate_cb, category filter);
+
+		//! Version of the tracked sources, which changes whenever a source is added, removed or renamed.
+		uint64_t version();
+
+		private:
+		std::shared_ptr<const snapshot> get_snapshot();
+
 		protected:
 		void insert_source(obs_source_t* source);
 		void remove_source(obs_source_t* source);
@@ -8,9 +8,13 @@
 #include "plugin.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
+#include <cctype>
+#include <functional>
 #include <map>
 #include <set>
 #include <stdexcept>
+#include <string_view>
 #include "warning-enable.hpp"
 
 struct __sfs_data {
@@ -98,3 +102,168 @@ bool streamfx::obs::tools::source_find_source(::streamfx::obs::source haystack,
 
 	return false;
 }
+
+static void __prepare_source(obs_source_t* parent, obs_source_t* source, void* param)
+{
+	// Anything that isn't one of ours simply has no such procedure, which the call ignores.
+	calldata_t data;
+	calldata_init(&data);
+	proc_handler_call(obs_source_get_proc_handler(source), "prepare", &data);
+	calldata_free(&data);
+}
+
+static void __prepare_source_and_filters(obs_source_t* parent, obs_source_t* source, void* param)
+{
+	// Calling it twice is harmless, in case the tree already included the filters.
+	__prepare_source(parent, source, param);
+	obs_source_enum_filters(source, __prepare_source, param);
+}
+
+void streamfx::obs::tools::prepare_source_tree(obs_source_t* source)
+{
+	if (!source) {
+		return;
+	}
+
+	obs_source_enum_full_tree(source, __prepare_source_and_filters, nullptr);
+	__prepare_source_and_filters(nullptr, source, nullptr);
+}
+
+static bool __content_is_static(obs_source_t* parent, int64_t& media_time)
+{
+	// Paused or stopped media only changes when seeked, which moves its time.
+	if (obs_source_get_output_flags(parent) & OBS_SOURCE_CONTROLLABLE_MEDIA) {
+		switch (obs_source_media_get_state(parent)) {
+		case OBS_MEDIA_STATE_PAUSED:
+		case OBS_MEDIA_STATE_STOPPED:
+		case OBS_MEDIA_STATE_ENDED:
+			media_time = obs_source_media_get_time(parent);
+			return true;
+		default:
+			break;
+		}
+	}
+
+	// Text and color sources only change with their settings, unless they follow the contents of a file.
+	std::string_view id = obs_source_get_unversioned_id(parent);
+	if ((id == "text_gdiplus") || (id == "text_ft2_source") || (id == "color_source")) {
+		obs_data_t* settings = obs_source_get_settings(parent);
+		bool        is_file  = obs_data_get_bool(settings, "read_from_file") || obs_data_get_bool(settings, "from_file") || obs_data_get_bool(settings, "log_mode");
+		if (const char* json = obs_data_get_json(settings); !is_file && json) {
+			media_time = static_cast<int64_t>(std::hash<std::string_view>{}(json));
+		}
+		obs_data_release(settings);
+		return !is_file;
+	}
+
+	// Images only change with their settings too, except for animated ones.
+	if (id == "image_source") {
+		obs_data_t*      settings = obs_source_get_settings(parent);
+		std::string_view file     = obs_data_get_string(settings, "file");
+		bool             animated = (file.size() >= 4) && std::equal(file.end() - 4, file.end(), ".gif", [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+		if (const char* json = obs_data_get_json(settings); !animated && json) {
+			media_time = static_cast<int64_t>(std::hash<std::string_view>{}(json));
+		}
+		obs_data_release(settings);
+		return !animated;
+	}
+
+	return false;
+}
+
+bool streamfx::obs::tools::filter_input_is_static(obs_source_t* parent, obs_source_t* target, int64_t& media_time)
+{
+	media_time = 0;
+
+	// Any filter in between may change its output at any time, so only trust the source itself.
+	if (!parent || (target != parent)) {
+		return false;
+	}
+
+	return __content_is_static(parent, media_time);
+}
+
+bool streamfx::obs::tools::source_is_static(obs_source_t* source, int64_t& media_time)
+{
+	media_time = 0;
+	if (!source) {
+		return false;
+	}
+
+	// Same as for filter inputs, the filters of the source may change its output at any time.
+	bool filtered = false;
+	obs_source_enum_filters(
+		source,
+		[](obs_source_t*, obs_source_t* child, void* param) {
+			if (obs_source_enabled(child)) {
+				*reinterpret_cast<bool*>(param) = true;
+			}
+		},
+		&filtered);
+	if (filtered) {
+		return false;
+	}
+
+	return __content_is_static(source, media_time);
+}
+
+gs_color_space streamfx::obs::tools::filter_pass_through_space(obs_source_t* self)
+{
+	static const gs_color_space preferred_spaces[] = {GS_CS_SRGB, GS_CS_SRGB_16F, GS_CS_709_EXTENDED};
+
+	obs_source_t* target = obs_filter_get_target(self);
+	if (!target) {
+		return GS_CS_SRGB;
+	}
+	return obs_source_get_color_space(target, sizeof(preferred_spaces) / sizeof(gs_color_space), preferred_spaces);
+}
+
+gs_color_format streamfx::obs::tools::color_format(gs_color_space space)
+{
+	switch (space) {
+	case GS_CS_SRGB:
+		return GS_RGBA;
+	case GS_CS_SRGB_16F:
+	case GS_CS_709_EXTENDED:
+	case GS_CS_709_SCRGB:
+		return GS_RGBA16F;
+	default:
+		return GS_RGBA_UNORM;
+	}
+}
+
+const char* streamfx::obs::tools::draw_technique(gs_color_space space, float_t& multiplier)
+{
+	gs_color_space current = gs_get_color_space();
+
+	multiplier = 1.f;
+	switch (space) {
+	case GS_CS_SRGB:
+	case GS_CS_SRGB_16F:
+		if (current == GS_CS_709_SCRGB) {
+			multiplier = obs_get_video_sdr_white_level() / 80.f;
+			return "DrawMultiply";
+		}
+		break;
+	case GS_CS_709_EXTENDED:
+		if ((current == GS_CS_SRGB) || (current == GS_CS_SRGB_16F)) {
+			return "DrawTonemap";
+		} else if (current == GS_CS_709_SCRGB) {
+			multiplier = obs_get_video_sdr_white_level() / 80.f;
+			return "DrawMultiply";
+		}
+		break;
+	case GS_CS_709_SCRGB:
+		if ((current == GS_CS_SRGB) || (current == GS_CS_SRGB_16F)) {
+			multiplier = 80.f / obs_get_video_sdr_white_level();
+			return "DrawMultiplyTonemap";
+		} else if (current == GS_CS_709_EXTENDED) {
+			multiplier = 80.f / obs_get_video_sdr_white_level();
+			return "DrawMultiply";
+		}
+		break;
+	default:
+		break;
+	}
+	return "Draw";
+}
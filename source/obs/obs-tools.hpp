@@ -9,6 +9,27 @@
 namespace streamfx::obs {
 	namespace tools {
 		bool source_find_source(::streamfx::obs::source haystack, ::streamfx::obs::source needle);
+
+		/** Ask the source and everything it shows, filters included, to prepare() for being rendered. Graphics thread only. */
+		void prepare_source_tree(obs_source_t* source);
+
+		/** Is the input of a filter known to stay the same between frames? Media time changes whenever the input does anyway:
+		 * It is the time of paused media, as seeking changes it, or a hash of the settings of text and color sources. */
+		bool filter_input_is_static(obs_source_t* parent, obs_source_t* target, int64_t& media_time);
+
+		/** Same as filter_input_is_static() for a source rendered with all of its filters, so only if none is enabled. */
+		bool source_is_static(obs_source_t* source, int64_t& media_time);
+
+		/** Color space for a filter that works the same in any of them, which is whatever its target renders in. Filters
+		 * that all do this keep the color space of the source, so it is only converted once, after the last of them. */
+		gs_color_space filter_pass_through_space(obs_source_t* self);
+
+		/** Format which holds the given color space without losing range. */
+		gs_color_format color_format(gs_color_space space);
+
+		/** Technique of the default effect that draws a texture in the given color space into the current render target,
+		 * along with the value of its "multiplier" parameter. Matches what obs_source_process_filter_end() does. */
+		const char* draw_technique(gs_color_space space, float_t& multiplier);
 	} // namespace tools
 
 	inline void obs_source_deleter(obs_source_t* v)
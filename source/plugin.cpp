@@ -7,10 +7,7 @@
 #include "gfx/gfx-opengl.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "obs/gs/gs-vertexbuffer.hpp"
-
-#ifdef ENABLE_NVIDIA_CUDA
-#include "nvidia/cuda/nvidia-cuda-obs.hpp"
-#endif
+#include "util/util-threadpool.hpp"
 
 #ifdef ENABLE_FRONTEND
 #include "ui/ui.hpp"
@@ -25,12 +22,20 @@
 #include <list>
 #include <map>
 #include <stdexcept>
+#include <vector>
 #include "warning-enable.hpp"
 
 static std::shared_ptr<streamfx::gfx::opengl> _streamfx_gfx_opengl;
 
 namespace streamfx {
-	typedef std::list<loader_function_t>               loader_list_t;
+	struct loader_info {
+		loader_function_t initializer;
+		loader_function_t finalizer;
+		loader_mode       mode;
+		bool              initialized;
+	};
+
+	typedef std::list<std::shared_ptr<loader_info>>    loader_list_t;
 	typedef std::map<loader_priority_t, loader_list_t> loader_map_t;
 
 	loader_map_t& get_initializers()
@@ -45,24 +50,62 @@ namespace streamfx {
 		return finalizers;
 	}
 
-	loader::loader(loader_function_t initializer, loader_function_t finalizer, loader_priority_t priority)
+	loader_list_t& get_deferred()
+	{
+		static loader_list_t deferred;
+		return deferred;
+	}
+
+	loader::loader(loader_function_t initializer, loader_function_t finalizer, loader_priority_t priority, loader_mode mode)
 	{
+		auto info = std::make_shared<loader_info>(loader_info{initializer, finalizer, mode, false});
+
 		auto init_kv = get_initializers().find(priority);
 		if (init_kv != get_initializers().end()) {
-			init_kv->second.push_back(initializer);
+			init_kv->second.push_back(info);
 		} else {
-			get_initializers().emplace(priority, loader_list_t{initializer});
+			get_initializers().emplace(priority, loader_list_t{info});
 		}
 
 		// Invert the order for finalizers.
 		auto ipriority = priority ^ static_cast<loader_priority_t>(0xFFFFFFFFFFFFFFFF);
 		auto fina_kv   = get_finalizers().find(ipriority);
 		if (fina_kv != get_finalizers().end()) {
-			fina_kv->second.push_back(finalizer);
+			fina_kv->second.push_back(info);
 		} else {
-			get_finalizers().emplace(ipriority, loader_list_t{finalizer});
+			get_finalizers().emplace(ipriority, loader_list_t{info});
+		}
+	}
+
+	static void initialize(loader_info& info)
+	{
+		info.initialized = true;
+		try {
+			info.initializer();
+		} catch (const std::exception& ex) {
+			DLOG_ERROR("Initializer threw exception: %s", ex.what());
+		} catch (...) {
+			DLOG_ERROR("Initializer threw unknown exception.");
+		}
+	}
+
+	static void initialize_deferred()
+	{
+		for (auto info : get_deferred()) {
+			initialize(*info);
+		}
+		get_deferred().clear();
+	}
+
+#ifdef ENABLE_FRONTEND
+	static void frontend_event_handler(obs_frontend_event event, void*)
+	{
+		if (event == OBS_FRONTEND_EVENT_FINISHED_LOADING) {
+			obs_frontend_remove_event_callback(frontend_event_handler, nullptr);
+			initialize_deferred();
 		}
 	}
+#endif
 } // namespace streamfx
 
 MODULE_EXPORT bool obs_module_load(void)
@@ -78,27 +121,32 @@ MODULE_EXPORT bool obs_module_load(void)
 			}
 		}
 
-#ifdef ENABLE_NVIDIA_CUDA
-		// Initialize CUDA if features requested it.
-		std::shared_ptr<::streamfx::nvidia::cuda::obs> cuda;
-		try {
-			cuda = ::streamfx::nvidia::cuda::obs::get();
-		} catch (...) {
-			// If CUDA failed to load, it is considered safe to ignore.
-		}
-#endif
-
-		// Run all initializers.
+		// Run all initializers, one priority after another. Concurrent ones go to the thread pool first, so that they can
+		// overlap with the serial ones, which stay on this thread as registering anything with libobs is not thread-safe.
 		for (auto kv : streamfx::get_initializers()) {
-			for (auto init : kv.second) {
-				try {
-					init();
-				} catch (const std::exception& ex) {
-					DLOG_ERROR("Initializer threw exception: %s", ex.what());
-				} catch (...) {
-					DLOG_ERROR("Initializer threw unknown exception.");
+			std::vector<std::shared_ptr<streamfx::util::threadpool::task>> tasks;
+			for (auto info : kv.second) {
+				if (info->mode == streamfx::loader_mode::CONCURRENT) {
+					info->initialized = true;
+					tasks.push_back(streamfx::threadpool()->push([info](streamfx::util::threadpool::task_data_t) { streamfx::initialize(*info); }));
 				}
 			}
+			for (auto info : kv.second) {
+				if (info->mode == streamfx::loader_mode::SERIAL) {
+					streamfx::initialize(*info);
+				} else if (info->mode == streamfx::loader_mode::DEFERRED) {
+					streamfx::get_deferred().push_back(info);
+				}
+			}
+			streamfx::threadpool()->join(tasks);
+		}
+
+		if (!streamfx::get_deferred().empty()) {
+#ifdef ENABLE_FRONTEND
+			obs_frontend_add_event_callback(streamfx::frontend_event_handler, nullptr);
+#else
+			streamfx::initialize_deferred();
+#endif
 		}
 
 		DLOG_INFO("Loaded Version %s", STREAMFX_VERSION_STRING);
@@ -117,11 +165,20 @@ MODULE_EXPORT void obs_module_unload(void)
 	try {
 		DLOG_INFO("Unloading Version %s", STREAMFX_VERSION_STRING);
 
-		// Run all finalizers.
+#ifdef ENABLE_FRONTEND
+		obs_frontend_remove_event_callback(streamfx::frontend_event_handler, nullptr);
+#endif
+		streamfx::get_deferred().clear();
+
+		// Run all finalizers whose initializer ran.
 		for (auto kv : streamfx::get_finalizers()) {
-			for (auto init : kv.second) {
+			for (auto info : kv.second) {
+				if (!info->initialized) {
+					continue;
+				}
+				info->initialized = false;
 				try {
-					init();
+					info->finalizer();
 				} catch (const std::exception& ex) {
 					DLOG_ERROR("Finalizer threw exception: %s", ex.what());
 				} catch (...) {
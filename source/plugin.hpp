@@ -27,8 +27,19 @@ namespace streamfx {
 		LOWEST  = INT32_MAX,
 	};
 
+	/** How an initializer is run.
+	 *
+	 * Priorities are the dependencies between loaders: every initializer may rely on all initializers of a higher
+	 * priority having completed, but on nothing within its own priority.
+	 */
+	enum class loader_mode {
+		SERIAL, // Run on the thread loading the plugin, in order of registration.
+		CONCURRENT, // Run in the thread pool, alongside other initializers of the same priority. Must not register anything with libobs.
+		DEFERRED, // Run once OBS finished loading, for anything that is not needed to load a scene collection.
+	};
+
 	struct loader {
-		loader(loader_function_t initializer, loader_function_t finalizer, loader_priority_t priority);
+		loader(loader_function_t initializer, loader_function_t finalizer, loader_priority_t priority, loader_mode mode = loader_mode::SERIAL);
 
 		// Usage:
 		// auto loader = streamfx::loader([]() { ... }, []() { ... }, 0);
@@ -5,7 +5,7 @@
 
 #include "source-mirror.hpp"
 #include "strings.hpp"
-#include <bitset>
+#include <algorithm>
 #include <cstring>
 #include <functional>
 #include <memory>
@@ -16,6 +16,7 @@
 #include "obs/obs-source-tracker.hpp"
 #include "obs/obs-tools.hpp"
 #include "util/util-logging.hpp"
+#include "util/util-simd.hpp"
 
 #ifdef _DEBUG
 #define ST_PREFIX "<%s> "
@@ -52,6 +53,8 @@
 #define ST_I18N "Source.Mirror"
 #define ST_I18N_SOURCE ST_I18N ".Source"
 #define ST_KEY_SOURCE "Source.Mirror.Source"
+#define ST_I18N_SOURCE_SHARED ST_I18N_SOURCE ".Shared"
+#define ST_KEY_SOURCE_SHARED "Source.Mirror.Shared"
 #define ST_I18N_SOURCE_AUDIO ST_I18N_SOURCE ".Audio"
 #define ST_KEY_SOURCE_AUDIO "Source.Mirror.Audio"
 #define ST_I18N_SOURCE_AUDIO_LAYOUT ST_I18N_SOURCE_AUDIO ".Layout"
@@ -62,30 +65,136 @@ using namespace streamfx::source::mirror;
 
 static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-StreamFX/wiki/Source-Mirror";
 
-mirror_audio_data::mirror_audio_data(const audio_data* audio, speaker_layout layout)
-{
-	// Build a clone of a packet.
-	audio_t*                 oad = obs_get_audio();
-	const audio_output_info* aoi = audio_output_get_info(oad);
-	osa.frames                   = audio->frames;
-	osa.timestamp                = audio->timestamp;
-	osa.speakers                 = layout;
-	osa.format                   = aoi->format;
-	osa.samples_per_sec          = aoi->samples_per_sec;
-	data.resize(MAX_AV_PLANES);
-	for (std::size_t idx = 0; idx < MAX_AV_PLANES; idx++) {
-		if (!audio->data[idx]) {
-			osa.data[idx] = nullptr;
-			continue;
+namespace {
+	// Speakers in the order libobs stores their planes, see speaker_layout.
+	enum class audio_channel : uint8_t { M, FL, FR, FC, LFE, RC, RL, RR, SL, SR };
+
+	std::size_t layout_channels(speaker_layout layout, std::array<audio_channel, MAX_AV_PLANES>& channels)
+	{
+		using ac = audio_channel;
+		switch (layout) {
+		case SPEAKERS_MONO:
+			channels = {ac::M};
+			return 1;
+		case SPEAKERS_STEREO:
+			channels = {ac::FL, ac::FR};
+			return 2;
+		case SPEAKERS_2POINT1:
+			channels = {ac::FL, ac::FR, ac::LFE};
+			return 3;
+		case SPEAKERS_4POINT0:
+			channels = {ac::FL, ac::FR, ac::FC, ac::RC};
+			return 4;
+		case SPEAKERS_4POINT1:
+			channels = {ac::FL, ac::FR, ac::FC, ac::LFE, ac::RC};
+			return 5;
+		case SPEAKERS_5POINT1:
+			channels = {ac::FL, ac::FR, ac::FC, ac::LFE, ac::RL, ac::RR};
+			return 6;
+		case SPEAKERS_7POINT1:
+			channels = {ac::FL, ac::FR, ac::FC, ac::LFE, ac::RL, ac::RR, ac::SL, ac::SR};
+			return 8;
+		default:
+			return 0;
 		}
+	}
 
-		data[idx].resize(audio->frames * get_audio_bytes_per_channel(osa.format));
-		memcpy(data[idx].data(), audio->data[idx], data[idx].size());
-		osa.data[idx] = data[idx].data();
+	speaker_layout layout_from_planes(std::size_t planes)
+	{
+		switch (planes) {
+		case 1:
+			return SPEAKERS_MONO;
+		case 2:
+			return SPEAKERS_STEREO;
+		case 3:
+			return SPEAKERS_2POINT1;
+		case 4:
+			return SPEAKERS_4POINT0;
+		case 5:
+			return SPEAKERS_4POINT1;
+		case 6:
+			return SPEAKERS_5POINT1;
+		case 8:
+			return SPEAKERS_7POINT1;
+		default:
+			return SPEAKERS_UNKNOWN;
+		}
 	}
-}
 
-mirror_instance::mirror_instance(obs_data_t* settings, obs_source_t* self) : obs::source_instance(settings, self), _source(), _source_child(), _signal_rename(), _audio_enabled(false), _audio_layout(SPEAKERS_UNKNOWN)
+	/** Gains for converting between two layouts, using the ITU-R BS.775 downmix coefficients.
+	 *
+	 * Speakers missing from the target are folded into their nearest neighbours at -3 dB, LFE is dropped unless the
+	 * target has one, and upmixing leaves the additional speakers silent instead of inventing content for them.
+	 */
+	void build_mix(speaker_layout from, speaker_layout to, std::array<std::array<float, MAX_AV_PLANES>, MAX_AV_PLANES>& gains)
+	{
+		constexpr float sqrt1_2 = 0.70710678f;
+
+		std::array<audio_channel, MAX_AV_PLANES> inputs  = {};
+		std::array<audio_channel, MAX_AV_PLANES> outputs = {};
+		std::size_t                              count   = layout_channels(from, inputs);
+		std::size_t                              targets = layout_channels(to, outputs);
+
+		gains = {};
+		for (std::size_t in = 0; in < count; in++) {
+			auto add = [&](audio_channel channel, float gain) {
+				for (std::size_t out = 0; out < targets; out++) {
+					if (outputs[out] == channel) {
+						gains[out][in] += gain;
+						return true;
+					}
+				}
+				return false;
+			};
+			std::function<void(audio_channel, float)> route = [&](audio_channel channel, float gain) {
+				using ac = audio_channel;
+				if (add(channel, gain)) {
+					return;
+				}
+
+				switch (channel) {
+				case ac::M:
+					if (!add(ac::FC, gain)) {
+						add(ac::FL, gain);
+						add(ac::FR, gain);
+					}
+					break;
+				case ac::FL:
+				case ac::FR:
+					add(ac::M, gain * .5f);
+					break;
+				case ac::FC:
+					route(ac::FL, gain * sqrt1_2);
+					route(ac::FR, gain * sqrt1_2);
+					break;
+				case ac::LFE:
+					break;
+				case ac::RC:
+					if (!add(ac::RL, gain * sqrt1_2) || !add(ac::RR, gain * sqrt1_2)) {
+						route(ac::FL, gain * .5f);
+						route(ac::FR, gain * .5f);
+					}
+					break;
+				case ac::RL:
+				case ac::SL:
+					if (!add((channel == ac::RL) ? ac::SL : ac::RL, gain) && !add(ac::RC, gain * sqrt1_2)) {
+						route(ac::FL, gain * sqrt1_2);
+					}
+					break;
+				case ac::RR:
+				case ac::SR:
+					if (!add((channel == ac::RR) ? ac::SR : ac::RR, gain) && !add(ac::RC, gain * sqrt1_2)) {
+						route(ac::FR, gain * sqrt1_2);
+					}
+					break;
+				}
+			};
+			route(inputs[in], 1.f);
+		}
+	}
+} // namespace
+
+mirror_instance::mirror_instance(obs_data_t* settings, obs_source_t* self) : obs::source_instance(settings, self), _source(), _source_child(), _signal_rename(), _shared(true), _cache(), _audio_enabled(false), _audio_layout(SPEAKERS_UNKNOWN), _audio_mix_from(SPEAKERS_UNKNOWN), _audio_mix_to(SPEAKERS_UNKNOWN), _audio_mix(), _audio_slots(), _audio_plane_size(0), _audio_head(0), _audio_tail(0), _audio_lock(), _audio_notify(), _audio_stop(false), _audio_thread()
 {
 	update(settings);
 }
@@ -93,6 +202,7 @@ mirror_instance::mirror_instance(obs_data_t* settings, obs_source_t* self) : obs
 mirror_instance::~mirror_instance()
 {
 	release();
+	audio_stop();
 }
 
 uint32_t mirror_instance::get_width()
@@ -124,6 +234,8 @@ void mirror_instance::migrate(obs_data_t* data, uint64_t version)
 void mirror_instance::update(obs_data_t* data)
 {
 	// Audio
+	_shared = obs_data_get_bool(data, ST_KEY_SOURCE_SHARED);
+
 	_audio_enabled = obs_data_get_bool(data, ST_KEY_SOURCE_AUDIO);
 	_audio_layout  = static_cast<speaker_layout>(obs_data_get_int(data, ST_KEY_SOURCE_AUDIO_LAYOUT));
 
@@ -140,7 +252,7 @@ void mirror_instance::save(obs_data_t* data)
 	}
 }
 
-void mirror_instance::video_tick(float_t time) {}
+void mirror_instance::video_tick(float_t time) noexcept {}
 
 void mirror_instance::video_render(gs_effect_t* effect)
 {
@@ -156,7 +268,19 @@ void mirror_instance::video_render(gs_effect_t* effect)
 	_source_size.first  = obs_source_get_width(_source.get());
 	_source_size.second = obs_source_get_height(_source.get());
 
-	obs_source_video_render(_source.get());
+	// Asynchronous sources already keep their frame in a texture, and HDR can't pass through the shared copy, so
+	// these are always rendered directly. Anything else is rendered once per frame and shared with other mirrors.
+	uint32_t flags = obs_source_get_output_flags(_source.get());
+	if (_shared && ((flags & OBS_SOURCE_ASYNC) == 0) && (gs_get_color_space() == GS_CS_SRGB) && (_source_size.first > 0) && (_source_size.second > 0)) {
+		if (!_cache) {
+			_cache = ::streamfx::gfx::source_texture_cache::get();
+		}
+
+		auto texture = _cache->render(_source.get(), _source_size.first, _source_size.second, GS_CS_SRGB, GS_RGBA, gs_get_linear_srgb());
+		obs_source_draw(texture->get_object(), 0, 0, _source_size.first, _source_size.second, false);
+	} else {
+		obs_source_video_render(_source.get());
+	}
 }
 
 void mirror_instance::enum_active_sources(obs_source_enum_proc_t cb, void* ptr)
@@ -193,6 +317,7 @@ void mirror_instance::acquire(std::string source_name)
 
 		// Listen to any audio the source spews out.
 		if (_audio_enabled) {
+			audio_start();
 			_signal_audio = std::make_shared<obs::audio_signal_handler>(_source);
 			_signal_audio->event.add(std::bind(&mirror_instance::on_audio, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
 		}
@@ -216,58 +341,139 @@ void mirror_instance::on_audio(::streamfx::obs::source, const audio_data* audio,
 		return;
 	}
 
-	// Detect Audio Layout from underlying audio.
-	speaker_layout detected_layout;
-	if (_audio_layout != SPEAKERS_UNKNOWN) {
-		detected_layout = _audio_layout;
-	} else {
-		std::bitset<MAX_AV_PLANES> layout_detection;
-		for (std::size_t idx = 0; idx < MAX_AV_PLANES; idx++) {
-			layout_detection.set(idx, audio->data[idx] != nullptr);
-		}
-		switch (layout_detection.to_ulong()) {
-		case 0b00000001:
-			detected_layout = SPEAKERS_MONO;
-			break;
-		case 0b00000011:
-			detected_layout = SPEAKERS_STEREO;
-			break;
-		case 0b00000111:
-			detected_layout = SPEAKERS_2POINT1;
-			break;
-		case 0b00001111:
-			detected_layout = SPEAKERS_4POINT0;
-			break;
-		case 0b00011111:
-			detected_layout = SPEAKERS_4POINT1;
-			break;
-		case 0b00111111:
-			detected_layout = SPEAKERS_5POINT1;
-			break;
-		case 0b11111111:
-			detected_layout = SPEAKERS_7POINT1;
-			break;
-		default:
-			detected_layout = SPEAKERS_UNKNOWN;
+	// libobs fills planes from the front, so the number of planes is enough to tell the layout.
+	std::size_t planes = 0;
+	while ((planes < MAX_AV_PLANES) && audio->data[planes]) {
+		planes++;
+	}
+	speaker_layout source_layout = layout_from_planes(planes);
+	speaker_layout target_layout = (_audio_layout != SPEAKERS_UNKNOWN) ? _audio_layout : source_layout;
+
+	// Pass planes through as they are unless the layouts differ, in which case the conversion is written straight
+	// into the ring. Converting here is cheaper than having libobs resample each mirror, and only copies the channels
+	// that are actually output.
+	bool convert = (source_layout != SPEAKERS_UNKNOWN) && (target_layout != source_layout) && (_audio_slots[0].osa.format == AUDIO_FORMAT_FLOAT_PLANAR);
+	if (convert && ((_audio_mix_from != source_layout) || (_audio_mix_to != target_layout))) {
+		build_mix(source_layout, target_layout, _audio_mix);
+		_audio_mix_from = source_layout;
+		_audio_mix_to   = target_layout;
+	}
+
+	// Copy the packet into free slots, split into pieces no larger than a slot.
+	bool        pushed = false;
+	std::size_t head   = _audio_head.load(std::memory_order_relaxed);
+	for (uint32_t offset = 0; offset < audio->frames;) {
+		if ((head - _audio_tail.load(std::memory_order_acquire)) >= audio_ring) {
+			D_LOG_DEBUG("Dropping %" PRIu32 " frames of audio, the output is falling behind.", audio->frames - offset);
 			break;
 		}
+
+		auto&       slot  = _audio_slots[head % audio_ring];
+		std::size_t bpc   = get_audio_bytes_per_channel(slot.osa.format);
+		uint32_t    count = std::min<uint32_t>(audio->frames - offset, static_cast<uint32_t>(_audio_plane_size / bpc));
+
+		slot.osa.frames    = count;
+		slot.osa.timestamp = audio->timestamp + (static_cast<uint64_t>(offset) * 1000000000ULL / slot.osa.samples_per_sec);
+		slot.osa.speakers  = target_layout;
+		if (convert) {
+			auto&       simd    = ::streamfx::util::simd::get();
+			std::size_t outputs = get_audio_channels(target_layout);
+			for (std::size_t out = 0; out < MAX_AV_PLANES; out++) {
+				if (out >= outputs) {
+					slot.osa.data[out] = nullptr;
+					continue;
+				}
+
+				float* plane = reinterpret_cast<float*>(slot.data.data() + (out * _audio_plane_size));
+				std::fill(plane, plane + count, 0.f);
+				for (std::size_t in = 0; in < planes; in++) {
+					if (_audio_mix[out][in] != 0.f) {
+						simd.mix(plane, reinterpret_cast<const float*>(audio->data[in]) + offset, _audio_mix[out][in], count);
+					}
+				}
+				slot.osa.data[out] = reinterpret_cast<uint8_t*>(plane);
+			}
+		} else {
+			for (std::size_t idx = 0; idx < MAX_AV_PLANES; idx++) {
+				if (!audio->data[idx]) {
+					slot.osa.data[idx] = nullptr;
+					continue;
+				}
+
+				uint8_t* plane = slot.data.data() + (idx * _audio_plane_size);
+				memcpy(plane, audio->data[idx] + (offset * bpc), count * bpc);
+				slot.osa.data[idx] = plane;
+			}
+		}
+
+		offset += count;
+		head++;
+		_audio_head.store(head, std::memory_order_release);
+		pushed = true;
 	}
 
-	{
-		std::unique_lock<std::mutex> ul(_audio_queue_lock);
-		_audio_queue.emplace(audio, detected_layout);
+	if (pushed) {
+		{ // Synchronize with the output thread, so that it can't miss the notification.
+			std::lock_guard<std::mutex> lg(_audio_lock);
+		}
+		_audio_notify.notify_one();
+	}
+}
+
+void mirror_instance::audio_start()
+{
+	if (_audio_thread.joinable()) {
+		return;
+	}
+
+	// Preallocate every slot for the largest packet libobs mixes.
+	const audio_output_info* aoi = audio_output_get_info(obs_get_audio());
+	_audio_plane_size            = AUDIO_OUTPUT_FRAMES * get_audio_bytes_per_channel(aoi->format);
+	for (auto& slot : _audio_slots) {
+		slot.data.resize(_audio_plane_size * MAX_AV_PLANES);
+		slot.osa                 = {};
+		slot.osa.format          = aoi->format;
+		slot.osa.samples_per_sec = aoi->samples_per_sec;
 	}
+	_audio_head = 0;
+	_audio_tail = 0;
 
-	// Create a clone of the audio data and push it to the thread pool.
-	streamfx::threadpool()->push(std::bind(&mirror_instance::audio_output, this, std::placeholders::_1), nullptr);
+	_audio_stop   = false;
+	_audio_thread = std::thread(&mirror_instance::audio_output, this);
 }
 
-void mirror_instance::audio_output(std::shared_ptr<void> data)
+void mirror_instance::audio_stop()
 {
-	std::unique_lock<std::mutex> ul(_audio_queue_lock);
-	while (_audio_queue.size() > 0) {
-		obs_source_output_audio(_self, &((_audio_queue.front()).osa));
-		_audio_queue.pop();
+	if (!_audio_thread.joinable()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lg(_audio_lock);
+		_audio_stop = true;
+	}
+	_audio_notify.notify_one();
+	_audio_thread.join();
+}
+
+void mirror_instance::audio_output()
+{
+	std::size_t tail = _audio_tail.load(std::memory_order_relaxed);
+	while (true) {
+		{
+			std::unique_lock<std::mutex> ul(_audio_lock);
+			_audio_notify.wait(ul, [this, tail]() { return _audio_stop || (_audio_head.load(std::memory_order_acquire) != tail); });
+			if (_audio_stop) {
+				return;
+			}
+		}
+
+		// Output without holding the lock, so that the audio thread is never blocked by it.
+		while (_audio_head.load(std::memory_order_acquire) != tail) {
+			obs_source_output_audio(_self, &_audio_slots[tail % audio_ring].osa);
+			tail++;
+			_audio_tail.store(tail, std::memory_order_release);
+		}
 	}
 }
 
@@ -293,6 +499,7 @@ const char* mirror_factory::get_name()
 void mirror_factory::get_defaults2(obs_data_t* data)
 {
 	obs_data_set_default_string(data, ST_KEY_SOURCE, "");
+	obs_data_set_default_bool(data, ST_KEY_SOURCE_SHARED, true);
 	obs_data_set_default_bool(data, ST_KEY_SOURCE_AUDIO, false);
 	obs_data_set_default_int(data, ST_KEY_SOURCE_AUDIO_LAYOUT, static_cast<int64_t>(SPEAKERS_UNKNOWN));
 }
@@ -345,6 +552,10 @@ obs_properties_t* mirror_factory::get_properties2(mirror_instance* data)
 			obs::source_tracker::filter_scenes);
 	}
 
+	{
+		p = obs_properties_add_bool(pr, ST_KEY_SOURCE_SHARED, D_TRANSLATE(ST_I18N_SOURCE_SHARED));
+	}
+
 	{
 		p = obs_properties_add_bool(pr, ST_KEY_SOURCE_AUDIO, D_TRANSLATE(ST_I18N_SOURCE_AUDIO));
 		obs_property_set_modified_callback(p, modified_properties);
@@ -14,34 +14,51 @@
 #include "obs/obs-tools.hpp"
 
 #include "warning-disable.hpp"
+#include <array>
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::source::mirror {
-	struct mirror_audio_data {
-		mirror_audio_data(const audio_data*, speaker_layout);
-
-		obs_source_audio                  osa;
-		std::vector<std::vector<uint8_t>> data;
+	struct mirror_audio_slot {
+		obs_source_audio     osa;
+		std::vector<uint8_t> data; // All planes, each AUDIO_OUTPUT_FRAMES long.
 	};
 
-	class mirror_instance : public obs::source_instance {
+	class mirror_instance final : public obs::source_instance {
 		// Source
-		::streamfx::obs::source                               _source;
-		std::shared_ptr<::streamfx::obs::source_active_child> _source_child;
-		std::shared_ptr<obs::source_signal_handler>           _signal_rename;
-		std::shared_ptr<obs::audio_signal_handler>            _signal_audio;
-		std::pair<uint32_t, uint32_t>                         _source_size;
+		::streamfx::obs::source                                _source;
+		std::shared_ptr<::streamfx::obs::source_active_child>  _source_child;
+		std::shared_ptr<obs::source_signal_handler>            _signal_rename;
+		std::shared_ptr<obs::audio_signal_handler>             _signal_audio;
+		std::pair<uint32_t, uint32_t>                          _source_size;
+		bool                                                   _shared;
+		std::shared_ptr<::streamfx::gfx::source_texture_cache> _cache;
 
 		// Audio
-		bool                          _audio_enabled;
-		speaker_layout                _audio_layout;
-		std::mutex                    _audio_queue_lock;
-		std::queue<mirror_audio_data> _audio_queue;
+		bool           _audio_enabled;
+		speaker_layout _audio_layout;
+
+		// Gains from each source channel to each output channel as [output][input], rebuilt whenever either layout
+		// changes. Only used from the audio thread.
+		speaker_layout                                              _audio_mix_from;
+		speaker_layout                                              _audio_mix_to;
+		std::array<std::array<float, MAX_AV_PLANES>, MAX_AV_PLANES> _audio_mix;
+
+		// Audio is handed to the output thread through a single producer, single consumer ring of preallocated
+		// slots. The lock and condition variable only exist to wake the output thread up.
+		static constexpr std::size_t              audio_ring = 16;
+		std::array<mirror_audio_slot, audio_ring> _audio_slots;
+		std::size_t                               _audio_plane_size;
+		std::atomic<std::size_t>                  _audio_head;
+		std::atomic<std::size_t>                  _audio_tail;
+		std::mutex                                _audio_lock;
+		std::condition_variable                   _audio_notify;
+		bool                                      _audio_stop;
+		std::thread                               _audio_thread;
 
 		public:
 		mirror_instance(obs_data_t* settings, obs_source_t* self);
@@ -55,7 +72,7 @@ namespace streamfx::source::mirror {
 		virtual void update(obs_data_t*) override;
 		virtual void save(obs_data_t*) override;
 
-		virtual void video_tick(float_t) override;
+		virtual void video_tick(float_t) noexcept override;
 		virtual void video_render(gs_effect_t*) override;
 
 		virtual void enum_active_sources(obs_source_enum_proc_t, void*) override;
@@ -67,7 +84,9 @@ namespace streamfx::source::mirror {
 
 		void on_audio(::streamfx::obs::source, const struct audio_data*, bool);
 
-		void audio_output(std::shared_ptr<void> data);
+		void audio_start();
+		void audio_stop();
+		void audio_output();
 	};
 
 	class mirror_factory : public obs::source_factory<source::mirror::mirror_factory, source::mirror::mirror_instance> {
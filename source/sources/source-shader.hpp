@@ -11,7 +11,7 @@
 #include "plugin.hpp"
 
 namespace streamfx::source::shader {
-	class shader_instance : public obs::source_instance {
+	class shader_instance final : public obs::source_instance {
 		std::shared_ptr<streamfx::gfx::shader::shader> _fx;
 
 		public:
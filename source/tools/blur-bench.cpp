@@ -0,0 +1,436 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+// Offline GPU benchmark for the StreamFX blur algorithms.
+//
+// Starts a headless libOBS, loads the StreamFX module, and renders a synthetic source through the Blur filter for every
+// combination of blur type, resolution, size and step scale that was asked for. Each sample is measured on the GPU with
+// timestamp queries, so that CPU overhead and vsync do not distort the numbers. Results are reported as CSV on stdout,
+// one line per combination, while the regular log goes to stderr.
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <graphics/graphics.h>
+#include <obs-module.h>
+#include <obs.h>
+#include <util/platform.h>
+#include "warning-enable.hpp"
+
+#ifndef STREAMFX_MODULE_PATH
+#define STREAMFX_MODULE_PATH ""
+#endif
+#ifndef STREAMFX_DATA_PATH
+#define STREAMFX_DATA_PATH ""
+#endif
+
+#define BENCH_SOURCE_ID "streamfx-blur-bench-source"
+#define BENCH_FILTER_ID "streamfx-filter-blur"
+
+struct bench_resolution {
+	uint32_t width;
+	uint32_t height;
+};
+
+struct bench_options {
+	std::string                   module_path = STREAMFX_MODULE_PATH;
+	std::string                   data_path   = STREAMFX_DATA_PATH;
+	std::vector<std::string>      types       = {"box", "box_linear", "gaussian", "gaussian_linear", "dual_filtering"};
+	std::string                   subtype     = "area";
+	std::vector<bench_resolution> resolutions = {{1280, 720}, {1920, 1080}, {3840, 2160}};
+	std::vector<double>           sizes       = {4, 8, 16, 32, 64};
+	std::vector<double>           steps       = {1.};
+	uint32_t                      warmup      = 10;
+	uint32_t                      samples     = 100;
+};
+
+struct bench_result {
+	std::vector<double> times; // GPU time of each sample in milliseconds.
+	uint32_t            disjoint = 0;
+};
+
+//------------------------------------------------------------------------------
+// Logging
+//------------------------------------------------------------------------------
+
+static void log_handler(int level, const char* format, va_list args, void*)
+{
+	if (level <= LOG_WARNING) {
+		vfprintf(stderr, format, args);
+		fprintf(stderr, "\n");
+	}
+}
+
+//------------------------------------------------------------------------------
+// Source
+//------------------------------------------------------------------------------
+// A source with fine detail everywhere, so that every blur has something to do.
+
+struct bench_source {
+	uint32_t      width;
+	uint32_t      height;
+	gs_texture_t* texture;
+};
+
+static bench_resolution current_resolution = {1920, 1080};
+
+static const char* bench_source_get_name(void*)
+{
+	return "StreamFX Blur Benchmark";
+}
+
+static void* bench_source_create(obs_data_t*, obs_source_t*)
+{
+	auto data    = new bench_source();
+	data->width  = current_resolution.width;
+	data->height = current_resolution.height;
+
+	std::vector<uint32_t> pixels(static_cast<size_t>(data->width) * data->height);
+	for (uint32_t y = 0; y < data->height; y++) {
+		for (uint32_t x = 0; x < data->width; x++) {
+			uint32_t v                                     = (x * 7 + y * 13 + ((x ^ y) & 0xFF)) & 0xFF;
+			pixels[static_cast<size_t>(y) * data->width + x] = 0xFF000000 | (v << 16) | (((x + y) & 0xFF) << 8) | (255 - v);
+		}
+	}
+	const uint8_t* planes[] = {reinterpret_cast<const uint8_t*>(pixels.data())};
+
+	obs_enter_graphics();
+	data->texture = gs_texture_create(data->width, data->height, GS_RGBA, 1, planes, 0);
+	obs_leave_graphics();
+
+	return data;
+}
+
+static void bench_source_destroy(void* ptr)
+{
+	auto data = reinterpret_cast<bench_source*>(ptr);
+	obs_enter_graphics();
+	gs_texture_destroy(data->texture);
+	obs_leave_graphics();
+	delete data;
+}
+
+static uint32_t bench_source_get_width(void* ptr)
+{
+	return reinterpret_cast<bench_source*>(ptr)->width;
+}
+
+static uint32_t bench_source_get_height(void* ptr)
+{
+	return reinterpret_cast<bench_source*>(ptr)->height;
+}
+
+static void bench_source_video_render(void* ptr, gs_effect_t*)
+{
+	auto data = reinterpret_cast<bench_source*>(ptr);
+	if (data->texture) {
+		obs_source_draw(data->texture, 0, 0, 0, 0, false);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Report
+//------------------------------------------------------------------------------
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+	if (sorted.empty()) {
+		return 0;
+	}
+	size_t idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+	return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+static void report_header()
+{
+	printf("type,subtype,width,height,size,step_scale,samples,disjoint,average_ms,min_ms,p50_ms,p95_ms,max_ms\n");
+}
+
+static void report(const bench_options& opts, const std::string& type, bench_resolution res, double size, double step, bench_result& result)
+{
+	std::sort(result.times.begin(), result.times.end());
+
+	double average = 0;
+	for (auto v : result.times) {
+		average += v;
+	}
+	average = result.times.empty() ? 0 : (average / static_cast<double>(result.times.size()));
+
+	printf("%s,%s,%" PRIu32 ",%" PRIu32 ",%.2f,%.2f,%zu,%" PRIu32 ",%.4f,%.4f,%.4f,%.4f,%.4f\n", type.c_str(), opts.subtype.c_str(), res.width, res.height, size, step, result.times.size(), result.disjoint, average, result.times.empty() ? 0. : result.times.front(), percentile(result.times, 0.5), percentile(result.times, 0.95), result.times.empty() ? 0. : result.times.back());
+	fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+// Main
+//------------------------------------------------------------------------------
+
+static void usage()
+{
+	fprintf(stderr, "Usage: streamfx-blur-bench [options]\n"
+					"  --types <a,b,...>        Blur types (default box,box_linear,gaussian,gaussian_linear,dual_filtering).\n"
+					"  --subtype <name>         area, directional, rotational or zoom (default area).\n"
+					"  --resolutions <WxH,...>  Resolutions (default 1280x720,1920x1080,3840x2160).\n"
+					"  --sizes <a,b,...>        Blur sizes (default 4,8,16,32,64).\n"
+					"  --steps <a,b,...>        Step scales, 1.0 being no scaling (default 1.0).\n"
+					"  --warmup <n>             Unmeasured renders before measuring (default 10).\n"
+					"  --samples <n>            Measured renders per combination (default 100).\n"
+					"  --module <path>          Path to the StreamFX module.\n"
+					"  --data <path>            Path to the StreamFX data directory.\n");
+}
+
+static std::vector<std::string> split(const std::string& text)
+{
+	std::vector<std::string> parts;
+	for (size_t start = 0; start <= text.size();) {
+		size_t end = text.find(',', start);
+		if (end == std::string::npos) {
+			end = text.size();
+		}
+		if (end > start) {
+			parts.push_back(text.substr(start, end - start));
+		}
+		start = end + 1;
+	}
+	return parts;
+}
+
+static bench_options parse_options(int argc, char** argv)
+{
+	bench_options opts;
+	for (int idx = 1; idx < argc; idx++) {
+		std::string arg = argv[idx];
+		auto        next = [&]() {
+			if (++idx >= argc) {
+				throw std::invalid_argument("Missing value for '" + arg + "'.");
+			}
+			return std::string(argv[idx]);
+		};
+
+		if (arg == "--types") {
+			opts.types = split(next());
+		} else if (arg == "--subtype") {
+			opts.subtype = next();
+		} else if (arg == "--resolutions") {
+			opts.resolutions.clear();
+			for (auto& part : split(next())) {
+				bench_resolution res;
+				if ((sscanf(part.c_str(), "%" SCNu32 "x%" SCNu32, &res.width, &res.height) != 2) || !res.width || !res.height) {
+					throw std::invalid_argument("Invalid resolution '" + part + "'.");
+				}
+				opts.resolutions.push_back(res);
+			}
+		} else if (arg == "--sizes") {
+			opts.sizes.clear();
+			for (auto& part : split(next())) {
+				opts.sizes.push_back(std::stod(part));
+			}
+		} else if (arg == "--steps") {
+			opts.steps.clear();
+			for (auto& part : split(next())) {
+				opts.steps.push_back(std::stod(part));
+			}
+		} else if (arg == "--warmup") {
+			opts.warmup = static_cast<uint32_t>(std::stoul(next()));
+		} else if (arg == "--samples") {
+			opts.samples = static_cast<uint32_t>(std::stoul(next()));
+		} else if (arg == "--module") {
+			opts.module_path = next();
+		} else if (arg == "--data") {
+			opts.data_path = next();
+		} else {
+			throw std::invalid_argument("Unknown option '" + arg + "'.");
+		}
+	}
+
+	if (opts.types.empty() || opts.resolutions.empty() || opts.sizes.empty() || opts.steps.empty() || !opts.samples) {
+		throw std::invalid_argument("Missing or invalid required options.");
+	}
+	return opts;
+}
+
+static void initialize_obs(const bench_options& opts)
+{
+	if (!obs_startup("en-US", nullptr, nullptr)) {
+		throw std::runtime_error("Failed to start libOBS.");
+	}
+
+	// Nothing is ever shown, the video settings only exist to create a graphics context.
+	obs_video_info ovi = {};
+#ifdef _WIN32
+	ovi.graphics_module = "libobs-d3d11";
+#else
+	ovi.graphics_module = "libobs-opengl";
+#endif
+	ovi.fps_num        = 30;
+	ovi.fps_den        = 1;
+	ovi.base_width     = 1280;
+	ovi.base_height    = 720;
+	ovi.output_width   = 1280;
+	ovi.output_height  = 720;
+	ovi.output_format  = VIDEO_FORMAT_NV12;
+	ovi.colorspace     = VIDEO_CS_709;
+	ovi.range          = VIDEO_RANGE_PARTIAL;
+	ovi.gpu_conversion = true;
+	ovi.scale_type     = OBS_SCALE_BICUBIC;
+	if (int res = obs_reset_video(&ovi); res != OBS_VIDEO_SUCCESS) {
+		throw std::runtime_error("Failed to initialize video (" + std::to_string(res) + ").");
+	}
+
+	obs_module_t* module = nullptr;
+	if (obs_open_module(&module, opts.module_path.c_str(), opts.data_path.c_str()) != MODULE_SUCCESS) {
+		throw std::runtime_error("Failed to open StreamFX module at '" + opts.module_path + "'.");
+	}
+	if (!obs_init_module(module)) {
+		throw std::runtime_error("Failed to initialize StreamFX module.");
+	}
+	obs_post_load_modules();
+
+	static obs_source_info source = {};
+	source.id                     = BENCH_SOURCE_ID;
+	source.type                   = OBS_SOURCE_TYPE_INPUT;
+	source.output_flags           = OBS_SOURCE_VIDEO;
+	source.get_name               = bench_source_get_name;
+	source.create                 = bench_source_create;
+	source.destroy                = bench_source_destroy;
+	source.get_width              = bench_source_get_width;
+	source.get_height             = bench_source_get_height;
+	source.video_render           = bench_source_video_render;
+	obs_register_source(&source);
+}
+
+static bench_result measure(const bench_options& opts, obs_source_t* source, obs_source_t* filter, bench_resolution res)
+{
+	bench_result result;
+
+	obs_enter_graphics();
+	gs_texrender_t*    target = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+	gs_timer_range_t*  range  = gs_timer_range_create();
+	gs_timer_t*        timer  = gs_timer_create();
+	obs_leave_graphics();
+	if (!target || !range || !timer) {
+		throw std::runtime_error("Failed to create render target or timer queries.");
+	}
+
+	for (uint32_t idx = 0, edx = opts.warmup + opts.samples; idx < edx; idx++) {
+		// The filter caches its result until the next tick, so tick it before every render.
+		obs_source_video_tick(filter, 0.f);
+
+		obs_enter_graphics();
+		gs_timer_range_begin(range);
+		gs_timer_begin(timer);
+
+		gs_texrender_reset(target);
+		if (gs_texrender_begin(target, res.width, res.height)) {
+			vec4 black = {};
+			gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
+			gs_ortho(0, static_cast<float>(res.width), 0, static_cast<float>(res.height), -1., 1.);
+			obs_source_video_render(source);
+			gs_texrender_end(target);
+		}
+
+		gs_timer_end(timer);
+		gs_timer_range_end(range);
+		gs_flush();
+
+		// Wait for the GPU, only one sample is in flight at a time so that samples do not overlap.
+		uint64_t ticks     = 0;
+		uint64_t frequency = 0;
+		bool     disjoint  = false;
+		while (!gs_timer_range_get_data(range, &disjoint, &frequency)) {
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+		while (!gs_timer_get_data(timer, &ticks)) {
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+		obs_leave_graphics();
+
+		if (idx < opts.warmup) {
+			continue;
+		}
+		if (disjoint || (frequency == 0)) {
+			result.disjoint++;
+			continue;
+		}
+		result.times.push_back(static_cast<double>(ticks) * 1000. / static_cast<double>(frequency));
+	}
+
+	obs_enter_graphics();
+	gs_timer_destroy(timer);
+	gs_timer_range_destroy(range);
+	gs_texrender_destroy(target);
+	obs_leave_graphics();
+
+	return result;
+}
+
+static void run(const bench_options& opts)
+{
+	report_header();
+	for (auto res : opts.resolutions) {
+		current_resolution = res;
+		obs_source_t* source = obs_source_create_private(BENCH_SOURCE_ID, "bench", nullptr);
+		if (!source) {
+			throw std::runtime_error("Failed to create benchmark source.");
+		}
+
+		for (auto& type : opts.types) {
+			for (auto size : opts.sizes) {
+				for (auto step : opts.steps) {
+					obs_data_t* settings = obs_data_create();
+					obs_data_set_string(settings, "Filter.Blur.Type", type.c_str());
+					obs_data_set_string(settings, "Filter.Blur.Subtype", opts.subtype.c_str());
+					obs_data_set_double(settings, "Filter.Blur.Size", size);
+					obs_data_set_bool(settings, "Filter.Blur.StepScale", true);
+					obs_data_set_double(settings, "Filter.Blur.StepScale.X", step * 100.);
+					obs_data_set_double(settings, "Filter.Blur.StepScale.Y", step * 100.);
+					obs_source_t* filter = obs_source_create_private(BENCH_FILTER_ID, "blur", settings);
+					obs_data_release(settings);
+					if (!filter) {
+						obs_source_release(source);
+						throw std::runtime_error("Failed to create Blur filter, is the StreamFX module complete?");
+					}
+					obs_source_filter_add(source, filter);
+
+					bench_result result = measure(opts, source, filter, res);
+					report(opts, type, res, size, step, result);
+
+					obs_source_filter_remove(source, filter);
+					obs_source_release(filter);
+				}
+			}
+		}
+
+		obs_source_release(source);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	try {
+		bench_options opts = parse_options(argc, argv);
+		base_set_log_handler(log_handler, nullptr);
+
+		initialize_obs(opts);
+		run(opts);
+
+		obs_shutdown();
+		return 0;
+	} catch (const std::invalid_argument& ex) {
+		fprintf(stderr, "%s\n", ex.what());
+		usage();
+		return 2;
+	} catch (const std::exception& ex) {
+		fprintf(stderr, "%s\n", ex.what());
+		return 1;
+	}
+}
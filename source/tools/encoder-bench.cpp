@@ -0,0 +1,535 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+// Offline benchmark for the StreamFX encoders.
+//
+// Starts a headless libOBS, loads the StreamFX module, and feeds synthetic or raw YUV frames through a private video
+// output into a single encoder. Latency is measured from handing a frame to libOBS until its packet arrives, and the
+// statistics the encoders log on destruction (frame pool, frame copy) are collected from the log. Everything is
+// reported as JSON on stdout, while the regular log goes to stderr.
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <media-io/video-io.h>
+#include <obs-module.h>
+#include <obs.h>
+#include <util/platform.h>
+#include "warning-enable.hpp"
+
+#ifndef STREAMFX_MODULE_PATH
+#define STREAMFX_MODULE_PATH ""
+#endif
+#ifndef STREAMFX_DATA_PATH
+#define STREAMFX_DATA_PATH ""
+#endif
+
+#define BENCH_OUTPUT_ID "streamfx-encoder-bench"
+
+struct bench_options {
+	std::string  module_path = STREAMFX_MODULE_PATH;
+	std::string  data_path   = STREAMFX_DATA_PATH;
+	std::string  encoder;
+	std::string  settings = "{}";
+	std::string  input;
+	uint32_t     width    = 1920;
+	uint32_t     height   = 1080;
+	uint32_t     fps_num  = 60;
+	uint32_t     fps_den  = 1;
+	uint64_t     frames   = 600;
+	video_format format   = VIDEO_FORMAT_NV12;
+	bool         realtime = false;
+};
+
+struct bench_stats {
+	std::mutex            lock;
+	std::vector<uint64_t> pushed;   // Time at which each frame was handed to libOBS.
+	std::vector<uint64_t> received; // Time at which the packet for each frame arrived.
+	std::atomic<uint64_t> packets{0};
+	std::atomic<uint64_t> bytes{0};
+
+	// Parsed from the encoder log on destruction.
+	bool     have_pool  = false;
+	uint64_t pool_hits  = 0;
+	uint64_t pool_miss  = 0;
+	size_t   pool_size  = 0;
+	bool     have_copy  = false;
+	uint64_t copy_count = 0;
+	double   copy_avg   = 0;
+	double   copy_p95   = 0;
+	double   copy_p99   = 0;
+};
+
+static bench_stats stats;
+
+//------------------------------------------------------------------------------
+// Logging
+//------------------------------------------------------------------------------
+
+static void log_handler(int level, const char* format, va_list args, void*)
+{
+	std::vector<char> buffer(4096);
+	vsnprintf(buffer.data(), buffer.size(), format, args);
+
+	if (const char* text = strstr(buffer.data(), "Frame Pool: "); text) {
+		std::unique_lock<std::mutex> ul(stats.lock);
+		stats.have_pool = (sscanf(text, "Frame Pool: %" SCNu64 " hits, %" SCNu64 " misses with %zu frames.", &stats.pool_hits, &stats.pool_miss, &stats.pool_size) == 3);
+	} else if (const char* text = strstr(buffer.data(), "Frame Copy: "); text) {
+		std::unique_lock<std::mutex> ul(stats.lock);
+		stats.have_copy = (sscanf(text, "Frame Copy: %" SCNu64 " frames, %lf ms average, %lf ms 95th percentile, %lf ms 99th percentile.", &stats.copy_count, &stats.copy_avg, &stats.copy_p95, &stats.copy_p99) == 4);
+	}
+
+	if (level <= LOG_INFO) {
+		fprintf(stderr, "%s\n", buffer.data());
+	}
+}
+
+//------------------------------------------------------------------------------
+// Output
+//------------------------------------------------------------------------------
+// Only exists to get libOBS to start the encoder and hand us its packets.
+
+static const char* bench_output_get_name(void*)
+{
+	return "StreamFX Encoder Benchmark";
+}
+
+static void* bench_output_create(obs_data_t*, obs_output_t* output)
+{
+	return output;
+}
+
+static void bench_output_destroy(void*) {}
+
+static bool bench_output_start(void* data)
+{
+	auto output = reinterpret_cast<obs_output_t*>(data);
+	if (!obs_output_can_begin_data_capture(output, 0) || !obs_output_initialize_encoders(output, 0)) {
+		return false;
+	}
+	return obs_output_begin_data_capture(output, 0);
+}
+
+static void bench_output_stop(void* data, uint64_t)
+{
+	obs_output_end_data_capture(reinterpret_cast<obs_output_t*>(data));
+}
+
+static void bench_output_encoded_packet(void*, struct encoder_packet* packet)
+{
+	if (!packet || (packet->type != OBS_ENCODER_VIDEO)) {
+		return;
+	}
+
+	uint64_t now   = os_gettime_ns();
+	uint64_t index = static_cast<uint64_t>(packet->pts) / static_cast<uint64_t>(std::max<int32_t>(packet->timebase_num, 1));
+
+	std::unique_lock<std::mutex> ul(stats.lock);
+	if ((index < stats.received.size()) && (stats.received[index] == 0)) {
+		stats.received[index] = now;
+	}
+	stats.packets++;
+	stats.bytes += packet->size;
+}
+
+//------------------------------------------------------------------------------
+// Frames
+//------------------------------------------------------------------------------
+
+// Number of rows and bytes per row of each plane of a format.
+static size_t plane_layout(video_format format, uint32_t width, uint32_t height, size_t rows[MAX_AV_PLANES], size_t row_size[MAX_AV_PLANES])
+{
+	uint32_t cw = (width + 1) / 2;
+	uint32_t ch = (height + 1) / 2;
+	switch (format) {
+	case VIDEO_FORMAT_NV12:
+		rows[0] = height, row_size[0] = width;
+		rows[1] = ch, row_size[1] = cw * 2;
+		return 2;
+	case VIDEO_FORMAT_P010:
+		rows[0] = height, row_size[0] = width * 2;
+		rows[1] = ch, row_size[1] = cw * 4;
+		return 2;
+	case VIDEO_FORMAT_I420:
+		rows[0] = height, row_size[0] = width;
+		rows[1] = ch, row_size[1] = cw;
+		rows[2] = ch, row_size[2] = cw;
+		return 3;
+	case VIDEO_FORMAT_I444:
+		rows[0] = rows[1] = rows[2] = height;
+		row_size[0] = row_size[1] = row_size[2] = width;
+		return 3;
+	case VIDEO_FORMAT_RGBA:
+	case VIDEO_FORMAT_BGRA:
+	case VIDEO_FORMAT_BGRX:
+		rows[0] = height, row_size[0] = width * 4;
+		return 1;
+	default:
+		throw std::invalid_argument("Unsupported video format.");
+	}
+}
+
+static void fill_synthetic(video_frame& frame, video_format format, size_t planes, const size_t rows[], const size_t row_size[], uint64_t index)
+{
+	// A moving diagonal gradient, so that encoders can not just skip every frame.
+	for (size_t plane = 0; plane < planes; plane++) {
+		bool luma = (plane == 0) || (format == VIDEO_FORMAT_RGBA) || (format == VIDEO_FORMAT_BGRA) || (format == VIDEO_FORMAT_BGRX);
+		for (size_t y = 0; y < rows[plane]; y++) {
+			uint8_t* row = frame.data[plane] + y * frame.linesize[plane];
+			if (luma) {
+				for (size_t x = 0; x < row_size[plane]; x++) {
+					row[x] = static_cast<uint8_t>(x + y + index * 4);
+				}
+			} else {
+				memset(row, 128, row_size[plane]);
+			}
+		}
+	}
+}
+
+static bool fill_from_file(video_frame& frame, std::ifstream& file, size_t planes, const size_t rows[], const size_t row_size[])
+{
+	for (size_t plane = 0; plane < planes; plane++) {
+		for (size_t y = 0; y < rows[plane]; y++) {
+			if (!file.read(reinterpret_cast<char*>(frame.data[plane] + y * frame.linesize[plane]), static_cast<std::streamsize>(row_size[plane]))) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Report
+//------------------------------------------------------------------------------
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+	if (sorted.empty()) {
+		return 0;
+	}
+	size_t idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+	return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+static void report(const bench_options& opts, uint64_t start, uint64_t end)
+{
+	std::unique_lock<std::mutex> ul(stats.lock);
+
+	std::vector<double> latencies;
+	for (size_t idx = 0; idx < stats.received.size(); idx++) {
+		if (stats.pushed[idx] && stats.received[idx]) {
+			latencies.push_back(static_cast<double>(stats.received[idx] - stats.pushed[idx]) / 1000000.0);
+		}
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	double seconds = static_cast<double>(end - start) / 1000000000.0;
+	double average = 0;
+	for (auto v : latencies) {
+		average += v;
+	}
+	average = latencies.empty() ? 0 : (average / static_cast<double>(latencies.size()));
+
+	printf("{\n");
+	printf("\t\"encoder\": \"%s\",\n", opts.encoder.c_str());
+	printf("\t\"width\": %" PRIu32 ",\n\t\"height\": %" PRIu32 ",\n", opts.width, opts.height);
+	printf("\t\"fps\": [%" PRIu32 ", %" PRIu32 "],\n", opts.fps_num, opts.fps_den);
+	printf("\t\"format\": \"%s\",\n", get_video_format_name(opts.format));
+	printf("\t\"realtime\": %s,\n", opts.realtime ? "true" : "false");
+	printf("\t\"frames\": %zu,\n", stats.pushed.size());
+	printf("\t\"packets\": %" PRIu64 ",\n", stats.packets.load());
+	printf("\t\"bytes\": %" PRIu64 ",\n", stats.bytes.load());
+	printf("\t\"duration_s\": %.6f,\n", seconds);
+	printf("\t\"throughput_fps\": %.3f,\n", (seconds > 0) ? (static_cast<double>(latencies.size()) / seconds) : 0.);
+	printf("\t\"latency_ms\": {\"count\": %zu, \"average\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n", latencies.size(), average, percentile(latencies, 0.5), percentile(latencies, 0.95), percentile(latencies, 0.99), latencies.empty() ? 0. : latencies.back());
+	if (stats.have_copy) {
+		printf("\t\"copy_ms\": {\"count\": %" PRIu64 ", \"average\": %.3f, \"p95\": %.3f, \"p99\": %.3f},\n", stats.copy_count, stats.copy_avg, stats.copy_p95, stats.copy_p99);
+	} else {
+		printf("\t\"copy_ms\": null,\n");
+	}
+	if (stats.have_pool) {
+		printf("\t\"pool\": {\"hits\": %" PRIu64 ", \"misses\": %" PRIu64 ", \"capacity\": %zu}\n", stats.pool_hits, stats.pool_miss, stats.pool_size);
+	} else {
+		printf("\t\"pool\": null\n");
+	}
+	printf("}\n");
+}
+
+//------------------------------------------------------------------------------
+// Main
+//------------------------------------------------------------------------------
+
+static void usage()
+{
+	fprintf(stderr, "Usage: streamfx-encoder-bench --encoder <id> [options]\n"
+					"  --encoder <id>       Encoder to benchmark, for example 'streamfx-h264_nvenc_sw'.\n"
+					"  --settings <json>    Encoder settings as JSON.\n"
+					"  --size <w>x<h>       Frame size (default 1920x1080).\n"
+					"  --fps <num>[/<den>]  Frame rate (default 60).\n"
+					"  --frames <n>         Number of frames to encode (default 600).\n"
+					"  --format <fmt>       nv12, i420, i444, p010, rgba, bgra or bgrx (default nv12).\n"
+					"  --input <file>       Raw frames in the given format and size, looped if too short.\n"
+					"  --realtime           Pace frames at the frame rate instead of as fast as possible.\n"
+					"  --module <path>      Path to the StreamFX module.\n"
+					"  --data <path>        Path to the StreamFX data directory.\n");
+}
+
+static video_format parse_format(const std::string& name)
+{
+	if (name == "nv12")
+		return VIDEO_FORMAT_NV12;
+	if (name == "i420")
+		return VIDEO_FORMAT_I420;
+	if (name == "i444")
+		return VIDEO_FORMAT_I444;
+	if (name == "p010")
+		return VIDEO_FORMAT_P010;
+	if (name == "rgba")
+		return VIDEO_FORMAT_RGBA;
+	if (name == "bgra")
+		return VIDEO_FORMAT_BGRA;
+	if (name == "bgrx")
+		return VIDEO_FORMAT_BGRX;
+	throw std::invalid_argument("Unknown format '" + name + "'.");
+}
+
+static bench_options parse_options(int argc, char** argv)
+{
+	bench_options opts;
+	for (int idx = 1; idx < argc; idx++) {
+		std::string arg = argv[idx];
+		auto        next = [&]() {
+			if (++idx >= argc) {
+				throw std::invalid_argument("Missing value for '" + arg + "'.");
+			}
+			return std::string(argv[idx]);
+		};
+
+		if (arg == "--encoder") {
+			opts.encoder = next();
+		} else if (arg == "--settings") {
+			opts.settings = next();
+		} else if (arg == "--size") {
+			if (sscanf(next().c_str(), "%" SCNu32 "x%" SCNu32, &opts.width, &opts.height) != 2) {
+				throw std::invalid_argument("Invalid size.");
+			}
+		} else if (arg == "--fps") {
+			opts.fps_den = 1;
+			if (sscanf(next().c_str(), "%" SCNu32 "/%" SCNu32, &opts.fps_num, &opts.fps_den) < 1) {
+				throw std::invalid_argument("Invalid frame rate.");
+			}
+		} else if (arg == "--frames") {
+			opts.frames = std::stoull(next());
+		} else if (arg == "--format") {
+			opts.format = parse_format(next());
+		} else if (arg == "--input") {
+			opts.input = next();
+		} else if (arg == "--realtime") {
+			opts.realtime = true;
+		} else if (arg == "--module") {
+			opts.module_path = next();
+		} else if (arg == "--data") {
+			opts.data_path = next();
+		} else {
+			throw std::invalid_argument("Unknown option '" + arg + "'.");
+		}
+	}
+
+	if (opts.encoder.empty() || !opts.width || !opts.height || !opts.fps_num || !opts.fps_den) {
+		throw std::invalid_argument("Missing or invalid required options.");
+	}
+	return opts;
+}
+
+static void initialize_obs(const bench_options& opts)
+{
+	if (!obs_startup("en-US", nullptr, nullptr)) {
+		throw std::runtime_error("Failed to start libOBS.");
+	}
+
+	// The encoders need a graphics context, even if nothing is ever rendered.
+	obs_video_info ovi = {};
+#ifdef _WIN32
+	ovi.graphics_module = "libobs-d3d11";
+#else
+	ovi.graphics_module = "libobs-opengl";
+#endif
+	ovi.fps_num        = opts.fps_num;
+	ovi.fps_den        = opts.fps_den;
+	ovi.base_width     = opts.width;
+	ovi.base_height    = opts.height;
+	ovi.output_width   = opts.width;
+	ovi.output_height  = opts.height;
+	ovi.output_format  = opts.format;
+	ovi.colorspace     = VIDEO_CS_709;
+	ovi.range          = VIDEO_RANGE_PARTIAL;
+	ovi.gpu_conversion = true;
+	ovi.scale_type     = OBS_SCALE_BICUBIC;
+	if (int res = obs_reset_video(&ovi); res != OBS_VIDEO_SUCCESS) {
+		throw std::runtime_error("Failed to initialize video (" + std::to_string(res) + ").");
+	}
+
+	obs_module_t* module = nullptr;
+	if (obs_open_module(&module, opts.module_path.c_str(), opts.data_path.c_str()) != MODULE_SUCCESS) {
+		throw std::runtime_error("Failed to open StreamFX module at '" + opts.module_path + "'.");
+	}
+	if (!obs_init_module(module)) {
+		throw std::runtime_error("Failed to initialize StreamFX module.");
+	}
+	obs_post_load_modules();
+
+	static obs_output_info output = {};
+	output.id                     = BENCH_OUTPUT_ID;
+	output.flags                  = OBS_OUTPUT_VIDEO | OBS_OUTPUT_ENCODED;
+	output.get_name               = bench_output_get_name;
+	output.create                 = bench_output_create;
+	output.destroy                = bench_output_destroy;
+	output.start                  = bench_output_start;
+	output.stop                   = bench_output_stop;
+	output.encoded_packet         = bench_output_encoded_packet;
+	obs_register_output(&output);
+}
+
+static void run(const bench_options& opts, uint64_t& start, uint64_t& end)
+{
+	size_t rows[MAX_AV_PLANES]     = {};
+	size_t row_size[MAX_AV_PLANES] = {};
+	size_t planes                  = plane_layout(opts.format, opts.width, opts.height, rows, row_size);
+
+	std::ifstream file;
+	if (!opts.input.empty()) {
+		file.open(opts.input, std::ios::binary);
+		if (!file) {
+			throw std::runtime_error("Failed to open input '" + opts.input + "'.");
+		}
+	}
+
+	// Frames are fed through a private video output, so that we control exactly when each frame arrives.
+	video_output_info voi = {};
+	voi.name              = "StreamFX Encoder Benchmark";
+	voi.format            = opts.format;
+	voi.fps_num           = opts.fps_num;
+	voi.fps_den           = opts.fps_den;
+	voi.width             = opts.width;
+	voi.height            = opts.height;
+	voi.cache_size        = 16;
+	voi.colorspace        = VIDEO_CS_709;
+	voi.range             = VIDEO_RANGE_PARTIAL;
+	video_t* video        = nullptr;
+	if (video_output_open(&video, &voi) != VIDEO_OUTPUT_SUCCESS) {
+		throw std::runtime_error("Failed to open video output.");
+	}
+
+	obs_data_t*    settings = obs_data_create_from_json(opts.settings.c_str());
+	obs_encoder_t* encoder  = obs_video_encoder_create(opts.encoder.c_str(), "bench", settings, nullptr);
+	obs_data_release(settings);
+	if (!encoder) {
+		video_output_close(video);
+		throw std::runtime_error("Failed to create encoder '" + opts.encoder + "'.");
+	}
+	obs_encoder_set_video(encoder, video);
+
+	obs_output_t* output = obs_output_create(BENCH_OUTPUT_ID, "bench", nullptr, nullptr);
+	obs_output_set_video_encoder(output, encoder);
+
+	stats.pushed.assign(opts.frames, 0);
+	stats.received.assign(opts.frames, 0);
+
+	if (!obs_output_start(output)) {
+		obs_output_release(output);
+		obs_encoder_release(encoder);
+		video_output_close(video);
+		throw std::runtime_error("Failed to start encoder.");
+	}
+
+	uint64_t interval = (static_cast<uint64_t>(opts.fps_den) * 1000000000ull) / opts.fps_num;
+	start             = os_gettime_ns();
+	for (uint64_t index = 0; index < opts.frames; index++) {
+		uint64_t timestamp = start + index * interval;
+		if (opts.realtime) {
+			os_sleepto_ns(timestamp);
+		}
+
+		// Wait for room in the video output cache when running faster than the encoder.
+		video_frame frame;
+		while (!video_output_lock_frame(video, &frame, 1, timestamp)) {
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+		if (!file.is_open() || !fill_from_file(frame, file, planes, rows, row_size)) {
+			if (file.is_open()) { // Loop the input.
+				file.clear();
+				file.seekg(0);
+				if (!fill_from_file(frame, file, planes, rows, row_size)) {
+					fill_synthetic(frame, opts.format, planes, rows, row_size, index);
+				}
+			} else {
+				fill_synthetic(frame, opts.format, planes, rows, row_size, index);
+			}
+		}
+		{
+			std::unique_lock<std::mutex> ul(stats.lock);
+			stats.pushed[index] = os_gettime_ns();
+		}
+		video_output_unlock_frame(video);
+	}
+
+	// Give the encoder a moment to drain.
+	for (uint64_t wait_until = os_gettime_ns() + 5000000000ull; os_gettime_ns() < wait_until;) {
+		{
+			std::unique_lock<std::mutex> ul(stats.lock);
+			if (std::all_of(stats.received.begin(), stats.received.end(), [](uint64_t v) { return v != 0; })) {
+				break;
+			}
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	end = os_gettime_ns();
+
+	obs_output_stop(output);
+	while (obs_output_active(output)) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	// The encoder logs its statistics when it is destroyed.
+	obs_output_release(output);
+	obs_encoder_release(encoder);
+	video_output_close(video);
+}
+
+int main(int argc, char** argv)
+{
+	try {
+		bench_options opts = parse_options(argc, argv);
+		base_set_log_handler(log_handler, nullptr);
+
+		initialize_obs(opts);
+
+		uint64_t start = 0, end = 0;
+		run(opts, start, end);
+
+		obs_shutdown();
+		report(opts, start, end);
+		return 0;
+	} catch (const std::invalid_argument& ex) {
+		fprintf(stderr, "%s\n", ex.what());
+		usage();
+		return 2;
+	} catch (const std::exception& ex) {
+		fprintf(stderr, "%s\n", ex.what());
+		return 1;
+	}
+}
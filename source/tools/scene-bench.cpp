@@ -0,0 +1,915 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+// Headless benchmark for whole scene collections.
+//
+// Starts a headless libOBS, loads the StreamFX module (and optionally other plugins), loads a scene collection exported
+// from OBS Studio, and renders its current scene offscreen at the canvas frame rate. The total frame time is measured on
+// the CPU and the GPU, every StreamFX source and filter reports its own timings, and the use of video memory is sampled
+// where the graphics backend can tell. Results are reported as JSON on stdout, in a form that can be passed back in as
+// a baseline, in which case the exit code tells if anything regressed.
+//
+// Alternatively, input recorded from a filter through its "capture_input" procedure is replayed through a new instance
+// of the same filter with the same settings, as fast as possible, for profiling content specific problems offline.
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <graphics/graphics.h>
+#include <obs-module.h>
+#include <obs.h>
+#include <util/platform.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <d3d11.h>
+#include <dxgi1_4.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "warning-enable.hpp"
+
+#include "util/util-capture.hpp"
+
+#ifndef STREAMFX_MODULE_PATH
+#define STREAMFX_MODULE_PATH ""
+#endif
+#ifndef STREAMFX_DATA_PATH
+#define STREAMFX_DATA_PATH ""
+#endif
+
+#define BENCH_REPLAY_ID "streamfx-scene-bench-replay"
+
+// Differences below this many milliseconds are noise, no matter how large they are in relation.
+#define BENCH_NOISE_FLOOR 0.05
+
+struct bench_plugins {
+	std::string binaries;
+	std::string data;
+};
+
+struct bench_options {
+	std::string                module_path = STREAMFX_MODULE_PATH;
+	std::string                data_path   = STREAMFX_DATA_PATH;
+	std::vector<bench_plugins> plugins;
+	std::string                collection;
+	std::string                replay;
+	std::string                scene;
+	std::string                baseline;
+	uint32_t                   width     = 1920;
+	uint32_t                   height    = 1080;
+	uint32_t                   fps_num   = 60;
+	uint32_t                   fps_den   = 1;
+	uint32_t                   warmup    = 60;
+	uint32_t                   frames    = 600;
+	double                     tolerance = 10.;
+};
+
+struct bench_timings {
+	int64_t cpu_calls  = 0;
+	int64_t cpu_total  = 0; // Nanoseconds.
+	double  cpu_p95    = 0; // Milliseconds.
+	int64_t gpu_frames = 0;
+	int64_t gpu_total  = 0; // Nanoseconds.
+	double  gpu_p95    = 0; // Milliseconds.
+};
+
+struct bench_instance {
+	std::string   parent; // Empty for sources, the source or scene the filter is on for filters.
+	std::string   name;
+	std::string   id;
+	bench_timings start;
+	bench_timings end;
+};
+
+struct bench_result {
+	std::vector<double>                   cpu_times; // CPU time of each frame in milliseconds.
+	std::vector<double>                   gpu_times; // GPU time of each frame in milliseconds.
+	uint32_t                              disjoint  = 0;
+	int64_t                               vram_peak = -1; // Bytes, or -1 if the backend can't tell.
+	std::map<std::string, bench_instance> instances;
+};
+
+//------------------------------------------------------------------------------
+// Logging
+//------------------------------------------------------------------------------
+
+static void log_handler(int level, const char* format, va_list args, void*)
+{
+	if (level <= LOG_WARNING) {
+		vfprintf(stderr, format, args);
+		fprintf(stderr, "\n");
+	}
+}
+
+//------------------------------------------------------------------------------
+// Video Memory
+//------------------------------------------------------------------------------
+// libOBS has no way to ask for this, so go to the backend directly. Must be used inside the graphics context.
+
+class vram_probe {
+#ifdef _WIN32
+	IDXGIAdapter3* _adapter = nullptr;
+#endif
+
+	public:
+	vram_probe()
+	{
+#ifdef _WIN32
+		if (gs_get_device_type() != GS_DEVICE_DIRECT3D_11) {
+			return;
+		}
+
+		IDXGIDevice*  dxgi_device  = nullptr;
+		IDXGIAdapter* dxgi_adapter = nullptr;
+		auto          device       = reinterpret_cast<ID3D11Device*>(gs_get_device_obj());
+		if (device && SUCCEEDED(device->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&dxgi_device)))) {
+			if (SUCCEEDED(dxgi_device->GetAdapter(&dxgi_adapter))) {
+				dxgi_adapter->QueryInterface(__uuidof(IDXGIAdapter3), reinterpret_cast<void**>(&_adapter));
+				dxgi_adapter->Release();
+			}
+			dxgi_device->Release();
+		}
+#endif
+	}
+
+	~vram_probe()
+	{
+#ifdef _WIN32
+		if (_adapter) {
+			_adapter->Release();
+		}
+#endif
+	}
+
+	/** Video memory used by this process in bytes, or -1 if unknown. */
+	int64_t sample()
+	{
+#ifdef _WIN32
+		DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+		if (_adapter && SUCCEEDED(_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info))) {
+			return static_cast<int64_t>(info.CurrentUsage);
+		}
+#endif
+		return -1;
+	}
+};
+
+//------------------------------------------------------------------------------
+// Replay
+//------------------------------------------------------------------------------
+// Recorded frames are uploaded outside of the measured part of each frame, so only the filter itself is measured.
+
+class mapped_file {
+	const uint8_t* _data = nullptr;
+	size_t         _size = 0;
+#ifdef _WIN32
+	HANDLE _file    = INVALID_HANDLE_VALUE;
+	HANDLE _mapping = nullptr;
+#else
+	int _fd = -1;
+#endif
+
+	public:
+	mapped_file(const std::string& path)
+	{
+#ifdef _WIN32
+		_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		LARGE_INTEGER size = {};
+		if ((_file == INVALID_HANDLE_VALUE) || !GetFileSizeEx(_file, &size)) {
+			throw std::runtime_error("Failed to open '" + path + "'.");
+		}
+		_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (_mapping) {
+			_data = reinterpret_cast<const uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+		}
+		_size = static_cast<size_t>(size.QuadPart);
+#else
+		struct stat info = {};
+		_fd              = open(path.c_str(), O_RDONLY);
+		if ((_fd < 0) || (fstat(_fd, &info) != 0)) {
+			throw std::runtime_error("Failed to open '" + path + "'.");
+		}
+		void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, _fd, 0);
+		if (data != MAP_FAILED) {
+			_data = reinterpret_cast<const uint8_t*>(data);
+		}
+		_size = static_cast<size_t>(info.st_size);
+#endif
+		if (!_data) {
+			throw std::runtime_error("Failed to map '" + path + "' into memory.");
+		}
+	}
+
+	~mapped_file()
+	{
+#ifdef _WIN32
+		if (_data) {
+			UnmapViewOfFile(_data);
+		}
+		if (_mapping) {
+			CloseHandle(_mapping);
+		}
+		if (_file != INVALID_HANDLE_VALUE) {
+			CloseHandle(_file);
+		}
+#else
+		if (_data) {
+			munmap(const_cast<uint8_t*>(_data), _size);
+		}
+		if (_fd >= 0) {
+			close(_fd);
+		}
+#endif
+	}
+
+	const uint8_t* data() const
+	{
+		return _data;
+	}
+
+	size_t size() const
+	{
+		return _size;
+	}
+};
+
+struct replay_state {
+	std::unique_ptr<mapped_file>    file;
+	streamfx::util::capture::header header  = {};
+	uint32_t                        frames  = 0;
+	gs_texture_t*                   texture = nullptr;
+	std::string                     id;
+	std::string                     name;
+	obs_data_t*                     settings = nullptr;
+};
+
+static replay_state replay;
+
+static void replay_open(const std::string& path)
+{
+	replay.file = std::make_unique<mapped_file>(path);
+	if (replay.file->size() < sizeof(replay.header)) {
+		throw std::runtime_error("'" + path + "' is not a capture.");
+	}
+	memcpy(&replay.header, replay.file->data(), sizeof(replay.header));
+	if ((memcmp(replay.header.magic, streamfx::util::capture::magic, sizeof(replay.header.magic)) != 0) || (replay.header.version != streamfx::util::capture::version) || (replay.header.frame_size != (sizeof(streamfx::util::capture::frame) + static_cast<uint64_t>(replay.header.width) * replay.header.height * 4))) {
+		throw std::runtime_error("'" + path + "' is not a capture, or from an incompatible version.");
+	}
+
+	// A capture that was never finished has no frame count, but everything that made it to disk is still usable.
+	uint64_t available = (replay.file->size() - sizeof(replay.header)) / replay.header.frame_size;
+	replay.frames      = static_cast<uint32_t>(replay.header.frames ? std::min<uint64_t>(replay.header.frames, available) : available);
+	if (replay.frames == 0) {
+		throw std::runtime_error("'" + path + "' does not contain any frames.");
+	}
+
+	obs_data_t* sidecar = obs_data_create_from_json_file((path + ".json").c_str());
+	if (!sidecar) {
+		throw std::runtime_error("Failed to load '" + path + ".json'.");
+	}
+	replay.id       = obs_data_get_string(sidecar, "id");
+	replay.name     = obs_data_get_string(sidecar, "name");
+	replay.settings = obs_data_get_obj(sidecar, "settings");
+	obs_data_release(sidecar);
+}
+
+static void replay_close()
+{
+	if (replay.texture) {
+		obs_enter_graphics();
+		gs_texture_destroy(replay.texture);
+		obs_leave_graphics();
+		replay.texture = nullptr;
+	}
+	obs_data_release(replay.settings);
+	replay.settings = nullptr;
+	replay.file.reset();
+}
+
+/** Upload the given frame, and return how far apart it was from the one before it in seconds. Graphics thread only. */
+static float replay_upload(uint32_t index)
+{
+	auto record = [](uint32_t idx) {
+		return replay.file->data() + sizeof(replay.header) + static_cast<size_t>(idx % replay.frames) * replay.header.frame_size;
+	};
+
+	if (!replay.texture) {
+		replay.texture = gs_texture_create(replay.header.width, replay.header.height, GS_RGBA, 1, nullptr, GS_DYNAMIC);
+		if (!replay.texture) {
+			throw std::runtime_error("Failed to create replay texture.");
+		}
+	}
+
+	streamfx::util::capture::frame current, previous;
+	memcpy(&current, record(index), sizeof(current));
+	memcpy(&previous, record(index ? (index - 1) : 0), sizeof(previous));
+	gs_texture_set_image(replay.texture, record(index) + sizeof(current), replay.header.width * 4, false);
+
+	// Wrapping around to the first frame, or broken timestamps, get a regular frame instead.
+	if (current.timestamp <= previous.timestamp) {
+		return 1.f / 60.f;
+	}
+	return static_cast<float>(static_cast<double>(current.timestamp - previous.timestamp) / 1000000000.);
+}
+
+static const char* replay_source_get_name(void*)
+{
+	return "StreamFX Scene Benchmark Replay";
+}
+
+static void* replay_source_create(obs_data_t*, obs_source_t*)
+{
+	return &replay;
+}
+
+static void replay_source_destroy(void*) {}
+
+static uint32_t replay_source_get_width(void*)
+{
+	return replay.header.width;
+}
+
+static uint32_t replay_source_get_height(void*)
+{
+	return replay.header.height;
+}
+
+static void replay_source_video_render(void*, gs_effect_t*)
+{
+	if (replay.texture) {
+		obs_source_draw(replay.texture, 0, 0, 0, 0, false);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Instances
+//------------------------------------------------------------------------------
+// Every StreamFX source and filter answers "get_timings", everything else is skipped.
+
+static bool query_timings(obs_source_t* source, bench_timings& timings)
+{
+	calldata_t data;
+	calldata_init(&data);
+	bool found = proc_handler_call(obs_source_get_proc_handler(source), "get_timings", &data);
+	if (found) {
+		timings.cpu_calls  = calldata_int(&data, "cpu_calls");
+		timings.cpu_total  = calldata_int(&data, "cpu_total");
+		timings.cpu_p95    = calldata_float(&data, "cpu_p95");
+		timings.gpu_frames = calldata_int(&data, "gpu_frames");
+		timings.gpu_total  = calldata_int(&data, "gpu_total");
+		timings.gpu_p95    = calldata_float(&data, "gpu_p95");
+	}
+	calldata_free(&data);
+	return found;
+}
+
+struct snapshot_context {
+	bench_result* result;
+	bool          start;
+	const char*   parent;
+};
+
+static void snapshot_instance(obs_source_t* source, snapshot_context& ctx)
+{
+	bench_timings timings;
+	if (!query_timings(source, timings)) {
+		return;
+	}
+
+	std::string name = obs_source_get_name(source);
+	std::string key  = ctx.parent ? (std::string(ctx.parent) + "/" + name) : name;
+	auto&       inst = ctx.result->instances[key];
+	if (ctx.start) {
+		inst.parent = ctx.parent ? ctx.parent : "";
+		inst.name   = name;
+		inst.id     = obs_source_get_id(source);
+		inst.start  = timings;
+	}
+	inst.end = timings;
+}
+
+static void snapshot_filter(obs_source_t*, obs_source_t* filter, void* param)
+{
+	snapshot_instance(filter, *reinterpret_cast<snapshot_context*>(param));
+}
+
+static bool snapshot_source(void* param, obs_source_t* source)
+{
+	auto&            ctx = *reinterpret_cast<snapshot_context*>(param);
+	snapshot_context sub = {ctx.result, ctx.start, nullptr};
+	snapshot_instance(source, sub);
+
+	sub.parent = obs_source_get_name(source);
+	obs_source_enum_filters(source, snapshot_filter, &sub);
+	return true;
+}
+
+static void snapshot(bench_result& result, bool start, obs_source_t* replay_source)
+{
+	snapshot_context ctx = {&result, start, nullptr};
+	if (replay_source) {
+		// Private sources are not enumerated.
+		snapshot_source(&ctx, replay_source);
+	} else {
+		obs_enum_sources(snapshot_source, &ctx);
+		obs_enum_scenes(snapshot_source, &ctx);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Report
+//------------------------------------------------------------------------------
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+	if (sorted.empty()) {
+		return 0;
+	}
+	size_t idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+	return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+static double average(const std::vector<double>& values)
+{
+	double total = 0;
+	for (auto v : values) {
+		total += v;
+	}
+	return values.empty() ? 0 : (total / static_cast<double>(values.size()));
+}
+
+static double average_ms(int64_t total, int64_t count)
+{
+	return (count > 0) ? (static_cast<double>(total) / static_cast<double>(count) / 1000000.) : 0.;
+}
+
+static double vram_peak_mb(const bench_result& result)
+{
+	return static_cast<double>(result.vram_peak) / (1024. * 1024.);
+}
+
+static std::string json_string(const std::string& text)
+{
+	std::string out = "\"";
+	for (char c : text) {
+		if ((c == '"') || (c == '\\')) {
+			out.push_back('\\');
+			out.push_back(c);
+		} else if (static_cast<unsigned char>(c) < 0x20) {
+			char buf[8];
+			snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+			out += buf;
+		} else {
+			out.push_back(c);
+		}
+	}
+	out.push_back('"');
+	return out;
+}
+
+static void report_distribution(const char* name, std::vector<double>& times)
+{
+	std::sort(times.begin(), times.end());
+	printf("\t%s: {\"samples\": %zu, \"average\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n", json_string(name).c_str(), times.size(), average(times), percentile(times, 0.5), percentile(times, 0.95), percentile(times, 0.99), times.empty() ? 0. : times.back());
+}
+
+static void report(const bench_options& opts, const std::string& scene, bench_result& result)
+{
+	printf("{\n");
+	if (opts.replay.empty()) {
+		printf("\t\"collection\": %s,\n", json_string(opts.collection).c_str());
+	} else {
+		printf("\t\"replay\": %s,\n", json_string(opts.replay).c_str());
+	}
+	printf("\t\"scene\": %s,\n", json_string(scene).c_str());
+	printf("\t\"width\": %" PRIu32 ",\n", opts.replay.empty() ? opts.width : replay.header.width);
+	printf("\t\"height\": %" PRIu32 ",\n", opts.replay.empty() ? opts.height : replay.header.height);
+	printf("\t\"fps\": %.3f,\n", static_cast<double>(opts.fps_num) / static_cast<double>(opts.fps_den));
+	printf("\t\"frames\": %" PRIu32 ",\n", opts.frames);
+	printf("\t\"disjoint\": %" PRIu32 ",\n", result.disjoint);
+	report_distribution("frame_cpu_ms", result.cpu_times);
+	report_distribution("frame_gpu_ms", result.gpu_times);
+	if (result.vram_peak >= 0) {
+		printf("\t\"vram_peak_mb\": %.1f,\n", vram_peak_mb(result));
+	} else {
+		printf("\t\"vram_peak_mb\": null,\n");
+	}
+
+	// Averages only cover the measured frames. The 95th percentiles come from the instances themselves, which keep
+	// track of everything since they were created, so those include the warmup.
+	printf("\t\"instances\": [");
+	bool first = true;
+	for (auto& kv : result.instances) {
+		auto& inst       = kv.second;
+		auto  cpu_calls  = inst.end.cpu_calls - inst.start.cpu_calls;
+		auto  gpu_frames = inst.end.gpu_frames - inst.start.gpu_frames;
+		printf("%s\n\t\t{\"key\": %s, \"parent\": %s, \"name\": %s, \"id\": %s, \"cpu_calls\": %" PRId64 ", \"cpu_average_ms\": %.4f, \"cpu_p95_ms\": %.4f, \"gpu_frames\": %" PRId64 ", \"gpu_average_ms\": %.4f, \"gpu_p95_ms\": %.4f}", first ? "" : ",", json_string(kv.first).c_str(), json_string(inst.parent).c_str(), json_string(inst.name).c_str(), json_string(inst.id).c_str(), cpu_calls, average_ms(inst.end.cpu_total - inst.start.cpu_total, cpu_calls), inst.end.cpu_p95, gpu_frames, average_ms(inst.end.gpu_total - inst.start.gpu_total, gpu_frames), inst.end.gpu_p95);
+		first = false;
+	}
+	printf("\n\t]\n");
+	printf("}\n");
+	fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+// Baseline
+//------------------------------------------------------------------------------
+
+static bool regressed(const bench_options& opts, const std::string& what, double baseline, double current)
+{
+	double limit = baseline * (1. + opts.tolerance / 100.);
+	if ((current <= limit) || ((current - baseline) < BENCH_NOISE_FLOOR)) {
+		return false;
+	}
+	fprintf(stderr, "Regression in %s: %.4f, baseline was %.4f (limit %.4f).\n", what.c_str(), current, baseline, limit);
+	return true;
+}
+
+static bool compare_distribution(const bench_options& opts, obs_data_t* baseline, const char* name, const std::vector<double>& sorted)
+{
+	obs_data_t* data = obs_data_get_obj(baseline, name);
+	if (!data) {
+		return false;
+	}
+	bool found = regressed(opts, std::string(name) + ".p95", obs_data_get_double(data, "p95"), percentile(sorted, 0.95));
+	obs_data_release(data);
+	return found;
+}
+
+/** Compare against an earlier report. Returns true if anything got slower than the tolerance allows. */
+static bool compare(const bench_options& opts, const bench_result& result)
+{
+	obs_data_t* baseline = obs_data_create_from_json_file(opts.baseline.c_str());
+	if (!baseline) {
+		throw std::runtime_error("Failed to load baseline from '" + opts.baseline + "'.");
+	}
+
+	bool found = false;
+	found      = compare_distribution(opts, baseline, "frame_cpu_ms", result.cpu_times) || found;
+	found      = compare_distribution(opts, baseline, "frame_gpu_ms", result.gpu_times) || found;
+
+	// Video memory is compared in megabytes, where the noise floor does not matter.
+	if ((result.vram_peak >= 0) && (obs_data_get_double(baseline, "vram_peak_mb") > 0)) {
+		found = regressed(opts, "vram_peak_mb", obs_data_get_double(baseline, "vram_peak_mb"), vram_peak_mb(result)) || found;
+	}
+
+	// Instances are matched by their key, anything that was added or removed since is not a regression.
+	obs_data_array_t* instances = obs_data_get_array(baseline, "instances");
+	for (size_t idx = 0, edx = obs_data_array_count(instances); idx < edx; idx++) {
+		obs_data_t* entry = obs_data_array_item(instances, idx);
+		auto        kv    = result.instances.find(obs_data_get_string(entry, "key"));
+		if (kv != result.instances.end()) {
+			auto& inst       = kv->second;
+			auto  cpu_calls  = inst.end.cpu_calls - inst.start.cpu_calls;
+			auto  gpu_frames = inst.end.gpu_frames - inst.start.gpu_frames;
+
+			found = regressed(opts, kv->first + " (CPU)", obs_data_get_double(entry, "cpu_average_ms"), average_ms(inst.end.cpu_total - inst.start.cpu_total, cpu_calls)) || found;
+			found = regressed(opts, kv->first + " (GPU)", obs_data_get_double(entry, "gpu_average_ms"), average_ms(inst.end.gpu_total - inst.start.gpu_total, gpu_frames)) || found;
+		}
+		obs_data_release(entry);
+	}
+	obs_data_array_release(instances);
+
+	obs_data_release(baseline);
+	return found;
+}
+
+//------------------------------------------------------------------------------
+// Main
+//------------------------------------------------------------------------------
+
+static void usage()
+{
+	fprintf(stderr, "Usage: streamfx-scene-bench (--collection <path> | --replay <path>) [options]\n"
+					"  --collection <path>      Scene collection as exported by OBS Studio.\n"
+					"  --replay <path>          Input recorded from a filter, replayed through the same filter at full speed.\n"
+					"  --scene <name>           Scene to render (default is the current scene of the collection).\n"
+					"  --canvas <WxH>           Canvas size (default 1920x1080).\n"
+					"  --fps <num[/den]>        Canvas frame rate (default 60).\n"
+					"  --warmup <n>             Unmeasured frames before measuring (default 60).\n"
+					"  --frames <n>             Measured frames (default 600).\n"
+					"  --plugins <bin;data>     Load all plugins from this location, such as the ones shipped with OBS Studio.\n"
+					"                           May be given more than once.\n"
+					"  --baseline <path>        Earlier report to compare against, exits with 3 on regressions.\n"
+					"  --tolerance <percent>    How much slower than the baseline is still fine (default 10).\n"
+					"  --module <path>          Path to the StreamFX module.\n"
+					"  --data <path>            Path to the StreamFX data directory.\n");
+}
+
+static bench_options parse_options(int argc, char** argv)
+{
+	bench_options opts;
+	for (int idx = 1; idx < argc; idx++) {
+		std::string arg = argv[idx];
+		auto        next = [&]() {
+			if (++idx >= argc) {
+				throw std::invalid_argument("Missing value for '" + arg + "'.");
+			}
+			return std::string(argv[idx]);
+		};
+
+		if (arg == "--collection") {
+			opts.collection = next();
+		} else if (arg == "--replay") {
+			opts.replay = next();
+		} else if (arg == "--scene") {
+			opts.scene = next();
+		} else if (arg == "--canvas") {
+			if (sscanf(next().c_str(), "%" SCNu32 "x%" SCNu32, &opts.width, &opts.height) != 2) {
+				throw std::invalid_argument("Invalid canvas size.");
+			}
+		} else if (arg == "--fps") {
+			opts.fps_den = 1;
+			if (sscanf(next().c_str(), "%" SCNu32 "/%" SCNu32, &opts.fps_num, &opts.fps_den) < 1) {
+				throw std::invalid_argument("Invalid frame rate.");
+			}
+		} else if (arg == "--warmup") {
+			opts.warmup = static_cast<uint32_t>(std::stoul(next()));
+		} else if (arg == "--frames") {
+			opts.frames = static_cast<uint32_t>(std::stoul(next()));
+		} else if (arg == "--plugins") {
+			std::string value = next();
+			size_t      pos   = value.find(';');
+			if (pos == std::string::npos) {
+				throw std::invalid_argument("Plugins must be given as '<bin>;<data>'.");
+			}
+			opts.plugins.push_back({value.substr(0, pos), value.substr(pos + 1)});
+		} else if (arg == "--baseline") {
+			opts.baseline = next();
+		} else if (arg == "--tolerance") {
+			opts.tolerance = std::stod(next());
+		} else if (arg == "--module") {
+			opts.module_path = next();
+		} else if (arg == "--data") {
+			opts.data_path = next();
+		} else {
+			throw std::invalid_argument("Unknown option '" + arg + "'.");
+		}
+	}
+
+	if ((opts.collection.empty() == opts.replay.empty()) || !opts.width || !opts.height || !opts.fps_num || !opts.fps_den || !opts.frames) {
+		throw std::invalid_argument("Missing or invalid required options.");
+	}
+	return opts;
+}
+
+static void initialize_obs(const bench_options& opts)
+{
+	if (!obs_startup("en-US", nullptr, nullptr)) {
+		throw std::runtime_error("Failed to start libOBS.");
+	}
+
+	// The canvas matches what the collection was made for, as sources and filters tick at its frame rate.
+	obs_video_info ovi = {};
+#ifdef _WIN32
+	ovi.graphics_module = "libobs-d3d11";
+#else
+	ovi.graphics_module = "libobs-opengl";
+#endif
+	ovi.fps_num        = opts.fps_num;
+	ovi.fps_den        = opts.fps_den;
+	ovi.base_width     = opts.width;
+	ovi.base_height    = opts.height;
+	ovi.output_width   = opts.width;
+	ovi.output_height  = opts.height;
+	ovi.output_format  = VIDEO_FORMAT_NV12;
+	ovi.colorspace     = VIDEO_CS_709;
+	ovi.range          = VIDEO_RANGE_PARTIAL;
+	ovi.gpu_conversion = true;
+	ovi.scale_type     = OBS_SCALE_BICUBIC;
+	if (int res = obs_reset_video(&ovi); res != OBS_VIDEO_SUCCESS) {
+		throw std::runtime_error("Failed to initialize video (" + std::to_string(res) + ").");
+	}
+
+	// Media sources refuse to work without audio.
+	obs_audio_info oai  = {};
+	oai.samples_per_sec = 48000;
+	oai.speakers        = SPEAKERS_STEREO;
+	if (!obs_reset_audio(&oai)) {
+		throw std::runtime_error("Failed to initialize audio.");
+	}
+
+	// Real collections use more than just StreamFX, so load whatever else was asked for first.
+	for (auto& plugins : opts.plugins) {
+		obs_add_module_path(plugins.binaries.c_str(), plugins.data.c_str());
+	}
+	if (!opts.plugins.empty()) {
+		obs_load_all_modules();
+	}
+
+	if (!obs_get_module("streamfx")) {
+		obs_module_t* module = nullptr;
+		if (obs_open_module(&module, opts.module_path.c_str(), opts.data_path.c_str()) != MODULE_SUCCESS) {
+			throw std::runtime_error("Failed to open StreamFX module at '" + opts.module_path + "'.");
+		}
+		if (!obs_init_module(module)) {
+			throw std::runtime_error("Failed to initialize StreamFX module.");
+		}
+	}
+	obs_post_load_modules();
+
+	static obs_source_info source = {};
+	source.id                     = BENCH_REPLAY_ID;
+	source.type                   = OBS_SOURCE_TYPE_INPUT;
+	source.output_flags           = OBS_SOURCE_VIDEO;
+	source.get_name               = replay_source_get_name;
+	source.create                 = replay_source_create;
+	source.destroy                = replay_source_destroy;
+	source.get_width              = replay_source_get_width;
+	source.get_height             = replay_source_get_height;
+	source.video_render           = replay_source_video_render;
+	obs_register_source(&source);
+}
+
+static obs_source_t* load_collection(const bench_options& opts, std::string& scene)
+{
+	obs_data_t* collection = obs_data_create_from_json_file(opts.collection.c_str());
+	if (!collection) {
+		throw std::runtime_error("Failed to load scene collection from '" + opts.collection + "'.");
+	}
+
+	// Groups are stored separately, but load just like any other source.
+	obs_data_array_t* sources = obs_data_get_array(collection, "sources");
+	obs_data_array_t* groups  = obs_data_get_array(collection, "groups");
+	if (sources && groups) {
+		obs_data_array_push_back_array(sources, groups);
+	}
+	if (sources) {
+		obs_load_sources(sources, nullptr, nullptr);
+	}
+	obs_data_array_release(groups);
+	obs_data_array_release(sources);
+
+	scene = opts.scene.empty() ? obs_data_get_string(collection, "current_scene") : opts.scene;
+	obs_data_release(collection);
+
+	obs_source_t* source = obs_get_source_by_name(scene.c_str());
+	if (!source) {
+		throw std::runtime_error("Scene '" + scene + "' is not part of the collection.");
+	}
+	return source;
+}
+
+/** Measure rendering the scene, or when replaying, the source with the filter that is being replayed. */
+static bench_result measure(const bench_options& opts, obs_source_t* scene, obs_source_t* filter)
+{
+	bench_result result;
+	result.cpu_times.reserve(opts.frames);
+	result.gpu_times.reserve(opts.frames);
+
+	obs_enter_graphics();
+	gs_texrender_t*   target = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+	gs_timer_range_t* range  = gs_timer_range_create();
+	gs_timer_t*       timer  = gs_timer_create();
+	vram_probe*       probe  = new vram_probe();
+	obs_leave_graphics();
+	if (!target || !range || !timer) {
+		throw std::runtime_error("Failed to create render target or timer queries.");
+	}
+
+	// Showing the scene, without assigning it to an output channel, keeps libOBS from rendering it a second time.
+	obs_source_inc_showing(scene);
+
+	// Replays render at the size of the recording, as the filter would have.
+	uint32_t width  = filter ? replay.header.width : opts.width;
+	uint32_t height = filter ? replay.header.height : opts.height;
+
+	uint64_t interval = util_mul_div64(1000000000ULL, opts.fps_den, opts.fps_num);
+	uint64_t start    = os_gettime_ns();
+	for (uint32_t idx = 0, edx = opts.warmup + opts.frames; idx < edx; idx++) {
+		if (idx == opts.warmup) {
+			snapshot(result, true, filter ? scene : nullptr);
+		}
+
+		if (filter) {
+			// Nothing ticks private sources, so tick the filter before every render, with the recorded frame timing.
+			obs_enter_graphics();
+			float seconds = replay_upload(idx);
+			obs_leave_graphics();
+			obs_source_video_tick(filter, seconds);
+		} else {
+			// Render once per tick, so that filters which cache their result until the next tick don't look free.
+			os_sleepto_ns(start + (idx + 1) * interval);
+		}
+
+		obs_enter_graphics();
+		gs_timer_range_begin(range);
+		gs_timer_begin(timer);
+
+		uint64_t cpu_start = os_gettime_ns();
+		gs_texrender_reset(target);
+		if (gs_texrender_begin(target, width, height)) {
+			vec4 black = {};
+			gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
+			gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), -1., 1.);
+			obs_source_video_render(scene);
+			gs_texrender_end(target);
+		}
+		uint64_t cpu_end = os_gettime_ns();
+
+		gs_timer_end(timer);
+		gs_timer_range_end(range);
+		gs_flush();
+
+		// Wait for the GPU, only one frame is in flight at a time so that frames do not overlap.
+		uint64_t ticks     = 0;
+		uint64_t frequency = 0;
+		bool     disjoint  = false;
+		while (!gs_timer_range_get_data(range, &disjoint, &frequency)) {
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+		while (!gs_timer_get_data(timer, &ticks)) {
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+		int64_t vram = probe->sample();
+		obs_leave_graphics();
+
+		result.vram_peak = std::max(result.vram_peak, vram);
+		if (idx < opts.warmup) {
+			continue;
+		}
+		result.cpu_times.push_back(static_cast<double>(cpu_end - cpu_start) / 1000000.);
+		if (disjoint || (frequency == 0)) {
+			result.disjoint++;
+			continue;
+		}
+		result.gpu_times.push_back(static_cast<double>(ticks) * 1000. / static_cast<double>(frequency));
+	}
+	snapshot(result, false, filter ? scene : nullptr);
+
+	obs_source_dec_showing(scene);
+
+	obs_enter_graphics();
+	delete probe;
+	gs_timer_destroy(timer);
+	gs_timer_range_destroy(range);
+	gs_texrender_destroy(target);
+	obs_leave_graphics();
+
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	try {
+		bench_options opts = parse_options(argc, argv);
+		base_set_log_handler(log_handler, nullptr);
+
+		initialize_obs(opts);
+
+		std::string  name;
+		bench_result result;
+		if (opts.replay.empty()) {
+			obs_source_t* scene = load_collection(opts, name);
+			result              = measure(opts, scene, nullptr);
+			obs_source_release(scene);
+		} else {
+			replay_open(opts.replay);
+			name = replay.name;
+
+			obs_source_t* source = obs_source_create_private(BENCH_REPLAY_ID, "replay", nullptr);
+			obs_source_t* filter = obs_source_create_private(replay.id.c_str(), replay.name.c_str(), replay.settings);
+			if (!source || !filter) {
+				obs_source_release(filter);
+				obs_source_release(source);
+				throw std::runtime_error("Failed to create '" + replay.id + "', is the module that provides it loaded?");
+			}
+			obs_source_filter_add(source, filter);
+
+			result = measure(opts, source, filter);
+
+			obs_source_filter_remove(source, filter);
+			obs_source_release(filter);
+			obs_source_release(source);
+			replay_close();
+		}
+
+		report(opts, name, result);
+		bool failed = !opts.baseline.empty() && compare(opts, result);
+
+		obs_shutdown();
+		return failed ? 3 : 0;
+	} catch (const std::invalid_argument& ex) {
+		fprintf(stderr, "%s\n", ex.what());
+		usage();
+		return 2;
+	} catch (const std::exception& ex) {
+		fprintf(stderr, "%s\n", ex.what());
+		return 1;
+	}
+}
@@ -6,9 +6,11 @@
 #include "transition-shader.hpp"
 #include "strings.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/obs-tools.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include "warning-enable.hpp"
 
@@ -27,12 +29,14 @@
 #endif
 
 #define ST_I18N "Transition.Shader"
+#define ST_I18N_PREROLL ST_I18N ".PreRoll"
+#define ST_KEY_PREROLL "Transition.PreRoll"
 
 using namespace streamfx::transition::shader;
 
 static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-StreamFX/wiki/Source-Filter-Transition-Shader";
 
-shader_instance::shader_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self)
+shader_instance::shader_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self), _preroll(0), _preroll_elapsed(0), _preroll_end(-1), _preroll_prepare(false), _time(0)
 {
 	_fx = std::make_shared<streamfx::gfx::shader::shader>(self, streamfx::gfx::shader::shader_mode::Transition);
 
@@ -63,11 +67,15 @@ void shader_instance::load(obs_data_t* data)
 
 void shader_instance::update(obs_data_t* data)
 {
+	_preroll = static_cast<float_t>(obs_data_get_int(data, ST_KEY_PREROLL)) / 1000.f;
+
 	_fx->update(data);
 }
 
 void shader_instance::video_tick(float_t sec_since_last)
 {
+	_preroll_elapsed += sec_since_last;
+
 	if (_fx->tick(sec_since_last)) {
 		obs_data_t* data = obs_source_get_settings(_self);
 		_fx->update(data);
@@ -90,7 +98,42 @@ void shader_instance::video_render(gs_effect_t* effect)
 	streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_source, "Shader Transition '%s'", obs_source_get_name(_self)};
 #endif
 
-	obs_transition_video_render(_self, [](void* data, gs_texture_t* a, gs_texture_t* b, float t, uint32_t cx, uint32_t cy) { reinterpret_cast<shader_instance*>(data)->transition_render(a, b, t, cx, cy); });
+	// B may have never been rendered before, so give its filters the first frames to create their resources while only A is
+	// shown. The rest of the transition then plays out in whatever time is left.
+	_time = obs_transition_get_time(_self);
+	if (_preroll > 0) {
+		if (_preroll_prepare) {
+			_preroll_prepare = false;
+			if (obs_source_t* b = obs_transition_get_source(_self, OBS_TRANSITION_SOURCE_B); b) {
+				streamfx::obs::tools::prepare_source_tree(b);
+				obs_source_release(b);
+			}
+		}
+
+		if (_preroll_end < 0) {
+			if ((_preroll_elapsed < _preroll) && (_time < 1.f)) {
+				obs_transition_video_render_direct(_self, OBS_TRANSITION_SOURCE_A);
+				return;
+			}
+			_preroll_end = _time;
+		}
+
+		_time = (_preroll_end < 1.f) ? std::clamp((_time - _preroll_end) / (1.f - _preroll_end), 0.f, 1.f) : 1.f;
+	}
+
+	// Where the output is just one of the inputs, draw that directly instead of rendering both and running the shader.
+	if (float_t t = _time; t <= _fx->transition_passthrough().first) {
+		obs_transition_video_render_direct(_self, OBS_TRANSITION_SOURCE_A);
+		return;
+	} else if (t >= _fx->transition_passthrough().second) {
+		obs_transition_video_render_direct(_self, OBS_TRANSITION_SOURCE_B);
+		return;
+	}
+
+	obs_transition_video_render(_self, [](void* data, gs_texture_t* a, gs_texture_t* b, float, uint32_t cx, uint32_t cy) {
+		auto self = reinterpret_cast<shader_instance*>(data);
+		self->transition_render(a, b, self->_time, cx, cy);
+	});
 }
 
 void shader_instance::transition_render(gs_texture_t* a, gs_texture_t* b, float_t t, uint32_t cx, uint32_t cy)
@@ -111,6 +154,10 @@ bool shader_instance::audio_render(uint64_t* ts_out, obs_source_audio_mix* audio
 
 void shader_instance::transition_start()
 {
+	_preroll_elapsed = 0;
+	_preroll_end     = -1;
+	_preroll_prepare = true;
+
 	_fx->set_visible(true);
 	_fx->set_active(true);
 }
@@ -142,6 +189,7 @@ const char* shader_factory::get_name()
 void shader_factory::get_defaults2(obs_data_t* data)
 {
 	streamfx::gfx::shader::shader::defaults(data);
+	obs_data_set_default_int(data, ST_KEY_PREROLL, 0);
 }
 
 obs_properties_t* shader_factory::get_properties2(shader::shader_instance* data)
@@ -155,6 +203,12 @@ obs_properties_t* shader_factory::get_properties2(shader::shader_instance* data)
 	}
 #endif
 
+	{
+		auto p = obs_properties_add_int(pr, ST_KEY_PREROLL, D_TRANSLATE(ST_I18N_PREROLL), 0, 5000, 1);
+		obs_property_int_set_suffix(p, " ms");
+		obs_property_set_long_description(p, D_TRANSLATE(ST_I18N_PREROLL ".Description"));
+	}
+
 	if (data) {
 		reinterpret_cast<shader_instance*>(data)->properties(pr);
 	}
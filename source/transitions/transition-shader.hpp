@@ -10,9 +10,15 @@
 #include "plugin.hpp"
 
 namespace streamfx::transition::shader {
-	class shader_instance : public obs::source_instance {
+	class shader_instance final : public obs::source_instance {
 		std::shared_ptr<streamfx::gfx::shader::shader> _fx;
 
+		float_t _preroll;         // Time to hold on to A while B prepares, in seconds.
+		float_t _preroll_elapsed; // Time since the transition started.
+		float_t _preroll_end;     // Transition time at which the pre-roll ended, or below zero while it lasts.
+		bool    _preroll_prepare; // B still has to be asked to prepare.
+		float_t _time;            // Transition time as the shader sees it.
+
 		public:
 		shader_instance(obs_data_t* data, obs_source_t* self);
 		virtual ~shader_instance();
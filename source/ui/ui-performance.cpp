@@ -0,0 +1,184 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "ui-performance.hpp"
+#include "gfx/gfx-rendertarget-pool.hpp"
+#include "obs/obs-encoder-factory.hpp"
+#include "obs/obs-source-tracker.hpp"
+#include "plugin.hpp"
+
+#include "warning-disable.hpp"
+#include <cmath>
+#include <vector>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <util/platform.h>
+#include "warning-enable.hpp"
+
+#define D_I18N_TITLE "UI.Performance.Title"
+#define D_I18N_NAME "UI.Performance.Name"
+#define D_I18N_TYPE "UI.Performance.Type"
+#define D_I18N_CPU "UI.Performance.CPU"
+#define D_I18N_GPU "UI.Performance.GPU"
+#define D_I18N_GPU_P95 "UI.Performance.GPU.P95"
+#define D_I18N_SUMMARY "UI.Performance.Summary"
+
+constexpr int refresh_interval_ms = 500;
+
+enum column : int {
+	COLUMN_NAME,
+	COLUMN_TYPE,
+	COLUMN_CPU,
+	COLUMN_GPU,
+	COLUMN_GPU_P95,
+	COLUMN_MAX,
+};
+
+static QTableWidgetItem* make_item(double_t value)
+{
+	auto item = new QTableWidgetItem();
+	if (value >= 0) {
+		// Stored as a number, so that sorting by the column is by value.
+		item->setData(Qt::DisplayRole, std::round(value * 1000.) / 1000.);
+	}
+	item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+	return item;
+}
+
+streamfx::ui::performance::performance(QWidget* parent) : QDockWidget(parent), _previous(), _previous_time(0)
+{
+	setObjectName("StreamFXPerformance");
+	setWindowTitle(QString::fromUtf8(D_TRANSLATE(D_I18N_TITLE)));
+	setFeatures(QDockWidget::DockWidgetClosable | QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetFloatable);
+
+	_contents = new QWidget(this);
+	auto layout = new QVBoxLayout(_contents);
+	layout->setContentsMargins(0, 0, 0, 0);
+
+	_table = new QTableWidget(0, COLUMN_MAX, _contents);
+	_table->setHorizontalHeaderLabels({QString::fromUtf8(D_TRANSLATE(D_I18N_NAME)), QString::fromUtf8(D_TRANSLATE(D_I18N_TYPE)), QString::fromUtf8(D_TRANSLATE(D_I18N_CPU)), QString::fromUtf8(D_TRANSLATE(D_I18N_GPU)), QString::fromUtf8(D_TRANSLATE(D_I18N_GPU_P95))});
+	_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	_table->setSelectionMode(QAbstractItemView::NoSelection);
+	_table->verticalHeader()->setVisible(false);
+	_table->horizontalHeader()->setSectionResizeMode(COLUMN_NAME, QHeaderView::Stretch);
+	_table->setSortingEnabled(true);
+	_table->sortByColumn(COLUMN_GPU, Qt::DescendingOrder);
+	layout->addWidget(_table);
+
+	_summary = new QLabel(_contents);
+	_summary->setWordWrap(true);
+	layout->addWidget(_summary);
+
+	setWidget(_contents);
+
+	_timer = new QTimer(this);
+	_timer->setInterval(refresh_interval_ms);
+	connect(_timer, &QTimer::timeout, this, &streamfx::ui::performance::on_refresh);
+	_timer->start();
+}
+
+streamfx::ui::performance::~performance() {}
+
+void streamfx::ui::performance::sample(std::map<std::string, totals>& current, std::vector<row>& rows, obs_source_t* source, const QString& name, double_t frames)
+{
+	// Only StreamFX sources answer this.
+	calldata_t data;
+	calldata_init(&data);
+	if (!proc_handler_call(obs_source_get_proc_handler(source), "get_timings", &data)) {
+		calldata_free(&data);
+		return;
+	}
+
+	std::string key = name.toStdString();
+	totals      now = {static_cast<uint64_t>(calldata_int(&data, "cpu_total")), static_cast<uint64_t>(calldata_int(&data, "gpu_total"))};
+	row         entry{name, QString::fromUtf8(obs_source_get_display_name(obs_source_get_id(source))), -1., -1., calldata_float(&data, "gpu_p95")};
+	calldata_free(&data);
+
+	if (auto kv = _previous.find(key); (kv != _previous.end()) && (frames > 0)) {
+		entry.cpu = static_cast<double_t>(now.cpu - std::min(now.cpu, kv->second.cpu)) / 1000000. / frames;
+		entry.gpu = static_cast<double_t>(now.gpu - std::min(now.gpu, kv->second.gpu)) / 1000000. / frames;
+	}
+	current.emplace(key, now);
+	rows.push_back(entry);
+}
+
+void streamfx::ui::performance::on_refresh()
+{
+	if (!isVisible()) {
+		// Start over once visible again, otherwise the first values would cover all the time we were hidden.
+		_previous.clear();
+		return;
+	}
+
+	uint64_t now    = os_gettime_ns();
+	double_t frames = 0;
+	if (_previous_time != 0) {
+		frames = static_cast<double_t>(now - _previous_time) / static_cast<double_t>(obs_get_frame_interval_ns());
+	}
+	_previous_time = now;
+
+	std::map<std::string, totals> current;
+	std::vector<row>              rows;
+
+	// Filters go by the name of their parent too, as their own names are rarely unique.
+	streamfx::obs::source_tracker::instance()->enumerate([this, &current, &rows, frames](std::string name, ::streamfx::obs::source source) {
+		if (obs_source_get_type(source.get()) == OBS_SOURCE_TYPE_FILTER) {
+			return false;
+		}
+		QString parent = QString::fromStdString(name);
+		sample(current, rows, source.get(), parent, frames);
+
+		struct context_t {
+			performance*                   self;
+			std::map<std::string, totals>* current;
+			std::vector<row>*              rows;
+			QString                        parent;
+			double_t                       frames;
+		} context{this, &current, &rows, parent, frames};
+		obs_source_enum_filters(
+			source.get(),
+			[](obs_source_t*, obs_source_t* filter, void* param) {
+				auto ctx = reinterpret_cast<context_t*>(param);
+				ctx->self->sample(*ctx->current, *ctx->rows, filter, ctx->parent + QString::fromUtf8(" / ") + QString::fromUtf8(obs_source_get_name(filter)), ctx->frames);
+			},
+			&context);
+		return false;
+	});
+
+	// Encoders don't have a procedure handler, but they all register themselves.
+	streamfx::obs::encoder_instance::enumerate([this, &current, &rows, frames](streamfx::obs::encoder_instance& instance) {
+		QString     name = QString::fromUtf8(obs_encoder_get_name(instance.get()));
+		std::string key  = std::string("encoder:") + name.toStdString();
+		totals      now  = {static_cast<uint64_t>(instance.cpu_timings().total_duration().count()), 0};
+		row         entry{name, QString::fromUtf8(obs_encoder_get_display_name(obs_encoder_get_id(instance.get()))), -1., -1., -1.};
+		if (auto kv = _previous.find(key); (kv != _previous.end()) && (frames > 0)) {
+			entry.cpu = static_cast<double_t>(now.cpu - std::min(now.cpu, kv->second.cpu)) / 1000000. / frames;
+		}
+		current.emplace(key, now);
+		rows.push_back(entry);
+	});
+
+	_previous = std::move(current);
+
+	// Rebuild the table without sorting, which would otherwise move rows around while they are being filled.
+	_table->setSortingEnabled(false);
+	_table->setRowCount(static_cast<int>(rows.size()));
+	for (std::size_t idx = 0; idx < rows.size(); idx++) {
+		auto& entry = rows[idx];
+		int   line  = static_cast<int>(idx);
+		_table->setItem(line, COLUMN_NAME, new QTableWidgetItem(entry.name));
+		_table->setItem(line, COLUMN_TYPE, new QTableWidgetItem(entry.type));
+		_table->setItem(line, COLUMN_CPU, make_item(entry.cpu));
+		_table->setItem(line, COLUMN_GPU, make_item(entry.gpu));
+		_table->setItem(line, COLUMN_GPU_P95, make_item(entry.gpu_p95));
+	}
+	_table->setSortingEnabled(true);
+
+	// Times include whatever an element renders, so adding them up would count filter chains several times.
+	auto     pool     = streamfx::gfx::rendertarget_pool::get_statistics();
+	uint64_t acquired = pool.hits + pool.misses;
+	double_t budget   = static_cast<double_t>(obs_get_frame_interval_ns()) / 1000000.;
+	double_t hit_rate = acquired ? (static_cast<double_t>(pool.hits) * 100. / static_cast<double_t>(acquired)) : 0.;
+	_summary->setText(QString::asprintf(D_TRANSLATE(D_I18N_SUMMARY), budget, hit_rate, static_cast<unsigned long long>(pool.idle)));
+}
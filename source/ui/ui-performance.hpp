@@ -0,0 +1,60 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "ui-common.hpp"
+
+#include "warning-disable.hpp"
+#include <map>
+#include <string>
+#include <QDockWidget>
+#include <QLabel>
+#include <QTableWidget>
+#include <QTimer>
+#include "warning-enable.hpp"
+
+namespace streamfx::ui {
+	/** Dock listing what every StreamFX source, filter, transition and encoder costs per frame.
+	 *
+	 * Only reads the counters each instance keeps anyway, twice a second and only while visible, so looking at it never
+	 * holds up rendering. Costs are the difference between two reads, divided by the frames rendered in between, and
+	 * include whatever an element renders itself, such as the filters before a filter.
+	 */
+	class performance : public QDockWidget {
+		Q_OBJECT
+
+		struct totals {
+			uint64_t cpu; // Nanoseconds of CPU time.
+			uint64_t gpu; // Nanoseconds of GPU time.
+		};
+
+		struct row {
+			QString  name;
+			QString  type;
+			double_t cpu; // Milliseconds per frame, negative if unknown.
+			double_t gpu; // Milliseconds per frame, negative if unknown.
+			double_t gpu_p95;
+		};
+
+		QWidget*      _contents;
+		QTableWidget* _table;
+		QLabel*       _summary;
+		QTimer*       _timer;
+
+		std::map<std::string, totals> _previous;
+		uint64_t                      _previous_time;
+
+		public:
+		performance(QWidget* parent = nullptr);
+		~performance();
+
+		private:
+		void sample(std::map<std::string, totals>& current, std::vector<row>& rows, obs_source_t* source, const QString& name, double_t frames);
+
+		private slots:
+		; // Not having this breaks some linters.
+		void on_refresh();
+	};
+} // namespace streamfx::ui
@@ -72,6 +72,8 @@ streamfx::ui::handler::handler()
 
 	  _about_action(), _about_dialog(),
 
+	  _performance_dock(),
+
 	  _translator()
 #ifdef ENABLE_UPDATER
 	  ,
@@ -121,6 +123,12 @@ void streamfx::ui::handler::on_obs_loaded()
 	// Create the 'About StreamFX' dialog.
 	_about_dialog = new streamfx::ui::about();
 
+	// Create the performance dock, which starts out hidden in the 'Docks' menu.
+	_performance_dock = new streamfx::ui::performance(reinterpret_cast<QWidget*>(obs_frontend_get_main_window()));
+	_performance_dock->setFloating(true);
+	_performance_dock->hide();
+	obs_frontend_add_dock(_performance_dock);
+
 	{ // Create and build the StreamFX menu
 		_menu = new QMenu(reinterpret_cast<QWidget*>(obs_frontend_get_main_window()));
 
@@ -5,6 +5,7 @@
 #pragma once
 #include "ui-common.hpp"
 #include "ui-about.hpp"
+#include "ui-performance.hpp"
 
 #ifdef ENABLE_UPDATER
 #include "ui-updater.hpp"
@@ -30,6 +31,9 @@ namespace streamfx::ui {
 		QAction*   _about_action;
 		ui::about* _about_dialog;
 
+		// Performance Dock
+		ui::performance* _performance_dock;
+
 		QTranslator* _translator;
 
 #ifdef ENABLE_UPDATER
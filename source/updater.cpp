@@ -9,6 +9,8 @@
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
+#include <cctype>
 #include <fstream>
 #include <mutex>
 #include <regex>
@@ -30,7 +32,6 @@
 #endif
 
 // TODO:
-// - Cache result in the configuration directory (not as a configuration value).
 // - Move 'autoupdater.last_checked_at' to out of the configuration.
 // - Figure out if nightly updates are viable at all.
 
@@ -39,6 +40,8 @@
 #define ST_CFG_CHANNEL "updater.channel"
 #define ST_CFG_LASTCHECKEDAT "updater.lastcheckedat"
 
+#define ST_CACHE_FILE "updater-releases.json"
+
 streamfx::version_stage streamfx::stage_from_string(std::string_view str)
 {
 	if (str == "a") {
@@ -220,8 +223,10 @@ streamfx::version_info::operator std::string()
 void streamfx::updater::task(streamfx::util::threadpool::task_data_t)
 {
 	try {
-		auto query_fn = [](std::vector<char>& buffer) {
-			static constexpr std::string_view ST_API_URL = "https://api.github.com/repos/Xaymar/obs-StreamFX/releases?per_page=25&page=1";
+		// Returns the status code, which is 304 if the releases did not change since the given ETag.
+		auto query_fn = [](std::vector<char>& buffer, const std::string& etag, std::string& new_etag) {
+			// Only the newest few releases matter for deciding on an update.
+			static constexpr std::string_view ST_API_URL = "https://api.github.com/repos/Xaymar/obs-StreamFX/releases?per_page=10&page=1";
 
 			streamfx::util::curl curl;
 			size_t               buffer_offset = 0;
@@ -229,6 +234,9 @@ void streamfx::updater::task(streamfx::util::threadpool::task_data_t)
 			// Set headers (User-Agent is needed so Github can contact us!).
 			curl.set_header("User-Agent", "StreamFX Updater v" STREAMFX_VERSION_STRING);
 			curl.set_header("Accept", "application/vnd.github.v3+json");
+			if (!etag.empty()) {
+				curl.set_header("If-None-Match", etag);
+			}
 
 			// Set up request.
 			curl.set_option(CURLOPT_HTTPGET, true); // GET
@@ -247,7 +255,19 @@ void streamfx::updater::task(streamfx::util::threadpool::task_data_t)
 
 				return s1 * s2;
 			});
-			//std::bind(&streamfx::updater::task_write_cb, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)
+			curl.set_header_callback([&new_etag](void* data, size_t s1, size_t s2) {
+				static constexpr std::string_view name = "etag:";
+
+				std::string_view line{static_cast<const char*>(data), s1 * s2};
+				if ((line.size() > name.size()) && std::equal(name.begin(), name.end(), line.begin(), [](char a, char b) { return a == std::tolower(static_cast<unsigned char>(b)); })) {
+					line.remove_prefix(name.size());
+					line.remove_prefix(std::min(line.find_first_not_of(" \t"), line.size()));
+					line.remove_suffix(line.size() - std::min(line.find_last_not_of(" \t\r\n") + 1, line.size()));
+					new_etag = line;
+				}
+
+				return s1 * s2;
+			});
 
 			// Clear any unknown data and reserve 64KiB of memory.
 			buffer.clear();
@@ -267,10 +287,20 @@ void streamfx::updater::task(streamfx::util::threadpool::task_data_t)
 			}
 			D_LOG_DEBUG("API returned status code %d.", status_code);
 
-			if (status_code != 200) {
+			if ((status_code != 200) && (status_code != 304)) {
 				D_LOG_ERROR("API returned unexpected status code %d.", status_code);
 				throw std::runtime_error("Request failed due to one or more reasons.");
 			}
+			buffer.resize(buffer_offset);
+			return status_code;
+		};
+		// Drops everything but what version_info needs while parsing, such as release notes, assets and authors.
+		nlohmann::json::parser_callback_t filter_fn = [](int, nlohmann::json::parse_event_t event, nlohmann::json& parsed) {
+			if (event == nlohmann::json::parse_event_t::key) {
+				const auto& key = parsed.get_ref<const std::string&>();
+				return (key == "tag_name") || (key == "name") || (key == "html_url");
+			}
+			return true;
 		};
 		auto parse_fn = [this](nlohmann::json json) {
 			// Check if it was parsed as an object.
@@ -320,12 +350,44 @@ void streamfx::updater::task(streamfx::util::threadpool::task_data_t)
 			auto debug_path = streamfx::config_file_path("github_release_query_response.json");
 			if (std::filesystem::exists(debug_path)) {
 				std::ifstream fs{debug_path};
-				json = nlohmann::json::parse(fs);
+				json = nlohmann::json::parse(fs, filter_fn);
 				fs.close();
 			} else {
+				// Load the releases from the last query, which GitHub only sends again if they changed.
+				auto           cache_path = streamfx::config_file_path(ST_CACHE_FILE);
+				nlohmann::json cache;
+				try {
+					if (std::filesystem::exists(cache_path)) {
+						std::ifstream fs{cache_path};
+						cache = nlohmann::json::parse(fs);
+					}
+				} catch (const std::exception& ex) {
+					D_LOG_WARNING("Ignoring broken release cache, error: %s", ex.what());
+					cache = nlohmann::json();
+				}
+				std::string etag;
+				if (cache.is_object() && cache.contains("etag") && cache.contains("releases")) {
+					etag = cache.at("etag").get<std::string>();
+				}
+
 				std::vector<char> buffer;
-				query_fn(buffer);
-				json = nlohmann::json::parse(buffer.begin(), buffer.end());
+				std::string       new_etag;
+				if (query_fn(buffer, etag, new_etag) == 304) {
+					D_LOG_DEBUG("Releases did not change since the last query.", "");
+					json = cache.at("releases");
+				} else {
+					json = nlohmann::json::parse(buffer.begin(), buffer.end(), filter_fn);
+
+					try {
+						cache             = nlohmann::json::object();
+						cache["etag"]     = new_etag;
+						cache["releases"] = json;
+						std::ofstream fs{cache_path, std::ios::trunc};
+						fs << cache;
+					} catch (const std::exception& ex) {
+						D_LOG_WARNING("Failed to write release cache, error: %s", ex.what());
+					}
+				}
 			}
 
 			// Parse the JSON response from the API.
@@ -485,7 +547,7 @@ void streamfx::updater::refresh()
 		save();
 
 		// Spawn a new task.
-		_task = streamfx::threadpool()->push(std::bind(&streamfx::updater::task, this, std::placeholders::_1), nullptr);
+		_task = streamfx::threadpool()->push(std::bind(&streamfx::updater::task, this, std::placeholders::_1), nullptr, ::streamfx::util::threadpool::priority::BACKGROUND);
 	} else {
 		events.refreshed(*this);
 	}
@@ -0,0 +1,95 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-capture.hpp"
+
+#include "warning-disable.hpp"
+#include <cstring>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+streamfx::util::capture::writer::~writer()
+{
+	{
+		std::unique_lock<std::mutex> ul(_lock);
+		_stop = true;
+	}
+	_signal.notify_all();
+	_worker.join();
+
+	// Now that everything is written, the frame count is known.
+	write_header();
+	_file.close();
+}
+
+streamfx::util::capture::writer::writer(const std::string& path, uint32_t width, uint32_t height) : _file(path, std::ios::binary | std::ios::trunc), _width(width), _height(height), _frames(0), _dropped(0), _lock(), _signal(), _queue(), _stop(false), _worker()
+{
+	if (!_file.is_open()) {
+		throw std::runtime_error("Failed to open '" + path + "' for writing.");
+	}
+	write_header();
+
+	_worker = std::thread([this]() { work(); });
+}
+
+bool streamfx::util::capture::writer::push(uint64_t timestamp, std::vector<uint8_t>&& pixels)
+{
+	{
+		std::unique_lock<std::mutex> ul(_lock);
+		if (_queue.size() >= queue_limit) {
+			_dropped++;
+			return false;
+		}
+		_queue.push_back({timestamp, std::move(pixels)});
+	}
+	_signal.notify_one();
+	return true;
+}
+
+uint64_t streamfx::util::capture::writer::dropped()
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	return _dropped;
+}
+
+void streamfx::util::capture::writer::work()
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	while (true) {
+		_signal.wait(ul, [this]() { return _stop || !_queue.empty(); });
+		if (_queue.empty()) {
+			break;
+		}
+
+		entry item = std::move(_queue.front());
+		_queue.pop_front();
+		ul.unlock();
+
+		frame info     = {};
+		info.timestamp = item.timestamp;
+		_file.write(reinterpret_cast<const char*>(&info), sizeof(info));
+		_file.write(reinterpret_cast<const char*>(item.pixels.data()), static_cast<std::streamsize>(item.pixels.size()));
+
+		ul.lock();
+		_frames++;
+	}
+}
+
+void streamfx::util::capture::writer::write_header()
+{
+	header info = {};
+	memcpy(info.magic, magic, sizeof(info.magic));
+	info.version    = version;
+	info.width      = _width;
+	info.height     = _height;
+	info.frames     = _frames;
+	info.frame_size = sizeof(frame) + static_cast<uint64_t>(_width) * _height * 4;
+
+	auto position = _file.tellp();
+	_file.seekp(0);
+	_file.write(reinterpret_cast<const char*>(&info), sizeof(info));
+	if (position > static_cast<std::streamoff>(sizeof(info))) {
+		_file.seekp(position);
+	}
+}
@@ -0,0 +1,91 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "warning-disable.hpp"
+#include <cinttypes>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::util::capture {
+	/** Recorded filter input, as written by writer and replayed by streamfx-scene-bench.
+	 *
+	 * The file is a header followed by fixed size frame records, each a frame header followed by tightly packed RGBA
+	 * rows. Frames are stored raw so that the file can be memory mapped and frame N found without reading the others.
+	 * The settings of the filter are stored next to it, in a JSON file with the same name plus ".json".
+	 */
+	static constexpr char     magic[8] = {'S', 'F', 'X', 'C', 'A', 'P', 'T', 'R'};
+	static constexpr uint32_t version  = 1;
+
+	struct header {
+		char     magic[8];
+		uint32_t version;
+		uint32_t width;
+		uint32_t height;
+		uint32_t frames;     // Frames actually written, only known once the writer is done.
+		uint64_t frame_size; // Size of each frame record, including its header.
+	};
+	static_assert(sizeof(header) == 32, "Capture header must not contain padding.");
+
+	struct frame {
+		uint64_t timestamp; // Video frame time at which the input was rendered.
+		uint64_t reserved;
+	};
+	static_assert(sizeof(frame) == 16, "Capture frame header must not contain padding.");
+
+	/** Writes frames on its own thread, so that the render thread never waits on the disk.
+	 *
+	 * Frames that arrive while too many are still waiting are dropped instead, and counted.
+	 */
+	class writer {
+		static constexpr std::size_t queue_limit = 8;
+
+		struct entry {
+			uint64_t             timestamp;
+			std::vector<uint8_t> pixels;
+		};
+
+		std::ofstream _file;
+		uint32_t      _width;
+		uint32_t      _height;
+		uint32_t      _frames;
+		uint64_t      _dropped;
+
+		std::mutex              _lock;
+		std::condition_variable _signal;
+		std::deque<entry>       _queue;
+		bool                    _stop;
+		std::thread             _worker;
+
+		public:
+		~writer();
+		writer(const std::string& path, uint32_t width, uint32_t height);
+
+		/** Queue a frame of width * height * 4 bytes. Returns false if it had to be dropped. */
+		bool push(uint64_t timestamp, std::vector<uint8_t>&& pixels);
+
+		uint32_t width() const
+		{
+			return _width;
+		}
+
+		uint32_t height() const
+		{
+			return _height;
+		}
+
+		/** Frames dropped so far, because the disk could not keep up. */
+		uint64_t dropped();
+
+		private:
+		void work();
+		void write_header();
+	};
+} // namespace streamfx::util::capture
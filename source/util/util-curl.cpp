@@ -70,6 +70,15 @@ size_t streamfx::util::curl::write_helper(void* ptr, size_t size, size_t count,
 	}
 }
 
+size_t streamfx::util::curl::header_helper(void* ptr, size_t size, size_t count, streamfx::util::curl* self)
+{
+	if (self->_header_callback) {
+		return self->_header_callback(ptr, size, count);
+	} else {
+		return size * count;
+	}
+}
+
 int32_t streamfx::util::curl::xferinfo_callback(streamfx::util::curl* self, curl_off_t dlt, curl_off_t dln, curl_off_t ult, curl_off_t uln)
 {
 	if (self->_xferinfo_callback) {
@@ -79,11 +88,12 @@ int32_t streamfx::util::curl::xferinfo_callback(streamfx::util::curl* self, curl
 	}
 }
 
-streamfx::util::curl::curl() : _curl(), _read_callback(), _write_callback(), _headers()
+streamfx::util::curl::curl() : _curl(), _read_callback(), _write_callback(), _header_callback(), _headers()
 {
 	_curl = curl_easy_init();
 	set_read_callback(nullptr);
 	set_write_callback(nullptr);
+	set_header_callback(nullptr);
 	set_xferinfo_callback(nullptr);
 	set_debug_callback(nullptr);
 
@@ -184,6 +194,14 @@ CURLcode streamfx::util::curl::set_write_callback(curl_io_callback_t cb)
 	return curl_easy_setopt(_curl, CURLOPT_WRITEFUNCTION, &write_helper);
 }
 
+CURLcode streamfx::util::curl::set_header_callback(curl_io_callback_t cb)
+{
+	_header_callback = std::move(cb);
+	if (CURLcode res = curl_easy_setopt(_curl, CURLOPT_HEADERDATA, this); res != CURLE_OK)
+		return res;
+	return curl_easy_setopt(_curl, CURLOPT_HEADERFUNCTION, &header_helper);
+}
+
 CURLcode streamfx::util::curl::set_xferinfo_callback(curl_xferinfo_callback_t cb)
 {
 	_xferinfo_callback = std::move(cb);
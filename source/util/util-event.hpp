@@ -7,22 +7,33 @@
 #include "common.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
+#include <atomic>
 #include <functional>
-#include <list>
+#include <memory>
 #include <mutex>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::util {
+	/** A list of listeners, some of which are called for every audio packet or frame.
+	 *
+	 * Calling only loads the current list of listeners, which is never modified once published. Changes to the list
+	 * copy it and publish the copy, so they are serialized by a lock that calls never take. A call that is already in
+	 * progress keeps going through the list it started with, so removing a listener doesn't wait for it to return.
+	 */
 	template<typename... _args>
 	class event {
-		std::list<std::function<void(_args...)>> _listeners;
-		std::recursive_mutex                     _lock;
+		typedef std::vector<std::function<void(_args...)>> listeners_t;
+
+		std::shared_ptr<const listeners_t> _listeners;
+		std::recursive_mutex               _lock;
 
 		std::function<void()> _cb_fill;
 		std::function<void()> _cb_clear;
 
 		public /* constructor */:
-		event() : _listeners(), _lock(), _cb_fill(), _cb_clear() {}
+		event() : _listeners(std::make_shared<const listeners_t>()), _lock(), _cb_fill(), _cb_clear() {}
 		virtual ~event()
 		{
 			std::lock_guard<std::recursive_mutex> lg(_lock);
@@ -38,7 +49,9 @@ namespace streamfx::util {
 			std::lock_guard<std::recursive_mutex> lg(_lock);
 			std::lock_guard<std::recursive_mutex> lgo(other._lock);
 
-			_listeners.swap(other._listeners);
+			auto listeners = std::atomic_load(&_listeners);
+			std::atomic_store(&_listeners, std::atomic_load(&other._listeners));
+			std::atomic_store(&other._listeners, listeners);
 			_cb_fill.swap(other._cb_fill);
 			_cb_clear.swap(other._cb_clear);
 		}
@@ -53,7 +66,9 @@ namespace streamfx::util {
 			std::lock_guard<std::recursive_mutex> lg(_lock);
 			std::lock_guard<std::recursive_mutex> lgo(other._lock);
 
-			_listeners.swap(other._listeners);
+			auto listeners = std::atomic_load(&_listeners);
+			std::atomic_store(&_listeners, std::atomic_load(&other._listeners));
+			std::atomic_store(&other._listeners, listeners);
 			_cb_fill.swap(other._cb_fill);
 			_cb_clear.swap(other._cb_clear);
 
@@ -70,8 +85,8 @@ namespace streamfx::util {
 		template<typename... _largs>
 		inline void call(_args... args)
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
-			for (auto& l : _listeners) {
+			auto listeners = std::atomic_load(&_listeners);
+			for (auto& l : *listeners) {
 				l(args...);
 			}
 		}
@@ -83,12 +98,14 @@ namespace streamfx::util {
 		inline void add(std::function<void(_args...)> listener)
 		{
 			std::lock_guard<std::recursive_mutex> lg(_lock);
-			if (_listeners.size() == 0) {
+			auto                                  listeners = std::make_shared<listeners_t>(*std::atomic_load(&_listeners));
+			if (listeners->size() == 0) {
 				if (_cb_fill) {
 					_cb_fill();
 				}
 			}
-			_listeners.push_back(listener);
+			listeners->push_back(listener);
+			std::atomic_store(&_listeners, std::shared_ptr<const listeners_t>(listeners));
 		}
 		inline event<_args...>& operator+=(std::function<void(_args...)> listener)
 		{
@@ -102,8 +119,10 @@ namespace streamfx::util {
 		inline void remove(std::function<void(_args...)> listener)
 		{
 			std::lock_guard<std::recursive_mutex> lg(_lock);
-			_listeners.remove(listener);
-			if (_listeners.size() == 0) {
+			auto                                  listeners = std::make_shared<listeners_t>(*std::atomic_load(&_listeners));
+			listeners->erase(std::remove(listeners->begin(), listeners->end(), listener), listeners->end());
+			std::atomic_store(&_listeners, std::shared_ptr<const listeners_t>(listeners));
+			if (listeners->size() == 0) {
 				if (_cb_clear) {
 					_cb_clear();
 				}
@@ -120,8 +139,7 @@ namespace streamfx::util {
 		 */
 		inline bool empty()
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
-			return _listeners.empty();
+			return std::atomic_load(&_listeners)->empty();
 		}
 		inline operator bool()
 		{
@@ -133,7 +151,7 @@ namespace streamfx::util {
 		inline void clear()
 		{
 			std::lock_guard<std::recursive_mutex> lg(_lock);
-			_listeners.clear();
+			std::atomic_store(&_listeners, std::make_shared<const listeners_t>());
 			if (_cb_clear) {
 				_cb_clear();
 			}
@@ -0,0 +1,290 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-file-watcher.hpp"
+
+#include "warning-disable.hpp"
+#include <set>
+#include <system_error>
+#include <vector>
+#if defined(D_PLATFORM_WINDOWS)
+#include <Windows.h>
+#elif defined(D_PLATFORM_LINUX)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+#include "warning-enable.hpp"
+
+// Every file is checked at least this often, even if no notification arrived.
+constexpr std::chrono::milliseconds poll_interval = std::chrono::milliseconds(1000);
+
+streamfx::util::file_watcher::subscription::subscription(const std::filesystem::path& path) : _path(path), _changed(false) {}
+
+streamfx::util::file_watcher::subscription::~subscription() = default;
+
+const std::filesystem::path& streamfx::util::file_watcher::subscription::path() const
+{
+	return _path;
+}
+
+bool streamfx::util::file_watcher::subscription::changed()
+{
+	return _changed.exchange(false);
+}
+
+streamfx::util::file_watcher::~file_watcher()
+{
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		_stop = true;
+	}
+	wake();
+	if (_worker.joinable()) {
+		_worker.join();
+	}
+
+#if defined(D_PLATFORM_LINUX)
+	for (auto& kv : _directories) {
+		inotify_rm_watch(_inotify, kv.second);
+	}
+	if (_inotify != -1) {
+		close(_inotify);
+	}
+	if (_wake != -1) {
+		close(_wake);
+	}
+#elif defined(D_PLATFORM_WINDOWS)
+	for (auto& kv : _directories) {
+		FindCloseChangeNotification(kv.second);
+	}
+	if (_wake) {
+		CloseHandle(_wake);
+	}
+#endif
+}
+
+streamfx::util::file_watcher::file_watcher()
+	: _lock(), _cv(), _stop(false), _dirty(false), _subscriptions(), _files(), _worker(),
+#if defined(D_PLATFORM_LINUX)
+	  _inotify(-1), _wake(-1), _directories()
+#elif defined(D_PLATFORM_WINDOWS)
+	  _wake(nullptr), _directories()
+#endif
+{
+#if defined(D_PLATFORM_LINUX)
+	_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	_wake    = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if ((_inotify == -1) || (_wake == -1)) {
+		DLOG_WARNING("File change notifications are unavailable, falling back to polling.");
+	}
+#elif defined(D_PLATFORM_WINDOWS)
+	_wake = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+	if (!_wake) {
+		DLOG_WARNING("File change notifications are unavailable, falling back to polling.");
+	}
+#endif
+
+	_worker = std::thread([this]() { work(); });
+}
+
+std::shared_ptr<streamfx::util::file_watcher::subscription> streamfx::util::file_watcher::watch(const std::filesystem::path& path)
+{
+	auto sub = std::make_shared<subscription>(path);
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		_subscriptions.push_back(sub);
+		_dirty = true;
+	}
+	wake();
+	return sub;
+}
+
+void streamfx::util::file_watcher::work()
+{
+	do {
+		try {
+			check();
+		} catch (const std::exception& ex) {
+			DLOG_ERROR("Checking files for changes failed: %s", ex.what());
+		}
+	} while (wait(poll_interval));
+}
+
+void streamfx::util::file_watcher::wake()
+{
+#if defined(D_PLATFORM_LINUX)
+	if (_wake != -1) {
+		uint64_t value = 1;
+		[[maybe_unused]] auto res = write(_wake, &value, sizeof(value));
+	}
+#elif defined(D_PLATFORM_WINDOWS)
+	if (_wake) {
+		SetEvent(_wake);
+	}
+#endif
+	_cv.notify_all();
+}
+
+bool streamfx::util::file_watcher::wait(std::chrono::milliseconds timeout)
+{
+	// The notifications themselves are not inspected, they only end the wait early so that check() runs sooner.
+#if defined(D_PLATFORM_LINUX)
+	if ((_inotify != -1) && (_wake != -1)) {
+		pollfd fds[2] = {{_wake, POLLIN, 0}, {_inotify, POLLIN, 0}};
+		if (poll(fds, 2, static_cast<int>(timeout.count())) > 0) {
+			char buffer[4096];
+			while (read(_inotify, buffer, sizeof(buffer)) > 0) {
+			}
+			uint64_t value;
+			[[maybe_unused]] auto res = read(_wake, &value, sizeof(value));
+		}
+
+		std::unique_lock<std::mutex> lock(_lock);
+		return !_stop;
+	}
+#elif defined(D_PLATFORM_WINDOWS)
+	if (_wake) {
+		std::vector<HANDLE> handles;
+		handles.reserve(_directories.size() + 1);
+		handles.push_back(_wake);
+		for (auto& kv : _directories) {
+			handles.push_back(kv.second);
+		}
+
+		DWORD res = WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(), FALSE, static_cast<DWORD>(timeout.count()));
+		if ((res > WAIT_OBJECT_0) && (res < (WAIT_OBJECT_0 + handles.size()))) {
+			FindNextChangeNotification(handles[res - WAIT_OBJECT_0]);
+		}
+
+		std::unique_lock<std::mutex> lock(_lock);
+		return !_stop;
+	}
+#endif
+
+	std::unique_lock<std::mutex> lock(_lock);
+	_cv.wait_for(lock, timeout, [this]() { return _stop || _dirty; });
+	return !_stop;
+}
+
+void streamfx::util::file_watcher::check()
+{
+	// Gather all live subscriptions by file, so that each file is only checked once.
+	std::map<std::filesystem::path, std::list<std::shared_ptr<subscription>>> files;
+	bool                                                                       dirty = false;
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		for (auto iter = _subscriptions.begin(); iter != _subscriptions.end();) {
+			if (auto sub = iter->lock(); sub) {
+				files[sub->_path].push_back(sub);
+				iter++;
+			} else {
+				iter  = _subscriptions.erase(iter);
+				dirty = true;
+			}
+		}
+		dirty |= _dirty;
+		_dirty = false;
+	}
+
+	if (dirty) {
+		for (auto iter = _files.begin(); iter != _files.end();) {
+			if (files.find(iter->first) == files.end()) {
+				iter = _files.erase(iter);
+			} else {
+				iter++;
+			}
+		}
+		update_directories(files);
+	}
+
+	for (auto& kv : files) {
+		file_state      state = {false, {}, 0};
+		std::error_code ec;
+		if (std::filesystem::exists(kv.first, ec)) {
+			state.exists = true;
+			state.time   = std::filesystem::last_write_time(kv.first, ec);
+			state.size   = std::filesystem::file_size(kv.first, ec);
+		}
+
+		// The first check only records the current state, as the subscriber has just loaded the file.
+		auto known = _files.find(kv.first);
+		if (known == _files.end()) {
+			_files.emplace(kv.first, state);
+			continue;
+		}
+
+		if ((known->second.exists != state.exists) || (known->second.time != state.time) || (known->second.size != state.size)) {
+			known->second = state;
+			for (auto& sub : kv.second) {
+				sub->_changed = true;
+			}
+		}
+	}
+}
+
+void streamfx::util::file_watcher::update_directories(const std::map<std::filesystem::path, std::list<std::shared_ptr<subscription>>>& files)
+{
+#if defined(D_PLATFORM_LINUX) || defined(D_PLATFORM_WINDOWS)
+	std::set<std::filesystem::path> directories;
+	for (auto& kv : files) {
+		directories.insert(kv.first.parent_path());
+	}
+
+	for (auto iter = _directories.begin(); iter != _directories.end();) {
+		if (directories.find(iter->first) == directories.end()) {
+#if defined(D_PLATFORM_LINUX)
+			inotify_rm_watch(_inotify, iter->second);
+#else
+			FindCloseChangeNotification(iter->second);
+#endif
+			iter = _directories.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+
+	for (auto& directory : directories) {
+		if (_directories.find(directory) != _directories.end()) {
+			continue;
+		}
+
+		// Directories which can not be watched are still polled.
+#if defined(D_PLATFORM_LINUX)
+		if (_inotify == -1) {
+			break;
+		}
+		int wd = inotify_add_watch(_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ATTRIB);
+		if (wd != -1) {
+			_directories.emplace(directory, wd);
+		}
+#else
+		if (!_wake || ((_directories.size() + 1) >= MAXIMUM_WAIT_OBJECTS)) {
+			break;
+		}
+		HANDLE handle = FindFirstChangeNotificationW(directory.wstring().c_str(), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+		if (handle != INVALID_HANDLE_VALUE) {
+			_directories.emplace(directory, handle);
+		}
+#endif
+	}
+#else
+	(void)files;
+#endif
+}
+
+std::shared_ptr<streamfx::util::file_watcher> streamfx::util::file_watcher::instance()
+{
+	static std::weak_ptr<streamfx::util::file_watcher> winst;
+	static std::mutex                                  mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::util::file_watcher>(new streamfx::util::file_watcher());
+		winst    = instance;
+	}
+	return instance;
+}
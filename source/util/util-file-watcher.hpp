@@ -0,0 +1,91 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "warning-enable.hpp"
+
+namespace streamfx::util {
+	/** Watches files for changes on a single background thread.
+	 *
+	 * Native change notifications (inotify, change notification handles) only wake the thread early, every watched file
+	 * is still checked at a fixed interval, as network shares rarely deliver notifications. Nothing here ever runs on the
+	 * caller's thread, so checking for changes is free for the caller.
+	 */
+	class file_watcher {
+		public:
+		class subscription {
+			friend class file_watcher;
+
+			std::filesystem::path _path;
+			std::atomic<bool>     _changed;
+
+			public:
+			subscription(const std::filesystem::path& path);
+			~subscription();
+
+			const std::filesystem::path& path() const;
+
+			/** Has the file changed since the last call? */
+			bool changed();
+		};
+
+		private:
+		struct file_state {
+			bool                            exists;
+			std::filesystem::file_time_type time;
+			uintmax_t                       size;
+		};
+
+		std::mutex                                  _lock;
+		std::condition_variable                     _cv;
+		bool                                        _stop;
+		bool                                        _dirty;
+		std::list<std::weak_ptr<subscription>>      _subscriptions;
+		std::map<std::filesystem::path, file_state> _files; // Only accessed by the worker.
+		std::thread                                 _worker;
+
+#if defined(D_PLATFORM_LINUX)
+		int                                  _inotify;
+		int                                  _wake;
+		std::map<std::filesystem::path, int> _directories;
+#elif defined(D_PLATFORM_WINDOWS)
+		void*                                  _wake;
+		std::map<std::filesystem::path, void*> _directories;
+#endif
+
+		public:
+		~file_watcher();
+		file_watcher();
+
+		/** Start watching a file, it is watched for as long as the subscription is alive. */
+		std::shared_ptr<subscription> watch(const std::filesystem::path& path);
+
+		private:
+		void work();
+
+		void wake();
+
+		bool wait(std::chrono::milliseconds timeout);
+
+		void check();
+
+		void update_directories(const std::map<std::filesystem::path, std::list<std::shared_ptr<subscription>>>& files);
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::util::file_watcher> instance();
+	};
+} // namespace streamfx::util
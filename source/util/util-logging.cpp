@@ -5,24 +5,232 @@
 
 #include "util-logging.hpp"
 #include "common.hpp"
+#include "plugin.hpp"
 
 #include "warning-disable.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <stdarg.h>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include "warning-enable.hpp"
 
+namespace {
+	constexpr std::size_t records     = 1024; // Must be a power of two.
+	constexpr std::size_t record_size = 512; // Longer messages are allocated instead.
+
+	// Identical messages beyond this many per window are counted instead of written.
+	constexpr uint32_t                  repeat_limit  = 5;
+	constexpr std::chrono::milliseconds repeat_window = std::chrono::milliseconds(1000);
+
+	struct record {
+		std::atomic<std::size_t> sequence;
+		int32_t                  level;
+		char*                    overflow;
+		char                     text[record_size];
+	};
+
+	struct repeat {
+		std::chrono::steady_clock::time_point start;
+		uint32_t                              count;
+		uint64_t                              suppressed;
+		int32_t                               level;
+		std::string                           text;
+	};
+
+	/** Bounded multi-producer single-consumer ring of formatted messages, see Dmitry Vyukov's bounded queue.
+	 *
+	 * A producer claims a record by advancing the head, formats into it and then publishes it by advancing its
+	 * sequence. Nothing on that path takes a lock or allocates, unless the message does not fit into a record.
+	 */
+	struct queue {
+		std::array<record, records>          ring;
+		alignas(64) std::atomic<std::size_t> head;
+		alignas(64) std::size_t              tail; // Only touched by whoever drains.
+		std::atomic<uint64_t>                dropped;
+		std::atomic<bool>                    running;
+		std::atomic<bool>                    sleeping;
+
+		std::mutex                              lock;
+		std::condition_variable                 signal;
+		bool                                    stop;
+		std::thread                             worker;
+		std::unordered_map<std::size_t, repeat> repeats;
+
+		queue() : head(0), tail(0), dropped(0), running(false), sleeping(false), stop(false)
+		{
+			for (std::size_t idx = 0; idx < records; idx++) {
+				ring[idx].sequence.store(idx, std::memory_order_relaxed);
+				ring[idx].overflow = nullptr;
+			}
+		}
+	};
+
+	queue& get_queue()
+	{
+		static queue instance;
+		return instance;
+	}
+
+	int32_t to_blog(streamfx::util::logging::level lvl)
+	{
+		switch (lvl) {
+		case streamfx::util::logging::level::LEVEL_DEBUG:
+			return LOG_DEBUG;
+		case streamfx::util::logging::level::LEVEL_INFO:
+			return LOG_INFO;
+		case streamfx::util::logging::level::LEVEL_WARN:
+			return LOG_WARNING;
+		default:
+			return LOG_ERROR;
+		}
+	}
+
+	void write(queue& q, int32_t level, const char* text)
+	{
+		auto now = std::chrono::steady_clock::now();
+		auto key = std::hash<std::string_view>()(text) ^ static_cast<std::size_t>(level);
+
+		auto kv = q.repeats.find(key);
+		if (kv == q.repeats.end()) {
+			kv = q.repeats.emplace(key, repeat{now, 0, 0, level, text}).first;
+		}
+		if (++kv->second.count > repeat_limit) {
+			kv->second.suppressed++;
+			return;
+		}
+
+		blog(level, "[StreamFX] %s", text);
+	}
+
+	void expire(queue& q, bool all)
+	{
+		auto now = std::chrono::steady_clock::now();
+		for (auto kv = q.repeats.begin(); kv != q.repeats.end();) {
+			if (!all && ((now - kv->second.start) < repeat_window)) {
+				++kv;
+				continue;
+			}
+			if (kv->second.suppressed > 0) {
+				blog(kv->second.level, "[StreamFX] (Suppressed %" PRIu64 " repeats of: %s)", kv->second.suppressed, kv->second.text.c_str());
+			}
+			kv = q.repeats.erase(kv);
+		}
+	}
+
+	/** Write all published records. Only one thread may drain at a time. */
+	void drain(queue& q)
+	{
+		for (;;) {
+			record&     rec = q.ring[q.tail & (records - 1)];
+			std::size_t seq = rec.sequence.load(std::memory_order_acquire);
+			if (seq != (q.tail + 1)) {
+				break;
+			}
+
+			if (rec.overflow) {
+				write(q, rec.level, rec.overflow);
+				delete[] rec.overflow;
+				rec.overflow = nullptr;
+			} else {
+				write(q, rec.level, rec.text);
+			}
+
+			rec.sequence.store(q.tail + records, std::memory_order_release);
+			q.tail++;
+		}
+
+		if (uint64_t dropped = q.dropped.exchange(0, std::memory_order_relaxed); dropped > 0) {
+			blog(LOG_WARNING, "[StreamFX] Dropped %" PRIu64 " messages, as they were logged faster than they could be written.", dropped);
+		}
+	}
+
+	void work()
+	{
+		auto&                        q = get_queue();
+		std::unique_lock<std::mutex> ul(q.lock);
+		while (!q.stop) {
+			ul.unlock();
+			drain(q);
+			expire(q, false);
+			ul.lock();
+
+			// Producers only wake us up when we said we'd sleep, which keeps a futex call out of every message. The
+			// timeout covers the race where a record is published between draining and sleeping.
+			q.sleeping.store(true, std::memory_order_seq_cst);
+			q.signal.wait_for(ul, std::chrono::milliseconds(100));
+			q.sleeping.store(false, std::memory_order_relaxed);
+		}
+		ul.unlock();
+
+		drain(q);
+		expire(q, true);
+	}
+
+	bool enqueue(queue& q, int32_t level, const char* format, va_list vargs)
+	{
+		std::size_t pos = q.head.load(std::memory_order_relaxed);
+		record*     rec = nullptr;
+		for (;;) {
+			rec              = &q.ring[pos & (records - 1)];
+			std::size_t seq  = rec->sequence.load(std::memory_order_acquire);
+			auto        diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+			if (diff == 0) {
+				if (q.head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = q.head.load(std::memory_order_relaxed);
+			}
+		}
+
+		va_list vargs_copy;
+		va_copy(vargs_copy, vargs);
+		int32_t ret = vsnprintf(rec->text, sizeof(rec->text), format, vargs);
+		if (ret < 0) {
+			rec->text[0] = '\0';
+		} else if (static_cast<std::size_t>(ret) >= sizeof(rec->text)) {
+			rec->overflow = new char[static_cast<std::size_t>(ret) + 1];
+			vsnprintf(rec->overflow, static_cast<std::size_t>(ret) + 1, format, vargs_copy);
+		}
+		va_end(vargs_copy);
+
+		rec->level = level;
+		rec->sequence.store(pos + 1, std::memory_order_release);
+
+		if (q.sleeping.load(std::memory_order_seq_cst) && q.sleeping.exchange(false)) {
+			q.signal.notify_one();
+		}
+		return true;
+	}
+} // namespace
+
 void streamfx::util::logging::log(level lvl, const char* format, ...)
 {
-	const static std::map<level, int32_t> level_map = {
-		{level::LEVEL_DEBUG, LOG_DEBUG},
-		{level::LEVEL_INFO, LOG_INFO},
-		{level::LEVEL_WARN, LOG_WARNING},
-		{level::LEVEL_ERROR, LOG_ERROR},
-	};
-	thread_local static std::vector<char> buffer;
+	auto& q = get_queue();
 
 	va_list vargs;
 	va_start(vargs, format);
 
+	if (q.running.load(std::memory_order_acquire)) {
+		if (!enqueue(q, to_blog(lvl), format, vargs)) {
+			q.dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+		va_end(vargs);
+		return;
+	}
+
+	// Without the background thread, write directly.
+	thread_local static std::vector<char> buffer;
+
 	va_list vargs_copy;
 	va_copy(vargs_copy, vargs);
 	int32_t ret = vsnprintf(buffer.data(), buffer.size(), format, vargs);
@@ -32,5 +240,30 @@ void streamfx::util::logging::log(level lvl, const char* format, ...)
 	va_end(vargs);
 	va_end(vargs_copy);
 
-	blog(level_map.at(lvl), "[StreamFX] %s", buffer.data());
+	blog(to_blog(lvl), "[StreamFX] %s", buffer.data());
 }
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		auto& q  = get_queue();
+		q.stop   = false;
+		q.worker = std::thread(work);
+		q.running.store(true, std::memory_order_release);
+	},
+	[]() { // Finalizer
+		auto& q = get_queue();
+		q.running.store(false, std::memory_order_release);
+		{
+			std::lock_guard<std::mutex> lg(q.lock);
+			q.stop = true;
+			q.signal.notify_all();
+		}
+		if (q.worker.joinable()) {
+			q.worker.join();
+		}
+
+		// Pick up what was published while the worker was shutting down.
+		drain(q);
+		expire(q, true);
+	},
+	streamfx::loader_priority::HIGHEST); // Everything else may log, so start first and stop last.
@@ -41,5 +41,11 @@ namespace streamfx::util::logging {
 		LEVEL_ERROR, // Errors that must be fixed.
 	};
 
+	/** Format a message and write it to the OBS log.
+	 *
+	 * While the plugin is loaded, messages are queued and written by a background thread, so that logging never waits
+	 * on the log file. Identical messages repeated more than a few times a second are summarized instead of written,
+	 * and messages are dropped if the queue is full. Before loading and after unloading, messages are written directly.
+	 */
 	void log(level lvl, const char* format, ...);
 } // namespace streamfx::util::logging
@@ -0,0 +1,77 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-plane-copy.hpp"
+#include "common.hpp"
+#include "plugin.hpp"
+#include "util/util-simd.hpp"
+
+#include "warning-disable.hpp"
+#include <cstring>
+#include <thread>
+#include <vector>
+#if defined(D_PLATFORM_INSTR_X86)
+#include <immintrin.h>
+#endif
+#include "warning-enable.hpp"
+
+// Planes smaller than this are copied on the calling thread.
+constexpr std::size_t threshold_parallel = 1024 * 1024;
+// Planes larger than this bypass the cache when written.
+constexpr std::size_t threshold_streaming = 4 * 1024 * 1024;
+// Each band should be at least this many rows.
+constexpr std::size_t band_minimum_rows = 64;
+// More than this is unlikely to help, as we will be limited by memory bandwidth.
+constexpr std::size_t band_maximum = 8;
+
+void streamfx::util::plane_copy::copy_rows(uint8_t* to, std::size_t to_stride, const uint8_t* from, std::size_t from_stride, std::size_t width, std::size_t height, bool streaming)
+{
+	if ((to_stride == from_stride) && (width == to_stride) && !streaming) {
+		// Contiguous memory can be copied in one go.
+		std::memcpy(to, from, width * height);
+		return;
+	}
+
+	if (streaming) {
+		auto copy_streaming = streamfx::util::simd::get().copy_streaming;
+		for (std::size_t y = 0; y < height; y++) {
+			copy_streaming(to, from, width);
+			to += to_stride;
+			from += from_stride;
+		}
+#if defined(D_PLATFORM_INSTR_X86)
+		// Ensure the non-temporal stores are visible to other threads before we return.
+		_mm_sfence();
+#endif
+	} else {
+		for (std::size_t y = 0; y < height; y++) {
+			std::memcpy(to, from, width);
+			to += to_stride;
+			from += from_stride;
+		}
+	}
+}
+
+void streamfx::util::plane_copy::copy(uint8_t* to, std::size_t to_stride, const uint8_t* from, std::size_t from_stride, std::size_t width, std::size_t height)
+{
+	std::size_t bytes     = width * height;
+	bool        streaming = (bytes >= threshold_streaming);
+
+	// Figure out how many bands we want to split this plane into.
+	std::size_t bands = 1;
+	if (bytes >= threshold_parallel) {
+		bands = std::min<std::size_t>(std::max<std::size_t>(std::thread::hardware_concurrency(), 1), band_maximum);
+		bands = std::min<std::size_t>(bands, std::max<std::size_t>(height / band_minimum_rows, 1));
+	}
+	if (bands <= 1) {
+		copy_rows(to, to_stride, from, from_stride, width, height, streaming);
+		return;
+	}
+
+	// Bands never overlap, so no synchronization is necessary here.
+	std::size_t band_rows = (height + bands - 1) / bands;
+	streamfx::threadpool()->parallel_for(0, height, band_rows, [to, to_stride, from, from_stride, width, streaming](std::size_t first, std::size_t last) {
+		copy_rows(to + first * to_stride, to_stride, from + first * from_stride, from_stride, width, last - first, streaming);
+	});
+}
@@ -0,0 +1,32 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "warning-disable.hpp"
+#include <cinttypes>
+#include <cstddef>
+#include "warning-enable.hpp"
+
+namespace streamfx::util::plane_copy {
+	/** Copy a single image plane from one memory location to another.
+	 *
+	 * Large planes are split into bands of rows which are copied in parallel on the StreamFX
+	 * threadpool, and are written with non-temporal stores (where supported) so that the copy
+	 * does not evict the working set of whoever consumes the data afterwards.
+	 *
+	 * @param to Pointer to the first row of the target plane.
+	 * @param to_stride Distance in bytes between two rows in the target plane.
+	 * @param from Pointer to the first row of the source plane.
+	 * @param from_stride Distance in bytes between two rows in the source plane.
+	 * @param width Number of bytes to copy per row.
+	 * @param height Number of rows to copy.
+	 */
+	void copy(uint8_t* to, std::size_t to_stride, const uint8_t* from, std::size_t from_stride, std::size_t width, std::size_t height);
+
+	/** Copy a band of rows on the calling thread only.
+	 *
+	 * @param streaming Use non-temporal stores if the platform supports them.
+	 */
+	void copy_rows(uint8_t* to, std::size_t to_stride, const uint8_t* from, std::size_t from_stride, std::size_t width, std::size_t height, bool streaming);
+} // namespace streamfx::util::plane_copy
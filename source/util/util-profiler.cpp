@@ -5,10 +5,15 @@
 #include "util-profiler.hpp"
 
 #include "warning-disable.hpp"
-#include <iterator>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 #include "warning-enable.hpp"
 
-streamfx::util::profiler::profiler() {}
+streamfx::util::profiler::profiler() : _timings() {}
 
 streamfx::util::profiler::~profiler() {}
 
@@ -19,117 +24,37 @@ std::shared_ptr<streamfx::util::profiler::instance> streamfx::util::profiler::tr
 
 void streamfx::util::profiler::track(std::chrono::nanoseconds duration)
 {
-	std::unique_lock<std::mutex> ul(_timings_lock);
-	auto                         itr = _timings.find(duration);
-	if (itr == _timings.end()) {
-		_timings.emplace(duration, 1u);
-	} else {
-		itr->second++;
-	}
+	_timings.track(duration);
 }
 
 uint64_t streamfx::util::profiler::count()
 {
-	uint64_t count = 0;
-
-	std::map<std::chrono::nanoseconds, size_t> copy_timings;
-	{
-		std::unique_lock<std::mutex> ul(_timings_lock);
-		copy(_timings.begin(), _timings.end(), std::inserter(copy_timings, copy_timings.end()));
-	}
-
-	for (auto kv : copy_timings) {
-		count += kv.second;
-	}
-
-	return count;
+	return _timings.count();
 }
 
 std::chrono::nanoseconds streamfx::util::profiler::total_duration()
 {
-	std::chrono::nanoseconds duration{0};
-
-	std::map<std::chrono::nanoseconds, size_t> copy_timings;
-	{
-		std::unique_lock<std::mutex> ul(_timings_lock);
-		copy(_timings.begin(), _timings.end(), std::inserter(copy_timings, copy_timings.end()));
-	}
-
-	for (auto kv : copy_timings) {
-		duration += kv.first * kv.second;
-	}
-
-	return duration;
+	return _timings.total_duration();
 }
 
 double_t streamfx::util::profiler::average_duration()
 {
-	std::chrono::nanoseconds duration{0};
-	uint64_t                 count = 0;
-
-	std::map<std::chrono::nanoseconds, size_t> copy_timings;
-	{
-		std::unique_lock<std::mutex> ul(_timings_lock);
-		copy(_timings.begin(), _timings.end(), std::inserter(copy_timings, copy_timings.end()));
-	}
-
-	for (auto kv : copy_timings) {
-		duration += kv.first * kv.second;
-		count += kv.second;
-	}
-
-	return double_t(duration.count()) / double_t(count);
-}
-
-template<typename T>
-inline bool is_equal(T a, T b, T c)
-{
-	return (a == b) || ((a >= (b - c)) && (a <= (b + c)));
+	return _timings.average_duration();
 }
 
 std::chrono::nanoseconds streamfx::util::profiler::percentile(double_t percentile, bool by_time)
 {
-	constexpr double_t edge  = 0.00005;
-	uint64_t           calls = count();
-
-	std::map<std::chrono::nanoseconds, size_t> copy_timings;
-	{
-		std::unique_lock<std::mutex> ul(_timings_lock);
-		copy(_timings.begin(), _timings.end(), inserter(copy_timings, copy_timings.end()));
+	if (_timings.count() == 0) {
+		return std::chrono::nanoseconds(-1);
 	}
+
 	if (by_time) { // Return by time percentile.
-		// Find largest and smallest time.
-		std::chrono::nanoseconds smallest = copy_timings.begin()->first;
-		std::chrono::nanoseconds largest  = copy_timings.rbegin()->first;
-		std::chrono::nanoseconds variance = largest - smallest;
-
-		for (auto kv : copy_timings) {
-			double_t kv_pct = double_t((kv.first - smallest).count()) / double_t(variance.count());
-			if (is_equal<double_t>(kv_pct, percentile, edge) || (kv_pct > percentile)) {
-				return std::chrono::nanoseconds(kv.first);
-			}
-		}
+		auto smallest = _timings.minimum();
+		auto largest  = _timings.maximum();
+		return smallest + std::chrono::nanoseconds(static_cast<int64_t>(double_t((largest - smallest).count()) * std::clamp(percentile, 0., 1.)));
 	} else { // Return by call percentile.
-		if (percentile == 0.0) {
-			return copy_timings.begin()->first;
-		}
-
-		uint64_t accu_calls_now = 0;
-		for (auto kv : copy_timings) {
-			uint64_t accu_calls_last = accu_calls_now;
-			accu_calls_now += kv.second;
-
-			double_t percentile_last = double_t(accu_calls_last) / double_t(calls);
-			double_t percentile_now  = double_t(accu_calls_now) / double_t(calls);
-
-			if (is_equal<double_t>(percentile, percentile_now, edge)
-				|| ((percentile_last < percentile) && (percentile_now > percentile))) {
-				return std::chrono::nanoseconds(kv.first);
-			}
-		}
+		return _timings.percentile(percentile);
 	}
-
-	return std::chrono::nanoseconds(-1);
 }
 
 streamfx::util::profiler::instance::instance(std::shared_ptr<streamfx::util::profiler> parent)
@@ -154,3 +79,109 @@ void streamfx::util::profiler::instance::reparent(std::shared_ptr<streamfx::util
 {
 	_parent = parent;
 }
+
+streamfx::util::histogram::histogram() : _buckets(), _count(0), _total(0), _minimum(std::numeric_limits<uint64_t>::max()), _maximum(0)
+{
+	for (auto& bucket : _buckets) {
+		bucket.store(0, std::memory_order_relaxed);
+	}
+}
+
+streamfx::util::histogram::~histogram() {}
+
+void streamfx::util::histogram::track(std::chrono::nanoseconds duration)
+{
+	uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+	_buckets[bucket_of(ns / 1000)].fetch_add(1, std::memory_order_relaxed);
+	_count.fetch_add(1, std::memory_order_relaxed);
+	_total.fetch_add(ns, std::memory_order_relaxed);
+
+	// Only loops while another thread updated the same extreme, which is rare.
+	for (uint64_t value = _minimum.load(std::memory_order_relaxed); (ns < value) && !_minimum.compare_exchange_weak(value, ns, std::memory_order_relaxed);) {
+	}
+	for (uint64_t value = _maximum.load(std::memory_order_relaxed); (ns > value) && !_maximum.compare_exchange_weak(value, ns, std::memory_order_relaxed);) {
+	}
+}
+
+uint64_t streamfx::util::histogram::count() const
+{
+	return _count.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds streamfx::util::histogram::total_duration() const
+{
+	return std::chrono::nanoseconds(static_cast<int64_t>(_total.load(std::memory_order_relaxed)));
+}
+
+std::chrono::nanoseconds streamfx::util::histogram::minimum() const
+{
+	return _count.load(std::memory_order_relaxed) ? std::chrono::nanoseconds(static_cast<int64_t>(_minimum.load(std::memory_order_relaxed))) : std::chrono::nanoseconds(0);
+}
+
+std::chrono::nanoseconds streamfx::util::histogram::maximum() const
+{
+	return std::chrono::nanoseconds(static_cast<int64_t>(_maximum.load(std::memory_order_relaxed)));
+}
+
+double_t streamfx::util::histogram::average_duration() const
+{
+	uint64_t count = _count.load(std::memory_order_relaxed);
+	return count ? (double_t(_total.load(std::memory_order_relaxed)) / double_t(count)) : 0.;
+}
+
+std::chrono::nanoseconds streamfx::util::histogram::percentile(double_t percentile) const
+{
+	// Buckets keep changing while we read them, so count them ourselves instead of relying on _count.
+	std::array<uint64_t, buckets> snapshot;
+	uint64_t                      count = 0;
+	for (std::size_t idx = 0; idx < buckets; idx++) {
+		snapshot[idx] = _buckets[idx].load(std::memory_order_relaxed);
+		count += snapshot[idx];
+	}
+	if (count == 0) {
+		return std::chrono::nanoseconds(0);
+	}
+
+	uint64_t target = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0., 1.) * double_t(count))), 1);
+	uint64_t seen   = 0;
+	for (std::size_t idx = 0; idx < buckets; idx++) {
+		seen += snapshot[idx];
+		if (seen >= target) {
+			return bucket_value(idx);
+		}
+	}
+	return bucket_value(buckets - 1);
+}
+
+std::size_t streamfx::util::histogram::bucket_of(uint64_t microseconds)
+{
+	if (microseconds < linear_buckets) {
+		return static_cast<std::size_t>(microseconds);
+	}
+
+	// Position of the highest set bit, which is at least 4 here.
+#ifdef _MSC_VER
+	unsigned long msb = 0;
+	_BitScanReverse64(&msb, microseconds);
+	std::size_t exponent = static_cast<std::size_t>(msb);
+#else
+	std::size_t exponent = static_cast<std::size_t>(63 - __builtin_clzll(microseconds));
+#endif
+	std::size_t sub    = static_cast<std::size_t>((microseconds >> (exponent - 3)) & (sub_buckets - 1));
+	std::size_t bucket = linear_buckets + (exponent - 4) * sub_buckets + sub;
+	return std::min<std::size_t>(bucket, buckets - 1);
+}
+
+std::chrono::nanoseconds streamfx::util::histogram::bucket_value(std::size_t bucket)
+{
+	if (bucket < linear_buckets) {
+		return std::chrono::microseconds(bucket);
+	}
+
+	// Report the middle of the bucket.
+	std::size_t exponent = ((bucket - linear_buckets) / sub_buckets) + 4;
+	std::size_t sub      = (bucket - linear_buckets) % sub_buckets;
+	uint64_t    low      = static_cast<uint64_t>(sub_buckets + sub) << (exponent - 3);
+	uint64_t    width    = uint64_t(1) << (exponent - 3);
+	return std::chrono::nanoseconds(static_cast<int64_t>((low * 1000) + (width * 500)));
+}
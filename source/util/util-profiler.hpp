@@ -6,15 +6,74 @@
 #include "common.hpp"
 
 #include "warning-disable.hpp"
+#include <array>
+#include <atomic>
 #include <chrono>
-#include <map>
-#include <mutex>
 #include "warning-enable.hpp"
 
 namespace streamfx::util {
+	/** Low overhead histogram of durations, cheap enough to always be enabled.
+	 *
+	 * Recording neither locks nor allocates. Durations are sorted into logarithmic buckets with 8 sub-buckets per power
+	 * of two of microseconds, so percentiles are accurate to about 12.5% while memory stays fixed.
+	 */
+	class histogram {
+		static constexpr std::size_t linear_buckets = 16;
+		static constexpr std::size_t sub_buckets    = 8;
+		static constexpr std::size_t buckets        = linear_buckets + (32 * sub_buckets);
+
+		std::array<std::atomic<uint64_t>, buckets> _buckets;
+		std::atomic<uint64_t>                      _count;
+		std::atomic<uint64_t>                      _total;
+		std::atomic<uint64_t>                      _minimum;
+		std::atomic<uint64_t>                      _maximum;
+
+		public:
+		class scope {
+			histogram*                            _parent;
+			std::chrono::steady_clock::time_point _start;
+
+			public:
+			scope(histogram& parent) : _parent(&parent), _start(std::chrono::steady_clock::now()) {}
+			~scope()
+			{
+				_parent->track(std::chrono::steady_clock::now() - _start);
+			}
+		};
+
+		public:
+		histogram();
+		~histogram();
+
+		/** Start tracking a duration which ends once the returned object goes out of scope. */
+		scope track()
+		{
+			return scope(*this);
+		}
+
+		void track(std::chrono::nanoseconds duration);
+
+		uint64_t count() const;
+
+		std::chrono::nanoseconds total_duration() const;
+
+		double_t average_duration() const;
+
+		/** Shortest and longest tracked duration, exact rather than by bucket. */
+		std::chrono::nanoseconds minimum() const;
+		std::chrono::nanoseconds maximum() const;
+
+		/** Estimate the duration below which the given fraction (0..1) of all tracked durations are. */
+		std::chrono::nanoseconds percentile(double_t percentile) const;
+
+		private:
+		static std::size_t              bucket_of(uint64_t microseconds);
+		static std::chrono::nanoseconds bucket_value(std::size_t bucket);
+	};
+
+	/** Shared histogram, for durations that are tracked from several places or outlive their owner. */
 	class profiler : public std::enable_shared_from_this<streamfx::util::profiler> {
-		std::map<std::chrono::nanoseconds, size_t> _timings;
-		std::mutex                                 _timings_lock;
+		histogram _timings;
 
 		public:
 		class instance {
@@ -0,0 +1,57 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-region-hints.hpp"
+
+#include "warning-disable.hpp"
+#include <util/platform.h>
+#include "warning-enable.hpp"
+
+streamfx::util::region_hints::region_hints() : _lock(), _entries() {}
+
+streamfx::util::region_hints::~region_hints() {}
+
+void streamfx::util::region_hints::publish(const void* publisher, std::vector<region> regions)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	auto&                        entry = _entries[publisher];
+	entry.timestamp                    = os_gettime_ns();
+	entry.regions                      = std::move(regions);
+}
+
+void streamfx::util::region_hints::withdraw(const void* publisher)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	_entries.erase(publisher);
+}
+
+std::vector<streamfx::util::region_hints::region> streamfx::util::region_hints::collect(uint64_t max_age)
+{
+	std::vector<region> result;
+	uint64_t            now = os_gettime_ns();
+
+	std::unique_lock<std::mutex> ul(_lock);
+	for (auto& kv : _entries) {
+		// Publishers that stopped ticking, like filters on hidden sources, no longer describe the picture.
+		if ((now - kv.second.timestamp) > max_age) {
+			continue;
+		}
+		result.insert(result.end(), kv.second.regions.begin(), kv.second.regions.end());
+	}
+	return result;
+}
+
+std::shared_ptr<streamfx::util::region_hints> streamfx::util::region_hints::get()
+{
+	static std::weak_ptr<streamfx::util::region_hints> instance;
+	static std::mutex                                  lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (instance.expired()) {
+		auto hard_instance = std::shared_ptr<streamfx::util::region_hints>(new streamfx::util::region_hints());
+		instance           = hard_instance;
+		return hard_instance;
+	}
+	return instance.lock();
+}
@@ -0,0 +1,55 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "warning-disable.hpp"
+#include <cinttypes>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::util {
+	/** Regions of the picture that filters know to be more (or less) important than the rest, for encoders to spend
+	 * their bits on.
+	 *
+	 * Filters publish the regions they found every tick, and encoders collect whatever is recent enough when they
+	 * encode a frame. Regions are normalized to the output of the publisher, which is assumed to fill the frame.
+	 */
+	class region_hints {
+		public:
+		struct region {
+			float x, y, width, height; // Normalized, with 0,0 being the top left.
+			float emphasis;            // -1 (spend fewer bits) to 1 (spend more bits).
+		};
+
+		private:
+		struct entry {
+			uint64_t            timestamp;
+			std::vector<region> regions;
+		};
+
+		std::mutex                   _lock;
+		std::map<const void*, entry> _entries;
+
+		private:
+		region_hints();
+
+		public:
+		~region_hints();
+
+		/** Replace all regions previously published by the same publisher. */
+		void publish(const void* publisher, std::vector<region> regions);
+
+		/** Remove all regions of a publisher, for example when it is destroyed. */
+		void withdraw(const void* publisher);
+
+		/** All regions published within the last max_age nanoseconds. */
+		std::vector<region> collect(uint64_t max_age);
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::util::region_hints> get();
+	};
+} // namespace streamfx::util
@@ -0,0 +1,513 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-simd.hpp"
+#include "common.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <cmath>
+#include <cstring>
+#if defined(D_PLATFORM_INSTR_X86)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(D_PLATFORM_INSTR_ARM) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<util::simd> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+// Kernels for newer instruction sets are compiled for them alone, so the rest of the plugin keeps running anywhere.
+// MSVC allows any intrinsic in any function, and needs no annotation.
+#if defined(D_PLATFORM_INSTR_X86) && !defined(_MSC_VER)
+#define ST_TARGET_AVX2 __attribute__((target("avx2")))
+#define ST_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#else
+#define ST_TARGET_AVX2
+#define ST_TARGET_AVX512
+#endif
+
+// Scalar
+static void scalar_multiply(float* out, const float* a, const float* b, std::size_t count)
+{
+	for (std::size_t idx = 0; idx < count; idx++) {
+		out[idx] = a[idx] * b[idx];
+	}
+}
+
+static void scalar_mix(float* out, const float* in, float gain, std::size_t count)
+{
+	for (std::size_t idx = 0; idx < count; idx++) {
+		out[idx] += in[idx] * gain;
+	}
+}
+
+static void scalar_magnitude(float* out, const float* re, const float* im, float scale, std::size_t count)
+{
+	for (std::size_t idx = 0; idx < count; idx++) {
+		out[idx] = std::sqrt(re[idx] * re[idx] + im[idx] * im[idx]) * scale;
+	}
+}
+
+static void scalar_luma_rgba8(uint8_t* out, const uint8_t* rgba, std::size_t count)
+{
+	for (std::size_t idx = 0; idx < count; idx++) {
+		const uint8_t* px = rgba + idx * 4;
+		out[idx]          = static_cast<uint8_t>((px[0] * 54u + px[1] * 183u + px[2] * 19u) >> 8);
+	}
+}
+
+static void scalar_copy_streaming(uint8_t* to, const uint8_t* from, std::size_t bytes)
+{
+	std::memcpy(to, from, bytes);
+}
+
+static constexpr streamfx::util::simd::kernels kernels_scalar = {
+	streamfx::util::simd::level::SCALAR, scalar_multiply, scalar_mix, scalar_magnitude, scalar_luma_rgba8, scalar_copy_streaming,
+};
+
+#if defined(D_PLATFORM_INSTR_X86)
+// SSE2
+static void sse2_multiply(float* out, const float* a, const float* b, std::size_t count)
+{
+	std::size_t idx = 0;
+	for (; (idx + 4) <= count; idx += 4) {
+		_mm_storeu_ps(out + idx, _mm_mul_ps(_mm_loadu_ps(a + idx), _mm_loadu_ps(b + idx)));
+	}
+	scalar_multiply(out + idx, a + idx, b + idx, count - idx);
+}
+
+static void sse2_mix(float* out, const float* in, float gain, std::size_t count)
+{
+	__m128      vgain = _mm_set1_ps(gain);
+	std::size_t idx   = 0;
+	for (; (idx + 4) <= count; idx += 4) {
+		_mm_storeu_ps(out + idx, _mm_add_ps(_mm_loadu_ps(out + idx), _mm_mul_ps(_mm_loadu_ps(in + idx), vgain)));
+	}
+	scalar_mix(out + idx, in + idx, gain, count - idx);
+}
+
+static void sse2_magnitude(float* out, const float* re, const float* im, float scale, std::size_t count)
+{
+	__m128      vscale = _mm_set1_ps(scale);
+	std::size_t idx    = 0;
+	for (; (idx + 4) <= count; idx += 4) {
+		__m128 r = _mm_loadu_ps(re + idx);
+		__m128 i = _mm_loadu_ps(im + idx);
+		_mm_storeu_ps(out + idx, _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(i, i))), vscale));
+	}
+	scalar_magnitude(out + idx, re + idx, im + idx, scale, count - idx);
+}
+
+static void sse2_luma_rgba8(uint8_t* out, const uint8_t* rgba, std::size_t count)
+{
+	// No product exceeds 16 bits, so 16-bit multiplies on 32-bit lanes are exact.
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	const __m128i wr   = _mm_set1_epi32(54);
+	const __m128i wg   = _mm_set1_epi32(183);
+	const __m128i wb   = _mm_set1_epi32(19);
+
+	std::size_t idx = 0;
+	for (; (idx + 4) <= count; idx += 4) {
+		__m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + idx * 4));
+		__m128i r  = _mm_and_si128(px, mask);
+		__m128i g  = _mm_and_si128(_mm_srli_epi32(px, 8), mask);
+		__m128i b  = _mm_and_si128(_mm_srli_epi32(px, 16), mask);
+		__m128i l  = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(_mm_mullo_epi16(r, wr), _mm_mullo_epi16(g, wg)), _mm_mullo_epi16(b, wb)), 8);
+		l          = _mm_packs_epi32(l, l);
+		l          = _mm_packus_epi16(l, l);
+
+		int32_t packed = _mm_cvtsi128_si32(l);
+		std::memcpy(out + idx, &packed, sizeof(packed));
+	}
+	scalar_luma_rgba8(out + idx, rgba + idx * 4, count - idx);
+}
+
+static void sse2_copy_streaming(uint8_t* to, const uint8_t* from, std::size_t bytes)
+{
+	constexpr std::size_t block = sizeof(__m128i);
+
+	// Non-temporal stores require an aligned target, so copy the unaligned head normally.
+	std::size_t head = (block - (reinterpret_cast<uintptr_t>(to) % block)) % block;
+	if (head > bytes) {
+		head = bytes;
+	}
+	std::memcpy(to, from, head);
+	to += head;
+	from += head;
+	bytes -= head;
+
+	std::size_t body = bytes - (bytes % block);
+	for (std::size_t pos = 0; pos < body; pos += block) {
+		_mm_stream_si128(reinterpret_cast<__m128i*>(to + pos), _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + pos)));
+	}
+
+	// And the tail as well.
+	std::memcpy(to + body, from + body, bytes - body);
+}
+
+static constexpr streamfx::util::simd::kernels kernels_sse2 = {
+	streamfx::util::simd::level::SSE2, sse2_multiply, sse2_mix, sse2_magnitude, sse2_luma_rgba8, sse2_copy_streaming,
+};
+
+// AVX2
+ST_TARGET_AVX2 static void avx2_multiply(float* out, const float* a, const float* b, std::size_t count)
+{
+	std::size_t idx = 0;
+	for (; (idx + 8) <= count; idx += 8) {
+		_mm256_storeu_ps(out + idx, _mm256_mul_ps(_mm256_loadu_ps(a + idx), _mm256_loadu_ps(b + idx)));
+	}
+	sse2_multiply(out + idx, a + idx, b + idx, count - idx);
+}
+
+ST_TARGET_AVX2 static void avx2_mix(float* out, const float* in, float gain, std::size_t count)
+{
+	__m256      vgain = _mm256_set1_ps(gain);
+	std::size_t idx   = 0;
+	for (; (idx + 8) <= count; idx += 8) {
+		_mm256_storeu_ps(out + idx, _mm256_add_ps(_mm256_loadu_ps(out + idx), _mm256_mul_ps(_mm256_loadu_ps(in + idx), vgain)));
+	}
+	sse2_mix(out + idx, in + idx, gain, count - idx);
+}
+
+ST_TARGET_AVX2 static void avx2_magnitude(float* out, const float* re, const float* im, float scale, std::size_t count)
+{
+	__m256      vscale = _mm256_set1_ps(scale);
+	std::size_t idx    = 0;
+	for (; (idx + 8) <= count; idx += 8) {
+		__m256 r = _mm256_loadu_ps(re + idx);
+		__m256 i = _mm256_loadu_ps(im + idx);
+		_mm256_storeu_ps(out + idx, _mm256_mul_ps(_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(r, r), _mm256_mul_ps(i, i))), vscale));
+	}
+	sse2_magnitude(out + idx, re + idx, im + idx, scale, count - idx);
+}
+
+ST_TARGET_AVX2 static void avx2_luma_rgba8(uint8_t* out, const uint8_t* rgba, std::size_t count)
+{
+	const __m256i mask = _mm256_set1_epi32(0xFF);
+	const __m256i wr   = _mm256_set1_epi32(54);
+	const __m256i wg   = _mm256_set1_epi32(183);
+	const __m256i wb   = _mm256_set1_epi32(19);
+
+	std::size_t idx = 0;
+	for (; (idx + 8) <= count; idx += 8) {
+		__m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rgba + idx * 4));
+		__m256i r  = _mm256_and_si256(px, mask);
+		__m256i g  = _mm256_and_si256(_mm256_srli_epi32(px, 8), mask);
+		__m256i b  = _mm256_and_si256(_mm256_srli_epi32(px, 16), mask);
+		__m256i l  = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi16(r, wr), _mm256_mullo_epi16(g, wg)), _mm256_mullo_epi16(b, wb)), 8);
+		l          = _mm256_packs_epi32(l, l);
+		l          = _mm256_packus_epi16(l, l);
+
+		// Packing works within each half, which leaves four results at the start of either.
+		int32_t packed[2] = {_mm_cvtsi128_si32(_mm256_castsi256_si128(l)), _mm_cvtsi128_si32(_mm256_extracti128_si256(l, 1))};
+		std::memcpy(out + idx, packed, sizeof(packed));
+	}
+	sse2_luma_rgba8(out + idx, rgba + idx * 4, count - idx);
+}
+
+ST_TARGET_AVX2 static void avx2_copy_streaming(uint8_t* to, const uint8_t* from, std::size_t bytes)
+{
+	constexpr std::size_t block = sizeof(__m256i);
+
+	std::size_t head = (block - (reinterpret_cast<uintptr_t>(to) % block)) % block;
+	if (head > bytes) {
+		head = bytes;
+	}
+	std::memcpy(to, from, head);
+	to += head;
+	from += head;
+	bytes -= head;
+
+	std::size_t body = bytes - (bytes % block);
+	for (std::size_t pos = 0; pos < body; pos += block) {
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(to + pos), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + pos)));
+	}
+	std::memcpy(to + body, from + body, bytes - body);
+}
+
+static constexpr streamfx::util::simd::kernels kernels_avx2 = {
+	streamfx::util::simd::level::AVX2, avx2_multiply, avx2_mix, avx2_magnitude, avx2_luma_rgba8, avx2_copy_streaming,
+};
+
+// AVX-512, which handles the remainder with masked loads and stores instead of a scalar loop.
+ST_TARGET_AVX512 static void avx512_multiply(float* out, const float* a, const float* b, std::size_t count)
+{
+	for (std::size_t idx = 0; idx < count; idx += 16) {
+		__mmask16 m = (count - idx >= 16) ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << (count - idx)) - 1);
+		_mm512_mask_storeu_ps(out + idx, m, _mm512_mul_ps(_mm512_maskz_loadu_ps(m, a + idx), _mm512_maskz_loadu_ps(m, b + idx)));
+	}
+}
+
+ST_TARGET_AVX512 static void avx512_mix(float* out, const float* in, float gain, std::size_t count)
+{
+	__m512 vgain = _mm512_set1_ps(gain);
+	for (std::size_t idx = 0; idx < count; idx += 16) {
+		__mmask16 m = (count - idx >= 16) ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << (count - idx)) - 1);
+		_mm512_mask_storeu_ps(out + idx, m, _mm512_add_ps(_mm512_maskz_loadu_ps(m, out + idx), _mm512_mul_ps(_mm512_maskz_loadu_ps(m, in + idx), vgain)));
+	}
+}
+
+ST_TARGET_AVX512 static void avx512_magnitude(float* out, const float* re, const float* im, float scale, std::size_t count)
+{
+	__m512 vscale = _mm512_set1_ps(scale);
+	for (std::size_t idx = 0; idx < count; idx += 16) {
+		__mmask16 m = (count - idx >= 16) ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << (count - idx)) - 1);
+		__m512    r = _mm512_maskz_loadu_ps(m, re + idx);
+		__m512    i = _mm512_maskz_loadu_ps(m, im + idx);
+		_mm512_mask_storeu_ps(out + idx, m, _mm512_mul_ps(_mm512_sqrt_ps(_mm512_add_ps(_mm512_mul_ps(r, r), _mm512_mul_ps(i, i))), vscale));
+	}
+}
+
+ST_TARGET_AVX512 static void avx512_luma_rgba8(uint8_t* out, const uint8_t* rgba, std::size_t count)
+{
+	const __m512i mask = _mm512_set1_epi32(0xFF);
+	const __m512i wr   = _mm512_set1_epi32(54);
+	const __m512i wg   = _mm512_set1_epi32(183);
+	const __m512i wb   = _mm512_set1_epi32(19);
+
+	for (std::size_t idx = 0; idx < count; idx += 16) {
+		__mmask16 m  = (count - idx >= 16) ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << (count - idx)) - 1);
+		__m512i   px = _mm512_maskz_loadu_epi32(m, rgba + idx * 4);
+		__m512i   r  = _mm512_and_si512(px, mask);
+		__m512i   g  = _mm512_and_si512(_mm512_srli_epi32(px, 8), mask);
+		__m512i   b  = _mm512_and_si512(_mm512_srli_epi32(px, 16), mask);
+		__m512i   l  = _mm512_srli_epi32(_mm512_add_epi32(_mm512_add_epi32(_mm512_mullo_epi16(r, wr), _mm512_mullo_epi16(g, wg)), _mm512_mullo_epi16(b, wb)), 8);
+		_mm512_mask_cvtepi32_storeu_epi8(out + idx, m, l);
+	}
+}
+
+ST_TARGET_AVX512 static void avx512_copy_streaming(uint8_t* to, const uint8_t* from, std::size_t bytes)
+{
+	constexpr std::size_t block = sizeof(__m512i);
+
+	std::size_t head = (block - (reinterpret_cast<uintptr_t>(to) % block)) % block;
+	if (head > bytes) {
+		head = bytes;
+	}
+	std::memcpy(to, from, head);
+	to += head;
+	from += head;
+	bytes -= head;
+
+	std::size_t body = bytes - (bytes % block);
+	for (std::size_t pos = 0; pos < body; pos += block) {
+		_mm512_stream_si512(reinterpret_cast<__m512i*>(to + pos), _mm512_loadu_si512(from + pos));
+	}
+	std::memcpy(to + body, from + body, bytes - body);
+}
+
+static constexpr streamfx::util::simd::kernels kernels_avx512 = {
+	streamfx::util::simd::level::AVX512, avx512_multiply, avx512_mix, avx512_magnitude, avx512_luma_rgba8, avx512_copy_streaming,
+};
+
+static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t (&regs)[4])
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+	for (std::size_t idx = 0; idx < 4; idx++) {
+		regs[idx] = static_cast<uint32_t>(info[idx]);
+	}
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static uint64_t xgetbv()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	uint32_t lo, hi;
+	__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+}
+#elif defined(D_PLATFORM_INSTR_ARM) && defined(__ARM_NEON) && defined(__aarch64__)
+// NEON
+static void neon_multiply(float* out, const float* a, const float* b, std::size_t count)
+{
+	std::size_t idx = 0;
+	for (; (idx + 4) <= count; idx += 4) {
+		vst1q_f32(out + idx, vmulq_f32(vld1q_f32(a + idx), vld1q_f32(b + idx)));
+	}
+	scalar_multiply(out + idx, a + idx, b + idx, count - idx);
+}
+
+static void neon_mix(float* out, const float* in, float gain, std::size_t count)
+{
+	float32x4_t vgain = vdupq_n_f32(gain);
+	std::size_t idx   = 0;
+	for (; (idx + 4) <= count; idx += 4) {
+		vst1q_f32(out + idx, vaddq_f32(vld1q_f32(out + idx), vmulq_f32(vld1q_f32(in + idx), vgain)));
+	}
+	scalar_mix(out + idx, in + idx, gain, count - idx);
+}
+
+static void neon_magnitude(float* out, const float* re, const float* im, float scale, std::size_t count)
+{
+	float32x4_t vscale = vdupq_n_f32(scale);
+	std::size_t idx    = 0;
+	for (; (idx + 4) <= count; idx += 4) {
+		float32x4_t r = vld1q_f32(re + idx);
+		float32x4_t i = vld1q_f32(im + idx);
+		vst1q_f32(out + idx, vmulq_f32(vsqrtq_f32(vaddq_f32(vmulq_f32(r, r), vmulq_f32(i, i))), vscale));
+	}
+	scalar_magnitude(out + idx, re + idx, im + idx, scale, count - idx);
+}
+
+static void neon_luma_rgba8(uint8_t* out, const uint8_t* rgba, std::size_t count)
+{
+	std::size_t idx = 0;
+	for (; (idx + 8) <= count; idx += 8) {
+		// Loading deinterleaves the channels for free.
+		uint8x8x4_t px = vld4_u8(rgba + idx * 4);
+		uint16x8_t  l  = vmull_u8(px.val[0], vdup_n_u8(54));
+		l              = vmlal_u8(l, px.val[1], vdup_n_u8(183));
+		l              = vmlal_u8(l, px.val[2], vdup_n_u8(19));
+		vst1_u8(out + idx, vshrn_n_u16(l, 8));
+	}
+	scalar_luma_rgba8(out + idx, rgba + idx * 4, count - idx);
+}
+
+static void neon_copy_streaming(uint8_t* to, const uint8_t* from, std::size_t bytes)
+{
+	// NEON has no non-temporal store intrinsics, but wide loads and stores still beat most memcpy implementations here.
+	constexpr std::size_t block = sizeof(uint8x16_t) * 4;
+
+	std::size_t body = bytes - (bytes % block);
+	for (std::size_t pos = 0; pos < body; pos += block) {
+		uint8x16_t v0 = vld1q_u8(from + pos);
+		uint8x16_t v1 = vld1q_u8(from + pos + 16);
+		uint8x16_t v2 = vld1q_u8(from + pos + 32);
+		uint8x16_t v3 = vld1q_u8(from + pos + 48);
+		vst1q_u8(to + pos, v0);
+		vst1q_u8(to + pos + 16, v1);
+		vst1q_u8(to + pos + 32, v2);
+		vst1q_u8(to + pos + 48, v3);
+	}
+	std::memcpy(to + body, from + body, bytes - body);
+}
+
+static constexpr streamfx::util::simd::kernels kernels_neon = {
+	streamfx::util::simd::level::NEON, neon_multiply, neon_mix, neon_magnitude, neon_luma_rgba8, neon_copy_streaming,
+};
+#endif
+
+streamfx::util::simd::level streamfx::util::simd::detect()
+{
+#if defined(D_PLATFORM_INSTR_X86)
+	uint32_t regs[4] = {};
+	cpuid(0, 0, regs);
+	uint32_t max_leaf = regs[0];
+
+	cpuid(1, 0, regs);
+	bool osxsave = (regs[2] & (1u << 27)) != 0;
+	bool avx     = (regs[2] & (1u << 28)) != 0;
+	if (!osxsave || !avx || (max_leaf < 7)) {
+		return level::SSE2;
+	}
+
+	// The processor supporting it is not enough, the operating system also has to save the registers.
+	uint64_t xcr0 = xgetbv();
+	if ((xcr0 & 0x06) != 0x06) {
+		return level::SSE2;
+	}
+
+	cpuid(7, 0, regs);
+	bool avx2     = (regs[1] & (1u << 5)) != 0;
+	bool avx512f  = (regs[1] & (1u << 16)) != 0;
+	bool avx512bw = (regs[1] & (1u << 30)) != 0;
+	if (avx512f && avx512bw && ((xcr0 & 0xE6) == 0xE6)) {
+		return level::AVX512;
+	}
+	return avx2 ? level::AVX2 : level::SSE2;
+#elif defined(D_PLATFORM_INSTR_ARM) && defined(__ARM_NEON) && defined(__aarch64__)
+	return level::NEON;
+#else
+	return level::SCALAR;
+#endif
+}
+
+const streamfx::util::simd::kernels* streamfx::util::simd::find(level isa)
+{
+	if (isa == level::SCALAR) {
+		return &kernels_scalar;
+	}
+	if (isa > detect()) {
+		return nullptr;
+	}
+
+	switch (isa) {
+#if defined(D_PLATFORM_INSTR_X86)
+	case level::SSE2:
+		return &kernels_sse2;
+	case level::AVX2:
+		return &kernels_avx2;
+	case level::AVX512:
+		return &kernels_avx512;
+#elif defined(D_PLATFORM_INSTR_ARM) && defined(__ARM_NEON) && defined(__aarch64__)
+	case level::NEON:
+		return &kernels_neon;
+#endif
+	default:
+		return nullptr;
+	}
+}
+
+const streamfx::util::simd::kernels& streamfx::util::simd::reference()
+{
+	return kernels_scalar;
+}
+
+const streamfx::util::simd::kernels& streamfx::util::simd::get()
+{
+	static const kernels* instance = find(detect());
+	return *instance;
+}
+
+const char* streamfx::util::simd::name(level isa)
+{
+	switch (isa) {
+	case level::SCALAR:
+		return "Scalar";
+	case level::SSE2:
+		return "SSE2";
+	case level::AVX2:
+		return "AVX2";
+	case level::AVX512:
+		return "AVX-512";
+	case level::NEON:
+		return "NEON";
+	}
+	return "Unknown";
+}
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		// Resolve now, so that the first frame doesn't have to.
+		D_LOG_INFO("Using %s kernels.", streamfx::util::simd::name(streamfx::util::simd::get().isa));
+	},
+	[]() { // Finalizer
+	},
+	streamfx::loader_priority::HIGHEST);
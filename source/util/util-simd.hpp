@@ -0,0 +1,62 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "warning-disable.hpp"
+#include <cinttypes>
+#include <cstddef>
+#include "warning-enable.hpp"
+
+namespace streamfx::util::simd {
+	/** Instruction sets that kernels are written for, from least to most capable. */
+	enum class level : uint8_t {
+		SCALAR,
+		SSE2,   // Every x86-64 processor.
+		AVX2,   // Haswell, Zen and newer.
+		AVX512, // AVX-512 F and BW, such as Skylake-X and Zen 4.
+		NEON,   // Every AArch64 processor, such as Apple Silicon.
+	};
+
+	/** Kernels for one instruction set.
+	 *
+	 * Integer kernels give exactly the same result as their scalar reference. Floating point kernels do the same
+	 * operations in the same order, but may differ in the last bit where the compiler fuses a multiply and an add.
+	 * Unaligned pointers are fine, and counts don't need to be a multiple of anything.
+	 */
+	struct kernels {
+		level isa;
+
+		/** out[i] = a[i] * b[i], such as applying a window function. out may be a or b. */
+		void (*multiply)(float* out, const float* a, const float* b, std::size_t count);
+
+		/** out[i] += in[i] * gain, such as mixing one channel into another. */
+		void (*mix)(float* out, const float* in, float gain, std::size_t count);
+
+		/** out[i] = sqrt(re[i] * re[i] + im[i] * im[i]) * scale. out may be re or im. */
+		void (*magnitude)(float* out, const float* re, const float* im, float scale, std::size_t count);
+
+		/** BT.709 luma of 8-bit RGBA pixels, computed as (r * 54 + g * 183 + b * 19) >> 8. */
+		void (*luma_rgba8)(uint8_t* out, const uint8_t* rgba, std::size_t count);
+
+		/** Copy bytes with non-temporal stores where possible, so that the copy does not evict the cache.
+		 *
+		 * On x86 the caller has to issue a store fence before anyone else may read the data.
+		 */
+		void (*copy_streaming)(uint8_t* to, const uint8_t* from, std::size_t bytes);
+	};
+
+	/** Most capable instruction set supported by both this build and the processor. */
+	level detect();
+
+	/** Kernels for the given instruction set, or nullptr if it can't be used here. */
+	const kernels* find(level isa);
+
+	/** Scalar reference kernels, which everything else is verified against. */
+	const kernels& reference();
+
+	/** Kernels for the best instruction set, resolved once on first use. */
+	const kernels& get();
+
+	const char* name(level isa);
+} // namespace streamfx::util::simd
@@ -0,0 +1,96 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "warning-disable.hpp"
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::util {
+	/** Bounded, lock-free queue for exactly one producer and exactly one consumer thread.
+	 *
+	 * The producer may only call try_push, the consumer may only call try_pop. All other
+	 * functions may be called from either thread, but only return a snapshot of the state.
+	 */
+	template<typename T>
+	class spsc_queue {
+		std::vector<T> _data;
+
+#if __cpp_lib_hardware_interference_size >= 201603
+		alignas(std::hardware_destructive_interference_size)
+#endif
+			std::atomic<std::size_t> _head; // Next element to read.
+#if __cpp_lib_hardware_interference_size >= 201603
+		alignas(std::hardware_destructive_interference_size)
+#endif
+			std::atomic<std::size_t> _tail; // Next element to write.
+
+		public:
+		spsc_queue(std::size_t capacity) : _data(capacity + 1), _head(0), _tail(0) {}
+		~spsc_queue() = default;
+
+		spsc_queue(const spsc_queue<T>&)                   = delete;
+		spsc_queue<T>& operator=(const spsc_queue<T>&)     = delete;
+		spsc_queue(spsc_queue<T>&&) noexcept               = delete;
+		spsc_queue<T>& operator=(spsc_queue<T>&&) noexcept = delete;
+
+		/** Try to append an element to the queue.
+		 * @return true if the element was added, false if the queue was full.
+		 */
+		bool try_push(T value)
+		{
+			std::size_t tail = _tail.load(std::memory_order_relaxed);
+			std::size_t next = (tail + 1) % _data.size();
+			if (next == _head.load(std::memory_order_acquire)) {
+				return false;
+			}
+
+			_data[tail] = std::move(value);
+			_tail.store(next, std::memory_order_release);
+			return true;
+		}
+
+		/** Try to remove the oldest element from the queue.
+		 * @return true if an element was removed, false if the queue was empty.
+		 */
+		bool try_pop(T& value)
+		{
+			std::size_t head = _head.load(std::memory_order_relaxed);
+			if (head == _tail.load(std::memory_order_acquire)) {
+				return false;
+			}
+
+			value       = std::move(_data[head]);
+			_data[head] = T{};
+			_head.store((head + 1) % _data.size(), std::memory_order_release);
+			return true;
+		}
+
+		std::size_t size() const
+		{
+			std::size_t head = _head.load(std::memory_order_acquire);
+			std::size_t tail = _tail.load(std::memory_order_acquire);
+			return (tail + _data.size() - head) % _data.size();
+		}
+
+		std::size_t capacity() const
+		{
+			return _data.size() - 1;
+		}
+
+		bool empty() const
+		{
+			return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+		}
+
+		bool full() const
+		{
+			return size() >= capacity();
+		}
+	};
+} // namespace streamfx::util
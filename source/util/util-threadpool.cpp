@@ -6,10 +6,13 @@
 
 #include "util-threadpool.hpp"
 #include "common.hpp"
+#include "configuration.hpp"
 #include "plugin.hpp"
+#include "obs/obs-tools.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
 #include <cstddef>
 #include "warning-enable.hpp"
 
@@ -35,7 +38,22 @@
 #define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
 #endif
 
-streamfx::util::threadpool::task::task(task_callback_t callback, task_data_t data) : _callback(callback), _data(data), _lock(), _status_changed(), _cancelled(false), _completed(false), _failed(false) {}
+#define ST_CFG_THREADPOOL "Threadpool"
+#define ST_CFG_THREADPOOL_REALTIME "RealtimeOnPerformanceCores"
+#define ST_CFG_THREADPOOL_BACKGROUND "BackgroundOnEfficiencyCores"
+#define ST_CFG_THREADPOOL_LOCAL "FrameOnLocalNode"
+
+// Worker affinities, anything above affinity_local is a NUMA node.
+constexpr uint32_t affinity_any         = 0;
+constexpr uint32_t affinity_performance = 1;
+constexpr uint32_t affinity_efficiency  = 2;
+constexpr uint32_t affinity_local       = 3;
+
+// Tasks pushed from a worker go to that worker's own queue.
+thread_local streamfx::util::threadpool::threadpool*  current_pool   = nullptr;
+thread_local streamfx::util::threadpool::worker_info* current_worker = nullptr;
+
+streamfx::util::threadpool::task::task(task_callback_t callback, task_data_t data, priority prio, uint32_t node) : _callback(callback), _data(data), _priority(prio), _node(node), _lock(), _status_changed(), _cancelled(false), _completed(false), _failed(false) {}
 
 streamfx::util::threadpool::task::~task() {}
 
@@ -65,6 +83,16 @@ void streamfx::util::threadpool::task::cancel()
 	_status_changed.notify_all();
 }
 
+streamfx::util::threadpool::priority streamfx::util::threadpool::task::get_priority()
+{
+	return _priority;
+}
+
+uint32_t streamfx::util::threadpool::task::get_node()
+{
+	return _node;
+}
+
 bool streamfx::util::threadpool::task::is_cancelled()
 {
 	return _cancelled;
@@ -97,10 +125,24 @@ streamfx::util::threadpool::threadpool::~threadpool()
 {
 	{ // Terminate all remaining tasks.
 		std::lock_guard<std::mutex> lg(_tasks_lock);
-		for (auto task : _tasks) {
-			task->cancel();
+		for (auto& queue : _tasks) {
+			for (auto task : queue) {
+				task->cancel();
+			}
+			queue.clear();
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lg(_workers_lock);
+		for (auto worker : _workers) {
+			std::lock_guard<std::mutex> qlg(worker->queue_lock);
+			for (auto& queue : worker->queue) {
+				for (auto task : queue) {
+					task->cancel();
+				}
+				queue.clear();
+			}
 		}
-		_tasks.clear();
 	}
 
 	{ // Notify workers to stop working.
@@ -120,37 +162,223 @@ streamfx::util::threadpool::threadpool::~threadpool()
 	}
 }
 
-streamfx::util::threadpool::threadpool::threadpool(size_t minimum, size_t maximum) : _limits{minimum, maximum}, _workers_lock(), _worker_count(0), _workers(), _tasks_lock(), _tasks_cv(), _tasks()
+streamfx::util::threadpool::threadpool::threadpool(size_t minimum, size_t maximum) : _limits{minimum, maximum}, _workers_lock(), _worker_count(0), _workers(), _tasks_lock(), _tasks_cv(), _tasks(), _pending(0), _pending_background(0), _running(0), _running_background(0), _topology(streamfx::util::topology::get()), _affinity_realtime(false), _affinity_background(false), _affinity_local(false)
 {
 	// Spawn the minimum number of threads.
 	spawn(_limits.first);
 }
 
-std::shared_ptr<streamfx::util::threadpool::task> streamfx::util::threadpool::threadpool::push(task_callback_t callback, task_data_t data /*= nullptr*/)
+std::shared_ptr<streamfx::util::threadpool::task> streamfx::util::threadpool::threadpool::push(task_callback_t callback, task_data_t data /*= nullptr*/, priority prio /*= priority::FRAME*/)
 {
-	std::lock_guard<std::mutex> lg(_tasks_lock);
-	constexpr size_t            threshold = 3;
+	uint32_t node = ((prio == priority::FRAME) && _affinity_local) ? _topology->current_node() : streamfx::util::topology::unknown_node;
+	auto     task = std::make_shared<streamfx::util::threadpool::task>(callback, data, prio, node);
+	enqueue({task}, prio);
 
-	// Enqueue the new task.
-	auto task = std::make_shared<streamfx::util::threadpool::task>(callback, data);
-	_tasks.emplace_back(task);
+	// Return handle to caller.
+	return task;
+}
+
+std::vector<std::shared_ptr<streamfx::util::threadpool::task>> streamfx::util::threadpool::threadpool::push_bulk(const std::vector<task_callback_t>& callbacks, priority prio /*= priority::FRAME*/)
+{
+	std::vector<std::shared_ptr<streamfx::util::threadpool::task>> tasks;
+	uint32_t                                                       node = ((prio == priority::FRAME) && _affinity_local) ? _topology->current_node() : streamfx::util::topology::unknown_node;
+	tasks.reserve(callbacks.size());
+	for (auto& callback : callbacks) {
+		tasks.push_back(std::make_shared<streamfx::util::threadpool::task>(callback, nullptr, prio, node));
+	}
+	if (!tasks.empty()) {
+		enqueue(tasks, prio);
+	}
+	return tasks;
+}
+
+void streamfx::util::threadpool::threadpool::enqueue(const std::vector<std::shared_ptr<task>>& tasks, priority prio)
+{
+	constexpr size_t threshold = 3;
+	std::size_t      level     = static_cast<std::size_t>(prio);
+
+	// Count before queueing, so that a worker taking one of them right away never sees fewer than zero.
+	_pending += tasks.size();
+	if (prio == priority::BACKGROUND) {
+		_pending_background += tasks.size();
+	}
+
+	if (current_pool == this) {
+		std::lock_guard<std::mutex> lg(current_worker->queue_lock);
+		current_worker->queue[level].insert(current_worker->queue[level].end(), tasks.begin(), tasks.end());
+	}
+
+	std::lock_guard<std::mutex> lg(_tasks_lock);
+	if (current_pool != this) {
+		_tasks[level].insert(_tasks[level].end(), tasks.begin(), tasks.end());
+	}
 
 	// Spawn additional workers if the number of queued tasks exceeds a threshold.
-	if (_tasks.size() > (threshold * _worker_count)) {
-		spawn(_tasks.size() / threshold);
+	if (size_t pending = _pending; pending > (threshold * _worker_count)) {
+		spawn(pending / threshold);
+	} else if ((prio != priority::BACKGROUND) && (_running >= _worker_count)) {
+		// Running tasks can't be interrupted, so urgent work that would have to wait for one gets a new worker.
+		spawn(1);
 	}
 
-	// Return handle to caller.
+	if (tasks.size() > 1) {
+		_tasks_cv.notify_all();
+	} else {
+		_tasks_cv.notify_one();
+	}
+}
+
+bool streamfx::util::threadpool::threadpool::background_allowed()
+{
+	// Background work never takes the last worker, unless it is the only background work running.
+	return (_running_background == 0) || ((_running_background + 1) < _worker_count);
+}
+
+bool streamfx::util::threadpool::threadpool::runnable()
+{
+	return (_pending > _pending_background) || ((_pending_background > 0) && background_allowed());
+}
+
+std::shared_ptr<streamfx::util::threadpool::task> streamfx::util::threadpool::threadpool::take(std::shared_ptr<worker_info> wi)
+{
+	std::shared_ptr<streamfx::util::threadpool::task> task;
+	std::size_t                                       levels = background_allowed() ? priorities : (priorities - 1);
+
+	// Realtime work before frame work before background work, no matter where it is queued.
+	for (std::size_t level = 0; (level < levels) && !task; level++) {
+		{ // Newest work of our own first, its data is the most likely to still be in cache.
+			std::lock_guard<std::mutex> lg(wi->queue_lock);
+			if (!wi->queue[level].empty()) {
+				task = std::move(wi->queue[level].back());
+				wi->queue[level].pop_back();
+			}
+		}
+
+		if (!task) { // Then work from outside of the pool.
+			std::lock_guard<std::mutex> lg(_tasks_lock);
+			if (!_tasks[level].empty()) {
+				task = std::move(_tasks[level].front());
+				_tasks[level].pop_front();
+			}
+		}
+
+		if (!task) { // And finally the oldest work of any other worker, skipping those that are busy with their queue.
+			std::lock_guard<std::mutex> lg(_workers_lock);
+			for (auto& victim : _workers) {
+				if ((victim == wi) || !victim->queue_lock.try_lock()) {
+					continue;
+				}
+				std::lock_guard<std::mutex> qlg(victim->queue_lock, std::adopt_lock);
+				if (!victim->queue[level].empty()) {
+					task = std::move(victim->queue[level].front());
+					victim->queue[level].pop_front();
+					break;
+				}
+			}
+		}
+	}
+
+	if (task) {
+		--_pending;
+		if (task->get_priority() == priority::BACKGROUND) {
+			--_pending_background;
+		}
+	}
 	return task;
 }
 
 void streamfx::util::threadpool::threadpool::pop(std::shared_ptr<task> task)
 {
-	if (task) {
-		task->cancel();
+	if (!task) {
+		return;
 	}
-	std::lock_guard<std::mutex> lg(_tasks_lock);
-	_tasks.remove(task);
+	task->cancel();
+
+	// Cancelled tasks are skipped when taken anyway, removing them just frees them earlier.
+	unqueue(task);
+}
+
+void streamfx::util::threadpool::threadpool::join(const std::vector<std::shared_ptr<task>>& tasks)
+{
+	// The newest tasks are the ones least likely to have been taken by a worker already.
+	for (auto itr = tasks.rbegin(); itr != tasks.rend(); itr++) {
+		if (*itr && unqueue(*itr)) {
+			(*itr)->run();
+		}
+	}
+	for (auto& task : tasks) {
+		if (task) {
+			task->wait();
+		}
+	}
+}
+
+void streamfx::util::threadpool::threadpool::parallel_for(std::size_t begin, std::size_t end, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& fn, priority prio /*= priority::FRAME*/)
+{
+	if (begin >= end) {
+		return;
+	}
+	grain = std::max<std::size_t>(grain, 1);
+
+	std::mutex         lock;
+	std::exception_ptr exception;
+	auto               range = [&fn, &lock, &exception](std::size_t first, std::size_t last) {
+		try {
+			fn(first, last);
+		} catch (...) {
+			std::lock_guard<std::mutex> lg(lock);
+			if (!exception) {
+				exception = std::current_exception();
+			}
+		}
+	};
+
+	// Everything but the first range goes to the pool.
+	std::vector<task_callback_t> callbacks;
+	callbacks.reserve((end - begin - 1) / grain);
+	for (std::size_t first = begin + grain; first < end; first += grain) {
+		std::size_t last = std::min<std::size_t>(first + grain, end);
+		callbacks.push_back([&range, first, last](task_data_t) { range(first, last); });
+	}
+	auto tasks = callbacks.empty() ? std::vector<std::shared_ptr<task>>() : push_bulk(callbacks, prio);
+
+	range(begin, std::min<std::size_t>(begin + grain, end));
+	join(tasks);
+
+	if (exception) {
+		std::rethrow_exception(exception);
+	}
+}
+
+bool streamfx::util::threadpool::threadpool::unqueue(std::shared_ptr<task> task)
+{
+	std::size_t level   = static_cast<std::size_t>(task->get_priority());
+	auto        removed = [this](priority prio) {
+		--_pending;
+		if (prio == priority::BACKGROUND) {
+			--_pending_background;
+		}
+	};
+	{
+		std::lock_guard<std::mutex> lg(_tasks_lock);
+		if (auto found = std::find(_tasks[level].begin(), _tasks[level].end(), task); found != _tasks[level].end()) {
+			_tasks[level].erase(found);
+			removed(task->get_priority());
+			return true;
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lg(_workers_lock);
+		for (auto& worker : _workers) {
+			std::lock_guard<std::mutex> qlg(worker->queue_lock);
+			if (auto found = std::find(worker->queue[level].begin(), worker->queue[level].end(), task); found != worker->queue[level].end()) {
+				worker->queue[level].erase(found);
+				removed(task->get_priority());
+				return true;
+			}
+		}
+	}
+	return false;
 }
 
 void streamfx::util::threadpool::threadpool::spawn(size_t count)
@@ -180,6 +408,15 @@ bool streamfx::util::threadpool::threadpool::die(std::shared_ptr<worker_info> wi
 		result   = ((wi->last_work_time + delay) <= now) && ((_last_worker_death + delay) <= now);
 
 		if (result) {
+			// Anything still queued by this worker goes back to everyone.
+			{
+				std::lock_guard<std::mutex> qlg(wi->queue_lock);
+				for (std::size_t level = 0; level < priorities; level++) {
+					_tasks[level].insert(_tasks[level].end(), wi->queue[level].begin(), wi->queue[level].end());
+					wi->queue[level].clear();
+				}
+			}
+
 			_last_worker_death = now;
 			--_worker_count;
 			_workers.remove(wi);
@@ -205,14 +442,46 @@ void streamfx::util::threadpool::threadpool::work(std::shared_ptr<worker_info> w
 	pthread_setname_np(pthread_self(), "StreamFX Worker Thread");
 #endif
 
+	current_pool   = this;
+	current_worker = wi.get();
+
 	while (!wi->stop) {
-		{ // Try and acquire new work.
+		// If there is work to be done anywhere, take it.
+		if (task = take(wi); task) {
+			// Move to the cores the task belongs on, which only costs a system call if that changed.
+			if (uint32_t affinity = affinity_for(task); affinity != wi->affinity) {
+				apply_affinity(affinity);
+				wi->affinity = affinity;
+			}
+
+			bool background    = (task->get_priority() == priority::BACKGROUND);
+			wi->last_work_time = std::chrono::high_resolution_clock::now();
+			++_running;
+			if (background) {
+				++_running_background;
+			}
+
+			task->run();
+			task.reset();
+
+			--_running;
+			if (background) {
+				--_running_background;
+
+				// Background work that was held back may be able to run now.
+				std::lock_guard<std::mutex> tlg(_tasks_lock);
+				_tasks_cv.notify_one();
+			}
+			continue;
+		}
+
+		{
 			std::unique_lock<std::mutex> ul(_tasks_lock);
 
 			// Is there any work available right now?
-			if (_tasks.size() == 0) { // If not:
+			if (!runnable()) { // If not:
 				// Block this thread until it is notified of a change.
-				_tasks_cv.wait_until(ul, std::chrono::time_point(std::chrono::high_resolution_clock::now() + std::chrono::milliseconds(250)), [this, wi]() { return wi->stop || _tasks.size() > 0; });
+				_tasks_cv.wait_until(ul, std::chrono::time_point(std::chrono::high_resolution_clock::now() + std::chrono::milliseconds(250)), [this, wi]() { return wi->stop || runnable(); });
 			}
 
 			// If we were asked to stop, skip everything.
@@ -220,20 +489,65 @@ void streamfx::util::threadpool::threadpool::work(std::shared_ptr<worker_info> w
 				continue;
 			}
 
-			// If there is work to be done, take it.
-			if (_tasks.size() > 0) {
-				wi->last_work_time = std::chrono::high_resolution_clock::now();
-				task               = _tasks.front();
-				_tasks.pop_front();
-			} else if (die(wi)) { // Is the threadpool requesting less threads?
+			// Is the threadpool requesting less threads?
+			if ((_pending == 0) && die(wi)) {
 				break;
 			}
 		}
+	}
 
-		if (task) {
-			task->run();
-			task.reset();
+	current_pool   = nullptr;
+	current_worker = nullptr;
+}
+
+void streamfx::util::threadpool::threadpool::configure()
+{
+	auto                        config = streamfx::configuration::instance();
+	auto                        data   = config->get();
+	std::shared_ptr<obs_data_t> cfg(obs_data_get_obj(data.get(), ST_CFG_THREADPOOL), streamfx::obs::obs_data_deleter);
+	if (!cfg) {
+		return;
+	}
+	obs_data_set_default_bool(cfg.get(), ST_CFG_THREADPOOL_REALTIME, false);
+	obs_data_set_default_bool(cfg.get(), ST_CFG_THREADPOOL_BACKGROUND, false);
+	obs_data_set_default_bool(cfg.get(), ST_CFG_THREADPOOL_LOCAL, false);
+
+	// Policies that can't do anything on this system stay off, so that workers never change affinity for nothing.
+	_affinity_realtime   = obs_data_get_bool(cfg.get(), ST_CFG_THREADPOOL_REALTIME) && _topology->is_hybrid();
+	_affinity_background = obs_data_get_bool(cfg.get(), ST_CFG_THREADPOOL_BACKGROUND) && _topology->is_hybrid();
+	_affinity_local      = obs_data_get_bool(cfg.get(), ST_CFG_THREADPOOL_LOCAL) && (_topology->nodes() > 1);
+	D_LOG_INFO("Realtime work on performance cores: %s, background work on efficiency cores: %s, frame work on the local NUMA node: %s.", _affinity_realtime ? "Enabled" : "Disabled", _affinity_background ? "Enabled" : "Disabled", _affinity_local ? "Enabled" : "Disabled");
+}
+
+uint32_t streamfx::util::threadpool::threadpool::affinity_for(const std::shared_ptr<task>& task)
+{
+	switch (task->get_priority()) {
+	case priority::REALTIME:
+		return _affinity_realtime ? affinity_performance : affinity_any;
+	case priority::BACKGROUND:
+		return _affinity_background ? affinity_efficiency : affinity_any;
+	default:
+		if (_affinity_local && (task->get_node() != streamfx::util::topology::unknown_node)) {
+			return affinity_local + task->get_node();
 		}
+		return affinity_any;
+	}
+}
+
+void streamfx::util::threadpool::threadpool::apply_affinity(uint32_t affinity)
+{
+	std::vector<streamfx::util::topology::processor> processors;
+	if (affinity == affinity_performance) {
+		processors = _topology->select(true, false);
+	} else if (affinity == affinity_efficiency) {
+		processors = _topology->select(false, true);
+	} else if (affinity >= affinity_local) {
+		processors = _topology->select(true, true, affinity - affinity_local);
+	}
+
+	// An empty selection allows every processor again.
+	if (!_topology->set_thread_affinity(processors)) {
+		D_LOG_DEBUG("Failed to change the affinity of a worker thread.", nullptr);
 	}
 }
 
@@ -251,6 +565,265 @@ std::shared_ptr<streamfx::util::threadpool::threadpool> streamfx::util::threadpo
 	return instance;
 };
 
+streamfx::util::threadpool::graph::~graph()
+{
+	try {
+		wait();
+	} catch (...) {
+		// Nobody is left to handle it.
+	}
+}
+
+streamfx::util::threadpool::graph::graph(priority prio /*= priority::FRAME*/, std::shared_ptr<threadpool> pool /*= threadpool::instance()*/) : _pool(pool), _priority(prio), _lock(), _nodes(), _exception(), _running(false) {}
+
+size_t streamfx::util::threadpool::graph::add(std::function<void()> callback, std::initializer_list<size_t> dependencies /*= {}*/)
+{
+	std::lock_guard<std::mutex> lg(_lock);
+	if (_running) {
+		throw std::runtime_error("Can't add to a running graph.");
+	}
+
+	size_t id = _nodes.size();
+	for (auto dependency : dependencies) {
+		if (dependency >= id) {
+			throw std::invalid_argument("Dependencies must be added before the nodes that depend on them.");
+		}
+	}
+
+	auto entry          = std::make_unique<node>();
+	entry->callback     = std::move(callback);
+	entry->dependencies = dependencies.size();
+	entry->remaining    = 0;
+	for (auto dependency : dependencies) {
+		_nodes[dependency]->successors.push_back(id);
+	}
+	_nodes.push_back(std::move(entry));
+	return id;
+}
+
+void streamfx::util::threadpool::graph::run()
+{
+	std::vector<size_t> roots;
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		if (_running) {
+			throw std::runtime_error("Graph is already running.");
+		}
+		_running   = true;
+		_exception = nullptr;
+
+		for (size_t id = 0; id < _nodes.size(); id++) {
+			_nodes[id]->remaining = _nodes[id]->dependencies;
+			_nodes[id]->handle.reset();
+			if (_nodes[id]->dependencies == 0) {
+				roots.push_back(id);
+			}
+		}
+	}
+	enqueue(roots);
+}
+
+void streamfx::util::threadpool::graph::wait()
+{
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		if (!_running) {
+			return;
+		}
+	}
+
+	// Nodes come after their dependencies, so each one has been queued by the time we get to it.
+	for (size_t id = 0; id < _nodes.size(); id++) {
+		std::shared_ptr<task> task;
+		{
+			std::lock_guard<std::mutex> lg(_lock);
+			task = _nodes[id]->handle;
+		}
+		_pool->join({task});
+	}
+
+	std::exception_ptr exception;
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		_running  = false;
+		exception = _exception;
+	}
+	if (exception) {
+		std::rethrow_exception(exception);
+	}
+}
+
+void streamfx::util::threadpool::graph::execute(size_t id)
+{
+	node* entry = _nodes[id].get();
+
+	bool skip;
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		skip = static_cast<bool>(_exception);
+	}
+	if (!skip) {
+		try {
+			entry->callback();
+		} catch (...) {
+			std::lock_guard<std::mutex> lg(_lock);
+			if (!_exception) {
+				_exception = std::current_exception();
+			}
+		}
+	}
+
+	// Queue everything that was only waiting on us, before our own task counts as completed.
+	std::vector<size_t> ready;
+	for (auto successor : entry->successors) {
+		if (--_nodes[successor]->remaining == 0) {
+			ready.push_back(successor);
+		}
+	}
+	enqueue(ready);
+}
+
+void streamfx::util::threadpool::graph::enqueue(const std::vector<size_t>& ids)
+{
+	if (ids.empty()) {
+		return;
+	}
+
+	std::vector<task_callback_t> callbacks;
+	callbacks.reserve(ids.size());
+	for (auto id : ids) {
+		callbacks.push_back([this, id](task_data_t) { execute(id); });
+	}
+
+	// A node may already be done before its task is stored, wait() simply finds it completed then.
+	std::lock_guard<std::mutex> lg(_lock);
+	auto                        tasks = _pool->push_bulk(callbacks, _priority);
+	for (size_t idx = 0; idx < ids.size(); idx++) {
+		_nodes[ids[idx]]->handle = tasks[idx];
+	}
+}
+
+streamfx::util::threadpool::chain::~chain() {}
+
+streamfx::util::threadpool::chain::chain(std::shared_ptr<threadpool> pool /*= threadpool::instance()*/) : _pool(pool), _lock(), _status_changed(), _steps(), _exception(), _started(false), _running(false), _cancelled(false), _finished(false) {}
+
+streamfx::util::threadpool::chain& streamfx::util::threadpool::chain::then(executor where, std::function<void()> callback)
+{
+	std::lock_guard<std::mutex> lg(_lock);
+	if (_started) {
+		throw std::runtime_error("Can't add to a started chain.");
+	}
+
+	_steps.push_back({where, std::move(callback)});
+	return *this;
+}
+
+void streamfx::util::threadpool::chain::start()
+{
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		if (_started) {
+			throw std::runtime_error("Chain is already started.");
+		}
+		_started = true;
+	}
+	next();
+}
+
+void streamfx::util::threadpool::chain::cancel()
+{
+	std::lock_guard<std::mutex> lg(_lock);
+	_cancelled = true;
+	_status_changed.notify_all();
+}
+
+void streamfx::util::threadpool::chain::wait()
+{
+	std::unique_lock<std::mutex> ul(_lock);
+	_status_changed.wait(ul, [this]() { return !_running && (_finished || _cancelled); });
+}
+
+bool streamfx::util::threadpool::chain::is_finished()
+{
+	std::lock_guard<std::mutex> lg(_lock);
+	return _finished;
+}
+
+std::exception_ptr streamfx::util::threadpool::chain::get_exception()
+{
+	std::lock_guard<std::mutex> lg(_lock);
+	return _exception;
+}
+
+void streamfx::util::threadpool::chain::next()
+{
+	step entry;
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		if (_cancelled || _exception || _steps.empty()) {
+			_finished = true;
+			_status_changed.notify_all();
+			return;
+		}
+		entry = std::move(_steps.front());
+		_steps.pop_front();
+	}
+
+	// The queued step owns a reference to us, so that nobody has to keep the chain around while it runs.
+	auto self = shared_from_this();
+	switch (entry.where) {
+	case executor::GRAPHICS: {
+		auto param = new std::function<void()>([self, entry]() mutable { self->execute(entry); });
+		obs_queue_task(
+			OBS_TASK_GRAPHICS,
+			[](void* param) {
+				std::unique_ptr<std::function<void()>> callback(static_cast<std::function<void()>*>(param));
+				(*callback)();
+			},
+			param, false);
+		break;
+	}
+	case executor::BACKGROUND:
+		_pool->push([self, entry](task_data_t) mutable { self->execute(entry); }, nullptr, priority::BACKGROUND);
+		break;
+	default:
+		_pool->push([self, entry](task_data_t) mutable { self->execute(entry); }, nullptr, priority::FRAME);
+		break;
+	}
+}
+
+void streamfx::util::threadpool::chain::execute(step& entry)
+{
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		if (_cancelled) {
+			_finished = true;
+			_status_changed.notify_all();
+			return;
+		}
+		_running = true;
+	}
+
+	std::exception_ptr exception;
+	try {
+		entry.callback();
+	} catch (const std::exception& ex) {
+		D_LOG_ERROR("Unhandled exception in Chain: %s.", ex.what());
+		exception = std::current_exception();
+	} catch (...) {
+		D_LOG_ERROR("Unhandled exception in Chain.", nullptr);
+		exception = std::current_exception();
+	}
+
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		_running   = false;
+		_exception = exception;
+		_status_changed.notify_all();
+	}
+	next();
+}
+
 static std::shared_ptr<streamfx::util::threadpool::threadpool> loader_instance;
 
 static auto loader = streamfx::loader(
@@ -261,3 +834,11 @@ static auto loader = streamfx::loader(
 		loader_instance.reset();
 	},
 	streamfx::loader_priority::HIGHEST);
+
+static auto loader_affinity = streamfx::loader(
+	[]() { // Initalizer
+		loader_instance->configure();
+	},
+	[]() { // Finalizer
+	},
+	streamfx::loader_priority::NORMAL); // The configuration is only available after the pool was created.
@@ -3,25 +3,45 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "util/util-topology.hpp"
+
 #include "warning-disable.hpp"
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cinttypes>
 #include <condition_variable>
 #include <cstddef>
+#include <deque>
+#include <exception>
 #include <functional>
+#include <initializer_list>
 #include <list>
 #include <memory>
 #include <mutex>
 #include <new>
 #include <stdexcept>
 #include <thread>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::util::threadpool {
 	typedef std::shared_ptr<void>            task_data_t;
 	typedef std::function<void(task_data_t)> task_callback_t;
 
+	/** How urgently a task has to run, in the order in which workers look for work.
+	 *
+	 * Running tasks can't be interrupted, so background work is never allowed to occupy every worker.
+	 */
+	enum class priority : uint8_t {
+		REALTIME,   // Has to finish within a fraction of a frame, such as audio processing.
+		FRAME,      // Needed for the current or next frame.
+		BACKGROUND, // May take seconds, such as loading models or files and compiling shaders.
+	};
+	constexpr std::size_t priorities = 3;
+
+	class task;
+
 	struct worker_info {
 #if __cpp_lib_hardware_interference_size >= 201603
 		alignas(std::hardware_destructive_interference_size)
@@ -36,11 +56,23 @@ namespace streamfx::util::threadpool {
 		std::chrono::high_resolution_clock::time_point last_work_time;
 
 		std::thread thread;
+
+		// Affinity the worker currently has, so that it only changes when a task needs a different one.
+		uint32_t affinity = 0;
+
+		// Tasks pushed by this worker, by priority. The owner takes from the back, idle workers steal from the front.
+#if __cpp_lib_hardware_interference_size >= 201603
+		alignas(std::hardware_destructive_interference_size)
+#endif
+			std::mutex queue_lock;
+		std::array<std::deque<std::shared_ptr<task>>, priorities> queue;
 	};
 
 	class task {
 		task_callback_t _callback;
 		task_data_t     _data;
+		priority        _priority;
+		uint32_t        _node;
 		std::mutex      _lock;
 
 #if __cpp_lib_hardware_interference_size >= 201603
@@ -61,7 +93,7 @@ namespace streamfx::util::threadpool {
 			std::atomic<bool> _failed;
 
 		public:
-		task(task_callback_t callback, task_data_t data);
+		task(task_callback_t callback, task_data_t data, priority prio = priority::FRAME, uint32_t node = streamfx::util::topology::unknown_node);
 
 		public:
 		~task();
@@ -72,6 +104,13 @@ namespace streamfx::util::threadpool {
 		public:
 		void cancel();
 
+		public:
+		priority get_priority();
+
+		/** NUMA node of the thread that queued the task, if the pool keeps frame work local. */
+		public:
+		uint32_t get_node();
+
 		public:
 		bool is_cancelled();
 
@@ -110,7 +149,23 @@ namespace streamfx::util::threadpool {
 		alignas(std::hardware_destructive_interference_size)
 #endif
 			std::condition_variable _tasks_cv;
-		std::list<std::shared_ptr<task>> _tasks;
+		std::array<std::list<std::shared_ptr<task>>, priorities> _tasks; // Tasks pushed from outside of the pool, by priority.
+#if __cpp_lib_hardware_interference_size >= 201603
+		alignas(std::hardware_destructive_interference_size)
+#endif
+			std::atomic<size_t> _pending; // Queued tasks in all queues, so that idle workers know when to look.
+		std::atomic<size_t> _pending_background; // Part of _pending that is background work.
+#if __cpp_lib_hardware_interference_size >= 201603
+		alignas(std::hardware_destructive_interference_size)
+#endif
+			std::atomic<size_t> _running; // Tasks currently being run.
+		std::atomic<size_t> _running_background; // Part of _running that is background work.
+
+		// Affinity Policies
+		std::shared_ptr<streamfx::util::topology> _topology;
+		std::atomic<bool>                         _affinity_realtime;   // Realtime work on performance cores.
+		std::atomic<bool>                         _affinity_background; // Background work on efficiency cores.
+		std::atomic<bool>                         _affinity_local;      // Frame work on the NUMA node that queued it.
 
 		public:
 		~threadpool();
@@ -119,21 +174,164 @@ namespace streamfx::util::threadpool {
 		threadpool(size_t minimum = 2, size_t maximum = std::thread::hardware_concurrency());
 
 		public:
-		std::shared_ptr<task> push(task_callback_t callback, task_data_t data = nullptr);
+		std::shared_ptr<task> push(task_callback_t callback, task_data_t data = nullptr, priority prio = priority::FRAME);
+
+		/** Queue several tasks at once, which only takes the locks and wakes the workers once. */
+		public:
+		std::vector<std::shared_ptr<task>> push_bulk(const std::vector<task_callback_t>& callbacks, priority prio = priority::FRAME);
 
 		public:
 		void pop(std::shared_ptr<task> task);
 
+		/** Apply the affinity policies from the configuration, which doesn't exist yet when the pool is created. */
+		public:
+		void configure();
+
+		/** Wait for the given tasks, running those that no worker has started yet on the calling thread. */
+		public:
+		void join(const std::vector<std::shared_ptr<task>>& tasks);
+
+		/** Call fn(first, last) for consecutive ranges of at most grain elements in [begin, end), and wait for all of them.
+		 *
+		 * The first range runs on the calling thread, so a single range never touches the pool. The first exception
+		 * thrown by fn is rethrown here once every range has finished.
+		 */
+		public:
+		void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& fn, priority prio = priority::FRAME);
+
+		private:
+		bool unqueue(std::shared_ptr<task> task);
+
+		private:
+		void enqueue(const std::vector<std::shared_ptr<task>>& tasks, priority prio);
+
+		private:
+		bool background_allowed();
+
+		private:
+		bool runnable();
+
+		private:
+		std::shared_ptr<task> take(std::shared_ptr<worker_info> wi);
+
 		private:
 		void spawn(size_t count = 1);
 
 		private:
 		bool die(std::shared_ptr<worker_info>);
 
+		private:
+		uint32_t affinity_for(const std::shared_ptr<task>& task);
+
+		private:
+		void apply_affinity(uint32_t affinity);
+
 		private:
 		void work(std::shared_ptr<worker_info>);
 
 		public /* Singleton */:
 		static std::shared_ptr<streamfx::util::threadpool::threadpool> instance();
 	};
+
+	/** Work with dependencies between its parts, such as A -> B, C -> D.
+	 *
+	 * Nodes may only depend on nodes added before them, which rules out cycles. A node is queued as soon as the last
+	 * of its dependencies finished, and wait() runs any node that is still queued on the calling thread. Once a node
+	 * throws, the nodes that haven't started yet are skipped and wait() rethrows the exception.
+	 */
+	class graph {
+		struct node {
+			std::function<void()> callback;
+			std::vector<size_t>   successors;
+			size_t                dependencies;
+			std::atomic<size_t>   remaining;
+			std::shared_ptr<task> handle;
+		};
+
+		std::shared_ptr<threadpool>        _pool;
+		priority                           _priority;
+		std::mutex                         _lock;
+		std::vector<std::unique_ptr<node>> _nodes;
+		std::exception_ptr                 _exception;
+		bool                               _running;
+
+		public:
+		~graph();
+		graph(priority prio = priority::FRAME, std::shared_ptr<threadpool> pool = threadpool::instance());
+
+		/** Add a node that runs after all of the given nodes, and return its id. */
+		size_t add(std::function<void()> callback, std::initializer_list<size_t> dependencies = {});
+
+		/** Queue all nodes without dependencies. */
+		void run();
+
+		/** Wait for every node to finish, helping with the work that is left. */
+		void wait();
+
+		private:
+		void execute(size_t id);
+
+		void enqueue(const std::vector<size_t>& ids);
+	};
+
+	/** Where a step of a chain runs. */
+	enum class executor : uint8_t {
+		FRAME,      // Thread pool, with priority::FRAME.
+		BACKGROUND, // Thread pool, with priority::BACKGROUND.
+		GRAPHICS,   // Graphics thread, at the start of the next frame, for creating or publishing graphics resources.
+	};
+
+	/** Work in several steps that each run once the previous one finished, such as load -> allocate -> publish.
+	 *
+	 * No thread waits in between steps, and a step that has to run elsewhere simply queues the next one there, so each
+	 * step only holds the locks it needs itself. Once a step throws or the chain is cancelled, the steps that haven't
+	 * started yet are skipped. Create it with std::make_shared, as queued steps keep it alive.
+	 */
+	class chain : public std::enable_shared_from_this<chain> {
+		struct step {
+			executor              where;
+			std::function<void()> callback;
+		};
+
+		std::shared_ptr<threadpool> _pool;
+		std::mutex                  _lock;
+		std::condition_variable     _status_changed;
+		std::deque<step>            _steps;
+		std::exception_ptr          _exception;
+		bool                        _started;
+		bool                        _running;
+		bool                        _cancelled;
+		bool                        _finished;
+
+		public:
+		~chain();
+		chain(std::shared_ptr<threadpool> pool = threadpool::instance());
+
+		/** Add a step that runs on the given executor after all steps added before it. */
+		chain& then(executor where, std::function<void()> callback);
+
+		/** Queue the first step. */
+		void start();
+
+		/** Skip every step that hasn't started yet. */
+		void cancel();
+
+		/** Wait until every step ran, or after cancel() only for the step that is currently running.
+		 *
+		 * Only the latter is safe on the graphics thread, which a remaining graphics step would wait for. Once cancelled,
+		 * nothing of the chain runs anymore when this returns, so whatever the steps use may be freed.
+		 */
+		void wait();
+
+		/** Did every step run, or was the rest skipped? */
+		bool is_finished();
+
+		/** The exception that stopped the chain, or nullptr. */
+		std::exception_ptr get_exception();
+
+		private:
+		void next();
+
+		void execute(step& entry);
+	};
 } // namespace streamfx::util::threadpool
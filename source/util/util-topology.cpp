@@ -0,0 +1,276 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-topology.hpp"
+#include "common.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include "warning-enable.hpp"
+
+#include "warning-disable.hpp"
+#if defined(D_PLATFORM_WINDOWS)
+#include <Windows.h>
+#elif defined(D_PLATFORM_LINUX)
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#endif
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<util::topology> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#if defined(D_PLATFORM_LINUX)
+// Parse a list in the kernel's "0-3,8,10-11" format.
+static std::vector<uint32_t> read_cpu_list(const std::filesystem::path& path)
+{
+	std::vector<uint32_t> cpus;
+	std::ifstream         file(path);
+	std::string           list;
+	if (!std::getline(file, list)) {
+		return cpus;
+	}
+
+	std::size_t pos = 0;
+	while (pos < list.size()) {
+		std::size_t end   = std::min(list.find(',', pos), list.size());
+		std::string range = list.substr(pos, end - pos);
+		pos               = end + 1;
+
+		try {
+			std::size_t dash  = range.find('-');
+			uint32_t    first = static_cast<uint32_t>(std::stoul(range.substr(0, dash)));
+			uint32_t    last  = (dash == std::string::npos) ? first : static_cast<uint32_t>(std::stoul(range.substr(dash + 1)));
+			for (uint32_t cpu = first; cpu <= last; cpu++) {
+				cpus.push_back(cpu);
+			}
+		} catch (...) {
+			// Ignore anything we don't understand.
+		}
+	}
+	return cpus;
+}
+#endif
+
+streamfx::util::topology::topology() : _processors(), _nodes(1), _hybrid(false)
+{
+#if defined(D_PLATFORM_WINDOWS)
+	DWORD length = 0;
+	GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+	std::vector<uint8_t> buffer(length);
+	if ((length > 0) && GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &length)) {
+		std::vector<std::pair<processor, BYTE>>          cores;
+		std::vector<std::pair<GROUP_AFFINITY, uint32_t>> nodes;
+
+		for (DWORD offset = 0; offset < length;) {
+			auto info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+			if (info->Relationship == RelationProcessorCore) {
+				for (WORD group = 0; group < info->Processor.GroupCount; group++) {
+					auto& mask = info->Processor.GroupMask[group];
+					for (uint32_t number = 0; number < (sizeof(KAFFINITY) * 8); number++) {
+						if ((mask.Mask & (KAFFINITY{1} << number)) != 0) {
+							cores.push_back({processor{mask.Group, number, 0, true}, info->Processor.EfficiencyClass});
+						}
+					}
+				}
+			} else if (info->Relationship == RelationNumaNode) {
+				nodes.push_back({info->NumaNode.GroupMask, static_cast<uint32_t>(info->NumaNode.NodeNumber)});
+			}
+			offset += info->Size;
+		}
+
+		// A higher efficiency class means a faster, less efficient core.
+		BYTE min_class = 0xFF, max_class = 0;
+		for (auto& core : cores) {
+			min_class = std::min(min_class, core.second);
+			max_class = std::max(max_class, core.second);
+		}
+		for (auto& core : cores) {
+			core.first.performance = (core.second == max_class);
+			for (auto& node : nodes) {
+				if ((node.first.Group == core.first.group) && ((node.first.Mask & (KAFFINITY{1} << core.first.number)) != 0)) {
+					core.first.node = node.second;
+				}
+			}
+			_processors.push_back(core.first);
+		}
+		_hybrid = !cores.empty() && (min_class != max_class);
+	}
+#elif defined(D_PLATFORM_LINUX)
+	std::filesystem::path sys = "/sys/devices/system";
+
+	auto cpus = read_cpu_list(sys / "cpu" / "online");
+	if (cpus.empty()) {
+		for (uint32_t cpu = 0; cpu < std::thread::hardware_concurrency(); cpu++) {
+			cpus.push_back(cpu);
+		}
+	}
+	for (auto cpu : cpus) {
+		_processors.push_back(processor{0, cpu, 0, true});
+	}
+
+	{ // NUMA nodes, if the kernel has them.
+		std::error_code ec;
+		for (auto& entry : std::filesystem::directory_iterator(sys / "node", ec)) {
+			std::string name = entry.path().filename().string();
+			if ((name.rfind("node", 0) != 0) || (name.size() <= 4) || !std::isdigit(static_cast<unsigned char>(name[4]))) {
+				continue;
+			}
+
+			uint32_t node = static_cast<uint32_t>(std::stoul(name.substr(4)));
+			for (auto cpu : read_cpu_list(entry.path() / "cpulist")) {
+				for (auto& proc : _processors) {
+					if (proc.number == cpu) {
+						proc.node = node;
+					}
+				}
+			}
+		}
+	}
+
+	// Intel hybrid processors list their efficiency cores as a separate PMU, others only differ in capacity.
+	if (auto atoms = read_cpu_list("/sys/devices/cpu_atom/cpus"); !atoms.empty()) {
+		for (auto& proc : _processors) {
+			proc.performance = (std::find(atoms.begin(), atoms.end(), proc.number) == atoms.end());
+		}
+	} else {
+		std::vector<uint32_t> capacities;
+		uint32_t              max_capacity = 0;
+		for (auto& proc : _processors) {
+			std::ifstream file(sys / "cpu" / ("cpu" + std::to_string(proc.number)) / "cpu_capacity");
+			uint32_t      capacity = 0;
+			file >> capacity;
+			capacities.push_back(capacity);
+			max_capacity = std::max(max_capacity, capacity);
+		}
+		for (std::size_t idx = 0; (max_capacity > 0) && (idx < _processors.size()); idx++) {
+			_processors[idx].performance = (capacities[idx] == max_capacity);
+		}
+	}
+	_hybrid = std::any_of(_processors.begin(), _processors.end(), [](const processor& proc) { return !proc.performance; });
+#endif
+
+	for (auto& proc : _processors) {
+		_nodes = std::max(_nodes, proc.node + 1);
+	}
+
+	std::size_t performance = static_cast<std::size_t>(std::count_if(_processors.begin(), _processors.end(), [](const processor& proc) { return proc.performance; }));
+	D_LOG_INFO("Found %zu logical processors in %" PRIu32 " NUMA node(s), with %zu performance and %zu efficiency processors.", _processors.size(), _nodes, performance, _processors.size() - performance);
+}
+
+streamfx::util::topology::~topology() {}
+
+const std::vector<streamfx::util::topology::processor>& streamfx::util::topology::processors()
+{
+	return _processors;
+}
+
+uint32_t streamfx::util::topology::nodes()
+{
+	return _nodes;
+}
+
+bool streamfx::util::topology::is_hybrid()
+{
+	return _hybrid;
+}
+
+std::vector<streamfx::util::topology::processor> streamfx::util::topology::select(bool performance, bool efficiency, uint32_t node)
+{
+	std::vector<processor> result;
+	for (auto& proc : _processors) {
+		if ((proc.performance ? performance : efficiency) && ((node == unknown_node) || (proc.node == node))) {
+			result.push_back(proc);
+		}
+	}
+	return result;
+}
+
+uint32_t streamfx::util::topology::current_node()
+{
+#if defined(D_PLATFORM_WINDOWS)
+	PROCESSOR_NUMBER number;
+	USHORT           node = 0;
+	GetCurrentProcessorNumberEx(&number);
+	if (GetNumaProcessorNodeEx(&number, &node)) {
+		return node;
+	}
+#elif defined(D_PLATFORM_LINUX)
+	if (int cpu = sched_getcpu(); cpu >= 0) {
+		for (auto& proc : _processors) {
+			if (proc.number == static_cast<uint32_t>(cpu)) {
+				return proc.node;
+			}
+		}
+	}
+#endif
+	return unknown_node;
+}
+
+bool streamfx::util::topology::set_thread_affinity(const std::vector<processor>& processors)
+{
+	const std::vector<processor>& list = processors.empty() ? _processors : processors;
+	if (list.empty()) {
+		return false;
+	}
+
+#if defined(D_PLATFORM_WINDOWS)
+	GROUP_AFFINITY affinity = {};
+	if (processors.empty()) { // Stay in the group the thread is already in.
+		GetThreadGroupAffinity(GetCurrentThread(), &affinity);
+		affinity.Mask = 0;
+	} else {
+		affinity.Group = list.front().group;
+	}
+	for (auto& proc : list) {
+		if ((proc.group == affinity.Group) && (proc.number < (sizeof(KAFFINITY) * 8))) {
+			affinity.Mask |= KAFFINITY{1} << proc.number;
+		}
+	}
+	return (affinity.Mask != 0) && SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr);
+#elif defined(D_PLATFORM_LINUX)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (auto& proc : list) {
+		if (proc.number < CPU_SETSIZE) {
+			CPU_SET(proc.number, &set);
+		}
+	}
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+std::shared_ptr<streamfx::util::topology> streamfx::util::topology::get()
+{
+	static std::weak_ptr<streamfx::util::topology> instance;
+	static std::mutex                              lock;
+
+	std::unique_lock<std::mutex> ul(lock);
+	if (instance.expired()) {
+		auto hard_instance = std::shared_ptr<streamfx::util::topology>(new streamfx::util::topology());
+		instance           = hard_instance;
+		return hard_instance;
+	}
+	return instance.lock();
+}
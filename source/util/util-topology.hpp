@@ -0,0 +1,67 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "warning-disable.hpp"
+#include <cinttypes>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::util {
+	/** Layout of the logical processors of the system, for placing threads on the right kind of core.
+	 *
+	 * Hybrid processors mix fast performance cores with slower but more efficient cores, and multi-socket systems
+	 * split memory into NUMA nodes that are slower to reach from the other sockets.
+	 */
+	class topology {
+		public:
+		static constexpr uint32_t unknown_node = UINT32_MAX;
+
+		struct processor {
+			uint16_t group;       // Processor group, always 0 outside of Windows.
+			uint32_t number;      // Number in the group, or the CPU index outside of Windows.
+			uint32_t node;        // NUMA node it belongs to.
+			bool     performance; // Part of the fastest class of cores, true for all of them if there is only one class.
+		};
+
+		private:
+		std::vector<processor> _processors;
+		uint32_t               _nodes;
+		bool                   _hybrid;
+
+		private:
+		topology();
+
+		public:
+		~topology();
+
+		const std::vector<processor>& processors();
+
+		/** Number of NUMA nodes, 1 if the system doesn't have any. */
+		uint32_t nodes();
+
+		/** Does the system have cores of different classes? */
+		bool is_hybrid();
+
+		/** Processors matching a filter, which are what an affinity is built from. */
+		std::vector<processor> select(bool performance, bool efficiency, uint32_t node = unknown_node);
+
+		/** NUMA node of the processor the calling thread currently runs on. */
+		uint32_t current_node();
+
+		/** Restrict the calling thread to the given processors, or allow all of them if the list is empty.
+		 *
+		 * Windows can only restrict threads to a single processor group at a time, so only the processors of the
+		 * first processor's group are used there.
+		 *
+		 * @return false if the operating system refused.
+		 */
+		bool set_thread_affinity(const std::vector<processor>& processors);
+
+		public /* Singleton */:
+		static std::shared_ptr<streamfx::util::topology> get();
+	};
+} // namespace streamfx::util